@@ -106,6 +106,7 @@ typedef void           ILvoid;
 #define IL_UNSIGNED_INT   0x1405
 #define IL_FLOAT          0x1406
 #define IL_DOUBLE         0x140A
+#define IL_HALF           0x140B  // Only accepted by ilHdrReadRows() and ilHdrReadRegion()
 
 
 #define IL_VENDOR   0x1F00
@@ -317,6 +318,8 @@ typedef void           ILvoid;
 #define IL_3DC              0x070E
 #define IL_RXGB             0x070F
 #define IL_ATI1N            0x0710
+#define IL_DXTC_MIPMAP_SKIP  0x0725 // ILint : leading mipmap levels of a DDS file that are not decoded
+#define IL_DXTC_MIPMAP_COUNT 0x0726 // ILint : levels decoded below the first one, -1 for all
 
 // Cube map definitions
 #define IL_CUBEMAP_POSITIVEX 0x00000400
@@ -435,6 +438,12 @@ typedef ILvoid  (ILAPIENTRY *mFree) (ILvoid*);
 typedef ILenum (ILAPIENTRY *IL_LOADPROC)(const ILstring);
 typedef ILenum (ILAPIENTRY *IL_SAVEPROC)(const ILstring);
 
+// Loading context for the reentrant ilLoad*Ctx functions
+typedef struct ILcontext ILcontext;
+
+// Open Radiance .hdr file decoded a few rows at a time (ilHdrOpen)
+typedef struct ILhdrStream ILhdrStream;
+
 
 // ImageLib Functions
 ILAPI ILboolean ILAPIENTRY ilActiveImage(ILuint Number);
@@ -527,6 +536,27 @@ ILAPI ILboolean ILAPIENTRY ilLoadDataF(ILHANDLE File, ILuint Width, ILuint Heigh
 ILAPI ILboolean ILAPIENTRY ilLoadDataL(ILvoid *Lump, ILuint Size, ILuint Width, ILuint Height, ILuint Depth, ILubyte Bpp);
 ILAPI ILboolean ILAPIENTRY ilSaveData(const ILstring FileName);
 
+// Reentrant loading:  each context has its own image, error stack and file
+//	callbacks, so several threads can load into separate contexts at once.
+ILAPI ILcontext* ILAPIENTRY ilCreateContext();
+ILAPI ILvoid    ILAPIENTRY ilDeleteContext(ILcontext *Context);
+ILAPI ILubyte*  ILAPIENTRY ilGetDataCtx(ILcontext *Context);
+ILAPI ILenum    ILAPIENTRY ilGetErrorCtx(ILcontext *Context);
+ILAPI ILint     ILAPIENTRY ilGetIntegerCtx(ILcontext *Context, ILenum Mode);
+ILAPI ILboolean ILAPIENTRY ilLoadCtx(ILcontext *Context, ILenum Type, const ILstring FileName);
+ILAPI ILboolean ILAPIENTRY ilLoadFCtx(ILcontext *Context, ILenum Type, ILHANDLE File);
+ILAPI ILboolean ILAPIENTRY ilLoadLCtx(ILcontext *Context, ILenum Type, const ILvoid *Lump, ILuint Size);
+ILAPI ILvoid    ILAPIENTRY ilSetReadCtx(ILcontext *Context, fOpenRProc, fCloseRProc, fEofProc, fGetcProc, fReadProc, fSeekRProc, fTellRProc);
+
+// Streaming .hdr decoding:  rows or regions are decoded straight into the caller's
+//	buffer as RGB IL_FLOAT or IL_HALF, keeping only one RGBE scanline in memory.
+ILAPI ILhdrStream* ILAPIENTRY ilHdrOpen(const ILstring FileName);
+ILAPI ILhdrStream* ILAPIENTRY ilHdrOpenL(const ILvoid *Lump, ILuint Size);
+ILAPI ILvoid    ILAPIENTRY ilHdrClose(ILhdrStream *Stream);
+ILAPI ILboolean ILAPIENTRY ilHdrGetSize(ILhdrStream *Stream, ILuint *Width, ILuint *Height);
+ILAPI ILboolean ILAPIENTRY ilHdrReadRegion(ILhdrStream *Stream, ILuint XOff, ILuint YOff, ILuint Width, ILuint Height, ILenum Type, ILvoid *Dest, ILuint Stride);
+ILAPI ILboolean ILAPIENTRY ilHdrReadRows(ILhdrStream *Stream, ILuint YOff, ILuint NumRows, ILenum Type, ILvoid *Dest);
+
 ILAPI ILboolean ILAPIENTRY ilLoadFromJpegStruct(ILvoid* JpegDecompressorPtr);
 ILAPI ILboolean ILAPIENTRY ilSaveFromJpegStruct(ILvoid* JpegCompressorPtr);
 
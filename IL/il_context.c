@@ -0,0 +1,216 @@
+//-----------------------------------------------------------------------------
+//
+// ImageLib Sources
+// Copyright (C) 2000-2002 by Denton Woods
+// Last modified: 10/19/2026
+//
+// Filename: src-IL/src/il_context.c
+//
+// Description: Reentrant loading through explicit contexts
+//
+//-----------------------------------------------------------------------------
+
+
+#include "il_internal.h"
+
+
+// Used by every call that is not made through a context (the classic API).
+//	Zeroed here, ilInit() sets the fields that start non-zero.
+ILcontext iDefaultContext;
+
+// Context of the call currently running on this thread.
+IL_THREAD_LOCAL ILcontext *iCurContext = &iDefaultContext;
+
+
+// Called by ilInit():  empties the error stack and marks the current image as a parent.
+ILvoid iInitDefaultContext()
+{
+	iDefaultContext.ErrorPlace = -1;
+	iDefaultContext.ParentImage = IL_TRUE;
+	return;
+}
+
+
+// Makes Context current on the calling thread and returns the previous one.
+ILcontext *iBindContext(ILcontext *Context)
+{
+	ILcontext *Prev = iCurContext;
+	iCurContext = Context;
+	return Prev;
+}
+
+
+//! Creates a loading context with its own image, error stack and file callbacks.
+ILcontext* ILAPIENTRY ilCreateContext()
+{
+	ILcontext *Context, *Prev;
+
+	Context = (ILcontext*)icalloc(1, sizeof(ILcontext));
+	if (Context == NULL)
+		return NULL;
+
+	// Must be all 1's instead of 0's, because some functions would divide by 0.
+	Context->BaseImage = ilNewImage(1, 1, 1, 1, 1);
+	if (Context->BaseImage == NULL) {
+		ifree(Context);
+		return NULL;
+	}
+	Context->CurImage = Context->BaseImage;
+	Context->ErrorPlace = -1;
+	Context->ParentImage = IL_TRUE;
+
+	Prev = iBindContext(Context);
+	ilResetRead();
+	ilResetWrite();
+	iBindContext(Prev);
+
+	return Context;
+}
+
+
+//! Frees a context created by ilCreateContext() together with its image.
+ILvoid ILAPIENTRY ilDeleteContext(ILcontext *Context)
+{
+	if (Context == NULL)
+		return;
+
+	if (Context->BaseImage)
+		ilCloseImage(Context->BaseImage);
+	if (Context->Cache)
+		ifree(Context->Cache);
+	ifree(Context);
+
+	return;
+}
+
+
+// Binds Context with its parent image current, so the load starts from a clean state.
+static ILcontext *iBeginContextCall(ILcontext *Context)
+{
+	ILcontext *Prev = iBindContext(Context);
+	iCurImage = Context->BaseImage;
+	return Prev;
+}
+
+
+//! Loads a file into Context.  Different threads may load into different contexts at once.
+ILboolean ILAPIENTRY ilLoadCtx(ILcontext *Context, ILenum Type, const ILstring FileName)
+{
+	ILcontext	*Prev;
+	ILboolean	bRet;
+
+	if (Context == NULL) {
+		ilSetError(IL_INVALID_PARAM);
+		return IL_FALSE;
+	}
+
+	Prev = iBeginContextCall(Context);
+	bRet = ilLoad(Type, FileName);
+	iBindContext(Prev);
+
+	return bRet;
+}
+
+
+//! Loads an already-opened file into Context.
+ILboolean ILAPIENTRY ilLoadFCtx(ILcontext *Context, ILenum Type, ILHANDLE File)
+{
+	ILcontext	*Prev;
+	ILboolean	bRet;
+
+	if (Context == NULL) {
+		ilSetError(IL_INVALID_PARAM);
+		return IL_FALSE;
+	}
+
+	Prev = iBeginContextCall(Context);
+	bRet = ilLoadF(Type, File);
+	iBindContext(Prev);
+
+	return bRet;
+}
+
+
+//! Loads an image from a memory lump into Context.
+ILboolean ILAPIENTRY ilLoadLCtx(ILcontext *Context, ILenum Type, const ILvoid *Lump, ILuint Size)
+{
+	ILcontext	*Prev;
+	ILboolean	bRet;
+
+	if (Context == NULL) {
+		ilSetError(IL_INVALID_PARAM);
+		return IL_FALSE;
+	}
+
+	Prev = iBeginContextCall(Context);
+	bRet = ilLoadL(Type, Lump, Size);
+	iBindContext(Prev);
+
+	return bRet;
+}
+
+
+//! Same as ilSetRead(), but only for loads made through Context.
+ILvoid ILAPIENTRY ilSetReadCtx(ILcontext *Context, fOpenRProc Open, fCloseRProc Close, fEofProc Eof, fGetcProc Getc, fReadProc Read, fSeekRProc Seek, fTellRProc Tell)
+{
+	ILcontext *Prev;
+
+	if (Context == NULL) {
+		ilSetError(IL_INVALID_PARAM);
+		return;
+	}
+
+	Prev = iBindContext(Context);
+	ilSetRead(Open, Close, Eof, Getc, Read, Seek, Tell);
+	iBindContext(Prev);
+
+	return;
+}
+
+
+//! Gets the last error of a load made through Context.
+ILenum ILAPIENTRY ilGetErrorCtx(ILcontext *Context)
+{
+	ILcontext	*Prev;
+	ILenum		Error;
+
+	if (Context == NULL)
+		return IL_INVALID_PARAM;
+
+	Prev = iBindContext(Context);
+	Error = ilGetError();
+	iBindContext(Prev);
+
+	return Error;
+}
+
+
+//! ilGetInteger() on the image of Context (IL_IMAGE_WIDTH, IL_IMAGE_FORMAT, ...).
+ILint ILAPIENTRY ilGetIntegerCtx(ILcontext *Context, ILenum Mode)
+{
+	ILcontext	*Prev;
+	ILint		Value;
+
+	if (Context == NULL) {
+		ilSetError(IL_INVALID_PARAM);
+		return 0;
+	}
+
+	Prev = iBeginContextCall(Context);
+	Value = ilGetInteger(Mode);
+	iBindContext(Prev);
+
+	return Value;
+}
+
+
+//! Returns the pixels of the image of Context.  Valid until its next load or deletion.
+ILubyte* ILAPIENTRY ilGetDataCtx(ILcontext *Context)
+{
+	if (Context == NULL) {
+		ilSetError(IL_INVALID_PARAM);
+		return NULL;
+	}
+
+	return Context->BaseImage->Data;
+}
@@ -0,0 +1,93 @@
+//-----------------------------------------------------------------------------
+//
+// ImageLib Sources
+// Copyright (C) 2000-2002 by Denton Woods
+// Last modified: 10/19/2026
+//
+// Filename: src-IL/include/il_context.h
+//
+// Description: Per-call loading state for DevIL
+//
+//-----------------------------------------------------------------------------
+
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include <IL/il.h>
+#include <IL/devil_internal_exports.h>
+
+
+// Storage class for state that has to be private to each thread.
+#if defined(_MSC_VER)
+	#define IL_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+	#define IL_THREAD_LOCAL __thread
+#else
+	#define IL_THREAD_LOCAL  // No thread-local storage, so only one load at a time.
+#endif
+
+#define IL_ERROR_STACK_SIZE 32
+
+
+// Everything a load touches besides the read-only library states:  the image
+//	being filled, the error stack and the whole I/O layer of il_files.c.  The
+//	legacy API works on iDefaultContext; the ilLoad*Ctx() functions make the
+//	caller's context current on the calling thread for the duration of the call.
+struct ILcontext
+{
+	ILimage		*CurImage;
+	ILimage		*BaseImage;  // Private image of ilCreateContext(), NULL for the default context
+	ILint		ErrorPlace;
+	ILenum		ErrorNum[IL_ERROR_STACK_SIZE];
+	ILboolean	ParentImage;
+
+	// User file callbacks
+	fEofProc	EofProc;
+	fGetcProc	GetcProc;
+	fReadProc	ReadProc;
+	fSeekRProc	SeekRProc;
+	fSeekWProc	SeekWProc;
+	fTellRProc	TellRProc;
+	fTellWProc	TellWProc;
+	fPutcProc	PutcProc;
+	fWriteProc	WriteProc;
+
+	// Current input/output functions (file or lump)
+	ILboolean	(ILAPIENTRY *ieof)(ILvoid);
+	ILHANDLE	(ILAPIENTRY *iopenr)(const ILstring);
+	ILvoid		(ILAPIENTRY *icloser)(ILHANDLE);
+	ILint		(ILAPIENTRY *igetc)(ILvoid);
+	ILuint		(ILAPIENTRY *iread)(ILvoid *Buffer, ILuint Size, ILuint Number);
+	ILuint		(ILAPIENTRY *iseek)(ILint Offset, ILuint Mode);
+	ILuint		(ILAPIENTRY *itell)(ILvoid);
+	ILvoid		(ILAPIENTRY *iclosew)(ILHANDLE);
+	ILHANDLE	(ILAPIENTRY *iopenw)(const ILstring);
+	ILint		(ILAPIENTRY *iputc)(ILubyte Char);
+	ILuint		(ILAPIENTRY *iseekw)(ILint Offset, ILuint Mode);
+	ILuint		(ILAPIENTRY *itellw)(ILvoid);
+	ILint		(ILAPIENTRY *iwrite)(const ILvoid *Buffer, ILuint Size, ILuint Number);
+
+	// File and lump positions
+	ILHANDLE	FileRead, FileWrite;
+	const ILvoid *ReadLump;
+	ILvoid		*WriteLump;
+	ILuint		ReadLumpPos, ReadLumpSize, ReadFileStart, WriteFileStart;
+	ILuint		WriteLumpPos, WriteLumpSize;
+
+	// Read cache (iPreCache)
+	ILboolean	UseCache;
+	ILubyte		*Cache;
+	ILuint		CacheSize, CachePos, CacheStartPos, CacheBytesRead;
+};
+
+
+extern ILcontext iDefaultContext;
+extern IL_THREAD_LOCAL ILcontext *iCurContext;  // Starts as &iDefaultContext on every thread
+
+#define iGetCurContext()	(iCurContext)
+
+ILcontext	*iBindContext(ILcontext *Context);
+ILvoid		iInitDefaultContext(ILvoid);
+
+
+#endif//CONTEXT_H
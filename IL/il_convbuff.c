@@ -13,6 +13,7 @@
 
 #include "il_internal.h"
 #include "il_manip.h"
+#include "il_convfast.h"
 #ifdef ALTIVEC_GCC
 #include "altivec_typeconversion.h"
 #endif
@@ -40,12 +41,23 @@ ILAPI ILvoid* ILAPIENTRY ilConvertBuffer(ILuint SizeOfData, ILenum SrcFormat, IL
 	ILuint		NumPix;  // Really number of pixels * bpp.
 	ILuint		BpcDest;
 	ILvoid		*Data = NULL;
+	iConvPath	Path;
 
 	if (SizeOfData == 0 || Buffer == NULL) {
 		ilSetError(IL_INVALID_PARAM);
 		return NULL;
 	}
 
+	// The common pairs take one pass, without the intermediate buffer of iSwitchTypes().
+	if (iGetConvPath(SrcFormat, SrcType, DestFormat, DestType, &Path)) {
+		NumPix = SizeOfData / Path.SrcBpp;
+		NewData = (ILubyte*)ialloc(NumPix * Path.DestBpp);
+		if (NewData == NULL)
+			return NULL;
+		iRunConvPath(&Path, Buffer, NewData, NumPix);
+		return NewData;
+	}
+
 	Data = iSwitchTypes(SizeOfData, SrcType, DestType, Buffer);
 	if (Data == NULL)
 		return NULL;
@@ -0,0 +1,840 @@
+//-----------------------------------------------------------------------------
+//
+// ImageLib Sources
+// Copyright (C) 2000-2002 by Denton Woods
+// Last modified: 10/19/2026
+//
+// Filename: src-IL/src/il_convfast.c
+//
+// Description: Single-pass conversion of the common format/type pairs
+//
+//-----------------------------------------------------------------------------
+
+
+#include "il_internal.h"
+#include "il_convfast.h"
+#include <limits.h>
+
+
+// Must give the same results as iSwitchTypes() and the format switch of
+//	ilConvertBuffer() in il_convbuff.c, which handle everything not listed here.
+static const ILfloat LumFactor[3] = { 0.212671f, 0.715160f, 0.072169f };
+static const ILfloat LumFactorRev[3] = { 0.072169f, 0.715160f, 0.212671f };  // BGR(A) order
+
+#define IL_CONV_CHUNK 256  // Pixels per step of a fused conversion
+
+
+//
+// Type kernels
+//
+
+static ILvoid iUbyteToUshort(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	const ILubyte	*s = (const ILubyte*)Src;
+	ILushort		*d = (ILushort*)Dest;
+	ILuint			i = 0;
+
+#ifdef IL_USE_SSE2
+	const __m128i	Zero = _mm_setzero_si128();
+	__m128i			v;
+
+	for (; i + 16 <= Num; i += 16) {
+		v = _mm_loadu_si128((const __m128i*)(s + i));
+		_mm_storeu_si128((__m128i*)(d + i), _mm_unpacklo_epi8(Zero, v));
+		_mm_storeu_si128((__m128i*)(d + i + 8), _mm_unpackhi_epi8(Zero, v));
+	}
+#endif
+	for (; i < Num; i++)
+		d[i] = s[i] << 8;
+
+	return;
+}
+
+
+static ILvoid iUshortToUbyte(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	const ILushort	*s = (const ILushort*)Src;
+	ILubyte			*d = (ILubyte*)Dest;
+	ILuint			i = 0;
+
+#ifdef IL_USE_SSE2
+	__m128i			a, b;
+
+	for (; i + 16 <= Num; i += 16) {
+		a = _mm_srli_epi16(_mm_loadu_si128((const __m128i*)(s + i)), 8);
+		b = _mm_srli_epi16(_mm_loadu_si128((const __m128i*)(s + i + 8)), 8);
+		_mm_storeu_si128((__m128i*)(d + i), _mm_packus_epi16(a, b));
+	}
+#endif
+	for (; i < Num; i++)
+		d[i] = s[i] >> 8;
+
+	return;
+}
+
+
+static ILvoid iUbyteToFloat(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	const ILubyte	*s = (const ILubyte*)Src;
+	ILfloat			*d = (ILfloat*)Dest;
+	ILuint			i = 0;
+
+#ifdef IL_USE_SSE2
+	const __m128i	Zero = _mm_setzero_si128();
+	const __m128	Max = _mm_set1_ps((ILfloat)UCHAR_MAX);
+	__m128i			v, lo, hi;
+
+	for (; i + 16 <= Num; i += 16) {
+		v = _mm_loadu_si128((const __m128i*)(s + i));
+		lo = _mm_unpacklo_epi8(v, Zero);
+		hi = _mm_unpackhi_epi8(v, Zero);
+		_mm_storeu_ps(d + i,      _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, Zero)), Max));
+		_mm_storeu_ps(d + i + 4,  _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, Zero)), Max));
+		_mm_storeu_ps(d + i + 8,  _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, Zero)), Max));
+		_mm_storeu_ps(d + i + 12, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, Zero)), Max));
+	}
+#endif
+	for (; i < Num; i++)
+		d[i] = s[i] / (ILfloat)UCHAR_MAX;
+
+	return;
+}
+
+
+static ILvoid iUshortToFloat(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	const ILushort	*s = (const ILushort*)Src;
+	ILfloat			*d = (ILfloat*)Dest;
+	ILuint			i = 0;
+
+#ifdef IL_USE_SSE2
+	const __m128i	Zero = _mm_setzero_si128();
+	const __m128	Max = _mm_set1_ps((ILfloat)USHRT_MAX);
+	__m128i			v;
+
+	for (; i + 8 <= Num; i += 8) {
+		v = _mm_loadu_si128((const __m128i*)(s + i));
+		_mm_storeu_ps(d + i,     _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, Zero)), Max));
+		_mm_storeu_ps(d + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, Zero)), Max));
+	}
+#endif
+	for (; i < Num; i++)
+		d[i] = s[i] / (ILfloat)USHRT_MAX;
+
+	return;
+}
+
+
+#ifdef IL_USE_SSE2
+// Clamped to [0..1] and scaled like the CLAMP_FLOATS paths of iSwitchTypes().
+//	max(x, 0) puts NaNs to 0, which is also what the scalar casts end up with.
+static __m128i iClampScale(const ILfloat *s, __m128 Max)
+{
+	__m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(s), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	return _mm_cvttps_epi32(_mm_mul_ps(v, Max));
+}
+#endif
+
+static ILvoid iFloatToUbyte(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	const ILfloat	*s = (const ILfloat*)Src;
+	ILubyte			*d = (ILubyte*)Dest;
+	ILfloat			f;
+	ILuint			i = 0;
+
+#ifdef IL_USE_SSE2
+	const __m128	Max = _mm_set1_ps((ILfloat)UCHAR_MAX);
+	__m128i			a, b;
+
+	for (; i + 16 <= Num; i += 16) {
+		a = _mm_packs_epi32(iClampScale(s + i, Max), iClampScale(s + i + 4, Max));
+		b = _mm_packs_epi32(iClampScale(s + i + 8, Max), iClampScale(s + i + 12, Max));
+		_mm_storeu_si128((__m128i*)(d + i), _mm_packus_epi16(a, b));
+	}
+#endif
+	for (; i < Num; i++) {
+		f = s[i];
+		if (f < 0.0f) f = 0.0f;
+		if (f > 1.0f) f = 1.0f;
+		d[i] = (ILubyte)(f * UCHAR_MAX);
+	}
+
+	return;
+}
+
+
+static ILvoid iFloatToUshort(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	const ILfloat	*s = (const ILfloat*)Src;
+	ILushort		*d = (ILushort*)Dest;
+	ILfloat			f;
+	ILuint			i = 0;
+
+#ifdef IL_USE_SSE2
+	const __m128	Max = _mm_set1_ps((ILfloat)USHRT_MAX);
+	const __m128i	Bias = _mm_set1_epi32(0x8000), Sign = _mm_set1_epi16((short)0x8000);
+	__m128i			a, b;
+
+	// No unsigned 32 -> 16 bit pack in SSE2:  shift into the signed range and back.
+	for (; i + 8 <= Num; i += 8) {
+		a = _mm_sub_epi32(iClampScale(s + i, Max), Bias);
+		b = _mm_sub_epi32(iClampScale(s + i + 4, Max), Bias);
+		_mm_storeu_si128((__m128i*)(d + i), _mm_xor_si128(_mm_packs_epi32(a, b), Sign));
+	}
+#endif
+	for (; i < Num; i++) {
+		f = s[i];
+		if (f < 0.0f) f = 0.0f;
+		if (f > 1.0f) f = 1.0f;
+		d[i] = (ILushort)(f * USHRT_MAX);
+	}
+
+	return;
+}
+
+
+//
+// Format kernels, working on the destination type
+//
+
+// Channels 0 and 2 of four swapped (RGBA <-> BGRA)
+static ILvoid iSwap4_8(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	const ILubyte	*s = (const ILubyte*)Src;
+	ILubyte			*d = (ILubyte*)Dest;
+	ILuint			i = 0;
+
+#ifdef IL_USE_SSE2
+	const __m128i	Keep = _mm_set1_epi32((int)0xFF00FF00), Low = _mm_set1_epi32(0xFF);
+	__m128i			v;
+
+	for (; i + 4 <= Num; i += 4) {
+		v = _mm_loadu_si128((const __m128i*)(s + i * 4));
+		v = _mm_or_si128(_mm_and_si128(v, Keep),
+			_mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 16), Low), _mm_slli_epi32(_mm_and_si128(v, Low), 16)));
+		_mm_storeu_si128((__m128i*)(d + i * 4), v);
+	}
+#endif
+	for (; i < Num; i++) {
+		d[i * 4]     = s[i * 4 + 2];
+		d[i * 4 + 1] = s[i * 4 + 1];
+		d[i * 4 + 2] = s[i * 4];
+		d[i * 4 + 3] = s[i * 4 + 3];
+	}
+
+	return;
+}
+
+
+static ILvoid iSwap4_16(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	const ILushort	*s = (const ILushort*)Src;
+	ILushort		*d = (ILushort*)Dest;
+	ILuint			i = 0;
+
+#ifdef IL_USE_SSE2
+	__m128i			v;
+
+	for (; i + 2 <= Num; i += 2) {
+		v = _mm_loadu_si128((const __m128i*)(s + i * 4));
+		v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+		_mm_storeu_si128((__m128i*)(d + i * 4), v);
+	}
+#endif
+	for (; i < Num; i++) {
+		d[i * 4]     = s[i * 4 + 2];
+		d[i * 4 + 1] = s[i * 4 + 1];
+		d[i * 4 + 2] = s[i * 4];
+		d[i * 4 + 3] = s[i * 4 + 3];
+	}
+
+	return;
+}
+
+
+// Also used for 32-bit integers, the swap does not look at the bits.
+static ILvoid iSwap4_32(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	const ILuint	*s = (const ILuint*)Src;
+	ILuint			*d = (ILuint*)Dest;
+	ILuint			i = 0;
+
+#ifdef IL_USE_SSE2
+	__m128i			v;
+
+	for (; i < Num; i++) {
+		v = _mm_loadu_si128((const __m128i*)(s + i * 4));
+		_mm_storeu_si128((__m128i*)(d + i * 4), _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 0, 1, 2)));
+	}
+#else
+	for (; i < Num; i++) {
+		d[i * 4]     = s[i * 4 + 2];
+		d[i * 4 + 1] = s[i * 4 + 1];
+		d[i * 4 + 2] = s[i * 4];
+		d[i * 4 + 3] = s[i * 4 + 3];
+	}
+#endif
+
+	return;
+}
+
+
+// RGB <-> RGBA with or without swapping channels 0 and 2.  Plain C:  without
+//	SSSE3 byte shuffles the 3-channel side does not vectorise well.
+#define IL_DEF_EXPAND(Name, Type, First, Last, Alpha) \
+static ILvoid Name(const ILvoid *Src, ILvoid *Dest, ILuint Num) \
+{ \
+	const Type	*s = (const Type*)Src; \
+	Type		*d = (Type*)Dest; \
+	ILuint		i; \
+	for (i = 0; i < Num; i++, s += 3, d += 4) { \
+		d[0] = s[First]; \
+		d[1] = s[1]; \
+		d[2] = s[Last]; \
+		d[3] = Alpha; \
+	} \
+	return; \
+}
+
+#define IL_DEF_DROP(Name, Type, First, Last) \
+static ILvoid Name(const ILvoid *Src, ILvoid *Dest, ILuint Num) \
+{ \
+	const Type	*s = (const Type*)Src; \
+	Type		*d = (Type*)Dest; \
+	ILuint		i; \
+	for (i = 0; i < Num; i++, s += 4, d += 3) { \
+		d[0] = s[First]; \
+		d[1] = s[1]; \
+		d[2] = s[Last]; \
+	} \
+	return; \
+}
+
+IL_DEF_EXPAND(iExpand_8, ILubyte, 0, 2, UCHAR_MAX)
+IL_DEF_EXPAND(iExpandSwap_8, ILubyte, 2, 0, UCHAR_MAX)
+IL_DEF_EXPAND(iExpand_16, ILushort, 0, 2, USHRT_MAX)
+IL_DEF_EXPAND(iExpandSwap_16, ILushort, 2, 0, USHRT_MAX)
+IL_DEF_EXPAND(iExpand_F, ILfloat, 0, 2, 1.0f)
+IL_DEF_EXPAND(iExpandSwap_F, ILfloat, 2, 0, 1.0f)
+IL_DEF_DROP(iDrop_8, ILubyte, 0, 2)
+IL_DEF_DROP(iDropSwap_8, ILubyte, 2, 0)
+IL_DEF_DROP(iDrop_16, ILushort, 0, 2)
+IL_DEF_DROP(iDropSwap_16, ILushort, 2, 0)
+IL_DEF_DROP(iDrop_32, ILuint, 0, 2)
+IL_DEF_DROP(iDropSwap_32, ILuint, 2, 0)
+
+
+// Luminance to RGBA/BGRA with full opacity
+static ILvoid iLumTo4_8(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	const ILubyte	*s = (const ILubyte*)Src;
+	ILubyte			*d = (ILubyte*)Dest;
+	ILuint			i = 0;
+
+#ifdef IL_USE_SSE2
+	const __m128i	Alpha = _mm_set1_epi32((int)0xFF000000);
+	__m128i			v, lo, hi;
+
+	for (; i + 16 <= Num; i += 16) {
+		v = _mm_loadu_si128((const __m128i*)(s + i));
+		lo = _mm_unpacklo_epi8(v, v);
+		hi = _mm_unpackhi_epi8(v, v);
+		_mm_storeu_si128((__m128i*)(d + i * 4),      _mm_or_si128(_mm_unpacklo_epi16(lo, lo), Alpha));
+		_mm_storeu_si128((__m128i*)(d + i * 4 + 16), _mm_or_si128(_mm_unpackhi_epi16(lo, lo), Alpha));
+		_mm_storeu_si128((__m128i*)(d + i * 4 + 32), _mm_or_si128(_mm_unpacklo_epi16(hi, hi), Alpha));
+		_mm_storeu_si128((__m128i*)(d + i * 4 + 48), _mm_or_si128(_mm_unpackhi_epi16(hi, hi), Alpha));
+	}
+#endif
+	for (; i < Num; i++) {
+		d[i * 4] = d[i * 4 + 1] = d[i * 4 + 2] = s[i];
+		d[i * 4 + 3] = UCHAR_MAX;  // Full opacity
+	}
+
+	return;
+}
+
+
+static ILvoid iLumTo4_16(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	const ILushort	*s = (const ILushort*)Src;
+	ILushort		*d = (ILushort*)Dest;
+	ILuint			i = 0;
+
+#ifdef IL_USE_SSE2
+	const __m128i	Alpha = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+	__m128i			v, lo, hi;
+
+	for (; i + 8 <= Num; i += 8) {
+		v = _mm_loadu_si128((const __m128i*)(s + i));
+		lo = _mm_unpacklo_epi16(v, v);
+		hi = _mm_unpackhi_epi16(v, v);
+		_mm_storeu_si128((__m128i*)(d + i * 4),      _mm_or_si128(_mm_unpacklo_epi32(lo, lo), Alpha));
+		_mm_storeu_si128((__m128i*)(d + i * 4 + 8),  _mm_or_si128(_mm_unpackhi_epi32(lo, lo), Alpha));
+		_mm_storeu_si128((__m128i*)(d + i * 4 + 16), _mm_or_si128(_mm_unpacklo_epi32(hi, hi), Alpha));
+		_mm_storeu_si128((__m128i*)(d + i * 4 + 24), _mm_or_si128(_mm_unpackhi_epi32(hi, hi), Alpha));
+	}
+#endif
+	for (; i < Num; i++) {
+		d[i * 4] = d[i * 4 + 1] = d[i * 4 + 2] = s[i];
+		d[i * 4 + 3] = USHRT_MAX;  // Full opacity
+	}
+
+	return;
+}
+
+
+static ILvoid iLumTo4_F(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	const ILfloat	*s = (const ILfloat*)Src;
+	ILfloat			*d = (ILfloat*)Dest;
+	ILuint			i = 0;
+
+#ifdef IL_USE_SSE2
+	const __m128	Rgb = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+	const __m128	Alpha = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+
+	for (; i < Num; i++)
+		_mm_storeu_ps(d + i * 4, _mm_or_ps(_mm_and_ps(_mm_set1_ps(s[i]), Rgb), Alpha));
+#else
+	for (; i < Num; i++) {
+		d[i * 4] = d[i * 4 + 1] = d[i * 4 + 2] = s[i];
+		d[i * 4 + 3] = 1.0f;  // Full opacity
+	}
+#endif
+
+	return;
+}
+
+
+// Luminance of 4-channel pixels, summed channel by channel in the order of
+//	the old loops:  ((c0 * f0) + c1 * f1) + c2 * f2, truncated.
+static ILvoid iLumFrom4_8(const ILubyte *s, ILubyte *d, ILuint Num, const ILfloat *f)
+{
+	ILuint			i = 0;
+
+#ifdef IL_USE_SSE2
+	const __m128	f0 = _mm_set1_ps(f[0]), f1 = _mm_set1_ps(f[1]), f2 = _mm_set1_ps(f[2]);
+	const __m128i	Low = _mm_set1_epi32(0xFF);
+	__m128i			v, l[4];
+	__m128			r;
+	ILuint			k;
+
+	for (; i + 16 <= Num; i += 16) {
+		for (k = 0; k < 4; k++) {
+			v = _mm_loadu_si128((const __m128i*)(s + i * 4 + k * 16));
+			r = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(v, Low)), f0);
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(v, 8), Low)), f1));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(v, 16), Low)), f2));
+			l[k] = _mm_cvttps_epi32(r);
+		}
+		_mm_storeu_si128((__m128i*)(d + i),
+			_mm_packus_epi16(_mm_packs_epi32(l[0], l[1]), _mm_packs_epi32(l[2], l[3])));
+	}
+#endif
+	for (; i < Num; i++)
+		d[i] = (ILubyte)(s[i * 4] * f[0] + s[i * 4 + 1] * f[1] + s[i * 4 + 2] * f[2]);
+
+	return;
+}
+
+
+// The float version adds the products in double precision, as the old loop does.
+static ILvoid iLumFrom4_F(const ILfloat *s, ILfloat *d, ILuint Num, const ILfloat *f)
+{
+	ILuint			i = 0;
+
+#ifdef IL_USE_SSE2
+	const __m128	f0 = _mm_set1_ps(f[0]), f1 = _mm_set1_ps(f[1]), f2 = _mm_set1_ps(f[2]);
+	__m128			p0, p1, p2, p3;
+	__m128d			lo, hi;
+
+	for (; i + 4 <= Num; i += 4) {
+		p0 = _mm_loadu_ps(s + i * 4);
+		p1 = _mm_loadu_ps(s + i * 4 + 4);
+		p2 = _mm_loadu_ps(s + i * 4 + 8);
+		p3 = _mm_loadu_ps(s + i * 4 + 12);
+		_MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+		p0 = _mm_mul_ps(p0, f0);
+		p1 = _mm_mul_ps(p1, f1);
+		p2 = _mm_mul_ps(p2, f2);
+		lo = _mm_add_pd(_mm_add_pd(_mm_cvtps_pd(p0), _mm_cvtps_pd(p1)), _mm_cvtps_pd(p2));
+		hi = _mm_add_pd(_mm_add_pd(_mm_cvtps_pd(_mm_movehl_ps(p0, p0)), _mm_cvtps_pd(_mm_movehl_ps(p1, p1))),
+			_mm_cvtps_pd(_mm_movehl_ps(p2, p2)));
+		_mm_storeu_ps(d + i, _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi)));
+	}
+#endif
+	for (; i < Num; i++)
+		d[i] = (ILfloat)((ILdouble)(s[i * 4] * f[0]) + (ILdouble)(s[i * 4 + 1] * f[1]) + (ILdouble)(s[i * 4 + 2] * f[2]));
+
+	return;
+}
+
+
+static ILvoid iRgbaToLum_8(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	iLumFrom4_8((const ILubyte*)Src, (ILubyte*)Dest, Num, LumFactor);
+	return;
+}
+
+static ILvoid iBgraToLum_8(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	iLumFrom4_8((const ILubyte*)Src, (ILubyte*)Dest, Num, LumFactorRev);
+	return;
+}
+
+static ILvoid iRgbaToLum_F(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	iLumFrom4_F((const ILfloat*)Src, (ILfloat*)Dest, Num, LumFactor);
+	return;
+}
+
+static ILvoid iBgraToLum_F(const ILvoid *Src, ILvoid *Dest, ILuint Num)
+{
+	iLumFrom4_F((const ILfloat*)Src, (ILfloat*)Dest, Num, LumFactorRev);
+	return;
+}
+
+
+//
+// Lookup
+//
+
+typedef struct iTypeKernel
+{
+	ILenum		SrcType, DestType;
+	iConvFunc	Func;
+} iTypeKernel;
+
+typedef struct iFormatKernel
+{
+	ILenum		SrcFormat, DestFormat, DestType;
+	iConvFunc	Func;
+} iFormatKernel;
+
+static const iTypeKernel TypeKernels[] =
+{
+	{ IL_UNSIGNED_BYTE,  IL_UNSIGNED_SHORT, iUbyteToUshort },
+	{ IL_UNSIGNED_SHORT, IL_UNSIGNED_BYTE,  iUshortToUbyte },
+	{ IL_UNSIGNED_BYTE,  IL_FLOAT,          iUbyteToFloat },
+	{ IL_UNSIGNED_SHORT, IL_FLOAT,          iUshortToFloat },
+	{ IL_FLOAT,          IL_UNSIGNED_BYTE,  iFloatToUbyte },
+	{ IL_FLOAT,          IL_UNSIGNED_SHORT, iFloatToUshort },
+};
+
+static const iFormatKernel FormatKernels[] =
+{
+	{ IL_RGBA,      IL_BGRA,      IL_UNSIGNED_BYTE,  iSwap4_8 },
+	{ IL_BGRA,      IL_RGBA,      IL_UNSIGNED_BYTE,  iSwap4_8 },
+	{ IL_RGB,       IL_RGBA,      IL_UNSIGNED_BYTE,  iExpand_8 },
+	{ IL_BGR,       IL_BGRA,      IL_UNSIGNED_BYTE,  iExpand_8 },
+	{ IL_RGB,       IL_BGRA,      IL_UNSIGNED_BYTE,  iExpandSwap_8 },
+	{ IL_BGR,       IL_RGBA,      IL_UNSIGNED_BYTE,  iExpandSwap_8 },
+	{ IL_RGBA,      IL_RGB,       IL_UNSIGNED_BYTE,  iDrop_8 },
+	{ IL_BGRA,      IL_BGR,       IL_UNSIGNED_BYTE,  iDrop_8 },
+	{ IL_RGBA,      IL_BGR,       IL_UNSIGNED_BYTE,  iDropSwap_8 },
+	{ IL_BGRA,      IL_RGB,       IL_UNSIGNED_BYTE,  iDropSwap_8 },
+	{ IL_LUMINANCE, IL_RGBA,      IL_UNSIGNED_BYTE,  iLumTo4_8 },
+	{ IL_LUMINANCE, IL_BGRA,      IL_UNSIGNED_BYTE,  iLumTo4_8 },
+	{ IL_RGBA,      IL_LUMINANCE, IL_UNSIGNED_BYTE,  iRgbaToLum_8 },
+	{ IL_BGRA,      IL_LUMINANCE, IL_UNSIGNED_BYTE,  iBgraToLum_8 },
+
+	{ IL_RGBA,      IL_BGRA,      IL_UNSIGNED_SHORT, iSwap4_16 },
+	{ IL_BGRA,      IL_RGBA,      IL_UNSIGNED_SHORT, iSwap4_16 },
+	{ IL_RGB,       IL_RGBA,      IL_UNSIGNED_SHORT, iExpand_16 },
+	{ IL_BGR,       IL_BGRA,      IL_UNSIGNED_SHORT, iExpand_16 },
+	{ IL_RGB,       IL_BGRA,      IL_UNSIGNED_SHORT, iExpandSwap_16 },
+	{ IL_BGR,       IL_RGBA,      IL_UNSIGNED_SHORT, iExpandSwap_16 },
+	{ IL_RGBA,      IL_RGB,       IL_UNSIGNED_SHORT, iDrop_16 },
+	{ IL_BGRA,      IL_BGR,       IL_UNSIGNED_SHORT, iDrop_16 },
+	{ IL_RGBA,      IL_BGR,       IL_UNSIGNED_SHORT, iDropSwap_16 },
+	{ IL_BGRA,      IL_RGB,       IL_UNSIGNED_SHORT, iDropSwap_16 },
+	{ IL_LUMINANCE, IL_RGBA,      IL_UNSIGNED_SHORT, iLumTo4_16 },
+	{ IL_LUMINANCE, IL_BGRA,      IL_UNSIGNED_SHORT, iLumTo4_16 },
+
+	{ IL_RGBA,      IL_BGRA,      IL_FLOAT,          iSwap4_32 },
+	{ IL_BGRA,      IL_RGBA,      IL_FLOAT,          iSwap4_32 },
+	{ IL_RGB,       IL_RGBA,      IL_FLOAT,          iExpand_F },
+	{ IL_BGR,       IL_BGRA,      IL_FLOAT,          iExpand_F },
+	{ IL_RGB,       IL_BGRA,      IL_FLOAT,          iExpandSwap_F },
+	{ IL_BGR,       IL_RGBA,      IL_FLOAT,          iExpandSwap_F },
+	{ IL_RGBA,      IL_RGB,       IL_FLOAT,          iDrop_32 },
+	{ IL_BGRA,      IL_BGR,       IL_FLOAT,          iDrop_32 },
+	{ IL_RGBA,      IL_BGR,       IL_FLOAT,          iDropSwap_32 },
+	{ IL_BGRA,      IL_RGB,       IL_FLOAT,          iDropSwap_32 },
+	{ IL_LUMINANCE, IL_RGBA,      IL_FLOAT,          iLumTo4_F },
+	{ IL_LUMINANCE, IL_BGRA,      IL_FLOAT,          iLumTo4_F },
+	{ IL_RGBA,      IL_LUMINANCE, IL_FLOAT,          iRgbaToLum_F },
+	{ IL_BGRA,      IL_LUMINANCE, IL_FLOAT,          iBgraToLum_F },
+};
+
+
+// The old code handles signed and unsigned types of the same size alike,
+//	except when converting to floating point.
+static ILenum iUnsignedType(ILenum Type)
+{
+	if (Type == IL_BYTE)
+		return IL_UNSIGNED_BYTE;
+	if (Type == IL_SHORT)
+		return IL_UNSIGNED_SHORT;
+	return Type;
+}
+
+
+// Finds the kernels converting SrcFormat/SrcType to DestFormat/DestType.
+//	Returns IL_FALSE if there is no fast path or nothing has to be done.
+ILboolean iGetConvPath(ILenum SrcFormat, ILenum SrcType, ILenum DestFormat, ILenum DestType, iConvPath *Path)
+{
+	ILuint	BpcSrc, BpcDest, i;
+	ILenum	SrcKey, DestKey;
+
+	BpcSrc = ilGetBpcType(SrcType);
+	BpcDest = ilGetBpcType(DestType);
+	Path->Channels = ilGetBppFormat(SrcFormat);
+	if (BpcSrc == 0 || BpcDest == 0 || Path->Channels == 0 || ilGetBppFormat(DestFormat) == 0)
+		return IL_FALSE;
+	Path->SrcBpp = Path->Channels * BpcSrc;
+	Path->DestBpp = ilGetBppFormat(DestFormat) * BpcDest;
+
+	// Like iSwitchTypes(), types of the same size are taken as they are.
+	//	Integers read as floats (and back) are left to the old code.
+	Path->Type = NULL;
+	if (BpcSrc == BpcDest && iUnsignedType(SrcType) != iUnsignedType(DestType))
+		return IL_FALSE;
+	if (BpcSrc != BpcDest) {
+		SrcKey = DestType == IL_FLOAT ? SrcType : iUnsignedType(SrcType);
+		DestKey = iUnsignedType(DestType);
+		for (i = 0; i < sizeof(TypeKernels) / sizeof(TypeKernels[0]); i++) {
+			if (TypeKernels[i].SrcType == SrcKey && TypeKernels[i].DestType == DestKey) {
+				Path->Type = TypeKernels[i].Func;
+				break;
+			}
+		}
+		if (Path->Type == NULL)
+			return IL_FALSE;
+	}
+
+	// The format step sees data of DestType, whatever it was before.
+	Path->Format = NULL;
+	if (SrcFormat != DestFormat) {
+		DestKey = iUnsignedType(DestType);
+		for (i = 0; i < sizeof(FormatKernels) / sizeof(FormatKernels[0]); i++) {
+			if (FormatKernels[i].SrcFormat == SrcFormat && FormatKernels[i].DestFormat == DestFormat
+				&& FormatKernels[i].DestType == DestKey) {
+				Path->Format = FormatKernels[i].Func;
+				break;
+			}
+		}
+		if (Path->Format == NULL)
+			return IL_FALSE;
+	}
+
+	return Path->Type != NULL || Path->Format != NULL;
+}
+
+
+// Converts NumPix pixels in one pass.  When both steps are needed, each chunk
+//	goes through a small buffer on the stack instead of a whole intermediate image.
+ILvoid iRunConvPath(const iConvPath *Path, const ILvoid *Src, ILvoid *Dest, ILuint NumPix)
+{
+	ILint	Chunks = (ILint)((NumPix + IL_CONV_CHUNK - 1) / IL_CONV_CHUNK), c;
+
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static) if (NumPix >= 65536)
+#endif
+	for (c = 0; c < Chunks; c++) {
+		ILuint			First = (ILuint)c * IL_CONV_CHUNK;
+		ILuint			Num = IL_MIN(IL_CONV_CHUNK, NumPix - First);
+		const ILubyte	*s = (const ILubyte*)Src + First * Path->SrcBpp;
+		ILubyte			*d = (ILubyte*)Dest + First * Path->DestBpp;
+		ILfloat			Temp[IL_CONV_CHUNK * 4];  // Up to 4 channels of 4 bytes
+
+		if (Path->Type == NULL)
+			Path->Format(s, d, Num);
+		else if (Path->Format == NULL)
+			Path->Type(s, d, Num * Path->Channels);
+		else {
+			Path->Type(s, Temp, Num * Path->Channels);
+			Path->Format(Temp, d, Num);
+		}
+	}
+
+	return;
+}
+
+
+//
+// Half-floats
+//
+
+//stolen from OpenEXR
+static ILuint halfToFloat(ILushort y)
+{
+	int s = (y >> 15) & 0x00000001;
+	int e = (y >> 10) & 0x0000001f;
+	int m =  y		  & 0x000003ff;
+
+	if (e == 0)
+	{
+		if (m == 0)
+		{
+			//
+			// Plus or minus zero
+			//
+
+			return s << 31;
+		}
+		else
+		{
+			//
+			// Denormalized number -- renormalize it
+			//
+
+			while (!(m & 0x00000400))
+			{
+				m <<= 1;
+				e -=  1;
+			}
+
+			e += 1;
+			m &= ~0x00000400;
+		}
+	}
+	else if (e == 31)
+	{
+		if (m == 0)
+		{
+			//
+			// Positive or negative infinity
+			//
+
+			return (s << 31) | 0x7f800000;
+		}
+		else
+		{
+			//
+			// Nan -- preserve sign and significand bits
+			//
+
+			return (s << 31) | 0x7f800000 | (m << 13);
+		}
+	}
+
+	//
+	// Normalized number
+	//
+
+	e = e + (127 - 15);
+	m = m << 13;
+
+	//
+	// Assemble s, e and m.
+	//
+
+	return (s << 31) | (e << 23) | m;
+}
+
+
+ILvoid iHalfToFloat(const ILushort *Src, ILfloat *Dest, ILuint Num)
+{
+	ILuint	i = 0, Bits;
+
+#ifdef IL_USE_SSE2
+	// Exponent and mantissa moved into place and rebiased; infinities and NaNs
+	//	get the rest of the exponent range, zeros and denormals are renormalised
+	//	by subtracting 2^-14 in floating point, which is exact.
+	const __m128i	Zero = _mm_setzero_si128(), ExpMask = _mm_set1_epi32(0x7C00 << 13);
+	const __m128i	Rebias = _mm_set1_epi32((127 - 15) << 23), InfRebias = _mm_set1_epi32((128 - 16) << 23);
+	const __m128i	One = _mm_set1_epi32(1 << 23), Magic = _mm_set1_epi32(113 << 23);
+	__m128i			h, o, e, Small, Norm;
+
+	for (; i + 4 <= Num; i += 4) {
+		h = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(Src + i)), Zero);
+		o = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7FFF)), 13);
+		e = _mm_and_si128(o, ExpMask);
+		o = _mm_add_epi32(o, Rebias);
+		o = _mm_add_epi32(o, _mm_and_si128(_mm_cmpeq_epi32(e, ExpMask), InfRebias));
+		Small = _mm_cmpeq_epi32(e, Zero);
+		Norm = _mm_castps_si128(_mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(o, One)), _mm_castsi128_ps(Magic)));
+		o = _mm_or_si128(_mm_andnot_si128(Small, o), _mm_and_si128(Small, Norm));
+		o = _mm_or_si128(o, _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16));
+		_mm_storeu_si128((__m128i*)(Dest + i), o);
+	}
+#endif
+	for (; i < Num; i++) {
+		Bits = halfToFloat(Src[i]);
+		memcpy(Dest + i, &Bits, sizeof(ILfloat));
+	}
+
+	return;
+}
+
+
+// Scalar version of iFloatToHalf().  Half denormals come from adding a magic
+//	number that lines the 10 mantissa bits up at the bottom of the float, so
+//	the FPU does the rounding.
+static ILushort iFloatToHalfBits(ILuint f)
+{
+	const ILuint	Sign = f & 0x80000000, Magic = ((127 - 15) + (23 - 10) + 1) << 23;
+	ILfloat			m, n;
+	ILuint			o;
+
+	f ^= Sign;
+	if (f >= (127 + 16) << 23) {
+		o = f > 0x7F800000 ? 0x7E00 : 0x7C00;  // NaNs stay NaNs, too large goes to infinity
+	}
+	else if (f < 113 << 23) {
+		memcpy(&m, &f, sizeof(ILfloat));
+		memcpy(&n, &Magic, sizeof(ILfloat));
+		m += n;
+		memcpy(&f, &m, sizeof(ILfloat));
+		o = f - Magic;
+	}
+	else {
+		// Rebias the exponent and round the 13 dropped bits to even.
+		f += ((ILuint)(15 - 127) << 23) + 0xFFF + ((f >> 13) & 1);
+		o = f >> 13;
+	}
+
+	return (ILushort)(o | (Sign >> 16));
+}
+
+
+ILvoid iFloatToHalf(const ILfloat *Src, ILushort *Dest, ILuint Num)
+{
+	ILuint	i = 0, Bits;
+
+#ifdef IL_USE_SSE2
+	const __m128i	SignMask = _mm_set1_epi32((int)0x80000000), Inf = _mm_set1_epi32(0x7F800000);
+	const __m128i	Max = _mm_set1_epi32((127 + 16) << 23), MinNormal = _mm_set1_epi32(113 << 23);
+	const __m128i	Magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+	const __m128i	Rebias = _mm_set1_epi32(((ILuint)(15 - 127) << 23) + 0xFFF), One = _mm_set1_epi32(1);
+	__m128i			f, s, o, Big, Small, Norm, Den, Special;
+
+	// Same three cases as iFloatToHalfBits(), selected with masks.  The values
+	//	are positive after taking the sign off, so signed compares work.
+	for (; i + 4 <= Num; i += 4) {
+		f = _mm_loadu_si128((const __m128i*)(Src + i));
+		s = _mm_and_si128(f, SignMask);
+		f = _mm_xor_si128(f, s);
+		Big = _mm_cmpgt_epi32(f, _mm_sub_epi32(Max, One));
+		Small = _mm_cmplt_epi32(f, MinNormal);
+		Special = _mm_or_si128(_mm_set1_epi32(0x7C00), _mm_and_si128(_mm_cmpgt_epi32(f, Inf), _mm_set1_epi32(0x0200)));
+		Den = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(f), _mm_castsi128_ps(Magic))), Magic);
+		Norm = _mm_add_epi32(_mm_add_epi32(f, Rebias), _mm_and_si128(_mm_srli_epi32(f, 13), One));
+		Norm = _mm_srli_epi32(Norm, 13);
+		o = _mm_or_si128(_mm_and_si128(Small, Den), _mm_andnot_si128(Small, Norm));
+		o = _mm_or_si128(_mm_and_si128(Big, Special), _mm_andnot_si128(Big, o));
+		o = _mm_or_si128(o, _mm_srli_epi32(s, 16));
+		// 32 -> 16 bits:  the values fit in 16 bits, so move them into the signed range for the pack.
+		o = _mm_sub_epi32(o, _mm_set1_epi32(0x8000));
+		o = _mm_xor_si128(_mm_packs_epi32(o, o), _mm_set1_epi16((short)0x8000));
+		_mm_storel_epi64((__m128i*)(Dest + i), o);
+	}
+#endif
+	for (; i < Num; i++) {
+		memcpy(&Bits, Src + i, sizeof(ILuint));
+		Dest[i] = iFloatToHalfBits(Bits);
+	}
+
+	return;
+}
@@ -0,0 +1,41 @@
+//-----------------------------------------------------------------------------
+//
+// ImageLib Sources
+// Copyright (C) 2000-2002 by Denton Woods
+// Last modified: 10/19/2026
+//
+// Filename: src-IL/include/il_convfast.h
+//
+// Description: Single-pass conversion of the common format/type pairs
+//
+//-----------------------------------------------------------------------------
+
+#ifndef CONVFAST_H
+#define CONVFAST_H
+
+#include "il_internal.h"
+
+
+// Converts Num elements (type kernels) or Num pixels (format kernels) from Src to Dest.
+typedef ILvoid (*iConvFunc)(const ILvoid *Src, ILvoid *Dest, ILuint Num);
+
+// One conversion as found by iGetConvPath().  Type runs first, then Format,
+//	exactly like iSwitchTypes() followed by the format switch of ilConvertBuffer().
+typedef struct iConvPath
+{
+	iConvFunc	Type;			// NULL if both types share a representation
+	iConvFunc	Format;			// NULL if the formats are the same
+	ILuint		SrcBpp;			// Bytes per source pixel
+	ILuint		DestBpp;		// Bytes per destination pixel
+	ILuint		Channels;		// Channels of the source format
+} iConvPath;
+
+ILboolean	iGetConvPath(ILenum SrcFormat, ILenum SrcType, ILenum DestFormat, ILenum DestType, iConvPath *Path);
+ILvoid		iRunConvPath(const iConvPath *Path, const ILvoid *Src, ILvoid *Dest, ILuint NumPix);
+
+// Half-float (1-5-10) to float, bit-exact for zeros, denormals, infinities and NaNs.
+ILvoid		iHalfToFloat(const ILushort *Src, ILfloat *Dest, ILuint Num);
+// Float to half-float, rounded to nearest even; overflows give infinity.
+ILvoid		iFloatToHalf(const ILfloat *Src, ILushort *Dest, ILuint Num);
+
+#endif//CONVFAST_H
@@ -27,15 +27,16 @@
 #include "il_internal.h"
 #ifndef IL_NO_DDS
 #include "il_dds.h"
+#include "il_convfast.h"
 
 
-// Global variables
-static DDSHEAD	Head;			// Image header
-static ILubyte	*CompData;		// Compressed data
-static ILuint	CompSize;		// Compressed size
-static ILuint	CompFormat;		// Compressed format
-static ILimage	*Image;
-static ILint	Width, Height, Depth;
+// Loader scratch, private to the thread doing the load
+static IL_THREAD_LOCAL DDSHEAD	Head;			// Image header
+static IL_THREAD_LOCAL ILubyte	*CompData;		// Compressed data
+static IL_THREAD_LOCAL ILuint	CompSize;		// Compressed size
+static IL_THREAD_LOCAL ILuint	CompFormat;		// Compressed format
+static IL_THREAD_LOCAL ILimage	*Image;
+static IL_THREAD_LOCAL ILint	Width, Height, Depth;
 
 ILuint CubemapDirections[CUBEMAP_SIDES] = {
 	DDS_CUBEMAP_POSITIVEX,
@@ -256,7 +257,7 @@ ILubyte iCompFormatToChannelCount(ILenum Format)
 
 ILboolean iLoadDdsCubemapInternal()
 {
-	ILuint	i;
+	ILuint	i, Levels, FaceLinear;
 	ILubyte	Bpp, Channels, Bpc;
 	ILimage *startImage;
 
@@ -270,12 +271,14 @@ ILboolean iLoadDdsCubemapInternal()
 	}
 
 	startImage = Image;
+	FaceLinear = Head.LinearSize;
 	// run through cube map possibilities
 	for (i = 0; i < CUBEMAP_SIDES; i++) {
 		// reset each time
 		Width = Head.Width;
 		Height = Head.Height;
 		Depth = Head.Depth;
+		Head.LinearSize = FaceLinear;
 		if (Head.ddsCaps2 & CubemapDirections[i]) {
 			if (i != 0) {
 				Image->Next = ilNewImage(Width, Height, Depth, Channels, Bpc);
@@ -300,6 +303,10 @@ ILboolean iLoadDdsCubemapInternal()
 				ilActiveImage(i); //now Image == iCurImage...globals SUCK, fix this!!!
 			}
 
+			Levels = iSkipMipmaps();
+			if (Levels == 0)
+				return IL_FALSE;
+
 			if (!ReadData())
 				return IL_FALSE;
 
@@ -321,7 +328,7 @@ ILboolean iLoadDdsCubemapInternal()
 				return IL_FALSE;
 			}
 
-			if (!ReadMipmaps()) {
+			if (!ReadMipmaps(Levels)) {
 				if (CompData) {
 					ifree(CompData);
 					CompData = NULL;
@@ -343,7 +350,7 @@ ILboolean iLoadDdsCubemapInternal()
 
 ILboolean iLoadDdsInternal()
 {
-	ILuint BlockSize = 0;
+	ILuint BlockSize = 0, Levels;
 
 	CompData = NULL;
 	Image = NULL;
@@ -375,6 +382,13 @@ ILboolean iLoadDdsInternal()
 		Head.LinearSize = BlockSize;
 	}
 
+	if (!(Head.Flags1 & DDS_MIPMAPCOUNT) || Head.MipMapCount == 0) {
+		//some .dds-files have their mipmap flag set,
+		//but a mipmapcount of 0. Because mipMapCount is an uint, 0 - 1 gives
+		//overflow - don't let this happen:
+		Head.MipMapCount = 1;
+	}
+
 	Image = iCurImage;
 	if (Head.ddsCaps1 & DDS_COMPLEX) {
 		if (Head.ddsCaps2 & DDS_CUBEMAP) {
@@ -389,6 +403,10 @@ ILboolean iLoadDdsInternal()
 	Depth = Head.Depth;
 	AdjustVolumeTexture(&Head);
 
+	Levels = iSkipMipmaps();
+	if (Levels == 0)
+		return IL_FALSE;
+
 	if (!ReadData())
 		return IL_FALSE;
 	if (!AllocImage()) {
@@ -406,7 +424,7 @@ ILboolean iLoadDdsInternal()
 		return IL_FALSE;
 	}
 
-	if (!ReadMipmaps()) {
+	if (!ReadMipmaps(Levels)) {
 		if (CompData) {
 			ifree(CompData);
 			CompData = NULL;
@@ -610,6 +628,7 @@ ILboolean ReadData()
 	if (Head.Flags1 & DDS_LINEARSIZE) {
 		//Head.LinearSize = Head.LinearSize * Depth;
 
+		CompSize = Head.LinearSize;
 		CompData = (ILubyte*)ialloc(Head.LinearSize);
 		if (CompData == NULL) {
 			return IL_FALSE;
@@ -802,20 +821,53 @@ ILboolean Decompress()
 }
 
 
-ILboolean ReadMipmaps()
+// Bytes ReadData() reads for the current level.
+static ILuint iLevelDataSize()
 {
-	ILuint	i, CompFactor=0;
-	ILubyte	Bpp, Channels, Bpc;
-	ILimage	*StartImage, *TempImage;
-	ILuint	LastLinear;
-	ILuint	minW, minH;
-	ILboolean isCompressed = IL_FALSE;
+	if (Head.Flags1 & DDS_LINEARSIZE)
+		return Head.LinearSize;
+	return Width * Head.RGBBitCount / 8 * Height * Depth;
+}
 
-	Bpp = iCompFormatToBpp(CompFormat);
-	Channels = iCompFormatToChannelCount(CompFormat);
-	Bpc = iCompFormatToBpc(CompFormat);
-	if(CompFormat == PF_LUMINANCE && Head.RGBBitCount == 16 && Head.RBitMask == 0xFFFF) { //HACK
-		Bpc = 2; Bpp = 2;
+
+// Moves Width, Height, Depth and Head.LinearSize one level down the mipmap chain.
+static ILvoid iNextMipLevel(ILubyte Bpp, ILboolean *Compressed)
+{
+	ILuint	CompFactor, minW, minH;
+
+	Depth = Depth / 2;
+	Width = Width / 2;
+	Height = Height / 2;
+
+	if (Depth == 0) 
+		Depth = 1;
+	if (Width == 0) 
+		Width = 1;
+	if (Height == 0) 
+		Height = 1;
+
+	*Compressed = IL_FALSE;
+	if (!(Head.Flags1 & DDS_LINEARSIZE)) {
+		Head.LinearSize >>= 1;
+		return;
+	}
+
+	if (CompFormat == PF_R16F
+		|| CompFormat == PF_G16R16F
+		|| CompFormat == PF_A16B16G16R16F
+		|| CompFormat == PF_R32F
+		|| CompFormat == PF_G32R32F
+		|| CompFormat == PF_A32B32G32R32F
+		|| CompFormat == PF_A16B16G16R16) {
+		Head.LinearSize = Width * Height * Depth * Bpp;
+		return;
+	}
+	if (CompFormat == PF_RGB || CompFormat == PF_ARGB
+		|| CompFormat == PF_LUMINANCE
+		|| CompFormat == PF_LUMINANCE_ALPHA) {
+		//don't use Bpp to support argb images with less than 32 bits
+		Head.LinearSize = Width * Height * Depth * (Head.RGBBitCount >> 3);
+		return;
 	}
 
 	//This doesn't work for images which first mipmap (= the image
@@ -848,27 +900,66 @@ ILboolean ReadMipmaps()
 			CompFactor = 1;
 	}
 
-	StartImage = Image;
+	//compressed format
+	minW = (((Width+3)/4))*4;
+	minH = (((Height+3)/4))*4;
+	Head.LinearSize = (minW * minH * Depth * Bpp) / CompFactor;
+	*Compressed = IL_TRUE;
 
-	if (!(Head.Flags1 & DDS_MIPMAPCOUNT) || Head.MipMapCount == 0) {
-		//some .dds-files have their mipmap flag set,
-		//but a mipmapcount of 0. Because mipMapCount is an uint, 0 - 1 gives
-		//overflow - don't let this happen:
-		Head.MipMapCount = 1;
+	return;
+}
+
+
+// Seeks past the first IL_DXTC_MIPMAP_SKIP levels of the surface about to be
+//	read, so it starts at the first level that is kept.  Returns the number of
+//	levels left in its chain, 0 on failure.
+ILuint iSkipMipmaps()
+{
+	ILint		Skip = ilGetInteger(IL_DXTC_MIPMAP_SKIP);
+	ILuint		Levels = Head.MipMapCount;
+	ILboolean	Compressed;
+
+	for (; Skip > 0 && Levels > 1; Skip--, Levels--) {
+		if (iseek(iLevelDataSize(), IL_SEEK_CUR))
+			return 0;
+		iNextMipLevel(iCompFormatToBpp(CompFormat), &Compressed);
 	}
 
+	return Levels;
+}
+
+
+// Reads the Levels - 1 mipmaps following the current surface, decoding no
+//	more than IL_DXTC_MIPMAP_COUNT of them.
+ILboolean ReadMipmaps(ILuint Levels)
+{
+	ILuint	i;
+	ILint	Count;
+	ILubyte	Bpp, Channels, Bpc;
+	ILimage	*StartImage, *TempImage;
+	ILuint	LastLinear;
+	ILboolean isCompressed = IL_FALSE;
+
+	Bpp = iCompFormatToBpp(CompFormat);
+	Channels = iCompFormatToChannelCount(CompFormat);
+	Bpc = iCompFormatToBpc(CompFormat);
+	if(CompFormat == PF_LUMINANCE && Head.RGBBitCount == 16 && Head.RBitMask == 0xFFFF) { //HACK
+		Bpc = 2; Bpp = 2;
+	}
+
+	StartImage = Image;
+	Count = ilGetInteger(IL_DXTC_MIPMAP_COUNT);
+
 	LastLinear = Head.LinearSize;
-	for (i = 0; i < Head.MipMapCount - 1; i++) {
-		Depth = Depth / 2;
-		Width = Width / 2;
-		Height = Height / 2;
-
-		if (Depth == 0) 
-			Depth = 1;
-		if (Width == 0) 
-			Width = 1;
-		if (Height == 0) 
-			Height = 1;
+	for (i = 0; i < Levels - 1; i++) {
+		iNextMipLevel(Bpp, &isCompressed);
+
+		if (Count >= 0 && i >= (ILuint)Count) {
+			// Not decoded, but the next cube face starts after it.
+			if (iseek(iLevelDataSize(), IL_SEEK_CUR))
+				goto mip_fail;
+			continue;
+		}
 
 		Image->Next = ilNewImage(Width, Height, Depth, Channels, Bpc);
 		if (Image->Next == NULL)
@@ -883,31 +974,11 @@ ILboolean ReadMipmaps()
 				|| CompFormat == PF_R32F
 				|| CompFormat == PF_G32R32F
 				|| CompFormat == PF_A32B32G32R32F) {
-				Head.LinearSize = Width * Height * Depth * Bpp;
-
 				//DevIL's format autodetection doesn't work for
 				//float images...correct this
 				Image->Type = IL_FLOAT;
 				Image->Bpp = Channels;
 			}
-			else if (CompFormat == PF_A16B16G16R16)
-				Head.LinearSize = Width * Height * Depth * Bpp;
-			else if (CompFormat != PF_RGB && CompFormat != PF_ARGB
-				&& CompFormat != PF_LUMINANCE
-				&& CompFormat != PF_LUMINANCE_ALPHA) {
-				//compressed format
-				minW = (((Width+3)/4))*4;
-				minH = (((Height+3)/4))*4;
-				Head.LinearSize = (minW * minH * Depth * Bpp) / CompFactor;
-				isCompressed = IL_TRUE;
-			}
-			else {
-				//don't use Bpp to support argb images with less than 32 bits
-				Head.LinearSize = Width * Height * Depth * (Head.RGBBitCount >> 3);
-			}
-		}
-		else {
-			Head.LinearSize >>= 1;
 		}
 
 		if (!ReadData())
@@ -945,6 +1016,7 @@ mip_fail:
 	return IL_FALSE;
 }
 
+
 ILvoid ReadColors(const ILubyte* Data, Color8888* Out)
 {
 	ILubyte r0, g0, b0, r1, g1, b1;
@@ -979,299 +1051,299 @@ ILvoid ReadColor(ILushort Data, Color8888* Out)
 	Out->b = b << 3;
 }
 
-ILboolean DecompressDXT1()
+//
+// BCn block decoding
+//
+// Every decoder below turns one compressed 4x4 block into 4 rows of pixels,
+//	Bps bytes apart.  Rows of blocks do not depend on each other, so
+//	iDecompressBlocks() hands them out to threads.  Blocks that are cut by
+//	the right or bottom edge are decoded into a scratch block and clipped.
+//
+
+typedef ILvoid (*iBlockDecoder)(const ILubyte *Block, ILubyte *Dest, ILuint Bps);
+
+
+// The four colours of a DXT colour block as RGBA bytes.  DXT1 blocks with
+//	color_0 <= color_1 have three colours and a transparent black; DXT2-5
+//	always use the four-colour mode.
+static ILvoid iDxtColourPalette(const ILubyte *Block, ILboolean Dxt1, ILubyte *Pal)
 {
-	int			x, y, z, i, j, k, Select;
-	ILubyte		*Temp;
-	Color8888	colours[4], *col;
-	ILushort	color_0, color_1;
-	ILuint		bitmask, Offset;
+	ILuint	c0 = Block[0] | (Block[1] << 8);
+	ILuint	c1 = Block[2] | (Block[3] << 8);
+	ILuint	i;
 
-	if (!CompData)
-		return IL_FALSE;
+	Pal[0] = (ILubyte)((c0 >> 11) << 3);
+	Pal[1] = (ILubyte)(((c0 >> 5) & 0x3F) << 2);
+	Pal[2] = (ILubyte)((c0 & 0x1F) << 3);
+	Pal[3] = 0xFF;
+	Pal[4] = (ILubyte)((c1 >> 11) << 3);
+	Pal[5] = (ILubyte)(((c1 >> 5) & 0x3F) << 2);
+	Pal[6] = (ILubyte)((c1 & 0x1F) << 3);
+	Pal[7] = 0xFF;
+
+	for (i = 0; i < 3; i++) {
+		if (!Dxt1 || c0 > c1)
+			Pal[8 + i] = (ILubyte)((2 * Pal[i] + Pal[4 + i] + 1) / 3);
+		else
+			Pal[8 + i] = (ILubyte)((Pal[i] + Pal[4 + i]) / 2);
+		Pal[12 + i] = (ILubyte)((Pal[i] + 2 * Pal[4 + i] + 1) / 3);
+	}
+	Pal[11] = 0xFF;
+	Pal[15] = (!Dxt1 || c0 > c1) ? 0xFF : 0x00;
 
-	Temp = CompData;
-	colours[0].a = 0xFF;
-	colours[1].a = 0xFF;
-	colours[2].a = 0xFF;
-	//colours[3].a = 0xFF;
-	for (z = 0; z < Depth; z++) {
-		for (y = 0; y < Height; y += 4) {
-			for (x = 0; x < Width; x += 4) {
-				color_0 = *((ILushort*)Temp);
-				UShort(&color_0);
-				color_1 = *((ILushort*)(Temp + 2));
-				UShort(&color_1);
-				ReadColor(color_0, colours);
-				ReadColor(color_1, colours + 1);
-				bitmask = ((ILuint*)Temp)[1];
-				UInt(&bitmask);
-				Temp += 8;
-
-				if (color_0 > color_1) {
-					// Four-color block: derive the other two colors.
-					// 00 = color_0, 01 = color_1, 10 = color_2, 11 = color_3
-					// These 2-bit codes correspond to the 2-bit fields 
-					// stored in the 64-bit block.
-					colours[2].b = (2 * colours[0].b + colours[1].b + 1) / 3;
-					colours[2].g = (2 * colours[0].g + colours[1].g + 1) / 3;
-					colours[2].r = (2 * colours[0].r + colours[1].r + 1) / 3;
-					//colours[2].a = 0xFF;
-
-					colours[3].b = (colours[0].b + 2 * colours[1].b + 1) / 3;
-					colours[3].g = (colours[0].g + 2 * colours[1].g + 1) / 3;
-					colours[3].r = (colours[0].r + 2 * colours[1].r + 1) / 3;
-					colours[3].a = 0xFF;
-				}
-				else { 
-					// Three-color block: derive the other color.
-					// 00 = color_0,  01 = color_1,  10 = color_2,
-					// 11 = transparent.
-					// These 2-bit codes correspond to the 2-bit fields 
-					// stored in the 64-bit block. 
-					colours[2].b = (colours[0].b + colours[1].b) / 2;
-					colours[2].g = (colours[0].g + colours[1].g) / 2;
-					colours[2].r = (colours[0].r + colours[1].r) / 2;
-					//colours[2].a = 0xFF;
-
-					colours[3].b = (colours[0].b + 2 * colours[1].b + 1) / 3;
-					colours[3].g = (colours[0].g + 2 * colours[1].g + 1) / 3;
-					colours[3].r = (colours[0].r + 2 * colours[1].r + 1) / 3;
-					colours[3].a = 0x00;
-				}
+	return;
+}
 
-				for (j = 0, k = 0; j < 4; j++) {
-					for (i = 0; i < 4; i++, k++) {
 
-						Select = (bitmask & (0x03 << k*2)) >> k*2;
-						col = &colours[Select];
+// Writes the colour part of a DXT block, taking alpha from Alpha (16 values
+//	in pixel order) if it is not NULL.
+static ILvoid iDxtColourRows(const ILubyte *Block, ILboolean Dxt1, const ILubyte *Alpha, ILubyte *Dest, ILuint Bps)
+{
+	ILubyte	Pal[16];
+	ILuint	Bits, j;
+#ifdef IL_USE_SSE2
+	const __m128i	Shift = _mm_set_epi32(1, 4, 16, 64), Three = _mm_set1_epi32(3);
+	__m128i			P[4], A[4], Idx, Row;
+	ILint			Entry;
+#else
+	ILuint			i;
+#endif
+
+	iDxtColourPalette(Block, Dxt1, Pal);
+	Bits = Block[4] | (Block[5] << 8) | (Block[6] << 16) | ((ILuint)Block[7] << 24);
+
+#ifdef IL_USE_SSE2
+	for (j = 0; j < 4; j++) {
+		memcpy(&Entry, Pal + 4 * j, 4);
+		P[j] = _mm_set1_epi32(Entry);
+	}
+	if (Alpha != NULL) {
+		// Alpha bytes moved to the top byte of each pixel
+		__m128i a = _mm_loadu_si128((const __m128i*)Alpha), z = _mm_setzero_si128();
+		__m128i lo = _mm_unpacklo_epi8(z, a), hi = _mm_unpackhi_epi8(z, a);
+		A[0] = _mm_unpacklo_epi16(z, lo);
+		A[1] = _mm_unpackhi_epi16(z, lo);
+		A[2] = _mm_unpacklo_epi16(z, hi);
+		A[3] = _mm_unpackhi_epi16(z, hi);
+	}
 
-						if (((x + i) < Width) && ((y + j) < Height)) {
-							Offset = z * Image->SizeOfPlane + (y + j) * Image->Bps + (x + i) * Image->Bpp;
-							Image->Data[Offset + 0] = col->r;
-							Image->Data[Offset + 1] = col->g;
-							Image->Data[Offset + 2] = col->b;
-							Image->Data[Offset + 3] = col->a;
-						}
-					}
-				}
-			}
+	for (j = 0; j < 4; j++, Dest += Bps, Bits >>= 8) {
+		// Index of pixel i is (Bits >> 2i) & 3:  multiply by 2^(6-2i) and shift back by 6.
+		Idx = _mm_and_si128(_mm_srli_epi32(_mm_mullo_epi16(_mm_set1_epi32(Bits & 0xFF), Shift), 6), Three);
+		Row = _mm_or_si128(
+			_mm_or_si128(_mm_and_si128(_mm_cmpeq_epi32(Idx, _mm_setzero_si128()), P[0]),
+				_mm_and_si128(_mm_cmpeq_epi32(Idx, _mm_set1_epi32(1)), P[1])),
+			_mm_or_si128(_mm_and_si128(_mm_cmpeq_epi32(Idx, _mm_set1_epi32(2)), P[2]),
+				_mm_and_si128(_mm_cmpeq_epi32(Idx, Three), P[3])));
+		if (Alpha != NULL)
+			Row = _mm_or_si128(_mm_and_si128(Row, _mm_set1_epi32(0x00FFFFFF)), A[j]);
+		_mm_storeu_si128((__m128i*)Dest, Row);
+	}
+#else
+	for (j = 0; j < 4; j++, Dest += Bps) {
+		for (i = 0; i < 4; i++, Bits >>= 2) {
+			memcpy(Dest + 4 * i, Pal + 4 * (Bits & 0x03), 4);
+			if (Alpha != NULL)
+				Dest[4 * i + 3] = Alpha[4 * j + i];
 		}
 	}
+#endif
 
-	return IL_TRUE;
+	return;
 }
 
 
-ILboolean DecompressDXT2()
+// Looks up the sixteen 3-bit indices in Block[2..7] (DXT5 alpha, ATI1N and
+//	each half of 3Dc) in the 8-entry palette Pal, in pixel order.
+static ILvoid iPaletteIndices(const ILubyte *Block, const ILubyte *Pal, ILubyte *Out)
 {
-	// Can do color & alpha same as dxt3, but color is pre-multiplied 
-	//   so the result will be wrong unless corrected. 
-	if (!DecompressDXT3())
-		return IL_FALSE;
-	CorrectPreMult();
+	ILuint	Lo = Block[2] | (Block[3] << 8) | (Block[4] << 16);
+	ILuint	Hi = Block[5] | (Block[6] << 8) | (Block[7] << 16);
+#ifdef IL_USE_SSE2
+	// Each 12-bit group holds the indices of one row.  Lane i of a row is
+	//	multiplied by 2^(13-3i), which puts index i in its top three bits.
+	const __m128i	Shift = _mm_set_epi16(1 << 4, 1 << 7, 1 << 10, 1 << 13, 1 << 4, 1 << 7, 1 << 10, 1 << 13);
+	__m128i			Row01 = _mm_set_epi16((short)(Lo >> 12), (short)(Lo >> 12), (short)(Lo >> 12), (short)(Lo >> 12),
+							(short)(Lo & 0xFFF), (short)(Lo & 0xFFF), (short)(Lo & 0xFFF), (short)(Lo & 0xFFF));
+	__m128i			Row23 = _mm_set_epi16((short)(Hi >> 12), (short)(Hi >> 12), (short)(Hi >> 12), (short)(Hi >> 12),
+							(short)(Hi & 0xFFF), (short)(Hi & 0xFFF), (short)(Hi & 0xFFF), (short)(Hi & 0xFFF));
+	__m128i			Idx, Res = _mm_setzero_si128();
+	ILint			i;
+
+	Idx = _mm_packus_epi16(_mm_srli_epi16(_mm_mullo_epi16(Row01, Shift), 13),
+		_mm_srli_epi16(_mm_mullo_epi16(Row23, Shift), 13));
+	for (i = 0; i < 8; i++)
+		Res = _mm_or_si128(Res, _mm_and_si128(_mm_cmpeq_epi8(Idx, _mm_set1_epi8((char)i)), _mm_set1_epi8((char)Pal[i])));
+	_mm_storeu_si128((__m128i*)Out, Res);
+#else
+	ILuint	i;
 
-	return IL_TRUE;
+	for (i = 0; i < 8; i++, Lo >>= 3)
+		Out[i] = Pal[Lo & 0x07];
+	for (i = 8; i < 16; i++, Hi >>= 3)
+		Out[i] = Pal[Hi & 0x07];
+#endif
+
+	return;
 }
 
 
-ILboolean DecompressDXT3()
+static ILvoid iDecodeDxt1Block(const ILubyte *Block, ILubyte *Dest, ILuint Bps)
 {
-	int			x, y, z, i, j, k, Select;
-	ILubyte		*Temp;
-	//Color565	*color_0, *color_1;
-	Color8888	colours[4], *col;
-	ILuint		bitmask, Offset;
-	ILushort	word;
-	ILubyte *alpha;
+	iDxtColourRows(Block, IL_TRUE, NULL, Dest, Bps);
+	return;
+}
 
-	if (!CompData)
-		return IL_FALSE;
 
-	Temp = CompData;
-	for (z = 0; z < Depth; z++) {
-		for (y = 0; y < Height; y += 4) {
-			for (x = 0; x < Width; x += 4) {
-				alpha = Temp;
-				Temp += 8;
-				ReadColors(Temp, colours);
-				bitmask = ((ILuint*)Temp)[1];
-				UInt(&bitmask);
-				Temp += 8;
-
-				// Four-color block: derive the other two colors.    
-				// 00 = color_0, 01 = color_1, 10 = color_2, 11 = color_3
-				// These 2-bit codes correspond to the 2-bit fields 
-				// stored in the 64-bit block.
-				colours[2].b = (2 * colours[0].b + colours[1].b + 1) / 3;
-				colours[2].g = (2 * colours[0].g + colours[1].g + 1) / 3;
-				colours[2].r = (2 * colours[0].r + colours[1].r + 1) / 3;
-				//colours[2].a = 0xFF;
-
-				colours[3].b = (colours[0].b + 2 * colours[1].b + 1) / 3;
-				colours[3].g = (colours[0].g + 2 * colours[1].g + 1) / 3;
-				colours[3].r = (colours[0].r + 2 * colours[1].r + 1) / 3;
-				//colours[3].a = 0xFF;
-
-				k = 0;
-				for (j = 0; j < 4; j++) {
-					for (i = 0; i < 4; i++, k++) {
-
-						Select = (bitmask & (0x03 << k*2)) >> k*2;
-						col = &colours[Select];
-
-						if (((x + i) < Width) && ((y + j) < Height)) {
-							Offset = z * Image->SizeOfPlane + (y + j) * Image->Bps + (x + i) * Image->Bpp;
-							Image->Data[Offset + 0] = col->r;
-							Image->Data[Offset + 1] = col->g;
-							Image->Data[Offset + 2] = col->b;
-						}
-					}
-				}
+// Explicit 4-bit alpha
+static ILvoid iDecodeDxt3Block(const ILubyte *Block, ILubyte *Dest, ILuint Bps)
+{
+	ILubyte	Alpha[16];
+	ILuint	i;
 
-				for (j = 0; j < 4; j++) {
-					word = alpha[2*j] + 256*alpha[2*j+1];
-					for (i = 0; i < 4; i++) {
-						if (((x + i) < Width) && ((y + j) < Height)) {
-							Offset = z * Image->SizeOfPlane + (y + j) * Image->Bps + (x + i) * Image->Bpp + 3;
-							Image->Data[Offset] = word & 0x0F;
-							Image->Data[Offset] = Image->Data[Offset] | (Image->Data[Offset] << 4);
-						}
-						word >>= 4;
-					}
-				}
+	for (i = 0; i < 8; i++) {
+		Alpha[2 * i]     = (ILubyte)((Block[i] & 0x0F) * 0x11);
+		Alpha[2 * i + 1] = (ILubyte)((Block[i] >> 4) * 0x11);
+	}
+	iDxtColourRows(Block + 8, IL_FALSE, Alpha, Dest, Bps);
 
-			}
-		}
+	return;
+}
+
+
+// Interpolated 3-bit alpha
+static ILvoid iDecodeDxt5Block(const ILubyte *Block, ILubyte *Dest, ILuint Bps)
+{
+	ILubyte	Alphas[8], Alpha[16];
+	ILuint	a0 = Block[0], a1 = Block[1], i;
+
+	Alphas[0] = (ILubyte)a0;
+	Alphas[1] = (ILubyte)a1;
+	if (a0 > a1) {
+		// 8-alpha block:  derive the other six alphas.
+		for (i = 2; i < 8; i++)
+			Alphas[i] = (ILubyte)(((8 - i) * a0 + (i - 1) * a1 + 3) / 7);
+	}
+	else {
+		// 6-alpha block.
+		for (i = 2; i < 6; i++)
+			Alphas[i] = (ILubyte)(((6 - i) * a0 + (i - 1) * a1 + 2) / 5);
+		Alphas[6] = 0x00;
+		Alphas[7] = 0xFF;
 	}
 
-	return IL_TRUE;
+	iPaletteIndices(Block, Alphas, Alpha);
+	iDxtColourRows(Block + 8, IL_FALSE, Alpha, Dest, Bps);
+
+	return;
 }
 
 
-ILboolean DecompressDXT4()
+// Palette of an ATI1N block (also each half of a 3Dc block).
+static ILvoid iAtiPalette(const ILubyte *Block, ILubyte *Pal)
 {
-	// Can do color & alpha same as dxt5, but color is pre-multiplied 
-	//   so the result will be wrong unless corrected. 
-	if (!DecompressDXT5())
-		return IL_FALSE;
-	CorrectPreMult();
+	ILint t1 = Block[0], t2 = Block[1], i;
 
-	return IL_FALSE;
+	Pal[0] = (ILubyte)t1;
+	Pal[1] = (ILubyte)t2;
+	if (t1 > t2)
+		for (i = 2; i < 8; ++i)
+			Pal[i] = (ILubyte)(t1 + ((t2 - t1)*(i - 1))/7);
+	else {
+		for (i = 2; i < 6; ++i)
+			Pal[i] = (ILubyte)(t1 + ((t2 - t1)*(i - 1))/5);
+		Pal[6] = 0;
+		Pal[7] = 255;
+	}
+
+	return;
 }
 
 
-ILboolean DecompressDXT5()
+static ILvoid iDecodeAti1nBlock(const ILubyte *Block, ILubyte *Dest, ILuint Bps)
 {
-	int			x, y, z, i, j, k, Select;
-	ILubyte		*Temp; //, r0, g0, b0, r1, g1, b1;
-	Color8888	colours[4], *col;
-	ILuint		bitmask, Offset;
-	ILubyte		alphas[8], *alphamask;
-	ILuint		bits;
+	ILubyte	Pal[8], Lum[16];
+	ILuint	j;
 
-	if (!CompData)
-		return IL_FALSE;
+	iAtiPalette(Block, Pal);
+	iPaletteIndices(Block, Pal, Lum);
+	for (j = 0; j < 4; j++, Dest += Bps)
+		memcpy(Dest, Lum + 4 * j, 4);
 
-	Temp = CompData;
-	for (z = 0; z < Depth; z++) {
-		for (y = 0; y < Height; y += 4) {
-			for (x = 0; x < Width; x += 4) {
-				if (y >= Height || x >= Width)
-					break;
-				alphas[0] = Temp[0];
-				alphas[1] = Temp[1];
-				alphamask = Temp + 2;
-				Temp += 8;
-
-				ReadColors(Temp, colours);
-				bitmask = ((ILuint*)Temp)[1];
-				UInt(&bitmask);
-				Temp += 8;
-
-				// Four-color block: derive the other two colors.    
-				// 00 = color_0, 01 = color_1, 10 = color_2, 11 = color_3
-				// These 2-bit codes correspond to the 2-bit fields 
-				// stored in the 64-bit block.
-				colours[2].b = (2 * colours[0].b + colours[1].b + 1) / 3;
-				colours[2].g = (2 * colours[0].g + colours[1].g + 1) / 3;
-				colours[2].r = (2 * colours[0].r + colours[1].r + 1) / 3;
-				//colours[2].a = 0xFF;
-
-				colours[3].b = (colours[0].b + 2 * colours[1].b + 1) / 3;
-				colours[3].g = (colours[0].g + 2 * colours[1].g + 1) / 3;
-				colours[3].r = (colours[0].r + 2 * colours[1].r + 1) / 3;
-				//colours[3].a = 0xFF;
-
-				k = 0;
-				for (j = 0; j < 4; j++) {
-					for (i = 0; i < 4; i++, k++) {
-
-						Select = (bitmask & (0x03 << k*2)) >> k*2;
-						col = &colours[Select];
-
-						// only put pixels out < width or height
-						if (((x + i) < Width) && ((y + j) < Height)) {
-							Offset = z * Image->SizeOfPlane + (y + j) * Image->Bps + (x + i) * Image->Bpp;
-							Image->Data[Offset + 0] = col->r;
-							Image->Data[Offset + 1] = col->g;
-							Image->Data[Offset + 2] = col->b;
-						}
-					}
-				}
+	return;
+}
 
-				// 8-alpha or 6-alpha block?    
-				if (alphas[0] > alphas[1]) {    
-					// 8-alpha block:  derive the other six alphas.    
-					// Bit code 000 = alpha_0, 001 = alpha_1, others are interpolated.
-					alphas[2] = (6 * alphas[0] + 1 * alphas[1] + 3) / 7;	// bit code 010
-					alphas[3] = (5 * alphas[0] + 2 * alphas[1] + 3) / 7;	// bit code 011
-					alphas[4] = (4 * alphas[0] + 3 * alphas[1] + 3) / 7;	// bit code 100
-					alphas[5] = (3 * alphas[0] + 4 * alphas[1] + 3) / 7;	// bit code 101
-					alphas[6] = (2 * alphas[0] + 5 * alphas[1] + 3) / 7;	// bit code 110
-					alphas[7] = (1 * alphas[0] + 6 * alphas[1] + 3) / 7;	// bit code 111
-				}
-				else {
-					// 6-alpha block.
-					// Bit code 000 = alpha_0, 001 = alpha_1, others are interpolated.
-					alphas[2] = (4 * alphas[0] + 1 * alphas[1] + 2) / 5;	// Bit code 010
-					alphas[3] = (3 * alphas[0] + 2 * alphas[1] + 2) / 5;	// Bit code 011
-					alphas[4] = (2 * alphas[0] + 3 * alphas[1] + 2) / 5;	// Bit code 100
-					alphas[5] = (1 * alphas[0] + 4 * alphas[1] + 2) / 5;	// Bit code 101
-					alphas[6] = 0x00;										// Bit code 110
-					alphas[7] = 0xFF;										// Bit code 111
-				}
 
-				// Note: Have to separate the next two loops,
-				//	it operates on a 6-byte system.
-
-				// First three bytes
-				//bits = *((ILint*)alphamask);
-				bits = (alphamask[0]) | (alphamask[1] << 8) | (alphamask[2] << 16);
-				for (j = 0; j < 2; j++) {
-					for (i = 0; i < 4; i++) {
-						// only put pixels out < width or height
-						if (((x + i) < Width) && ((y + j) < Height)) {
-							Offset = z * Image->SizeOfPlane + (y + j) * Image->Bps + (x + i) * Image->Bpp + 3;
-							Image->Data[Offset] = alphas[bits & 0x07];
-						}
-						bits >>= 3;
-					}
-				}
+// The second half holds x (red), the first y (green); z is rebuilt so the
+//	normal has unit length.
+static ILvoid iDecode3DcBlock(const ILubyte *Block, ILubyte *Dest, ILuint Bps)
+{
+	ILubyte	XPal[8], YPal[8], X[16], Y[16];
+	ILint	i, j, t, tx, ty;
+
+	iAtiPalette(Block, YPal);
+	iPaletteIndices(Block, YPal, Y);
+	iAtiPalette(Block + 8, XPal);
+	iPaletteIndices(Block + 8, XPal, X);
+
+	for (j = 0; j < 4; j++, Dest += Bps) {
+		for (i = 0; i < 4; i++) {
+			Dest[3 * i + 0] = (ILubyte)(tx = X[4 * j + i]);
+			Dest[3 * i + 1] = (ILubyte)(ty = Y[4 * j + i]);
+
+			//calculate b (z) component ((r/255)^2 + (g/255)^2 + (b/255)^2 = 1
+			t = 127*128 - (tx - 127)*(tx - 128) - (ty - 127)*(ty - 128);
+			if (t > 0)
+				Dest[3 * i + 2] = (ILubyte)(iSqrt(t) + 128);
+			else
+				Dest[3 * i + 2] = 0x7F;
+		}
+	}
 
-				// Last three bytes
-				//bits = *((ILint*)&alphamask[3]);
-				bits = (alphamask[3]) | (alphamask[4] << 8) | (alphamask[5] << 16);
-				for (j = 2; j < 4; j++) {
-					for (i = 0; i < 4; i++) {
-						// only put pixels out < width or height
-						if (((x + i) < Width) && ((y + j) < Height)) {
-							Offset = z * Image->SizeOfPlane + (y + j) * Image->Bps + (x + i) * Image->Bpp + 3;
-							Image->Data[Offset] = alphas[bits & 0x07];
-						}
-						bits >>= 3;
-					}
-				}
+	return;
+}
+
+
+// Decodes CompData into Image with one call of Decode per block.
+static ILboolean iDecompressBlocks(iBlockDecoder Decode, ILuint BlockBytes)
+{
+	const ILubyte	*Src = CompData;
+	ILubyte			*Dst;
+	ILint			Cols, PlaneRows, Rows, r, w = Width, h = Height;
+	ILuint			Bpp, Bps, SizeOfPlane;
+
+	if (!CompData)
+		return IL_FALSE;
+
+	Dst = Image->Data;
+	Bpp = Image->Bpp;
+	Bps = Image->Bps;
+	SizeOfPlane = Image->SizeOfPlane;
+	Cols = (w + 3) / 4;
+	PlaneRows = (h + 3) / 4;
+	Rows = PlaneRows * Depth;
+	if (CompSize < (ILuint)(Rows * Cols) * BlockBytes)
+		return IL_FALSE;
+
+	// The globals above are thread-local, so the loop only uses the copies.
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static) if (Rows * Cols >= 1024)
+#endif
+	for (r = 0; r < Rows; r++) {
+		const ILubyte	*Block = Src + (ILuint)(r * Cols) * BlockBytes;
+		ILint			y = (r % PlaneRows) * 4, x, j, cw, ch = IL_MIN(4, h - y);
+		ILubyte			*Line = Dst + (r / PlaneRows) * SizeOfPlane + y * Bps;
+		ILubyte			Edge[4 * 4 * 4];
+
+		for (x = 0; x < w; x += 4, Block += BlockBytes) {
+			cw = IL_MIN(4, w - x);
+			if (cw == 4 && ch == 4) {
+				Decode(Block, Line + x * Bpp, Bps);
+			}
+			else {
+				Decode(Block, Edge, 4 * Bpp);
+				for (j = 0; j < ch; j++)
+					memcpy(Line + j * Bps + x * Bpp, Edge + j * 4 * Bpp, cw * Bpp);
 			}
 		}
 	}
@@ -1279,152 +1351,58 @@ ILboolean DecompressDXT5()
 	return IL_TRUE;
 }
 
-ILboolean	Decompress3Dc()
+
+ILboolean DecompressDXT1()
 {
-	int			x, y, z, i, j, k, t1, t2;
-	ILubyte		*Temp, *Temp2;
-	ILubyte		XColours[8], YColours[8];
-	ILuint		bitmask, bitmask2, Offset, CurrOffset;
+	return iDecompressBlocks(iDecodeDxt1Block, 8);
+}
 
-	if (!CompData)
+
+ILboolean DecompressDXT2()
+{
+	// Can do color & alpha same as dxt3, but color is pre-multiplied 
+	//   so the result will be wrong unless corrected. 
+	if (!DecompressDXT3())
 		return IL_FALSE;
+	CorrectPreMult();
 
-	Temp = CompData;
-	Offset = 0;
-	for (z = 0; z < Depth; z++) {
-		for (y = 0; y < Height; y += 4) {
-			for (x = 0; x < Width; x += 4) {
-				Temp2 = Temp + 8;
-
-				//Read Y palette
-				t1 = YColours[0] = Temp[0];
-				t2 = YColours[1] = Temp[1];
-				Temp += 2;
-				if (t1 > t2)
-					for (i = 2; i < 8; ++i)
-						YColours[i] = t1 + ((t2 - t1)*(i - 1))/7;
-				else {
-					for (i = 2; i < 6; ++i)
-						YColours[i] = t1 + ((t2 - t1)*(i - 1))/5;
-					YColours[6] = 0;
-					YColours[7] = 255;
-				}
-
-				// Read X palette
-				t1 = XColours[0] = Temp2[0];
-				t2 = XColours[1] = Temp2[1];
-				Temp2 += 2;
-				if (t1 > t2)
-					for (i = 2; i < 8; ++i)
-						XColours[i] = t1 + ((t2 - t1)*(i - 1))/7;
-				else {
-					for (i = 2; i < 6; ++i)
-						XColours[i] = t1 + ((t2 - t1)*(i - 1))/5;
-					XColours[6] = 0;
-					XColours[7] = 255;
-				}
-
-				//decompress pixel data
-				CurrOffset = Offset;
-				for (k = 0; k < 4; k += 2) {
-					// First three bytes
-					bitmask = ((ILuint)(Temp[0]) << 0) | ((ILuint)(Temp[1]) << 8) | ((ILuint)(Temp[2]) << 16);
-					bitmask2 = ((ILuint)(Temp2[0]) << 0) | ((ILuint)(Temp2[1]) << 8) | ((ILuint)(Temp2[2]) << 16);
-					for (j = 0; j < 2; j++) {
-						// only put pixels out < height
-						if ((y + k + j) < Height) {
-							for (i = 0; i < 4; i++) {
-								// only put pixels out < width
-								if (((x + i) < Width)) {
-									ILint t, tx, ty;
+	return IL_TRUE;
+}
 
-									t1 = CurrOffset + (x + i)*3;
-									Image->Data[t1 + 1] = ty = YColours[bitmask & 0x07];
-									Image->Data[t1 + 0] = tx = XColours[bitmask2 & 0x07];
 
-									//calculate b (z) component ((r/255)^2 + (g/255)^2 + (b/255)^2 = 1
-									t = 127*128 - (tx - 127)*(tx - 128) - (ty - 127)*(ty - 128);
-									if (t > 0)
-										Image->Data[t1 + 2] = (ILubyte)(iSqrt(t) + 128);
-									else
-										Image->Data[t1 + 2] = 0x7F;
-								}
-								bitmask >>= 3;
-								bitmask2 >>= 3;
-							}
-							CurrOffset += Image->Bps;
-						}
-					}
-					Temp += 3;
-					Temp2 += 3;
-				}
+ILboolean DecompressDXT3()
+{
+	return iDecompressBlocks(iDecodeDxt3Block, 16);
+}
 
-				//skip bytes that were read via Temp2
-				Temp += 8;
-			}
-			Offset += Image->Bps*4;
-		}
-	}
 
-	return IL_TRUE;
+ILboolean DecompressDXT4()
+{
+	// Can do color & alpha same as dxt5, but color is pre-multiplied 
+	//   so the result will be wrong unless corrected. 
+	if (!DecompressDXT5())
+		return IL_FALSE;
+	CorrectPreMult();
+
+	return IL_FALSE;
 }
 
-ILboolean	DecompressAti1n()
+
+ILboolean DecompressDXT5()
 {
-	int			x, y, z, i, j, k, t1, t2;
-	ILubyte		*Temp;
-	ILubyte		Colours[8];
-	ILuint		bitmask, Offset, CurrOffset;
+	return iDecompressBlocks(iDecodeDxt5Block, 16);
+}
 
-	if (!CompData)
-		return IL_FALSE;
 
-	Temp = CompData;
-	Offset = 0;
-	for (z = 0; z < Depth; z++) {
-		for (y = 0; y < Height; y += 4) {
-			for (x = 0; x < Width; x += 4) {
-				//Read palette
-				t1 = Colours[0] = Temp[0];
-				t2 = Colours[1] = Temp[1];
-				Temp += 2;
-				if (t1 > t2)
-					for (i = 2; i < 8; ++i)
-						Colours[i] = t1 + ((t2 - t1)*(i - 1))/7;
-				else {
-					for (i = 2; i < 6; ++i)
-						Colours[i] = t1 + ((t2 - t1)*(i - 1))/5;
-					Colours[6] = 0;
-					Colours[7] = 255;
-				}
+ILboolean	Decompress3Dc()
+{
+	return iDecompressBlocks(iDecode3DcBlock, 16);
+}
 
-				//decompress pixel data
-				CurrOffset = Offset;
-				for (k = 0; k < 4; k += 2) {
-					// First three bytes
-					bitmask = ((ILuint)(Temp[0]) << 0) | ((ILuint)(Temp[1]) << 8) | ((ILuint)(Temp[2]) << 16);
-					for (j = 0; j < 2; j++) {
-						// only put pixels out < height
-						if ((y + k + j) < Height) {
-							for (i = 0; i < 4; i++) {
-								// only put pixels out < width
-								if (((x + i) < Width)) {
-									t1 = CurrOffset + (x + i);
-									Image->Data[t1] = Colours[bitmask & 0x07];
-								}
-								bitmask >>= 3;
-							}
-							CurrOffset += Image->Bps;
-						}
-					}
-					Temp += 3;
-				}
-			}
-			Offset += Image->Bps*4;
-		}
-	}
 
-	return IL_TRUE;
+ILboolean	DecompressAti1n()
+{
+	return iDecompressBlocks(iDecodeAti1nBlock, 8);
 }
 
 //This is nearly exactly the same as DecompressDXT5...
@@ -1555,85 +1533,11 @@ ILboolean DecompressRXGB()
 	return IL_TRUE;
 }
 
-//stolen from OpenEXR
-unsigned int
-halfToFloat (unsigned short y)
-{
-
-	int s = (y >> 15) & 0x00000001;
-	int e = (y >> 10) & 0x0000001f;
-	int m =  y		  & 0x000003ff;
-
-	if (e == 0)
-	{
-		if (m == 0)
-		{
-			//
-			// Plus or minus zero
-			//
-
-			return s << 31;
-		}
-		else
-		{
-			//
-			// Denormalized number -- renormalize it
-			//
-
-			while (!(m & 0x00000400))
-			{
-				m <<= 1;
-				e -=  1;
-			}
-
-			e += 1;
-			m &= ~0x00000400;
-		}
-	}
-	else if (e == 31)
-	{
-		if (m == 0)
-		{
-			//
-			// Positive or negative infinity
-			//
-
-			return (s << 31) | 0x7f800000;
-		}
-		else
-		{
-			//
-			// Nan -- preserve sign and significand bits
-			//
-
-			return (s << 31) | 0x7f800000 | (m << 13);
-		}
-	}
-
-	//
-	// Normalized number
-	//
-
-	e = e + (127 - 15);
-	m = m << 13;
-
-	//
-	// Assemble s, e and m.
-	//
-
-	return (s << 31) | (e << 23) | m;
-}
-
-
 ILboolean iConvFloat16ToFloat32(ILuint* dest, ILushort* src, ILuint size)
 {
-	ILuint i;
-	for(i = 0; i < size; ++i, ++dest, ++src) {
-		//float: 1 sign bit, 8 exponent bits, 23 mantissa bits
-		//half: 1 sign bit, 5 exponent bits, 10 mantissa bits
-		*dest = halfToFloat(*src);
-
-	}
+	//float: 1 sign bit, 8 exponent bits, 23 mantissa bits
+	//half: 1 sign bit, 5 exponent bits, 10 mantissa bits
+	iHalfToFloat(src, (ILfloat*)dest, size);
 	return IL_TRUE;
 }
 
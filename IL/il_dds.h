@@ -173,7 +173,8 @@ ILvoid		AdjustVolumeTexture(DDSHEAD *Head);
 ILboolean	ReadData(ILvoid);
 ILboolean	AllocImage(ILvoid);
 ILboolean	Decompress(ILvoid);
-ILboolean	ReadMipmaps(ILvoid);
+ILboolean	ReadMipmaps(ILuint Levels);
+ILuint		iSkipMipmaps(ILvoid);
 ILuint		DecodePixelFormat(ILvoid);
 ILboolean	DecompressARGB(ILvoid);
 ILboolean	DecompressDXT1(ILvoid);
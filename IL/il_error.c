@@ -14,11 +14,9 @@
 #include "il_internal.h"
 
 
-#define IL_ERROR_STACK_SIZE 32  // Needed elsewhere?
-
-
-ILenum	ilErrorNum[IL_ERROR_STACK_SIZE];
-ILint	ilErrorPlace = (-1);
+// The error stack belongs to the current context (IL_ERROR_STACK_SIZE is in il_context.h).
+#define ilErrorNum		(iGetCurContext()->ErrorNum)
+#define ilErrorPlace	(iGetCurContext()->ErrorPlace)
 
 
 // Sets the current error
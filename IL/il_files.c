@@ -35,11 +35,18 @@ ILint		ILAPIENTRY iPutcFile(ILubyte Char);
 ILint		ILAPIENTRY iPutcLump(ILubyte Char);
 ILint		ILAPIENTRY iWriteFile(const ILvoid *Buffer, ILuint Size, ILuint Number);
 ILint		ILAPIENTRY iWriteLump(const ILvoid *Buffer, ILuint Size, ILuint Number);
-ILHANDLE	FileRead = NULL, FileWrite = NULL;
-const ILvoid *ReadLump = NULL;
-ILvoid 		*WriteLump = NULL;
-ILuint		ReadLumpPos = 0, ReadLumpSize = 0, ReadFileStart = 0, WriteFileStart = 0;
-ILuint		WriteLumpPos = 0, WriteLumpSize = 0;
+
+// File, lump and cache positions of the current context
+#define FileRead		(iGetCurContext()->FileRead)
+#define FileWrite		(iGetCurContext()->FileWrite)
+#define ReadLump		(iGetCurContext()->ReadLump)
+#define WriteLump		(iGetCurContext()->WriteLump)
+#define ReadLumpPos		(iGetCurContext()->ReadLumpPos)
+#define ReadLumpSize	(iGetCurContext()->ReadLumpSize)
+#define ReadFileStart	(iGetCurContext()->ReadFileStart)
+#define WriteFileStart	(iGetCurContext()->WriteFileStart)
+#define WriteLumpPos	(iGetCurContext()->WriteLumpPos)
+#define WriteLumpSize	(iGetCurContext()->WriteLumpSize)
 
 fGetcProc	GetcProcCopy;
 fReadProc	ReadProcCopy;
@@ -48,9 +55,12 @@ fTellRProc	TellProcCopy;
 ILHANDLE	(ILAPIENTRY *iopenCopy)(ILstring);
 ILvoid		(ILAPIENTRY *icloseCopy)(ILHANDLE);
 
-ILboolean	UseCache = IL_FALSE;
-ILubyte		*Cache = NULL;
-ILuint		CacheSize, CachePos, CacheStartPos, CacheBytesRead;
+#define UseCache		(iGetCurContext()->UseCache)
+#define Cache			(iGetCurContext()->Cache)
+#define CacheSize		(iGetCurContext()->CacheSize)
+#define CachePos		(iGetCurContext()->CachePos)
+#define CacheStartPos	(iGetCurContext()->CacheStartPos)
+#define CacheBytesRead	(iGetCurContext()->CacheBytesRead)
 
 
 /*// Just preserves the current read functions and replaces
@@ -440,15 +450,15 @@ ILuint ILAPIENTRY iReadLump(ILvoid *Buffer, ILuint Size, ILuint Number)
 	ILuint i, ByteSize = Size * Number;
 
 	for (i = 0; i < ByteSize; i++) {
-		*((ILubyte*)Buffer + i) = *((ILubyte*)ReadLump + ReadLumpPos + i);
 		if (ReadLumpSize > 0) {  // ReadLumpSize is too large to care about apparently
-			if (ReadLumpPos + i > ReadLumpSize) {
+			if (ReadLumpPos + i >= ReadLumpSize) {
 				ReadLumpPos += i;
 				if (i != Number)
 					ilSetError(IL_FILE_READ_ERROR);
 				return i;
 			}
 		}
+		*((ILubyte*)Buffer + i) = *((ILubyte*)ReadLump + ReadLumpPos + i);
 	}
 
 	ReadLumpPos += i;
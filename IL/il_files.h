@@ -19,20 +19,22 @@
 #define __FILES_EXTERN extern
 #endif
 #include <IL/il.h>
+#include "il_context.h"
 
 
 __FILES_EXTERN ILvoid ILAPIENTRY iPreserveReadFuncs(ILvoid);
 __FILES_EXTERN ILvoid ILAPIENTRY iRestoreReadFuncs(ILvoid);
 
-__FILES_EXTERN fEofProc		EofProc;
-__FILES_EXTERN fGetcProc	GetcProc;
-__FILES_EXTERN fReadProc	ReadProc;
-__FILES_EXTERN fSeekRProc	SeekRProc;
-__FILES_EXTERN fSeekWProc	SeekWProc;
-__FILES_EXTERN fTellRProc	TellRProc;
-__FILES_EXTERN fTellWProc	TellWProc;
-__FILES_EXTERN fPutcProc	PutcProc;
-__FILES_EXTERN fWriteProc	WriteProc;
+// The file callbacks and current I/O functions belong to the current context.
+#define EofProc		(iGetCurContext()->EofProc)
+#define GetcProc	(iGetCurContext()->GetcProc)
+#define ReadProc	(iGetCurContext()->ReadProc)
+#define SeekRProc	(iGetCurContext()->SeekRProc)
+#define SeekWProc	(iGetCurContext()->SeekWProc)
+#define TellRProc	(iGetCurContext()->TellRProc)
+#define TellWProc	(iGetCurContext()->TellWProc)
+#define PutcProc	(iGetCurContext()->PutcProc)
+#define WriteProc	(iGetCurContext()->WriteProc)
 
 __FILES_EXTERN ILHANDLE		ILAPIENTRY iDefaultOpen(const ILstring FileName);
 __FILES_EXTERN ILvoid		ILAPIENTRY iDefaultClose(ILHANDLE Handle);
@@ -47,22 +49,22 @@ __FILES_EXTERN ILint		ILAPIENTRY iDefaultWrite(const ILvoid *Buffer, ILuint Size
 
 __FILES_EXTERN ILvoid		iSetInputFile(ILHANDLE File);
 __FILES_EXTERN ILvoid		iSetInputLump(const ILvoid *Lump, ILuint Size);
-__FILES_EXTERN ILboolean	(ILAPIENTRY *ieof)(ILvoid);
-__FILES_EXTERN ILHANDLE		(ILAPIENTRY *iopenr)(const ILstring);
-__FILES_EXTERN ILvoid		(ILAPIENTRY *icloser)(ILHANDLE);
-__FILES_EXTERN ILint		(ILAPIENTRY *igetc)(ILvoid);
-__FILES_EXTERN ILuint		(ILAPIENTRY *iread)(ILvoid *Buffer, ILuint Size, ILuint Number);
-__FILES_EXTERN ILuint		(ILAPIENTRY *iseek)(ILint Offset, ILuint Mode);
-__FILES_EXTERN ILuint		(ILAPIENTRY *itell)(ILvoid);
+#define ieof		(iGetCurContext()->ieof)
+#define iopenr		(iGetCurContext()->iopenr)
+#define icloser		(iGetCurContext()->icloser)
+#define igetc		(iGetCurContext()->igetc)
+#define iread		(iGetCurContext()->iread)
+#define iseek		(iGetCurContext()->iseek)
+#define itell		(iGetCurContext()->itell)
 
 __FILES_EXTERN ILvoid		iSetOutputFile(ILHANDLE File);
 __FILES_EXTERN ILvoid		iSetOutputLump(ILvoid *Lump, ILuint Size);
-__FILES_EXTERN ILvoid		(ILAPIENTRY *iclosew)(ILHANDLE);
-__FILES_EXTERN ILHANDLE		(ILAPIENTRY *iopenw)(const ILstring);
-__FILES_EXTERN ILint		(ILAPIENTRY *iputc)(ILubyte Char);
-__FILES_EXTERN ILuint		(ILAPIENTRY *iseekw)(ILint Offset, ILuint Mode);
-__FILES_EXTERN ILuint		(ILAPIENTRY *itellw)(ILvoid);
-__FILES_EXTERN ILint		(ILAPIENTRY *iwrite)(const ILvoid *Buffer, ILuint Size, ILuint Number);
+#define iclosew		(iGetCurContext()->iclosew)
+#define iopenw		(iGetCurContext()->iopenw)
+#define iputc		(iGetCurContext()->iputc)
+#define iseekw		(iGetCurContext()->iseekw)
+#define itellw		(iGetCurContext()->itellw)
+#define iwrite		(iGetCurContext()->iwrite)
  
 __FILES_EXTERN ILHANDLE		ILAPIENTRY iGetFile(ILvoid);
 __FILES_EXTERN const ILubyte*		ILAPIENTRY iGetLump(ILvoid);
@@ -21,7 +21,7 @@
 #include "il_gif.h"
 
 
-ILenum	GifType;
+IL_THREAD_LOCAL ILenum	GifType;
 
 //! Checks if the file specified in FileName is a valid Gif file.
 ILboolean ilIsValidGif(const ILstring FileName)
@@ -425,14 +425,14 @@ ILboolean SkipExtensions(GFXCONTROL *Gfx)
 
 #define MAX_CODES 4096
 
-ILint	curr_size, clear, ending, newcodes, top_slot, slot, navail_bytes = 0, nbits_left = 0;
-ILubyte	b1;
-ILubyte	byte_buff[257];
-ILubyte	*pbytes;
-ILubyte	*stack;
-ILubyte	*suffix;
-ILshort	*prefix;
-ILboolean success;
+IL_THREAD_LOCAL ILint	curr_size, clear, ending, newcodes, top_slot, slot, navail_bytes = 0, nbits_left = 0;
+IL_THREAD_LOCAL ILubyte	b1;
+IL_THREAD_LOCAL ILubyte	byte_buff[257];
+IL_THREAD_LOCAL ILubyte	*pbytes;
+IL_THREAD_LOCAL ILubyte	*stack;
+IL_THREAD_LOCAL ILubyte	*suffix;
+IL_THREAD_LOCAL ILshort	*prefix;
+IL_THREAD_LOCAL ILboolean success;
 
 ILuint code_mask[13] =
 {
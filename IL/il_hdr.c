@@ -15,6 +15,7 @@
 #ifndef IL_NO_HDR
 #include "il_hdr.h"
 #include "il_endian.h"
+#include "il_convfast.h"
 
 //! Checks if the file specified in FileName is a valid .hdr file.
 ILboolean ilIsValidHdr(const ILstring FileName)
@@ -97,6 +98,8 @@ ILboolean iGetHdrHead(HDRHEADER *Header)
 	if (iread(&a, 1, 1) != 1)
 		return IL_FALSE;
 	while (a != '\n') {
+		if (count == sizeof(buff) - 1)
+			return IL_FALSE;
 		buff[count] = a;
 		if (iread(&a, 1, 1) != 1)
 			return IL_FALSE;
@@ -112,8 +115,8 @@ ILboolean iGetHdrHead(HDRHEADER *Header)
 	//nothing that really changes the appearance of the loaded image...
 	//(The code as it is now assumes that y contains "-Y" and x contains
 	//"+X" after the following line)
-	//Furthermore, this crashes if the read strings are longer than 2 chars o_O
-	sscanf(buff, "%s %d %s %d", y, &Header->Height, x, &Header->Width);
+	if (sscanf(buff, "%2s %d %2s %d", y, &Header->Height, x, &Header->Width) != 4)
+		return IL_FALSE;
 
 	return IL_TRUE;
 }
@@ -187,13 +190,72 @@ ILboolean ilLoadHdrL(const ILvoid *Lump, ILuint Size)
 }
 
 
+// Allocates a scanline of w pixels for ReadScanline(), which has to be passed
+//	the returned pointer + 4:  an old-style run at the first pixel repeats the
+//	pixel before the line, which is zeroed here instead of being out of bounds.
+static ILubyte *iAllocScanline(ILuint w)
+{
+	ILubyte *buffer = ialloc(w*4 + 4);
+	if (buffer != NULL)
+		memset(buffer, 0, 4);
+	return buffer;
+}
+
+
+// Converts Num RGBE pixels to RGB floats:  (mantissa / 255) * 2^(e - 128).
+static ILvoid iRgbeToFloat(const ILubyte *Rgbe, ILfloat *Dest, ILuint Num)
+{
+	ILuint	i = 0, e;
+	ILfloat	t;
+
+#ifdef IL_USE_SSE2
+	// Four pixels per iteration, channels split into registers, scaled and
+	//	transposed back into three stores of RGB triples.
+	const __m128i	ByteMask = _mm_set1_epi32(0xFF), One = _mm_set1_epi32(1), Zero = _mm_setzero_si128();
+	const __m128	Max = _mm_set1_ps(255.0f);
+	__m128i			v, e4;
+	__m128			r, g, b, z, s;
+
+	for (; i + 4 <= Num; i += 4) {
+		v = _mm_loadu_si128((const __m128i*)(Rgbe + i * 4));
+		e4 = _mm_srli_epi32(v, 24);
+		s = _mm_castsi128_ps(_mm_andnot_si128(_mm_cmpeq_epi32(e4, Zero),
+			_mm_slli_epi32(_mm_sub_epi32(e4, One), 23)));
+		r = _mm_mul_ps(_mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(v, ByteMask)), Max), s);
+		g = _mm_mul_ps(_mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(v, 8), ByteMask)), Max), s);
+		b = _mm_mul_ps(_mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(v, 16), ByteMask)), Max), s);
+		z = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(r, g, b, z);  // r..z now hold pixels 0..3 as (R, G, B, 0)
+		_mm_storeu_ps(Dest, _mm_shuffle_ps(r, _mm_shuffle_ps(r, g, _MM_SHUFFLE(0, 0, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0)));
+		_mm_storeu_ps(Dest + 4, _mm_shuffle_ps(g, b, _MM_SHUFFLE(1, 0, 2, 1)));
+		_mm_storeu_ps(Dest + 8, _mm_shuffle_ps(_mm_shuffle_ps(b, z, _MM_SHUFFLE(0, 0, 2, 2)), z, _MM_SHUFFLE(2, 1, 2, 0)));
+		Dest += 12;
+	}
+#endif
+	for (Rgbe += i * 4; i < Num; i++, Rgbe += 4) {
+		e = Rgbe[3];
+		//t = (float)pow(2.f, ((ILint)e) - 128);
+		if (e != 0)
+			e = (e - 1) << 23;
+		memcpy(&t, &e, sizeof(ILfloat));
+
+		Dest[0] = (Rgbe[0]/255.0f)*t;
+		Dest[1] = (Rgbe[1]/255.0f)*t;
+		Dest[2] = (Rgbe[2]/255.0f)*t;
+		Dest += 3;
+	}
+
+	return;
+}
+
+
 // Internal function used to load the .hdr.
 ILboolean iLoadHdrInternal()
 {
 	HDRHEADER	Header;
 	ILfloat *data;
-	ILubyte *scanline;
-	ILuint i, j, e, r, g, b;
+	ILubyte *buffer, *scanline;
+	ILuint i;
 
 	if (iCurImage == NULL) {
 		ilSetError(IL_ILLEGAL_OPERATION);
@@ -216,61 +278,48 @@ ILboolean iLoadHdrInternal()
 	}
 	iCurImage->Origin = IL_ORIGIN_UPPER_LEFT;
 
-	//read image data
-	if (iGetHint(IL_MEM_SPEED_HINT) == IL_FASTEST)
-		iPreCache(iCurImage->Width / 8 * iCurImage->Height);
-
+	//read image data.  No iPreCache(): the cache pads a short file with
+	//	stale bytes instead of returning IL_EOF, so truncation would go unseen.
 	data = (ILfloat*)iCurImage->Data;
-	scanline = ialloc(Header.Width*4);
+	buffer = iAllocScanline(Header.Width);
+	if (buffer == NULL)
+		return IL_FALSE;
+	scanline = buffer + 4;
 	for (i = 0; i < Header.Height; ++i) {
-		ReadScanline(scanline, Header.Width);
+		if (!ReadScanline(scanline, Header.Width)) {
+			ifree(buffer);
+			ilSetError(IL_FILE_READ_ERROR);
+			return IL_FALSE;
+		}
 
 		//convert hdrs internal format to floats
-		for (j = 0; j < 4*Header.Width; j += 4) {
-			ILuint *ee;
-			ILfloat t, *ff;
-			e = scanline[j + 3];
-			r = scanline[j + 0];
-			g = scanline[j + 1];
-			b = scanline[j + 2];
-
-			//t = (float)pow(2.f, ((ILint)e) - 128);
-			if (e != 0)
-				e = (e - 1) << 23;
-			
-			// All this just to avoid stric-aliasing warnings...
-			// was: t = *(ILfloat*)&e
-			ee = &e;
-			ff = (ILfloat*)ee;
-			t = *ff;
-			
-			data[0] = (r/255.0f)*t;
-			data[1] = (g/255.0f)*t;
-			data[2] = (b/255.0f)*t;
-			data += 3;
-		}
+		iRgbeToFloat(scanline, data, Header.Width);
+		data += 3*Header.Width;
 	}
-	iUnCache();
-	ifree(scanline);
+	ifree(buffer);
 
 	return ilFixImage();
 }
 
-ILvoid ReadScanline(ILubyte *scanline, ILuint w) {
+// Returns IL_FALSE if the input ends inside the scanline.
+ILboolean ReadScanline(ILubyte *scanline, ILuint w) {
 	ILubyte *runner;
-	ILuint r, g, b, e, read, shift;
+	ILint r, g, b, e, t, val;
+	ILuint read, shift;
 
 	r = igetc();
 	g = igetc();
 	b = igetc();
 	e = igetc();
+	if (r == IL_EOF || g == IL_EOF || b == IL_EOF || e == IL_EOF)
+		return IL_FALSE;
 
 	//check if the scanline is in the new format
 	//if so, e, r, g, g are stored separated and are
 	//rle-compressed independently.
 	if (r == 2 && g == 2) {
 		ILuint length = (b << 8) | e;
-		ILuint j, t, k;
+		ILuint j, k;
 		if (length > w)
 			length = w; //fix broken files
 		for (k = 0; k < 4; ++k) {
@@ -278,8 +327,12 @@ ILvoid ReadScanline(ILubyte *scanline, ILuint w) {
 			j = 0;
 			while (j < length) {
 				t = igetc();
+				if (t == IL_EOF)
+					return IL_FALSE;
 				if (t > 128) { //Run?
-					ILubyte val = igetc();
+					val = igetc();
+					if (val == IL_EOF)
+						return IL_FALSE;
 					t &= 127;
 					//copy current byte
 					while (t > 0 && j < length) {
@@ -292,7 +345,10 @@ ILvoid ReadScanline(ILubyte *scanline, ILuint w) {
 				else { //No Run.
 					//read new bytes
 					while (t > 0 && j < length) {
-						*runner = igetc();
+						val = igetc();
+						if (val == IL_EOF)
+							return IL_FALSE;
+						*runner = val;
 						runner += 4;
 						--t;
 						++j;
@@ -300,7 +356,7 @@ ILvoid ReadScanline(ILubyte *scanline, ILuint w) {
 				}
 			}
 		}
-		return; //done decoding a scanline in separated format
+		return IL_TRUE; //done decoding a scanline in separated format
 	}
 
 	//if we come here, we are dealing with old-style scanlines
@@ -313,6 +369,8 @@ ILvoid ReadScanline(ILubyte *scanline, ILuint w) {
 			g = igetc();
 			b = igetc();
 			e = igetc();
+			if (r == IL_EOF || g == IL_EOF || b == IL_EOF || e == IL_EOF)
+				return IL_FALSE;
 		}
 
 		//if all three mantissas are 1, then this is a rle
@@ -342,8 +400,293 @@ ILvoid ReadScanline(ILubyte *scanline, ILuint w) {
 			++read;
 		}
 	}
+
+	return IL_TRUE;
 }
 
+// Open .hdr of ilHdrOpen().  The input position lives in a context of its own,
+//	so streams can be read in between other loads (or from different threads).
+struct ILhdrStream
+{
+	ILcontext	*Context;
+	ILHANDLE	File;		// NULL for lumps
+	ILuint		Width, Height;
+	ILuint		NextRow;	// Row the input is positioned at
+	ILuint		*RowPos;	// Input position of each row start, found while decoding
+	ILuint		RowsKnown;	// Entries of RowPos filled in so far (always >= 1)
+	ILubyte		*Buffer;	// iAllocScanline() of Width pixels
+};
+
+
+// Reads the header and sets up the row index of a stream whose input has just been set.
+static ILboolean iHdrStreamBegin(ILhdrStream *Stream)
+{
+	HDRHEADER	Header;
+
+	if (!iGetHdrHead(&Header) || !iCheckHdr(&Header)) {
+		ilSetError(IL_INVALID_FILE_HEADER);
+		return IL_FALSE;
+	}
+	if (Header.Width == 0 || Header.Height == 0) {
+		ilSetError(IL_INVALID_FILE_HEADER);
+		return IL_FALSE;
+	}
+
+	Stream->Width = Header.Width;
+	Stream->Height = Header.Height;
+	Stream->RowPos = (ILuint*)ialloc(Header.Height * sizeof(ILuint));
+	Stream->Buffer = iAllocScanline(Header.Width);
+	if (Stream->RowPos == NULL || Stream->Buffer == NULL)
+		return IL_FALSE;
+	Stream->RowPos[0] = itell();
+	Stream->RowsKnown = 1;
+	Stream->NextRow = 0;
+
+	return IL_TRUE;
+}
+
+
+// Common part of ilHdrOpen() and ilHdrOpenL().  Errors go to the caller's context.
+static ILhdrStream *iHdrStreamOpen(const ILstring FileName, const ILvoid *Lump, ILuint Size)
+{
+	ILhdrStream	*Stream;
+	ILcontext	*Prev;
+	ILenum		Error = IL_NO_ERROR;
+	ILboolean	bRet = IL_FALSE;
+
+	// Files are read through the caller's ilSetRead() callbacks.
+	fOpenRProc	Open = iopenr;
+	fCloseRProc	Close = icloser;
+	fEofProc	Eof = EofProc;
+	fGetcProc	Getc = GetcProc;
+	fReadProc	Read = ReadProc;
+	fSeekRProc	Seek = SeekRProc;
+	fTellRProc	Tell = TellRProc;
+
+	Stream = (ILhdrStream*)icalloc(1, sizeof(ILhdrStream));
+	if (Stream == NULL)
+		return NULL;
+	Stream->Context = ilCreateContext();
+	if (Stream->Context == NULL) {
+		ifree(Stream);
+		return NULL;
+	}
+
+	Prev = iBindContext(Stream->Context);
+	ilSetRead(Open, Close, Eof, Getc, Read, Seek, Tell);
+	if (FileName != NULL) {
+		Stream->File = iopenr(FileName);
+		if (Stream->File == NULL)
+			ilSetError(IL_COULD_NOT_OPEN_FILE);
+		else {
+			iSetInputFile(Stream->File);
+			bRet = iHdrStreamBegin(Stream);
+		}
+	}
+	else {
+		iSetInputLump(Lump, Size);
+		bRet = iHdrStreamBegin(Stream);
+	}
+	if (!bRet)
+		Error = ilGetError();
+	iBindContext(Prev);
+
+	if (!bRet) {
+		ilHdrClose(Stream);
+		if (Error != IL_NO_ERROR)
+			ilSetError(Error);
+		return NULL;
+	}
+
+	return Stream;
+}
+
+
+//! Opens a .hdr file for decoding a few rows at a time with ilHdrReadRows() or ilHdrReadRegion().
+ILhdrStream* ILAPIENTRY ilHdrOpen(const ILstring FileName)
+{
+	if (FileName == NULL) {
+		ilSetError(IL_INVALID_PARAM);
+		return NULL;
+	}
+	return iHdrStreamOpen(FileName, NULL, 0);
+}
+
+
+//! Same as ilHdrOpen() for a .hdr in memory.  Lump has to stay valid until ilHdrClose().
+ILhdrStream* ILAPIENTRY ilHdrOpenL(const ILvoid *Lump, ILuint Size)
+{
+	if (Lump == NULL) {
+		ilSetError(IL_INVALID_PARAM);
+		return NULL;
+	}
+	return iHdrStreamOpen(NULL, Lump, Size);
+}
+
+
+//! Closes a stream of ilHdrOpen() or ilHdrOpenL().
+ILvoid ILAPIENTRY ilHdrClose(ILhdrStream *Stream)
+{
+	ILcontext *Prev;
+
+	if (Stream == NULL)
+		return;
+
+	if (Stream->File != NULL) {
+		Prev = iBindContext(Stream->Context);
+		icloser(Stream->File);
+		iBindContext(Prev);
+	}
+	ilDeleteContext(Stream->Context);
+	ifree(Stream->RowPos);
+	ifree(Stream->Buffer);
+	ifree(Stream);
+
+	return;
+}
+
+
+//! Gets the dimensions of the image of Stream.
+ILboolean ILAPIENTRY ilHdrGetSize(ILhdrStream *Stream, ILuint *Width, ILuint *Height)
+{
+	if (Stream == NULL) {
+		ilSetError(IL_INVALID_PARAM);
+		return IL_FALSE;
+	}
+
+	if (Width)
+		*Width = Stream->Width;
+	if (Height)
+		*Height = Stream->Height;
+
+	return IL_TRUE;
+}
+
+
+// Decodes the row the input is positioned at into the scanline buffer, indexing the next one.
+//	On a short read the position is unknown, so the next seek always goes through the index.
+static ILboolean iHdrStreamNextRow(ILhdrStream *Stream)
+{
+	if (!ReadScanline(Stream->Buffer + 4, Stream->Width)) {
+		Stream->NextRow = Stream->Height;
+		return IL_FALSE;
+	}
+	Stream->NextRow++;
+	if (Stream->NextRow == Stream->RowsKnown && Stream->NextRow < Stream->Height)
+		Stream->RowPos[Stream->RowsKnown++] = itell();
+
+	return IL_TRUE;
+}
+
+
+// Positions the input at Row.  Rows are variable-length RLE, so rows past the
+//	index are found by decoding forward from the last indexed one.
+static ILboolean iHdrStreamSeekRow(ILhdrStream *Stream, ILuint Row)
+{
+	if (Row == Stream->NextRow)
+		return IL_TRUE;
+
+	if (Row < Stream->RowsKnown) {
+		iseek(Stream->RowPos[Row], IL_SEEK_SET);
+		Stream->NextRow = Row;
+		return IL_TRUE;
+	}
+
+	if (Stream->NextRow != Stream->RowsKnown - 1) {
+		iseek(Stream->RowPos[Stream->RowsKnown - 1], IL_SEEK_SET);
+		Stream->NextRow = Stream->RowsKnown - 1;
+	}
+	while (Stream->NextRow < Row) {
+		if (!iHdrStreamNextRow(Stream))
+			return IL_FALSE;
+	}
+
+	return IL_TRUE;
+}
+
+
+// Converts Num pixels of the scanline buffer to RGB of Type.
+static ILvoid iHdrStreamConvert(const ILubyte *Rgbe, ILuint Num, ILenum Type, ILvoid *Dest)
+{
+	ILfloat	Temp[256 * 3];
+	ILuint	i, Count;
+
+	if (Type == IL_FLOAT) {
+		iRgbeToFloat(Rgbe, (ILfloat*)Dest, Num);
+		return;
+	}
+
+	// IL_HALF goes through float in chunks that stay in the cache.
+	for (i = 0; i < Num; i += Count) {
+		Count = IL_MIN(Num - i, 256);
+		iRgbeToFloat(Rgbe + i * 4, Temp, Count);
+		iFloatToHalf(Temp, (ILushort*)Dest + i * 3, Count * 3);
+	}
+
+	return;
+}
+
+
+//! Decodes the Width x Height region of Stream at (XOff, YOff) into Dest as RGB of
+//	Type (IL_FLOAT or IL_HALF).  Stride is the distance between rows of Dest in bytes,
+//	0 if they are packed.  Whole scanlines are still read, but only the region is converted.
+ILboolean ILAPIENTRY ilHdrReadRegion(ILhdrStream *Stream, ILuint XOff, ILuint YOff, ILuint Width, ILuint Height,
+										ILenum Type, ILvoid *Dest, ILuint Stride)
+{
+	ILcontext	*Prev;
+	ILuint		y, Bpp;
+
+	if (Stream == NULL || Dest == NULL || (Type != IL_FLOAT && Type != IL_HALF)) {
+		ilSetError(IL_INVALID_PARAM);
+		return IL_FALSE;
+	}
+	if (XOff > Stream->Width || Width > Stream->Width - XOff
+		|| YOff > Stream->Height || Height > Stream->Height - YOff) {
+		ilSetError(IL_INVALID_PARAM);
+		return IL_FALSE;
+	}
+
+	Bpp = Type == IL_FLOAT ? 3 * sizeof(ILfloat) : 3 * sizeof(ILushort);
+	if (Stride == 0)
+		Stride = Width * Bpp;
+	else if (Stride < Width * Bpp) {
+		ilSetError(IL_INVALID_PARAM);
+		return IL_FALSE;
+	}
+	if (Width == 0 || Height == 0)
+		return IL_TRUE;
+
+	Prev = iBindContext(Stream->Context);
+	if (!iHdrStreamSeekRow(Stream, YOff)) {
+		iBindContext(Prev);
+		ilSetError(IL_FILE_READ_ERROR);
+		return IL_FALSE;
+	}
+	for (y = 0; y < Height; y++) {
+		if (!iHdrStreamNextRow(Stream)) {
+			iBindContext(Prev);
+			ilSetError(IL_FILE_READ_ERROR);
+			return IL_FALSE;
+		}
+		iHdrStreamConvert(Stream->Buffer + 4 + XOff * 4, Width, Type, (ILubyte*)Dest + y * Stride);
+	}
+	iBindContext(Prev);
+
+	return IL_TRUE;
+}
+
+
+//! Decodes NumRows full rows of Stream starting at YOff into Dest, packed, as RGB of Type.
+ILboolean ILAPIENTRY ilHdrReadRows(ILhdrStream *Stream, ILuint YOff, ILuint NumRows, ILenum Type, ILvoid *Dest)
+{
+	if (Stream == NULL) {
+		ilSetError(IL_INVALID_PARAM);
+		return IL_FALSE;
+	}
+	return ilHdrReadRegion(Stream, 0, YOff, Stream->Width, NumRows, Type, Dest, 0);
+}
+
+
 
 
 #endif//IL_NO_HDR
@@ -37,6 +37,6 @@ ILboolean iCheckHdr(HDRHEADER *Header);
 ILboolean ilLoadHdrF(ILHANDLE file);
 ILboolean iLoadHdrInternal();
 
-ILvoid ReadScanline(ILubyte *scanline, ILuint w);
+ILboolean ReadScanline(ILubyte *scanline, ILuint w);
 
 #endif//HDR_H
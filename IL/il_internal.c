@@ -16,8 +16,6 @@
 #include <stdlib.h>
 
 
-ILimage *iCurImage = NULL;
-
 
 /* Siigron: added this for Linux... a #define should work, but for some reason
 	it doesn't (anyone who knows why?) */
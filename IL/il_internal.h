@@ -80,7 +80,12 @@
 		#define USE_WIN32_ASM
 	#endif
 #endif
-extern ILimage *iCurImage;
+// SSE2 is always there on x86-64; IL_NO_SSE2 forces the plain C paths.
+#if !defined(IL_NO_SSE2) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define IL_USE_SSE2
+	#include <emmintrin.h>
+#endif
+#define iCurImage (iGetCurContext()->CurImage)  // See il_context.h
 #define BIT_0	0x00000001
 #define BIT_1	0x00000002
 #define BIT_2	0x00000004
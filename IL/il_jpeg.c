@@ -49,7 +49,7 @@
 		#endif
 	#endif
 
-static ILboolean jpgErrorOccured = IL_FALSE;
+static IL_THREAD_LOCAL ILboolean jpgErrorOccured = IL_FALSE;
 
 
 // Internal function used to get the .jpg header from the current file.
@@ -287,7 +287,7 @@ devil_jpeg_read_init (j_decompress_ptr cinfo)
 }
 
 
-jmp_buf	JpegJumpBuffer;
+static IL_THREAD_LOCAL jmp_buf	JpegJumpBuffer;
 
 static void iJpegErrorExit( j_common_ptr cinfo )
 {
@@ -44,9 +44,9 @@ ILint		readpng_init(ILvoid);
 ILboolean	readpng_get_image(ILdouble display_exponent);
 ILvoid		readpng_cleanup(ILvoid);
 
-png_structp png_ptr = NULL;
-png_infop info_ptr = NULL;
-ILint color_type;
+static IL_THREAD_LOCAL png_structp png_ptr = NULL;
+static IL_THREAD_LOCAL png_infop info_ptr = NULL;
+static IL_THREAD_LOCAL ILint color_type;
 
 #define GAMMA_CORRECTION 1.0  // Doesn't seem to be doing anything...
 
@@ -21,7 +21,7 @@
 
 
 // Can't read direct bits from a lump yet
-ILboolean IsLump = IL_FALSE;
+IL_THREAD_LOCAL ILboolean IsLump = IL_FALSE;
 
 
 //! Checks if the file specified in FileName is a valid .pnm file.
@@ -459,7 +459,7 @@ ILboolean iGetWord(ILvoid)
 }
 
 
-ILstring FName;
+IL_THREAD_LOCAL ILstring FName;
 
 //! Writes a Pnm file
 ILboolean ilSavePnm(const ILstring FileName)
@@ -19,8 +19,8 @@
 
 #define MAX_BUFFER 180  // According to the ppm specs, it's 70, but PSP
 						//  likes to output longer lines...
-ILbyte LineBuffer[MAX_BUFFER];
-ILbyte SmallBuff[MAX_BUFFER];
+IL_THREAD_LOCAL ILbyte LineBuffer[MAX_BUFFER];
+IL_THREAD_LOCAL ILbyte SmallBuff[MAX_BUFFER];
 
 #define IL_PBM_ASCII	0x0001
 #define IL_PGM_ASCII	0x0002
@@ -27,12 +27,12 @@ ILubyte GenAttHead[4] = {
 
 
 // Make these global, since they contain most of the image information.
-GENATT_CHUNK	AttChunk;
-PSPHEAD			Header;
-ILuint			NumChannels;
-ILubyte			**Channels = NULL;
-ILubyte			*Alpha = NULL;
-ILpal			Pal;
+IL_THREAD_LOCAL GENATT_CHUNK	AttChunk;
+IL_THREAD_LOCAL PSPHEAD			Header;
+IL_THREAD_LOCAL ILuint			NumChannels;
+IL_THREAD_LOCAL ILubyte			**Channels = NULL;
+IL_THREAD_LOCAL ILubyte			*Alpha = NULL;
+IL_THREAD_LOCAL ILpal			Pal;
 
 
 
@@ -5,7 +5,7 @@
 #include "il_manip.h"
 #include <limits.h>
 
-static char *FName = NULL;
+static IL_THREAD_LOCAL char *FName = NULL;
 
 /*----------------------------------------------------------------------------*/
 
@@ -63,6 +63,14 @@ ILint ILAPIENTRY ilGenImage() {
 //! Makes Image the current active image - similar to glBindTexture().
 ILvoid ILAPIENTRY ilBindImage(ILuint Image)
 {
+	// A loading context has exactly one image and no names, so any bind
+	//	(loaders only rebind their parent image) selects that image.
+	if (iGetCurContext()->BaseImage != NULL) {
+		iCurImage = iGetCurContext()->BaseImage;
+		ParentImage = IL_TRUE;
+		return;
+	}
+
 	if (ImageStack == NULL || StackSize == 0) {
 		if (!iEnlargeStack()) {
 			return;
@@ -262,6 +270,8 @@ ILAPI ILvoid ILAPIENTRY ilClosePal(ILpal *Palette)
 
 ILimage *iGetBaseImage()
 {
+	if (iGetCurContext()->BaseImage != NULL)
+		return iGetCurContext()->BaseImage;
 	return ImageStack[ilGetCurName()];
 }
 
@@ -423,6 +433,8 @@ ILuint ILAPIENTRY ilCreateSubImage(ILenum Type, ILuint Num)
 // Returns the current index.
 ILAPI ILuint ILAPIENTRY ilGetCurName()
 {
+	if (iGetCurContext()->BaseImage != NULL)
+		return 0;
 	if (iCurImage == NULL || ImageStack == NULL || StackSize == 0)
 		return 0;
 	return CurName;
@@ -451,7 +463,10 @@ ILAPI ILvoid ILAPIENTRY ilReplaceCurImage(ILimage *Image)
 		ilActiveImage(0);
 		ilCloseImage(iCurImage);
 	}
-	ImageStack[ilGetCurName()] = Image;
+	if (iGetCurContext()->BaseImage != NULL)
+		iGetCurContext()->BaseImage = Image;
+	else
+		ImageStack[ilGetCurName()] = Image;
 	iCurImage = Image;
 	ParentImage = IL_TRUE;
 	return;
@@ -507,6 +522,7 @@ ILboolean IsInit = IL_FALSE;
 ILvoid ILAPIENTRY ilInit()
 {
 	//ilSetMemory(NULL, NULL);  Now useless 3/4/2006 (due to modification in il_alloc.c)
+	iInitDefaultContext();
 	ilSetError(IL_NO_ERROR);
 	ilDefaultStates();  // Set states to their defaults.
 	// Sets default file-reading callbacks.
@@ -37,7 +37,7 @@ ILuint		CurName = 0;
 ILimage		**ImageStack = NULL;
 iFree		*FreeNames = NULL;
 ILboolean	OnExit = IL_FALSE;
-ILboolean	ParentImage = IL_TRUE;
+#define		ParentImage (iGetCurContext()->ParentImage)
 
 
 #endif//IMAGESTACK_H
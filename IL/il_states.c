@@ -80,6 +80,8 @@ ILvoid ilDefaultStates()
 	ilStates[ilCurrentPos].ilQuantMaxIndexs = 256;
 
 	ilStates[ilCurrentPos].ilKeepDxtcData = IL_FALSE;
+	ilStates[ilCurrentPos].ilDxtcMipmapSkip = 0;
+	ilStates[ilCurrentPos].ilDxtcMipmapCount = -1;
 
 
 
@@ -415,6 +417,12 @@ ILvoid ILAPIENTRY ilGetIntegerv(ILenum Mode, ILint *Param) {
 		case IL_DXTC_FORMAT:
 			*Param = ilStates[ilCurrentPos].ilDxtcFormat;
 			break;
+		case IL_DXTC_MIPMAP_SKIP:
+			*Param = ilStates[ilCurrentPos].ilDxtcMipmapSkip;
+			break;
+		case IL_DXTC_MIPMAP_COUNT:
+			*Param = ilStates[ilCurrentPos].ilDxtcMipmapCount;
+			break;
 		case IL_JPG_QUALITY:
 			*Param = ilStates[ilCurrentPos].ilJpgQuality;
 			break;
@@ -735,6 +743,8 @@ ILvoid ILAPIENTRY ilPushAttrib(ILuint Bits)
 		ilStates[ilCurrentPos].ilJpgFormat = ilStates[ilCurrentPos-1].ilJpgFormat;
 		ilStates[ilCurrentPos].ilDxtcFormat = ilStates[ilCurrentPos-1].ilDxtcFormat;
 		ilStates[ilCurrentPos].ilPcdPicNum = ilStates[ilCurrentPos-1].ilPcdPicNum;
+		ilStates[ilCurrentPos].ilDxtcMipmapSkip = ilStates[ilCurrentPos-1].ilDxtcMipmapSkip;
+		ilStates[ilCurrentPos].ilDxtcMipmapCount = ilStates[ilCurrentPos-1].ilDxtcMipmapCount;
 
 		ilStates[ilCurrentPos].ilPngAlphaIndex = ilStates[ilCurrentPos-1].ilPngAlphaIndex;
 
@@ -1030,6 +1040,18 @@ ILvoid ILAPIENTRY ilSetInteger(ILenum Mode, ILint Param)
 				return;
 			}
 			break;
+		case IL_DXTC_MIPMAP_SKIP:
+			if (Param >= 0) {
+				ilStates[ilCurrentPos].ilDxtcMipmapSkip = Param;
+				return;
+			}
+			break;
+		case IL_DXTC_MIPMAP_COUNT:
+			if (Param >= -1) {
+				ilStates[ilCurrentPos].ilDxtcMipmapCount = Param;
+				return;
+			}
+			break;
 		case IL_JPG_SAVE_FORMAT:
 			if (Param == IL_JFIF || Param == IL_EXIF) {
 				ilStates[ilCurrentPos].ilJpgFormat = Param;
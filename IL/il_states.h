@@ -71,6 +71,8 @@ typedef struct IL_STATES
 	ILenum		ilJpgFormat;
 	ILenum		ilDxtcFormat;
 	ILenum		ilPcdPicNum;
+	ILint		ilDxtcMipmapSkip;
+	ILint		ilDxtcMipmapCount;
 
 	ILint		ilPngAlphaIndex;	// this index should be treated as an alpha key (most formats use this rather than having alpha in the palette), -1 for none
 									// currently only used when writing out .png files and should obviously be set to -1 most of the time
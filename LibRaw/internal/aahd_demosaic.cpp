@@ -72,13 +72,24 @@ struct AAHD {
 	void make_ahd_rb_hv(int i);
 	void make_ahd_rb_last(int i);
 	void evaluate_ahd();
+	void evaluate_yuv_line(int i);
+	void evaluate_homo_line(int i);
+	void evaluate_dirs_line(int i);
 	void combine_image();
+	void combine_line(int i);
 	void hide_hots();
 	void refine_hv_dirs();
 	void refine_hv_dirs(int i, int js);
+	void refine_hv_dline(int i) {
+		refine_hv_dirs(i, i & 1);
+	}
+	void refine_hv_dline_alt(int i) {
+		refine_hv_dirs(i, (i & 1) ^ 1);
+	}
 	void refine_ihv_dirs(int i);
 	void illustrate_dirs();
 	void illustrate_dline(int i);
+	libraw_thread_pool *workers;
 };
 
 const float AAHD::yuv_coeff[3][3] = {
@@ -170,6 +181,7 @@ AAHD::AAHD(LibRaw& _libraw) :
 		}
 	}
 	channels_max = MAX(MAX(channel_maximum[0], channel_maximum[1]), channel_maximum[2]);
+	workers = libraw.get_thread_pool();
 }
 
 void AAHD::hide_hots() {
@@ -278,26 +290,11 @@ const static float d65_white[3] = {
 	1.088754f };
 
 void AAHD::evaluate_ahd() {
-	int hvdir[4] = {
-		Pw,
-		Pe,
-		Pn,
-		Ps };
 	/*
 	 * YUV
 	 *
 	 */
-	for (int d = 0; d < 2; ++d) {
-		for (int i = 0; i < nr_width * nr_height; ++i) {
-			ushort3 rgb;
-			for (int c = 0; c < 3; ++c) {
-				rgb[c] = gammaLUT[rgb_ahd[d][i][c]];
-			}
-			yuv[d][i][0] = Y(rgb);
-			yuv[d][i][1] = U(rgb);
-			yuv[d][i][2] = V(rgb);
-		}
-	}
+	demosaic_lines(*this, &AAHD::evaluate_yuv_line, 0, nr_height, 1, workers);
 	/* */
 	/*
 	 * Lab
@@ -332,127 +329,159 @@ void AAHD::evaluate_ahd() {
 	 }
 	 }
 	 * Lab */
-	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		int moff = nr_offset(i + nr_margin, nr_margin);
-		for (int j = 0; j < libraw.imgdata.sizes.iwidth; j++, ++moff) {
-			int3 *ynr;
-			float ydiff[2][4];
-			int uvdiff[2][4];
-			for (int d = 0; d < 2; ++d) {
-				ynr = &yuv[d][moff];
-				for (int k = 0; k < 4; k++) {
-					ydiff[d][k] = ABS(ynr[0][0] - ynr[hvdir[k]][0]);
-					uvdiff[d][k] = SQR(ynr[0][1] - ynr[hvdir[k]][1])
-							+ SQR(ynr[0][2] - ynr[hvdir[k]][2]);
-				}
-			}
-			float yeps = MIN(MAX(ydiff[0][0], ydiff[0][1]), MAX(ydiff[1][2], ydiff[1][3]));
-			int uveps = MIN(MAX(uvdiff[0][0], uvdiff[0][1]), MAX(uvdiff[1][2], uvdiff[1][3]));
-			for (int d = 0; d < 2; d++) {
-				ynr = &yuv[d][moff];
-				for (int k = 0; k < 4; k++)
-					if (ydiff[d][k] <= yeps && uvdiff[d][k] <= uveps) {
-						homo[d][moff + hvdir[k]]++;
-						if (k / 2 == d) {
-							// если в сонаправленном направлении интеполяции следующие точки так же гомогенны, учтём их тоже
-							for (int m = 2; m < 4; ++m) {
-								int hvd = m * hvdir[k];
-								if (ABS(ynr[0][0] - ynr[hvd][0]) < yeps
-										&& SQR(ynr[0][1] - ynr[hvd][1])
-												+ SQR(ynr[0][2] - ynr[hvd][2]) < uveps) {
-									homo[d][moff + hvd]++;
-								} else
-									break;
-							}
-						}
-					}
+	/*
+	 * evaluate_homo_line() bumps homo[] up to three lines above and below
+	 * its own, so lines seven apart never collide; each residue is run as
+	 * a separate pass.
+	 */
+	for (int p = 0; p < 7; ++p)
+		demosaic_lines(*this, &AAHD::evaluate_homo_line, p, libraw.imgdata.sizes.iheight, 7,
+				workers);
+	demosaic_lines(*this, &AAHD::evaluate_dirs_line, 0, libraw.imgdata.sizes.iheight, 1, workers);
+}
+
+void AAHD::evaluate_yuv_line(int i) {
+	for (int d = 0; d < 2; ++d) {
+		int moff = nr_offset(i, 0);
+		for (int j = 0; j < nr_width; ++j, ++moff) {
+			ushort3 rgb;
+			for (int c = 0; c < 3; ++c) {
+				rgb[c] = gammaLUT[rgb_ahd[d][moff][c]];
 			}
+			yuv[d][moff][0] = Y(rgb);
+			yuv[d][moff][1] = U(rgb);
+			yuv[d][moff][2] = V(rgb);
 		}
 	}
-	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		int moff = nr_offset(i + nr_margin, nr_margin);
-		for (int j = 0; j < libraw.imgdata.sizes.iwidth; j++, ++moff) {
-			char hm[2];
-			for (int d = 0; d < 2; d++) {
-				hm[d] = 0;
-				char *hh = &homo[d][moff];
-				for (int hx = -1; hx < 2; hx++)
-					for (int hy = -1; hy < 2; hy++)
-						hm[d] += hh[nr_offset(hy, hx)];
+}
+
+void AAHD::evaluate_homo_line(int i) {
+	int hvdir[4] = {
+		Pw,
+		Pe,
+		Pn,
+		Ps };
+	int moff = nr_offset(i + nr_margin, nr_margin);
+	for (int j = 0; j < libraw.imgdata.sizes.iwidth; j++, ++moff) {
+		int3 *ynr;
+		float ydiff[2][4];
+		int uvdiff[2][4];
+		for (int d = 0; d < 2; ++d) {
+			ynr = &yuv[d][moff];
+			for (int k = 0; k < 4; k++) {
+				ydiff[d][k] = ABS(ynr[0][0] - ynr[hvdir[k]][0]);
+				uvdiff[d][k] = SQR(ynr[0][1] - ynr[hvdir[k]][1])
+						+ SQR(ynr[0][2] - ynr[hvdir[k]][2]);
 			}
-			char d = 0;
-			if (hm[0] != hm[1]) {
-				if (hm[1] > hm[0]) {
-					d = VERSH;
-				} else {
-					d = HORSH;
+		}
+		float yeps = MIN(MAX(ydiff[0][0], ydiff[0][1]), MAX(ydiff[1][2], ydiff[1][3]));
+		int uveps = MIN(MAX(uvdiff[0][0], uvdiff[0][1]), MAX(uvdiff[1][2], uvdiff[1][3]));
+		for (int d = 0; d < 2; d++) {
+			ynr = &yuv[d][moff];
+			for (int k = 0; k < 4; k++)
+				if (ydiff[d][k] <= yeps && uvdiff[d][k] <= uveps) {
+					homo[d][moff + hvdir[k]]++;
+					if (k / 2 == d) {
+						// если в сонаправленном направлении интеполяции следующие точки так же гомогенны, учтём их тоже
+						for (int m = 2; m < 4; ++m) {
+							int hvd = m * hvdir[k];
+							if (ABS(ynr[0][0] - ynr[hvd][0]) < yeps
+									&& SQR(ynr[0][1] - ynr[hvd][1])
+											+ SQR(ynr[0][2] - ynr[hvd][2]) < uveps) {
+								homo[d][moff + hvd]++;
+							} else
+								break;
+						}
+					}
 				}
+		}
+	}
+}
+
+void AAHD::evaluate_dirs_line(int i) {
+	int moff = nr_offset(i + nr_margin, nr_margin);
+	for (int j = 0; j < libraw.imgdata.sizes.iwidth; j++, ++moff) {
+		char hm[2];
+		for (int d = 0; d < 2; d++) {
+			hm[d] = 0;
+			char *hh = &homo[d][moff];
+			for (int hx = -1; hx < 2; hx++)
+				for (int hy = -1; hy < 2; hy++)
+					hm[d] += hh[nr_offset(hy, hx)];
+		}
+		char d = 0;
+		if (hm[0] != hm[1]) {
+			if (hm[1] > hm[0]) {
+				d = VERSH;
 			} else {
-				int3 *ynr = &yuv[1][moff];
-				int gv = SQR(2 * ynr[0][0] - ynr[Pn][0] - ynr[Ps][0]);
-				gv += SQR(2 * ynr[0][1] - ynr[Pn][1] - ynr[Ps][1])
-						+ SQR(2 * ynr[0][2] - ynr[Pn][2] - ynr[Ps][2]);
-				ynr = &yuv[1][moff + Pn];
-				gv += (SQR(2 * ynr[0][0] - ynr[Pn][0] - ynr[Ps][0])
-						+ SQR(2 * ynr[0][1] - ynr[Pn][1] - ynr[Ps][1])
-						+ SQR(2 * ynr[0][2] - ynr[Pn][2] - ynr[Ps][2])) / 2;
-				ynr = &yuv[1][moff + Ps];
-				gv += (SQR(2 * ynr[0][0] - ynr[Pn][0] - ynr[Ps][0])
-						+ SQR(2 * ynr[0][1] - ynr[Pn][1] - ynr[Ps][1])
-						+ SQR(2 * ynr[0][2] - ynr[Pn][2] - ynr[Ps][2])) / 2;
-				ynr = &yuv[0][moff];
-				int gh = SQR(2 * ynr[0][0] - ynr[Pw][0] - ynr[Pe][0]);
-				gh += SQR(2 * ynr[0][1] - ynr[Pw][1] - ynr[Pe][1])
-						+ SQR(2 * ynr[0][2] - ynr[Pw][2] - ynr[Pe][2]);
-				ynr = &yuv[0][moff + Pw];
-				gh += (SQR(2 * ynr[0][0] - ynr[Pw][0] - ynr[Pe][0])
-						+ SQR(2 * ynr[0][1] - ynr[Pw][1] - ynr[Pe][1])
-						+ SQR(2 * ynr[0][2] - ynr[Pw][2] - ynr[Pe][2])) / 2;
-				ynr = &yuv[0][moff + Pe];
-				gh += (SQR(2 * ynr[0][0] - ynr[Pw][0] - ynr[Pe][0])
-						+ SQR(2 * ynr[0][1] - ynr[Pw][1] - ynr[Pe][1])
-						+ SQR(2 * ynr[0][2] - ynr[Pw][2] - ynr[Pe][2])) / 2;
-				if (gv > gh)
-					d = HOR;
-				else
-					d = VER;
+				d = HORSH;
 			}
-			ndir[moff] |= d;
+		} else {
+			int3 *ynr = &yuv[1][moff];
+			int gv = SQR(2 * ynr[0][0] - ynr[Pn][0] - ynr[Ps][0]);
+			gv += SQR(2 * ynr[0][1] - ynr[Pn][1] - ynr[Ps][1])
+					+ SQR(2 * ynr[0][2] - ynr[Pn][2] - ynr[Ps][2]);
+			ynr = &yuv[1][moff + Pn];
+			gv += (SQR(2 * ynr[0][0] - ynr[Pn][0] - ynr[Ps][0])
+					+ SQR(2 * ynr[0][1] - ynr[Pn][1] - ynr[Ps][1])
+					+ SQR(2 * ynr[0][2] - ynr[Pn][2] - ynr[Ps][2])) / 2;
+			ynr = &yuv[1][moff + Ps];
+			gv += (SQR(2 * ynr[0][0] - ynr[Pn][0] - ynr[Ps][0])
+					+ SQR(2 * ynr[0][1] - ynr[Pn][1] - ynr[Ps][1])
+					+ SQR(2 * ynr[0][2] - ynr[Pn][2] - ynr[Ps][2])) / 2;
+			ynr = &yuv[0][moff];
+			int gh = SQR(2 * ynr[0][0] - ynr[Pw][0] - ynr[Pe][0]);
+			gh += SQR(2 * ynr[0][1] - ynr[Pw][1] - ynr[Pe][1])
+					+ SQR(2 * ynr[0][2] - ynr[Pw][2] - ynr[Pe][2]);
+			ynr = &yuv[0][moff + Pw];
+			gh += (SQR(2 * ynr[0][0] - ynr[Pw][0] - ynr[Pe][0])
+					+ SQR(2 * ynr[0][1] - ynr[Pw][1] - ynr[Pe][1])
+					+ SQR(2 * ynr[0][2] - ynr[Pw][2] - ynr[Pe][2])) / 2;
+			ynr = &yuv[0][moff + Pe];
+			gh += (SQR(2 * ynr[0][0] - ynr[Pw][0] - ynr[Pe][0])
+					+ SQR(2 * ynr[0][1] - ynr[Pw][1] - ynr[Pe][1])
+					+ SQR(2 * ynr[0][2] - ynr[Pw][2] - ynr[Pe][2])) / 2;
+			if (gv > gh)
+				d = HOR;
+			else
+				d = VER;
 		}
+		ndir[moff] |= d;
 	}
 }
 
 void AAHD::combine_image() {
-	for (int i = 0, i_out = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		int moff = nr_offset(i + nr_margin, nr_margin);
-		for (int j = 0; j < libraw.imgdata.sizes.iwidth; j++, ++moff, ++i_out) {
-			if (ndir[moff] & HOT) {
-				int c = libraw.COLOR(i, j);
-				rgb_ahd[1][moff][c] = rgb_ahd[0][moff][c] = libraw.imgdata.image[i_out][c];
+	demosaic_lines(*this, &AAHD::combine_line, 0, libraw.imgdata.sizes.iheight, 1, workers);
+}
 
-			}
-			if (ndir[moff] & VER) {
-				libraw.imgdata.image[i_out][0] = rgb_ahd[1][moff][0];
-				libraw.imgdata.image[i_out][3] = libraw.imgdata.image[i_out][1] =
-						rgb_ahd[1][moff][1];
-				libraw.imgdata.image[i_out][2] = rgb_ahd[1][moff][2];
-			} else {
-				libraw.imgdata.image[i_out][0] = rgb_ahd[0][moff][0];
-				libraw.imgdata.image[i_out][3] = libraw.imgdata.image[i_out][1] =
-						rgb_ahd[0][moff][1];
-				libraw.imgdata.image[i_out][2] = rgb_ahd[0][moff][2];
-			}
+void AAHD::combine_line(int i) {
+	int moff = nr_offset(i + nr_margin, nr_margin);
+	int i_out = i * libraw.imgdata.sizes.iwidth;
+	for (int j = 0; j < libraw.imgdata.sizes.iwidth; j++, ++moff, ++i_out) {
+		if (ndir[moff] & HOT) {
+			int c = libraw.COLOR(i, j);
+			rgb_ahd[1][moff][c] = rgb_ahd[0][moff][c] = libraw.imgdata.image[i_out][c];
+
+		}
+		if (ndir[moff] & VER) {
+			libraw.imgdata.image[i_out][0] = rgb_ahd[1][moff][0];
+			libraw.imgdata.image[i_out][3] = libraw.imgdata.image[i_out][1] =
+					rgb_ahd[1][moff][1];
+			libraw.imgdata.image[i_out][2] = rgb_ahd[1][moff][2];
+		} else {
+			libraw.imgdata.image[i_out][0] = rgb_ahd[0][moff][0];
+			libraw.imgdata.image[i_out][3] = libraw.imgdata.image[i_out][1] =
+					rgb_ahd[0][moff][1];
+			libraw.imgdata.image[i_out][2] = rgb_ahd[0][moff][2];
 		}
 	}
 }
 
 void AAHD::refine_hv_dirs() {
-	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		refine_hv_dirs(i, i & 1);
-	}
-	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		refine_hv_dirs(i, (i & 1) ^ 1);
-	}
+	demosaic_lines(*this, &AAHD::refine_hv_dline, 0, libraw.imgdata.sizes.iheight, 1, workers);
+	demosaic_lines(*this, &AAHD::refine_hv_dline_alt, 0, libraw.imgdata.sizes.iheight, 1,
+			workers);
+	/* refine_ihv_dirs() reads the line it updated just before, keep it serial */
 	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
 		refine_ihv_dirs(i);
 	}
@@ -509,9 +538,7 @@ void AAHD::refine_hv_dirs(int i, int js) {
  * вычисление недостающих зелёных точек.
  */
 void AAHD::make_ahd_greens() {
-	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		make_ahd_gline(i);
-	}
+	demosaic_lines(*this, &AAHD::make_ahd_gline, 0, libraw.imgdata.sizes.iheight, 1, workers);
 }
 
 void AAHD::make_ahd_gline(int i) {
@@ -618,12 +645,8 @@ void AAHD::make_ahd_rb_hv(int i) {
 }
 
 void AAHD::make_ahd_rb() {
-	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		make_ahd_rb_hv(i);
-	}
-	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		make_ahd_rb_last(i);
-	}
+	demosaic_lines(*this, &AAHD::make_ahd_rb_hv, 0, libraw.imgdata.sizes.iheight, 1, workers);
+	demosaic_lines(*this, &AAHD::make_ahd_rb_last, 0, libraw.imgdata.sizes.iheight, 1, workers);
 }
 
 void AAHD::make_ahd_rb_last(int i) {
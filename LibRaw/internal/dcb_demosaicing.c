@@ -43,12 +43,17 @@
 // interpolates green vertically and saves it to image3
 void CLASS dcb_ver(float (*image3)[3])
 {
-	int row, col, u=width, v=2*u, indx;
+	demosaic_lines(*this, &LibRaw::dcb_ver_row, image3, 2, height-2, 1, _workers);
+}
 
-	for (row=2; row < height-2; row++)
-		for (col=2+(FC(row,2)&1),indx=row*width+col; col < u-2; col+=2,indx+=2) {
+void CLASS dcb_ver_row(int row, void *buf)
+{
+	float (*image3)[3] = (float (*)[3]) buf;
+	int col, u=width, indx;
+
+	for (col=2+(FC(row,2)&1),indx=row*width+col; col < u-2; col+=2,indx+=2) {
 	
-			image3[indx][1] = CLIP((image[indx+u][1] + image[indx-u][1])/2.0);
+		image3[indx][1] = CLIP((image[indx+u][1] + image[indx-u][1])/2.0);
 
 	}	
 }
@@ -57,12 +62,17 @@ void CLASS dcb_ver(float (*image3)[3])
 // interpolates green horizontally and saves it to image2
 void CLASS dcb_hor(float (*image2)[3])
 {
-	int row, col, u=width, v=2*u, indx;
+	demosaic_lines(*this, &LibRaw::dcb_hor_row, image2, 2, height-2, 1, _workers);
+}
+
+void CLASS dcb_hor_row(int row, void *buf)
+{
+	float (*image2)[3] = (float (*)[3]) buf;
+	int col, u=width, indx;
 	
-	for (row=2; row < height-2; row++)
-		for (col=2+(FC(row,2)&1),indx=row*width+col; col < u-2; col+=2,indx+=2) {
-			
-			image2[indx][1] = CLIP((image[indx+1][1] + image[indx-1][1])/2.0);
+	for (col=2+(FC(row,2)&1),indx=row*width+col; col < u-2; col+=2,indx+=2) {
+		
+		image2[indx][1] = CLIP((image[indx+1][1] + image[indx-1][1])/2.0);
 
 	}	
 }
@@ -72,111 +82,147 @@ void CLASS dcb_hor(float (*image2)[3])
 // missing colors are interpolated
 void CLASS dcb_color()
 {
-	int row, col, c, d, u=width, indx;
+	demosaic_lines(*this, &LibRaw::dcb_color_rb_row, 1, height-1, 1, _workers);
+	demosaic_lines(*this, &LibRaw::dcb_color_g_row, 1, height-1, 1, _workers);
+}
 
+void CLASS dcb_color_rb_row(int row)
+{
+	int col, c, u=width, indx;
 
-	for (row=1; row < height-1; row++)
-		for (col=1+(FC(row,1) & 1), indx=row*width+col, c=2-FC(row,col); col < u-1; col+=2, indx+=2) {
+	for (col=1+(FC(row,1) & 1), indx=row*width+col, c=2-FC(row,col); col < u-1; col+=2, indx+=2) {
 
-			
-			image[indx][c] = CLIP(( 
-			4*image[indx][1] 
-			- image[indx+u+1][1] - image[indx+u-1][1] - image[indx-u+1][1] - image[indx-u-1][1] 
-			+ image[indx+u+1][c] + image[indx+u-1][c] + image[indx-u+1][c] + image[indx-u-1][c] )/4.0);
-		}
+		
+		image[indx][c] = CLIP(( 
+		4*image[indx][1] 
+		- image[indx+u+1][1] - image[indx+u-1][1] - image[indx-u+1][1] - image[indx-u-1][1] 
+		+ image[indx+u+1][c] + image[indx+u-1][c] + image[indx-u+1][c] + image[indx-u-1][c] )/4.0);
+	}
+}
 
-	for (row=1; row<height-1; row++)
-		for (col=1+(FC(row,2) & 1), indx=row*width+col,c=FC(row,col+1),d=2-c; col<width-1; col+=2, indx+=2) {
-			
-			image[indx][c] = CLIP((2*image[indx][1] - image[indx+1][1] - image[indx-1][1] + image[indx+1][c] + image[indx-1][c])/2.0);
-			image[indx][d] = CLIP((2*image[indx][1] - image[indx+u][1] - image[indx-u][1] + image[indx+u][d] + image[indx-u][d])/2.0);
-		}	
+void CLASS dcb_color_g_row(int row)
+{
+	int col, c, d, u=width, indx;
+
+	for (col=1+(FC(row,2) & 1), indx=row*width+col,c=FC(row,col+1),d=2-c; col<width-1; col+=2, indx+=2) {
+		
+		image[indx][c] = CLIP((2*image[indx][1] - image[indx+1][1] - image[indx-1][1] + image[indx+1][c] + image[indx-1][c])/2.0);
+		image[indx][d] = CLIP((2*image[indx][1] - image[indx+u][1] - image[indx-u][1] + image[indx+u][d] + image[indx-u][d])/2.0);
+	}	
 }
 
 
 // missing R and B are interpolated horizontally and saved in image2
 void CLASS dcb_color2(float (*image2)[3])
 {
-	int row, col, c, d, u=width, indx;
+	demosaic_lines(*this, &LibRaw::dcb_color2_rb_row, image2, 1, height-1, 1, _workers);
+	demosaic_lines(*this, &LibRaw::dcb_color2_g_row, image2, 1, height-1, 1, _workers);
+}
 
+void CLASS dcb_color2_rb_row(int row, void *buf)
+{
+	float (*image2)[3] = (float (*)[3]) buf;
+	int col, c, u=width, indx;
 
-	for (row=1; row < height-1; row++)
-		for (col=1+(FC(row,1) & 1), indx=row*width+col, c=2-FC(row,col); col < u-1; col+=2, indx+=2) {
+	for (col=1+(FC(row,1) & 1), indx=row*width+col, c=2-FC(row,col); col < u-1; col+=2, indx+=2) {
 
-			
-			image2[indx][c] = CLIP(( 
-			4*image2[indx][1] 
-			- image2[indx+u+1][1] - image2[indx+u-1][1] - image2[indx-u+1][1] - image2[indx-u-1][1] 
-			+ image[indx+u+1][c] + image[indx+u-1][c] + image[indx-u+1][c] + image[indx-u-1][c] )/4.0);
-		}
+		
+		image2[indx][c] = CLIP(( 
+		4*image2[indx][1] 
+		- image2[indx+u+1][1] - image2[indx+u-1][1] - image2[indx-u+1][1] - image2[indx-u-1][1] 
+		+ image[indx+u+1][c] + image[indx+u-1][c] + image[indx-u+1][c] + image[indx-u-1][c] )/4.0);
+	}
+}
 
-	for (row=1; row<height-1; row++)
-		for (col=1+(FC(row,2) & 1), indx=row*width+col,c=FC(row,col+1),d=2-c; col<width-1; col+=2, indx+=2) {
-			
-			image2[indx][c] = CLIP((image[indx+1][c] + image[indx-1][c])/2.0);
-			image2[indx][d] = CLIP((2*image2[indx][1] - image2[indx+u][1] - image2[indx-u][1] + image[indx+u][d] + image[indx-u][d])/2.0);
-		}	
+void CLASS dcb_color2_g_row(int row, void *buf)
+{
+	float (*image2)[3] = (float (*)[3]) buf;
+	int col, c, d, u=width, indx;
+
+	for (col=1+(FC(row,2) & 1), indx=row*width+col,c=FC(row,col+1),d=2-c; col<width-1; col+=2, indx+=2) {
+		
+		image2[indx][c] = CLIP((image[indx+1][c] + image[indx-1][c])/2.0);
+		image2[indx][d] = CLIP((2*image2[indx][1] - image2[indx+u][1] - image2[indx-u][1] + image[indx+u][d] + image[indx-u][d])/2.0);
+	}	
 }
 
 
 // missing R and B are interpolated vertically and saved in image3
 void CLASS dcb_color3(float (*image3)[3])
 {
-	int row, col, c, d, u=width, indx;
+	demosaic_lines(*this, &LibRaw::dcb_color3_rb_row, image3, 1, height-1, 1, _workers);
+	demosaic_lines(*this, &LibRaw::dcb_color3_g_row, image3, 1, height-1, 1, _workers);
+}
 
+void CLASS dcb_color3_rb_row(int row, void *buf)
+{
+	float (*image3)[3] = (float (*)[3]) buf;
+	int col, c, u=width, indx;
 
-	for (row=1; row < height-1; row++)
-		for (col=1+(FC(row,1) & 1), indx=row*width+col, c=2-FC(row,col); col < u-1; col+=2, indx+=2) {
+	for (col=1+(FC(row,1) & 1), indx=row*width+col, c=2-FC(row,col); col < u-1; col+=2, indx+=2) {
 
-			
-			image3[indx][c] = CLIP(( 
-			4*image3[indx][1] 
-			- image3[indx+u+1][1] - image3[indx+u-1][1] - image3[indx-u+1][1] - image3[indx-u-1][1] 
-			+ image[indx+u+1][c] + image[indx+u-1][c] + image[indx-u+1][c] + image[indx-u-1][c] )/4.0);
-		}
+		
+		image3[indx][c] = CLIP(( 
+		4*image3[indx][1] 
+		- image3[indx+u+1][1] - image3[indx+u-1][1] - image3[indx-u+1][1] - image3[indx-u-1][1] 
+		+ image[indx+u+1][c] + image[indx+u-1][c] + image[indx-u+1][c] + image[indx-u-1][c] )/4.0);
+	}
+}
 
-	for (row=1; row<height-1; row++)
-		for (col=1+(FC(row,2) & 1), indx=row*width+col,c=FC(row,col+1),d=2-c; col<width-1; col+=2, indx+=2) {
-			
-			image3[indx][c] = CLIP((2*image3[indx][1] - image3[indx+1][1] - image3[indx-1][1] + image[indx+1][c] + image[indx-1][c])/2.0);
-			image3[indx][d] = CLIP((image[indx+u][d] + image[indx-u][d])/2.0);
-		}	
+void CLASS dcb_color3_g_row(int row, void *buf)
+{
+	float (*image3)[3] = (float (*)[3]) buf;
+	int col, c, d, u=width, indx;
+
+	for (col=1+(FC(row,2) & 1), indx=row*width+col,c=FC(row,col+1),d=2-c; col<width-1; col+=2, indx+=2) {
+		
+		image3[indx][c] = CLIP((2*image3[indx][1] - image3[indx+1][1] - image3[indx-1][1] + image[indx+1][c] + image[indx-1][c])/2.0);
+		image3[indx][d] = CLIP((image[indx+u][d] + image[indx-u][d])/2.0);
+	}	
 }
 
 
 // decides the primary green interpolation direction
 void CLASS dcb_decide(float (*image2)[3], float (*image3)[3])
 {
-	int row, col, c, d, u=width, v=2*u, indx;
+	float (*buffers[2])[3] = { image2, image3 };
+
+	demosaic_lines(*this, &LibRaw::dcb_decide_row, buffers, 2, height-2, 1, _workers);
+}
+
+void CLASS dcb_decide_row(int row, void *buf)
+{
+	float (*image2)[3] = ((float (**)[3]) buf)[0];
+	float (*image3)[3] = ((float (**)[3]) buf)[1];
+	int col, c, d, u=width, v=2*u, indx;
 	float current, current2, current3;
 
-	for (row=2; row < height-2; row++)
-		for (col=2+(FC(row,2)&1),indx=row*width+col, c=FC(row,col); col < u-2; col+=2,indx+=2) {
+	for (col=2+(FC(row,2)&1),indx=row*width+col, c=FC(row,col); col < u-2; col+=2,indx+=2) {
 	
-		d=ABS(c-2);
+	d=ABS(c-2);
 
    current = MAX(image[indx+v][c], MAX(image[indx-v][c], MAX(image[indx-2][c], image[indx+2][c]))) -
-			 MIN(image[indx+v][c], MIN(image[indx-v][c], MIN(image[indx-2][c], image[indx+2][c]))) +
-			 MAX(image[indx+1+u][d], MAX(image[indx+1-u][d], MAX(image[indx-1+u][d], image[indx-1-u][d]))) -
-			 MIN(image[indx+1+u][d], MIN(image[indx+1-u][d], MIN(image[indx-1+u][d], image[indx-1-u][d])));
-		
+		 MIN(image[indx+v][c], MIN(image[indx-v][c], MIN(image[indx-2][c], image[indx+2][c]))) +
+		 MAX(image[indx+1+u][d], MAX(image[indx+1-u][d], MAX(image[indx-1+u][d], image[indx-1-u][d]))) -
+		 MIN(image[indx+1+u][d], MIN(image[indx+1-u][d], MIN(image[indx-1+u][d], image[indx-1-u][d])));
+	
   current2 = MAX(image2[indx+v][d], MAX(image2[indx-v][d], MAX(image2[indx-2][d], image2[indx+2][d]))) -
-			 MIN(image2[indx+v][d], MIN(image2[indx-v][d], MIN(image2[indx-2][d], image2[indx+2][d]))) +
-			 MAX(image2[indx+1+u][c], MAX(image2[indx+1-u][c], MAX(image2[indx-1+u][c], image2[indx-1-u][c]))) -
-			 MIN(image2[indx+1+u][c], MIN(image2[indx+1-u][c], MIN(image2[indx-1+u][c], image2[indx-1-u][c])));
-			  
+		 MIN(image2[indx+v][d], MIN(image2[indx-v][d], MIN(image2[indx-2][d], image2[indx+2][d]))) +
+		 MAX(image2[indx+1+u][c], MAX(image2[indx+1-u][c], MAX(image2[indx-1+u][c], image2[indx-1-u][c]))) -
+		 MIN(image2[indx+1+u][c], MIN(image2[indx+1-u][c], MIN(image2[indx-1+u][c], image2[indx-1-u][c])));
+		  
   current3 = MAX(image3[indx+v][d], MAX(image3[indx-v][d], MAX(image3[indx-2][d], image3[indx+2][d]))) -
-			 MIN(image3[indx+v][d], MIN(image3[indx-v][d], MIN(image3[indx-2][d], image3[indx+2][d]))) +
-			 MAX(image3[indx+1+u][c], MAX(image3[indx+1-u][c], MAX(image3[indx-1+u][c], image3[indx-1-u][c]))) -
-			 MIN(image3[indx+1+u][c], MIN(image3[indx+1-u][c], MIN(image3[indx-1+u][c], image3[indx-1-u][c])));
+		 MIN(image3[indx+v][d], MIN(image3[indx-v][d], MIN(image3[indx-2][d], image3[indx+2][d]))) +
+		 MAX(image3[indx+1+u][c], MAX(image3[indx+1-u][c], MAX(image3[indx-1+u][c], image3[indx-1-u][c]))) -
+		 MIN(image3[indx+1+u][c], MIN(image3[indx+1-u][c], MIN(image3[indx-1+u][c], image3[indx-1-u][c])));
 
+	
+		if (ABS(current-current2) < ABS(current-current3))
+			image[indx][1] = image2[indx][1];
+		else
+			image[indx][1] = image3[indx][1];				
 		
-			if (ABS(current-current2) < ABS(current-current3))
-				image[indx][1] = image2[indx][1];
-			else
-				image[indx][1] = image3[indx][1];				
-			
-		
+	
 	}
 }
 
@@ -207,6 +253,7 @@ void CLASS dcb_restore_from_buffer(float (*image2)[3])
 
 
 // R and B smoothing using green contrast, all pixels except 2 pixel wide border
+// (reads neighbours this loop has already smoothed, so it stays serial)
 void CLASS dcb_pp()
 {
 	int g1, r1, b1, u=width, indx, row, col;
@@ -228,6 +275,7 @@ void CLASS dcb_pp()
 
 
 // green blurring correction, helps to get the nyquist right
+// (reads greens this loop has already corrected, so it stays serial)
 void CLASS dcb_nyquist()
 {
 	int row, col, c, u=width, v=2*u, indx;
@@ -250,43 +298,16 @@ void CLASS dcb_nyquist()
 // missing colors are interpolated using high quality algorithm by Luis Sanz Rodríguez
 void CLASS dcb_color_full()
 {
-	int row,col,c,d,i,j,u=width,v=2*u,w=3*u,indx, g1, g2;
-	float f[4],g[4],(*chroma)[2];
+	int row,col,u=width,indx, g1, g2;
+	float (*chroma)[2];
 
 	chroma = (float (*)[2]) calloc(width*height,sizeof *chroma); merror (chroma, "dcb_color_full()");
 
-	for (row=1; row < height-1; row++)
-		for (col=1+(FC(row,1)&1),indx=row*width+col,c=FC(row,col),d=c/2; col < u-1; col+=2,indx+=2)
-			chroma[indx][d]=image[indx][c]-image[indx][1];
-
-	for (row=3; row<height-3; row++)
-		for (col=3+(FC(row,1)&1),indx=row*width+col,c=1-FC(row,col)/2,d=1-c; col<u-3; col+=2,indx+=2) {
-			f[0]=1.0/(float)(1.0+fabs(chroma[indx-u-1][c]-chroma[indx+u+1][c])+fabs(chroma[indx-u-1][c]-chroma[indx-w-3][c])+fabs(chroma[indx+u+1][c]-chroma[indx-w-3][c]));
-			f[1]=1.0/(float)(1.0+fabs(chroma[indx-u+1][c]-chroma[indx+u-1][c])+fabs(chroma[indx-u+1][c]-chroma[indx-w+3][c])+fabs(chroma[indx+u-1][c]-chroma[indx-w+3][c]));
-			f[2]=1.0/(float)(1.0+fabs(chroma[indx+u-1][c]-chroma[indx-u+1][c])+fabs(chroma[indx+u-1][c]-chroma[indx+w+3][c])+fabs(chroma[indx-u+1][c]-chroma[indx+w-3][c]));
-			f[3]=1.0/(float)(1.0+fabs(chroma[indx+u+1][c]-chroma[indx-u-1][c])+fabs(chroma[indx+u+1][c]-chroma[indx+w-3][c])+fabs(chroma[indx-u-1][c]-chroma[indx+w+3][c]));
-			g[0]=1.325*chroma[indx-u-1][c]-0.175*chroma[indx-w-3][c]-0.075*chroma[indx-w-1][c]-0.075*chroma[indx-u-3][c];
-			g[1]=1.325*chroma[indx-u+1][c]-0.175*chroma[indx-w+3][c]-0.075*chroma[indx-w+1][c]-0.075*chroma[indx-u+3][c];
-			g[2]=1.325*chroma[indx+u-1][c]-0.175*chroma[indx+w-3][c]-0.075*chroma[indx+w-1][c]-0.075*chroma[indx+u-3][c];
-			g[3]=1.325*chroma[indx+u+1][c]-0.175*chroma[indx+w+3][c]-0.075*chroma[indx+w+1][c]-0.075*chroma[indx+u+3][c];
-			chroma[indx][c]=(f[0]*g[0]+f[1]*g[1]+f[2]*g[2]+f[3]*g[3])/(f[0]+f[1]+f[2]+f[3]);
-		}
-	for (row=3; row<height-3; row++)
-		for (col=3+(FC(row,2)&1),indx=row*width+col,c=FC(row,col+1)/2; col<u-3; col+=2,indx+=2)
-			for(d=0;d<=1;c=1-c,d++){
-				f[0]=1.0/(float)(1.0+fabs(chroma[indx-u][c]-chroma[indx+u][c])+fabs(chroma[indx-u][c]-chroma[indx-w][c])+fabs(chroma[indx+u][c]-chroma[indx-w][c]));
-				f[1]=1.0/(float)(1.0+fabs(chroma[indx+1][c]-chroma[indx-1][c])+fabs(chroma[indx+1][c]-chroma[indx+3][c])+fabs(chroma[indx-1][c]-chroma[indx+3][c]));
-				f[2]=1.0/(float)(1.0+fabs(chroma[indx-1][c]-chroma[indx+1][c])+fabs(chroma[indx-1][c]-chroma[indx-3][c])+fabs(chroma[indx+1][c]-chroma[indx-3][c]));
-				f[3]=1.0/(float)(1.0+fabs(chroma[indx+u][c]-chroma[indx-u][c])+fabs(chroma[indx+u][c]-chroma[indx+w][c])+fabs(chroma[indx-u][c]-chroma[indx+w][c]));
-			
-				g[0]=0.875*chroma[indx-u][c]+0.125*chroma[indx-w][c];
-				g[1]=0.875*chroma[indx+1][c]+0.125*chroma[indx+3][c];
-				g[2]=0.875*chroma[indx-1][c]+0.125*chroma[indx-3][c];
-				g[3]=0.875*chroma[indx+u][c]+0.125*chroma[indx+w][c];				
-
-				chroma[indx][c]=(f[0]*g[0]+f[1]*g[1]+f[2]*g[2]+f[3]*g[3])/(f[0]+f[1]+f[2]+f[3]);
-			}
+	demosaic_lines(*this, &LibRaw::dcb_chroma_row, chroma, 1, height-1, 1, _workers);
+	demosaic_lines(*this, &LibRaw::dcb_chroma_rb_row, chroma, 3, height-3, 1, _workers);
+	demosaic_lines(*this, &LibRaw::dcb_chroma_g_row, chroma, 3, height-3, 1, _workers);
 
+	// clamps against neighbours this loop has already clamped, so it stays serial
 	for(row=6; row<height-6; row++)
 		for(col=6,indx=row*width+col; col<width-6; col++,indx++){
 			image[indx][0]=CLIP(chroma[indx][0]+image[indx][1]);
@@ -314,6 +335,59 @@ void CLASS dcb_color_full()
 	free(chroma);
 }
 
+// colour differences at the red and blue pixels
+void CLASS dcb_chroma_row(int row, void *buf)
+{
+	float (*chroma)[2] = (float (*)[2]) buf;
+	int col,c,d,u=width,indx;
+
+	for (col=1+(FC(row,1)&1),indx=row*width+col,c=FC(row,col),d=c/2; col < u-1; col+=2,indx+=2)
+		chroma[indx][d]=image[indx][c]-image[indx][1];
+}
+
+// the missing colour difference at the red and blue pixels
+void CLASS dcb_chroma_rb_row(int row, void *buf)
+{
+	float (*chroma)[2] = (float (*)[2]) buf;
+	int col,c,u=width,w=3*u,indx;
+	float f[4],g[4];
+
+	for (col=3+(FC(row,1)&1),indx=row*width+col,c=1-FC(row,col)/2; col<u-3; col+=2,indx+=2) {
+		f[0]=1.0/(float)(1.0+fabs(chroma[indx-u-1][c]-chroma[indx+u+1][c])+fabs(chroma[indx-u-1][c]-chroma[indx-w-3][c])+fabs(chroma[indx+u+1][c]-chroma[indx-w-3][c]));
+		f[1]=1.0/(float)(1.0+fabs(chroma[indx-u+1][c]-chroma[indx+u-1][c])+fabs(chroma[indx-u+1][c]-chroma[indx-w+3][c])+fabs(chroma[indx+u-1][c]-chroma[indx-w+3][c]));
+		f[2]=1.0/(float)(1.0+fabs(chroma[indx+u-1][c]-chroma[indx-u+1][c])+fabs(chroma[indx+u-1][c]-chroma[indx+w+3][c])+fabs(chroma[indx-u+1][c]-chroma[indx+w-3][c]));
+		f[3]=1.0/(float)(1.0+fabs(chroma[indx+u+1][c]-chroma[indx-u-1][c])+fabs(chroma[indx+u+1][c]-chroma[indx+w-3][c])+fabs(chroma[indx-u-1][c]-chroma[indx+w+3][c]));
+		g[0]=1.325*chroma[indx-u-1][c]-0.175*chroma[indx-w-3][c]-0.075*chroma[indx-w-1][c]-0.075*chroma[indx-u-3][c];
+		g[1]=1.325*chroma[indx-u+1][c]-0.175*chroma[indx-w+3][c]-0.075*chroma[indx-w+1][c]-0.075*chroma[indx-u+3][c];
+		g[2]=1.325*chroma[indx+u-1][c]-0.175*chroma[indx+w-3][c]-0.075*chroma[indx+w-1][c]-0.075*chroma[indx+u-3][c];
+		g[3]=1.325*chroma[indx+u+1][c]-0.175*chroma[indx+w+3][c]-0.075*chroma[indx+w+1][c]-0.075*chroma[indx+u+3][c];
+		chroma[indx][c]=(f[0]*g[0]+f[1]*g[1]+f[2]*g[2]+f[3]*g[3])/(f[0]+f[1]+f[2]+f[3]);
+	}
+}
+
+// both colour differences at the green pixels
+void CLASS dcb_chroma_g_row(int row, void *buf)
+{
+	float (*chroma)[2] = (float (*)[2]) buf;
+	int col,c,d,u=width,w=3*u,indx;
+	float f[4],g[4];
+
+	for (col=3+(FC(row,2)&1),indx=row*width+col,c=FC(row,col+1)/2; col<u-3; col+=2,indx+=2)
+		for(d=0;d<=1;c=1-c,d++){
+			f[0]=1.0/(float)(1.0+fabs(chroma[indx-u][c]-chroma[indx+u][c])+fabs(chroma[indx-u][c]-chroma[indx-w][c])+fabs(chroma[indx+u][c]-chroma[indx-w][c]));
+			f[1]=1.0/(float)(1.0+fabs(chroma[indx+1][c]-chroma[indx-1][c])+fabs(chroma[indx+1][c]-chroma[indx+3][c])+fabs(chroma[indx-1][c]-chroma[indx+3][c]));
+			f[2]=1.0/(float)(1.0+fabs(chroma[indx-1][c]-chroma[indx+1][c])+fabs(chroma[indx-1][c]-chroma[indx-3][c])+fabs(chroma[indx+1][c]-chroma[indx-3][c]));
+			f[3]=1.0/(float)(1.0+fabs(chroma[indx+u][c]-chroma[indx-u][c])+fabs(chroma[indx+u][c]-chroma[indx+w][c])+fabs(chroma[indx-u][c]-chroma[indx+w][c]));
+		
+			g[0]=0.875*chroma[indx-u][c]+0.125*chroma[indx-w][c];
+			g[1]=0.875*chroma[indx+1][c]+0.125*chroma[indx+3][c];
+			g[2]=0.875*chroma[indx-1][c]+0.125*chroma[indx-3][c];
+			g[3]=0.875*chroma[indx+u][c]+0.125*chroma[indx+w][c];				
+
+			chroma[indx][c]=(f[0]*g[0]+f[1]*g[1]+f[2]*g[2]+f[3]*g[3])/(f[0]+f[1]+f[2]+f[3]);
+		}
+}
+
 
 
 
@@ -322,18 +396,21 @@ void CLASS dcb_color_full()
 // 0 = horizontal
 void CLASS dcb_map()
 {	
-	int current, row, col, c, u=width, v=2*u, indx;
+	demosaic_lines(*this, &LibRaw::dcb_map_row, 1, height-1, 1, _workers);
+}
+
+void CLASS dcb_map_row(int row)
+{
+	int col, u=width, indx;
 
-	for (row=1; row < height-1; row++) {
 	for (col=1, indx=row*width+col; col < width-1; col++, indx++) { 
 
-		if (image[indx][1] > ( image[indx-1][1] + image[indx+1][1] + image[indx-u][1] + image[indx+u][1])/4.0)
-			image[indx][3] = ((MIN( image[indx-1][1], image[indx+1][1]) + image[indx-1][1] + image[indx+1][1]) < 
-							  (MIN( image[indx-u][1], image[indx+u][1]) + image[indx-u][1] + image[indx+u][1]));   
-		else
-			image[indx][3] = ((MAX( image[indx-1][1], image[indx+1][1]) + image[indx-1][1] + image[indx+1][1]) > 
-							  (MAX( image[indx-u][1], image[indx+u][1]) + image[indx-u][1] + image[indx+u][1])); 
-	}
+	if (image[indx][1] > ( image[indx-1][1] + image[indx+1][1] + image[indx-u][1] + image[indx+u][1])/4.0)
+		image[indx][3] = ((MIN( image[indx-1][1], image[indx+1][1]) + image[indx-1][1] + image[indx+1][1]) < 
+						  (MIN( image[indx-u][1], image[indx+u][1]) + image[indx-u][1] + image[indx+u][1]));   
+	else
+		image[indx][3] = ((MAX( image[indx-1][1], image[indx+1][1]) + image[indx-1][1] + image[indx+1][1]) > 
+						  (MAX( image[indx-u][1], image[indx+u][1]) + image[indx-u][1] + image[indx+u][1])); 
 	}
 }
 
@@ -341,16 +418,20 @@ void CLASS dcb_map()
 // interpolated green pixels are corrected using the map
 void CLASS dcb_correction()
 {
-	int current, row, col, u=width, v=2*u, indx;
+	demosaic_lines(*this, &LibRaw::dcb_correction_row, 2, height-2, 1, _workers);
+}
 
-	for (row=2; row < height-2; row++)
-		for (col=2+(FC(row,2)&1),indx=row*width+col; col < u-2; col+=2,indx+=2) {
+void CLASS dcb_correction_row(int row)
+{
+	int current, col, u=width, v=2*u, indx;
 
-			current = 4*image[indx][3] + 
-				      2*(image[indx+u][3] + image[indx-u][3] + image[indx+1][3] + image[indx-1][3]) + 
-					    image[indx+v][3] + image[indx-v][3] + image[indx+2][3] + image[indx-2][3];
-						
-			image[indx][1] = ((16-current)*(image[indx-1][1] + image[indx+1][1])/2.0 + current*(image[indx-u][1] + image[indx+u][1])/2.0)/16.0;
+	for (col=2+(FC(row,2)&1),indx=row*width+col; col < u-2; col+=2,indx+=2) {
+
+		current = 4*image[indx][3] + 
+			      2*(image[indx+u][3] + image[indx-u][3] + image[indx+1][3] + image[indx-1][3]) + 
+				    image[indx+v][3] + image[indx-v][3] + image[indx+2][3] + image[indx-2][3];
+					
+		image[indx][1] = ((16-current)*(image[indx-1][1] + image[indx+1][1])/2.0 + current*(image[indx-u][1] + image[indx+u][1])/2.0)/16.0;
 
 	}
 
@@ -361,23 +442,27 @@ void CLASS dcb_correction()
 // with contrast correction
 void CLASS dcb_correction2()
 {
-	int current, row, col, c, u=width, v=2*u, indx;
-	ushort (*pix)[4];
+	demosaic_lines(*this, &LibRaw::dcb_correction2_row, 4, height-4, 1, _workers);
+}
 
-	for (row=4; row < height-4; row++)
-		for (col=4+(FC(row,2)&1),indx=row*width+col, c=FC(row,col); col < u-4; col+=2,indx+=2) {
-			
-			current = 4*image[indx][3] + 
-				      2*(image[indx+u][3] + image[indx-u][3] + image[indx+1][3] + image[indx-1][3]) + 
-					    image[indx+v][3] + image[indx-v][3] + image[indx+2][3] + image[indx-2][3];
-						
-			image[indx][1] = CLIP(((16-current)*((image[indx-1][1] + image[indx+1][1])/2.0 + image[indx][c] - (image[indx+2][c] + image[indx-2][c])/2.0) + current*((image[indx-u][1] + image[indx+u][1])/2.0 + image[indx][c] - (image[indx+v][c] + image[indx-v][c])/2.0))/16.0);			   
+void CLASS dcb_correction2_row(int row)
+{
+	int current, col, c, u=width, v=2*u, indx;
+
+	for (col=4+(FC(row,2)&1),indx=row*width+col, c=FC(row,col); col < u-4; col+=2,indx+=2) {
 		
+		current = 4*image[indx][3] + 
+			      2*(image[indx+u][3] + image[indx-u][3] + image[indx+1][3] + image[indx-1][3]) + 
+				    image[indx+v][3] + image[indx-v][3] + image[indx+2][3] + image[indx-2][3];
+					
+		image[indx][1] = CLIP(((16-current)*((image[indx-1][1] + image[indx+1][1])/2.0 + image[indx][c] - (image[indx+2][c] + image[indx-2][c])/2.0) + current*((image[indx-u][1] + image[indx+u][1])/2.0 + image[indx][c] - (image[indx+v][c] + image[indx-v][c])/2.0))/16.0);			   
+	
 	}
 
 }
 
 
+// reads greens this loop has already refined, so it stays serial
 void CLASS dcb_refinement()
 {
 	int row, col, c, u=width, v=2*u, w=3*u, indx, current;
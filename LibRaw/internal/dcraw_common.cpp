@@ -23,6 +23,7 @@ it under the terms of the one of three licenses as you choose:
 
 #include <math.h>
 #include <string.h>
+#include <algorithm>
 
 #define CLASS LibRaw::
 #include "libraw/libraw_types.h"
@@ -31,6 +32,7 @@ it under the terms of the one of three licenses as you choose:
 #include "libraw/libraw.h"
 #include "internal/defines.h"
 #include "internal/var_defines.h"
+#include "internal/demosaic_threads.h"
 int CLASS fcol (int row, int col)
 {
   static const char filter[16][16] =
@@ -441,24 +443,31 @@ int CLASS canon_s2is()
   return 0;
 }
 
-unsigned CLASS getbithuff (int nbits, ushort *huff)
+/*
+   Reads from stream with the bit buffer kept in state, so that several
+   decoders can run side by side on private streams.
+ */
+unsigned CLASS getbithuff (LibRaw_abstract_datastream *stream, LibRaw_TLS *state, int nbits, ushort *huff)
 {
 #ifdef LIBRAW_NOTHREADS
   static unsigned bitbuf=0;
   static int vbits=0, reset=0;
 #else
-#define bitbuf tls->getbits.bitbuf
-#define vbits  tls->getbits.vbits
-#define reset  tls->getbits.reset
+#define bitbuf state->getbits.bitbuf
+#define vbits  state->getbits.vbits
+#define reset  state->getbits.reset
 #endif
+  LibRaw_buffer_datastream *mem;
   unsigned c;
 
   if (nbits > 25) return 0;
   if (nbits < 0)
     return bitbuf = vbits = reset = 0;
   if (nbits == 0 || vbits < 0) return 0;
-  while (!reset && vbits < nbits && (c = fgetc(ifp)) != EOF &&
-    !(reset = zero_after_ff && c == 0xff && fgetc(ifp))) {
+  mem = stream->memory_stream();
+#define getbyte() (mem ? mem->get_byte() : fgetc(stream))
+  while (!reset && vbits < nbits && (c = getbyte()) != EOF &&
+    !(reset = zero_after_ff && c == 0xff && getbyte())) {
     bitbuf = (bitbuf << 8) + (uchar) c;
     vbits += 8;
   }
@@ -470,6 +479,7 @@ unsigned CLASS getbithuff (int nbits, ushort *huff)
     vbits -= nbits;
   if (vbits < 0) derror();
   return c;
+#undef getbyte
 #ifndef LIBRAW_NOTHREADS
 #undef bitbuf
 #undef vbits
@@ -477,6 +487,11 @@ unsigned CLASS getbithuff (int nbits, ushort *huff)
 #endif
 }
 
+unsigned CLASS getbithuff (int nbits, ushort *huff)
+{
+  return getbithuff (ifp, tls, nbits, huff);
+}
+
 #define getbits(n) getbithuff(n,0)
 #define gethuff(h) getbithuff(*h,h+1)
 
@@ -680,7 +695,7 @@ void CLASS canon_load_raw()
   FORC(2) free (huff[c]);
 }
 
-int CLASS ljpeg_start (struct jhead *jh, int info_only)
+int CLASS ljpeg_start (LibRaw_abstract_datastream *stream, struct jhead *jh, int info_only)
 {
   ushort c, tag, len;
   int cnt = 0;
@@ -689,15 +704,15 @@ int CLASS ljpeg_start (struct jhead *jh, int info_only)
 
   memset (jh, 0, sizeof *jh);
   jh->restart = INT_MAX;
-  if ((fgetc(ifp),fgetc(ifp)) != 0xd8) return 0;
+  if ((fgetc(stream),fgetc(stream)) != 0xd8) return 0;
   do {
-    if(feof(ifp)) return 0;
+    if(feof(stream)) return 0;
     if(cnt++ > 1024) return 0; // 1024 tags limit
-    if (!fread (data, 2, 2, ifp)) return 0;
+    if (!fread (data, 2, 2, stream)) return 0;
     tag =  data[0] << 8 | data[1];
     len = (data[2] << 8 | data[3]) - 2;
     if (tag <= 0xff00) return 0;
-    fread (data, 1, len, ifp);
+    fread (data, 1, len, stream);
     switch (tag) {
       case 0xffc3:        // start of frame; lossless, Huffman
 	jh->sraw = ((data[7] >> 4) * (data[7] & 15) - 1) & 3;
@@ -708,7 +723,7 @@ int CLASS ljpeg_start (struct jhead *jh, int info_only)
 	jh->high = data[1] << 8 | data[2];
 	jh->wide = data[3] << 8 | data[4];
 	jh->clrs = data[5] + jh->sraw;
-	if (len == 9 && !dng_version) getc(ifp);
+	if (len == 9 && !dng_version) getc(stream);
 	break;
       case 0xffc4:          // define Huffman tables
 	if (info_only) break;
@@ -735,7 +750,14 @@ int CLASS ljpeg_start (struct jhead *jh, int info_only)
   }
   jh->row = (ushort *) calloc (jh->wide*jh->clrs, 4);
   merror (jh->row, "ljpeg_start()");
-  return zero_after_ff = 1;
+  return 1;
+}
+
+int CLASS ljpeg_start (struct jhead *jh, int info_only)
+{
+  if (!ljpeg_start (ifp, jh, info_only)) return 0;
+  if (!info_only) zero_after_ff = 1;
+  return 1;
 }
 
 void CLASS ljpeg_end (struct jhead *jh)
@@ -745,7 +767,7 @@ void CLASS ljpeg_end (struct jhead *jh)
   free (jh->row);
 }
 
-int CLASS ljpeg_diff (ushort *huff)
+int CLASS ljpeg_diff (LibRaw_abstract_datastream *stream, LibRaw_TLS *state, ushort *huff)
 {
   int len, diff;
   if(!huff)
@@ -756,16 +778,21 @@ int CLASS ljpeg_diff (ushort *huff)
 #endif
 
 
-  len = gethuff(huff);
+  len = getbithuff (stream, state, *huff, huff+1);
   if (len == 16 && (!dng_version || dng_version >= 0x1010000))
     return -32768;
-  diff = getbits(len);
+  diff = getbithuff (stream, state, len, 0);
   if ((diff & (1 << (len-1))) == 0)
     diff -= (1 << len) - 1;
   return diff;
 }
 
-ushort * CLASS ljpeg_row (int jrow, struct jhead *jh)
+int CLASS ljpeg_diff (ushort *huff)
+{
+  return ljpeg_diff (ifp, tls, huff);
+}
+
+ushort * CLASS ljpeg_row (LibRaw_abstract_datastream *stream, LibRaw_TLS *state, int jrow, struct jhead *jh)
 {
   int col, c, diff, pred, spred=0;
   ushort mark=0, *row[3];
@@ -773,16 +800,16 @@ ushort * CLASS ljpeg_row (int jrow, struct jhead *jh)
   if (jrow * jh->wide % jh->restart == 0) {
     FORC(6) jh->vpred[c] = 1 << (jh->bits-1);
     if (jrow) {
-      fseek (ifp, -2, SEEK_CUR);
-      do mark = (mark << 8) + (c = fgetc(ifp));
+      fseek (stream, -2, SEEK_CUR);
+      do mark = (mark << 8) + (c = fgetc(stream));
       while (c != EOF && mark >> 4 != 0xffd);
     }
-    getbits(-1);
+    getbithuff (stream, state, -1, 0);
   }
   FORC3 row[c] = jh->row + jh->wide*jh->clrs*((jrow+c) & 1);
   for (col=0; col < jh->wide; col++)
     FORC(jh->clrs) {
-      diff = ljpeg_diff (jh->huff[c]);
+      diff = ljpeg_diff (stream, state, jh->huff[c]);
       if (jh->sraw && c <= jh->sraw && (col | c))
 		    pred = spred;
       else if (col) pred = row[0][-jh->clrs];
@@ -804,6 +831,11 @@ ushort * CLASS ljpeg_row (int jrow, struct jhead *jh)
   return row[2];
 }
 
+ushort * CLASS ljpeg_row (int jrow, struct jhead *jh)
+{
+  return ljpeg_row (ifp, tls, jrow, jh);
+}
+
 void CLASS lossless_jpeg_load_raw()
 {
   int jwide, jhigh, jrow, jcol, val, jidx, i, j, row=0, col=0;
@@ -1063,12 +1095,210 @@ void CLASS ljpeg_idct (struct jhead *jh)
   FORC(64) jh->idct[c] = CLIP(((float *)work[2])[c]+0.5);
 }
 
+void CLASS lossless_dng_decode_tile (LibRaw_abstract_datastream *stream, LibRaw_TLS *state, struct jhead *jh, unsigned trow, unsigned tcol)
+{
+  unsigned jwide, jrow, jcol, row, col;
+  ushort *rp;
+
+  jwide = jh->wide;
+  if (filters) jwide *= jh->clrs;
+  jwide /= MIN (is_raw, tiff_samples);
+  for (row=col=jrow=0; jrow < jh->high; jrow++) {
+#ifdef LIBRAW_LIBRARY_BUILD
+    if (stream == ifp) checkCancel();
+#endif
+    rp = ljpeg_row (stream, state, jrow, jh);
+    for (jcol=0; jcol < jwide; jcol++) {
+      adobe_copy_pixel (trow+row, tcol+col, &rp);
+      if (++col >= tile_width || col >= raw_width)
+	row += 1 + (col = 0);
+    }
+  }
+}
+
+#if defined(LIBRAW_LIBRARY_BUILD) && !defined(LIBRAW_NOTHREADS)
+struct lossless_dng_tile_t
+{
+  INT64 offset;
+  size_t start, size, index;
+  unsigned trow, tcol;
+};
+
+static bool lossless_dng_tile_by_offset (const lossless_dng_tile_t &a, const lossless_dng_tile_t &b)
+{
+  return a.offset < b.offset;
+}
+
+static bool lossless_dng_tile_by_index (const lossless_dng_tile_t &a, const lossless_dng_tile_t &b)
+{
+  return a.index < b.index;
+}
+
+struct lossless_dng_thread_data_t
+{
+  lossless_dng_tile_t *tiles;
+  int ntiles;
+  uchar *buffer;
+  int *error;
+};
+
+/*
+   Each worker decodes every topIncr-th tile from its in-memory copy with
+   its own bit buffer and Huffman tables.  Tiles cover disjoint parts of
+   raw_image, so no further locking is needed.
+ */
+void CLASS lossless_dng_thread_func (DCRAWThreadData *td)
+{
+  LibRaw& libRaw = (*td->libRawPtr);
+  lossless_dng_thread_data_t *dd = (lossless_dng_thread_data_t *) td->data;
+  LibRaw_TLS *state = NULL;
+  struct jhead jh;
+  int i;
+
+  try {
+    state = new LibRaw_TLS;
+    state->init();
+    for (i=td->topStart; i < dd->ntiles; i += td->topIncr) {
+      lossless_dng_tile_t *t = dd->tiles + i;
+      LibRaw_buffer_datastream stream (dd->buffer + t->start, t->size);
+      if (!libRaw.ljpeg_start (&stream, &jh, 0)) continue;
+      try {
+	libRaw.lossless_dng_decode_tile (&stream, state, &jh, t->trow, t->tcol);
+      } catch (...) {
+	libRaw.ljpeg_end (&jh);
+	throw ;
+      }
+      libRaw.ljpeg_end (&jh);
+    }
+  } catch (LibRaw_exceptions e) {
+    dd->error[td->topStart] = e;
+  } catch (...) {
+    dd->error[td->topStart] = LIBRAW_EXCEPTION_ALLOC;
+  }
+  delete state;
+}
+
+/*
+   Threaded counterpart of the tiled branch of lossless_dng_load_raw().
+   The tile offsets and each tile's byte range are read up front on the
+   calling thread; the entropy-coded data is then decoded in parallel.
+   Returns 0 without decoding anything when the tiles are not all lossless
+   Huffman (0xc3), leaving the stream where it was.
+ */
+int CLASS lossless_dng_load_tiles()
+{
+  std::vector<lossless_dng_tile_t> tiles;
+  std::vector<int> error;
+  INT64 save, fsize, maxbytes, end;
+  size_t total, i, j, ntiles;
+  unsigned trow, tcol;
+  uchar *buffer;
+  struct jhead jh;
+  int nthreads = _nthreads, n;
+
+  if (!tile_width || !tile_length) return 0;
+  save = ftell(ifp);
+  fsize = ifp->size();
+  for (trow=tcol=0; trow < raw_height; ) {
+    lossless_dng_tile_t t;
+    t.offset = get4();
+    t.index = tiles.size();
+    t.trow = trow;
+    t.tcol = tcol;
+    tiles.push_back (t);
+    if ((tcol += tile_width) >= raw_width)
+      trow += tile_length + (tcol = 0);
+  }
+  ntiles = tiles.size();
+  std::sort (tiles.begin(), tiles.end(), lossless_dng_tile_by_offset);
+
+  /* A tile ends where the next one starts, but never runs past the
+     largest encoding of tile_width x tile_length samples. */
+  maxbytes = (INT64) tile_width * tile_length * MAX (tiff_samples, 1) * 4 + 0x10000;
+  for (total=i=0; i < ntiles; i++) {
+    end = fsize;
+    for (j=i+1; j < ntiles; j++)
+      if (tiles[j].offset > tiles[i].offset) {
+	end = tiles[j].offset;
+	break;
+      }
+    if (end > tiles[i].offset + maxbytes) end = tiles[i].offset + maxbytes;
+    tiles[i].start = total;
+    tiles[i].size = tiles[i].offset < end ? end - tiles[i].offset : 0;
+    total += tiles[i].size;
+  }
+  buffer = (uchar *) malloc (total + 1);
+  merror (buffer, "lossless_dng_load_raw()");
+  try {
+    for (i=0; i < ntiles; i++) {
+      checkCancel();
+      if (!tiles[i].size) continue;
+      fseek (ifp, tiles[i].offset, SEEK_SET);
+      n = fread (buffer + tiles[i].start, 1, tiles[i].size, ifp);
+      tiles[i].size = MAX (n, 0);
+    }
+    std::sort (tiles.begin(), tiles.end(), lossless_dng_tile_by_index);
+    /* derror() reports EOF from the shared stream, so move it off the end */
+    fseek (ifp, save + 4 * (INT64) tiles.size(), SEEK_SET);
+
+    /* The serial decoder stops at the first tile without a valid
+       header, and only knows how to share out lossless Huffman tiles. */
+    for (i=0; i < ntiles; i++) {
+      LibRaw_buffer_datastream stream (buffer + tiles[i].start, tiles[i].size);
+      if (!ljpeg_start (&stream, &jh, 1)) break;
+      if (jh.algo != 0xc3) {
+	free (buffer);
+	fseek (ifp, save, SEEK_SET);
+	return 0;
+      }
+    }
+    ntiles = i;
+
+    if (nthreads > (int) ntiles) nthreads = ntiles;
+    if (nthreads < 1) nthreads = 1;
+    std::vector<boost::thread *> workerThread(nthreads);
+    std::vector<DCRAWThreadData> td(nthreads);
+    lossless_dng_thread_data_t dd;
+
+    error.assign (nthreads, LIBRAW_EXCEPTION_NONE);
+    dd.tiles = ntiles ? &tiles[0] : NULL;
+    dd.ntiles = ntiles;
+    dd.buffer = buffer;
+    dd.error = &error[0];
+    zero_after_ff = 1;
+    for (n=0; n < nthreads; n++) {
+      td[n].topStart = n;
+      td[n].topIncr = nthreads;
+      td[n].libRawPtr = this;
+      td[n].data = &dd;
+      workerThread[n] = new boost::thread(lossless_dng_thread_func, &td[n]);
+    }
+    for (n=0; n < nthreads; n++) {
+      workerThread[n]->join();
+      delete workerThread[n];
+    }
+    for (n=0; n < nthreads; n++)
+      if (error[n] != LIBRAW_EXCEPTION_NONE)
+	throw (LibRaw_exceptions) error[n];
+  } catch (...) {
+    free (buffer);
+    throw ;
+  }
+  free (buffer);
+  return 1;
+}
+#endif
+
 void CLASS lossless_dng_load_raw()
 {
-  unsigned save, trow=0, tcol=0, jwide, jrow, jcol, row, col, i, j;
+  unsigned save, trow=0, tcol=0, jrow, jcol, row, col, i, j;
   struct jhead jh;
   ushort *rp;
 
+#if defined(LIBRAW_LIBRARY_BUILD) && !defined(LIBRAW_NOTHREADS)
+  if (_nthreads > 1 && tile_length < INT_MAX && lossless_dng_load_tiles())
+    return;
+#endif
   while (trow < raw_height) {
 #ifdef LIBRAW_LIBRARY_BUILD
     checkCancel();
@@ -1077,9 +1307,6 @@ void CLASS lossless_dng_load_raw()
     if (tile_length < INT_MAX)
       fseek (ifp, get4(), SEEK_SET);
     if (!ljpeg_start (&jh, 0)) break;
-    jwide = jh.wide;
-    if (filters) jwide *= jh.clrs;
-    jwide /= MIN (is_raw, tiff_samples);
 #ifdef LIBRAW_LIBRARY_BUILD
     try {
 #endif
@@ -1103,17 +1330,7 @@ void CLASS lossless_dng_load_raw()
 	}
 	break;
       case 0xc3:
-	for (row=col=jrow=0; jrow < jh.high; jrow++) {
-#ifdef LIBRAW_LIBRARY_BUILD
-	  checkCancel();
-#endif
-	  rp = ljpeg_row (jrow, &jh);
-	  for (jcol=0; jcol < jwide; jcol++) {
-	    adobe_copy_pixel (trow+row, tcol+col, &rp);
-	    if (++col >= tile_width || col >= raw_width)
-	      row += 1 + (col = 0);
-	  }
-	}
+	lossless_dng_decode_tile (ifp, tls, &jh, trow, tcol);
       }
 #ifdef LIBRAW_LIBRARY_BUILD
     } catch (...) {
@@ -1128,11 +1345,135 @@ void CLASS lossless_dng_load_raw()
   }
 }
 
+#if defined(LIBRAW_LIBRARY_BUILD) && !defined(LIBRAW_NOTHREADS)
+/*
+   Decodes rows first, first+step, ... of a packed DNG whose rows have
+   already been read into buffer, rowbytes apart.
+ */
+void CLASS packed_dng_decode_rows (uchar *buffer, size_t rowbytes, int first, int step)
+{
+  LibRaw_buffer_datastream stream (buffer, rowbytes * raw_height);
+  LibRaw_TLS *state = NULL;
+  ushort *pixel, *rp;
+  int row, col;
+
+  pixel = (ushort *) calloc (raw_width, tiff_samples*sizeof *pixel);
+  merror (pixel, "packed_dng_load_raw()");
+  try {
+    state = new LibRaw_TLS;
+    state->init();
+    for (row=first; row < raw_height; row += step) {
+      if (tiff_bps == 16) {
+	memcpy (pixel, buffer + row*rowbytes, raw_width * tiff_samples * 2);
+	if ((order == 0x4949) == (ntohs(0x1234) == 0x1234))
+	  swab ((char*)pixel, (char*)pixel, raw_width * tiff_samples * 2);
+      } else {
+	stream.seek ((INT64) row*rowbytes, SEEK_SET);
+	getbithuff (&stream, state, -1, 0);
+	for (col=0; col < raw_width * tiff_samples; col++)
+	  pixel[col] = getbithuff (&stream, state, tiff_bps, 0);
+      }
+      for (rp=pixel, col=0; col < raw_width; col++)
+	adobe_copy_pixel (row, col, &rp);
+    }
+  } catch (...) {
+    free (pixel);
+    delete state;
+    throw ;
+  }
+  free (pixel);
+  delete state;
+}
+
+struct packed_dng_thread_data_t
+{
+  uchar *buffer;
+  size_t rowbytes;
+  int *error;
+};
+
+void CLASS packed_dng_thread_func (DCRAWThreadData *td)
+{
+  packed_dng_thread_data_t *dd = (packed_dng_thread_data_t *) td->data;
+
+  try {
+    td->libRawPtr->packed_dng_decode_rows (dd->buffer, dd->rowbytes, td->topStart, td->topIncr);
+  } catch (LibRaw_exceptions e) {
+    dd->error[td->topStart] = e;
+  } catch (...) {
+    dd->error[td->topStart] = LIBRAW_EXCEPTION_ALLOC;
+  }
+}
+
+/*
+   Without 0xff byte stuffing every packed row starts on a byte boundary,
+   so the whole strip can be read in one go and its rows unpacked in
+   parallel.  Returns 0 if the data is not there in full, leaving the
+   stream where it was.
+ */
+int CLASS packed_dng_load_rows()
+{
+  size_t rowbytes = ((size_t) raw_width * tiff_samples * tiff_bps + 7) >> 3;
+  size_t size = rowbytes * raw_height;
+  INT64 save = ftell(ifp);
+  int nthreads = _nthreads, n;
+  std::vector<int> error;
+  uchar *buffer;
+
+  if (!size || save + (INT64) size > ifp->size()) return 0;
+  buffer = (uchar *) malloc (size);
+  merror (buffer, "packed_dng_load_raw()");
+  try {
+    if (fread (buffer, 1, size, ifp) < (int) size) {
+      free (buffer);
+      fseek (ifp, save, SEEK_SET);
+      return 0;
+    }
+    checkCancel();
+
+    if (nthreads > (int) raw_height) nthreads = raw_height;
+    std::vector<boost::thread *> workerThread(nthreads);
+    std::vector<DCRAWThreadData> td(nthreads);
+    packed_dng_thread_data_t dd;
+
+    error.assign (nthreads, LIBRAW_EXCEPTION_NONE);
+    dd.buffer = buffer;
+    dd.rowbytes = rowbytes;
+    dd.error = &error[0];
+    for (n=0; n < nthreads; n++) {
+      td[n].topStart = n;
+      td[n].topIncr = nthreads;
+      td[n].libRawPtr = this;
+      td[n].data = &dd;
+      workerThread[n] = new boost::thread(packed_dng_thread_func, &td[n]);
+    }
+    for (n=0; n < nthreads; n++) {
+      workerThread[n]->join();
+      delete workerThread[n];
+    }
+    for (n=0; n < nthreads; n++)
+      if (error[n] != LIBRAW_EXCEPTION_NONE)
+	throw (LibRaw_exceptions) error[n];
+  } catch (...) {
+    free (buffer);
+    throw ;
+  }
+  free (buffer);
+  return 1;
+}
+#endif
+
 void CLASS packed_dng_load_raw()
 {
   ushort *pixel, *rp;
   int row, col;
 
+#if defined(LIBRAW_LIBRARY_BUILD) && !defined(LIBRAW_NOTHREADS)
+  if (_nthreads > 1 && raw_height > 1 && tiff_bps <= 16 &&
+      (tiff_bps == 16 || !zero_after_ff) && packed_dng_load_rows())
+    return;
+#endif
+
   pixel = (ushort *) calloc (raw_width, tiff_samples*sizeof *pixel);
   merror (pixel, "packed_dng_load_raw()");
 #ifdef LIBRAW_LIBRARY_BUILD
@@ -4418,6 +4759,14 @@ skip_block: ;
   }
   size = iheight*iwidth;
 #ifdef LIBRAW_LIBRARY_BUILD
+  if (libraw_internal_data.output_data.linear_output == 1) {
+    /* only subtract black: copy_float_image() applies the multipliers
+       without clipping */
+    FORC4 {
+      libraw_internal_data.output_data.linear_mul[c] = scale_mul[c];
+      scale_mul[c] = 1;
+    }
+  }
   scale_colors_loop(scale_mul);
 #else
   for (i=0; i < size*4; i++) {
@@ -4537,25 +4886,40 @@ void CLASS border_interpolate (int border)
     }
 }
 
+struct lin_interpolate_data_t
+{
+  int (*code)[16][32];
+  int size;
+};
+
+/*
+   A row only writes the missing colors of its own pixels and only reads
+   the colors its neighbours already have, so the rows are independent.
+ */
 void CLASS lin_interpolate_loop(int code[16][16][32],int size)
 {
-  int row;
-  for (row=1; row < height-1; row++)
-    {
-      int col,*ip;
-      ushort *pix;
-      for (col=1; col < width-1; col++) {
-        int i;
-        int sum[4];
-        pix = image[row*width+col];
-        ip = code[row % size][col % size];
-        memset (sum, 0, sizeof sum);
-        for (i=*ip++; i--; ip+=3)
-          sum[ip[2]] += pix[ip[0]] << ip[1];
-        for (i=colors; --i; ip+=2)
-          pix[ip[0]] = sum[ip[0]] * ip[1] >> 8;
-      }
-    }
+  lin_interpolate_data_t ld;
+  ld.code = code;
+  ld.size = size;
+  demosaic_lines(*this, &LibRaw::lin_interpolate_row, &ld, 1, height-1, 1, _workers);
+}
+
+void CLASS lin_interpolate_row(int row, void *arg)
+{
+  lin_interpolate_data_t *ld = (lin_interpolate_data_t *) arg;
+  int col,*ip;
+  ushort *pix;
+  for (col=1; col < width-1; col++) {
+    int i;
+    int sum[4];
+    pix = image[row*width+col];
+    ip = ld->code[row % ld->size][col % ld->size];
+    memset (sum, 0, sizeof sum);
+    for (i=*ip++; i--; ip+=3)
+      sum[ip[2]] += pix[ip[0]] << ip[1];
+    for (i=colors; --i; ip+=2)
+      pix[ip[0]] = sum[ip[0]] * ip[1] >> 8;
+  }
 }
 
 void CLASS lin_interpolate()
@@ -4604,6 +4968,23 @@ void CLASS lin_interpolate()
 #endif
 }
 
+#ifdef LIBRAW_LIBRARY_BUILD
+struct vng_band_t
+{
+  int top, bottom, row, nedge, edge[4];
+  ushort (*brow[5])[4], (*ebuf)[4];
+};
+
+struct vng_thread_data_t
+{
+  LibRaw *libRawPtr;
+  int *code[16][16];
+  int prow, pcol;
+  int pass;
+  vng_band_t *bands;
+};
+#endif
+
 /*
    This algorithm is officially called:
 
@@ -4640,10 +5021,10 @@ void CLASS vng_interpolate()
     +1,-1,+1,+1,0,static_cast<signed char>(0x88), +1,+0,+1,+2,0,0x08, +1,+0,+2,-1,0,0x40,
     +1,+0,+2,+1,0,0x10
   }, chood[] = { -1,-1, -1,0, -1,+1, 0,+1, +1,+1, +1,0, +1,-1, 0,-1 };
-  ushort (*brow[5])[4], *pix;
-  int prow=8, pcol=2, *ip, *code[16][16], gval[8], gmin, gmax, sum[4];
+  ushort (*brow[5])[4];
+  int prow=8, pcol=2, *ip, *code[16][16];
   int row, col, x, y, x1, x2, y1, y2, t, weight, grads, color, diag;
-  int g, diff, thold, num, c;
+  int g;
 
   lin_interpolate();
 #ifdef DCRAW_VERBOSE
@@ -4684,6 +5065,57 @@ void CLASS vng_interpolate()
 	  *ip++ = 0;
       }
     }
+#ifdef LIBRAW_LIBRARY_BUILD
+  if (_workers && height > 4)
+  {
+      int band, nbands = MIN(_workers->size(), MAX(1,(int)(height-4)/16));
+      int chunk, nchunks;
+      vng_thread_data_t vd;
+
+      band = (height-4 + nbands-1) / nbands;
+      nbands = (height-4 + band-1) / band;
+      nchunks = (MAX(band-4,0) + 255) / 256;
+      std::vector< vng_band_t > bands(nbands);
+      for (int i=0; i < nbands; ++i)
+      {
+          vng_band_t &b = bands[i];
+          b.top = 2 + band*i;
+          b.bottom = MIN(b.top + band, (int)height-2);
+          b.row = b.top + 2;
+          b.nedge = 0;
+          b.ebuf = (ushort (*)[4]) calloc (width*4, sizeof *b.ebuf);
+          merror (b.ebuf, "vng_interpolate()");
+          b.brow[4] = (ushort (*)[4]) calloc (width*3, sizeof **b.brow);
+          merror (b.brow[4], "vng_interpolate()");
+          for (row=0; row < 3; row++)
+            b.brow[row] = b.brow[4] + row*width;
+      }
+      vd.libRawPtr = this;
+      memcpy (vd.code, code, sizeof code);
+      vd.prow = prow;
+      vd.pcol = pcol;
+      vd.bands = &bands[0];
+
+      vd.pass = 0;
+      _workers->run(vng_interpolate_job, &vd, nbands);
+      vd.pass = 1;
+      for (chunk=0; chunk < nchunks; chunk++)
+      {
+          RUN_CALLBACK(LIBRAW_PROGRESS_INTERPOLATE,chunk+1,nchunks+1);
+          _workers->run(vng_interpolate_job, &vd, nbands);
+      }
+      vd.pass = 2;
+      _workers->run(vng_interpolate_job, &vd, nbands);
+
+      for (int i=0; i < nbands; ++i)
+      {
+          free (bands[i].brow[4]);
+          free (bands[i].ebuf);
+      }
+      free (code[0][0]);
+      return;
+  }
+#endif
   brow[4] = (ushort (*)[4]) calloc (width*3, sizeof **brow);
   merror (brow[4], "vng_interpolate()");
   for (row=0; row < 3; row++)
@@ -4692,49 +5124,7 @@ void CLASS vng_interpolate()
 #ifdef LIBRAW_LIBRARY_BUILD
       if(!((row-2)%256))RUN_CALLBACK(LIBRAW_PROGRESS_INTERPOLATE,(row-2)/256+1,((height-3)/256)+1);
 #endif
-    for (col=2; col < width-2; col++) {
-      pix = image[row*width+col];
-      ip = code[row % prow][col % pcol];
-      memset (gval, 0, sizeof gval);
-      while ((g = ip[0]) != INT_MAX) {		/* Calculate gradients */
-	diff = ABS(pix[g] - pix[ip[1]]) << ip[2];
-	gval[ip[3]] += diff;
-	ip += 5;
-	if ((g = ip[-1]) == -1) continue;
-	gval[g] += diff;
-	while ((g = *ip++) != -1)
-	  gval[g] += diff;
-      }
-      ip++;
-      gmin = gmax = gval[0];			/* Choose a threshold */
-      for (g=1; g < 8; g++) {
-	if (gmin > gval[g]) gmin = gval[g];
-	if (gmax < gval[g]) gmax = gval[g];
-      }
-      if (gmax == 0) {
-	memcpy (brow[2][col], pix, sizeof *image);
-	continue;
-      }
-      thold = gmin + (gmax >> 1);
-      memset (sum, 0, sizeof sum);
-      color = fcol(row,col);
-      for (num=g=0; g < 8; g++,ip+=2) {		/* Average the neighbors */
-	if (gval[g] <= thold) {
-	  FORCC
-	    if (c == color && ip[1])
-	      sum[c] += (pix[c] + pix[ip[1]]) >> 1;
-	    else
-	      sum[c] += pix[ip[0] + c];
-	  num++;
-	}
-      }
-      FORCC {					/* Save to buffer */
-	t = pix[color];
-	if (c != color)
-	  t += (sum[c] - sum[color]) / num;
-	brow[2][col][c] = CLIP(t);
-      }
-    }
+    vng_interpolate_row (code, prow, pcol, row, brow[2]);
     if (row > 3)				/* Write buffer to image */
       memcpy (image[(row-2)*width+2], brow[0]+2, (width-4)*sizeof *image);
     for (g=0; g < 4; g++)
@@ -4746,15 +5136,117 @@ void CLASS vng_interpolate()
   free (code[0][0]);
 }
 
+/*
+   Interpolates one row of VNG output into out[2..width-3], reading only
+   the unmodified rows row-2..row+2 of the image.
+ */
+void CLASS vng_interpolate_row (int *code[16][16], int prow, int pcol, int row, ushort (*out)[4])
+{
+  ushort *pix;
+  int *ip, gval[8], gmin, gmax, sum[4];
+  int col, t, color, g, diff, thold, num, c;
+
+  for (col=2; col < width-2; col++) {
+    pix = image[row*width+col];
+    ip = code[row % prow][col % pcol];
+    memset (gval, 0, sizeof gval);
+    while ((g = ip[0]) != INT_MAX) {		/* Calculate gradients */
+      diff = ABS(pix[g] - pix[ip[1]]) << ip[2];
+      gval[ip[3]] += diff;
+      ip += 5;
+      if ((g = ip[-1]) == -1) continue;
+      gval[g] += diff;
+      while ((g = *ip++) != -1)
+	gval[g] += diff;
+    }
+    ip++;
+    gmin = gmax = gval[0];			/* Choose a threshold */
+    for (g=1; g < 8; g++) {
+      if (gmin > gval[g]) gmin = gval[g];
+      if (gmax < gval[g]) gmax = gval[g];
+    }
+    if (gmax == 0) {
+      memcpy (out[col], pix, sizeof *image);
+      continue;
+    }
+    thold = gmin + (gmax >> 1);
+    memset (sum, 0, sizeof sum);
+    color = fcol(row,col);
+    for (num=g=0; g < 8; g++,ip+=2) {		/* Average the neighbors */
+      if (gval[g] <= thold) {
+	FORCC
+	  if (c == color && ip[1])
+	    sum[c] += (pix[c] + pix[ip[1]]) >> 1;
+	  else
+	    sum[c] += pix[ip[0] + c];
+	num++;
+      }
+    }
+    FORCC {					/* Save to buffer */
+      t = pix[color];
+      if (c != color)
+	t += (sum[c] - sum[color]) / num;
+      out[col][c] = CLIP(t);
+    }
+  }
+}
+
+#ifdef LIBRAW_LIBRARY_BUILD
+/*
+   Each band owns the rows [top,bottom).  The two rows at either end of a
+   band are also read by the neighbouring bands, so pass 0 interpolates
+   them before anything is written and pass 2 stores them last; pass 1
+   runs the next 256 rows of the interior with the same delayed
+   write-back as the serial loop, which keeps the output identical to it
+   and lets vng_interpolate() report progress between the chunks.
+ */
+void CLASS vng_interpolate_job (void *arg, int index, int count)
+{
+  vng_thread_data_t *vd = (vng_thread_data_t *) arg;
+  LibRaw& libRaw = *vd->libRawPtr;
+  libraw_data_t& imgdata = libRaw.imgdata;
+  vng_band_t *b = vd->bands + index;
+  int top = b->top, bottom = b->bottom;
+  int row, g, stop;
+
+  if (vd->pass == 0) {
+    for (row=top; row < bottom; row++)
+      if (row < top+2 || row >= bottom-2) {
+        libRaw.vng_interpolate_row (vd->code, vd->prow, vd->pcol, row, b->ebuf + b->nedge*width);
+        b->edge[b->nedge++] = row;
+      }
+    return;
+  }
+
+  if (vd->pass == 1) {
+    stop = MIN(b->row + 256, bottom-2);
+    for (row=b->row; row < stop; row++) {
+      libRaw.vng_interpolate_row (vd->code, vd->prow, vd->pcol, row, b->brow[2]);
+      if (row > top+3)
+        memcpy (image[(row-2)*width+2], b->brow[0]+2, (width-4)*sizeof *image);
+      for (g=0; g < 4; g++)
+        b->brow[(g-1) & 3] = b->brow[g];
+    }
+    if (stop > b->row)
+      b->row = stop;
+    return;
+  }
+
+  row = b->row;
+  if (row > top+3)
+    memcpy (image[(row-2)*width+2], b->brow[0]+2, (width-4)*sizeof *image);
+  if (row > top+2)
+    memcpy (image[(row-1)*width+2], b->brow[1]+2, (width-4)*sizeof *image);
+  for (g=0; g < b->nedge; g++)
+    memcpy (image[b->edge[g]*width+2], b->ebuf + g*width+2, (width-4)*sizeof *image);
+}
+#endif
+
 /*
    Patterned Pixel Grouping Interpolation by Alain Desbiolles
 */
 void CLASS ppg_interpolate()
 {
-  int dir[5] = { 1, width, -1, -width, 1 };
-  int row, col, diff[2], guess[2], c, d, i;
-  ushort (*pix)[4];
-
   border_interpolate(3);
 #ifdef DCRAW_VERBOSE
   if (verbose) fprintf (stderr,_("PPG interpolation...\n"));
@@ -4763,61 +5255,81 @@ void CLASS ppg_interpolate()
 /*  Fill in the green layer with gradients and pattern recognition: */
 #ifdef LIBRAW_LIBRARY_BUILD
   RUN_CALLBACK(LIBRAW_PROGRESS_INTERPOLATE,0,3);
-#ifdef LIBRAW_USE_OPENMP
-#pragma omp parallel for default(shared) private(guess, diff, row, col, d, c, i, pix) schedule(static)
-#endif
 #endif
-  for (row=3; row < height-3; row++)
-    for (col=3+(FC(row,3) & 1), c=FC(row,col); col < width-3; col+=2) {
-      pix = image + row*width+col;
-      for (i=0; (d=dir[i]) > 0; i++) {
-	guess[i] = (pix[-d][1] + pix[0][c] + pix[d][1]) * 2
-		      - pix[-2*d][c] - pix[2*d][c];
-	diff[i] = ( ABS(pix[-2*d][c] - pix[ 0][c]) +
-		    ABS(pix[ 2*d][c] - pix[ 0][c]) +
-		    ABS(pix[  -d][1] - pix[ d][1]) ) * 3 +
-		  ( ABS(pix[ 3*d][1] - pix[ d][1]) +
-		    ABS(pix[-3*d][1] - pix[-d][1]) ) * 2;
-      }
-      d = dir[i = diff[0] > diff[1]];
-      pix[0][1] = ULIM(guess[i] >> 2, pix[d][1], pix[-d][1]);
-    }
+  demosaic_lines(*this, &LibRaw::ppg_green_row, 3, height-3, 1, _workers);
 /*  Calculate red and blue for each green pixel:		*/
 #ifdef LIBRAW_LIBRARY_BUILD
   RUN_CALLBACK(LIBRAW_PROGRESS_INTERPOLATE,1,3);
-#ifdef LIBRAW_USE_OPENMP
-#pragma omp parallel for default(shared) private(guess, diff, row, col, d, c, i, pix) schedule(static)
 #endif
-#endif
-  for (row=1; row < height-1; row++)
-    for (col=1+(FC(row,2) & 1), c=FC(row,col+1); col < width-1; col+=2) {
-      pix = image + row*width+col;
-      for (i=0; (d=dir[i]) > 0; c=2-c, i++)
-	pix[0][c] = CLIP((pix[-d][c] + pix[d][c] + 2*pix[0][1]
-			- pix[-d][1] - pix[d][1]) >> 1);
-    }
+  demosaic_lines(*this, &LibRaw::ppg_rb_at_green_row, 1, height-1, 1, _workers);
 /*  Calculate blue for red pixels and vice versa:		*/
 #ifdef LIBRAW_LIBRARY_BUILD
   RUN_CALLBACK(LIBRAW_PROGRESS_INTERPOLATE,2,3);
-#ifdef LIBRAW_USE_OPENMP
-#pragma omp parallel for default(shared) private(guess, diff, row, col, d, c, i, pix) schedule(static)
-#endif
 #endif
-  for (row=1; row < height-1; row++)
-    for (col=1+(FC(row,1) & 1), c=2-FC(row,col); col < width-1; col+=2) {
-      pix = image + row*width+col;
-      for (i=0; (d=dir[i]+dir[i+1]) > 0; i++) {
-	diff[i] = ABS(pix[-d][c] - pix[d][c]) +
-		  ABS(pix[-d][1] - pix[0][1]) +
-		  ABS(pix[ d][1] - pix[0][1]);
-	guess[i] = pix[-d][c] + pix[d][c] + 2*pix[0][1]
-		 - pix[-d][1] - pix[d][1];
-      }
-      if (diff[0] != diff[1])
-	pix[0][c] = CLIP(guess[diff[0] > diff[1]] >> 1);
-      else
-	pix[0][c] = CLIP((guess[0]+guess[1]) >> 2);
+  demosaic_lines(*this, &LibRaw::ppg_rb_at_rb_row, 1, height-1, 1, _workers);
+}
+
+/*
+   Every PPG pass only reads values written by the previous one, so the
+   rows of a pass are independent and each pass is split between the
+   threads as a whole.
+ */
+void CLASS ppg_green_row(int row)
+{
+  int dir[5] = { 1, width, -1, -width, 1 };
+  int col, diff[2], guess[2], c, d, i;
+  ushort (*pix)[4];
+
+  for (col=3+(FC(row,3) & 1), c=FC(row,col); col < width-3; col+=2) {
+    pix = image + row*width+col;
+    for (i=0; (d=dir[i]) > 0; i++) {
+      guess[i] = (pix[-d][1] + pix[0][c] + pix[d][1]) * 2
+		    - pix[-2*d][c] - pix[2*d][c];
+      diff[i] = ( ABS(pix[-2*d][c] - pix[ 0][c]) +
+		  ABS(pix[ 2*d][c] - pix[ 0][c]) +
+		  ABS(pix[  -d][1] - pix[ d][1]) ) * 3 +
+		( ABS(pix[ 3*d][1] - pix[ d][1]) +
+		  ABS(pix[-3*d][1] - pix[-d][1]) ) * 2;
     }
+    d = dir[i = diff[0] > diff[1]];
+    pix[0][1] = ULIM(guess[i] >> 2, pix[d][1], pix[-d][1]);
+  }
+}
+
+void CLASS ppg_rb_at_green_row(int row)
+{
+  int dir[5] = { 1, width, -1, -width, 1 };
+  int col, c, d, i;
+  ushort (*pix)[4];
+
+  for (col=1+(FC(row,2) & 1), c=FC(row,col+1); col < width-1; col+=2) {
+    pix = image + row*width+col;
+    for (i=0; (d=dir[i]) > 0; c=2-c, i++)
+      pix[0][c] = CLIP((pix[-d][c] + pix[d][c] + 2*pix[0][1]
+		      - pix[-d][1] - pix[d][1]) >> 1);
+  }
+}
+
+void CLASS ppg_rb_at_rb_row(int row)
+{
+  int dir[5] = { 1, width, -1, -width, 1 };
+  int col, diff[2], guess[2], c, d, i;
+  ushort (*pix)[4];
+
+  for (col=1+(FC(row,1) & 1), c=2-FC(row,col); col < width-1; col+=2) {
+    pix = image + row*width+col;
+    for (i=0; (d=dir[i]+dir[i+1]) > 0; i++) {
+      diff[i] = ABS(pix[-d][c] - pix[d][c]) +
+		ABS(pix[-d][1] - pix[0][1]) +
+		ABS(pix[ d][1] - pix[0][1]);
+      guess[i] = pix[-d][c] + pix[d][c] + 2*pix[0][1]
+	       - pix[-d][1] - pix[d][1];
+    }
+    if (diff[0] != diff[1])
+      pix[0][c] = CLIP(guess[diff[0] > diff[1]] >> 1);
+    else
+      pix[0][c] = CLIP((guess[0]+guess[1]) >> 2);
+  }
 }
 
 void CLASS cielab (ushort rgb[3], short lab[3])
@@ -4866,23 +5378,31 @@ void CLASS cielab (ushort rgb[3], short lab[3])
 #define TS 512		/* Tile Size */
 #define fcol(row,col) xtrans[(row+6) % 6][(col+6) % 6]
 
+#ifdef LIBRAW_LIBRARY_BUILD
+struct xtrans_thread_data_t
+{
+  LibRaw *libRawPtr;
+  int passes, ntop, nleft, step;
+  short (*allhex)[3][2][8];
+  ushort sgrow, sgcol;
+  char **buffers;
+};
+#endif
+
 /*
    Frank Markesteijn's algorithm for Fuji X-Trans sensors
  */
 void CLASS xtrans_interpolate (int passes)
 {
-  int c, d, f, g, h, i, v, ng, row, col, top, left, mrow, mcol;
-  int val, ndir, pass, hm[8], avg[4], color[3][8];
+  int c, d, g, h, v, ng, row, col, top, left;
+  int val, ndir;
   static const short orth[12] = { 1,0,0,1,-1,0,0,-1,1,0,0,1 },
 	patt[2][16] = { { 0,1,0,-1,2,0,-1,0,1,1,1,-1,0,0,0,0 },
-			{ 0,1,0,-2,1,0,-2,0,1,1,-2,-2,1,-1,-1,1 } },
-	dir[4] = { 1,TS,TS+1,TS-1 };
+			{ 0,1,0,-2,1,0,-2,0,1,1,-2,-2,1,-1,-1,1 } };
   short allhex[3][3][2][8], *hex;
   ushort min, max, sgrow, sgcol;
-  ushort (*rgb)[TS][TS][3], (*rix)[3], (*pix)[4];
-   short (*lab)    [TS][3], (*lix)[3];
-   float (*drv)[TS][TS], diff[6], tr;
-   char (*homo)[TS][TS], *buffer;
+  ushort (*pix)[4];
+  char *buffer;
 
 #ifdef DCRAW_VERBOSE
   if (verbose)
@@ -4893,10 +5413,6 @@ void CLASS xtrans_interpolate (int passes)
   ndir = 4 << (passes > 1);
   buffer = (char *) malloc (TS*TS*(ndir*11+6));
   merror (buffer, "xtrans_interpolate()");
-  rgb  = (ushort(*)[TS][TS][3]) buffer;
-  lab  = (short (*)    [TS][3])(buffer + TS*TS*(ndir*6));
-  drv  = (float (*)[TS][TS])   (buffer + TS*TS*(ndir*6+6));
-  homo = (char  (*)[TS][TS])   (buffer + TS*TS*(ndir*10+6));
 
 /* Map a green hexagon around each non-green pixel and vice versa:	*/
   for (row=0; row < 3; row++)
@@ -4932,170 +5448,254 @@ void CLASS xtrans_interpolate (int passes)
       }
     }
 
+#ifdef LIBRAW_LIBRARY_BUILD
+  if (_workers)
+  {
+      xtrans_thread_data_t xd;
+      int nthreads = _workers->size(), nsteps;
+
+      xd.libRawPtr = this;
+      xd.passes = passes;
+      xd.allhex = allhex;
+      xd.sgrow = sgrow;
+      xd.sgcol = sgcol;
+      xd.ntop = xd.nleft = 0;
+      for (top=3; top < height-19; top += TS-16) xd.ntop++;
+      for (left=3; left < width-19; left += TS-16) xd.nleft++;
+      if (MIN(xd.ntop,(xd.nleft+1)/2) < nthreads)
+          nthreads = MAX(1,MIN(xd.ntop,(xd.nleft+1)/2));
+      nsteps = xd.ntop > 0 ? 2*(xd.ntop-1) + xd.nleft : 0;
+
+      std::vector< char * > buffers(nthreads);
+      buffers[0] = buffer;
+      for (int i=1; i < nthreads; ++i)
+      {
+          buffers[i] = (char *) malloc (TS*TS*(ndir*11+6));
+          merror (buffers[i], "xtrans_interpolate()");
+      }
+      xd.buffers = &buffers[0];
+
+      for (xd.step=0; xd.step < nsteps; xd.step++)
+          _workers->run(xtrans_interpolate_job, &xd, nthreads);
+
+      for (int i=0; i < nthreads; ++i)
+          free (buffers[i]);
+      border_interpolate(8);
+      return;
+  }
+#endif
   for (top=3; top < height-19; top += TS-16)
-    for (left=3; left < width-19; left += TS-16) {
-      mrow = MIN (top+TS, height-3);
-      mcol = MIN (left+TS, width-3);
-      for (row=top; row < mrow; row++)
-	for (col=left; col < mcol; col++)
-	  memcpy (rgb[0][row-top][col-left], image[row*width+col], 6);
-      FORC3 memcpy (rgb[c+1], rgb[0], sizeof *rgb);
+    for (left=3; left < width-19; left += TS-16)
+      xtrans_interpolate_tile (top, left, passes, allhex, sgrow, sgcol, buffer);
+  free(buffer);
+  border_interpolate(8);
+}
+
+/*
+   Interpolates the X-Trans tile at (top,left) using buffer, which must
+   hold TS*TS*(ndir*11+6) bytes.  Tiles overlap by 16 pixels and read
+   pixels the previous tiles have already written.
+ */
+void CLASS xtrans_interpolate_tile (int top, int left, int passes, short allhex[3][3][2][8],
+				    ushort sgrow, ushort sgcol, char *buffer)
+{
+  int c, d, f, g, h, i, v, row, col, mrow, mcol;
+  int val, ndir, pass, hm[8], avg[4], color[3][8];
+  static const short dir[4] = { 1,TS,TS+1,TS-1 };
+  short *hex;
+  ushort max;
+  ushort (*rgb)[TS][TS][3], (*rix)[3], (*pix)[4];
+   short (*lab)    [TS][3], (*lix)[3];
+   float (*drv)[TS][TS], diff[6], tr;
+   char (*homo)[TS][TS];
+
+  ndir = 4 << (passes > 1);
+  rgb  = (ushort(*)[TS][TS][3]) buffer;
+  lab  = (short (*)    [TS][3])(buffer + TS*TS*(ndir*6));
+  drv  = (float (*)[TS][TS])   (buffer + TS*TS*(ndir*6+6));
+  homo = (char  (*)[TS][TS])   (buffer + TS*TS*(ndir*10+6));
+
+  mrow = MIN (top+TS, height-3);
+  mcol = MIN (left+TS, width-3);
+  for (row=top; row < mrow; row++)
+    for (col=left; col < mcol; col++)
+      memcpy (rgb[0][row-top][col-left], image[row*width+col], 6);
+  FORC3 memcpy (rgb[c+1], rgb[0], sizeof *rgb);
 
 /* Interpolate green horizontally, vertically, and along both diagonals: */
-      for (row=top; row < mrow; row++)
-	for (col=left; col < mcol; col++) {
-	  if ((f = fcol(row,col)) == 1) continue;
-	  pix = image + row*width + col;
-	  hex = allhex[row % 3][col % 3][0];
-	  color[1][0] = 174 * (pix[  hex[1]][1] + pix[  hex[0]][1]) -
-			 46 * (pix[2*hex[1]][1] + pix[2*hex[0]][1]);
-	  color[1][1] = 223 *  pix[  hex[3]][1] + pix[  hex[2]][1] * 33 +
-			 92 * (pix[      0 ][f] - pix[ -hex[2]][f]);
-	  FORC(2) color[1][2+c] =
-		164 * pix[hex[4+c]][1] + 92 * pix[-2*hex[4+c]][1] + 33 *
-		(2*pix[0][f] - pix[3*hex[4+c]][f] - pix[-3*hex[4+c]][f]);
-	  FORC4 rgb[c^!((row-sgrow) % 3)][row-top][col-left][1] =
-		LIM(color[1][c] >> 8,pix[0][1],pix[0][3]);
-	}
+  for (row=top; row < mrow; row++)
+    for (col=left; col < mcol; col++) {
+      if ((f = fcol(row,col)) == 1) continue;
+      pix = image + row*width + col;
+      hex = allhex[row % 3][col % 3][0];
+      color[1][0] = 174 * (pix[  hex[1]][1] + pix[  hex[0]][1]) -
+		     46 * (pix[2*hex[1]][1] + pix[2*hex[0]][1]);
+      color[1][1] = 223 *  pix[  hex[3]][1] + pix[  hex[2]][1] * 33 +
+		     92 * (pix[      0 ][f] - pix[ -hex[2]][f]);
+      FORC(2) color[1][2+c] =
+	    164 * pix[hex[4+c]][1] + 92 * pix[-2*hex[4+c]][1] + 33 *
+	    (2*pix[0][f] - pix[3*hex[4+c]][f] - pix[-3*hex[4+c]][f]);
+      FORC4 rgb[c^!((row-sgrow) % 3)][row-top][col-left][1] =
+	    LIM(color[1][c] >> 8,pix[0][1],pix[0][3]);
+    }
 
-      for (pass=0; pass < passes; pass++) {
-	if (pass == 1)
-	  memcpy (rgb+=4, buffer, 4*sizeof *rgb);
+  for (pass=0; pass < passes; pass++) {
+    if (pass == 1)
+      memcpy (rgb+=4, buffer, 4*sizeof *rgb);
 
 /* Recalculate green from interpolated values of closer pixels:	*/
-	if (pass) {
-	  for (row=top+2; row < mrow-2; row++)
-	    for (col=left+2; col < mcol-2; col++) {
-	      if ((f = fcol(row,col)) == 1) continue;
-	      pix = image + row*width + col;
-	      hex = allhex[row % 3][col % 3][1];
-	      for (d=3; d < 6; d++) {
-		rix = &rgb[(d-2)^!((row-sgrow) % 3)][row-top][col-left];
-		val = rix[-2*hex[d]][1] + 2*rix[hex[d]][1]
-		    - rix[-2*hex[d]][f] - 2*rix[hex[d]][f] + 3*rix[0][f];
-		rix[0][1] = LIM(val/3,pix[0][1],pix[0][3]);
-	      }
-	    }
+    if (pass) {
+      for (row=top+2; row < mrow-2; row++)
+	for (col=left+2; col < mcol-2; col++) {
+	  if ((f = fcol(row,col)) == 1) continue;
+	  pix = image + row*width + col;
+	  hex = allhex[row % 3][col % 3][1];
+	  for (d=3; d < 6; d++) {
+	    rix = &rgb[(d-2)^!((row-sgrow) % 3)][row-top][col-left];
+	    val = rix[-2*hex[d]][1] + 2*rix[hex[d]][1]
+		- rix[-2*hex[d]][f] - 2*rix[hex[d]][f] + 3*rix[0][f];
+	    rix[0][1] = LIM(val/3,pix[0][1],pix[0][3]);
+	  }
 	}
+    }
 
 /* Interpolate red and blue values for solitary green pixels:	*/
-	for (row=(top-sgrow+4)/3*3+sgrow; row < mrow-2; row+=3)
-	  for (col=(left-sgcol+4)/3*3+sgcol; col < mcol-2; col+=3) {
-	    rix = &rgb[0][row-top][col-left];
-	    h = fcol(row,col+1);
-	    memset (diff, 0, sizeof diff);
-	    for (i=1, d=0; d < 6; d++, i^=TS^1, h^=2) {
-	      for (c=0; c < 2; c++, h^=2) {
-		g = 2*rix[0][1] - rix[i<<c][1] - rix[-i<<c][1];
-		color[h][d] = g + rix[i<<c][h] + rix[-i<<c][h];
-		if (d > 1)
-		  diff[d] += SQR (rix[i<<c][1] - rix[-i<<c][1]
-				- rix[i<<c][h] + rix[-i<<c][h]) + SQR(g);
-	      }
-	      if (d > 1 && (d & 1))
-		if (diff[d-1] < diff[d])
-		  FORC(2) color[c*2][d] = color[c*2][d-1];
-	      if (d < 2 || (d & 1)) {
-		FORC(2) rix[0][c*2] = CLIP(color[c*2][d]/2);
-		rix += TS*TS;
-	      }
-	    }
+    for (row=(top-sgrow+4)/3*3+sgrow; row < mrow-2; row+=3)
+      for (col=(left-sgcol+4)/3*3+sgcol; col < mcol-2; col+=3) {
+	rix = &rgb[0][row-top][col-left];
+	h = fcol(row,col+1);
+	memset (diff, 0, sizeof diff);
+	for (i=1, d=0; d < 6; d++, i^=TS^1, h^=2) {
+	  for (c=0; c < 2; c++, h^=2) {
+	    g = 2*rix[0][1] - rix[i<<c][1] - rix[-i<<c][1];
+	    color[h][d] = g + rix[i<<c][h] + rix[-i<<c][h];
+	    if (d > 1)
+	      diff[d] += SQR (rix[i<<c][1] - rix[-i<<c][1]
+			    - rix[i<<c][h] + rix[-i<<c][h]) + SQR(g);
 	  }
+	  if (d > 1 && (d & 1))
+	    if (diff[d-1] < diff[d])
+	      FORC(2) color[c*2][d] = color[c*2][d-1];
+	  if (d < 2 || (d & 1)) {
+	    FORC(2) rix[0][c*2] = CLIP(color[c*2][d]/2);
+	    rix += TS*TS;
+	  }
+	}
+      }
 
 /* Interpolate red for blue pixels and vice versa:		*/
-	for (row=top+3; row < mrow-3; row++)
-	  for (col=left+3; col < mcol-3; col++) {
-	    if ((f = 2-fcol(row,col)) == 1) continue;
-	    rix = &rgb[0][row-top][col-left];
-	    c = (row-sgrow) % 3 ? TS:1;
-	    h = 3 * (c ^ TS ^ 1);
-	    for (d=0; d < 4; d++, rix += TS*TS) {
-	      i = d > 1 || ((d ^ c) & 1) ||
-		 ((ABS(rix[0][1]-rix[c][1])+ABS(rix[0][1]-rix[-c][1])) <
-		2*(ABS(rix[0][1]-rix[h][1])+ABS(rix[0][1]-rix[-h][1]))) ? c:h;
-	      rix[0][f] = CLIP((rix[i][f] + rix[-i][f] +
-		  2*rix[0][1] - rix[i][1] - rix[-i][1])/2);
-	    }
-	  }
+    for (row=top+3; row < mrow-3; row++)
+      for (col=left+3; col < mcol-3; col++) {
+	if ((f = 2-fcol(row,col)) == 1) continue;
+	rix = &rgb[0][row-top][col-left];
+	c = (row-sgrow) % 3 ? TS:1;
+	h = 3 * (c ^ TS ^ 1);
+	for (d=0; d < 4; d++, rix += TS*TS) {
+	  i = d > 1 || ((d ^ c) & 1) ||
+	     ((ABS(rix[0][1]-rix[c][1])+ABS(rix[0][1]-rix[-c][1])) <
+	    2*(ABS(rix[0][1]-rix[h][1])+ABS(rix[0][1]-rix[-h][1]))) ? c:h;
+	  rix[0][f] = CLIP((rix[i][f] + rix[-i][f] +
+	      2*rix[0][1] - rix[i][1] - rix[-i][1])/2);
+	}
+      }
 
 /* Fill in red and blue for 2x2 blocks of green:		*/
-	for (row=top+2; row < mrow-2; row++) if ((row-sgrow) % 3)
-	  for (col=left+2; col < mcol-2; col++) if ((col-sgcol) % 3) {
-	    rix = &rgb[0][row-top][col-left];
-	    hex = allhex[row % 3][col % 3][1];
-	    for (d=0; d < ndir; d+=2, rix += TS*TS)
-	      if (hex[d] + hex[d+1]) {
-		g = 3*rix[0][1] - 2*rix[hex[d]][1] - rix[hex[d+1]][1];
-		for (c=0; c < 4; c+=2) rix[0][c] =
-			CLIP((g + 2*rix[hex[d]][c] + rix[hex[d+1]][c])/3);
-	      } else {
-		g = 2*rix[0][1] - rix[hex[d]][1] - rix[hex[d+1]][1];
-		for (c=0; c < 4; c+=2) rix[0][c] =
-			CLIP((g + rix[hex[d]][c] + rix[hex[d+1]][c])/2);
-	      }
+    for (row=top+2; row < mrow-2; row++) if ((row-sgrow) % 3)
+      for (col=left+2; col < mcol-2; col++) if ((col-sgcol) % 3) {
+	rix = &rgb[0][row-top][col-left];
+	hex = allhex[row % 3][col % 3][1];
+	for (d=0; d < ndir; d+=2, rix += TS*TS)
+	  if (hex[d] + hex[d+1]) {
+	    g = 3*rix[0][1] - 2*rix[hex[d]][1] - rix[hex[d+1]][1];
+	    for (c=0; c < 4; c+=2) rix[0][c] =
+		    CLIP((g + 2*rix[hex[d]][c] + rix[hex[d+1]][c])/3);
+	  } else {
+	    g = 2*rix[0][1] - rix[hex[d]][1] - rix[hex[d+1]][1];
+	    for (c=0; c < 4; c+=2) rix[0][c] =
+		    CLIP((g + rix[hex[d]][c] + rix[hex[d+1]][c])/2);
 	  }
       }
-      rgb = (ushort(*)[TS][TS][3]) buffer;
-      mrow -= top;
-      mcol -= left;
+  }
+  rgb = (ushort(*)[TS][TS][3]) buffer;
+  mrow -= top;
+  mcol -= left;
 
 /* Convert to CIELab and differentiate in all directions:	*/
-      for (d=0; d < ndir; d++) {
-	for (row=2; row < mrow-2; row++)
-	  for (col=2; col < mcol-2; col++)
-	    cielab (rgb[d][row][col], lab[row][col]);
-	for (f=dir[d & 3],row=3; row < mrow-3; row++)
-	  for (col=3; col < mcol-3; col++) {
-	    lix = &lab[row][col];
-	    g = 2*lix[0][0] - lix[f][0] - lix[-f][0];
-	    drv[d][row][col] = SQR(g)
-	      + SQR((2*lix[0][1] - lix[f][1] - lix[-f][1] + g*500/232))
-	      + SQR((2*lix[0][2] - lix[f][2] - lix[-f][2] - g*500/580));
-	  }
+  for (d=0; d < ndir; d++) {
+    for (row=2; row < mrow-2; row++)
+      for (col=2; col < mcol-2; col++)
+	cielab (rgb[d][row][col], lab[row][col]);
+    for (f=dir[d & 3],row=3; row < mrow-3; row++)
+      for (col=3; col < mcol-3; col++) {
+	lix = &lab[row][col];
+	g = 2*lix[0][0] - lix[f][0] - lix[-f][0];
+	drv[d][row][col] = SQR(g)
+	  + SQR((2*lix[0][1] - lix[f][1] - lix[-f][1] + g*500/232))
+	  + SQR((2*lix[0][2] - lix[f][2] - lix[-f][2] - g*500/580));
       }
+  }
 
 /* Build homogeneity maps from the derivatives:			*/
-      memset(homo, 0, ndir*TS*TS);
-      for (row=4; row < mrow-4; row++)
-	for (col=4; col < mcol-4; col++) {
-	  for (tr=FLT_MAX, d=0; d < ndir; d++)
-	    if (tr > drv[d][row][col])
-		tr = drv[d][row][col];
-	  tr *= 8;
-	  for (d=0; d < ndir; d++)
-	    for (v=-1; v <= 1; v++)
-	      for (h=-1; h <= 1; h++)
-		if (drv[d][row+v][col+h] <= tr)
-		  homo[d][row][col]++;
-	}
+  memset(homo, 0, ndir*TS*TS);
+  for (row=4; row < mrow-4; row++)
+    for (col=4; col < mcol-4; col++) {
+      for (tr=FLT_MAX, d=0; d < ndir; d++)
+	if (tr > drv[d][row][col])
+	    tr = drv[d][row][col];
+      tr *= 8;
+      for (d=0; d < ndir; d++)
+	for (v=-1; v <= 1; v++)
+	  for (h=-1; h <= 1; h++)
+	    if (drv[d][row+v][col+h] <= tr)
+	      homo[d][row][col]++;
+    }
 
 /* Average the most homogenous pixels for the final result:	*/
-      if (height-top < TS+4) mrow = height-top+2;
-      if (width-left < TS+4) mcol = width-left+2;
-      for (row = MIN(top,8); row < mrow-8; row++)
-	for (col = MIN(left,8); col < mcol-8; col++) {
-	  for (d=0; d < ndir; d++)
-	    for (hm[d]=0, v=-2; v <= 2; v++)
-	      for (h=-2; h <= 2; h++)
-		hm[d] += homo[d][row+v][col+h];
-	  for (d=0; d < ndir-4; d++)
-	    if (hm[d] < hm[d+4]) hm[d  ] = 0; else
-	    if (hm[d] > hm[d+4]) hm[d+4] = 0;
-	  for (max=hm[0],d=1; d < ndir; d++)
-	    if (max < hm[d]) max = hm[d];
-	  max -= max >> 3;
-	  memset (avg, 0, sizeof avg);
-	  for (d=0; d < ndir; d++)
-	    if (hm[d] >= max) {
-	      FORC3 avg[c] += rgb[d][row][col][c];
-	      avg[3]++;
-	    }
-	  FORC3 image[(row+top)*width+col+left][c] = avg[c]/avg[3];
+  if (height-top < TS+4) mrow = height-top+2;
+  if (width-left < TS+4) mcol = width-left+2;
+  for (row = MIN(top,8); row < mrow-8; row++)
+    for (col = MIN(left,8); col < mcol-8; col++) {
+      for (d=0; d < ndir; d++)
+	for (hm[d]=0, v=-2; v <= 2; v++)
+	  for (h=-2; h <= 2; h++)
+	    hm[d] += homo[d][row+v][col+h];
+      for (d=0; d < ndir-4; d++)
+	if (hm[d] < hm[d+4]) hm[d  ] = 0; else
+	if (hm[d] > hm[d+4]) hm[d+4] = 0;
+      for (max=hm[0],d=1; d < ndir; d++)
+	if (max < hm[d]) max = hm[d];
+      max -= max >> 3;
+      memset (avg, 0, sizeof avg);
+      for (d=0; d < ndir; d++)
+	if (hm[d] >= max) {
+	  FORC3 avg[c] += rgb[d][row][col][c];
+	  avg[3]++;
 	}
+      FORC3 image[(row+top)*width+col+left][c] = avg[c]/avg[3];
     }
-  free(buffer);
-  border_interpolate(8);
 }
+
+#ifdef LIBRAW_LIBRARY_BUILD
+/*
+   A tile reads the pixels written by its left neighbour and by the three
+   tiles above it, so tile (i,j) is processed in step 2*i+j: every tile of
+   a step only depends on earlier steps, which reproduces the serial
+   output exactly.  Each call runs this thread's share of one step.
+ */
+void CLASS xtrans_interpolate_job (void *arg, int index, int count)
+{
+  xtrans_thread_data_t *xd = (xtrans_thread_data_t *) arg;
+  int n, i, j;
+
+  for (n=i=0; i < xd->ntop; i++) {
+    j = xd->step - 2*i;
+    if (j < 0 || j >= xd->nleft) continue;
+    if (n++ % count != index) continue;
+    xd->libRawPtr->xtrans_interpolate_tile (3 + i*(TS-16), 3 + j*(TS-16), xd->passes,
+					    xd->allhex, xd->sgrow, xd->sgcol, xd->buffers[index]);
+  }
+}
+#endif
 #undef fcol
 
 /*
@@ -14577,6 +15177,15 @@ void CLASS convert_to_rgb()
 	_("Converting to %s colorspace...\n"), name[output_color-1]);
 #endif
 #ifdef LIBRAW_LIBRARY_BUILD
+  if (libraw_internal_data.output_data.linear_output == 1) {
+    /* copy_float_image() applies the matrix later, without clipping */
+    for (i=0; i < 3; i++)
+      for (j=0; j < 4; j++)
+	libraw_internal_data.output_data.linear_cam[i][j] = raw_color ?
+	  (j == (colors == 1 ? 0 : i)) : (j < colors ? out_cam[i][j] : 0);
+    libraw_internal_data.output_data.linear_output = 2;
+    return;
+  }
   convert_to_rgb_loop(out_cam);
 #else
   memset (histogram, 0, sizeof histogram);
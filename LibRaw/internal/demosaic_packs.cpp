@@ -37,6 +37,7 @@ it under the terms of the one of three licenses as you choose:
 /* WF filtering is allowed to triple libraw license */
 #include "./wf_filtering.cpp"
 /* DHT and AAHD are LGPL licensed, so include them */
+#include "internal/demosaic_threads.h"
 #include "./dht_demosaic.cpp"
 #include "./aahd_demosaic.cpp"
 
@@ -0,0 +1,231 @@
+/* -*- C++ -*-
+ * File: demosaic_threads.h
+ *
+ * Worker threads and the line-parallel driver for the demosaic passes.
+ *
+ * This code is licensed under one of three licenses as you choose:
+ *
+ * 1. GNU LESSER GENERAL PUBLIC LICENSE version 2.1
+ *    (See file LICENSE.LGPL provided in LibRaw distribution archive for details).
+ *
+ * 2. COMMON DEVELOPMENT AND DISTRIBUTION LICENSE (CDDL) Version 1.0
+ *    (See file LICENSE.CDDL provided in LibRaw distribution archive for details).
+ *
+ * 3. LibRaw Software License 27032010
+ *    (See file LICENSE.LibRaw.pdf provided in LibRaw distribution archive for details).
+ *
+ */
+
+#ifndef LIBRAW_DEMOSAIC_THREADS_H
+#define LIBRAW_DEMOSAIC_THREADS_H
+
+#include <new>
+#include <vector>
+#include <boost/thread.hpp>
+
+/*
+ * A fixed set of worker threads that dcraw_process() keeps for the whole
+ * call, so that the many short passes of a demosaic do not each pay for
+ * creating and joining their own threads.
+ */
+class libraw_thread_pool
+{
+public:
+	typedef void (*job_func)(void *arg, int index, int count);
+
+	libraw_thread_pool(int nthreads)
+		: job(0), arg(0), njobs(0), generation(0), pending(0), quit(false),
+		  failed(false), error(LIBRAW_EXCEPTION_NONE)
+	{
+		for (int i = 1; i < nthreads; ++i)
+			workers.push_back(new boost::thread(worker_main, this, i));
+	}
+
+	~libraw_thread_pool()
+	{
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			quit = true;
+			++generation;
+		}
+		start.notify_all();
+		for (size_t i = 0; i < workers.size(); ++i) {
+			workers[i]->join();
+			delete workers[i];
+		}
+	}
+
+	int size() const { return (int) workers.size() + 1; }
+
+	/*
+	 * Calls f(a, i, count) for i = 0 .. count-1, index 0 on the calling
+	 * thread, and returns once all of them are done.  count is clipped to
+	 * size().  A LibRaw exception thrown by any of the calls is rethrown
+	 * here, after the others have finished.
+	 */
+	void run(job_func f, void *a, int count)
+	{
+		if (count > size())
+			count = size();
+		if (count <= 1) {
+			f(a, 0, 1);
+			return;
+		}
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			job = f;
+			arg = a;
+			njobs = count;
+			pending = count - 1;
+			failed = false;
+			++generation;
+		}
+		start.notify_all();
+
+		bool caller_failed = false;
+		LibRaw_exceptions caller_error = LIBRAW_EXCEPTION_NONE;
+		try {
+			f(a, 0, count);
+		}
+		catch (LibRaw_exceptions e) {
+			caller_failed = true;
+			caller_error = e;
+		}
+		catch (std::bad_alloc &) {
+			caller_failed = true;
+			caller_error = LIBRAW_EXCEPTION_ALLOC;
+		}
+
+		boost::mutex::scoped_lock lock(mutex);
+		while (pending)
+			done.wait(lock);
+		if (caller_failed)
+			throw caller_error;
+		if (failed)
+			throw error;
+	}
+
+private:
+	static void worker_main(libraw_thread_pool *pool, int index)
+	{
+		unsigned seen = 0;
+		boost::mutex::scoped_lock lock(pool->mutex);
+		for (;;) {
+			while (pool->generation == seen)
+				pool->start.wait(lock);
+			seen = pool->generation;
+			if (pool->quit)
+				return;
+			if (index >= pool->njobs)
+				continue;
+
+			job_func f = pool->job;
+			void *a = pool->arg;
+			int count = pool->njobs;
+			LibRaw_exceptions e = LIBRAW_EXCEPTION_NONE;
+			lock.unlock();
+			try {
+				f(a, index, count);
+			}
+			catch (LibRaw_exceptions err) {
+				e = err;
+			}
+			catch (std::bad_alloc &) {
+				e = LIBRAW_EXCEPTION_ALLOC;
+			}
+			lock.lock();
+			if (e != LIBRAW_EXCEPTION_NONE && !pool->failed) {
+				pool->failed = true;
+				pool->error = e;
+			}
+			if (--pool->pending == 0)
+				pool->done.notify_one();
+		}
+	}
+
+	std::vector<boost::thread *> workers;
+	boost::mutex mutex;
+	boost::condition_variable start, done;
+	job_func job;
+	void *arg;
+	int njobs;
+	unsigned generation;
+	int pending;
+	bool quit;
+	bool failed;
+	LibRaw_exceptions error;
+};
+
+template <class T, class L>
+struct DemosaicLineJob
+{
+	T *obj;
+	L line;
+	void *arg;
+	int first;
+	int end;
+	int step;
+};
+
+template <class T>
+inline void demosaic_call_line(T *obj, void (T::*line)(int), void *, int i)
+{
+	(obj->*line)(i);
+}
+
+template <class T>
+inline void demosaic_call_line(T *obj, void (T::*line)(int, void *), void *arg, int i)
+{
+	(obj->*line)(i, arg);
+}
+
+template <class T, class L>
+void demosaic_line_job(void *p, int index, int count)
+{
+	DemosaicLineJob<T, L> *job = (DemosaicLineJob<T, L> *) p;
+	for (int i = job->first + index * job->step; i < job->end; i += count * job->step)
+		demosaic_call_line(job->obj, job->line, job->arg, i);
+}
+
+template <class T, class L>
+void demosaic_lines_run(T &obj, L line, void *arg, int first, int end, int step,
+		libraw_thread_pool *pool)
+{
+	int nlines = end > first ? (end - first + step - 1) / step : 0;
+
+	if (pool && nlines > 1) {
+		DemosaicLineJob<T, L> job = { &obj, line, arg, first, end, step };
+		pool->run(demosaic_line_job<T, L>, &job, nlines);
+		return;
+	}
+#if defined(LIBRAW_USE_OPENMP)
+#pragma omp parallel for schedule(guided)
+#endif
+	for (int n = 0; n < nlines; ++n)
+		demosaic_call_line(&obj, line, arg, first + n * step);
+}
+
+/*
+ * Calls (obj.*line)(i) for i = first, first+step, ... below end, dealing
+ * the lines out to the workers of pool in turn, and returns once all of
+ * them are done.  Without a pool the lines run in an OpenMP loop when
+ * LibRaw is built with it, and serially otherwise.  Only passes whose
+ * lines do not touch each other's output may be run this way; everything
+ * else stays on the serial loop.
+ */
+template <class T>
+void demosaic_lines(T &obj, void (T::*line)(int), int first, int end, int step,
+		libraw_thread_pool *pool)
+{
+	demosaic_lines_run(obj, line, 0, first, end, step, pool);
+}
+
+/* The same, for lines that need the pass's buffers: calls (obj.*line)(i, arg). */
+template <class T>
+void demosaic_lines(T &obj, void (T::*line)(int, void *), void *arg, int first, int end,
+		int step, libraw_thread_pool *pool)
+{
+	demosaic_lines_run(obj, line, arg, first, end, step, pool);
+}
+
+#endif
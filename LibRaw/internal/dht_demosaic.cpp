@@ -162,6 +162,12 @@ struct DHT {
 	void make_diag_dirs();
 	void make_hv_dirs();
 	void refine_hv_dirs(int i, int js);
+	void refine_hv_dline(int i) {
+		refine_hv_dirs(i, i & 1);
+	}
+	void refine_hv_dline_alt(int i) {
+		refine_hv_dirs(i, (i & 1) ^ 1);
+	}
 	void refine_diag_dirs(int i, int js);
 	void refine_ihv_dirs(int i);
 	void refine_idiag_dirs(int i);
@@ -173,8 +179,10 @@ struct DHT {
 	void make_rbdiag(int i);
 	void make_rbhv(int i);
 	void make_rb();
+	void copy_line(int i);
 	void hide_hots();
 	void restore_hots();
+	libraw_thread_pool *workers;
 };
 
 typedef float float3[3];
@@ -227,6 +235,7 @@ DHT::DHT(LibRaw& _libraw) :
 	channel_minimum[0] += .5;
 	channel_minimum[1] += .5;
 	channel_minimum[2] += .5;
+	workers = libraw.get_thread_pool();
 }
 
 void DHT::hide_hots() {
@@ -366,13 +375,16 @@ void DHT::restore_hots() {
 	}
 }
 
+/*
+ * The line passes go through demosaic_lines(), which uses the worker
+ * threads of dcraw_process() and otherwise the same OpenMP loop these
+ * passes used to carry.  refine_idiag_dirs() and refine_ihv_dirs() lost
+ * their OpenMP pragmas on purpose: they read the directions they have
+ * just updated on the previous line, so running them in parallel raced
+ * and made the result depend on the number of threads.
+ */
 void DHT::make_diag_dirs() {
-#if defined(LIBRAW_USE_OPENMP)
-#pragma omp parallel for schedule(guided)
-#endif
-	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		make_diag_dline(i);
-	}
+	demosaic_lines(*this, &DHT::make_diag_dline, 0, libraw.imgdata.sizes.iheight, 1, workers);
 //#if defined(LIBRAW_USE_OPENMP)
 //#pragma omp parallel for schedule(guided)
 //#endif
@@ -385,36 +397,16 @@ void DHT::make_diag_dirs() {
 //	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
 //		refine_diag_dirs(i, (i & 1) ^ 1);
 //	}
-#if defined(LIBRAW_USE_OPENMP)
-#pragma omp parallel for schedule(guided)
-#endif
 	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
 		refine_idiag_dirs(i);
 	}
 }
 
 void DHT::make_hv_dirs() {
-#if defined(LIBRAW_USE_OPENMP)
-#pragma omp parallel for schedule(guided)
-#endif
-	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		make_hv_dline(i);
-	}
-#if defined(LIBRAW_USE_OPENMP)
-#pragma omp parallel for schedule(guided)
-#endif
-	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		refine_hv_dirs(i, i & 1);
-	}
-#if defined(LIBRAW_USE_OPENMP)
-#pragma omp parallel for schedule(guided)
-#endif
-	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		refine_hv_dirs(i, (i & 1) ^ 1);
-	}
-#if defined(LIBRAW_USE_OPENMP)
-#pragma omp parallel for schedule(guided)
-#endif
+	int iheight = libraw.imgdata.sizes.iheight;
+	demosaic_lines(*this, &DHT::make_hv_dline, 0, iheight, 1, workers);
+	demosaic_lines(*this, &DHT::refine_hv_dline, 0, iheight, 1, workers);
+	demosaic_lines(*this, &DHT::refine_hv_dline_alt, 0, iheight, 1, workers);
 	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
 		refine_ihv_dirs(i);
 	}
@@ -585,12 +577,7 @@ void DHT::refine_idiag_dirs(int i) {
  * вычисление недостающих зелёных точек.
  */
 void DHT::make_greens() {
-#if defined(LIBRAW_USE_OPENMP)
-#pragma omp parallel for schedule(guided)
-#endif
-	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		make_gline(i);
-	}
+	demosaic_lines(*this, &DHT::make_gline, 0, libraw.imgdata.sizes.iheight, 1, workers);
 }
 
 void DHT::make_gline(int i) {
@@ -811,44 +798,26 @@ void DHT::make_rbhv(int i) {
 }
 
 void DHT::make_rb() {
-#if defined(LIBRAW_USE_OPENMP)
-#pragma omp barrier
-#pragma omp parallel for schedule(guided)
-#endif
-	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		make_rbdiag(i);
-	}
-#if defined(LIBRAW_USE_OPENMP)
-#pragma omp barrier
-#pragma omp parallel for schedule(guided)
-#endif
-	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		make_rbhv(i);
-	}
-
+	demosaic_lines(*this, &DHT::make_rbdiag, 0, libraw.imgdata.sizes.iheight, 1, workers);
+	demosaic_lines(*this, &DHT::make_rbhv, 0, libraw.imgdata.sizes.iheight, 1, workers);
 }
 
 /*
  * перенос изображения в выходной массив
  */
 void DHT::copy_to_image() {
+	demosaic_lines(*this, &DHT::copy_line, 0, libraw.imgdata.sizes.iheight, 1, workers);
+}
+
+void DHT::copy_line(int i) {
 	int iwidth = libraw.imgdata.sizes.iwidth;
-#if defined(LIBRAW_USE_OPENMP)
-#ifdef WIN32
-#pragma omp parallel for
-#else
-#pragma omp parallel for schedule(guided) collapse(2)
-#endif
-#endif
-	for (int i = 0; i < libraw.imgdata.sizes.iheight; ++i) {
-		for (int j = 0; j < iwidth; ++j) {
-			libraw.imgdata.image[i * iwidth + j][0] = (unsigned short) (nraw[nr_offset(
-					i + nr_topmargin, j + nr_leftmargin)][0]);
-			libraw.imgdata.image[i * iwidth + j][2] = (unsigned short) (nraw[nr_offset(
-					i + nr_topmargin, j + nr_leftmargin)][2]);
-			libraw.imgdata.image[i * iwidth + j][1] = libraw.imgdata.image[i * iwidth + j][3] =
-					(unsigned short) (nraw[nr_offset(i + nr_topmargin, j + nr_leftmargin)][1]);
-		}
+	for (int j = 0; j < iwidth; ++j) {
+		libraw.imgdata.image[i * iwidth + j][0] = (unsigned short) (nraw[nr_offset(
+				i + nr_topmargin, j + nr_leftmargin)][0]);
+		libraw.imgdata.image[i * iwidth + j][2] = (unsigned short) (nraw[nr_offset(
+				i + nr_topmargin, j + nr_leftmargin)][2]);
+		libraw.imgdata.image[i * iwidth + j][1] = libraw.imgdata.image[i * iwidth + j][3] =
+				(unsigned short) (nraw[nr_offset(i + nr_topmargin, j + nr_leftmargin)][1]);
 	}
 }
 
@@ -69,12 +69,16 @@ void        parse_ciff (int offset, int length, int);
 
 // LJPEG decoder
     unsigned    getbithuff (int nbits, ushort *huff);
+    unsigned    getbithuff (LibRaw_abstract_datastream *stream, LibRaw_TLS *state, int nbits, ushort *huff);
     ushort*     make_decoder_ref (const uchar **source);
     ushort*     make_decoder (const uchar *source);
     int         ljpeg_start (struct jhead *jh, int info_only);
+    int         ljpeg_start (LibRaw_abstract_datastream *stream, struct jhead *jh, int info_only);
     void        ljpeg_end(struct jhead *jh);
     int         ljpeg_diff (ushort *huff);
+    int         ljpeg_diff (LibRaw_abstract_datastream *stream, LibRaw_TLS *state, ushort *huff);
     ushort *    ljpeg_row (int jrow, struct jhead *jh);
+    ushort *    ljpeg_row (LibRaw_abstract_datastream *stream, LibRaw_TLS *state, int jrow, struct jhead *jh);
     void	ljpeg_idct (struct jhead *jh);
     unsigned    ph1_bithuff (int nbits, ushort *huff);
 
@@ -87,8 +91,13 @@ void        crw_init_tables (unsigned table, ushort *huff[2]);
 // Adobe DNG
     void        adobe_copy_pixel (unsigned int row, unsigned int col, ushort **rp);
     void        lossless_dng_load_raw();
+    void        lossless_dng_decode_tile (LibRaw_abstract_datastream *stream, LibRaw_TLS *state,
+                                          struct jhead *jh, unsigned trow, unsigned tcol);
+    int         lossless_dng_load_tiles();
     void        deflate_dng_load_raw();
     void        packed_dng_load_raw();
+    void        packed_dng_decode_rows (uchar *buffer, size_t rowbytes, int first, int step);
+    int         packed_dng_load_rows();
     void        lossy_dng_load_raw();
 //void        adobe_dng_load_raw_nc();
 
@@ -283,6 +292,21 @@ void        crw_init_tables (unsigned table, ushort *huff[2]);
     void 	dcb_color3(float (*image3)[3]);
     void 	dcb_decide(float (*image2)[3], float (*image3)[3]);
     void 	dcb_nyquist();
+    void        dcb_ver_row(int row, void *buf);
+    void        dcb_hor_row(int row, void *buf);
+    void        dcb_color_rb_row(int row);
+    void        dcb_color_g_row(int row);
+    void        dcb_color2_rb_row(int row, void *buf);
+    void        dcb_color2_g_row(int row, void *buf);
+    void        dcb_color3_rb_row(int row, void *buf);
+    void        dcb_color3_g_row(int row, void *buf);
+    void        dcb_decide_row(int row, void *buf);
+    void        dcb_map_row(int row);
+    void        dcb_correction_row(int row);
+    void        dcb_correction2_row(int row);
+    void        dcb_chroma_row(int row, void *buf);
+    void        dcb_chroma_rb_row(int row, void *buf);
+    void        dcb_chroma_g_row(int row, void *buf);
 // VCD/modified dcraw
     void        refinement();
     void        ahd_partial_interpolate(int threshold_value);
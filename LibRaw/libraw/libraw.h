@@ -47,12 +47,14 @@ it under the terms of the one of three licenses as you choose:
 #include <boost/thread.hpp>
 
 class LibRaw;
+class libraw_thread_pool;
 
 struct DCRAWThreadData
 {
 	int topStart;
 	int topIncr;
     LibRaw *libRawPtr;
+    void *data;
 };
 
 struct LIBRAWThreadData
@@ -188,6 +190,8 @@ class DllDef LibRaw
     int                         dcraw_ppm_tiff_writer(const char *filename);
     int                         dcraw_thumb_writer(const char *fname);
     int                         dcraw_process(void);
+    /* thumbnail, then half size, then full size, each through cb; parses once */
+    int                         progressive_process(preview_callback cb, void *data);
     /* information calls */
     int is_fuji_rotated(){return libraw_internal_data.internal_output_params.fuji_width;}
     int is_sraw();
@@ -205,6 +209,14 @@ class DllDef LibRaw
     void get_mem_image_format(int* width, int* height, int* colors, int* bps) const;
     int  copy_mem_image(void* scan0, int stride, int bgr);
 
+    /* Scene-linear output: dcraw_process_linear() leaves the image black
+       subtracted in camera space, copy_float_image() then applies white
+       balance and the output matrix and writes width x height RGBA pixels
+       (see get_mem_image_format) with 1.0 at the white level. The 8/16-bit
+       writers return LIBRAW_OUT_OF_ORDER_CALL until dcraw_process() runs again */
+    int  dcraw_process_linear(void);
+    int  copy_float_image(void* scan0, int stride, int format);
+
     /* free all internal data structures */
     void         recycle(); 
     virtual ~LibRaw(void); 
@@ -234,6 +246,11 @@ class DllDef LibRaw
 
   int  get_no_of_threads() { return _nthreads; }
   void set_no_of_threads(int n) { _nthreads = n; }
+  /* worker threads of the running dcraw_process() call, NULL outside it
+     or when fewer than two threads are set */
+  libraw_thread_pool *get_thread_pool() { return _workers; }
+  /* keep up to bytes of large freed buffers for the next file (0: off) */
+  void set_arena_limit(size_t bytes) { memmgr.set_arena_limit(bytes); }
   void	set_dng_host(void *);
 
 protected:
@@ -251,6 +268,9 @@ protected:
     virtual void convert_to_rgb_loop(float out_cam[3][4]);
     virtual void lin_interpolate_loop(int code[16][16][32],int size);
     virtual void scale_colors_loop(float scale_mul[4]);
+    virtual void convert_to_float_loop(float mat[4][4], void *scan0, int stride, int format);
+    static int   progressive_progress(void *data, enum LibRaw_progress stage, int iteration, int expected);
+    int          progressive_stage(preview_callback cb, void *data, enum LibRaw_preview_stage stage, int *stop);
 
     int FCF(int row,int col) { 
         int rr,cc;
@@ -315,6 +335,17 @@ protected:
     void        aahd_interpolate();
 
     void static ahd_interpolate_thread_func (DCRAWThreadData *td);
+    void static vng_interpolate_job (void *arg, int index, int count);
+    void static xtrans_interpolate_job (void *arg, int index, int count);
+    void static lossless_dng_thread_func (DCRAWThreadData *td);
+    void static packed_dng_thread_func (DCRAWThreadData *td);
+    void        lin_interpolate_row(int row, void *arg);
+    void        vng_interpolate_row(int *code[16][16], int prow, int pcol, int row, ushort (*out)[4]);
+    void        ppg_green_row(int row);
+    void        ppg_rb_at_green_row(int row);
+    void        ppg_rb_at_rb_row(int row);
+    void        xtrans_interpolate_tile(int top, int left, int passes, short allhex[3][3][2][8],
+                                        ushort sgrow, ushort sgcol, char *buffer);
 
     /* from demosaic pack */
     void        ahd_interpolate_mod();
@@ -381,6 +412,8 @@ protected:
   void          *_x3f_data;
 
   int         _nthreads;
+  libraw_thread_pool *_workers;
+  boost::mutex derror_lock;	/* unpack workers may report data errors concurrently */
 
   int raw_was_read()
   {
@@ -27,69 +27,231 @@ it under the terms of the one of three licenses as you choose:
 
 #ifdef __cplusplus
 
+#include <boost/thread/mutex.hpp>
+
 #define LIBRAW_MSIZE 64
 
+/* Freed blocks of at least this size may be kept for reuse */
+#define LIBRAW_ARENA_MIN_BLOCK (1<<20)
+#define LIBRAW_ARENA_SLOTS 8
+
 class DllDef libraw_memmgr
 {
   public:
     libraw_memmgr()
         {
-            memset(mems,0,sizeof(mems));
-            calloc_cnt=0;
+            mems = NULL;
+            mems_size = mems_used = 0;
+            memset(arena,0,sizeof(arena));
+            arena_bytes = arena_limit = 0;
+        }
+    ~libraw_memmgr()
+        {
+            arena_release();
+            ::free(mems);
         }
     void *malloc(size_t sz)
         {
-            void *ptr = ::malloc(sz);
-            mem_ptr(ptr);
+            size_t cap = sz;
+            void *ptr = arena_get(&cap);
+            if(!ptr)
+                ptr = ::malloc(sz);
+            mem_ptr(ptr,cap);
             return ptr;
         }
     void *calloc(size_t n, size_t sz)
         {
-            void *ptr =  ::calloc(n,sz);
-            mem_ptr(ptr);
+            size_t cap = (sz && n > ((size_t)-1)/sz) ? 0 : n*sz;
+            void *ptr = arena_get(&cap);
+            if(ptr)
+                memset(ptr,0,n*sz);
+            else
+                ptr =  ::calloc(n,sz);
+            mem_ptr(ptr,cap);
             return ptr;
         }
     void *realloc(void *ptr,size_t newsz)
         {
+            if(ptr && newsz && arena_limit)
+                {
+                    size_t cap = forget_ptr(ptr);
+                    if(cap >= newsz && newsz)
+                        {
+                            mem_ptr(ptr,cap);
+                            return ptr;
+                        }
+                    void *ret = ::realloc(ptr,newsz);
+                    mem_ptr(ret ? ret : ptr, ret ? newsz : cap);
+                    return ret;
+                }
+            size_t cap = forget_ptr(ptr);
             void *ret = ::realloc(ptr,newsz);
-            forget_ptr(ptr);
-            mem_ptr(ret);
+            if(ret)
+                mem_ptr(ret,newsz);
+            else if(ptr && newsz)
+                mem_ptr(ptr,cap);	/* failed: ptr is still ours */
             return ret;
         }
     void  free(void *ptr)
     {
-        forget_ptr(ptr);
-        ::free(ptr);
+        size_t cap = forget_ptr(ptr);
+        if(!arena_put(ptr,cap))
+            ::free(ptr);
     }
     void cleanup(void)
     {
-        for(int i = 0; i< LIBRAW_MSIZE; i++)
-            if(mems[i])
+        for(size_t i = 0; i< mems_size; i++)
+            if(mems[i].ptr && mems[i].ptr != tombstone())
+                free(mems[i].ptr);
+    }
+    /* Keep up to bytes of freed large blocks (image, raw and demosaic
+       buffers) across recycle() for the next file; 0 disables reuse */
+    void set_arena_limit(size_t bytes)
+    {
+        boost::mutex::scoped_lock lock(mems_lock);
+        arena_limit = bytes;
+        arena_trim(0);
+    }
+    void arena_release()
+    {
+        boost::mutex::scoped_lock lock(mems_lock);
+        size_t save = arena_limit;
+        arena_limit = 0;
+        arena_trim(0);
+        arena_limit = save;
+    }
+
+  private:
+    struct mem_entry { void *ptr; size_t size; };
+    mem_entry *mems;		/* open addressing, power of two sized */
+    size_t mems_size, mems_used;
+    mem_entry arena[LIBRAW_ARENA_SLOTS];
+    size_t arena_bytes, arena_limit;
+    // decoder and demosaic worker threads allocate through here too
+    boost::mutex mems_lock;
+
+    static void *tombstone() { return (void*)~(size_t)0; }
+    static size_t slot_of(void *ptr, size_t mask)
+    {
+        size_t h = (size_t)ptr >> 4;
+        h ^= h >> 16;
+        return (h * 0x9E3779B1u) & mask;
+    }
+    bool mems_grow()
+    {
+        size_t nsize = mems_size ? mems_size : LIBRAW_MSIZE*2, live = 0;
+        for(size_t i=0; i < mems_size; i++)
+            if(mems[i].ptr && mems[i].ptr != tombstone())
+                live++;
+        /* rehashing also drops the tombstones left by forget_ptr() */
+        while((live+1)*4 > nsize)
+            nsize *= 2;
+        mem_entry *n = (mem_entry*) ::calloc(nsize,sizeof(mem_entry));
+        if(!n)
+            return false;
+        for(size_t i=0; i < mems_size; i++)
+            if(mems[i].ptr && mems[i].ptr != tombstone())
+                {
+                    size_t j = slot_of(mems[i].ptr,nsize-1);
+                    while(n[j].ptr) j = (j+1) & (nsize-1);
+                    n[j] = mems[i];
+                }
+        ::free(mems);
+        mems = n;
+        mems_size = nsize;
+        mems_used = live;
+        return true;
+    }
+    void mem_ptr(void *ptr, size_t size)
+    {
+        boost::mutex::scoped_lock lock(mems_lock);
+        if(!ptr)
+            return;
+        if((mems_used+1)*2 > mems_size && !mems_grow())
+            return;	/* untracked: only cleanup() after an exception misses it */
+        size_t j = slot_of(ptr,mems_size-1);
+        while(mems[j].ptr && mems[j].ptr != tombstone())
+            j = (j+1) & (mems_size-1);
+        if(!mems[j].ptr)
+            mems_used++;
+        mems[j].ptr = ptr;
+        mems[j].size = size;
+    }
+    /* returns the recorded block size, 0 if ptr was not tracked */
+    size_t forget_ptr(void *ptr)
+    {
+        boost::mutex::scoped_lock lock(mems_lock);
+        if(!ptr || !mems_size)
+            return 0;
+        for(size_t j = slot_of(ptr,mems_size-1); mems[j].ptr; j = (j+1) & (mems_size-1))
+            if(mems[j].ptr == ptr)
                 {
-                    free(mems[i]);
-                    mems[i] = NULL;
+                    mems[j].ptr = tombstone();
+                    return mems[j].size;
                 }
+        return 0;
     }
 
-  private:
-    void *mems[LIBRAW_MSIZE];
-    int calloc_cnt;
-    void mem_ptr(void *ptr)
+    /* Smallest kept block that holds *size bytes without wasting more than
+       half of it; *size is set to the block's real size */
+    void *arena_get(size_t *size)
     {
-        if(ptr)
-            for(int i=0;i < LIBRAW_MSIZE; i++)
-                if(!mems[i])
-                    {
-                        mems[i] = ptr;
-                        break;
-                    }
+        if(!arena_limit || *size < LIBRAW_ARENA_MIN_BLOCK)
+            return NULL;
+        boost::mutex::scoped_lock lock(mems_lock);
+        int best = -1;
+        for(int i=0; i < LIBRAW_ARENA_SLOTS; i++)
+            if(arena[i].ptr && arena[i].size >= *size && arena[i].size/2 <= *size
+               && (best < 0 || arena[i].size < arena[best].size))
+                best = i;
+        if(best < 0)
+            return NULL;
+        void *ptr = arena[best].ptr;
+        *size = arena[best].size;
+        arena_bytes -= arena[best].size;
+        arena[best].ptr = NULL;
+        return ptr;
+    }
+    bool arena_put(void *ptr, size_t size)
+    {
+        if(!ptr || !arena_limit || size < LIBRAW_ARENA_MIN_BLOCK)
+            return false;
+        boost::mutex::scoped_lock lock(mems_lock);
+        if(size > arena_limit)
+            return false;
+        arena_trim(size);
+        for(int i=0; i < LIBRAW_ARENA_SLOTS; i++)
+            if(!arena[i].ptr)
+                {
+                    arena[i].ptr = ptr;
+                    arena[i].size = size;
+                    arena_bytes += size;
+                    return true;
+                }
+        return false;
     }
-    void forget_ptr(void *ptr)
+    /* drop the smallest kept blocks until another `room' bytes (and one
+       slot, if room is non-zero) fit under the limit */
+    void arena_trim(size_t room)
     {
-        if(ptr)
-            for(int i=0;i < LIBRAW_MSIZE; i++)
-                if(mems[i] == ptr)
-                    mems[i] = NULL;
+        for(;;)
+            {
+                int smallest = -1, used = 0;
+                for(int i=0; i < LIBRAW_ARENA_SLOTS; i++)
+                    if(arena[i].ptr)
+                        {
+                            used++;
+                            if(smallest < 0 || arena[i].size < arena[smallest].size)
+                                smallest = i;
+                        }
+                if(smallest < 0)
+                    return;
+                if(arena_bytes + room <= arena_limit && (!room || used < LIBRAW_ARENA_SLOTS))
+                    return;
+                ::free(arena[smallest].ptr);
+                arena_bytes -= arena[smallest].size;
+                arena[smallest].ptr = NULL;
+            }
     }
 
 };
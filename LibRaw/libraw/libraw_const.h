@@ -284,4 +284,17 @@ enum LibRaw_image_formats
     LIBRAW_IMAGE_BITMAP=2
 };
 
+enum LibRaw_preview_stage
+{
+    LIBRAW_PREVIEW_THUMBNAIL=1,	/* embedded preview, JPEG or bitmap */
+    LIBRAW_PREVIEW_HALF_SIZE=2,	/* half_size dcraw_process() result */
+    LIBRAW_PREVIEW_FULL=3		/* dcraw_process() result at the current settings */
+};
+
+enum LibRaw_float_image_formats
+{
+    LIBRAW_FLOAT_RGBA32=0,	/* 4 x float per pixel */
+    LIBRAW_FLOAT_RGBA16=1	/* 4 x IEEE half per pixel */
+};
+
 #endif
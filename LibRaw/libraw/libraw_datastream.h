@@ -74,7 +74,7 @@ class LibRaw_bit_buffer;
 class DllDef LibRaw_abstract_datastream
 {
   public:
-    LibRaw_abstract_datastream(){ substream=0;};
+    LibRaw_abstract_datastream(){ substream=0; memory_backed=0;};
     virtual             ~LibRaw_abstract_datastream(void){if(substream) delete substream;}
     virtual int         valid() = 0;
     virtual int         read(void *,size_t, size_t ) = 0;
@@ -102,8 +102,13 @@ class DllDef LibRaw_abstract_datastream
     virtual int		tempbuffer_open(void*, size_t);
     virtual void	tempbuffer_close();
 
+    /* Non-NULL while all data is in memory, so that bit readers can use
+       LibRaw_buffer_datastream::get_byte() instead of virtual get_char() */
+    inline LibRaw_buffer_datastream *memory_stream();
+
   protected:
     LibRaw_abstract_datastream *substream;
+    int memory_backed;
 };
 
 #ifdef WIN32
@@ -174,12 +179,24 @@ class DllDef  LibRaw_buffer_datastream : public LibRaw_abstract_datastream
             return -1;
         return buf[streampos++];
     }
+    /* get_char() for callers that already checked memory_stream() */
+    int                 get_byte()
+    {
+        if(streampos>=streamsize)
+            return -1;
+        return buf[streampos++];
+    }
 
   private:
     unsigned char *buf;
     size_t   streampos,streamsize;
 };
 
+inline LibRaw_buffer_datastream *LibRaw_abstract_datastream::memory_stream()
+{
+    return memory_backed && !substream ? static_cast<LibRaw_buffer_datastream*>(this) : NULL;
+}
+
 class DllDef LibRaw_bigfile_datastream : public LibRaw_abstract_datastream
 {
   public:
@@ -249,6 +266,32 @@ protected:
     __int64	cbView_;		/* size of the mapping in bytes */
 };
 
+#else
+class DllDef  LibRaw_mmap_datastream : public LibRaw_buffer_datastream
+{
+public:
+    /* ctor: maps the whole file read-only; valid() is 0 if that fails */
+    LibRaw_mmap_datastream(const char *fname);
+    /* dtor: unmap the file */
+    virtual ~LibRaw_mmap_datastream();
+    virtual INT64 size() { return cbView_;}
+    virtual const char* fname() { return filename.c_str(); }
+    /* ask the kernel to start reading [offset, offset+length) now, e.g. the
+       next frame of a CinemaDNG sequence; length <= 0 means up to the end */
+    void readahead(INT64 offset = 0, INT64 length = 0);
+
+protected:
+    inline void reconstruct_base()
+	{
+            /* same subterfuge as LibRaw_windows_datastream */
+            (LibRaw_buffer_datastream&)*this = LibRaw_buffer_datastream(pView_, (size_t)cbView_);
+	}
+
+    std::string filename;
+    void*		pView_;			/* pointer to the mapped memory */
+    INT64	cbView_;		/* size of the mapping in bytes */
+};
+
 #endif
 
 #ifdef USE_DNGSDK
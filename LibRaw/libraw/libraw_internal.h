@@ -111,6 +111,9 @@ typedef struct
 {
     int         (*histogram)[LIBRAW_HISTOGRAM_SIZE];
     unsigned    *oprof;
+    int         linear_output;	/* 1: dcraw_process_linear() running, 2: linear_cam ready */
+    float       linear_cam[3][4];
+    float       linear_mul[4];	/* white balance and scaling held back by scale_colors() */
 } output_data_t;
 
 typedef struct
@@ -148,6 +148,9 @@ typedef struct
     unsigned char data[1];
 }libraw_processed_image_t;
 
+/* image is only valid during the call; return non-zero to skip later stages */
+typedef int (* preview_callback) (void *data,enum LibRaw_preview_stage stage, libraw_processed_image_t *image);
+
 
 typedef struct
 {
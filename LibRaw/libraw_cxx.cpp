@@ -26,6 +26,9 @@ it under the terms of the one of three licenses as you choose:
 #include <exception>
 #include <sys/types.h>
 #include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #ifndef WIN32
 #include <netinet/in.h>
 #else
@@ -34,6 +37,7 @@ it under the terms of the one of three licenses as you choose:
 #define LIBRAW_LIBRARY_BUILD
 #include "libraw/libraw.h"
 #include "internal/defines.h"
+#include "internal/demosaic_threads.h"
 #include <zlib.h>
 
 #if defined(_WIN32)
@@ -210,6 +214,7 @@ LibRaw_colormatrix_type LibRaw::camera_color_type()
 
 void LibRaw::derror()
 {
+  boost::mutex::scoped_lock lock(derror_lock);
   if (!libraw_internal_data.unpacker_data.data_error && libraw_internal_data.internal_data.input)
     {
       if (libraw_internal_data.internal_data.input->eof())
@@ -372,6 +377,7 @@ LibRaw:: LibRaw(unsigned int flags)
   dnghost =  NULL;
   _x3f_data = NULL;
   _nthreads = 0;
+  _workers = NULL;
 
 #ifdef USE_RAWSPEED
   CameraMetaDataLR *camerameta = make_camera_metadata(); // May be NULL in case of exception in make_camera_metadata()
@@ -3149,6 +3155,9 @@ int LibRaw::copy_mem_image(void* scan0, int stride, int bgr)
     // the image memory pointed to by scan0 is assumed to be in the format returned by get_mem_image_format
     if((imgdata.progress_flags & LIBRAW_PROGRESS_THUMB_MASK) < LIBRAW_PROGRESS_PRE_INTERPOLATE)
         return LIBRAW_OUT_OF_ORDER_CALL;
+    // camera-space data left by dcraw_process_linear() is read with copy_float_image()
+    if(libraw_internal_data.output_data.linear_output == 2)
+        return LIBRAW_OUT_OF_ORDER_CALL;
 
     if(libraw_internal_data.output_data.histogram)
       {
@@ -3224,9 +3233,55 @@ int LibRaw::copy_mem_image(void* scan0, int stride, int bgr)
 
 
 
+int LibRaw::dcraw_process_linear(void)
+{
+  libraw_internal_data.output_data.linear_output = 1;
+  for (int c=0; c < 4; c++)
+    libraw_internal_data.output_data.linear_mul[c] = 1.f;
+  int ret = dcraw_process();
+  if (libraw_internal_data.output_data.linear_output != 2)
+    libraw_internal_data.output_data.linear_output = 0;
+  return ret;
+}
+
+int LibRaw::copy_float_image(void* scan0, int stride, int format)
+{
+    // the image memory pointed to by scan0 is assumed to hold get_mem_image_format() pixels, 4 channels each
+    if(libraw_internal_data.output_data.linear_output != 2)
+        return LIBRAW_OUT_OF_ORDER_CALL;
+    if(format != LIBRAW_FLOAT_RGBA32 && format != LIBRAW_FLOAT_RGBA16)
+        return LIBRAW_REQUEST_FOR_NONEXISTENT_IMAGE;
+
+    /* Columns of the camera to output matrix, with the white balance
+       multipliers scale_colors() held back and scaled so that white maps
+       to 1.0, plus a fourth row that produces alpha = 1 */
+    float mat[4][4];
+    for (int c=0; c < 4; c++)
+      {
+        for (int i=0; i < 3; i++)
+          mat[c][i] = libraw_internal_data.output_data.linear_cam[i][c]
+            * libraw_internal_data.output_data.linear_mul[c] / 65535.f;
+        mat[c][3] = 0.f;
+      }
+
+    int s_iheight = S.iheight;
+    int s_iwidth = S.iwidth;
+    S.iheight = S.height;
+    S.iwidth  = S.width;
+    convert_to_float_loop(mat, scan0, stride, format);
+    S.iheight = s_iheight;
+    S.iwidth = s_iwidth;
+    return 0;
+}
+
 libraw_processed_image_t *LibRaw::dcraw_make_mem_image(int *errcode)
 
 {
+    if(libraw_internal_data.output_data.linear_output == 2)
+        {
+                if(errcode) *errcode= LIBRAW_OUT_OF_ORDER_CALL;
+                return NULL;
+        }
     int width, height, colors, bps;
     get_mem_image_format(&width, &height, &colors, &bps);
     int stride = width * (bps/8) * colors;
@@ -3261,7 +3316,7 @@ int LibRaw::dcraw_ppm_tiff_writer(const char *filename)
 {
   CHECK_ORDER_LOW(LIBRAW_PROGRESS_LOAD_RAW);
 
-  if(!imgdata.image)
+  if(!imgdata.image || libraw_internal_data.output_data.linear_output == 2)
     return LIBRAW_OUT_OF_ORDER_CALL;
 
   if(!filename)
@@ -3993,6 +4048,147 @@ void LibRaw::scale_colors_loop(float scale_mul[4])
   }
 }
 
+struct float_image_target
+{
+    uchar *scan0;
+    int stride, format;
+    int soff, rstep, cstep;
+};
+
+static inline ushort float_to_half(float f)
+{
+    union { float f; unsigned u; } v;
+    v.f = f;
+    unsigned sign = (v.u >> 16) & 0x8000;
+    unsigned a = v.u & 0x7fffffff, h, rem, halfway;
+
+    if (a >= 0x47800000)			// 65536 and up, inf, NaN
+        return sign | (a > 0x7f800000 ? 0x7e00 : 0x7c00);
+    if (a < 0x38800000)				// half denormals
+      {
+        if (a < 0x33000000) return sign;
+        unsigned m = (a & 0x7fffff) | 0x800000;
+        int shift = 126 - (int)(a >> 23);
+        h = m >> shift;
+        rem = m & ((1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+      }
+    else
+      {
+        h = (a - 0x38000000) >> 13;
+        rem = a & 0x1fff;
+        halfway = 0x1000;
+      }
+    if (rem > halfway || (rem == halfway && (h & 1))) h++;	// a carry rounds up to inf
+    return sign | h;
+}
+
+void convert_to_float_thread_func (LIBRAWThreadData *td)
+{
+    const ushort (*image)[4] = (const ushort (*)[4]) td->ptr1;
+    const float (*mat)[4] = (const float (*)[4]) td->ptr2;
+    const float_image_target *t = (const float_image_target *) td->ptr3;
+    float out[4];
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 alpha = _mm_set_ps(1.f, 0.f, 0.f, 0.f);
+    const __m128 m0 = _mm_loadu_ps(mat[0]), m1 = _mm_loadu_ps(mat[1]),
+                 m2 = _mm_loadu_ps(mat[2]), m3 = _mm_loadu_ps(mat[3]);
+#endif
+
+    for (int row=td->topStart; row < td->height; row += td->topIncr)
+      {
+        int soff = t->soff + row * t->rstep;
+        float *dstf = (float *) (t->scan0 + (size_t) row * t->stride);
+        ushort *dsth = (ushort *) dstf;
+        for (int col=0; col < td->width; col++, soff += t->cstep)
+          {
+            const ushort *img = image[soff];
+#ifdef __SSE2__
+            __m128 v = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *) img), zero));
+            __m128 o = _mm_add_ps(alpha, _mm_mul_ps(m0, _mm_shuffle_ps(v, v, 0x00)));
+            o = _mm_add_ps(o, _mm_mul_ps(m1, _mm_shuffle_ps(v, v, 0x55)));
+            o = _mm_add_ps(o, _mm_mul_ps(m2, _mm_shuffle_ps(v, v, 0xaa)));
+            o = _mm_add_ps(o, _mm_mul_ps(m3, _mm_shuffle_ps(v, v, 0xff)));
+            if (t->format == LIBRAW_FLOAT_RGBA32)
+              {
+                _mm_storeu_ps(dstf + col*4, o);
+                continue;
+              }
+            _mm_storeu_ps(out, o);
+#else
+            for (int c=0; c < 4; c++)
+                out[c] = (c == 3) + mat[0][c]*img[0] + mat[1][c]*img[1]
+                    + mat[2][c]*img[2] + mat[3][c]*img[3];
+            if (t->format == LIBRAW_FLOAT_RGBA32)
+              {
+                memmove(dstf + col*4, out, sizeof(out));
+                continue;
+              }
+#endif
+            for (int c=0; c < 4; c++)
+                dsth[col*4+c] = float_to_half(out[c]);
+          }
+      }
+}
+
+/*
+   Camera space to linear output RGBA in one pass: mat holds one column per
+   camera channel, so each pixel is a 4x4 matrix-vector product with the
+   alpha folded in, written straight into the caller's rows in output
+   orientation.
+ */
+void LibRaw::convert_to_float_loop(float mat[4][4], void *scan0, int stride, int format)
+{
+    float_image_target t;
+    int width = S.width, height = S.height;
+
+    if (S.flip & 4) std::swap(width, height);
+    t.scan0 = (uchar *) scan0;
+    t.stride = stride;
+    t.format = format;
+    t.soff = flip_index(0, 0);
+    t.cstep = flip_index(0, 1) - t.soff;
+    t.rstep = flip_index(1, 0) - t.soff;
+
+    int nthreads = _nthreads > 1 ? _nthreads : 1;
+    if (nthreads > height) nthreads = height;
+    if (nthreads <= 1)
+      {
+        LIBRAWThreadData td;
+        td.topStart = 0;
+        td.topIncr = 1;
+        td.width = width;
+        td.height = height;
+        td.ptr1 = (void *) imgdata.image[0];
+        td.ptr2 = (void *) mat[0];
+        td.ptr3 = (void *) &t;
+        convert_to_float_thread_func(&td);
+        return;
+      }
+
+    std::vector< boost::thread *> workerThread(nthreads);
+    std::vector< LIBRAWThreadData > td(nthreads);
+
+    for (int i=0; i < nthreads; ++i)
+    {
+        td[i].topStart    = i;
+        td[i].topIncr     = nthreads;
+        td[i].width       = width;
+        td[i].height      = height;
+        td[i].ptr1        = (void *) imgdata.image[0];
+        td[i].ptr2        = (void *) mat[0];
+        td[i].ptr3        = (void *) &t;
+        workerThread[i] = new boost::thread(convert_to_float_thread_func, &td[i]);
+    }
+
+    for (int i=0; i < nthreads; ++i)
+    {
+        workerThread[i]->join();
+        delete workerThread[i];
+    }
+}
+
 void LibRaw::adjust_bl()
 {
   int clear_repeat=0;
@@ -4070,6 +4266,26 @@ int LibRaw::dcraw_process(void)
   CHECK_ORDER_LOW(LIBRAW_PROGRESS_LOAD_RAW);
   //    CHECK_ORDER_HIGH(LIBRAW_PROGRESS_PRE_INTERPOLATE);
 
+  // drop a camera-space image left over from an earlier dcraw_process_linear()
+  if (libraw_internal_data.output_data.linear_output != 1)
+    libraw_internal_data.output_data.linear_output = 0;
+
+  // one set of worker threads serves every threaded pass of this call
+  struct workers_scope
+  {
+    LibRaw *owner;
+    workers_scope(LibRaw *o) : owner(o)
+    {
+      if (owner->_nthreads > 1)
+        owner->_workers = new libraw_thread_pool(owner->_nthreads);
+    }
+    ~workers_scope()
+    {
+      delete owner->_workers;
+      owner->_workers = NULL;
+    }
+  } workers(this);
+
   try {
 
     int no_crop = 1;
@@ -4255,13 +4471,14 @@ int LibRaw::dcraw_process(void)
           }
       }
 
-    if (O.highlight == 2)
+    // the linear image is not white balanced yet and keeps values above white
+    if (O.highlight == 2 && libraw_internal_data.output_data.linear_output != 1)
       {
         blend_highlights();
         SET_PROC_FLAG(LIBRAW_PROGRESS_HIGHLIGHTS);
       }
 
-    if (O.highlight > 2)
+    if (O.highlight > 2 && libraw_internal_data.output_data.linear_output != 1)
       {
         recover_highlights();
         SET_PROC_FLAG(LIBRAW_PROGRESS_HIGHLIGHTS);
@@ -4303,6 +4520,83 @@ int LibRaw::dcraw_process(void)
   }
 }
 
+struct progressive_state
+{
+  LibRaw *owner;
+  progress_callback cb;
+  void *data;
+};
+
+// Stands in for the user's progress callback during progressive_process(),
+// so that setCancelFlag() stops a stage at its next progress report
+int LibRaw::progressive_progress(void *data, enum LibRaw_progress stage, int iteration, int expected)
+{
+  progressive_state *ps = (progressive_state *) data;
+  ps->owner->checkCancel();
+  return ps->cb ? (*ps->cb)(ps->data, stage, iteration, expected) : 0;
+}
+
+int LibRaw::progressive_stage(preview_callback cb, void *data, enum LibRaw_preview_stage stage, int *stop)
+{
+  libraw_processed_image_t *img;
+  int ret, errc = 0;
+
+  try {
+    checkCancel();
+  }
+  catch ( LibRaw_exceptions err) {
+    EXCEPTION_HANDLER(err);
+  }
+  if (stage == LIBRAW_PREVIEW_THUMBNAIL)
+    img = dcraw_make_mem_thumb(&errc);
+  else if ((ret = dcraw_process()) != LIBRAW_SUCCESS)
+    return ret;
+  else
+    img = dcraw_make_mem_image(&errc);
+  if (!img)
+    return errc == ENOMEM ? LIBRAW_UNSUFFICIENT_MEMORY : errc;
+  *stop = (*cb)(data, stage, img);
+  dcraw_clear_mem(img);
+  return LIBRAW_SUCCESS;
+}
+
+int LibRaw::progressive_process(preview_callback cb, void *data)
+{
+  CHECK_ORDER_LOW(LIBRAW_PROGRESS_IDENTIFY);
+
+  progressive_state ps;
+  ps.owner = this;
+  ps.cb = callbacks.progress_cb;
+  ps.data = callbacks.progresscb_data;
+  callbacks.progress_cb = progressive_progress;
+  callbacks.progresscb_data = &ps;
+
+  int save_half = O.half_size;
+  int ret = LIBRAW_SUCCESS, stop = 0;
+
+  // the embedded preview is optional, so only a cancel ends things here
+  if ((imgdata.progress_flags & LIBRAW_PROGRESS_THUMB_LOAD) || !(ret = unpack_thumb()))
+    ret = progressive_stage(cb, data, LIBRAW_PREVIEW_THUMBNAIL, &stop);
+  if (ret != LIBRAW_CANCELLED_BY_CALLBACK && !stop)
+    {
+      ret = LIBRAW_SUCCESS;
+      if (!(imgdata.progress_flags & LIBRAW_PROGRESS_LOAD_RAW))
+        ret = unpack();
+      if (!ret && !save_half)
+        {
+          O.half_size = 1;
+          ret = progressive_stage(cb, data, LIBRAW_PREVIEW_HALF_SIZE, &stop);
+          O.half_size = save_half;
+        }
+      if (!ret && !stop)
+        ret = progressive_stage(cb, data, LIBRAW_PREVIEW_FULL, &stop);
+    }
+
+  callbacks.progress_cb = ps.cb;
+  callbacks.progresscb_data = ps.data;
+  return ret;
+}
+
 // Supported cameras:
 static const char  *static_camera_list[] =
 {
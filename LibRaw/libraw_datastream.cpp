@@ -30,6 +30,11 @@
 #include "libraw/libraw.h"
 #include "libraw/libraw_datastream.h"
 #include <sys/stat.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #ifdef USE_JASPER
 #include <jasper/jasper.h>	/* Decode RED camera movies */
 #else
@@ -293,6 +298,7 @@ int LibRaw_file_datastream::jpeg_src(void *jpegdata)
 LibRaw_buffer_datastream::LibRaw_buffer_datastream(void *buffer, size_t bsize)
 {    
     buf = (unsigned char*)buffer; streampos = 0; streamsize = bsize;
+    memory_backed = 1;
 }
 
 LibRaw_buffer_datastream::~LibRaw_buffer_datastream(){}
@@ -697,6 +703,51 @@ void LibRaw_windows_datastream::Open(HANDLE hFile)
         throw std::runtime_error("failed to map the file"); 
 }
 
+#else
+
+// == LibRaw_mmap_datastream
+LibRaw_mmap_datastream::LibRaw_mmap_datastream(const char *fname)
+    : LibRaw_buffer_datastream(NULL, 0)
+    , filename(fname)
+    , pView_(NULL)
+    , cbView_(0)
+{
+    struct stat st;
+    int fd = ::open(fname, O_RDONLY);
+    if (fd < 0)
+        return;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void *view = ::mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED)
+                {
+                    pView_ = view;
+                    cbView_ = st.st_size;
+                    /* decoders mostly walk the file front to back */
+                    ::madvise(pView_, (size_t)cbView_, MADV_SEQUENTIAL);
+                }
+        }
+    ::close(fd);		// the mapping keeps its own reference to the file
+    reconstruct_base();
+}
+
+LibRaw_mmap_datastream::~LibRaw_mmap_datastream()
+{
+    if (pView_ != NULL)
+        ::munmap(pView_, (size_t)cbView_);
+}
+
+void LibRaw_mmap_datastream::readahead(INT64 offset, INT64 length)
+{
+    if (pView_ == NULL || offset < 0 || offset >= cbView_)
+        return;
+    if (length <= 0 || length > cbView_ - offset)
+        length = cbView_ - offset;
+    // madvise() wants a page-aligned start
+    INT64 page = sysconf(_SC_PAGESIZE);
+    INT64 start = offset - offset % page;
+    ::madvise((char*)pView_ + start, (size_t)(offset + length - start), MADV_WILLNEED);
+}
 
 #endif
 
@@ -100,6 +100,15 @@ extern float icvCubicCoeffs[(ICV_CUBIC_TAB_SIZE+1)*2];
 
 void icvInitCubicCoeffTab();
 
+/* fixed-point remap maps keep this many fractional bits per coordinate */
+#define ICV_REMAP_SHIFT         7
+#define ICV_REMAP_MASK          ((1 << ICV_REMAP_SHIFT) - 1)
+
+/* down-samples src to [(w+1)/2 x (h+1)/2] in parallel row bands; *buffer is
+   the scratch memory of the bands, reallocated when it is smaller than needed */
+CvStatus icvPyrDownParallel( const CvMat* src, CvMat* dst,
+                             uchar** buffer, int* buffer_size );
+
 CvStatus CV_STDCALL icvGetRectSubPix_8u_C1R
 ( const uchar* src, int src_step, CvSize src_size,
   uchar* dst, int dst_step, CvSize win_size, CvPoint2D32f center );
@@ -76,8 +76,11 @@ CVAPI(void) cvCopyMakeBorder( const CvArr* src, CvArr* dst, CvPoint offset,
 #define CV_GAUSSIAN  2
 #define CV_MEDIAN 3
 #define CV_BILATERAL 4
+#define CV_GAUSSIAN_RECURSIVE 5
 
-/* Smoothes array (removes noise) */
+/* Smoothes array (removes noise).
+   CV_GAUSSIAN_RECURSIVE takes sigma from param3 (param4 for the vertical direction,
+   if non-zero) and ignores the aperture size; its cost does not depend on sigma */
 CVAPI(void) cvSmooth( const CvArr* src, CvArr* dst,
                       int smoothtype CV_DEFAULT(CV_GAUSSIAN),
                       int param1 CV_DEFAULT(3),
@@ -111,6 +114,18 @@ CVAPI(void)  cvPyrUp( const CvArr* src, CvArr* dst,
                       int filter CV_DEFAULT(CV_GAUSSIAN_5x5) );
 
 
+/* Allocates a pyramid of <level_count> levels for images of the given size and type.
+   Every level is (size+1)/2 of the previous one in each dimension */
+CVAPI(CvImagePyramid*) cvCreateImagePyramid( CvSize size, int type, int level_count );
+
+/* Releases the pyramid */
+CVAPI(void)  cvReleaseImagePyramid( CvImagePyramid** pyramid );
+
+/* Fills the pyramid from src, which must have the size and type the pyramid was created
+   for. levels[0] is set to refer to src, the other levels are computed with the same
+   5x5 Gaussian as cvPyrDown, each split into row bands processed in parallel */
+CVAPI(void)  cvBuildImagePyramid( const CvArr* src, CvImagePyramid* pyramid );
+
 /* Builds the whole pyramid at once. Output array of CvMat headers (levels[*])
    is initialized with the headers of subsequent pyramid levels */
 /*CVAPI  void  cvCalcPyramid( const CvArr* src, CvArr* container,
@@ -296,6 +311,11 @@ CVAPI(void)  cvRemap( const CvArr* src, CvArr* dst,
                       int flags CV_DEFAULT(CV_INTER_LINEAR+CV_WARP_FILL_OUTLIERS),
                       CvScalar fillval CV_DEFAULT(cvScalarAll(0)) );
 
+/* Converts 32fC1 coordinate maps to the fixed-point representation
+   (16sC2 integer coordinates + 16uC1 fractions) that cvRemap processes faster */
+CVAPI(void)  cvConvertMaps( const CvArr* mapx, const CvArr* mapy,
+                            CvArr* mapxy, CvArr* mapalpha );
+
 /* Performs forward or inverse log-polar image transform */
 CVAPI(void)  cvLogPolar( const CvArr* src, CvArr* dst,
                          CvPoint2D32f center, double M,
@@ -304,6 +324,10 @@ CVAPI(void)  cvLogPolar( const CvArr* src, CvArr* dst,
 #define  CV_SHAPE_RECT      0
 #define  CV_SHAPE_CROSS     1
 #define  CV_SHAPE_ELLIPSE   2
+/* the ellipse approximated by a union of a few centered rectangles
+   inscribed into it; erosion and dilation with it take the time
+   that does not depend on the element size */
+#define  CV_SHAPE_ELLIPSE_APPROX 3
 #define  CV_SHAPE_CUSTOM    100
 
 /* creates structuring element used for morphological operations */
@@ -471,6 +495,10 @@ CVAPI(void)  cvCalcOpticalFlowHS( const CvArr* prev, const CvArr* curr,
 #define  CV_LKFLOW_PYR_A_READY       1
 #define  CV_LKFLOW_PYR_B_READY       2
 #define  CV_LKFLOW_INITIAL_GUESSES   4
+/* tracks each feature through all the levels as one task, on integer
+   patches and Scharr derivatives cached per level; faster, with results
+   slightly different from the default floating-point tracker */
+#define  CV_LKFLOW_FIXED_POINT       8
 
 /* It is Lucas & Kanade method, modified to use pyramids.
    Also it does several iterations to get optical flow for
@@ -876,6 +904,12 @@ CV_INLINE  void  cvCalcHist( IplImage** image, CvHistogram* hist,
     cvCalcArrHist( (CvArr**)image, hist, accumulate, mask );
 }
 
+/* Calculates histograms of <count> frames: hist[i] of the planes arr[i]
+   (and the optional mask[i]). The histograms must be distinct */
+CVAPI(void)  cvCalcArrHistBatch( CvArr*** arr, CvHistogram** hist, int count,
+                                 int accumulate CV_DEFAULT(0),
+                                 const CvArr** mask CV_DEFAULT(NULL) );
+
 /* Calculates back project */
 CVAPI(void)  cvCalcArrBackProject( CvArr** image, CvArr* dst,
                                    const CvHistogram* hist );
@@ -1087,6 +1121,19 @@ CVAPI(void) cvInitUndistortMap( const CvMat* intrinsic_matrix,
                                 const CvMat* distortion_coeffs,
                                 CvArr* mapx, CvArr* mapy );
 
+/* computes fixed-point undistortion map for images of the given size,
+   to be reused for a sequence of frames shot with the same lens */
+CVAPI(CvUndistortMap*) cvCreateUndistortMap( const CvMat* intrinsic_matrix,
+                                             const CvMat* distortion_coeffs,
+                                             CvSize size );
+
+/* releases undistortion map */
+CVAPI(void) cvReleaseUndistortMap( CvUndistortMap** map );
+
+/* transforms the input image using the precomputed undistortion map */
+CVAPI(void) cvUndistortWithMap( const CvArr* src, CvArr* dst,
+                                const CvUndistortMap* map );
+
 /* converts rotation vector to rotation matrix or vice versa */
 CVAPI(int) cvRodrigues2( const CvMat* src, CvMat* dst,
                          CvMat* jacobian CV_DEFAULT(0) );
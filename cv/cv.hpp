@@ -346,7 +346,7 @@ public:
     uchar* get_element_sparse_buf() { return el_sparse; }
     int get_element_sparse_count() const { return el_sparse_count; }
 
-    enum { RECT=0, CROSS=1, ELLIPSE=2, CUSTOM=100, BINARY = 0, GRAYSCALE=256 };
+    enum { RECT=0, CROSS=1, ELLIPSE=2, ELLIPSE_APPROX=3, CUSTOM=100, BINARY = 0, GRAYSCALE=256 };
     enum { ERODE=0, DILATE=1 };
 
     static void init_binary_element( CvMat* _element, int _element_shape,
@@ -104,6 +104,210 @@ typedef CvStatus (CV_STDCALL * CvColorCvtFunc3)(
     const void* src, int srcstep, void* dst, int dststep,
     CvSize size, int param0, int param1, int param2 );
 
+/* conversions of at least that many pixels are split between the threads */
+#define ICV_CVT_COLOR_PARALLEL_MIN_SIZE  (1 << 16)
+
+#if CV_SSE2
+
+/* The SSE2 row functions below convert the longest prefix of a row they can
+   and return the number of pixels done; the scalar loops finish the row.
+   They repeat the scalar arithmetic operation by operation, so the results are
+   bit-exact with the scalar code. The 8-bit color ones work on 32 pixels at once,
+   kept as planes: channel k of pixels 0..15 in v[k*2], of pixels 16..31 in v[k*2+1] */
+
+/* 32 3-channel pixels (v[0..5]) are sorted by channel after five rounds of unpacking */
+static inline void
+icvDeinterleave3_8u( __m128i* v )
+{
+    __m128i v0 = v[0], v1 = v[1], v2 = v[2], v3 = v[3], v4 = v[4], v5 = v[5];
+    for( int k = 0; k < 5; k++ )
+    {
+        __m128i t0 = _mm_unpacklo_epi8( v0, v3 ), t1 = _mm_unpackhi_epi8( v0, v3 );
+        __m128i t2 = _mm_unpacklo_epi8( v1, v4 ), t3 = _mm_unpackhi_epi8( v1, v4 );
+        __m128i t4 = _mm_unpacklo_epi8( v2, v5 ), t5 = _mm_unpackhi_epi8( v2, v5 );
+        v0 = t0; v1 = t1; v2 = t2; v3 = t3; v4 = t4; v5 = t5;
+    }
+    v[0] = v0; v[1] = v1; v[2] = v2; v[3] = v3; v[4] = v4; v[5] = v5;
+}
+
+/* the inverse of icvDeinterleave3_8u: every round gathers the even and the odd bytes */
+static inline void
+icvInterleave3_8u( __m128i* v )
+{
+    const __m128i lo = _mm_set1_epi16( 0xff );
+    __m128i v0 = v[0], v1 = v[1], v2 = v[2], v3 = v[3], v4 = v[4], v5 = v[5];
+    for( int k = 0; k < 5; k++ )
+    {
+        __m128i t0 = _mm_packus_epi16( _mm_and_si128( v0, lo ), _mm_and_si128( v1, lo ));
+        __m128i t1 = _mm_packus_epi16( _mm_and_si128( v2, lo ), _mm_and_si128( v3, lo ));
+        __m128i t2 = _mm_packus_epi16( _mm_and_si128( v4, lo ), _mm_and_si128( v5, lo ));
+        __m128i t3 = _mm_packus_epi16( _mm_srli_epi16( v0, 8 ), _mm_srli_epi16( v1, 8 ));
+        __m128i t4 = _mm_packus_epi16( _mm_srli_epi16( v2, 8 ), _mm_srli_epi16( v3, 8 ));
+        __m128i t5 = _mm_packus_epi16( _mm_srli_epi16( v4, 8 ), _mm_srli_epi16( v5, 8 ));
+        v0 = t0; v1 = t1; v2 = t2; v3 = t3; v4 = t4; v5 = t5;
+    }
+    v[0] = v0; v[1] = v1; v[2] = v2; v[3] = v3; v[4] = v4; v[5] = v5;
+}
+
+/* 16 4-channel pixels (v[0..3]) are sorted by channel after four rounds */
+static inline void
+icvDeinterleave4_8u( __m128i* v )
+{
+    __m128i v0 = v[0], v1 = v[1], v2 = v[2], v3 = v[3];
+    for( int k = 0; k < 4; k++ )
+    {
+        __m128i t0 = _mm_unpacklo_epi8( v0, v2 ), t1 = _mm_unpackhi_epi8( v0, v2 );
+        __m128i t2 = _mm_unpacklo_epi8( v1, v3 ), t3 = _mm_unpackhi_epi8( v1, v3 );
+        v0 = t0; v1 = t1; v2 = t2; v3 = t3;
+    }
+    v[0] = v0; v[1] = v1; v[2] = v2; v[3] = v3;
+}
+
+static inline void
+icvInterleave4_8u( __m128i* v )
+{
+    const __m128i lo = _mm_set1_epi16( 0xff );
+    __m128i v0 = v[0], v1 = v[1], v2 = v[2], v3 = v[3];
+    for( int k = 0; k < 4; k++ )
+    {
+        __m128i t0 = _mm_packus_epi16( _mm_and_si128( v0, lo ), _mm_and_si128( v1, lo ));
+        __m128i t1 = _mm_packus_epi16( _mm_and_si128( v2, lo ), _mm_and_si128( v3, lo ));
+        __m128i t2 = _mm_packus_epi16( _mm_srli_epi16( v0, 8 ), _mm_srli_epi16( v1, 8 ));
+        __m128i t3 = _mm_packus_epi16( _mm_srli_epi16( v2, 8 ), _mm_srli_epi16( v3, 8 ));
+        v0 = t0; v1 = t1; v2 = t2; v3 = t3;
+    }
+    v[0] = v0; v[1] = v1; v[2] = v2; v[3] = v3;
+}
+
+/* loads 32 pixels of 3 or 4 channels as the three color planes v[0..5] */
+static inline void
+icvLoadPlanes_8u( const uchar* src, int cn, __m128i* v )
+{
+    if( cn == 3 )
+    {
+        for( int k = 0; k < 6; k++ )
+            v[k] = _mm_loadu_si128( (const __m128i*)(src + k*16) );
+        icvDeinterleave3_8u( v );
+    }
+    else
+    {
+        __m128i a[4], b[4];
+        for( int k = 0; k < 4; k++ )
+        {
+            a[k] = _mm_loadu_si128( (const __m128i*)(src + k*16) );
+            b[k] = _mm_loadu_si128( (const __m128i*)(src + k*16 + 64) );
+        }
+        icvDeinterleave4_8u( a );
+        icvDeinterleave4_8u( b );
+        v[0] = a[0]; v[1] = b[0]; v[2] = a[1]; v[3] = b[1]; v[4] = a[2]; v[5] = b[2];
+    }
+}
+
+/* stores the planes v[0..5] as 32 pixels of 3 or 4 channels, the 4th channel is 0 */
+static inline void
+icvStorePlanes_8u( uchar* dst, int cn, const __m128i* v )
+{
+    if( cn == 3 )
+    {
+        __m128i t[6];
+        for( int k = 0; k < 6; k++ )
+            t[k] = v[k];
+        icvInterleave3_8u( t );
+        for( int k = 0; k < 6; k++ )
+            _mm_storeu_si128( (__m128i*)(dst + k*16), t[k] );
+    }
+    else
+    {
+        __m128i a[4], b[4];
+        a[0] = v[0]; a[1] = v[2]; a[2] = v[4]; a[3] = _mm_setzero_si128();
+        b[0] = v[1]; b[1] = v[3]; b[2] = v[5]; b[3] = a[3];
+        icvInterleave4_8u( a );
+        icvInterleave4_8u( b );
+        for( int k = 0; k < 4; k++ )
+        {
+            _mm_storeu_si128( (__m128i*)(dst + k*16), a[k] );
+            _mm_storeu_si128( (__m128i*)(dst + k*16 + 64), b[k] );
+        }
+    }
+}
+
+/* loads 4 pixels of 3 or 4 channels as the planes v[0..2] */
+static inline void
+icvLoadPlanes_32f( const float* src, int cn, __m128* v )
+{
+    if( cn == 3 )
+    {
+        __m128 v0 = _mm_loadu_ps( src ), v1 = _mm_loadu_ps( src + 4 );
+        __m128 v2 = _mm_loadu_ps( src + 8 );
+        __m128 t0 = _mm_shuffle_ps( v1, v2, _MM_SHUFFLE(1,1,2,2) );
+        __m128 t1 = _mm_shuffle_ps( v0, v1, _MM_SHUFFLE(0,0,1,1) );
+        __m128 t2 = _mm_shuffle_ps( v1, v2, _MM_SHUFFLE(2,2,3,3) );
+        __m128 t3 = _mm_shuffle_ps( v0, v1, _MM_SHUFFLE(1,1,2,2) );
+        __m128 t4 = _mm_shuffle_ps( v2, v2, _MM_SHUFFLE(3,3,0,0) );
+        v[0] = _mm_shuffle_ps( v0, t0, _MM_SHUFFLE(2,0,3,0) );
+        v[1] = _mm_shuffle_ps( t1, t2, _MM_SHUFFLE(2,0,2,0) );
+        v[2] = _mm_shuffle_ps( t3, t4, _MM_SHUFFLE(2,0,2,0) );
+    }
+    else
+    {
+        __m128 v0 = _mm_loadu_ps( src ), v1 = _mm_loadu_ps( src + 4 );
+        __m128 v2 = _mm_loadu_ps( src + 8 ), v3 = _mm_loadu_ps( src + 12 );
+        _MM_TRANSPOSE4_PS( v0, v1, v2, v3 );
+        v[0] = v0; v[1] = v1; v[2] = v2;
+    }
+}
+
+/* stores the planes v[0..2] as 4 pixels of 3 or 4 channels, the 4th channel is 0 */
+static inline void
+icvStorePlanes_32f( float* dst, int cn, const __m128* v )
+{
+    if( cn == 3 )
+    {
+        __m128 bg0 = _mm_unpacklo_ps( v[0], v[1] ), bg1 = _mm_unpackhi_ps( v[0], v[1] );
+        __m128 t0 = _mm_shuffle_ps( v[2], v[0], _MM_SHUFFLE(1,1,0,0) );
+        __m128 t1 = _mm_shuffle_ps( v[1], v[2], _MM_SHUFFLE(1,1,1,1) );
+        __m128 t2 = _mm_shuffle_ps( v[2], bg1, _MM_SHUFFLE(3,2,2,2) );
+        __m128 t3 = _mm_shuffle_ps( bg1, v[2], _MM_SHUFFLE(3,3,3,3) );
+        _mm_storeu_ps( dst, _mm_shuffle_ps( bg0, t0, _MM_SHUFFLE(2,0,1,0) ));
+        _mm_storeu_ps( dst + 4, _mm_shuffle_ps( t1, bg1, _MM_SHUFFLE(1,0,2,0) ));
+        _mm_storeu_ps( dst + 8, _mm_shuffle_ps( t2, t3, _MM_SHUFFLE(2,0,2,0) ));
+    }
+    else
+    {
+        __m128 v0 = v[0], v1 = v[1], v2 = v[2], v3 = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS( v0, v1, v2, v3 );
+        _mm_storeu_ps( dst, v0 );
+        _mm_storeu_ps( dst + 4, v1 );
+        _mm_storeu_ps( dst + 8, v2 );
+        _mm_storeu_ps( dst + 12, v3 );
+    }
+}
+
+/* low 32 bits of the products of 32-bit integers (there is no pmulld in SSE2) */
+static inline __m128i
+icvMulLo_32s( __m128i a, __m128i b )
+{
+    __m128i even = _mm_mul_epu32( a, b );
+    __m128i odd = _mm_mul_epu32( _mm_srli_epi64( a, 32 ), _mm_srli_epi64( b, 32 ));
+    return _mm_unpacklo_epi32( _mm_shuffle_epi32( even, _MM_SHUFFLE(0,0,2,0) ),
+                               _mm_shuffle_epi32( odd, _MM_SHUFFLE(0,0,2,0) ));
+}
+
+/* mask ? a : b */
+static inline __m128
+icvSelect_32f( __m128 mask, __m128 a, __m128 b )
+{
+    return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ));
+}
+
+static inline __m128i
+icvSelect_32s( __m128i mask, __m128i a, __m128i b )
+{
+    return _mm_or_si128( _mm_and_si128( mask, a ), _mm_andnot_si128( mask, b ));
+}
+
+#endif
+
 /****************************************************************************************\
 *                 Various 3/4-channel to 3/4-channel RGB transformations                 *
 \****************************************************************************************/
@@ -481,6 +685,51 @@ CV_IMPL_ABC2BGRx_IPP( 32f, float )
 #define cscGg  fix(cscGg_32f,csc_shift)
 #define cscGb  /*fix(cscGb_32f,csc_shift)*/ ((1 << csc_shift) - cscGr - cscGg)
 
+#if CV_SSE2
+
+static inline int
+icvGray2BGRx_8u_SSE2( const uchar* src, uchar* dst, int width, int dst_cn )
+{
+    int i = 0;
+    for( ; i <= width - 32; i += 32, dst += dst_cn*32 )
+    {
+        __m128i v[6];
+        v[0] = v[2] = v[4] = _mm_loadu_si128( (const __m128i*)(src + i) );
+        v[1] = v[3] = v[5] = _mm_loadu_si128( (const __m128i*)(src + i + 16) );
+        icvStorePlanes_8u( dst, dst_cn, v );
+    }
+    return i;
+}
+
+static inline int
+icvGray2BGRx_32f_SSE2( const float* src, float* dst, int width, int dst_cn )
+{
+    int i = 0;
+    for( ; i <= width - 4; i += 4, dst += dst_cn*4 )
+    {
+        __m128 v[3];
+        v[0] = v[1] = v[2] = _mm_loadu_ps( src + i );
+        icvStorePlanes_32f( dst, dst_cn, v );
+    }
+    return i;
+}
+
+#else
+
+static inline int
+icvGray2BGRx_8u_SSE2( const uchar*, uchar*, int, int )
+{ return 0; }
+
+static inline int
+icvGray2BGRx_32f_SSE2( const float*, float*, int, int )
+{ return 0; }
+
+#endif
+
+static inline int
+icvGray2BGRx_16u_SSE2( const ushort*, ushort*, int, int )
+{ return 0; }
+
 #define CV_IMPL_GRAY2BGRX( flavor, arrtype )                    \
 static CvStatus CV_STDCALL                                      \
 icvGray2BGRx_##flavor##_C1CnR( const arrtype* src, int srcstep, \
@@ -494,11 +743,14 @@ icvGray2BGRx_##flavor##_C1CnR( const arrtype* src, int srcstep, \
                                                                 \
     for( ; size.height--; src += srcstep, dst += dststep )      \
     {                                                           \
+        i = icvGray2BGRx_##flavor##_SSE2( src, dst,             \
+                                          size.width, dst_cn ); \
+        dst += i*dst_cn;                                        \
         if( dst_cn == 3 )                                       \
-            for( i = 0; i < size.width; i++, dst += 3 )         \
+            for( ; i < size.width; i++, dst += 3 )              \
                 dst[0] = dst[1] = dst[2] = src[i];              \
         else                                                    \
-            for( i = 0; i < size.width; i++, dst += 4 )         \
+            for( ; i < size.width; i++, dst += 4 )              \
             {                                                   \
                 dst[0] = dst[1] = dst[2] = src[i];              \
                 dst[3] = 0;                                     \
@@ -574,6 +826,93 @@ icvGray2BGR5x5_8u_C1C2R( const uchar* src, int srcstep,
 }
 
 
+#if CV_SSE2
+
+/* (a*ca + b*cb + rounding) >> 14 for 8 16-bit lanes, cab holds the pairs (ca, cb) */
+static inline __m128i
+icvMulAdd2_16s( __m128i a, __m128i b, __m128i cab )
+{
+    const __m128i delta = _mm_set1_epi32( 1 << 13 );
+    __m128i y0 = _mm_add_epi32( _mm_madd_epi16( _mm_unpacklo_epi16( a, b ), cab ), delta );
+    __m128i y1 = _mm_add_epi32( _mm_madd_epi16( _mm_unpackhi_epi16( a, b ), cab ), delta );
+    return _mm_packs_epi32( _mm_srai_epi32( y0, 14 ), _mm_srai_epi32( y1, 14 ));
+}
+
+/* (a*ca + b*cb + c*cc + rounding) >> 14, cc1 holds the pairs (cc, rounding) */
+static inline __m128i
+icvMulAdd3_16s( __m128i a, __m128i b, __m128i c, __m128i cab, __m128i cc1 )
+{
+    const __m128i one = _mm_set1_epi16( 1 );
+    __m128i y0 = _mm_add_epi32( _mm_madd_epi16( _mm_unpacklo_epi16( a, b ), cab ),
+                                _mm_madd_epi16( _mm_unpacklo_epi16( c, one ), cc1 ));
+    __m128i y1 = _mm_add_epi32( _mm_madd_epi16( _mm_unpackhi_epi16( a, b ), cab ),
+                                _mm_madd_epi16( _mm_unpackhi_epi16( c, one ), cc1 ));
+    return _mm_packs_epi32( _mm_srai_epi32( y0, 14 ), _mm_srai_epi32( y1, 14 ));
+}
+
+static inline __m128i
+icvSetPairs_16s( int a, int b )
+{
+    return _mm_set1_epi32( (int)((a & 0xffff) | ((unsigned)b << 16)) );
+}
+
+static inline int
+icvBGRx2Gray_8u_SSE2( const uchar* src, uchar* dst, int width, int src_cn, int blue_idx )
+{
+    int cb = blue_idx ? cscGr : cscGb, cr = blue_idx ? cscGb : cscGr;
+    const __m128i z = _mm_setzero_si128();
+    const __m128i cbg = icvSetPairs_16s( cb, cscGg );
+    const __m128i cr1 = icvSetPairs_16s( cr, 1 << (csc_shift-1) );
+    int i = 0;
+
+    for( ; i <= width - 32; i += 32, src += src_cn*32 )
+    {
+        __m128i v[6];
+        icvLoadPlanes_8u( src, src_cn, v );
+        for( int k = 0; k < 2; k++ )
+        {
+            __m128i b = v[k], g = v[k+2], r = v[k+4];
+            __m128i y0 = icvMulAdd3_16s( _mm_unpacklo_epi8( b, z ), _mm_unpacklo_epi8( g, z ),
+                                         _mm_unpacklo_epi8( r, z ), cbg, cr1 );
+            __m128i y1 = icvMulAdd3_16s( _mm_unpackhi_epi8( b, z ), _mm_unpackhi_epi8( g, z ),
+                                         _mm_unpackhi_epi8( r, z ), cbg, cr1 );
+            _mm_storeu_si128( (__m128i*)(dst + i + k*16), _mm_packus_epi16( y0, y1 ));
+        }
+    }
+    return i;
+}
+
+static inline int
+icvBGRx2Gray_32f_SSE2( const float* src, float* dst, int width,
+                       int src_cn, float cb, float cr )
+{
+    const __m128 vcb = _mm_set1_ps( cb ), vcg = _mm_set1_ps( cscGg_32f );
+    const __m128 vcr = _mm_set1_ps( cr );
+    int i = 0;
+
+    for( ; i <= width - 4; i += 4, src += src_cn*4 )
+    {
+        __m128 v[3];
+        icvLoadPlanes_32f( src, src_cn, v );
+        _mm_storeu_ps( dst + i, _mm_add_ps( _mm_add_ps( _mm_mul_ps( v[0], vcb ),
+                       _mm_mul_ps( v[1], vcg )), _mm_mul_ps( v[2], vcr )));
+    }
+    return i;
+}
+
+#else
+
+static inline int
+icvBGRx2Gray_8u_SSE2( const uchar*, uchar*, int, int, int )
+{ return 0; }
+
+static inline int
+icvBGRx2Gray_32f_SSE2( const float*, float*, int, int, float, float )
+{ return 0; }
+
+#endif
+
+
 static CvStatus CV_STDCALL
 icvBGRx2Gray_8u_CnC1R( const uchar* src, int srcstep,
                        uchar* dst, int dststep, CvSize size,
@@ -601,7 +940,8 @@ icvBGRx2Gray_8u_CnC1R( const uchar* src, int srcstep,
 
         for( ; size.height--; src += srcstep, dst += dststep )
         {
-            for( i = 0; i < size.width; i++, src += src_cn )
+            i = icvBGRx2Gray_8u_SSE2( src, dst, size.width, src_cn, blue_idx );
+            for( src += i*src_cn; i < size.width; i++, src += src_cn )
             {
                 int t0 = tab[src[0]] + tab[src[1] + 256] + tab[src[2] + 512];
                 dst[i] = (uchar)(t0 >> csc_shift);
@@ -612,7 +952,8 @@ icvBGRx2Gray_8u_CnC1R( const uchar* src, int srcstep,
     {
         for( ; size.height--; src += srcstep, dst += dststep )
         {
-            for( i = 0; i < size.width; i++, src += src_cn )
+            i = icvBGRx2Gray_8u_SSE2( src, dst, size.width, src_cn, blue_idx );
+            for( src += i*src_cn; i < size.width; i++, src += src_cn )
             {
                 int t0 = src[blue_idx]*cscGb + src[1]*cscGg + src[blue_idx^2]*cscGr;
                 dst[i] = (uchar)CV_DESCALE(t0, csc_shift);
@@ -660,8 +1001,11 @@ icvBGRx2Gray_32f_CnC1R( const float* src, int srcstep,
     dststep /= sizeof(dst[0]);
     srcstep -= size.width*src_cn;
     for( ; size.height--; src += srcstep, dst += dststep )
-        for( i = 0; i < size.width; i++, src += src_cn )
+    {
+        i = icvBGRx2Gray_32f_SSE2( src, dst, size.width, src_cn, cb, cr );
+        for( src += i*src_cn; i < size.width; i++, src += src_cn )
             dst[i] = src[0]*cb + src[1]*cscGg_32f + src[2]*cr;
+    }
 
     return CV_OK;
 }
@@ -698,6 +1042,152 @@ icvBGRx2Gray_32f_CnC1R( const float* src, int srcstep,
 #define  yuvGCb   (-fix(-yuvGCb_32f,yuv_shift))
 #define  yuvBCb   fix(yuvBCb_32f,yuv_shift)
 
+#if CV_SSE2
+
+static inline int
+icvBGRx2YCrCb_8u_SSE2( const uchar* src, uchar* dst, int width, int src_cn, int blue_idx )
+{
+    const __m128i z = _mm_setzero_si128(), bias = _mm_set1_epi16( 128 );
+    const __m128i cbg = icvSetPairs_16s( yuvYb, yuvYg );
+    const __m128i cr1 = icvSetPairs_16s( yuvYr, 1 << (yuv_shift-1) );
+    const __m128i ccr = icvSetPairs_16s( yuvCr, 0 ), ccb = icvSetPairs_16s( yuvCb, 0 );
+    int i = 0;
+
+    for( ; i <= width - 32; i += 32, src += src_cn*32, dst += 96 )
+    {
+        __m128i v[6], d[6];
+        icvLoadPlanes_8u( src, src_cn, v );
+        for( int k = 0; k < 2; k++ )
+        {
+            __m128i b = v[k + blue_idx*2], g = v[k + 2], r = v[k + (blue_idx^2)*2];
+            __m128i y[2], cr[2], cb[2];
+            for( int h = 0; h < 2; h++ )
+            {
+                __m128i b16 = h ? _mm_unpackhi_epi8( b, z ) : _mm_unpacklo_epi8( b, z );
+                __m128i g16 = h ? _mm_unpackhi_epi8( g, z ) : _mm_unpacklo_epi8( g, z );
+                __m128i r16 = h ? _mm_unpackhi_epi8( r, z ) : _mm_unpacklo_epi8( r, z );
+                y[h] = icvMulAdd3_16s( b16, g16, r16, cbg, cr1 );
+                cr[h] = _mm_add_epi16( icvMulAdd2_16s( _mm_sub_epi16( r16, y[h] ), z, ccr ), bias );
+                cb[h] = _mm_add_epi16( icvMulAdd2_16s( _mm_sub_epi16( b16, y[h] ), z, ccb ), bias );
+            }
+            d[k] = _mm_packus_epi16( y[0], y[1] );
+            d[k + 2] = _mm_packus_epi16( cr[0], cr[1] );
+            d[k + 4] = _mm_packus_epi16( cb[0], cb[1] );
+        }
+        icvStorePlanes_8u( dst, 3, d );
+    }
+    return i;
+}
+
+static inline int
+icvBGRx2YCrCb_32f_SSE2( const float* src, float* dst, int width, int src_cn, int blue_idx )
+{
+    const __m128 cyb = _mm_set1_ps( yuvYb_32f ), cyg = _mm_set1_ps( yuvYg_32f );
+    const __m128 cyr = _mm_set1_ps( yuvYr_32f ), ccr = _mm_set1_ps( yuvCr_32f );
+    const __m128 ccb = _mm_set1_ps( yuvCb_32f ), bias = _mm_set1_ps( 0.5f );
+    int i = 0;
+
+    for( ; i <= width - 4; i += 4, src += src_cn*4, dst += 12 )
+    {
+        __m128 v[3], d[3];
+        icvLoadPlanes_32f( src, src_cn, v );
+        __m128 b = v[blue_idx], r = v[blue_idx^2];
+        __m128 y = _mm_add_ps( _mm_add_ps( _mm_mul_ps( b, cyb ), _mm_mul_ps( v[1], cyg )),
+                               _mm_mul_ps( r, cyr ));
+        d[0] = y;
+        d[1] = _mm_add_ps( _mm_mul_ps( _mm_sub_ps( r, y ), ccr ), bias );
+        d[2] = _mm_add_ps( _mm_mul_ps( _mm_sub_ps( b, y ), ccb ), bias );
+        icvStorePlanes_32f( dst, 3, d );
+    }
+    return i;
+}
+
+static inline int
+icvYCrCb2BGRx_8u_SSE2( const uchar* src, uchar* dst, int width, int dst_cn, int blue_idx )
+{
+    const __m128i z = _mm_setzero_si128(), bias = _mm_set1_epi16( 128 );
+    const __m128i cb = icvSetPairs_16s( 1 << yuv_shift, yuvBCb );
+    const __m128i cr = icvSetPairs_16s( 1 << yuv_shift, yuvRCr );
+    const __m128i cg = icvSetPairs_16s( yuvGCr, yuvGCb );
+    const __m128i cy1 = icvSetPairs_16s( 1 << yuv_shift, 1 << (yuv_shift-1) );
+    int i = 0;
+
+    for( ; i <= width - 32; i += 32, src += 96, dst += dst_cn*32 )
+    {
+        __m128i v[6], d[6];
+        icvLoadPlanes_8u( src, 3, v );
+        for( int k = 0; k < 2; k++ )
+        {
+            __m128i b[2], g[2], r[2];
+            for( int h = 0; h < 2; h++ )
+            {
+                __m128i Y = h ? _mm_unpackhi_epi8( v[k], z ) : _mm_unpacklo_epi8( v[k], z );
+                __m128i Cr = _mm_sub_epi16( h ? _mm_unpackhi_epi8( v[k+2], z ) :
+                                                _mm_unpacklo_epi8( v[k+2], z ), bias );
+                __m128i Cb = _mm_sub_epi16( h ? _mm_unpackhi_epi8( v[k+4], z ) :
+                                                _mm_unpacklo_epi8( v[k+4], z ), bias );
+                b[h] = icvMulAdd2_16s( Y, Cb, cb );
+                g[h] = icvMulAdd3_16s( Cr, Cb, Y, cg, cy1 );
+                r[h] = icvMulAdd2_16s( Y, Cr, cr );
+            }
+            d[k + blue_idx*2] = _mm_packus_epi16( b[0], b[1] );
+            d[k + 2] = _mm_packus_epi16( g[0], g[1] );
+            d[k + (blue_idx^2)*2] = _mm_packus_epi16( r[0], r[1] );
+        }
+        icvStorePlanes_8u( dst, dst_cn, d );
+    }
+    return i;
+}
+
+static inline int
+icvYCrCb2BGRx_32f_SSE2( const float* src, float* dst, int width, int dst_cn, int blue_idx )
+{
+    const __m128 cbcb = _mm_set1_ps( yuvBCb_32f ), cgcr = _mm_set1_ps( yuvGCr_32f );
+    const __m128 cgcb = _mm_set1_ps( yuvGCb_32f ), crcr = _mm_set1_ps( yuvRCr_32f );
+    const __m128 bias = _mm_set1_ps( 0.5f );
+    int i = 0;
+
+    for( ; i <= width - 4; i += 4, src += 12, dst += dst_cn*4 )
+    {
+        __m128 v[3], d[3];
+        icvLoadPlanes_32f( src, 3, v );
+        __m128 Y = v[0], Cr = _mm_sub_ps( v[1], bias ), Cb = _mm_sub_ps( v[2], bias );
+        d[blue_idx] = _mm_add_ps( Y, _mm_mul_ps( cbcb, Cb ));
+        d[1] = _mm_add_ps( _mm_add_ps( Y, _mm_mul_ps( cgcr, Cr )), _mm_mul_ps( cgcb, Cb ));
+        d[blue_idx^2] = _mm_add_ps( Y, _mm_mul_ps( crcr, Cr ));
+        icvStorePlanes_32f( dst, dst_cn, d );
+    }
+    return i;
+}
+
+#else
+
+static inline int
+icvBGRx2YCrCb_8u_SSE2( const uchar*, uchar*, int, int, int )
+{ return 0; }
+
+static inline int
+icvBGRx2YCrCb_32f_SSE2( const float*, float*, int, int, int )
+{ return 0; }
+
+static inline int
+icvYCrCb2BGRx_8u_SSE2( const uchar*, uchar*, int, int, int )
+{ return 0; }
+
+static inline int
+icvYCrCb2BGRx_32f_SSE2( const float*, float*, int, int, int )
+{ return 0; }
+
+#endif
+
+static inline int
+icvBGRx2YCrCb_16u_SSE2( const ushort*, ushort*, int, int, int )
+{ return 0; }
+
+static inline int
+icvYCrCb2BGRx_16u_SSE2( const ushort*, ushort*, int, int, int )
+{ return 0; }
+
 #define CV_IMPL_BGRx2YCrCb( flavor, arrtype, worktype, scale_macro, cast_macro,     \
                             YUV_YB, YUV_YG, YUV_YR, YUV_CR, YUV_CB, YUV_Cx_BIAS )   \
 static CvStatus CV_STDCALL                                                  \
@@ -712,7 +1202,10 @@ icvBGRx2YCrCb_##flavor##_CnC3R( const arrtype* src, int srcstep,            \
                                                                             \
     for( ; size.height--; src += srcstep, dst += dststep )                  \
     {                                                                       \
-        for( i = 0; i < size.width; i += 3, src += src_cn )                 \
+        i = icvBGRx2YCrCb_##flavor##_SSE2( src, dst, size.width/3,          \
+                                           src_cn, blue_idx );              \
+        src += i*src_cn;                                                    \
+        for( i *= 3; i < size.width; i += 3, src += src_cn )                \
         {                                                                   \
             worktype b = src[blue_idx], r = src[2^blue_idx], y;             \
             y = scale_macro(b*YUV_YB + src[1]*YUV_YG + r*YUV_YR);           \
@@ -753,7 +1246,10 @@ icvYCrCb2BGRx_##flavor##_C3CnR( const arrtype* src, int srcstep,            \
                                                                             \
     for( ; size.height--; src += srcstep, dst += dststep )                  \
     {                                                                       \
-        for( i = 0; i < size.width; i += 3, dst += dst_cn )                 \
+        i = icvYCrCb2BGRx_##flavor##_SSE2( src, dst, size.width/3,          \
+                                           dst_cn, blue_idx );              \
+        dst += i*dst_cn;                                                    \
+        for( i *= 3; i < size.width; i += 3, dst += dst_cn )                \
         {                                                                   \
             worktype Y = prescale_macro(src[i]),                            \
                      Cr = src[i+1] - YUV_Cx_BIAS,                           \
@@ -962,6 +1458,113 @@ CV_IMPL_XYZ2BGRx( 32f, float, float, CV_NOP, CV_NOP, _32f )
 *                          Non-linear Color Space Transformations                        *
 \****************************************************************************************/
 
+#if CV_SSE2
+
+/* dst[k] = src[k]*coeffs[c*2] + coeffs[c*2+1], c = k % 3, for 16 3-channel pixels at once */
+static inline int
+icvCvt8uTo32f_C3_SSE2( const uchar* src, float* dst, int len, const float* coeffs )
+{
+    const __m128i z = _mm_setzero_si128();
+    __m128 a[3], b[3];
+    int j, k = 0;
+
+    for( j = 0; j < 12; j++ )
+    {
+        int c = j % 3;
+        ((float*)a)[j] = coeffs[c*2];
+        ((float*)b)[j] = coeffs[c*2+1];
+    }
+
+    for( ; k <= len - 48; k += 48 )
+        for( j = 0; j < 3; j++ )
+        {
+            __m128i v = _mm_loadu_si128( (const __m128i*)(src + k + j*16) );
+            __m128i v0 = _mm_unpacklo_epi8( v, z ), v1 = _mm_unpackhi_epi8( v, z );
+            __m128 f0 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( v0, z ));
+            __m128 f1 = _mm_cvtepi32_ps( _mm_unpackhi_epi16( v0, z ));
+            __m128 f2 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( v1, z ));
+            __m128 f3 = _mm_cvtepi32_ps( _mm_unpackhi_epi16( v1, z ));
+            float* d = dst + k + j*16;
+            _mm_storeu_ps( d, _mm_add_ps( _mm_mul_ps( f0, a[(j*4) % 3] ), b[(j*4) % 3] ));
+            _mm_storeu_ps( d + 4, _mm_add_ps( _mm_mul_ps( f1, a[(j*4+1) % 3] ), b[(j*4+1) % 3] ));
+            _mm_storeu_ps( d + 8, _mm_add_ps( _mm_mul_ps( f2, a[(j*4+2) % 3] ), b[(j*4+2) % 3] ));
+            _mm_storeu_ps( d + 12, _mm_add_ps( _mm_mul_ps( f3, a[(j*4+3) % 3] ), b[(j*4+3) % 3] ));
+        }
+    return k;
+}
+
+static inline void
+icvStore48_32s8u( uchar* dst, const __m128i* t )
+{
+    for( int j = 0; j < 3; j++ )
+        _mm_storeu_si128( (__m128i*)(dst + j*16), _mm_packus_epi16(
+            _mm_packs_epi32( t[j*4], t[j*4+1] ), _mm_packs_epi32( t[j*4+2], t[j*4+3] )));
+}
+
+/* dst[k] = CV_CAST_8U(cvRound(src[k]*coeffs[c*2] + coeffs[c*2+1])), c = k % 3 */
+static inline int
+icvCvt32fTo8u_C3_SSE2( const float* src, uchar* dst, int len, const float* coeffs )
+{
+    __m128 a[3], b[3];
+    int j, k = 0;
+
+    for( j = 0; j < 12; j++ )
+    {
+        int c = j % 3;
+        ((float*)a)[j] = coeffs[c*2];
+        ((float*)b)[j] = coeffs[c*2+1];
+    }
+
+    for( ; k <= len - 48; k += 48 )
+    {
+        __m128i t[12];
+        for( j = 0; j < 12; j++ )
+            t[j] = _mm_cvtps_epi32( _mm_add_ps( _mm_mul_ps(
+                        _mm_loadu_ps( src + k + j*4 ), a[j % 3] ), b[j % 3] ));
+        icvStore48_32s8u( dst + k, t );
+    }
+    return k;
+}
+
+/* dst[k] = CV_CAST_8U(cvRound(src[k]*255.)) */
+static inline int
+icvCvt32fTo8uScale_C3_SSE2( const float* src, uchar* dst, int len )
+{
+    const __m128d scale = _mm_set1_pd( 255. );
+    int j, k = 0;
+
+    for( ; k <= len - 48; k += 48 )
+    {
+        __m128i t[12];
+        for( j = 0; j < 12; j++ )
+        {
+            __m128 f = _mm_loadu_ps( src + k + j*4 );
+            __m128i t0 = _mm_cvtpd_epi32( _mm_mul_pd( _mm_cvtps_pd( f ), scale ));
+            __m128i t1 = _mm_cvtpd_epi32( _mm_mul_pd( _mm_cvtps_pd(
+                                          _mm_movehl_ps( f, f )), scale ));
+            t[j] = _mm_unpacklo_epi64( t0, t1 );
+        }
+        icvStore48_32s8u( dst + k, t );
+    }
+    return k;
+}
+
+#else
+
+static inline int
+icvCvt8uTo32f_C3_SSE2( const uchar*, float*, int, const float* )
+{ return 0; }
+
+static inline int
+icvCvt32fTo8u_C3_SSE2( const float*, uchar*, int, const float* )
+{ return 0; }
+
+static inline int
+icvCvt32fTo8uScale_C3_SSE2( const float*, uchar*, int )
+{ return 0; }
+
+#endif
+
 // driver color space conversion function for 8u arrays that uses 32f function
 // with appropriate pre- and post-scaling.
 static CvStatus CV_STDCALL
@@ -969,6 +1572,7 @@ icvABC2BGRx_8u_C3CnR( const uchar* src, int srcstep, uchar* dst, int dststep,
                       CvSize size, int dst_cn, int blue_idx, CvColorCvtFunc2 cvtfunc_32f,
                      const float* pre_coeffs, int postscale )
 {
+    static const float unit_coeffs[] = { 1.f, 0.f, 1.f, 0.f, 1.f, 0.f };
     int block_size = MIN(1 << 8, size.width);
     float* buffer = (float*)cvStackAlloc( block_size*3*sizeof(buffer[0]) );
     int i, di, k;
@@ -983,7 +1587,8 @@ icvABC2BGRx_8u_C3CnR( const uchar* src, int srcstep, uchar* dst, int dststep,
             const uchar* src1 = src + i*3;
             di = MIN(block_size, size.width - i);
             
-            for( k = 0; k < di*3; k += 3 )
+            k = icvCvt8uTo32f_C3_SSE2( src1, buffer, di*3, pre_coeffs );
+            for( ; k < di*3; k += 3 )
             {
                 float a = CV_8TO32F(src1[k])*pre_coeffs[0] + pre_coeffs[1];
                 float b = CV_8TO32F(src1[k+1])*pre_coeffs[2] + pre_coeffs[3];
@@ -999,7 +1604,8 @@ icvABC2BGRx_8u_C3CnR( const uchar* src, int srcstep, uchar* dst, int dststep,
             
             if( postscale )
             {
-                for( k = 0; k < di*3; k += 3, dst += dst_cn )
+                k = dst_cn == 3 ? icvCvt32fTo8uScale_C3_SSE2( buffer, dst, di*3 ) : 0;
+                for( dst += k; k < di*3; k += 3, dst += dst_cn )
                 {
                     int b = cvRound(buffer[k]*255.);
                     int g = cvRound(buffer[k+1]*255.);
@@ -1014,7 +1620,8 @@ icvABC2BGRx_8u_C3CnR( const uchar* src, int srcstep, uchar* dst, int dststep,
             }
             else
             {
-                for( k = 0; k < di*3; k += 3, dst += dst_cn )
+                k = dst_cn == 3 ? icvCvt32fTo8u_C3_SSE2( buffer, dst, di*3, unit_coeffs ) : 0;
+                for( dst += k; k < di*3; k += 3, dst += dst_cn )
                 {
                     int b = cvRound(buffer[k]);
                     int g = cvRound(buffer[k+1]);
@@ -1041,6 +1648,9 @@ icvBGRx2ABC_8u_CnC3R( const uchar* src, int srcstep, uchar* dst, int dststep,
                       CvSize size, int src_cn, int blue_idx, CvColorCvtFunc2 cvtfunc_32f,
                       int prescale, const float* post_coeffs )
 {
+    static const float unit_coeffs[] = { 1.f, 0.f, 1.f, 0.f, 1.f, 0.f };
+    static const float prescale_coeffs[] = { 0.0039215686274509803f, 0.f,
+        0.0039215686274509803f, 0.f, 0.0039215686274509803f, 0.f };
     int block_size = MIN(1 << 8, size.width);
     float* buffer = (float*)cvStackAlloc( block_size*3*sizeof(buffer[0]) );
     int i, di, k;
@@ -1057,7 +1667,8 @@ icvBGRx2ABC_8u_CnC3R( const uchar* src, int srcstep, uchar* dst, int dststep,
 
             if( prescale )
             {
-                for( k = 0; k < di*3; k += 3, src += src_cn )
+                k = src_cn == 3 ? icvCvt8uTo32f_C3_SSE2( src, buffer, di*3, prescale_coeffs ) : 0;
+                for( src += k; k < di*3; k += 3, src += src_cn )
                 {
                     float b = CV_8TO32F(src[0])*0.0039215686274509803f;
                     float g = CV_8TO32F(src[1])*0.0039215686274509803f;
@@ -1070,7 +1681,8 @@ icvBGRx2ABC_8u_CnC3R( const uchar* src, int srcstep, uchar* dst, int dststep,
             }
             else
             {
-                for( k = 0; k < di*3; k += 3, src += src_cn )
+                k = src_cn == 3 ? icvCvt8uTo32f_C3_SSE2( src, buffer, di*3, unit_coeffs ) : 0;
+                for( src += k; k < di*3; k += 3, src += src_cn )
                 {
                     float b = CV_8TO32F(src[0]);
                     float g = CV_8TO32F(src[1]);
@@ -1086,7 +1698,8 @@ icvBGRx2ABC_8u_CnC3R( const uchar* src, int srcstep, uchar* dst, int dststep,
             if( status < 0 )
                 return status;
 
-            for( k = 0; k < di*3; k += 3 )
+            k = icvCvt32fTo8u_C3_SSE2( buffer, dst1, di*3, post_coeffs );
+            for( ; k < di*3; k += 3 )
             {
                 int a = cvRound( buffer[k]*post_coeffs[0] + post_coeffs[1] );
                 int b = cvRound( buffer[k+1]*post_coeffs[2] + post_coeffs[3] );
@@ -1148,6 +1761,196 @@ static const uchar icvHue180To255[] =
 };
 
 
+#if CV_SSE2
+
+/* the reciprocals come from div_table (see icvBGRx2HSV_8u_CnC3R) one lane at a time */
+static inline int
+icvBGRx2HSV_8u_SSE2( const uchar* src, uchar* dst, int width,
+                     int src_cn, int blue_idx, const int* div_table )
+{
+    const __m128i z = _mm_setzero_si128(), lo = _mm_set1_epi16( 0xff );
+    const __m128i hdelta = _mm_set1_epi32( 1 << 18 ), h180 = _mm_set1_epi32( 180 );
+    __m128i abuf[4];
+    int* buf = (int*)abuf;
+    int i = 0;
+
+    for( ; i <= width - 32; i += 32, src += src_cn*32, dst += 96 )
+    {
+        __m128i v[6], d[6];
+        icvLoadPlanes_8u( src, src_cn, v );
+        for( int k = 0; k < 2; k++ )
+        {
+            __m128i b8 = v[k + blue_idx*2], g8 = v[k + 2], r8 = v[k + (blue_idx^2)*2];
+            __m128i hh[2], ss[2], vv[2];
+            for( int q = 0; q < 2; q++ )
+            {
+                __m128i b = q ? _mm_unpackhi_epi8( b8, z ) : _mm_unpacklo_epi8( b8, z );
+                __m128i g = q ? _mm_unpackhi_epi8( g8, z ) : _mm_unpacklo_epi8( g8, z );
+                __m128i r = q ? _mm_unpackhi_epi8( r8, z ) : _mm_unpacklo_epi8( r8, z );
+                __m128i vmax = _mm_max_epi16( _mm_max_epi16( b, g ), r );
+                __m128i vmin = _mm_min_epi16( _mm_min_epi16( b, g ), r );
+                __m128i diff = _mm_sub_epi16( vmax, vmin );
+                __m128i vr = _mm_cmpeq_epi16( vmax, r ), vg = _mm_cmpeq_epi16( vmax, g );
+                __m128i h, h0, h1, s0, s1;
+                __m128i h1x = _mm_add_epi16( _mm_sub_epi16( b, r ), _mm_add_epi16( diff, diff ));
+                __m128i h2x = _mm_add_epi16( _mm_sub_epi16( r, g ), _mm_slli_epi16( diff, 2 ));
+
+                h = _mm_or_si128( _mm_and_si128( vg, h1x ), _mm_andnot_si128( vg, h2x ));
+                h = _mm_or_si128( _mm_and_si128( vr, _mm_sub_epi16( g, b )),
+                                  _mm_andnot_si128( vr, h ));
+
+                _mm_store_si128( (__m128i*)buf, _mm_unpacklo_epi16( vmax, z ));
+                _mm_store_si128( (__m128i*)(buf + 4), _mm_unpackhi_epi16( vmax, z ));
+                _mm_store_si128( (__m128i*)(buf + 8), _mm_unpacklo_epi16( diff, z ));
+                _mm_store_si128( (__m128i*)(buf + 12), _mm_unpackhi_epi16( diff, z ));
+                for( int j = 0; j < 16; j++ )
+                    buf[j] = div_table[buf[j]];
+
+                s0 = icvMulLo_32s( _mm_unpacklo_epi16( diff, z ),
+                                   _mm_load_si128( (const __m128i*)buf ));
+                s1 = icvMulLo_32s( _mm_unpackhi_epi16( diff, z ),
+                                   _mm_load_si128( (const __m128i*)(buf + 4) ));
+                ss[q] = _mm_packs_epi32( _mm_srai_epi32( s0, 12 ), _mm_srai_epi32( s1, 12 ));
+
+                h0 = _mm_srai_epi32( _mm_unpacklo_epi16( h, h ), 16 );
+                h1 = _mm_srai_epi32( _mm_unpackhi_epi16( h, h ), 16 );
+                s0 = icvMulLo_32s( h0, _mm_load_si128( (const __m128i*)(buf + 8) ));
+                s1 = icvMulLo_32s( h1, _mm_load_si128( (const __m128i*)(buf + 12) ));
+                s0 = _mm_srai_epi32( _mm_add_epi32( _mm_sub_epi32( _mm_slli_epi32( s0, 4 ), s0 ),
+                                                    hdelta ), 19 );
+                s1 = _mm_srai_epi32( _mm_add_epi32( _mm_sub_epi32( _mm_slli_epi32( s1, 4 ), s1 ),
+                                                    hdelta ), 19 );
+                h0 = _mm_add_epi32( s0, _mm_and_si128( _mm_cmplt_epi32( h0, z ), h180 ));
+                h1 = _mm_add_epi32( s1, _mm_and_si128( _mm_cmplt_epi32( h1, z ), h180 ));
+                hh[q] = _mm_and_si128( _mm_packs_epi32( h0, h1 ), lo );
+                vv[q] = vmax;
+            }
+            d[k] = _mm_packus_epi16( hh[0], hh[1] );
+            d[k + 2] = _mm_packus_epi16( ss[0], ss[1] );
+            d[k + 4] = _mm_packus_epi16( vv[0], vv[1] );
+        }
+        icvStorePlanes_8u( dst, 3, d );
+    }
+    return i;
+}
+
+static inline int
+icvBGRx2HSV_32f_SSE2( const float* src, float* dst, int width, int src_cn, int blue_idx )
+{
+    const __m128 eps = _mm_set1_ps( FLT_EPSILON ), c60 = _mm_set1_ps( 60.f );
+    const __m128 c120 = _mm_set1_ps( 120.f ), c240 = _mm_set1_ps( 240.f );
+    const __m128 c360 = _mm_set1_ps( 360.f ), z = _mm_setzero_ps();
+    const __m128 absmask = _mm_castsi128_ps( _mm_set1_epi32( 0x7fffffff ));
+    int i = 0;
+
+    for( ; i <= width - 4; i += 4, src += src_cn*4, dst += 12 )
+    {
+        __m128 v[3], d[3];
+        icvLoadPlanes_32f( src, src_cn, v );
+        __m128 b = v[blue_idx], g = v[1], r = v[blue_idx^2];
+        __m128 vmax = r, vmin = r, diff, s, h, mr, mg;
+
+        vmax = icvSelect_32f( _mm_cmplt_ps( vmax, g ), g, vmax );
+        vmax = icvSelect_32f( _mm_cmplt_ps( vmax, b ), b, vmax );
+        vmin = icvSelect_32f( _mm_cmpgt_ps( vmin, g ), g, vmin );
+        vmin = icvSelect_32f( _mm_cmpgt_ps( vmin, b ), b, vmin );
+
+        diff = _mm_sub_ps( vmax, vmin );
+        s = _mm_div_ps( diff, _mm_add_ps( _mm_and_ps( vmax, absmask ), eps ));
+        diff = _mm_div_ps( c60, _mm_add_ps( diff, eps ));
+
+        mr = _mm_cmpeq_ps( vmax, r );
+        mg = _mm_cmpeq_ps( vmax, g );
+        h = icvSelect_32f( mg, _mm_add_ps( _mm_mul_ps( _mm_sub_ps( b, r ), diff ), c120 ),
+                               _mm_add_ps( _mm_mul_ps( _mm_sub_ps( r, g ), diff ), c240 ));
+        h = icvSelect_32f( mr, _mm_mul_ps( _mm_sub_ps( g, b ), diff ), h );
+        h = icvSelect_32f( _mm_cmplt_ps( h, z ), _mm_add_ps( h, c360 ), h );
+
+        d[0] = h; d[1] = s; d[2] = vmax;
+        icvStorePlanes_32f( dst, 3, d );
+    }
+    return i;
+}
+
+/* the sector is found as in the scalar code: h/60 is brought to [0,6) by adding
+   or subtracting 6 as many times as needed (lanes with s == 0 do not take part) */
+static inline int
+icvHSV2BGRx_32f_SSE2( const float* src, float* dst, int width, int dst_cn, int blue_idx )
+{
+    const __m128 z = _mm_setzero_ps(), one = _mm_set1_ps( 1.f );
+    const __m128 c6 = _mm_set1_ps( 6.f ), scale = _mm_set1_ps( 0.016666666666666666f );
+    int i = 0;
+
+    for( ; i <= width - 4; i += 4, src += 12, dst += dst_cn*4 )
+    {
+        __m128 v[3], d[3];
+        icvLoadPlanes_32f( src, 3, v );
+        __m128 s = v[1], val = v[2], h = _mm_mul_ps( v[0], scale );
+        __m128 gray = _mm_cmpeq_ps( s, z ), m, t1, t2, t3;
+        __m128i sector, m0, m1, m2, m3, m4, m5;
+
+        while( _mm_movemask_ps( m = _mm_andnot_ps( gray, _mm_cmplt_ps( h, z ))))
+            h = icvSelect_32f( m, _mm_add_ps( h, c6 ), h );
+        while( _mm_movemask_ps( m = _mm_andnot_ps( gray, _mm_cmpge_ps( h, c6 ))))
+            h = icvSelect_32f( m, _mm_sub_ps( h, c6 ), h );
+
+        sector = _mm_cvttps_epi32( h );
+        h = _mm_sub_ps( h, _mm_cvtepi32_ps( sector ));
+
+        t1 = _mm_mul_ps( val, _mm_sub_ps( one, s ));
+        t2 = _mm_mul_ps( val, _mm_sub_ps( one, _mm_mul_ps( s, h )));
+        t3 = _mm_mul_ps( val, _mm_sub_ps( one, _mm_mul_ps( s, _mm_sub_ps( one, h ))));
+
+        /* b, g, r = tab[1] tab[3] tab[0], tab[1] tab[0] tab[2], tab[3] tab[0] tab[1],
+                     tab[0] tab[2] tab[1], tab[0] tab[1] tab[3], tab[2] tab[1] tab[0] */
+        m0 = _mm_cmpeq_epi32( sector, _mm_setzero_si128() );
+        m1 = _mm_cmpeq_epi32( sector, _mm_set1_epi32( 1 ));
+        m2 = _mm_cmpeq_epi32( sector, _mm_set1_epi32( 2 ));
+        m3 = _mm_cmpeq_epi32( sector, _mm_set1_epi32( 3 ));
+        m4 = _mm_cmpeq_epi32( sector, _mm_set1_epi32( 4 ));
+        m5 = _mm_cmpeq_epi32( sector, _mm_set1_epi32( 5 ));
+
+        d[blue_idx] = _mm_or_ps(
+            _mm_or_ps( _mm_and_ps( _mm_castsi128_ps( _mm_or_si128( m0, m1 )), t1 ),
+                       _mm_and_ps( _mm_castsi128_ps( m2 ), t3 )),
+            _mm_or_ps( _mm_and_ps( _mm_castsi128_ps( _mm_or_si128( m3, m4 )), val ),
+                       _mm_and_ps( _mm_castsi128_ps( m5 ), t2 )));
+        d[1] = _mm_or_ps(
+            _mm_or_ps( _mm_and_ps( _mm_castsi128_ps( m0 ), t3 ),
+                       _mm_and_ps( _mm_castsi128_ps( _mm_or_si128( m1, m2 )), val )),
+            _mm_or_ps( _mm_and_ps( _mm_castsi128_ps( m3 ), t2 ),
+                       _mm_and_ps( _mm_castsi128_ps( _mm_or_si128( m4, m5 )), t1 )));
+        d[blue_idx^2] = _mm_or_ps(
+            _mm_or_ps( _mm_and_ps( _mm_castsi128_ps( _mm_or_si128( m0, m5 )), val ),
+                       _mm_and_ps( _mm_castsi128_ps( m1 ), t2 )),
+            _mm_or_ps( _mm_and_ps( _mm_castsi128_ps( _mm_or_si128( m2, m3 )), t1 ),
+                       _mm_and_ps( _mm_castsi128_ps( m4 ), t3 )));
+
+        d[0] = icvSelect_32f( gray, val, d[0] );
+        d[1] = icvSelect_32f( gray, val, d[1] );
+        d[2] = icvSelect_32f( gray, val, d[2] );
+        icvStorePlanes_32f( dst, dst_cn, d );
+    }
+    return i;
+}
+
+#else
+
+static inline int
+icvBGRx2HSV_8u_SSE2( const uchar*, uchar*, int, int, int, const int* )
+{ return 0; }
+
+static inline int
+icvBGRx2HSV_32f_SSE2( const float*, float*, int, int, int )
+{ return 0; }
+
+static inline int
+icvHSV2BGRx_32f_SSE2( const float*, float*, int, int, int )
+{ return 0; }
+
+#endif
+
+
 static CvStatus CV_STDCALL
 icvBGRx2HSV_8u_CnC3R( const uchar* src, int srcstep, uchar* dst, int dststep,
                       CvSize size, int src_cn, int blue_idx )
@@ -1218,7 +2021,8 @@ icvBGRx2HSV_8u_CnC3R( const uchar* src, int srcstep, uchar* dst, int dststep,
 
     for( ; size.height--; src += srcstep, dst += dststep )
     {
-        for( i = 0; i < size.width; i += 3, src += src_cn )
+        i = icvBGRx2HSV_8u_SSE2( src, dst, size.width/3, src_cn, blue_idx, div_table );
+        for( src += i*src_cn, i *= 3; i < size.width; i += 3, src += src_cn )
         {
             int b = (src)[blue_idx], g = (src)[1], r = (src)[2^blue_idx];
             int h, s, v = b;
@@ -1263,7 +2067,8 @@ icvBGRx2HSV_32f_CnC3R( const float* src, int srcstep,
 
     for( ; size.height--; src += srcstep, dst += dststep )
     {
-        for( i = 0; i < size.width; i += 3, src += src_cn )
+        i = icvBGRx2HSV_32f_SSE2( src, dst, size.width/3, src_cn, blue_idx );
+        for( src += i*src_cn, i *= 3; i < size.width; i += 3, src += src_cn )
         {
             float b = src[blue_idx], g = src[1], r = src[2^blue_idx];
             float h, s, v;
@@ -1310,7 +2115,8 @@ icvHSV2BGRx_32f_C3CnR( const float* src, int srcstep, float* dst,
 
     for( ; size.height--; src += srcstep, dst += dststep )
     {
-        for( i = 0; i < size.width; i += 3, dst += dst_cn )
+        i = icvHSV2BGRx_32f_SSE2( src, dst, size.width/3, dst_cn, blue_idx );
+        for( dst += i*dst_cn, i *= 3; i < size.width; i += 3, dst += dst_cn )
         {
             float h = src[i], s = src[i+1], v = src[i+2];
             float b, g, r;
@@ -1786,6 +2592,235 @@ static ushort icvLabCubeRootTab[] = {
 };
 
 
+#if CV_SSE2
+
+static inline __m128i
+icvLabCubeRoot_8u( __m128i idx )
+{
+    __m128i abuf;
+    int* buf = (int*)&abuf;
+    _mm_storeu_si128( &abuf, idx );
+    return _mm_setr_epi32( icvLabCubeRootTab[buf[0]], icvLabCubeRootTab[buf[1]],
+                           icvLabCubeRootTab[buf[2]], icvLabCubeRootTab[buf[3]] );
+}
+
+static inline int
+icvBGRx2Lab_8u_SSE2( const uchar* src, uchar* dst, int width, int src_cn, int blue_idx )
+{
+    const __m128i z = _mm_setzero_si128(), bias = _mm_set1_epi32( 128 );
+    const __m128i cx0 = icvSetPairs_16s( labXb, labXg ), cx1 = icvSetPairs_16s( labXr, 0 );
+    const __m128i cy0 = icvSetPairs_16s( labYb, labYg ), cy1 = icvSetPairs_16s( labYr, 0 );
+    const __m128i cz0 = icvSetPairs_16s( labZb, labZg ), cz1 = icvSetPairs_16s( labZr, 0 );
+    const __m128i T = _mm_set1_epi32( labT ), delta = _mm_set1_epi32( 1 << (lab_shift-1) );
+    const __m128i sscale = icvSetPairs_16s( labSmallScale, 0 );
+    const __m128i sshift = _mm_set1_epi32( labSmallShift + (1 << (lab_shift-1)) );
+    const __m128i lscale = _mm_set1_epi32( labLScale );
+    const __m128i lshift = _mm_set1_epi32( (1 << (2*lab_shift-1)) - labLShift );
+    const __m128i lscale2 = icvSetPairs_16s( labLScale2, 0 );
+    const __m128i c500 = icvSetPairs_16s( 500, 0 ), c200 = icvSetPairs_16s( 200, 0 );
+    int i = 0;
+
+    for( ; i <= width - 32; i += 32, src += src_cn*32, dst += 96 )
+    {
+        __m128i v[6], d[6];
+        icvLoadPlanes_8u( src, src_cn, v );
+        for( int k = 0; k < 2; k++ )
+        {
+            __m128i b8 = v[k + blue_idx*2], g8 = v[k + 2], r8 = v[k + (blue_idx^2)*2];
+            __m128i L16[2], a16[2], b16[2];
+            for( int h = 0; h < 2; h++ )
+            {
+                __m128i bb = h ? _mm_unpackhi_epi8( b8, z ) : _mm_unpacklo_epi8( b8, z );
+                __m128i gg = h ? _mm_unpackhi_epi8( g8, z ) : _mm_unpacklo_epi8( g8, z );
+                __m128i rr = h ? _mm_unpackhi_epi8( r8, z ) : _mm_unpacklo_epi8( r8, z );
+                __m128i L[2], a[2], b[2];
+                for( int q = 0; q < 2; q++ )
+                {
+                    __m128i bg = q ? _mm_unpackhi_epi16( bb, gg ) : _mm_unpacklo_epi16( bb, gg );
+                    __m128i r0 = q ? _mm_unpackhi_epi16( rr, z ) : _mm_unpacklo_epi16( rr, z );
+                    __m128i x = _mm_add_epi32( _mm_madd_epi16( bg, cx0 ), _mm_madd_epi16( r0, cx1 ));
+                    __m128i y = _mm_add_epi32( _mm_madd_epi16( bg, cy0 ), _mm_madd_epi16( r0, cy1 ));
+                    __m128i zz = _mm_add_epi32( _mm_madd_epi16( bg, cz0 ), _mm_madd_epi16( r0, cz1 ));
+                    __m128i f, yc;
+
+                    f = _mm_cmpgt_epi32( x, T );
+                    x = _mm_srai_epi32( _mm_add_epi32( x, delta ), lab_shift );
+                    x = icvSelect_32s( f, icvLabCubeRoot_8u( x ), _mm_srai_epi32(
+                        _mm_add_epi32( _mm_madd_epi16( x, sscale ), sshift ), lab_shift ));
+
+                    f = _mm_cmpgt_epi32( zz, T );
+                    zz = _mm_srai_epi32( _mm_add_epi32( zz, delta ), lab_shift );
+                    zz = icvSelect_32s( f, icvLabCubeRoot_8u( zz ), _mm_srai_epi32(
+                        _mm_add_epi32( _mm_madd_epi16( zz, sscale ), sshift ), lab_shift ));
+
+                    f = _mm_cmpgt_epi32( y, T );
+                    y = _mm_srai_epi32( _mm_add_epi32( y, delta ), lab_shift );
+                    yc = icvLabCubeRoot_8u( y );
+                    L[q] = icvSelect_32s( f, _mm_srai_epi32( _mm_add_epi32(
+                        icvMulLo_32s( yc, lscale ), lshift ), 2*lab_shift ), _mm_srai_epi32(
+                        _mm_add_epi32( _mm_madd_epi16( y, lscale2 ), delta ), lab_shift ));
+                    y = icvSelect_32s( f, yc, _mm_srai_epi32(
+                        _mm_add_epi32( _mm_madd_epi16( y, sscale ), sshift ), lab_shift ));
+
+                    a[q] = _mm_add_epi32( _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16(
+                        _mm_sub_epi32( x, y ), c500 ), delta ), lab_shift ), bias );
+                    b[q] = _mm_add_epi32( _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16(
+                        _mm_sub_epi32( y, zz ), c200 ), delta ), lab_shift ), bias );
+                }
+                L16[h] = _mm_packs_epi32( L[0], L[1] );
+                a16[h] = _mm_packs_epi32( a[0], a[1] );
+                b16[h] = _mm_packs_epi32( b[0], b[1] );
+            }
+            d[k] = _mm_packus_epi16( L16[0], L16[1] );
+            d[k + 2] = _mm_packus_epi16( a16[0], a16[1] );
+            d[k + 4] = _mm_packus_epi16( b16[0], b16[1] );
+        }
+        icvStorePlanes_8u( dst, 3, d );
+    }
+    return i;
+}
+
+static inline __m128d
+icvCbrtPoly_SSE2( __m128d fr )
+{
+    __m128d p = _mm_add_pd( _mm_mul_pd( _mm_set1_pd( 45.2548339756803022511987494 ), fr ),
+                            _mm_set1_pd( 192.2798368355061050458134625 ));
+    __m128d q = _mm_add_pd( _mm_mul_pd( _mm_set1_pd( 14.80884093219134573786480845 ), fr ),
+                            _mm_set1_pd( 151.9714051044435648658557668 ));
+    p = _mm_add_pd( _mm_mul_pd( p, fr ), _mm_set1_pd( 119.1654824285581628956914143 ));
+    q = _mm_add_pd( _mm_mul_pd( q, fr ), _mm_set1_pd( 168.5254414101568283957668343 ));
+    p = _mm_add_pd( _mm_mul_pd( p, fr ), _mm_set1_pd( 13.43250139086239872172837314 ));
+    q = _mm_add_pd( _mm_mul_pd( q, fr ), _mm_set1_pd( 33.9905941350215598754191872 ));
+    p = _mm_add_pd( _mm_mul_pd( p, fr ), _mm_set1_pd( 0.1636161226585754240958355063 ));
+    q = _mm_add_pd( _mm_mul_pd( q, fr ), _mm_set1_pd( 1.0 ));
+    return _mm_div_pd( p, q );
+}
+
+/* cvCbrt of 4 values: the same exponent manipulations and the same rational
+   polynomial, evaluated in double precision */
+static inline __m128
+icvCbrt_SSE2( __m128 value )
+{
+    const __m128i c127 = _mm_set1_epi32( 127 ), c3 = _mm_set1_epi32( 3 );
+    const __m128 three = _mm_set1_ps( 3.f );
+    __m128i vi = _mm_castps_si128( value ), ex, shx, q;
+    __m128i ix = _mm_and_si128( vi, _mm_set1_epi32( 0x7fffffff ));
+    __m128i s = _mm_and_si128( vi, _mm_set1_epi32( 0x80000000 ));
+    __m128 fr;
+
+    /* ex is within [-127,128], so ex/3 and (ex - shx)/3 are exact in single precision */
+    ex = _mm_sub_epi32( _mm_srli_epi32( ix, 23 ), c127 );
+    q = _mm_cvttps_epi32( _mm_div_ps( _mm_cvtepi32_ps( ex ), three ));
+    shx = _mm_sub_epi32( ex, _mm_add_epi32( q, _mm_add_epi32( q, q )));
+    shx = _mm_sub_epi32( shx, _mm_and_si128( _mm_cmpgt_epi32( shx,
+                         _mm_set1_epi32( -1 )), c3 ));
+    ex = _mm_cvttps_epi32( _mm_div_ps( _mm_cvtepi32_ps( _mm_sub_epi32( ex, shx )), three ));
+    fr = _mm_castsi128_ps( _mm_or_si128( _mm_and_si128( ix, _mm_set1_epi32( (1 << 23) - 1 )),
+                           _mm_slli_epi32( _mm_add_epi32( shx, c127 ), 23 )));
+
+    fr = _mm_movelh_ps( _mm_cvtpd_ps( icvCbrtPoly_SSE2( _mm_cvtps_pd( fr ))),
+                _mm_cvtpd_ps( icvCbrtPoly_SSE2( _mm_cvtps_pd( _mm_movehl_ps( fr, fr )))));
+
+    vi = _mm_add_epi32( _mm_add_epi32( _mm_castps_si128( fr ), _mm_slli_epi32( ex, 23 )), s );
+    return _mm_castsi128_ps( _mm_andnot_si128( _mm_cmpeq_epi32( _mm_slli_epi32(
+                             _mm_castps_si128( value ), 1 ), _mm_setzero_si128() ), vi ));
+}
+
+static inline int
+icvBGRx2Lab_32f_SSE2( const float* src, float* dst, int width, int src_cn, int blue_idx )
+{
+    const __m128 xb = _mm_set1_ps( labXb_32f ), xg = _mm_set1_ps( labXg_32f ),
+                 xr = _mm_set1_ps( labXr_32f ), yb = _mm_set1_ps( labYb_32f ),
+                 yg = _mm_set1_ps( labYg_32f ), yr = _mm_set1_ps( labYr_32f ),
+                 zb = _mm_set1_ps( labZb_32f ), zg = _mm_set1_ps( labZg_32f ),
+                 zr = _mm_set1_ps( labZr_32f ), T = _mm_set1_ps( labT_32f );
+    const __m128 sscale = _mm_set1_ps( labSmallScale_32f );
+    const __m128 sshift = _mm_set1_ps( labSmallShift_32f );
+    const __m128 lscale = _mm_set1_ps( labLScale_32f ), lshift = _mm_set1_ps( labLShift_32f );
+    const __m128 lscale2 = _mm_set1_ps( labLScale2_32f );
+    const __m128 c500 = _mm_set1_ps( 500.f ), c200 = _mm_set1_ps( 200.f );
+    int i = 0;
+
+    for( ; i <= width - 4; i += 4, src += src_cn*4, dst += 12 )
+    {
+        __m128 v[3], d[3];
+        icvLoadPlanes_32f( src, src_cn, v );
+        __m128 b = v[blue_idx], g = v[1], r = v[blue_idx^2];
+        __m128 x, y, z, yc, f;
+
+        x = _mm_add_ps( _mm_add_ps( _mm_mul_ps( b, xb ), _mm_mul_ps( g, xg )), _mm_mul_ps( r, xr ));
+        y = _mm_add_ps( _mm_add_ps( _mm_mul_ps( b, yb ), _mm_mul_ps( g, yg )), _mm_mul_ps( r, yr ));
+        z = _mm_add_ps( _mm_add_ps( _mm_mul_ps( b, zb ), _mm_mul_ps( g, zg )), _mm_mul_ps( r, zr ));
+
+        x = icvSelect_32f( _mm_cmpgt_ps( x, T ), icvCbrt_SSE2( x ),
+                           _mm_add_ps( _mm_mul_ps( x, sscale ), sshift ));
+        z = icvSelect_32f( _mm_cmpgt_ps( z, T ), icvCbrt_SSE2( z ),
+                           _mm_add_ps( _mm_mul_ps( z, sscale ), sshift ));
+        f = _mm_cmpgt_ps( y, T );
+        yc = icvCbrt_SSE2( y );
+        d[0] = icvSelect_32f( f, _mm_sub_ps( _mm_mul_ps( yc, lscale ), lshift ),
+                              _mm_mul_ps( y, lscale2 ));
+        y = icvSelect_32f( f, yc, _mm_add_ps( _mm_mul_ps( y, sscale ), sshift ));
+
+        d[1] = _mm_mul_ps( c500, _mm_sub_ps( x, y ));
+        d[2] = _mm_mul_ps( c200, _mm_sub_ps( y, z ));
+        icvStorePlanes_32f( dst, 3, d );
+    }
+    return i;
+}
+
+static inline int
+icvLab2BGRx_32f_SSE2( const float* src, float* dst, int width, int dst_cn, int blue_idx )
+{
+    const __m128 lshift = _mm_set1_ps( labLShift_32f );
+    const __m128 lscale = _mm_set1_ps( 1.f/labLScale_32f );
+    const __m128 ca = _mm_set1_ps( 0.002f ), cb = _mm_set1_ps( 0.005f );
+    const __m128 bx = _mm_set1_ps( labBx_32f ), by = _mm_set1_ps( labBy_32f ),
+                 bz = _mm_set1_ps( labBz_32f ), gx = _mm_set1_ps( labGx_32f ),
+                 gy = _mm_set1_ps( labGy_32f ), gz = _mm_set1_ps( labGz_32f ),
+                 rx = _mm_set1_ps( labRx_32f ), ry = _mm_set1_ps( labRy_32f ),
+                 rz = _mm_set1_ps( labRz_32f );
+    int i = 0;
+
+    for( ; i <= width - 4; i += 4, src += 12, dst += dst_cn*4 )
+    {
+        __m128 v[3], d[3];
+        icvLoadPlanes_32f( src, 3, v );
+        __m128 L = _mm_mul_ps( _mm_add_ps( v[0], lshift ), lscale );
+        __m128 x = _mm_add_ps( L, _mm_mul_ps( v[1], ca ));
+        __m128 z = _mm_sub_ps( L, _mm_mul_ps( v[2], cb ));
+        __m128 y = _mm_mul_ps( _mm_mul_ps( L, L ), L );
+        x = _mm_mul_ps( _mm_mul_ps( x, x ), x );
+        z = _mm_mul_ps( _mm_mul_ps( z, z ), z );
+
+        d[blue_idx] = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, bx ), _mm_mul_ps( y, by )),
+                                  _mm_mul_ps( z, bz ));
+        d[1] = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, gx ), _mm_mul_ps( y, gy )),
+                           _mm_mul_ps( z, gz ));
+        d[blue_idx^2] = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, rx ), _mm_mul_ps( y, ry )),
+                                    _mm_mul_ps( z, rz ));
+        icvStorePlanes_32f( dst, dst_cn, d );
+    }
+    return i;
+}
+
+#else
+
+static inline int
+icvBGRx2Lab_8u_SSE2( const uchar*, uchar*, int, int, int )
+{ return 0; }
+
+static inline int
+icvBGRx2Lab_32f_SSE2( const float*, float*, int, int, int )
+{ return 0; }
+
+static inline int
+icvLab2BGRx_32f_SSE2( const float*, float*, int, int, int )
+{ return 0; }
+
+#endif
+
+
 static CvStatus CV_STDCALL
 icvBGRx2Lab_8u_CnC3R( const uchar* src, int srcstep, uchar* dst, int dststep,
                       CvSize size, int src_cn, int blue_idx )
@@ -1801,7 +2836,8 @@ icvBGRx2Lab_8u_CnC3R( const uchar* src, int srcstep, uchar* dst, int dststep,
 
     for( ; size.height--; src += srcstep, dst += dststep )
     {
-        for( i = 0; i < size.width; i += 3, src += src_cn )
+        i = icvBGRx2Lab_8u_SSE2( src, dst, size.width/3, src_cn, blue_idx );
+        for( src += i*src_cn, i *= 3; i < size.width; i += 3, src += src_cn )
         {
             int b = src[blue_idx], g = src[1], r = src[2^blue_idx];
             int x, y, z, f;
@@ -1866,7 +2902,8 @@ icvBGRx2Lab_32f_CnC3R( const float* src, int srcstep, float* dst, int dststep,
 
     for( ; size.height--; src += srcstep, dst += dststep )
     {
-        for( i = 0; i < size.width; i += 3, src += src_cn )
+        i = icvBGRx2Lab_32f_SSE2( src, dst, size.width/3, src_cn, blue_idx );
+        for( src += i*src_cn, i *= 3; i < size.width; i += 3, src += src_cn )
         {
             float b = src[blue_idx], g = src[1], r = src[2^blue_idx];
             float x, y, z;
@@ -1922,7 +2959,8 @@ icvLab2BGRx_32f_C3CnR( const float* src, int srcstep, float* dst, int dststep,
 
     for( ; size.height--; src += srcstep, dst += dststep )
     {
-        for( i = 0; i < size.width; i += 3, dst += dst_cn )
+        i = icvLab2BGRx_32f_SSE2( src, dst, size.width/3, dst_cn, blue_idx );
+        for( dst += i*dst_cn, i *= 3; i < size.width; i += 3, dst += dst_cn )
         {
             float L = src[i], a = src[i+1], b = src[i+2];
             float x, y, z;
@@ -2128,20 +3166,69 @@ icvLuv2BGRx_8u_C3CnR( const uchar* src, int srcstep, uchar* dst, int dststep,
 *                            Bayer Pattern -> RGB conversion                             *
 \****************************************************************************************/
 
-static CvStatus CV_STDCALL
-icvBayer2BGR_8u_C1C3R( const uchar* bayer0, int bayer_step,
-                       uchar *dst0, int dst_step,
-                       CvSize size, int code )
+#if CV_SSE2
+
+/* 16 pairs of pixels per iteration; every 16-bit lane of the even (low) and odd (high)
+   bytes of the three source rows gives one pair, the way the scalar loop computes it */
+static inline int
+icvBayer2BGRPairs_8u_SSE2( const uchar* bayer, int bayer_step, uchar* dst, int len, int blue )
 {
-    int blue = code == CV_BayerBG2BGR || code == CV_BayerGB2BGR ? -1 : 1;
-    int start_with_green = code == CV_BayerGB2BGR || code == CV_BayerGR2BGR;
+    const __m128i lo = _mm_set1_epi16( 0xff ), two = _mm_set1_epi16( 2 );
+    int i = 0;
 
-    memset( dst0, 0, size.width*3*sizeof(dst0[0]) );
-    memset( dst0 + (size.height - 1)*dst_step, 0, size.width*3*sizeof(dst0[0]) );
-    dst0 += dst_step + 3 + 1;
-    size.height -= 2;
-    size.width -= 2;
+    for( ; i <= len - 32; i += 32, dst += 96 )
+    {
+        __m128i v[6];
+        for( int k = 0; k < 2; k++ )
+        {
+            const uchar* r0 = bayer + i + k*16;
+            __m128i a0 = _mm_loadu_si128( (const __m128i*)r0 );
+            __m128i a0s = _mm_loadu_si128( (const __m128i*)(r0 + 2) );
+            __m128i a1 = _mm_loadu_si128( (const __m128i*)(r0 + bayer_step) );
+            __m128i a1s = _mm_loadu_si128( (const __m128i*)(r0 + bayer_step + 2) );
+            __m128i a2 = _mm_loadu_si128( (const __m128i*)(r0 + bayer_step*2) );
+            __m128i a2s = _mm_loadu_si128( (const __m128i*)(r0 + bayer_step*2 + 2) );
+            __m128i e0 = _mm_and_si128( a0, lo ), o0 = _mm_srli_epi16( a0, 8 );
+            __m128i e0s = _mm_and_si128( a0s, lo );
+            __m128i e1 = _mm_and_si128( a1, lo ), o1 = _mm_srli_epi16( a1, 8 );
+            __m128i e1s = _mm_and_si128( a1s, lo ), o1s = _mm_srli_epi16( a1s, 8 );
+            __m128i e2 = _mm_and_si128( a2, lo ), o2 = _mm_srli_epi16( a2, 8 );
+            __m128i e2s = _mm_and_si128( a2s, lo );
+
+            __m128i t0 = _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16(
+                _mm_add_epi16( e0, e0s ), _mm_add_epi16( e2, e2s )), two ), 2 );
+            __m128i t1 = _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16(
+                _mm_add_epi16( o0, e1 ), _mm_add_epi16( e1s, o2 )), two ), 2 );
+            __m128i u0 = _mm_avg_epu16( e0s, e2s ), u1 = _mm_avg_epu16( o1, o1s );
+
+            v[k] = _mm_or_si128( t0, _mm_slli_epi16( u0, 8 ));
+            v[k+2] = _mm_or_si128( t1, _mm_slli_epi16( e1s, 8 ));
+            v[k+4] = _mm_or_si128( o1, _mm_slli_epi16( u1, 8 ));
+        }
+
+        if( blue < 0 )
+        {
+            __m128i t = v[0]; v[0] = v[4]; v[4] = t;
+            t = v[1]; v[1] = v[5]; v[5] = t;
+        }
+        icvStorePlanes_8u( dst - 1, 3, v );
+    }
+    return i;
+}
+
+#else
+
+static inline int
+icvBayer2BGRPairs_8u_SSE2( const uchar*, int, uchar*, int, int )
+{ return 0; }
+
+#endif
 
+/* converts the rows of one band; blue and start_with_green are set for its first row */
+static void
+icvBayer2BGRRows_8u( const uchar* bayer0, int bayer_step, uchar* dst0, int dst_step,
+                     CvSize size, int blue, int start_with_green )
+{
     for( ; size.height-- > 0; bayer0 += bayer_step, dst0 += dst_step )
     {
         int t0, t1;
@@ -2166,6 +3253,10 @@ icvBayer2BGR_8u_C1C3R( const uchar* bayer0, int bayer_step,
             dst += 3;
         }
 
+        t0 = icvBayer2BGRPairs_8u_SSE2( bayer, bayer_step, dst, (int)(bayer_end - bayer), blue );
+        bayer += t0;
+        dst += t0*3;
+
         if( blue > 0 )
         {
             for( ; bayer <= bayer_end - 2; bayer += 2, dst += 6 )
@@ -2221,15 +3312,109 @@ icvBayer2BGR_8u_C1C3R( const uchar* bayer0, int bayer_step,
         blue = -blue;
         start_with_green = !start_with_green;
     }
+}
+
+
+static CvStatus CV_STDCALL
+icvBayer2BGR_8u_C1C3R( const uchar* bayer0, int bayer_step,
+                       uchar *dst0, int dst_step,
+                       CvSize size, int code )
+{
+    int blue = code == CV_BayerBG2BGR || code == CV_BayerGB2BGR ? -1 : 1;
+    int start_with_green = code == CV_BayerGB2BGR || code == CV_BayerGR2BGR;
+    int threads = cvGetNumThreads(), t;
+
+    memset( dst0, 0, size.width*3*sizeof(dst0[0]) );
+    memset( dst0 + (size.height - 1)*dst_step, 0, size.width*3*sizeof(dst0[0]) );
+    dst0 += dst_step + 3 + 1;
+    size.height -= 2;
+    size.width -= 2;
+
+    if( size.height <= 0 )
+        return CV_OK;
+
+    if( size.width*size.height < ICV_CVT_COLOR_PARALLEL_MIN_SIZE )
+        threads = 1;
+    threads = MIN( threads, size.height );
+
+    /* the pattern alternates from row to row, so a band starting
+       at an odd row starts with the other blue/green arrangement */
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(threads), schedule(static)
+#endif
+    for( t = 0; t < threads; t++ )
+    {
+        int y0 = size.height*t/threads, y1 = size.height*(t+1)/threads;
+        icvBayer2BGRRows_8u( bayer0 + y0*bayer_step, bayer_step, dst0 + y0*dst_step,
+                             dst_step, cvSize( size.width, y1 - y0 ),
+                             y0 & 1 ? -blue : blue, start_with_green ^ (y0 & 1) );
+    }
 
     return CV_OK;
 }
 
 
+
+
 /****************************************************************************************\
 *                                   The main function                                    *
 \****************************************************************************************/
 
+/* runs the conversion function (the one of func0..func3 that is set) in one band
+   per thread: bands of rows, or pieces of the row if the arrays are a single row */
+static CvStatus
+icvCvtColorParallel( CvColorCvtFunc0 func0, CvColorCvtFunc1 func1,
+                     CvColorCvtFunc2 func2, CvColorCvtFunc3 func3,
+                     const uchar* src, int src_step, uchar* dst, int dst_step,
+                     CvSize size, int src_pix_size, int dst_pix_size, const int* param )
+{
+    int threads = cvGetNumThreads(), t;
+    int len = size.height > 1 ? size.height : size.width;
+    CvStatus status = CV_OK;
+    CvStatus* band_status;
+
+    if( size.width*size.height < ICV_CVT_COLOR_PARALLEL_MIN_SIZE )
+        threads = 1;
+    threads = MAX( MIN( threads, len ), 1 );
+    band_status = (CvStatus*)cvStackAlloc( threads*sizeof(band_status[0]) );
+
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(threads), schedule(static)
+#endif
+    for( t = 0; t < threads; t++ )
+    {
+        int y0 = len*t/threads, y1 = len*(t+1)/threads;
+        const uchar* s = src;
+        uchar* d = dst;
+        CvSize band_size = size;
+
+        if( size.height > 1 )
+        {
+            s += y0*src_step;
+            d += y0*dst_step;
+            band_size.height = y1 - y0;
+        }
+        else
+        {
+            s += y0*src_pix_size;
+            d += y0*dst_pix_size;
+            band_size.width = y1 - y0;
+        }
+
+        band_status[t] = func0 ? func0( s, src_step, d, dst_step, band_size ) :
+            func1 ? func1( s, src_step, d, dst_step, band_size, param[0] ) :
+            func2 ? func2( s, src_step, d, dst_step, band_size, param[0], param[1] ) :
+            func3( s, src_step, d, dst_step, band_size, param[0], param[1], param[2] );
+    }
+
+    for( t = 0; t < threads; t++ )
+        if( band_status[t] < 0 )
+            status = band_status[t];
+
+    return status;
+}
+
+
 CV_IMPL void
 cvCvtColor( const CvArr* srcarr, CvArr* dstarr, int code )
 {
@@ -2247,6 +3432,8 @@ cvCvtColor( const CvArr* srcarr, CvArr* dstarr, int code )
     CvColorCvtFunc2 func2 = 0;
     CvColorCvtFunc3 func3 = 0;
     int param[] = { 0, 0, 0, 0 };
+    int is_bayer = code == CV_BayerBG2BGR || code == CV_BayerGB2BGR ||
+                   code == CV_BayerRG2BGR || code == CV_BayerGR2BGR;
     
     CV_CALL( src = cvGetMat( srcarr, &srcstub ));
     CV_CALL( dst = cvGetMat( dstarr, &dststub ));
@@ -2267,9 +3454,7 @@ cvCvtColor( const CvArr* srcarr, CvArr* dstarr, int code )
     src_step = src->step;
     dst_step = dst->step;
 
-    if( CV_IS_MAT_CONT(src->type & dst->type) &&
-        code != CV_BayerBG2BGR && code != CV_BayerGB2BGR &&
-        code != CV_BayerRG2BGR && code != CV_BayerGR2BGR ) 
+    if( CV_IS_MAT_CONT(src->type & dst->type) && !is_bayer )
     {
         size.width *= size.height;
         size.height = 1;
@@ -2521,27 +3706,21 @@ cvCvtColor( const CvArr* srcarr, CvArr* dstarr, int code )
         CV_ERROR( CV_StsBadFlag, "Unknown/unsupported color conversion code" );
     }
 
-    if( func0 )
-    {
-        IPPI_CALL( func0( src->data.ptr, src_step, dst->data.ptr, dst_step, size ));
-    }
-    else if( func1 )
+    if( !func0 && !func1 && !func2 && !func3 )
+        CV_ERROR( CV_StsUnsupportedFormat, "The image format is not supported" );
+
+    if( is_bayer )
     {
+        // the Bayer conversion reads the neighbor rows and splits the work itself
         IPPI_CALL( func1( src->data.ptr, src_step,
             dst->data.ptr, dst_step, size, param[0] ));
     }
-    else if( func2 )
-    {
-        IPPI_CALL( func2( src->data.ptr, src_step,
-            dst->data.ptr, dst_step, size, param[0], param[1] ));
-    }
-    else if( func3 )
+    else
     {
-        IPPI_CALL( func3( src->data.ptr, src_step,
-            dst->data.ptr, dst_step, size, param[0], param[1], param[2] ));
+        IPPI_CALL( icvCvtColorParallel( func0, func1, func2, func3,
+            src->data.ptr, src_step, dst->data.ptr, dst_step, size,
+            CV_ELEM_SIZE(src->type), CV_ELEM_SIZE(dst->type), param ));
     }
-    else
-        CV_ERROR( CV_StsUnsupportedFormat, "The image format is not supported" );
 
     __END__;
 }
@@ -898,6 +898,221 @@ void CvSepFilter::init( int _max_width, int _src_type, int _dst_type,
 }
 
 
+/****************************************************************************************\
+                          SSE2 versions of the symmetric kernels
+\****************************************************************************************/
+
+/* Each helper handles as many leading elements of the row as it can with
+   vector code and returns their count; the caller finishes the tail. */
+
+#if CV_SSE2
+
+static inline __m128 icvLoad4f_8u( const uchar* s )
+{
+    __m128i z = _mm_setzero_si128();
+    __m128i v = _mm_cvtsi32_si128( *(const int*)s );
+    return _mm_cvtepi32_ps( _mm_unpacklo_epi16( _mm_unpacklo_epi8( v, z ), z ));
+}
+
+static inline __m128 icvLoad4f_16s( const short* s )
+{
+    __m128i v = _mm_loadl_epi64( (const __m128i*)s );
+    return _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 ));
+}
+
+static inline __m128 icvLoad4f_16u( const ushort* s )
+{
+    __m128i v = _mm_loadl_epi64( (const __m128i*)s );
+    return _mm_cvtepi32_ps( _mm_unpacklo_epi16( v, _mm_setzero_si128() ));
+}
+
+static inline __m128 icvLoad4f_32f( const float* s )
+{
+    return _mm_loadu_ps( s );
+}
+
+static inline void icvStore4f_8u( uchar* d, __m128 v )
+{
+    __m128i t = _mm_cvtps_epi32( v );
+    t = _mm_packs_epi32( t, t );
+    *(int*)d = _mm_cvtsi128_si32( _mm_packus_epi16( t, t ));
+}
+
+static inline void icvStore4f_16s( short* d, __m128 v )
+{
+    __m128i t = _mm_cvtps_epi32( v );
+    _mm_storel_epi64( (__m128i*)d, _mm_packs_epi32( t, t ));
+}
+
+static inline void icvStore4f_16u( ushort* d, __m128 v )
+{
+    /* there is no unsigned 32->16 pack in SSE2, so bias into the signed range */
+    __m128i t = _mm_sub_epi32( _mm_cvtps_epi32( v ), _mm_set1_epi32( 32768 ));
+    t = _mm_xor_si128( _mm_packs_epi32( t, t ), _mm_set1_epi16( (short)0x8000 ));
+    _mm_storel_epi64( (__m128i*)d, t );
+}
+
+static inline void icvStore4f_32f( float* d, __m128 v )
+{
+    _mm_storeu_ps( d, v );
+}
+
+/* low 32 bits of the lane-wise 32x32 product (pmulld is SSE4.1) */
+static inline __m128i icvMulLo32( __m128i a, __m128i b )
+{
+    __m128i lo = _mm_mul_epu32( a, b );
+    __m128i hi = _mm_mul_epu32( _mm_srli_epi64( a, 32 ), _mm_srli_epi64( b, 32 ));
+    return _mm_unpacklo_epi32( _mm_shuffle_epi32( lo, _MM_SHUFFLE(0,0,2,0) ),
+                               _mm_shuffle_epi32( hi, _MM_SHUFFLE(0,0,2,0) ));
+}
+
+#define ICV_DEF_FILTER_ROW_SYMM_SSE2( flavor, srcflavor, srctype )      \
+static int                                                              \
+icvFilterRowSymm_##flavor##_SSE2( const srctype* s, float* dst,         \
+                    const float* kx, int ksize2, int cn, int width )    \
+{                                                                       \
+    int i = 0, j, k;                                                    \
+    for( ; i <= width - 4; i += 4, s += 4 )                             \
+    {                                                                   \
+        __m128 s0 = _mm_mul_ps( _mm_set1_ps(kx[0]),                     \
+                                icvLoad4f_##srcflavor(s) );             \
+        for( k = 1, j = cn; k <= ksize2; k++, j += cn )                 \
+        {                                                               \
+            __m128 t = _mm_add_ps( icvLoad4f_##srcflavor(s + j),        \
+                                   icvLoad4f_##srcflavor(s - j) );      \
+            s0 = _mm_add_ps( s0, _mm_mul_ps( _mm_set1_ps(kx[k]), t ));  \
+        }                                                               \
+        _mm_storeu_ps( dst + i, s0 );                                   \
+    }                                                                   \
+    return i;                                                           \
+}
+
+#define ICV_DEF_FILTER_COL_SYMM_SSE2( flavor, dstflavor, dsttype )      \
+static int                                                              \
+icvFilterColSymm_##flavor##_SSE2( const float** src, dsttype* dst,      \
+                                  const float* ky, int ksize2, int width )\
+{                                                                       \
+    int i = 0, k;                                                       \
+    for( ; i <= width - 4; i += 4 )                                     \
+    {                                                                   \
+        __m128 s0 = _mm_mul_ps( _mm_set1_ps(ky[0]),                     \
+                                _mm_loadu_ps(src[0] + i) );             \
+        for( k = 1; k <= ksize2; k++ )                                  \
+        {                                                               \
+            __m128 t = _mm_add_ps( _mm_loadu_ps(src[k] + i),            \
+                                   _mm_loadu_ps(src[-k] + i) );         \
+            s0 = _mm_add_ps( s0, _mm_mul_ps( _mm_set1_ps(ky[k]), t ));  \
+        }                                                               \
+        icvStore4f_##dstflavor( dst + i, s0 );                          \
+    }                                                                   \
+    return i;                                                           \
+}
+
+/* integer 8u row kernel; sums of two pixels and the kernel taps must fit
+   into signed 16 bits for pmaddwd, which holds for the fixed-point kernels */
+static int
+icvFilterRowSymm_8u32s_SSE2( const uchar* s, int* dst, const int* kx,
+                             int ksize2, int cn, int width )
+{
+    int i = 0, j, k;
+    __m128i z = _mm_setzero_si128();
+
+    for( k = 0; k <= ksize2; k++ )
+        if( (unsigned)(kx[k] + 32768) > 65535 )
+            return 0;
+
+    for( ; i <= width - 8; i += 8, s += 8 )
+    {
+        __m128i f = _mm_set1_epi32( kx[0] & 0xffff );
+        __m128i x = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)s ), z );
+        __m128i s0 = _mm_madd_epi16( _mm_unpacklo_epi16( x, z ), f );
+        __m128i s1 = _mm_madd_epi16( _mm_unpackhi_epi16( x, z ), f );
+
+        for( k = 1, j = cn; k <= ksize2; k++, j += cn )
+        {
+            x = _mm_add_epi16(
+                _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(s + j) ), z ),
+                _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(s - j) ), z ));
+            f = _mm_set1_epi32( kx[k] & 0xffff );
+            s0 = _mm_add_epi32( s0, _mm_madd_epi16( _mm_unpacklo_epi16( x, z ), f ));
+            s1 = _mm_add_epi32( s1, _mm_madd_epi16( _mm_unpackhi_epi16( x, z ), f ));
+        }
+
+        _mm_storeu_si128( (__m128i*)(dst + i), s0 );
+        _mm_storeu_si128( (__m128i*)(dst + i + 4), s1 );
+    }
+    return i;
+}
+
+/* fixed-point 8u column kernel, bit-exact with the scalar CV_DESCALE code */
+static int
+icvFilterColSymm_32s8u_SSE2( const int** src, uchar* dst, const int* ky,
+                             int ksize2, int width )
+{
+    int i = 0, k;
+    __m128i delta = _mm_set1_epi32( 1 << (FILTER_BITS*2 - 1) );
+
+    for( ; i <= width - 8; i += 8 )
+    {
+        __m128i f = _mm_set1_epi32( ky[0] );
+        __m128i s0 = icvMulLo32( _mm_loadu_si128( (const __m128i*)(src[0] + i) ), f );
+        __m128i s1 = icvMulLo32( _mm_loadu_si128( (const __m128i*)(src[0] + i + 4) ), f );
+
+        for( k = 1; k <= ksize2; k++ )
+        {
+            const int *sptr = src[k] + i, *sptr2 = src[-k] + i;
+            __m128i x0 = _mm_add_epi32( _mm_loadu_si128( (const __m128i*)sptr ),
+                                        _mm_loadu_si128( (const __m128i*)sptr2 ));
+            __m128i x1 = _mm_add_epi32( _mm_loadu_si128( (const __m128i*)(sptr + 4) ),
+                                        _mm_loadu_si128( (const __m128i*)(sptr2 + 4) ));
+            f = _mm_set1_epi32( ky[k] );
+            s0 = _mm_add_epi32( s0, icvMulLo32( x0, f ));
+            s1 = _mm_add_epi32( s1, icvMulLo32( x1, f ));
+        }
+
+        s0 = _mm_srai_epi32( _mm_add_epi32( s0, delta ), FILTER_BITS*2 );
+        s1 = _mm_srai_epi32( _mm_add_epi32( s1, delta ), FILTER_BITS*2 );
+        s0 = _mm_packs_epi32( s0, s1 );
+        _mm_storel_epi64( (__m128i*)(dst + i), _mm_packus_epi16( s0, s0 ));
+    }
+    return i;
+}
+
+#else
+
+#define ICV_DEF_FILTER_ROW_SYMM_SSE2( flavor, srcflavor, srctype )      \
+static inline int                                                       \
+icvFilterRowSymm_##flavor##_SSE2( const srctype*, float*,               \
+                                  const float*, int, int, int )         \
+{ return 0; }
+
+#define ICV_DEF_FILTER_COL_SYMM_SSE2( flavor, dstflavor, dsttype )      \
+static inline int                                                       \
+icvFilterColSymm_##flavor##_SSE2( const float**, dsttype*,              \
+                                  const float*, int, int )              \
+{ return 0; }
+
+static inline int
+icvFilterRowSymm_8u32s_SSE2( const uchar*, int*, const int*, int, int, int )
+{ return 0; }
+
+static inline int
+icvFilterColSymm_32s8u_SSE2( const int**, uchar*, const int*, int, int )
+{ return 0; }
+
+#endif
+
+ICV_DEF_FILTER_ROW_SYMM_SSE2( 8u32f, 8u, uchar )
+ICV_DEF_FILTER_ROW_SYMM_SSE2( 16s32f, 16s, short )
+ICV_DEF_FILTER_ROW_SYMM_SSE2( 16u32f, 16u, ushort )
+ICV_DEF_FILTER_ROW_SYMM_SSE2( 32f, 32f, float )
+
+ICV_DEF_FILTER_COL_SYMM_SSE2( 32f8u, 8u, uchar )
+ICV_DEF_FILTER_COL_SYMM_SSE2( 32f16s, 16s, short )
+ICV_DEF_FILTER_COL_SYMM_SSE2( 32f16u, 16u, ushort )
+ICV_DEF_FILTER_COL_SYMM_SSE2( 32f, 32f, float )
+
+
 static void
 icvFilterRowSymm_8u32s( const uchar* src, int* dst, void* params )
 {
@@ -975,6 +1190,10 @@ icvFilterRowSymm_8u32s( const uchar* src, int* dst, void* params )
                 }
         }
         else
+        {
+            i = icvFilterRowSymm_8u32s_SSE2( s, dst, kx, ksize2, cn, width );
+            s += i;
+
             for( ; i <= width - 4; i += 4, s += 4 )
             {
                 int f = kx[0];
@@ -989,6 +1208,7 @@ icvFilterRowSymm_8u32s( const uchar* src, int* dst, void* params )
                 dst[i] = s0; dst[i+1] = s1;
                 dst[i+2] = s2; dst[i+3] = s3;
             }
+        }
 
         for( ; i < width; i++, s++ )
         {
@@ -1099,6 +1319,10 @@ icvFilterRowSymm_##flavor( const srctype* src,                      \
                                                                     \
     if( is_symm )                                                   \
     {                                                               \
+        i = icvFilterRowSymm_##flavor##_SSE2( s, dst, kx, ksize2,   \
+                                              cn, width );          \
+        s += i;                                                     \
+                                                                    \
         for( ; i <= width - 4; i += 4, s += 4 )                     \
         {                                                           \
             double f = kx[0];                                       \
@@ -1189,6 +1413,10 @@ icvFilterRowSymm_32f( const float* src, float* dst, void* params )
                 dst[i] = s0; dst[i+1] = s1;
             }
         else
+        {
+            i = icvFilterRowSymm_32f_SSE2( s, dst, kx, ksize2, cn, width );
+            s += i;
+
             for( ; i <= width - 4; i += 4, s += 4 )
             {
                 double f = kx[0];
@@ -1203,6 +1431,7 @@ icvFilterRowSymm_32f( const float* src, float* dst, void* params )
                 dst[i] = (float)s0; dst[i+1] = (float)s1;
                 dst[i+2] = (float)s2; dst[i+3] = (float)s3;
             }
+        }
 
         for( ; i < width; i++, s++ )
         {
@@ -1290,7 +1519,8 @@ icvFilterColSymm_32s8u( const int** src, uchar* dst, int dst_step, int count, vo
             }
         }
         else
-            for( i = 0; i <= width - 4; i += 4 )
+            for( i = icvFilterColSymm_32s8u_SSE2( src, dst, ky, ksize2, width );
+                 i <= width - 4; i += 4 )
             {
                 int f = ky[0];
                 const int* sptr = src[0] + i, *sptr2;
@@ -1524,7 +1754,9 @@ icvFilterColSymm_##flavor( const srctype** src, dsttype* dst,       \
     {                                                               \
         for( ; count--; dst += dst_step, src++ )                    \
         {                                                           \
-            for( i = 0; i <= width - 4; i += 4 )                    \
+            i = icvFilterColSymm_##flavor##_SSE2( src, dst, ky,     \
+                                                  ksize2, width );  \
+            for( ; i <= width - 4; i += 4 )                         \
             {                                                       \
                 double f = ky[0];                                   \
                 const srctype* sptr = src[0] + i, *sptr2;           \
@@ -1708,7 +1940,8 @@ icvFilterColSymm_32f( const float** src, float* dst,
                 }
             }
             else
-                for( i = 0; i <= width - 4; i += 4 )
+                for( i = icvFilterColSymm_32f_SSE2( src, dst, ky, ksize2, width );
+                     i <= width - 4; i += 4 )
                 {
                     double f = ky[0];
                     const float* sptr = src[0] + i, *sptr2;
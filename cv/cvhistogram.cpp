@@ -790,14 +790,25 @@ cvSetHistBinRanges( CvHistogram* hist, float** ranges, int uniform )
 
 #define  ICV_HIST_DUMMY_IDX  (INT_MIN/3)
 
+/* arrays of at least that many pixels are processed in parallel bands */
+#define  ICV_CALC_HIST_PARALLEL_MIN_SIZE  (1 << 16)
+
+/* dense histograms with up to that many bins are back-projected
+   through a copy of the bins converted to the destination type */
+#define  ICV_BACK_PROJECT_SMALL_HIST_SIZE  (1 << 12)
+
+/* uniform 32f histograms compute bin indices by blocks of that many pixels */
+#define  ICV_HIST_IDX_BLOCK_SIZE  256
+
 static CvStatus
-icvCalcHistLookupTables8u( const CvHistogram* hist, int dims, int* size, int* tab )
+icvCalcHistLookupTables( const CvHistogram* hist, int dims, int* size,
+                         int* tab, int tab_size )
 {
-    const int lo = 0, hi = 256;
+    const int lo = 0, hi = tab_size;
     int is_sparse = CV_IS_SPARSE_HIST( hist );
     int have_range = CV_HIST_HAS_RANGES(hist);
     int i, j;
-    
+
     if( !have_range || CV_IS_UNIFORM_HIST(hist))
     {
         for( i = 0; i < dims; i++ )
@@ -836,7 +847,7 @@ icvCalcHistLookupTables8u( const CvHistogram* hist, int dims, int* size, int* ta
 
             if( limit > hi )
                 limit = hi;
-            
+
             j = lo;
             for(;;)
             {
@@ -864,265 +875,406 @@ icvCalcHistLookupTables8u( const CvHistogram* hist, int dims, int* size, int* ta
 }
 
 
-/***************************** C A L C   H I S T O G R A M *************************/
-
-// Calculates histogram for one or more 8u arrays
-static CvStatus CV_STDCALL
-    icvCalcHist_8u_C1R( uchar** img, int step, uchar* mask, int maskStep,
-                        CvSize size, CvHistogram* hist )
+/* Allocates and fills the lookup tables of a histogram of 8u or 16u arrays
+   (one table entry per possible pixel value). When <_buffer> is not NULL
+   (back projection), the bins of a dense histogram are also converted to
+   the array type: into a table indexed by pixel values for 1D histograms
+   and into a compact copy of small continuous multi-dimensional ones.
+   The caller frees both arrays, also on failure */
+static CvStatus
+icvCreateHistLookupTables( const CvHistogram* hist, int depth,
+                           int** _tab, void** _buffer )
 {
-    int* tab;
-    int is_sparse = CV_IS_SPARSE_HIST(hist);
+    int tab_size = depth == CV_8U ? 256 : 65536;
     int dims, histsize[CV_MAX_DIM];
-    int i, x;
+    int i, total = 1, count;
+    int* tab;
+    void* buffer;
+    CvMatND* mat;
     CvStatus status;
 
     dims = cvGetDims( hist->bins, histsize );
 
-    tab = (int*)cvStackAlloc( dims*256*sizeof(int));
-    status = icvCalcHistLookupTables8u( hist, dims, histsize, tab );
+    for( i = 0; i < dims; i++ )
+        total *= histsize[i];
 
-    if( status < 0 )
+    if( !CV_IS_SPARSE_HIST(hist) && dims <= 3 && total >= -ICV_HIST_DUMMY_IDX )
+        return CV_BADSIZE_ERR; // too big histogram
+
+    tab = (int*)cvAlloc( dims*tab_size*sizeof(tab[0]));
+    if( !tab )
+        return CV_OUTOFMEM_ERR;
+    *_tab = tab;
+
+    status = icvCalcHistLookupTables( hist, dims, histsize, tab, tab_size );
+    if( status < 0 || !_buffer || CV_IS_SPARSE_HIST(hist) )
         return status;
 
-    if( !is_sparse )
+    mat = (CvMatND*)(hist->bins);
+    if( dims > 1 && (total > ICV_BACK_PROJECT_SMALL_HIST_SIZE ||
+                     !CV_IS_MAT_CONT(mat->type)))
+        return CV_OK;
+
+    count = dims == 1 ? tab_size : total;
+    buffer = cvAlloc( count*CV_ELEM_SIZE(depth) );
+    if( !buffer )
+        return CV_OUTOFMEM_ERR;
+    *_buffer = buffer;
+
+    for( i = 0; i < count; i++ )
     {
-        int total = 1;
-        int* bins = ((CvMatND*)(hist->bins))->data.i;
+        int v = 0;
 
-        for( i = 0; i < dims; i++ )
-            total *= histsize[i];
+        if( dims > 1 )
+            v = cvRound(mat->data.fl[i]);
+        else if( tab[i] >= 0 )
+            v = cvRound(mat->data.fl[tab[i]]);
 
-        if( dims <= 3 && total >= -ICV_HIST_DUMMY_IDX )
-            return CV_BADSIZE_ERR; // too big histogram
+        if( depth == CV_8U )
+            ((uchar*)buffer)[i] = CV_CAST_8U(v);
+        else
+            ((ushort*)buffer)[i] = CV_CAST_16U(v);
+    }
 
-        switch( dims )
-        {
-        case 1:
-            {
-            int tab1d[256];
-            memset( tab1d, 0, sizeof(tab1d));
+    return CV_OK;
+}
 
-            for( ; size.height--; img[0] += step )
-            {
-                uchar* ptr = img[0];
-                if( !mask )
-                {
-                    for( x = 0; x <= size.width - 4; x += 4 )
-                    {
-                        int v0 = ptr[x];
-                        int v1 = ptr[x+1];
 
-                        tab1d[v0]++;
-                        tab1d[v1]++;
+/* Computes cvFloor(src[i]*a + b), i.e. the bin indices of a block of pixels
+   along one dimension of a uniform 32f histogram */
+static void
+icvCalcHistIdx_32f( const float* src, int len, double a, double b, int* idx )
+{
+    int i = 0;
 
-                        v0 = ptr[x+2];
-                        v1 = ptr[x+3];
+#if CV_SSE2
+    __m128d va = _mm_set1_pd(a), vb = _mm_set1_pd(b);
 
-                        tab1d[v0]++;
-                        tab1d[v1]++;
-                    }
+    for( ; i <= len - 4; i += 4 )
+    {
+        __m128 s = _mm_loadu_ps( src + i );
+        __m128d t0 = _mm_add_pd( _mm_mul_pd( _mm_cvtps_pd(s), va ), vb );
+        __m128d t1 = _mm_add_pd( _mm_mul_pd( _mm_cvtps_pd(_mm_movehl_ps(s, s)), va ), vb );
+        __m128i i0 = _mm_cvtpd_epi32(t0), i1 = _mm_cvtpd_epi32(t1);
+        // same as cvFloor: the rounded value is decremented where it is
+        // above the argument (the comparison mask is -1 there)
+        __m128i m0 = _mm_castpd_si128( _mm_cmplt_pd( t0, _mm_cvtepi32_pd(i0) ));
+        __m128i m1 = _mm_castpd_si128( _mm_cmplt_pd( t1, _mm_cvtepi32_pd(i1) ));
+
+        m0 = _mm_unpacklo_epi64( _mm_shuffle_epi32( m0, _MM_SHUFFLE(3,3,2,0) ),
+                                 _mm_shuffle_epi32( m1, _MM_SHUFFLE(3,3,2,0) ));
+        i0 = _mm_add_epi32( _mm_unpacklo_epi64( i0, i1 ), m0 );
+        _mm_storeu_si128( (__m128i*)(idx + i), i0 );
+    }
+#endif
 
-                    for( ; x < size.width; x++ )
-                        tab1d[ptr[x]]++;
-                }
-                else
-                {
-                    for( x = 0; x < size.width; x++ )
-                        if( mask[x] )
-                            tab1d[ptr[x]]++;
-                    mask += maskStep;
-                }
-            }
+    for( ; i < len; i++ )
+        idx[i] = cvFloor( src[i]*a + b );
+}
 
-            for( i = 0; i < 256; i++ )
-            {
-                int idx = tab[i];
-                if( idx >= 0 )
-                    bins[idx] += tab1d[i];
-            }
-            }
-            break;
-        case 2:
-            for( ; size.height--; img[0] += step, img[1] += step )
-            {
-                uchar* ptr0 = img[0];
-                uchar* ptr1 = img[1];
-                if( !mask )
-                {
-                    for( x = 0; x < size.width; x++ )
-                    {
-                        int v0 = ptr0[x];
-                        int v1 = ptr1[x];
-                        int idx = tab[v0] + tab[256+v1];
 
-                        if( idx >= 0 )
-                            bins[idx]++;
-                    }
-                }
-                else
-                {
-                    for( x = 0; x < size.width; x++ )
-                    {
-                        if( mask[x] )
-                        {
-                            int v0 = ptr0[x];
-                            int v1 = ptr1[x];
+/***************************** C A L C   H I S T O G R A M *************************/
 
-                            int idx = tab[v0] + tab[256+v1];
+/* The histogram functions below accumulate pixels of a single band into
+   the integer bins <bins>, which have the layout of the histogram matrix
+   (for dense histograms; sparse ones are updated directly) */
 
-                            if( idx >= 0 )
-                                bins[idx]++;
-                        }
-                    }
-                    mask += maskStep;
-                }
-            }
-            break;
-        case 3:
-            for( ; size.height--; img[0] += step, img[1] += step, img[2] += step )
-            {
-                uchar* ptr0 = img[0];
-                uchar* ptr1 = img[1];
-                uchar* ptr2 = img[2];
-                if( !mask )
-                {
-                    for( x = 0; x < size.width; x++ )
-                    {
-                        int v0 = ptr0[x];
-                        int v1 = ptr1[x];
-                        int v2 = ptr2[x];
-                        int idx = tab[v0] + tab[256+v1] + tab[512+v2];
+// 1D histograms of 8u arrays count pixel values first, in four tables,
+// so that runs of equal pixels do not serialize on a single counter
+static void
+icvCalcHist1D_8u( uchar** img, int step, uchar* mask, int maskStep,
+                  CvSize size, const int* tab, int* bins )
+{
+    int tab1d[4][256];
+    int i, x;
 
-                        if( idx >= 0 )
-                            bins[idx]++;
-                    }
-                }
-                else
-                {
-                    for( x = 0; x < size.width; x++ )
-                    {
-                        if( mask[x] )
-                        {
-                            int v0 = ptr0[x];
-                            int v1 = ptr1[x];
-                            int v2 = ptr2[x];
-                            int idx = tab[v0] + tab[256+v1] + tab[512+v2];
+    memset( tab1d, 0, sizeof(tab1d));
 
-                            if( idx >= 0 )
-                                bins[idx]++;
-                        }
-                    }
-                    mask += maskStep;
-                }
-            }
-            break;
-        default:
-            for( ; size.height--; )
+    for( ; size.height--; img[0] += step )
+    {
+        uchar* ptr = img[0];
+        if( !mask )
+        {
+            for( x = 0; x <= size.width - 4; x += 4 )
             {
-                if( !mask )
-                {
-                    for( x = 0; x < size.width; x++ )
-                    {
-                        int* binptr = bins;
-                        for( i = 0; i < dims; i++ )
-                        {
-                            int idx = tab[i*256 + img[i][x]];
-                            if( idx < 0 )
-                                break;
-                            binptr += idx;
-                        }
-                        if( i == dims )
-                            binptr[0]++;
-                    }
-                }
-                else
-                {
-                    for( x = 0; x < size.width; x++ )
-                    {
-                        if( mask[x] )
-                        {
-                            int* binptr = bins;
-                            for( i = 0; i < dims; i++ )
-                            {
-                                int idx = tab[i*256 + img[i][x]];
-                                if( idx < 0 )
-                                    break;
-                                binptr += idx;
-                            }
-                            if( i == dims )
-                                binptr[0]++;
-                        }
-                    }
-                    mask += maskStep;
-                }
+                int v0 = ptr[x];
+                int v1 = ptr[x+1];
 
-                for( i = 0; i < dims; i++ )
-                    img[i] += step;
+                tab1d[0][v0]++;
+                tab1d[1][v1]++;
+
+                v0 = ptr[x+2];
+                v1 = ptr[x+3];
+
+                tab1d[2][v0]++;
+                tab1d[3][v1]++;
             }
+
+            for( ; x < size.width; x++ )
+                tab1d[0][ptr[x]]++;
+        }
+        else
+        {
+            for( x = 0; x < size.width; x++ )
+                if( mask[x] )
+                    tab1d[0][ptr[x]]++;
+            mask += maskStep;
         }
     }
-    else
+
+    for( i = 0; i < 256; i++ )
     {
-        CvSparseMat* mat = (CvSparseMat*)(hist->bins);
-        int node_idx[CV_MAX_DIM];
+        int idx = tab[i];
+        if( idx >= 0 )
+            bins[idx] += tab1d[0][i] + tab1d[1][i] + tab1d[2][i] + tab1d[3][i];
+    }
+}
 
-        for( ; size.height--; )
+
+// 1D histograms of 16u arrays go to the bins directly
+static void
+icvCalcHist1D_16u( ushort** img, int step, uchar* mask, int maskStep,
+                   CvSize size, const int* tab, int* bins )
+{
+    int x;
+
+    for( ; size.height--; img[0] += step )
+    {
+        ushort* ptr = img[0];
+        if( !mask )
         {
-            if( !mask )
+            for( x = 0; x <= size.width - 4; x += 4 )
             {
-                for( x = 0; x < size.width; x++ )
-                {
-                    for( i = 0; i < dims; i++ )
-                    {
-                        int idx = tab[i*256 + img[i][x]];
-                        if( idx < 0 )
-                            break;
-                        node_idx[i] = idx;
-                    }
-                    if( i == dims )
-                    {
-                        int* bin = (int*)cvPtrND( mat, node_idx, 0, 1 );
-                        bin[0]++;
-                    }
-                }
+                int idx0 = tab[ptr[x]];
+                int idx1 = tab[ptr[x+1]];
+
+                if( idx0 >= 0 )
+                    bins[idx0]++;
+                if( idx1 >= 0 )
+                    bins[idx1]++;
+
+                idx0 = tab[ptr[x+2]];
+                idx1 = tab[ptr[x+3]];
+
+                if( idx0 >= 0 )
+                    bins[idx0]++;
+                if( idx1 >= 0 )
+                    bins[idx1]++;
             }
-            else
+
+            for( ; x < size.width; x++ )
             {
-                for( x = 0; x < size.width; x++ )
+                int idx = tab[ptr[x]];
+                if( idx >= 0 )
+                    bins[idx]++;
+            }
+        }
+        else
+        {
+            for( x = 0; x < size.width; x++ )
+                if( mask[x] )
                 {
-                    if( mask[x] )
-                    {
-                        for( i = 0; i < dims; i++ )
-                        {
-                            int idx = tab[i*256 + img[i][x]];
-                            if( idx < 0 )
-                                break;
-                            node_idx[i] = idx;
-                        }
-                        if( i == dims )
-                        {
-                            int* bin = (int*)cvPtrND( mat, node_idx, 0, 1, 0 );
-                            bin[0]++;
-                        }
-                    }
+                    int idx = tab[ptr[x]];
+                    if( idx >= 0 )
+                        bins[idx]++;
                 }
-                mask += maskStep;
-            }
-
-            for( i = 0; i < dims; i++ )
-                img[i] += step;
+            mask += maskStep;
         }
     }
+}
 
-    return CV_OK;
+
+// Calculates histogram for one or more 8u or 16u arrays.
+// Pixel values are mapped to bin offsets by the lookup tables <tab>
+#define ICV_DEF_CALC_HIST_LUT_FUNC( flavor, arrtype, tab_size )                \
+static CvStatus CV_STDCALL                                                     \
+icvCalcHist_##flavor##_C1R( arrtype** img, int step, uchar* mask,              \
+                            int maskStep, CvSize size, CvHistogram* hist,      \
+                            const int* tab, int* bins )                        \
+{                                                                              \
+    int is_sparse = CV_IS_SPARSE_HIST(hist);                                   \
+    int dims, histsize[CV_MAX_DIM];                                            \
+    int i, x;                                                                  \
+                                                                               \
+    dims = cvGetDims( hist->bins, histsize );                                  \
+    step /= sizeof(img[0][0]);                                                 \
+                                                                               \
+    if( !is_sparse )                                                           \
+    {                                                                          \
+        switch( dims )                                                         \
+        {                                                                      \
+        case 1:                                                                \
+            icvCalcHist1D_##flavor( img, step, mask, maskStep,                 \
+                                    size, tab, bins );                         \
+            break;                                                             \
+        case 2:                                                                \
+            for( ; size.height--; img[0] += step, img[1] += step )             \
+            {                                                                  \
+                arrtype* ptr0 = img[0];                                        \
+                arrtype* ptr1 = img[1];                                        \
+                if( !mask )                                                    \
+                {                                                              \
+                    for( x = 0; x < size.width; x++ )                          \
+                    {                                                          \
+                        int v0 = ptr0[x];                                      \
+                        int v1 = ptr1[x];                                      \
+                        int idx = tab[v0] + tab[tab_size+v1];                  \
+                                                                               \
+                        if( idx >= 0 )                                         \
+                            bins[idx]++;                                       \
+                    }                                                          \
+                }                                                              \
+                else                                                           \
+                {                                                              \
+                    for( x = 0; x < size.width; x++ )                          \
+                    {                                                          \
+                        if( mask[x] )                                          \
+                        {                                                      \
+                            int v0 = ptr0[x];                                  \
+                            int v1 = ptr1[x];                                  \
+                                                                               \
+                            int idx = tab[v0] + tab[tab_size+v1];              \
+                                                                               \
+                            if( idx >= 0 )                                     \
+                                bins[idx]++;                                   \
+                        }                                                      \
+                    }                                                          \
+                    mask += maskStep;                                          \
+                }                                                              \
+            }                                                                  \
+            break;                                                             \
+        case 3:                                                                \
+            for( ; size.height--; img[0] += step, img[1] += step,              \
+                                  img[2] += step )                             \
+            {                                                                  \
+                arrtype* ptr0 = img[0];                                        \
+                arrtype* ptr1 = img[1];                                        \
+                arrtype* ptr2 = img[2];                                        \
+                if( !mask )                                                    \
+                {                                                              \
+                    for( x = 0; x < size.width; x++ )                          \
+                    {                                                          \
+                        int v0 = ptr0[x];                                      \
+                        int v1 = ptr1[x];                                      \
+                        int v2 = ptr2[x];                                      \
+                        int idx = tab[v0] + tab[tab_size+v1] +                 \
+                                  tab[tab_size*2+v2];                          \
+                                                                               \
+                        if( idx >= 0 )                                         \
+                            bins[idx]++;                                       \
+                    }                                                          \
+                }                                                              \
+                else                                                           \
+                {                                                              \
+                    for( x = 0; x < size.width; x++ )                          \
+                    {                                                          \
+                        if( mask[x] )                                          \
+                        {                                                      \
+                            int v0 = ptr0[x];                                  \
+                            int v1 = ptr1[x];                                  \
+                            int v2 = ptr2[x];                                  \
+                            int idx = tab[v0] + tab[tab_size+v1] +             \
+                                      tab[tab_size*2+v2];                      \
+                                                                               \
+                            if( idx >= 0 )                                     \
+                                bins[idx]++;                                   \
+                        }                                                      \
+                    }                                                          \
+                    mask += maskStep;                                          \
+                }                                                              \
+            }                                                                  \
+            break;                                                             \
+        default:                                                               \
+            for( ; size.height--; )                                            \
+            {                                                                  \
+                if( !mask )                                                    \
+                {                                                              \
+                    for( x = 0; x < size.width; x++ )                          \
+                    {                                                          \
+                        int* binptr = bins;                                    \
+                        for( i = 0; i < dims; i++ )                            \
+                        {                                                      \
+                            int idx = tab[i*tab_size + img[i][x]];             \
+                            if( idx < 0 )                                      \
+                                break;                                         \
+                            binptr += idx;                                     \
+                        }                                                      \
+                        if( i == dims )                                        \
+                            binptr[0]++;                                       \
+                    }                                                          \
+                }                                                              \
+                else                                                           \
+                {                                                              \
+                    for( x = 0; x < size.width; x++ )                          \
+                    {                                                          \
+                        if( mask[x] )                                          \
+                        {                                                      \
+                            int* binptr = bins;                                \
+                            for( i = 0; i < dims; i++ )                        \
+                            {                                                  \
+                                int idx = tab[i*tab_size + img[i][x]];         \
+                                if( idx < 0 )                                  \
+                                    break;                                     \
+                                binptr += idx;                                 \
+                            }                                                  \
+                            if( i == dims )                                    \
+                                binptr[0]++;                                   \
+                        }                                                      \
+                    }                                                          \
+                    mask += maskStep;                                          \
+                }                                                              \
+                                                                               \
+                for( i = 0; i < dims; i++ )                                    \
+                    img[i] += step;                                            \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+    else                                                                       \
+    {                                                                          \
+        CvSparseMat* mat = (CvSparseMat*)(hist->bins);                         \
+        int node_idx[CV_MAX_DIM];                                              \
+                                                                               \
+        for( ; size.height--; )                                                \
+        {                                                                      \
+            for( x = 0; x < size.width; x++ )                                  \
+            {                                                                  \
+                if( !mask || mask[x] )                                         \
+                {                                                              \
+                    for( i = 0; i < dims; i++ )                                \
+                    {                                                          \
+                        int idx = tab[i*tab_size + img[i][x]];                 \
+                        if( idx < 0 )                                          \
+                            break;                                             \
+                        node_idx[i] = idx;                                     \
+                    }                                                          \
+                    if( i == dims )                                            \
+                    {                                                          \
+                        int* bin = (int*)cvPtrND( mat, node_idx, 0, 1, 0 );    \
+                        bin[0]++;                                              \
+                    }                                                          \
+                }                                                              \
+            }                                                                  \
+                                                                               \
+            for( i = 0; i < dims; i++ )                                        \
+                img[i] += step;                                                \
+                                                                               \
+            if( mask )                                                         \
+                mask += maskStep;                                              \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    return CV_OK;                                                              \
 }
 
 
+ICV_DEF_CALC_HIST_LUT_FUNC( 8u, uchar, 256 )
+ICV_DEF_CALC_HIST_LUT_FUNC( 16u, ushort, 65536 )
+
+
 // Calculates histogram for one or more 32f arrays
 static CvStatus CV_STDCALL
     icvCalcHist_32f_C1R( float** img, int step, uchar* mask, int maskStep,
-                         CvSize size, CvHistogram* hist )
+                         CvSize size, CvHistogram* hist, int* bins )
 {
     int is_sparse = CV_IS_SPARSE_HIST(hist);
     int uniform = CV_IS_UNIFORM_HIST(hist);
@@ -1146,7 +1298,6 @@ static CvStatus CV_STDCALL
     if( !is_sparse )
     {
         CvMatND* mat = (CvMatND*)(hist->bins);
-        int* bins = mat->data.i;
 
         if( uniform )
         {
@@ -1156,50 +1307,34 @@ static CvStatus CV_STDCALL
                 {
                 double a = uni_range[0][0], b = uni_range[0][1];
                 int sz = histsize[0];
+                int idx[ICV_HIST_IDX_BLOCK_SIZE];
 
                 for( ; size.height--; img[0] += step )
                 {
                     float* ptr = img[0];
+                    int j, len;
 
-                    if( !mask )
+                    for( x = 0; x < size.width; x += len )
                     {
-                        for( x = 0; x <= size.width - 4; x += 4 )
-                        {
-                            int v0 = cvFloor(ptr[x]*a + b);
-                            int v1 = cvFloor(ptr[x+1]*a + b);
+                        len = MIN( size.width - x, ICV_HIST_IDX_BLOCK_SIZE );
+                        icvCalcHistIdx_32f( ptr + x, len, a, b, idx );
 
-                            if( (unsigned)v0 < (unsigned)sz )
-                                bins[v0]++;
-                            if( (unsigned)v1 < (unsigned)sz )
-                                bins[v1]++;
-
-                            v0 = cvFloor(ptr[x+2]*a + b);
-                            v1 = cvFloor(ptr[x+3]*a + b);
-
-                            if( (unsigned)v0 < (unsigned)sz )
-                                bins[v0]++;
-                            if( (unsigned)v1 < (unsigned)sz )
-                                bins[v1]++;
+                        if( !mask )
+                        {
+                            for( j = 0; j < len; j++ )
+                                if( (unsigned)idx[j] < (unsigned)sz )
+                                    bins[idx[j]]++;
                         }
-
-                        for( ; x < size.width; x++ )
+                        else
                         {
-                            int v0 = cvFloor(ptr[x]*a + b);
-                            if( (unsigned)v0 < (unsigned)sz )
-                                bins[v0]++;
+                            for( j = 0; j < len; j++ )
+                                if( mask[x+j] && (unsigned)idx[j] < (unsigned)sz )
+                                    bins[idx[j]]++;
                         }
                     }
-                    else
-                    {
-                        for( x = 0; x < size.width; x++ )
-                            if( mask[x] )
-                            {
-                                int v0 = cvFloor(ptr[x]*a + b);
-                                if( (unsigned)v0 < (unsigned)sz )
-                                    bins[v0]++;
-                            }
+
+                    if( mask )
                         mask += maskStep;
-                    }
                 }
                 }
                 break;
@@ -1209,40 +1344,33 @@ static CvStatus CV_STDCALL
                 double  a1 = uni_range[1][0], b1 = uni_range[1][1];
                 int sz0 = histsize[0], sz1 = histsize[1];
                 int step0 = ((CvMatND*)(hist->bins))->dim[0].step/sizeof(float);
+                int idx0[ICV_HIST_IDX_BLOCK_SIZE], idx1[ICV_HIST_IDX_BLOCK_SIZE];
 
                 for( ; size.height--; img[0] += step, img[1] += step )
                 {
                     float* ptr0 = img[0];
                     float* ptr1 = img[1];
+                    int j, len;
 
-                    if( !mask )
+                    for( x = 0; x < size.width; x += len )
                     {
-                        for( x = 0; x < size.width; x++ )
+                        len = MIN( size.width - x, ICV_HIST_IDX_BLOCK_SIZE );
+                        icvCalcHistIdx_32f( ptr0 + x, len, a0, b0, idx0 );
+                        icvCalcHistIdx_32f( ptr1 + x, len, a1, b1, idx1 );
+
+                        for( j = 0; j < len; j++ )
                         {
-                            int v0 = cvFloor( ptr0[x]*a0 + b0 );
-                            int v1 = cvFloor( ptr1[x]*a1 + b1 );
+                            int v0 = idx0[j], v1 = idx1[j];
 
-                            if( (unsigned)v0 < (unsigned)sz0 &&
+                            if( (!mask || mask[x+j]) &&
+                                (unsigned)v0 < (unsigned)sz0 &&
                                 (unsigned)v1 < (unsigned)sz1 )
                                 bins[v0*step0 + v1]++;
                         }
                     }
-                    else
-                    {
-                        for( x = 0; x < size.width; x++ )
-                        {
-                            if( mask[x] )
-                            {
-                                int v0 = cvFloor( ptr0[x]*a0 + b0 );
-                                int v1 = cvFloor( ptr1[x]*a1 + b1 );
 
-                                if( (unsigned)v0 < (unsigned)sz0 &&
-                                    (unsigned)v1 < (unsigned)sz1 )
-                                    bins[v0*step0 + v1]++;
-                            }
-                        }
+                    if( mask )
                         mask += maskStep;
-                    }
                 }
                 }
                 break;
@@ -1398,22 +1526,30 @@ static CvStatus CV_STDCALL
 }
 
 
-CV_IMPL void
-cvCalcArrHist( CvArr** img, CvHistogram* hist,
-               int do_not_clear, const CvArr* mask )
+/* Input of one histogram calculation, checked by icvInitCalcHistFrame */
+typedef struct CvCalcHistFrame
 {
-    CV_FUNCNAME( "cvCalcHist" );
+    CvHistogram* hist;
+    uchar* ptr[CV_MAX_DIM];
+    uchar* mask;
+    int step, maskstep;
+    int dims, depth;
+    CvSize size;
+}
+CvCalcHistFrame;
+
+
+static void
+icvInitCalcHistFrame( CvArr** img, CvHistogram* hist, const CvArr* mask,
+                      CvCalcHistFrame* frame )
+{
+    CV_FUNCNAME( "icvInitCalcHistFrame" );
 
     __BEGIN__;
 
-    uchar* ptr[CV_MAX_DIM];
-    uchar* maskptr = 0;
-    int maskstep = 0, step = 0;
     int i, dims;
     int cont_flag = -1;
     CvMat stub0, *mat0 = 0;
-    CvMatND dense;
-    CvSize size;
 
     if( !CV_IS_HIST(hist))
         CV_ERROR( CV_StsBadArg, "Bad histogram pointer" );
@@ -1422,7 +1558,12 @@ cvCalcArrHist( CvArr** img, CvHistogram* hist,
         CV_ERROR( CV_StsNullPtr, "Null double array pointer" );
 
     CV_CALL( dims = cvGetDims( hist->bins ));
-    
+
+    frame->hist = hist;
+    frame->dims = dims;
+    frame->mask = 0;
+    frame->maskstep = 0;
+
     for( i = 0; i < dims; i++ )
     {
         CvMat stub, *mat = (CvMat*)img[i];
@@ -1434,7 +1575,7 @@ cvCalcArrHist( CvArr** img, CvHistogram* hist,
         if( i == 0 )
         {
             mat0 = mat;
-            step = mat0->step;
+            frame->step = mat0->step;
         }
         else
         {
@@ -1449,7 +1590,7 @@ cvCalcArrHist( CvArr** img, CvHistogram* hist,
         }
 
         cont_flag &= mat->type;
-        ptr[i] = mat->data.ptr;
+        frame->ptr[i] = mat->data.ptr;
     }
 
     if( mask )
@@ -1463,24 +1604,38 @@ cvCalcArrHist( CvArr** img, CvHistogram* hist,
         if( !CV_ARE_SIZES_EQ( mat0, mat ))
             CV_ERROR( CV_StsUnmatchedSizes,
                 "Mask size does not match to other arrays\' size" );
-        maskptr = mat->data.ptr;
-        maskstep = mat->step;
+        frame->mask = mat->data.ptr;
+        frame->maskstep = mat->step;
         cont_flag &= mat->type;
     }
 
-    size = cvGetMatSize(mat0);
+    frame->size = cvGetMatSize(mat0);
     if( CV_IS_MAT_CONT( cont_flag ))
     {
-        size.width *= size.height;
-        size.height = 1;
-        maskstep = step = CV_STUB_STEP;
+        frame->size.width *= frame->size.height;
+        frame->size.height = 1;
+        frame->maskstep = frame->step = CV_STUB_STEP;
     }
 
-    if( !CV_IS_SPARSE_HIST(hist))
-    {
-        dense = *(CvMatND*)hist->bins;
-        dense.type = (dense.type & ~CV_MAT_TYPE_MASK) | CV_32SC1;
-    }
+    frame->depth = CV_MAT_DEPTH(mat0->type);
+    if( frame->depth != CV_8U && frame->depth != CV_16U && frame->depth != CV_32F )
+        CV_ERROR( CV_StsUnsupportedFormat, "Unsupported array type" );
+
+    if( frame->depth > CV_8S && !CV_HIST_HAS_RANGES(hist))
+        CV_ERROR( CV_StsBadArg, "histogram ranges must be set (via cvSetHistBinRanges) "
+                                "before calling the function" );
+
+    __END__;
+}
+
+
+// Clears the histogram or converts its bins to integer counters
+static void
+icvBeginCalcHist( CvHistogram* hist, int do_not_clear )
+{
+    CV_FUNCNAME( "icvBeginCalcHist" );
+
+    __BEGIN__;
 
     if( !do_not_clear )
     {
@@ -1488,6 +1643,8 @@ cvCalcArrHist( CvArr** img, CvHistogram* hist,
     }
     else if( !CV_IS_SPARSE_HIST(hist))
     {
+        CvMatND dense = *(CvMatND*)hist->bins;
+        dense.type = (dense.type & ~CV_MAT_TYPE_MASK) | CV_32SC1;
         CV_CALL( cvConvert( (CvMatND*)hist->bins, &dense ));
     }
     else
@@ -1504,28 +1661,22 @@ cvCalcArrHist( CvArr** img, CvHistogram* hist,
         }
     }
 
-    if( CV_MAT_DEPTH(mat0->type) > CV_8S && !CV_HIST_HAS_RANGES(hist))
-        CV_ERROR( CV_StsBadArg, "histogram ranges must be set (via cvSetHistBinRanges) "
-                                "before calling the function" );
+    __END__;
+}
 
-    switch( CV_MAT_DEPTH(mat0->type) )
-    {
-    case CV_8U:
-        IPPI_CALL( icvCalcHist_8u_C1R( ptr, step, maskptr, maskstep, size, hist ));
-	    break;
-    case CV_32F:
-        {
-        union { uchar** ptr; float** fl; } v;
-        v.ptr = ptr;
-	    IPPI_CALL( icvCalcHist_32f_C1R( v.fl, step, maskptr, maskstep, size, hist ));
-        }
-	    break;
-    default:
-        CV_ERROR( CV_StsUnsupportedFormat, "Unsupported array type" );
-    }
+
+// Converts the integer counters back to floating-point bins
+static void
+icvEndCalcHist( CvHistogram* hist )
+{
+    CV_FUNCNAME( "icvEndCalcHist" );
+
+    __BEGIN__;
 
     if( !CV_IS_SPARSE_HIST(hist))
     {
+        CvMatND dense = *(CvMatND*)hist->bins;
+        dense.type = (dense.type & ~CV_MAT_TYPE_MASK) | CV_32SC1;
         CV_CALL( cvConvert( &dense, (CvMatND*)hist->bins ));
     }
     else
@@ -1541,275 +1692,462 @@ cvCalcArrHist( CvArr** img, CvHistogram* hist,
             val->f = (float)val->i;
         }
     }
-    
+
     __END__;
 }
 
 
-/***************************** B A C K   P R O J E C T *****************************/
-
-// Calculates back project for one or more 8u arrays
-static CvStatus CV_STDCALL
-    icvCalcBackProject_8u_C1R( uchar** img, int step, uchar* dst, int dstStep,
-                               CvSize size, const CvHistogram* hist )
+/* Accumulates the frame pixels into the (integer) histogram bins using up to
+   <threads> parallel bands. The first band updates the histogram itself,
+   the others count into private zero-initialized copies of the bins that
+   are added to the histogram afterwards. Sparse histograms are processed
+   by a single band */
+static CvStatus
+icvCalcHistFrame( const CvCalcHistFrame* frame, int threads )
 {
-    const int small_hist_size = 1<<12;
+    CvHistogram* hist = frame->hist;
+    CvSize size = frame->size;
+    int dims = frame->dims, depth = frame->depth;
+    int pix_size = CV_ELEM_SIZE(depth);
+    int len = size.height > 1 ? size.height : size.width;
+    int total = size.width*size.height;
     int* tab = 0;
-    int is_sparse = CV_IS_SPARSE_HIST(hist);
-    int dims, histsize[CV_MAX_DIM];
-    int i, x;
-    CvStatus status;
-
-    dims = cvGetDims( hist->bins, histsize );
+    int* bins = 0;
+    int* private_bins = 0;
+    int span = 0, t, i;
+    CvStatus status = CV_OK;
+    CvStatus* band_status;
 
-    tab = (int*)cvStackAlloc( dims*256*sizeof(int));
-    status = icvCalcHistLookupTables8u( hist, dims, histsize, tab );
-    if( status < 0 )
-        return status;
+    if( depth != CV_32F )
+    {
+        status = icvCreateHistLookupTables( hist, depth, &tab, 0 );
+        if( status < 0 )
+        {
+            cvFree( &tab );
+            return status;
+        }
+    }
 
-    if( !is_sparse )
+    if( !CV_IS_SPARSE_HIST(hist))
     {
-        int total = 1;
         CvMatND* mat = (CvMatND*)(hist->bins);
-        float* bins = mat->data.fl;
-        uchar* buffer = 0;
+        bins = mat->data.i;
+        span = mat->dim[0].size*(mat->dim[0].step/sizeof(bins[0]));
 
-        for( i = 0; i < dims; i++ )
-            total *= histsize[i];
+        // each extra band costs a private copy of the bins and its merging
+        if( total < ICV_CALC_HIST_PARALLEL_MIN_SIZE )
+            threads = 1;
+        threads = MIN( threads, total/span );
+    }
+    else
+        threads = 1;
 
-        if( dims <= 3 && total >= -ICV_HIST_DUMMY_IDX )
-            return CV_BADSIZE_ERR; // too big histogram
+    threads = MAX( MIN( threads, len ), 1 );
 
-        if( dims > 1 && total <= small_hist_size && CV_IS_MAT_CONT(mat->type))
+    if( threads > 1 )
+    {
+        private_bins = (int*)cvAlloc( (threads - 1)*span*sizeof(bins[0]));
+        if( !private_bins )
         {
-            buffer = (uchar*)cvAlloc(total);
-            if( !buffer )
-                return CV_OUTOFMEM_ERR;
-            for( i = 0; i < total; i++ )
-            {
-                int v = cvRound(bins[i]);
-                buffer[i] = CV_CAST_8U(v);
-            }
+            cvFree( &tab );
+            return CV_OUTOFMEM_ERR;
         }
+        memset( private_bins, 0, (threads - 1)*span*sizeof(bins[0]));
+    }
+
+    band_status = (CvStatus*)cvStackAlloc( threads*sizeof(band_status[0]) );
+
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(threads), schedule(static)
+#endif
+    for( t = 0; t < threads; t++ )
+    {
+        int y0 = len*t/threads, y1 = len*(t+1)/threads;
+        int* band_bins = t == 0 ? bins : private_bins + (t - 1)*span;
+        union { uchar* ptr[CV_MAX_DIM]; ushort* u[CV_MAX_DIM]; float* fl[CV_MAX_DIM]; } v;
+        uchar* mask = frame->mask;
+        CvSize band_size = size;
+        int j;
+
+        for( j = 0; j < dims; j++ )
+            v.ptr[j] = frame->ptr[j];
 
-        switch( dims )
+        if( size.height > 1 )
         {
-        case 1:
-            {
-            uchar tab1d[256];
-            for( i = 0; i < 256; i++ )
-            {
-                int idx = tab[i];
-                if( idx >= 0 )
-                {
-                    int v = cvRound(bins[idx]);
-                    tab1d[i] = CV_CAST_8U(v);
-                }
-                else
-                    tab1d[i] = 0;
-            }
+            for( j = 0; j < dims; j++ )
+                v.ptr[j] += y0*frame->step;
+            if( mask )
+                mask += y0*frame->maskstep;
+            band_size.height = y1 - y0;
+        }
+        else
+        {
+            for( j = 0; j < dims; j++ )
+                v.ptr[j] += y0*pix_size;
+            if( mask )
+                mask += y0;
+            band_size.width = y1 - y0;
+        }
 
-            for( ; size.height--; img[0] += step, dst += dstStep )
-            {
-                uchar* ptr = img[0];
-                for( x = 0; x <= size.width - 4; x += 4 )
-                {
-                    uchar v0 = tab1d[ptr[x]];
-                    uchar v1 = tab1d[ptr[x+1]];
+        band_status[t] =
+            depth == CV_8U ? icvCalcHist_8u_C1R( v.ptr, frame->step, mask,
+                                 frame->maskstep, band_size, hist, tab, band_bins ) :
+            depth == CV_16U ? icvCalcHist_16u_C1R( v.u, frame->step, mask,
+                                 frame->maskstep, band_size, hist, tab, band_bins ) :
+            icvCalcHist_32f_C1R( v.fl, frame->step, mask,
+                                 frame->maskstep, band_size, hist, band_bins );
+    }
 
-                    dst[x] = v0;
-                    dst[x+1] = v1;
+    for( t = 0; t < threads; t++ )
+    {
+        if( band_status[t] < 0 )
+            status = band_status[t];
+        else if( t > 0 )
+        {
+            const int* src = private_bins + (t - 1)*span;
+            for( i = 0; i < span; i++ )
+                bins[i] += src[i];
+        }
+    }
 
-                    v0 = tab1d[ptr[x+2]];
-                    v1 = tab1d[ptr[x+3]];
+    cvFree( &private_bins );
+    cvFree( &tab );
 
-                    dst[x+2] = v0;
-                    dst[x+3] = v1;
-                }
+    return status;
+}
 
-                for( ; x < size.width; x++ )
-                    dst[x] = tab1d[ptr[x]];
-            }
-            }
-            break;
-        case 2:
-            for( ; size.height--; img[0] += step, img[1] += step, dst += dstStep )
-            {
-                uchar* ptr0 = img[0];
-                uchar* ptr1 = img[1];
 
-                if( buffer )
-                {
-                    for( x = 0; x < size.width; x++ )
-                    {
-                        int v0 = ptr0[x];
-                        int v1 = ptr1[x];
-                        int idx = tab[v0] + tab[256+v1];
-                        int v = 0;
+CV_IMPL void
+cvCalcArrHist( CvArr** img, CvHistogram* hist,
+               int do_not_clear, const CvArr* mask )
+{
+    CV_FUNCNAME( "cvCalcHist" );
 
-                        if( idx >= 0 )
-                            v = buffer[idx];
+    __BEGIN__;
 
-                        dst[x] = (uchar)v;
-                    }
-                }
-                else
-                {
-                    for( x = 0; x < size.width; x++ )
-                    {
-                        int v0 = ptr0[x];
-                        int v1 = ptr1[x];
-                        int idx = tab[v0] + tab[256+v1];
-                        int v = 0;
+    CvCalcHistFrame frame;
 
-                        if( idx >= 0 )
-                        {
-                            v = cvRound(bins[idx]);
-                            v = CV_CAST_8U(v);
-                        }
+    CV_CALL( icvInitCalcHistFrame( img, hist, mask, &frame ));
+    CV_CALL( icvBeginCalcHist( hist, do_not_clear ));
+    IPPI_CALL( icvCalcHistFrame( &frame, cvGetNumThreads() ));
+    CV_CALL( icvEndCalcHist( hist ));
 
-                        dst[x] = (uchar)v;
-                    }
-                }
-            }
-            break;
-        case 3:
-            for( ; size.height--; img[0] += step, img[1] += step,
-                                  img[2] += step, dst += dstStep )
-            {
-                uchar* ptr0 = img[0];
-                uchar* ptr1 = img[1];
-                uchar* ptr2 = img[2];
+    __END__;
+}
 
-                if( buffer )
-                {
-                    for( x = 0; x < size.width; x++ )
-                    {
-                        int v0 = ptr0[x];
-                        int v1 = ptr1[x];
-                        int v2 = ptr2[x];
-                        int idx = tab[v0] + tab[256+v1] + tab[512+v2];
-                        int v = 0;
 
-                        if( idx >= 0 )
-                            v = buffer[idx];
+CV_IMPL void
+cvCalcArrHistBatch( CvArr*** img, CvHistogram** hist, int count,
+                    int do_not_clear, const CvArr** mask )
+{
+    CvCalcHistFrame* frames = 0;
+    CvStatus* frame_status = 0;
+    int begun = 0, ended = 0;
 
-                        dst[x] = (uchar)v;
-                    }
-                }
-                else
-                {
-                    for( x = 0; x < size.width; x++ )
-                    {
-                        int v0 = ptr0[x];
-                        int v1 = ptr1[x];
-                        int v2 = ptr2[x];
-                        int idx = tab[v0] + tab[256+v1] + tab[512+v2];
-                        int v = 0;
+    CV_FUNCNAME( "cvCalcArrHistBatch" );
 
-                        if( idx >= 0 )
-                        {
-                            v = cvRound(bins[idx]);
-                            v = CV_CAST_8U(v);
-                        }
-                        dst[x] = (uchar)v;
-                    }
-                }
-            }
-            break;
-        default:
-            for( ; size.height--; dst += dstStep )
-            {
-                if( buffer )
-                {
-                    for( x = 0; x < size.width; x++ )
-                    {
-                        uchar* binptr = buffer;
-                        int v = 0;
+    __BEGIN__;
 
-                        for( i = 0; i < dims; i++ )
-                        {
-                            int idx = tab[i*256 + img[i][x]];
-                            if( idx < 0 )
-                                break;
-                            binptr += idx;
-                        }
-                        
-                        if( i == dims )
-                            v = binptr[0];
+    int i, j, threads = cvGetNumThreads();
 
-                        dst[x] = (uchar)v;
-                    }
-                }
-                else
-                {
-                    for( x = 0; x < size.width; x++ )
-                    {
-                        float* binptr = bins;
-                        int v = 0;
+    if( !img || !hist )
+        CV_ERROR( CV_StsNullPtr, "Null array or histogram list" );
 
-                        for( i = 0; i < dims; i++ )
-                        {
-                            int idx = tab[i*256 + img[i][x]];
-                            if( idx < 0 )
-                                break;
-                            binptr += idx;
-                        }
+    if( count < 0 )
+        CV_ERROR( CV_StsOutOfRange, "Negative number of frames" );
 
-                        if( i == dims )
-                        {
-                            v = cvRound( binptr[0] );
-                            v = CV_CAST_8U(v);
-                        }
+    if( count == 0 )
+        EXIT;
 
-                        dst[x] = (uchar)v;
-                    }
-                }
+    CV_CALL( frames = (CvCalcHistFrame*)cvAlloc( count*sizeof(frames[0])));
+    CV_CALL( frame_status = (CvStatus*)cvAlloc( count*sizeof(frame_status[0])));
 
-                for( i = 0; i < dims; i++ )
-                    img[i] += step;
-            }
-        }
+    // check all the frames before any histogram is touched
+    for( i = 0; i < count; i++ )
+    {
+        CV_CALL( icvInitCalcHistFrame( img[i], hist[i], mask ? mask[i] : 0, frames + i ));
 
-        cvFree( &buffer );
+        for( j = 0; j < i; j++ )
+            if( hist[j] == hist[i] )
+                CV_ERROR( CV_StsBadArg, "The same histogram is passed for several frames" );
+    }
+
+    for( ; begun < count; begun++ )
+        CV_CALL( icvBeginCalcHist( hist[begun], do_not_clear ));
+
+    // with enough frames, each thread takes whole frames;
+    // otherwise the frames are processed one by one, in parallel bands
+    if( count >= threads )
+    {
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(threads), schedule(dynamic)
+#endif
+        for( i = 0; i < count; i++ )
+            frame_status[i] = icvCalcHistFrame( frames + i, 1 );
     }
     else
     {
-        CvSparseMat* mat = (CvSparseMat*)(hist->bins);
-        int node_idx[CV_MAX_DIM];
+        for( i = 0; i < count; i++ )
+            frame_status[i] = icvCalcHistFrame( frames + i, threads );
+    }
 
-        for( ; size.height--; dst += dstStep )
-        {
-            for( x = 0; x < size.width; x++ )
-            {
-                int v = 0;
+    for( i = 0; i < count; i++ )
+        IPPI_CALL( frame_status[i] );
 
-                for( i = 0; i < dims; i++ )
-                {
-                    int idx = tab[i*256 + img[i][x]];
-                    if( idx < 0 )
-                        break;
-                    node_idx[i] = idx;
-                }
-                if( i == dims )
-                {
-                    float* bin = (float*)cvPtrND( mat, node_idx, 0, 1, 0 );
-                    v = cvRound(bin[0]);
-                    v = CV_CAST_8U(v);
-                }
+    for( ; ended < count; ended++ )
+        CV_CALL( icvEndCalcHist( hist[ended] ));
 
-                dst[x] = (uchar)v;
-            }
+    __END__;
 
-            for( i = 0; i < dims; i++ )
-                img[i] += step;
-        }
+    // after a failure, the histograms that still hold integer counters are
+    // converted back to float bins. The error status is put aside meanwhile,
+    // otherwise the conversion would stop at its first error check
+    if( ended < begun )
+    {
+        int code = cvGetErrStatus();
+        cvSetErrStatus( CV_StsOk );
+        for( ; ended < begun; ended++ )
+            icvEndCalcHist( hist[ended] );
+        cvSetErrStatus( code );
     }
 
-    return CV_OK;
+    cvFree( &frame_status );
+    cvFree( &frames );
+}
+
+
+/***************************** B A C K   P R O J E C T *****************************/
+
+// Calculates back project for one or more 8u or 16u arrays.
+// <buffer> is the output of icvCreateHistLookupTables
+#define ICV_DEF_CALC_BACK_PROJECT_LUT_FUNC( flavor, arrtype, tab_size, cast )  \
+static CvStatus CV_STDCALL                                                     \
+icvCalcBackProject_##flavor##_C1R( arrtype** img, int step, arrtype* dst,      \
+                                   int dstStep, CvSize size,                   \
+                                   const CvHistogram* hist, const int* tab,    \
+                                   const arrtype* buffer )                     \
+{                                                                              \
+    int is_sparse = CV_IS_SPARSE_HIST(hist);                                   \
+    int dims, histsize[CV_MAX_DIM];                                            \
+    int i, x;                                                                  \
+                                                                               \
+    dims = cvGetDims( hist->bins, histsize );                                  \
+    step /= sizeof(img[0][0]);                                                 \
+    dstStep /= sizeof(dst[0]);                                                 \
+                                                                               \
+    if( !is_sparse )                                                           \
+    {                                                                          \
+        CvMatND* mat = (CvMatND*)(hist->bins);                                 \
+        float* bins = mat->data.fl;                                            \
+                                                                               \
+        switch( dims )                                                         \
+        {                                                                      \
+        case 1:                                                                \
+            for( ; size.height--; img[0] += step, dst += dstStep )             \
+            {                                                                  \
+                arrtype* ptr = img[0];                                         \
+                for( x = 0; x <= size.width - 4; x += 4 )                      \
+                {                                                              \
+                    arrtype v0 = buffer[ptr[x]];                               \
+                    arrtype v1 = buffer[ptr[x+1]];                             \
+                                                                               \
+                    dst[x] = v0;                                               \
+                    dst[x+1] = v1;                                             \
+                                                                               \
+                    v0 = buffer[ptr[x+2]];                                     \
+                    v1 = buffer[ptr[x+3]];                                     \
+                                                                               \
+                    dst[x+2] = v0;                                             \
+                    dst[x+3] = v1;                                             \
+                }                                                              \
+                                                                               \
+                for( ; x < size.width; x++ )                                   \
+                    dst[x] = buffer[ptr[x]];                                   \
+            }                                                                  \
+            break;                                                             \
+        case 2:                                                                \
+            for( ; size.height--; img[0] += step, img[1] += step,              \
+                                  dst += dstStep )                             \
+            {                                                                  \
+                arrtype* ptr0 = img[0];                                        \
+                arrtype* ptr1 = img[1];                                        \
+                                                                               \
+                if( buffer )                                                   \
+                {                                                              \
+                    for( x = 0; x < size.width; x++ )                          \
+                    {                                                          \
+                        int v0 = ptr0[x];                                      \
+                        int v1 = ptr1[x];                                      \
+                        int idx = tab[v0] + tab[tab_size+v1];                  \
+                        int v = 0;                                             \
+                                                                               \
+                        if( idx >= 0 )                                         \
+                            v = buffer[idx];                                   \
+                                                                               \
+                        dst[x] = (arrtype)v;                                   \
+                    }                                                          \
+                }                                                              \
+                else                                                           \
+                {                                                              \
+                    for( x = 0; x < size.width; x++ )                          \
+                    {                                                          \
+                        int v0 = ptr0[x];                                      \
+                        int v1 = ptr1[x];                                      \
+                        int idx = tab[v0] + tab[tab_size+v1];                  \
+                        int v = 0;                                             \
+                                                                               \
+                        if( idx >= 0 )                                         \
+                        {                                                      \
+                            v = cvRound(bins[idx]);                            \
+                            v = cast(v);                                       \
+                        }                                                      \
+                                                                               \
+                        dst[x] = (arrtype)v;                                   \
+                    }                                                          \
+                }                                                              \
+            }                                                                  \
+            break;                                                             \
+        case 3:                                                                \
+            for( ; size.height--; img[0] += step, img[1] += step,              \
+                                  img[2] += step, dst += dstStep )             \
+            {                                                                  \
+                arrtype* ptr0 = img[0];                                        \
+                arrtype* ptr1 = img[1];                                        \
+                arrtype* ptr2 = img[2];                                        \
+                                                                               \
+                if( buffer )                                                   \
+                {                                                              \
+                    for( x = 0; x < size.width; x++ )                          \
+                    {                                                          \
+                        int v0 = ptr0[x];                                      \
+                        int v1 = ptr1[x];                                      \
+                        int v2 = ptr2[x];                                      \
+                        int idx = tab[v0] + tab[tab_size+v1] +                 \
+                                  tab[tab_size*2+v2];                          \
+                        int v = 0;                                             \
+                                                                               \
+                        if( idx >= 0 )                                         \
+                            v = buffer[idx];                                   \
+                                                                               \
+                        dst[x] = (arrtype)v;                                   \
+                    }                                                          \
+                }                                                              \
+                else                                                           \
+                {                                                              \
+                    for( x = 0; x < size.width; x++ )                          \
+                    {                                                          \
+                        int v0 = ptr0[x];                                      \
+                        int v1 = ptr1[x];                                      \
+                        int v2 = ptr2[x];                                      \
+                        int idx = tab[v0] + tab[tab_size+v1] +                 \
+                                  tab[tab_size*2+v2];                          \
+                        int v = 0;                                             \
+                                                                               \
+                        if( idx >= 0 )                                         \
+                        {                                                      \
+                            v = cvRound(bins[idx]);                            \
+                            v = cast(v);                                       \
+                        }                                                      \
+                        dst[x] = (arrtype)v;                                   \
+                    }                                                          \
+                }                                                              \
+            }                                                                  \
+            break;                                                             \
+        default:                                                               \
+            for( ; size.height--; dst += dstStep )                             \
+            {                                                                  \
+                if( buffer )                                                   \
+                {                                                              \
+                    for( x = 0; x < size.width; x++ )                          \
+                    {                                                          \
+                        const arrtype* binptr = buffer;                        \
+                        int v = 0;                                             \
+                                                                               \
+                        for( i = 0; i < dims; i++ )                            \
+                        {                                                      \
+                            int idx = tab[i*tab_size + img[i][x]];             \
+                            if( idx < 0 )                                      \
+                                break;                                         \
+                            binptr += idx;                                     \
+                        }                                                      \
+                                                                               \
+                        if( i == dims )                                        \
+                            v = binptr[0];                                     \
+                                                                               \
+                        dst[x] = (arrtype)v;                                   \
+                    }                                                          \
+                }                                                              \
+                else                                                           \
+                {                                                              \
+                    for( x = 0; x < size.width; x++ )                          \
+                    {                                                          \
+                        float* binptr = bins;                                  \
+                        int v = 0;                                             \
+                                                                               \
+                        for( i = 0; i < dims; i++ )                            \
+                        {                                                      \
+                            int idx = tab[i*tab_size + img[i][x]];             \
+                            if( idx < 0 )                                      \
+                                break;                                         \
+                            binptr += idx;                                     \
+                        }                                                      \
+                                                                               \
+                        if( i == dims )                                        \
+                        {                                                      \
+                            v = cvRound( binptr[0] );                          \
+                            v = cast(v);                                       \
+                        }                                                      \
+                                                                               \
+                        dst[x] = (arrtype)v;                                   \
+                    }                                                          \
+                }                                                              \
+                                                                               \
+                for( i = 0; i < dims; i++ )                                    \
+                    img[i] += step;                                            \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+    else                                                                       \
+    {                                                                          \
+        CvSparseMat* mat = (CvSparseMat*)(hist->bins);                         \
+        int node_idx[CV_MAX_DIM];                                              \
+                                                                               \
+        for( ; size.height--; dst += dstStep )                                 \
+        {                                                                      \
+            for( x = 0; x < size.width; x++ )                                  \
+            {                                                                  \
+                int v = 0;                                                     \
+                                                                               \
+                for( i = 0; i < dims; i++ )                                    \
+                {                                                              \
+                    int idx = tab[i*tab_size + img[i][x]];                     \
+                    if( idx < 0 )                                              \
+                        break;                                                 \
+                    node_idx[i] = idx;                                         \
+                }                                                              \
+                if( i == dims )                                                \
+                {                                                              \
+                    float* bin = (float*)cvPtrND( mat, node_idx, 0, 1, 0 );    \
+                    v = cvRound(bin[0]);                                       \
+                    v = cast(v);                                               \
+                }                                                              \
+                                                                               \
+                dst[x] = (arrtype)v;                                           \
+            }                                                                  \
+                                                                               \
+            for( i = 0; i < dims; i++ )                                        \
+                img[i] += step;                                                \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    return CV_OK;                                                              \
 }
 
 
+ICV_DEF_CALC_BACK_PROJECT_LUT_FUNC( 8u, uchar, 256, CV_CAST_8U )
+ICV_DEF_CALC_BACK_PROJECT_LUT_FUNC( 16u, ushort, 65536, CV_CAST_16U )
+
+
 // Calculates back project for one or more 32f arrays
 static CvStatus CV_STDCALL
     icvCalcBackProject_32f_C1R( float** img, int step, float* dst, int dstStep,
@@ -1849,48 +2187,23 @@ static CvStatus CV_STDCALL
                 {
                 double a = uni_range[0][0], b = uni_range[0][1];
                 int sz = histsize[0];
+                int idx[ICV_HIST_IDX_BLOCK_SIZE];
 
                 for( ; size.height--; img[0] += step, dst += dstStep )
                 {
                     float* ptr = img[0];
+                    int j, len;
 
-                    for( x = 0; x <= size.width - 4; x += 4 )
+                    for( x = 0; x < size.width; x += len )
                     {
-                        int v0 = cvFloor(ptr[x]*a + b);
-                        int v1 = cvFloor(ptr[x+1]*a + b);
-
-                        if( (unsigned)v0 < (unsigned)sz )
-                            dst[x] = bins[v0];
-                        else
-                            dst[x] = 0;
-
-                        if( (unsigned)v1 < (unsigned)sz )
-                            dst[x+1] = bins[v1];
-                        else
-                            dst[x+1] = 0;
-
-                        v0 = cvFloor(ptr[x+2]*a + b);
-                        v1 = cvFloor(ptr[x+3]*a + b);
+                        len = MIN( size.width - x, ICV_HIST_IDX_BLOCK_SIZE );
+                        icvCalcHistIdx_32f( ptr + x, len, a, b, idx );
 
-                        if( (unsigned)v0 < (unsigned)sz )
-                            dst[x+2] = bins[v0];
-                        else
-                            dst[x+2] = 0;
-
-                        if( (unsigned)v1 < (unsigned)sz )
-                            dst[x+3] = bins[v1];
-                        else
-                            dst[x+3] = 0;
-                    }
-
-                    for( ; x < size.width; x++ )
-                    {
-                        int v0 = cvFloor(ptr[x]*a + b);
-
-                        if( (unsigned)v0 < (unsigned)sz )
-                            dst[x] = bins[v0];
-                        else
-                            dst[x] = 0;
+                        for( j = 0; j < len; j++ )
+                        {
+                            int v0 = idx[j];
+                            dst[x+j] = (unsigned)v0 < (unsigned)sz ? bins[v0] : 0.f;
+                        }
                     }
                 }
                 }
@@ -1901,22 +2214,30 @@ static CvStatus CV_STDCALL
                 double a1 = uni_range[1][0], b1 = uni_range[1][1];
                 int sz0 = histsize[0], sz1 = histsize[1];
                 int step0 = ((CvMatND*)(hist->bins))->dim[0].step/sizeof(float);
+                int idx0[ICV_HIST_IDX_BLOCK_SIZE], idx1[ICV_HIST_IDX_BLOCK_SIZE];
 
                 for( ; size.height--; img[0] += step, img[1] += step, dst += dstStep )
                 {
                     float* ptr0 = img[0];
                     float* ptr1 = img[1];
+                    int j, len;
 
-                    for( x = 0; x < size.width; x++ )
+                    for( x = 0; x < size.width; x += len )
                     {
-                        int v0 = cvFloor( ptr0[x]*a0 + b0 );
-                        int v1 = cvFloor( ptr1[x]*a1 + b1 );
+                        len = MIN( size.width - x, ICV_HIST_IDX_BLOCK_SIZE );
+                        icvCalcHistIdx_32f( ptr0 + x, len, a0, b0, idx0 );
+                        icvCalcHistIdx_32f( ptr1 + x, len, a1, b1, idx1 );
 
-                        if( (unsigned)v0 < (unsigned)sz0 &&
-                            (unsigned)v1 < (unsigned)sz1 )
-                            dst[x] = bins[v0*step0 + v1];
-                        else
-                            dst[x] = 0;
+                        for( j = 0; j < len; j++ )
+                        {
+                            int v0 = idx0[j], v1 = idx1[j];
+
+                            if( (unsigned)v0 < (unsigned)sz0 &&
+                                (unsigned)v1 < (unsigned)sz1 )
+                                dst[x+j] = bins[v0*step0 + v1];
+                            else
+                                dst[x+j] = 0;
+                        }
                     }
                 }
                 }
@@ -1941,10 +2262,10 @@ static CvStatus CV_STDCALL
                         else
                             dst[x] = 0;
                     }
-                }
 
-                for( i = 0; i < dims; i++ )
-                    img[i] += step;
+                    for( i = 0; i < dims; i++ )
+                        img[i] += step;
+                }
             }
         }
         else
@@ -2044,6 +2365,87 @@ static CvStatus CV_STDCALL
 }
 
 
+/* Back-projects the arrays in up to <threads> parallel bands
+   (a single band for sparse histograms, which are updated on lookup) */
+static CvStatus
+icvCalcBackProjectBands( uchar** ptr, int step, uchar* dstptr, int dststep,
+                         CvSize size, int depth, const CvHistogram* hist,
+                         int threads )
+{
+    int dims = cvGetDims( hist->bins );
+    int pix_size = CV_ELEM_SIZE(depth);
+    int len = size.height > 1 ? size.height : size.width;
+    int* tab = 0;
+    void* buffer = 0;
+    int t;
+    CvStatus status = CV_OK;
+    CvStatus* band_status;
+
+    if( depth != CV_32F )
+    {
+        status = icvCreateHistLookupTables( hist, depth, &tab, &buffer );
+        if( status < 0 )
+        {
+            cvFree( &buffer );
+            cvFree( &tab );
+            return status;
+        }
+    }
+
+    if( CV_IS_SPARSE_HIST(hist) || size.width*size.height < ICV_CALC_HIST_PARALLEL_MIN_SIZE )
+        threads = 1;
+    threads = MAX( MIN( threads, len ), 1 );
+    band_status = (CvStatus*)cvStackAlloc( threads*sizeof(band_status[0]) );
+
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(threads), schedule(static)
+#endif
+    for( t = 0; t < threads; t++ )
+    {
+        int y0 = len*t/threads, y1 = len*(t+1)/threads;
+        union { uchar* ptr[CV_MAX_DIM]; ushort* u[CV_MAX_DIM]; float* fl[CV_MAX_DIM]; } v;
+        uchar* dst = dstptr;
+        CvSize band_size = size;
+        int j;
+
+        for( j = 0; j < dims; j++ )
+            v.ptr[j] = ptr[j];
+
+        if( size.height > 1 )
+        {
+            for( j = 0; j < dims; j++ )
+                v.ptr[j] += y0*step;
+            dst += y0*dststep;
+            band_size.height = y1 - y0;
+        }
+        else
+        {
+            for( j = 0; j < dims; j++ )
+                v.ptr[j] += y0*pix_size;
+            dst += y0*pix_size;
+            band_size.width = y1 - y0;
+        }
+
+        band_status[t] =
+            depth == CV_8U ? icvCalcBackProject_8u_C1R( v.ptr, step, dst, dststep,
+                                 band_size, hist, tab, (const uchar*)buffer ) :
+            depth == CV_16U ? icvCalcBackProject_16u_C1R( v.u, step, (ushort*)dst,
+                                 dststep, band_size, hist, tab, (const ushort*)buffer ) :
+            icvCalcBackProject_32f_C1R( v.fl, step, (float*)dst, dststep,
+                                        band_size, hist );
+    }
+
+    for( t = 0; t < threads; t++ )
+        if( band_status[t] < 0 )
+            status = band_status[t];
+
+    cvFree( &buffer );
+    cvFree( &tab );
+
+    return status;
+}
+
+
 CV_IMPL void
 cvCalcArrBackProject( CvArr** img, CvArr* dst, const CvHistogram* hist )
 {
@@ -2054,7 +2456,7 @@ cvCalcArrBackProject( CvArr** img, CvArr* dst, const CvHistogram* hist )
     uchar* ptr[CV_MAX_DIM];
     uchar* dstptr = 0;
     int dststep = 0, step = 0;
-    int i, dims;
+    int i, dims, depth;
     int cont_flag = -1;
     CvMat stub0, *mat0 = 0;
     CvSize size;
@@ -2066,7 +2468,7 @@ cvCalcArrBackProject( CvArr** img, CvArr* dst, const CvHistogram* hist )
         CV_ERROR( CV_StsNullPtr, "Null double array pointer" );
 
     CV_CALL( dims = cvGetDims( hist->bins ));
-    
+
     for( i = 0; i <= dims; i++ )
     {
         CvMat stub, *mat = (CvMat*)(i < dims ? img[i] : dst);
@@ -2110,26 +2512,16 @@ cvCalcArrBackProject( CvArr** img, CvArr* dst, const CvHistogram* hist )
         dststep = step = CV_STUB_STEP;
     }
 
-    if( CV_MAT_DEPTH(mat0->type) > CV_8S && !CV_HIST_HAS_RANGES(hist))
+    depth = CV_MAT_DEPTH(mat0->type);
+    if( depth != CV_8U && depth != CV_16U && depth != CV_32F )
+        CV_ERROR( CV_StsUnsupportedFormat, "Unsupported array type" );
+
+    if( depth > CV_8S && !CV_HIST_HAS_RANGES(hist))
         CV_ERROR( CV_StsBadArg, "histogram ranges must be set (via cvSetHistBinRanges) "
                                 "before calling the function" );
 
-    switch( CV_MAT_DEPTH(mat0->type) )
-    {
-    case CV_8U:
-        IPPI_CALL( icvCalcBackProject_8u_C1R( ptr, step, dstptr, dststep, size, hist ));
-	    break;
-    case CV_32F:
-        {
-        union { uchar** ptr; float** fl; } v;
-        v.ptr = ptr;
-	    IPPI_CALL( icvCalcBackProject_32f_C1R( v.fl, step,
-                                (float*)dstptr, dststep, size, hist ));
-        }
-	    break;
-    default:
-        CV_ERROR( CV_StsUnsupportedFormat, "Unsupported array type" );
-    }
+    IPPI_CALL( icvCalcBackProjectBands( ptr, step, dstptr, dststep, size,
+                                        depth, hist, cvGetNumThreads() ));
 
     __END__;
 }
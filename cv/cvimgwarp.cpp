@@ -953,7 +953,7 @@ icvWarpAffine_Bilinear_##flavor##_CnR(                                      \
     const arrtype* src, int step, CvSize ssize,                             \
     arrtype* dst, int dststep, CvSize dsize,                                \
     const double* matrix, int cn,                                           \
-    const arrtype* fillval, const int* ofs )                                \
+    const arrtype* fillval, const int* ofs, int ystart )                    \
 {                                                                           \
     int x, y, k;                                                            \
     double  A12 = matrix[1], b1 = matrix[2];                                \
@@ -962,7 +962,7 @@ icvWarpAffine_Bilinear_##flavor##_CnR(                                      \
     step /= sizeof(src[0]);                                                 \
     dststep /= sizeof(dst[0]);                                              \
                                                                             \
-    for( y = 0; y < dsize.height; y++, dst += dststep )                     \
+    for( y = ystart; y < ystart + dsize.height; y++, dst += dststep )       \
     {                                                                       \
         int xs = CV_FLT_TO_FIX( A12*y + b1, ICV_WARP_SHIFT );               \
         int ys = CV_FLT_TO_FIX( A22*y + b2, ICV_WARP_SHIFT );               \
@@ -1036,17 +1036,371 @@ ICV_DEF_WARP_AFFINE_BILINEAR_FUNC( 32f, float, double, ICV_WARP_SCALE_ALPHA, CV_
                                    CV_NOP, CV_NOP )
 
 
+/* Bicubic interpolation of destination pixel x at the fixed-point source
+   position (ixs, iys). Taps that fall outside the image replicate the edge;
+   pixels further than one pixel outside are outliers, as in the bilinear case. */
+#define ICV_WARP_BICUBIC_PIXEL( arrtype, load_macro, cast_macro1, cast_macro2 )  \
+{                                                                           \
+    int ifx = ixs & ICV_WARP_MASK, ify = iys & ICV_WARP_MASK;               \
+    ixs >>= ICV_WARP_SHIFT;                                                 \
+    iys >>= ICV_WARP_SHIFT;                                                 \
+                                                                            \
+    if( (unsigned)(ixs+1) < (unsigned)(ssize.width+1) &&                    \
+        (unsigned)(iys+1) < (unsigned)(ssize.height+1))                     \
+    {                                                                       \
+        float wx[4], wy[4];                                                 \
+        const arrtype* row[4];                                              \
+        int xo[4];                                                          \
+                                                                            \
+        wx[0] = icvCubicCoeffs[ifx*2 + 1];                                  \
+        wx[1] = icvCubicCoeffs[ifx*2];                                      \
+        wx[2] = icvCubicCoeffs[(ICV_CUBIC_TAB_SIZE-ifx)*2];                 \
+        wx[3] = icvCubicCoeffs[(ICV_CUBIC_TAB_SIZE-ifx)*2+1];               \
+        wy[0] = icvCubicCoeffs[ify*2 + 1];                                  \
+        wy[1] = icvCubicCoeffs[ify*2];                                      \
+        wy[2] = icvCubicCoeffs[(ICV_CUBIC_TAB_SIZE-ify)*2];                 \
+        wy[3] = icvCubicCoeffs[(ICV_CUBIC_TAB_SIZE-ify)*2+1];               \
+                                                                            \
+        for( j = 0; j < 4; j++ )                                            \
+        {                                                                   \
+            row[j] = src + ICV_WARP_CLIP_Y( iys + j - 1 )*step;             \
+            xo[j] = ICV_WARP_CLIP_X( ixs + j - 1 )*cn;                      \
+        }                                                                   \
+                                                                            \
+        for( k = 0; k < cn; k++ )                                           \
+        {                                                                   \
+            float t = 0;                                                    \
+            for( j = 0; j < 4; j++ )                                        \
+            {                                                               \
+                const arrtype* r = row[j] + k;                              \
+                t += wy[j]*(load_macro(r[xo[0]])*wx[0] +                    \
+                            load_macro(r[xo[1]])*wx[1] +                    \
+                            load_macro(r[xo[2]])*wx[2] +                    \
+                            load_macro(r[xo[3]])*wx[3]);                    \
+            }                                                               \
+            dst[x*cn+k] = cast_macro2( cast_macro1(t) );                    \
+        }                                                                   \
+    }                                                                       \
+    else if( fillval )                                                      \
+        for( k = 0; k < cn; k++ )                                           \
+            dst[x*cn+k] = fillval[k];                                       \
+}
+
+
+#define ICV_DEF_WARP_AFFINE_BICUBIC_FUNC( flavor, arrtype, load_macro,      \
+                                          cast_macro1, cast_macro2 )        \
+static CvStatus CV_STDCALL                                                  \
+icvWarpAffine_Bicubic_##flavor##_CnR(                                       \
+    const arrtype* src, int step, CvSize ssize,                             \
+    arrtype* dst, int dststep, CvSize dsize,                                \
+    const double* matrix, int cn,                                           \
+    const arrtype* fillval, const int* ofs, int ystart )                    \
+{                                                                           \
+    int x, y, j, k;                                                         \
+    double  A12 = matrix[1], b1 = matrix[2];                                \
+    double  A22 = matrix[4], b2 = matrix[5];                                \
+                                                                            \
+    step /= sizeof(src[0]);                                                 \
+    dststep /= sizeof(dst[0]);                                              \
+                                                                            \
+    for( y = ystart; y < ystart + dsize.height; y++, dst += dststep )       \
+    {                                                                       \
+        int xs = CV_FLT_TO_FIX( A12*y + b1, ICV_WARP_SHIFT );               \
+        int ys = CV_FLT_TO_FIX( A22*y + b2, ICV_WARP_SHIFT );               \
+                                                                            \
+        for( x = 0; x < dsize.width; x++ )                                  \
+        {                                                                   \
+            int ixs = xs + ofs[x*2];                                        \
+            int iys = ys + ofs[x*2+1];                                      \
+            ICV_WARP_BICUBIC_PIXEL( arrtype, load_macro,                    \
+                                    cast_macro1, cast_macro2 )              \
+        }                                                                   \
+    }                                                                       \
+                                                                            \
+    return CV_OK;                                                           \
+}
+
+
+ICV_DEF_WARP_AFFINE_BICUBIC_FUNC( 8u, uchar, CV_8TO32F, cvRound, CV_FAST_CAST_8U )
+ICV_DEF_WARP_AFFINE_BICUBIC_FUNC( 16u, ushort, CV_NOP, cvRound, CV_CAST_16U )
+ICV_DEF_WARP_AFFINE_BICUBIC_FUNC( 32f, float, CV_NOP, CV_NOP, CV_NOP )
+
+
+#if CV_SSE2
+/* 8uC4 bilinear warp with the same integer arithmetic as
+   icvWarpAffine_Bilinear_8u_CnR: the horizontal pass is one _mm_madd_epi16
+   per source row, the vertical one is done in 32 bits with _mm_mul_epu32 */
+static CvStatus CV_STDCALL
+icvWarpAffine_Bilinear_8u_C4R_SSE2( const uchar* src, int step, CvSize ssize,
+                                    uchar* dst, int dststep, CvSize dsize,
+                                    const double* matrix, int, const uchar* fillval,
+                                    const int* ofs, int ystart )
+{
+    const __m128i z = _mm_setzero_si128();
+    const __m128i lo = _mm_set_epi32( 0, -1, 0, -1 );
+    const __m128i delta = _mm_set1_epi32( 1 << (ICV_WARP_SHIFT*2-1) );
+    const int one = 1 << ICV_WARP_SHIFT;
+    int x, y, k, cn = 4;
+    double  A12 = matrix[1], b1 = matrix[2];
+    double  A22 = matrix[4], b2 = matrix[5];
+
+    for( y = ystart; y < ystart + dsize.height; y++, dst += dststep )
+    {
+        int xs = CV_FLT_TO_FIX( A12*y + b1, ICV_WARP_SHIFT );
+        int ys = CV_FLT_TO_FIX( A22*y + b2, ICV_WARP_SHIFT );
+
+        for( x = 0; x < dsize.width; x++ )
+        {
+            int ixs = xs + ofs[x*2];
+            int iys = ys + ofs[x*2+1];
+            int a = ixs & ICV_WARP_MASK;
+            int b = iys & ICV_WARP_MASK;
+            ixs >>= ICV_WARP_SHIFT;
+            iys >>= ICV_WARP_SHIFT;
+
+            if( (unsigned)ixs < (unsigned)(ssize.width - 1) &&
+                (unsigned)iys < (unsigned)(ssize.height - 1) )
+            {
+                const uchar* ptr = src + step*iys + ixs*4;
+                __m128i wa = _mm_set1_epi32( (a << 16) | (one - a) );
+                __m128i wb0 = _mm_set1_epi32( one - b ), wb1 = _mm_set1_epi32( b );
+                __m128i r0 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)ptr ), z );
+                __m128i r1 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(ptr + step) ), z );
+                __m128i p0 = _mm_madd_epi16( _mm_unpacklo_epi16( r0, _mm_srli_si128( r0, 8 )), wa );
+                __m128i p1 = _mm_madd_epi16( _mm_unpacklo_epi16( r1, _mm_srli_si128( r1, 8 )), wa );
+                __m128i e = _mm_add_epi64( _mm_mul_epu32( p0, wb0 ), _mm_mul_epu32( p1, wb1 ));
+                __m128i o = _mm_add_epi64( _mm_mul_epu32( _mm_srli_epi64( p0, 32 ), wb0 ),
+                                           _mm_mul_epu32( _mm_srli_epi64( p1, 32 ), wb1 ));
+                __m128i v = _mm_or_si128( _mm_and_si128( e, lo ), _mm_slli_epi64( o, 32 ));
+
+                v = _mm_srli_epi32( _mm_add_epi32( v, delta ), ICV_WARP_SHIFT*2 );
+                v = _mm_packs_epi32( v, v );
+                *(int*)(dst + x*4) = _mm_cvtsi128_si32( _mm_packus_epi16( v, v ));
+            }
+            else if( (unsigned)(ixs+1) < (unsigned)(ssize.width+1) &&
+                     (unsigned)(iys+1) < (unsigned)(ssize.height+1))
+            {
+                int x0 = ICV_WARP_CLIP_X( ixs );
+                int y0 = ICV_WARP_CLIP_Y( iys );
+                int x1 = ICV_WARP_CLIP_X( ixs + 1 );
+                int y1 = ICV_WARP_CLIP_Y( iys + 1 );
+                const uchar* ptr0 = src + y0*step + x0*cn;
+                const uchar* ptr1 = src + y0*step + x1*cn;
+                const uchar* ptr2 = src + y1*step + x0*cn;
+                const uchar* ptr3 = src + y1*step + x1*cn;
+
+                for( k = 0; k < cn; k++ )
+                {
+                    int p0 = ICV_WARP_MUL_ONE_8U(ptr0[k]) + a * (ptr1[k] - ptr0[k]);
+                    int p1 = ICV_WARP_MUL_ONE_8U(ptr2[k]) + a * (ptr3[k] - ptr2[k]);
+                    dst[x*cn+k] = (uchar)ICV_WARP_DESCALE_8U( ICV_WARP_MUL_ONE_8U(p0) + b*(p1 - p0) );
+                }
+            }
+            else if( fillval )
+                *(int*)(dst + x*4) = *(const int*)fillval;
+        }
+    }
+
+    return CV_OK;
+}
+
+
+static inline __m128i icvLoad4_16u_32s( const ushort* p )
+{
+    return _mm_unpacklo_epi16( _mm_loadl_epi64( (const __m128i*)p ), _mm_setzero_si128() );
+}
+
+/* saturates four ints to ushort; SSE2 has no unsigned 32->16 pack,
+   so the values are biased into the signed range and back */
+static inline void icvStore4_16u_32s( ushort* p, __m128i v )
+{
+    v = _mm_sub_epi32( v, _mm_set1_epi32( 32768 ));
+    v = _mm_add_epi16( _mm_packs_epi32( v, v ), _mm_set1_epi16( (short)0x8000 ));
+    _mm_storel_epi64( (__m128i*)p, v );
+}
+
+static inline __m128 icvLoad4_16u( const ushort* p )
+{
+    return _mm_cvtepi32_ps( icvLoad4_16u_32s( p ));
+}
+
+static inline void icvStore4_16u( ushort* p, __m128 v )
+{
+    icvStore4_16u_32s( p, _mm_cvtps_epi32( v ));
+}
+
+/* bilinear blend of two channels in double precision, the way
+   icvWarpAffine_Bilinear_16u_CnR does it */
+static inline __m128i icvBlend2_64f( __m128i i0, __m128i i1, __m128i i2, __m128i i3,
+                                     __m128d a, __m128d b )
+{
+    __m128d s0 = _mm_cvtepi32_pd( i0 ), s2 = _mm_cvtepi32_pd( i2 );
+    __m128d p0 = _mm_add_pd( s0, _mm_mul_pd( a, _mm_sub_pd( _mm_cvtepi32_pd( i1 ), s0 )));
+    __m128d p1 = _mm_add_pd( s2, _mm_mul_pd( a, _mm_sub_pd( _mm_cvtepi32_pd( i3 ), s2 )));
+    return _mm_cvtpd_epi32( _mm_add_pd( p0, _mm_mul_pd( b, _mm_sub_pd( p1, p0 ))));
+}
+
+/* 16uC4 bilinear warp, bit-exact with icvWarpAffine_Bilinear_16u_CnR */
+static CvStatus CV_STDCALL
+icvWarpAffine_Bilinear_16u_C4R_SSE2( const ushort* src, int step, CvSize ssize,
+                                     ushort* dst, int dststep, CvSize dsize,
+                                     const double* matrix, int, const ushort* fillval,
+                                     const int* ofs, int ystart )
+{
+    const double scale = 1./(ICV_WARP_MASK+1);
+    int x, y;
+    double  A12 = matrix[1], b1 = matrix[2];
+    double  A22 = matrix[4], b2 = matrix[5];
+
+    step /= sizeof(src[0]);
+    dststep /= sizeof(dst[0]);
+
+    for( y = ystart; y < ystart + dsize.height; y++, dst += dststep )
+    {
+        int xs = CV_FLT_TO_FIX( A12*y + b1, ICV_WARP_SHIFT );
+        int ys = CV_FLT_TO_FIX( A22*y + b2, ICV_WARP_SHIFT );
+
+        for( x = 0; x < dsize.width; x++ )
+        {
+            int ixs = xs + ofs[x*2];
+            int iys = ys + ofs[x*2+1];
+            __m128d a = _mm_set1_pd( (ixs & ICV_WARP_MASK)*scale );
+            __m128d b = _mm_set1_pd( (iys & ICV_WARP_MASK)*scale );
+            const ushort *ptr0, *ptr1, *ptr2, *ptr3;
+            ixs >>= ICV_WARP_SHIFT;
+            iys >>= ICV_WARP_SHIFT;
+
+            if( (unsigned)ixs < (unsigned)(ssize.width - 1) &&
+                (unsigned)iys < (unsigned)(ssize.height - 1) )
+            {
+                ptr0 = src + step*iys + ixs*4;
+                ptr1 = ptr0 + 4;
+                ptr2 = ptr0 + step;
+                ptr3 = ptr2 + 4;
+            }
+            else if( (unsigned)(ixs+1) < (unsigned)(ssize.width+1) &&
+                     (unsigned)(iys+1) < (unsigned)(ssize.height+1))
+            {
+                int x0 = ICV_WARP_CLIP_X( ixs );
+                int y0 = ICV_WARP_CLIP_Y( iys );
+                int x1 = ICV_WARP_CLIP_X( ixs + 1 );
+                int y1 = ICV_WARP_CLIP_Y( iys + 1 );
+
+                ptr0 = src + y0*step + x0*4;
+                ptr1 = src + y0*step + x1*4;
+                ptr2 = src + y1*step + x0*4;
+                ptr3 = src + y1*step + x1*4;
+            }
+            else
+            {
+                if( fillval )
+                    memcpy( dst + x*4, fillval, 4*sizeof(dst[0]) );
+                continue;
+            }
+
+            {
+                __m128i i0 = icvLoad4_16u_32s( ptr0 ), i1 = icvLoad4_16u_32s( ptr1 );
+                __m128i i2 = icvLoad4_16u_32s( ptr2 ), i3 = icvLoad4_16u_32s( ptr3 );
+                __m128i v0 = icvBlend2_64f( i0, i1, i2, i3, a, b );
+                __m128i v1 = icvBlend2_64f( _mm_srli_si128( i0, 8 ), _mm_srli_si128( i1, 8 ),
+                                            _mm_srli_si128( i2, 8 ), _mm_srli_si128( i3, 8 ), a, b );
+                icvStore4_16u_32s( dst + x*4, _mm_unpacklo_epi64( v0, v1 ));
+            }
+        }
+    }
+
+    return CV_OK;
+}
+
+
+/* 16uC4 version of ICV_WARP_BICUBIC_PIXEL: the same weights, tap order and
+   float accumulation, with the four channels of a pixel in one register */
+static inline void
+icvWarpBicubicPixel_16u_C4_SSE2( const ushort* src, int step, CvSize ssize,
+                                 int ixs, int iys, ushort* dst, const ushort* fillval )
+{
+    int ifx = ixs & ICV_WARP_MASK, ify = iys & ICV_WARP_MASK;
+    ixs >>= ICV_WARP_SHIFT;
+    iys >>= ICV_WARP_SHIFT;
+
+    if( (unsigned)(ixs+1) < (unsigned)(ssize.width+1) &&
+        (unsigned)(iys+1) < (unsigned)(ssize.height+1))
+    {
+        __m128 wx0 = _mm_set1_ps( icvCubicCoeffs[ifx*2 + 1] );
+        __m128 wx1 = _mm_set1_ps( icvCubicCoeffs[ifx*2] );
+        __m128 wx2 = _mm_set1_ps( icvCubicCoeffs[(ICV_CUBIC_TAB_SIZE-ifx)*2] );
+        __m128 wx3 = _mm_set1_ps( icvCubicCoeffs[(ICV_CUBIC_TAB_SIZE-ifx)*2+1] );
+        float wy[4];
+        int x0 = ICV_WARP_CLIP_X( ixs - 1 )*4, x1 = ICV_WARP_CLIP_X( ixs )*4;
+        int x2 = ICV_WARP_CLIP_X( ixs + 1 )*4, x3 = ICV_WARP_CLIP_X( ixs + 2 )*4;
+        __m128 t = _mm_setzero_ps();
+        int j;
+
+        wy[0] = icvCubicCoeffs[ify*2 + 1];
+        wy[1] = icvCubicCoeffs[ify*2];
+        wy[2] = icvCubicCoeffs[(ICV_CUBIC_TAB_SIZE-ify)*2];
+        wy[3] = icvCubicCoeffs[(ICV_CUBIC_TAB_SIZE-ify)*2+1];
+
+        for( j = 0; j < 4; j++ )
+        {
+            const ushort* r = src + ICV_WARP_CLIP_Y( iys + j - 1 )*step;
+            __m128 h = _mm_add_ps( _mm_add_ps( _mm_add_ps(
+                           _mm_mul_ps( icvLoad4_16u( r + x0 ), wx0 ),
+                           _mm_mul_ps( icvLoad4_16u( r + x1 ), wx1 )),
+                           _mm_mul_ps( icvLoad4_16u( r + x2 ), wx2 )),
+                           _mm_mul_ps( icvLoad4_16u( r + x3 ), wx3 ));
+            t = _mm_add_ps( t, _mm_mul_ps( _mm_set1_ps( wy[j] ), h ));
+        }
+        icvStore4_16u( dst, t );
+    }
+    else if( fillval )
+        memcpy( dst, fillval, 4*sizeof(dst[0]) );
+}
+
+
+static CvStatus CV_STDCALL
+icvWarpAffine_Bicubic_16u_C4R_SSE2( const ushort* src, int step, CvSize ssize,
+                                    ushort* dst, int dststep, CvSize dsize,
+                                    const double* matrix, int, const ushort* fillval,
+                                    const int* ofs, int ystart )
+{
+    int x, y;
+    double  A12 = matrix[1], b1 = matrix[2];
+    double  A22 = matrix[4], b2 = matrix[5];
+
+    step /= sizeof(src[0]);
+    dststep /= sizeof(dst[0]);
+
+    for( y = ystart; y < ystart + dsize.height; y++, dst += dststep )
+    {
+        int xs = CV_FLT_TO_FIX( A12*y + b1, ICV_WARP_SHIFT );
+        int ys = CV_FLT_TO_FIX( A22*y + b2, ICV_WARP_SHIFT );
+
+        for( x = 0; x < dsize.width; x++ )
+            icvWarpBicubicPixel_16u_C4_SSE2( src, step, ssize, xs + ofs[x*2],
+                                             ys + ofs[x*2+1], dst + x*4, fillval );
+    }
+
+    return CV_OK;
+}
+#endif
+
+
 typedef CvStatus (CV_STDCALL * CvWarpAffineFunc)(
     const void* src, int srcstep, CvSize ssize,
     void* dst, int dststep, CvSize dsize,
     const double* matrix, int cn,
-    const void* fillval, const int* ofs );
+    const void* fillval, const int* ofs, int ystart );
 
-static void icvInitWarpAffineTab( CvFuncTable* bilin_tab )
+static void icvInitWarpAffineTab( CvFuncTable* bilin_tab, CvFuncTable* bicube_tab )
 {
     bilin_tab->fn_2d[CV_8U] = (void*)icvWarpAffine_Bilinear_8u_CnR;
     bilin_tab->fn_2d[CV_16U] = (void*)icvWarpAffine_Bilinear_16u_CnR;
     bilin_tab->fn_2d[CV_32F] = (void*)icvWarpAffine_Bilinear_32f_CnR;
+
+    bicube_tab->fn_2d[CV_8U] = (void*)icvWarpAffine_Bicubic_8u_CnR;
+    bicube_tab->fn_2d[CV_16U] = (void*)icvWarpAffine_Bicubic_16u_CnR;
+    bicube_tab->fn_2d[CV_32F] = (void*)icvWarpAffine_Bicubic_32f_CnR;
 }
 
 
@@ -1071,6 +1425,7 @@ cvWarpAffine( const CvArr* srcarr, CvArr* dstarr, const CvMat* matrix,
               int flags, CvScalar fillval )
 {
     static CvFuncTable bilin_tab;
+    static CvFuncTable bicube_tab;
     static int inittab = 0;
 
     CV_FUNCNAME( "cvWarpAffine" );
@@ -1091,7 +1446,8 @@ cvWarpAffine( const CvArr* srcarr, CvArr* dstarr, const CvMat* matrix,
     
     if( !inittab )
     {
-        icvInitWarpAffineTab( &bilin_tab );
+        icvInitWarpAffineTab( &bilin_tab, &bicube_tab );
+        icvInitCubicCoeffTab();
         inittab = 1;
     }
 
@@ -1166,15 +1522,36 @@ cvWarpAffine( const CvArr* srcarr, CvArr* dstarr, const CvMat* matrix,
         ofs[2*k+1] = CV_FLT_TO_FIX( dst_matrix[3]*k, ICV_WARP_SHIFT );
     }
 
-    /*if( method == CV_INTER_LINEAR )*/
+    func = (CvWarpAffineFunc)(method == CV_INTER_CUBIC ?
+        bicube_tab.fn_2d[depth] : bilin_tab.fn_2d[depth]);
+    if( !func )
+        CV_ERROR( CV_StsUnsupportedFormat, "" );
+#if CV_SSE2
+    if( type == CV_8UC4 && method != CV_INTER_CUBIC )
+        func = (CvWarpAffineFunc)icvWarpAffine_Bilinear_8u_C4R_SSE2;
+    else if( type == CV_16UC4 )
+        func = method == CV_INTER_CUBIC ?
+            (CvWarpAffineFunc)icvWarpAffine_Bicubic_16u_C4R_SSE2 :
+            (CvWarpAffineFunc)icvWarpAffine_Bilinear_16u_C4R_SSE2;
+#endif
+
     {
-        func = (CvWarpAffineFunc)bilin_tab.fn_2d[depth];
-        if( !func )
-            CV_ERROR( CV_StsUnsupportedFormat, "" );
+        int band, nbands = MAX( MIN( cvGetNumThreads(), dsize.height/8 ), 1 );
+        const void* fill = flags & CV_WARP_FILL_OUTLIERS ? fillbuf : 0;
 
-        IPPI_CALL( func( src->data.ptr, src->step, ssize, dst->data.ptr,
-                         dst->step, dsize, dst_matrix, cn,
-                         flags & CV_WARP_FILL_OUTLIERS ? fillbuf : 0, ofs ));
+        // the kernels take the first row of their band, so the
+        // result does not depend on the number of threads
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(nbands), schedule(static)
+#endif
+        for( band = 0; band < nbands; band++ )
+        {
+            int y0 = dsize.height*band/nbands, y1 = dsize.height*(band+1)/nbands;
+
+            func( src->data.ptr, src->step, ssize, dst->data.ptr + y0*dst->step,
+                  dst->step, cvSize( dsize.width, y1 - y0 ), dst_matrix, cn,
+                  fill, ofs, y0 );
+        }
     }
 
     __END__;
@@ -1225,7 +1602,7 @@ icvWarpPerspective_Bilinear_##flavor##_CnR(                                 \
     const arrtype* src, int step, CvSize ssize,                             \
     arrtype* dst, int dststep, CvSize dsize,                                \
     const double* matrix, int cn,                                           \
-    const arrtype* fillval )                                                \
+    const arrtype* fillval, int ystart )                                    \
 {                                                                           \
     int x, y, k;                                                            \
     float A11 = (float)matrix[0], A12 = (float)matrix[1], A13 = (float)matrix[2];\
@@ -1235,7 +1612,7 @@ icvWarpPerspective_Bilinear_##flavor##_CnR(                                 \
     step /= sizeof(src[0]);                                                 \
     dststep /= sizeof(dst[0]);                                              \
                                                                             \
-    for( y = 0; y < dsize.height; y++, dst += dststep )                     \
+    for( y = ystart; y < ystart + dsize.height; y++, dst += dststep )       \
     {                                                                       \
         float xs0 = A12*y + A13;                                            \
         float ys0 = A22*y + A23;                                            \
@@ -1306,16 +1683,196 @@ ICV_DEF_WARP_PERSPECTIVE_BILINEAR_FUNC( 8u, uchar, CV_8TO32F, cvRound )
 ICV_DEF_WARP_PERSPECTIVE_BILINEAR_FUNC( 16u, ushort, CV_NOP, cvRound )
 ICV_DEF_WARP_PERSPECTIVE_BILINEAR_FUNC( 32f, float, CV_NOP, CV_NOP )
 
+
+#define ICV_DEF_WARP_PERSPECTIVE_BICUBIC_FUNC( flavor, arrtype, load_macro, \
+                                               cast_macro1, cast_macro2 )   \
+static CvStatus CV_STDCALL                                                  \
+icvWarpPerspective_Bicubic_##flavor##_CnR(                                  \
+    const arrtype* src, int step, CvSize ssize,                             \
+    arrtype* dst, int dststep, CvSize dsize,                                \
+    const double* matrix, int cn,                                           \
+    const arrtype* fillval, int ystart )                                    \
+{                                                                           \
+    int x, y, j, k;                                                         \
+    float A11 = (float)matrix[0], A12 = (float)matrix[1], A13 = (float)matrix[2];\
+    float A21 = (float)matrix[3], A22 = (float)matrix[4], A23 = (float)matrix[5];\
+    float A31 = (float)matrix[6], A32 = (float)matrix[7], A33 = (float)matrix[8];\
+                                                                            \
+    step /= sizeof(src[0]);                                                 \
+    dststep /= sizeof(dst[0]);                                              \
+                                                                            \
+    for( y = ystart; y < ystart + dsize.height; y++, dst += dststep )       \
+    {                                                                       \
+        float xs0 = A12*y + A13;                                            \
+        float ys0 = A22*y + A23;                                            \
+        float ws = A32*y + A33;                                             \
+                                                                            \
+        for( x = 0; x < dsize.width; x++, xs0 += A11, ys0 += A21, ws += A31 )\
+        {                                                                   \
+            float inv_ws = 1.f/ws;                                          \
+            int ixs = cvFloor( xs0*inv_ws*(1 << ICV_WARP_SHIFT) );          \
+            int iys = cvFloor( ys0*inv_ws*(1 << ICV_WARP_SHIFT) );          \
+            ICV_WARP_BICUBIC_PIXEL( arrtype, load_macro,                    \
+                                    cast_macro1, cast_macro2 )              \
+        }                                                                   \
+    }                                                                       \
+                                                                            \
+    return CV_OK;                                                           \
+}
+
+
+ICV_DEF_WARP_PERSPECTIVE_BICUBIC_FUNC( 8u, uchar, CV_8TO32F, cvRound, CV_FAST_CAST_8U )
+ICV_DEF_WARP_PERSPECTIVE_BICUBIC_FUNC( 16u, ushort, CV_NOP, cvRound, CV_CAST_16U )
+ICV_DEF_WARP_PERSPECTIVE_BICUBIC_FUNC( 32f, float, CV_NOP, CV_NOP, CV_NOP )
+
+
+#if CV_SSE2
+static inline __m128 icvLoad4_8u( const uchar* p )
+{
+    __m128i z = _mm_setzero_si128();
+    __m128i v = _mm_unpacklo_epi8( _mm_cvtsi32_si128( *(const int*)p ), z );
+    return _mm_cvtepi32_ps( _mm_unpacklo_epi16( v, z ));
+}
+
+static inline void icvStore4_8u( uchar* p, __m128 v )
+{
+    __m128i i = _mm_cvtps_epi32( v );
+    i = _mm_packs_epi32( i, i );
+    *(int*)p = _mm_cvtsi128_si32( _mm_packus_epi16( i, i ));
+}
+
+static inline __m128 icvLoad4_32f( const float* p ) { return _mm_loadu_ps( p ); }
+static inline void icvStore4_32f( float* p, __m128 v ) { _mm_storeu_ps( p, v ); }
+
+/* 4-channel bilinear perspective warp; the coordinates are stepped exactly
+   as in the scalar version and all four channels are blended at once */
+#define ICV_DEF_WARP_PERSPECTIVE_BILINEAR_C4_SSE2( flavor, arrtype )       \
+static CvStatus CV_STDCALL                                                  \
+icvWarpPerspective_Bilinear_##flavor##_C4R_SSE2(                            \
+    const arrtype* src, int step, CvSize ssize,                             \
+    arrtype* dst, int dststep, CvSize dsize,                                \
+    const double* matrix, int, const arrtype* fillval, int ystart )         \
+{                                                                           \
+    int x, y;                                                               \
+    float A11 = (float)matrix[0], A12 = (float)matrix[1], A13 = (float)matrix[2];\
+    float A21 = (float)matrix[3], A22 = (float)matrix[4], A23 = (float)matrix[5];\
+    float A31 = (float)matrix[6], A32 = (float)matrix[7], A33 = (float)matrix[8];\
+                                                                            \
+    step /= sizeof(src[0]);                                                 \
+    dststep /= sizeof(dst[0]);                                              \
+                                                                            \
+    for( y = ystart; y < ystart + dsize.height; y++, dst += dststep )       \
+    {                                                                       \
+        float xs0 = A12*y + A13;                                            \
+        float ys0 = A22*y + A23;                                            \
+        float ws = A32*y + A33;                                             \
+                                                                            \
+        for( x = 0; x < dsize.width; x++, xs0 += A11, ys0 += A21, ws += A31 )\
+        {                                                                   \
+            float inv_ws = 1.f/ws;                                          \
+            float xs = xs0*inv_ws;                                          \
+            float ys = ys0*inv_ws;                                          \
+            int ixs = cvFloor(xs);                                          \
+            int iys = cvFloor(ys);                                          \
+            const arrtype *ptr0, *ptr1, *ptr2, *ptr3;                       \
+                                                                            \
+            if( (unsigned)ixs < (unsigned)(ssize.width - 1) &&              \
+                (unsigned)iys < (unsigned)(ssize.height - 1) )              \
+            {                                                               \
+                ptr0 = src + step*iys + ixs*4;                              \
+                ptr1 = ptr0 + 4;                                            \
+                ptr2 = ptr0 + step;                                         \
+                ptr3 = ptr2 + 4;                                            \
+            }                                                               \
+            else if( (unsigned)(ixs+1) < (unsigned)(ssize.width+1) &&       \
+                     (unsigned)(iys+1) < (unsigned)(ssize.height+1))        \
+            {                                                               \
+                int x0 = ICV_WARP_CLIP_X( ixs );                            \
+                int y0 = ICV_WARP_CLIP_Y( iys );                            \
+                int x1 = ICV_WARP_CLIP_X( ixs + 1 );                        \
+                int y1 = ICV_WARP_CLIP_Y( iys + 1 );                        \
+                                                                            \
+                ptr0 = src + y0*step + x0*4;                                \
+                ptr1 = src + y0*step + x1*4;                                \
+                ptr2 = src + y1*step + x0*4;                                \
+                ptr3 = src + y1*step + x1*4;                                \
+            }                                                               \
+            else                                                            \
+            {                                                               \
+                if( fillval )                                               \
+                    memcpy( dst + x*4, fillval, 4*sizeof(dst[0]) );         \
+                continue;                                                   \
+            }                                                               \
+                                                                            \
+            {                                                               \
+                __m128 a = _mm_set1_ps( xs - ixs ), b = _mm_set1_ps( ys - iys );\
+                __m128 s0 = icvLoad4_##flavor( ptr0 );                      \
+                __m128 s2 = icvLoad4_##flavor( ptr2 );                      \
+                __m128 p0 = _mm_add_ps( s0, _mm_mul_ps( a,                  \
+                                _mm_sub_ps( icvLoad4_##flavor( ptr1 ), s0 )));\
+                __m128 p1 = _mm_add_ps( s2, _mm_mul_ps( a,                  \
+                                _mm_sub_ps( icvLoad4_##flavor( ptr3 ), s2 )));\
+                icvStore4_##flavor( dst + x*4, _mm_add_ps( p0,              \
+                                _mm_mul_ps( b, _mm_sub_ps( p1, p0 ))));     \
+            }                                                               \
+        }                                                                   \
+    }                                                                       \
+                                                                            \
+    return CV_OK;                                                           \
+}
+
+ICV_DEF_WARP_PERSPECTIVE_BILINEAR_C4_SSE2( 8u, uchar )
+ICV_DEF_WARP_PERSPECTIVE_BILINEAR_C4_SSE2( 16u, ushort )
+ICV_DEF_WARP_PERSPECTIVE_BILINEAR_C4_SSE2( 32f, float )
+
+
+static CvStatus CV_STDCALL
+icvWarpPerspective_Bicubic_16u_C4R_SSE2( const ushort* src, int step, CvSize ssize,
+                                         ushort* dst, int dststep, CvSize dsize,
+                                         const double* matrix, int,
+                                         const ushort* fillval, int ystart )
+{
+    int x, y;
+    float A11 = (float)matrix[0], A12 = (float)matrix[1], A13 = (float)matrix[2];
+    float A21 = (float)matrix[3], A22 = (float)matrix[4], A23 = (float)matrix[5];
+    float A31 = (float)matrix[6], A32 = (float)matrix[7], A33 = (float)matrix[8];
+
+    step /= sizeof(src[0]);
+    dststep /= sizeof(dst[0]);
+
+    for( y = ystart; y < ystart + dsize.height; y++, dst += dststep )
+    {
+        float xs0 = A12*y + A13;
+        float ys0 = A22*y + A23;
+        float ws = A32*y + A33;
+
+        for( x = 0; x < dsize.width; x++, xs0 += A11, ys0 += A21, ws += A31 )
+        {
+            float inv_ws = 1.f/ws;
+            icvWarpBicubicPixel_16u_C4_SSE2( src, step, ssize,
+                cvFloor( xs0*inv_ws*(1 << ICV_WARP_SHIFT) ),
+                cvFloor( ys0*inv_ws*(1 << ICV_WARP_SHIFT) ), dst + x*4, fillval );
+        }
+    }
+
+    return CV_OK;
+}
+#endif
+
 typedef CvStatus (CV_STDCALL * CvWarpPerspectiveFunc)(
     const void* src, int srcstep, CvSize ssize,
     void* dst, int dststep, CvSize dsize,
-    const double* matrix, int cn, const void* fillval );
+    const double* matrix, int cn, const void* fillval, int ystart );
 
-static void icvInitWarpPerspectiveTab( CvFuncTable* bilin_tab )
+static void icvInitWarpPerspectiveTab( CvFuncTable* bilin_tab, CvFuncTable* bicube_tab )
 {
     bilin_tab->fn_2d[CV_8U] = (void*)icvWarpPerspective_Bilinear_8u_CnR;
     bilin_tab->fn_2d[CV_16U] = (void*)icvWarpPerspective_Bilinear_16u_CnR;
     bilin_tab->fn_2d[CV_32F] = (void*)icvWarpPerspective_Bilinear_32f_CnR;
+
+    bicube_tab->fn_2d[CV_8U] = (void*)icvWarpPerspective_Bicubic_8u_CnR;
+    bicube_tab->fn_2d[CV_16U] = (void*)icvWarpPerspective_Bicubic_16u_CnR;
+    bicube_tab->fn_2d[CV_32F] = (void*)icvWarpPerspective_Bicubic_32f_CnR;
 }
 
 
@@ -1347,6 +1904,7 @@ cvWarpPerspective( const CvArr* srcarr, CvArr* dstarr,
                    const CvMat* matrix, int flags, CvScalar fillval )
 {
     static CvFuncTable bilin_tab;
+    static CvFuncTable bicube_tab;
     static int inittab = 0;
 
     CV_FUNCNAME( "cvWarpPerspective" );
@@ -1369,7 +1927,8 @@ cvWarpPerspective( const CvArr* srcarr, CvArr* dstarr,
     
     if( !inittab )
     {
-        icvInitWarpPerspectiveTab( &bilin_tab );
+        icvInitWarpPerspectiveTab( &bilin_tab, &bicube_tab );
+        icvInitCubicCoeffTab();
         inittab = 1;
     }
 
@@ -1453,15 +2012,39 @@ cvWarpPerspective( const CvArr* srcarr, CvArr* dstarr,
 
     cvScalarToRawData( &fillval, fillbuf, CV_MAT_TYPE(src->type), 0 );
 
-    /*if( method == CV_INTER_LINEAR )*/
+    func = (CvWarpPerspectiveFunc)(method == CV_INTER_CUBIC ?
+        bicube_tab.fn_2d[depth] : bilin_tab.fn_2d[depth]);
+    if( !func )
+        CV_ERROR( CV_StsUnsupportedFormat, "" );
+#if CV_SSE2
+    if( method != CV_INTER_CUBIC )
     {
-        func = (CvWarpPerspectiveFunc)bilin_tab.fn_2d[depth];
-        if( !func )
-            CV_ERROR( CV_StsUnsupportedFormat, "" );
+        if( type == CV_8UC4 )
+            func = (CvWarpPerspectiveFunc)icvWarpPerspective_Bilinear_8u_C4R_SSE2;
+        else if( type == CV_16UC4 )
+            func = (CvWarpPerspectiveFunc)icvWarpPerspective_Bilinear_16u_C4R_SSE2;
+        else if( type == CV_32FC4 )
+            func = (CvWarpPerspectiveFunc)icvWarpPerspective_Bilinear_32f_C4R_SSE2;
+    }
+    else if( type == CV_16UC4 )
+        func = (CvWarpPerspectiveFunc)icvWarpPerspective_Bicubic_16u_C4R_SSE2;
+#endif
 
-        IPPI_CALL( func( src->data.ptr, src->step, ssize, dst->data.ptr,
-                         dst->step, dsize, dst_matrix, cn,
-                         flags & CV_WARP_FILL_OUTLIERS ? fillbuf : 0 ));
+    {
+        int band, nbands = MAX( MIN( cvGetNumThreads(), dsize.height/8 ), 1 );
+        const void* fill = flags & CV_WARP_FILL_OUTLIERS ? fillbuf : 0;
+
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(nbands), schedule(static)
+#endif
+        for( band = 0; band < nbands; band++ )
+        {
+            int y0 = dsize.height*band/nbands, y1 = dsize.height*(band+1)/nbands;
+
+            func( src->data.ptr, src->step, ssize, dst->data.ptr + y0*dst->step,
+                  dst->step, cvSize( dsize.width, y1 - y0 ), dst_matrix, cn,
+                  fill, y0 );
+        }
     }
 
     __END__;
@@ -1747,6 +2330,140 @@ ICV_DEF_REMAP_BICUBIC_FUNC( 8u, uchar, int, CV_8TO32F, cvRound, CV_FAST_CAST_8U
 ICV_DEF_REMAP_BICUBIC_FUNC( 16u, ushort, int, CV_NOP, cvRound, CV_CAST_16U )
 ICV_DEF_REMAP_BICUBIC_FUNC( 32f, float, float, CV_NOP, CV_NOP, CV_NOP )
 
+/* Fixed-point remap: mapxy holds the integer part of the source coordinates,
+   mapalpha holds (fy << ICV_REMAP_SHIFT) | fx. Integer depths are
+   interpolated in integers, so the result does not depend on the code path. */
+
+#define ICV_REMAP_ONE           (1 << ICV_REMAP_SHIFT)
+#define ICV_REMAP_DESCALE(x)    (((x) + (1 << (ICV_REMAP_SHIFT*2-1))) >> (ICV_REMAP_SHIFT*2))
+#define ICV_REMAP_SCALE_ALPHA(x) ((x)*(1.f/ICV_REMAP_ONE))
+
+#define  ICV_DEF_REMAP_FIXED_ROW_FUNC( flavor, arrtype, worktype,             \
+                                       scale_alpha_macro, cast_macro )        \
+static void                                                                   \
+icvRemapFixedRow_##flavor##_CnR( const arrtype* src, int srcstep, CvSize ssize,\
+                                 arrtype* dst, int width, const short* xy,    \
+                                 const ushort* alpha, int cn,                 \
+                                 const arrtype* fillval )                     \
+{                                                                             \
+    int j, k;                                                                 \
+                                                                              \
+    for( j = 0; j < width; j++ )                                              \
+    {                                                                         \
+        int ix = xy[j*2], iy = xy[j*2+1];                                     \
+                                                                              \
+        if( (unsigned)ix < (unsigned)ssize.width &&                           \
+            (unsigned)iy < (unsigned)ssize.height )                           \
+        {                                                                     \
+            worktype x0 = scale_alpha_macro( alpha[j] & ICV_REMAP_MASK );     \
+            worktype y0 = scale_alpha_macro( alpha[j] >> ICV_REMAP_SHIFT );   \
+            worktype x1 = scale_alpha_macro( ICV_REMAP_ONE ) - x0;            \
+            worktype y1 = scale_alpha_macro( ICV_REMAP_ONE ) - y0;            \
+            const arrtype* s = src + iy*srcstep + ix*cn;                      \
+                                                                              \
+            for( k = 0; k < cn; k++, s++ )                                    \
+            {                                                                 \
+                worktype t0 = s[0]*x1 + s[cn]*x0;                             \
+                worktype t1 = s[srcstep]*x1 + s[srcstep + cn]*x0;             \
+                dst[j*cn + k] = (arrtype)cast_macro(t0*y1 + t1*y0);           \
+            }                                                                 \
+        }                                                                     \
+        else if( fillval )                                                    \
+            for( k = 0; k < cn; k++ )                                         \
+                dst[j*cn + k] = fillval[k];                                   \
+    }                                                                         \
+}
+
+
+ICV_DEF_REMAP_FIXED_ROW_FUNC( 8u, uchar, int, CV_NOP, ICV_REMAP_DESCALE )
+ICV_DEF_REMAP_FIXED_ROW_FUNC( 16u, ushort, int, CV_NOP, ICV_REMAP_DESCALE )
+ICV_DEF_REMAP_FIXED_ROW_FUNC( 32f, float, float, ICV_REMAP_SCALE_ALPHA, CV_NOP )
+
+#if CV_SSE2
+/* 4-channel 8u rows: both taps of a source row are interpolated at once
+   in 16-bit lanes, then the two rows are blended with _mm_madd_epi16 */
+static void
+icvRemapFixedRow_8u_C4R_SSE2( const uchar* src, int srcstep, CvSize ssize,
+                              uchar* dst, int width, const short* xy,
+                              const ushort* alpha, const uchar* fillval )
+{
+    const __m128i z = _mm_setzero_si128();
+    const __m128i delta = _mm_set1_epi32( 1 << (ICV_REMAP_SHIFT*2-1) );
+    int j, fill = fillval ? *(const int*)fillval : 0;
+
+    for( j = 0; j < width; j++ )
+    {
+        int ix = xy[j*2], iy = xy[j*2+1];
+
+        if( (unsigned)ix < (unsigned)ssize.width &&
+            (unsigned)iy < (unsigned)ssize.height )
+        {
+            int fx = alpha[j] & ICV_REMAP_MASK, fy = alpha[j] >> ICV_REMAP_SHIFT;
+            const uchar* s = src + iy*srcstep + ix*4;
+            __m128i wx = _mm_set_epi16( (short)fx, (short)fx, (short)fx, (short)fx,
+                (short)(ICV_REMAP_ONE - fx), (short)(ICV_REMAP_ONE - fx),
+                (short)(ICV_REMAP_ONE - fx), (short)(ICV_REMAP_ONE - fx) );
+            __m128i wy = _mm_set1_epi32( (fy << 16) | (ICV_REMAP_ONE - fy) );
+            __m128i r0 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)s ), z );
+            __m128i r1 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(s + srcstep) ), z );
+
+            r0 = _mm_mullo_epi16( r0, wx );
+            r1 = _mm_mullo_epi16( r1, wx );
+            r0 = _mm_add_epi16( r0, _mm_srli_si128( r0, 8 ));
+            r1 = _mm_add_epi16( r1, _mm_srli_si128( r1, 8 ));
+            r0 = _mm_madd_epi16( _mm_unpacklo_epi16( r0, r1 ), wy );
+            r0 = _mm_srai_epi32( _mm_add_epi32( r0, delta ), ICV_REMAP_SHIFT*2 );
+            r0 = _mm_packs_epi32( r0, r0 );
+            *(int*)(dst + j*4) = _mm_cvtsi128_si32( _mm_packus_epi16( r0, r0 ));
+        }
+        else if( fillval )
+            *(int*)(dst + j*4) = fill;
+    }
+}
+#endif
+
+static void
+icvRemapFixed( const CvMat* src, CvMat* dst, const CvMat* mapxy,
+               const CvMat* mapalpha, const void* fillval )
+{
+    int i, depth = CV_MAT_DEPTH(src->type), cn = CV_MAT_CN(src->type);
+    int esz = CV_ELEM_SIZE1(depth);
+    int srcstep = src->step / esz;
+    CvSize ssize = cvSize( src->cols - 1, src->rows - 1 );
+
+    /* rows are independent, so they are simply dealt out to the threads */
+#ifdef _OPENMP
+    int thread_count = cvGetNumThreads();
+    #pragma omp parallel for num_threads(thread_count), schedule(static)
+#endif
+    for( i = 0; i < dst->rows; i++ )
+    {
+        uchar* d = dst->data.ptr + i*dst->step;
+        const short* xy = (const short*)(mapxy->data.ptr + i*mapxy->step);
+        const ushort* alpha = (const ushort*)(mapalpha->data.ptr + i*mapalpha->step);
+
+        if( depth == CV_8U )
+        {
+#if CV_SSE2
+            if( cn == 4 )
+            {
+                icvRemapFixedRow_8u_C4R_SSE2( src->data.ptr, src->step, ssize,
+                    d, dst->cols, xy, alpha, (const uchar*)fillval );
+                continue;
+            }
+#endif
+            icvRemapFixedRow_8u_CnR( src->data.ptr, srcstep, ssize, d, dst->cols,
+                                     xy, alpha, cn, (const uchar*)fillval );
+        }
+        else if( depth == CV_16U )
+            icvRemapFixedRow_16u_CnR( (const ushort*)src->data.ptr, srcstep, ssize,
+                (ushort*)d, dst->cols, xy, alpha, cn, (const ushort*)fillval );
+        else
+            icvRemapFixedRow_32f_CnR( src->data.fl, srcstep, ssize,
+                (float*)d, dst->cols, xy, alpha, cn, (const float*)fillval );
+    }
+}
+
 typedef CvStatus (CV_STDCALL * CvRemapFunc)(
     const void* src, int srcstep, CvSize ssize,
     void* dst, int dststep, CvSize dsize,
@@ -1821,6 +2538,33 @@ cvRemap( const CvArr* srcarr, CvArr* dstarr,
     if( !CV_ARE_TYPES_EQ( src, dst ))
         CV_ERROR( CV_StsUnmatchedFormats, "" );
 
+    if( CV_MAT_TYPE( mapx->type ) == CV_16SC2 )
+    {
+        if( CV_MAT_TYPE( mapy->type ) != CV_16UC1 )
+            CV_ERROR( CV_StsUnmatchedFormats,
+            "Fixed-point maps must be 16sC2 coordinates and 16uC1 fractions" );
+
+        if( !CV_ARE_SIZES_EQ( mapx, mapy ) || !CV_ARE_SIZES_EQ( mapx, dst ))
+            CV_ERROR( CV_StsUnmatchedSizes,
+            "Both map arrays and the destination array must have the same size" );
+
+        if( method == CV_INTER_CUBIC )
+            CV_ERROR( CV_StsBadFlag,
+            "Fixed-point maps support only bilinear interpolation" );
+
+        depth = CV_MAT_DEPTH(src->type);
+        if( depth != CV_8U && depth != CV_16U && depth != CV_32F )
+            CV_ERROR( CV_StsUnsupportedFormat, "" );
+
+        if( CV_MAT_CN(src->type) > 4 )
+            CV_ERROR( CV_BadNumChannels, "" );
+
+        cvScalarToRawData( &fillval, fillbuf, CV_MAT_TYPE(src->type), 0 );
+        icvRemapFixed( src, dst, mapx, mapy,
+                       flags & CV_WARP_FILL_OUTLIERS ? fillbuf : 0 );
+        EXIT;
+    }
+
     if( !CV_ARE_TYPES_EQ( mapx, mapy ) || CV_MAT_TYPE( mapx->type ) != CV_32FC1 )
         CV_ERROR( CV_StsUnmatchedFormats, "Both map arrays must have 32fC1 type" );
 
@@ -1889,6 +2633,58 @@ cvRemap( const CvArr* srcarr, CvArr* dstarr,
 }
 
 
+CV_IMPL void
+cvConvertMaps( const CvArr* _mapx, const CvArr* _mapy,
+               CvArr* _mapxy, CvArr* _mapalpha )
+{
+    CV_FUNCNAME( "cvConvertMaps" );
+
+    __BEGIN__;
+
+    CvMat mxstub, *mapx = (CvMat*)_mapx;
+    CvMat mystub, *mapy = (CvMat*)_mapy;
+    CvMat xystub, *mapxy = (CvMat*)_mapxy;
+    CvMat astub, *mapalpha = (CvMat*)_mapalpha;
+    int i, j;
+
+    CV_CALL( mapx = cvGetMat( mapx, &mxstub ));
+    CV_CALL( mapy = cvGetMat( mapy, &mystub ));
+    CV_CALL( mapxy = cvGetMat( mapxy, &xystub ));
+    CV_CALL( mapalpha = cvGetMat( mapalpha, &astub ));
+
+    if( !CV_ARE_TYPES_EQ( mapx, mapy ) || CV_MAT_TYPE( mapx->type ) != CV_32FC1 )
+        CV_ERROR( CV_StsUnmatchedFormats, "Both source maps must have 32fC1 type" );
+
+    if( CV_MAT_TYPE( mapxy->type ) != CV_16SC2 || CV_MAT_TYPE( mapalpha->type ) != CV_16UC1 )
+        CV_ERROR( CV_StsUnsupportedFormat,
+        "The destination maps must have 16sC2 and 16uC1 types" );
+
+    if( !CV_ARE_SIZES_EQ( mapx, mapy ) || !CV_ARE_SIZES_EQ( mapx, mapxy ) ||
+        !CV_ARE_SIZES_EQ( mapx, mapalpha ))
+        CV_ERROR( CV_StsUnmatchedSizes, "" );
+
+    for( i = 0; i < mapx->rows; i++ )
+    {
+        const float* mx = (const float*)(mapx->data.ptr + i*mapx->step);
+        const float* my = (const float*)(mapy->data.ptr + i*mapy->step);
+        short* xy = (short*)(mapxy->data.ptr + i*mapxy->step);
+        ushort* alpha = (ushort*)(mapalpha->data.ptr + i*mapalpha->step);
+
+        for( j = 0; j < mapx->cols; j++ )
+        {
+            int ix = cvRound( mx[j]*ICV_REMAP_ONE );
+            int iy = cvRound( my[j]*ICV_REMAP_ONE );
+            xy[j*2] = CV_CAST_16S( ix >> ICV_REMAP_SHIFT );
+            xy[j*2+1] = CV_CAST_16S( iy >> ICV_REMAP_SHIFT );
+            alpha[j] = (ushort)(((iy & ICV_REMAP_MASK) << ICV_REMAP_SHIFT) +
+                                (ix & ICV_REMAP_MASK));
+        }
+    }
+
+    __END__;
+}
+
+
 /****************************************************************************************\
 *                                   Log-Polar Transform                                  *
 \****************************************************************************************/
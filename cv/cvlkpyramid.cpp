@@ -160,6 +160,9 @@ icvInitPyramidalAlgorithm( const uchar * imgA, const uchar * imgB,
         uchar *bufPtr = (uchar *) (*size + level1);
         uchar *ptrA = pyrA;
         uchar *ptrB = pyrB;
+        uchar *pyrBuf = 0;
+        int pyrBufSize = 0;
+        CvStatus status = CV_OK;
 
         if( !ptrA )
         {
@@ -195,7 +198,9 @@ icvInitPyramidalAlgorithm( const uchar * imgA, const uchar * imgB,
                 next_level = cvMat( size[0][i].height, size[0][i].width, CV_8UC1 );
                 cvSetData( &prev_level, imgI[0][i-1], step[0][i-1] );
                 cvSetData( &next_level, imgI[0][i], step[0][i] );
-                cvPyrDown( &prev_level, &next_level );
+                status = icvPyrDownParallel( &prev_level, &next_level, &pyrBuf, &pyrBufSize );
+                if( status < 0 )
+                    break;
             }
 
             imgJ[0][i] = (uchar *) ptrB;
@@ -207,9 +212,15 @@ icvInitPyramidalAlgorithm( const uchar * imgA, const uchar * imgB,
                 next_level = cvMat( size[0][i].height, size[0][i].width, CV_8UC1 );
                 cvSetData( &prev_level, imgJ[0][i-1], step[0][i-1] );
                 cvSetData( &next_level, imgJ[0][i], step[0][i] );
-                cvPyrDown( &prev_level, &next_level );
+                status = icvPyrDownParallel( &prev_level, &next_level, &pyrBuf, &pyrBufSize );
+                if( status < 0 )
+                    break;
             }
         }
+
+        cvFree( &pyrBuf );
+        if( status < 0 )
+            return status;
     }
 
     return CV_OK;
@@ -249,6 +260,619 @@ icvCalcIxIy_32f( const float* src, int src_step, float* dstX, float* dstY, int d
     }
 }
 
+/****************************************************************************************\
+*                         Fixed-point tracker (CV_LKFLOW_FIXED_POINT)                   *
+\****************************************************************************************/
+
+/* bilinear weights are scaled by 2^ICV_LK_W_BITS; the sampled patches of the
+   first image keep ICV_LK_I_BITS fractional bits */
+#define ICV_LK_W_BITS   14
+#define ICV_LK_I_BITS   5
+
+/* arrays of at least that many pixels get their derivatives in parallel bands */
+#define ICV_LK_DERIV_PARALLEL_MIN_SIZE  (1 << 16)
+
+/* Computes rows [y0,y1) of the Scharr derivatives of an 8u image, replicating
+   the border pixels. dst holds interleaved (dI/dx, dI/dy) pairs, 32 times
+   the derivatives icvCalcIxIy_32f computes from the floating-point patches */
+static void
+icvCalcScharrDeriv_8u16s( const uchar* src, int src_step, short* dst, int dst_step,
+                          CvSize size, int y0, int y1, short* buffer )
+{
+    int width = size.width, x, y;
+    short* trow0 = buffer + 1;
+    short* trow1 = trow0 + width + 2;
+
+    dst_step /= sizeof(dst[0]);
+
+    for( y = y0; y < y1; y++ )
+    {
+        const uchar* srow0 = src + MAX(y - 1, 0)*src_step;
+        const uchar* srow1 = src + y*src_step;
+        const uchar* srow2 = src + MIN(y + 1, size.height - 1)*src_step;
+        short* drow = dst + y*dst_step;
+
+        x = 0;
+#if CV_SSE2
+        {
+        __m128i z = _mm_setzero_si128(), k3 = _mm_set1_epi16(3), k10 = _mm_set1_epi16(10);
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m128i s0 = _mm_unpacklo_epi8( _mm_loadl_epi64((const __m128i*)(srow0 + x)), z );
+            __m128i s1 = _mm_unpacklo_epi8( _mm_loadl_epi64((const __m128i*)(srow1 + x)), z );
+            __m128i s2 = _mm_unpacklo_epi8( _mm_loadl_epi64((const __m128i*)(srow2 + x)), z );
+            __m128i t0 = _mm_add_epi16( _mm_mullo_epi16( _mm_add_epi16( s0, s2 ), k3 ),
+                                        _mm_mullo_epi16( s1, k10 ));
+            __m128i t1 = _mm_sub_epi16( s2, s0 );
+            _mm_storeu_si128( (__m128i*)(trow0 + x), t0 );
+            _mm_storeu_si128( (__m128i*)(trow1 + x), t1 );
+        }
+        }
+#endif
+        for( ; x < width; x++ )
+        {
+            trow0[x] = (short)((srow0[x] + srow2[x])*3 + srow1[x]*10);
+            trow1[x] = (short)(srow2[x] - srow0[x]);
+        }
+
+        trow0[-1] = trow0[0]; trow0[width] = trow0[width-1];
+        trow1[-1] = trow1[0]; trow1[width] = trow1[width-1];
+
+        x = 0;
+#if CV_SSE2
+        {
+        __m128i k3 = _mm_set1_epi16(3), k10 = _mm_set1_epi16(10);
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m128i t00 = _mm_loadu_si128( (const __m128i*)(trow0 + x - 1) );
+            __m128i t02 = _mm_loadu_si128( (const __m128i*)(trow0 + x + 1) );
+            __m128i t10 = _mm_loadu_si128( (const __m128i*)(trow1 + x - 1) );
+            __m128i t11 = _mm_loadu_si128( (const __m128i*)(trow1 + x) );
+            __m128i t12 = _mm_loadu_si128( (const __m128i*)(trow1 + x + 1) );
+            __m128i dx = _mm_sub_epi16( t02, t00 );
+            __m128i dy = _mm_add_epi16( _mm_mullo_epi16( _mm_add_epi16( t10, t12 ), k3 ),
+                                        _mm_mullo_epi16( t11, k10 ));
+            _mm_storeu_si128( (__m128i*)(drow + x*2), _mm_unpacklo_epi16( dx, dy ));
+            _mm_storeu_si128( (__m128i*)(drow + x*2 + 8), _mm_unpackhi_epi16( dx, dy ));
+        }
+        }
+#endif
+        for( ; x < width; x++ )
+        {
+            drow[x*2] = (short)(trow0[x+1] - trow0[x-1]);
+            drow[x*2+1] = (short)((trow1[x+1] + trow1[x-1])*3 + trow1[x]*10);
+        }
+    }
+}
+
+
+/* Returns the (bsize.width x bsize.height) block of pixels with the top-left
+   corner at pt. Blocks that do not fit into the image are copied to buf with
+   the border pixels replicated */
+static const uchar*
+icvGetLKBlock( const uchar* img, int step, CvSize size, int pix_size,
+               CvPoint pt, CvSize bsize, uchar* buf, int* block_step )
+{
+    int x, y;
+
+    if( pt.x >= 0 && pt.y >= 0 && pt.x + bsize.width <= size.width &&
+        pt.y + bsize.height <= size.height )
+    {
+        *block_step = step;
+        return img + pt.y*step + pt.x*pix_size;
+    }
+
+    *block_step = bsize.width*pix_size;
+
+    for( y = 0; y < bsize.height; y++ )
+    {
+        const uchar* src = img + MIN( MAX( pt.y + y, 0 ), size.height - 1 )*step;
+        uchar* dst = buf + y*bsize.width*pix_size;
+
+        for( x = 0; x < bsize.width; x++ )
+        {
+            int sx = MIN( MAX( pt.x + x, 0 ), size.width - 1 );
+            memcpy( dst + x*pix_size, src + sx*pix_size, pix_size );
+        }
+    }
+
+    return buf;
+}
+
+
+/* Samples the (psize.width x psize.height) patch of the first image and its
+   derivatives bilinearly with the weights w. src and dsrc point to blocks
+   that are one pixel wider and higher than the patch */
+static void
+icvLKSamplePatch_8u16s( const uchar* src, int src_step, const short* dsrc,
+                        int dsrc_step, CvSize psize, const int* w,
+                        short* Iwin, short* dIwin )
+{
+    int x, y;
+
+    for( y = 0; y < psize.height; y++, src += src_step, dsrc += dsrc_step,
+                                 Iwin += psize.width, dIwin += psize.width*2 )
+    {
+        x = 0;
+#if CV_SSE2
+        {
+        __m128i z = _mm_setzero_si128();
+        __m128i qw0 = _mm_set1_epi32( w[0] + (w[1] << 16) );
+        __m128i qw1 = _mm_set1_epi32( w[2] + (int)((unsigned)w[3] << 16) );
+        __m128i qdelta_i = _mm_set1_epi32( 1 << (ICV_LK_W_BITS - ICV_LK_I_BITS - 1) );
+        __m128i qdelta_d = _mm_set1_epi32( 1 << (ICV_LK_W_BITS - 1) );
+
+        for( ; x <= psize.width - 8; x += 8 )
+        {
+            __m128i v00 = _mm_unpacklo_epi8( _mm_loadl_epi64((const __m128i*)(src + x)), z );
+            __m128i v01 = _mm_unpacklo_epi8( _mm_loadl_epi64((const __m128i*)(src + x + 1)), z );
+            __m128i v10 = _mm_unpacklo_epi8( _mm_loadl_epi64((const __m128i*)(src + x + src_step)), z );
+            __m128i v11 = _mm_unpacklo_epi8( _mm_loadl_epi64((const __m128i*)(src + x + src_step + 1)), z );
+            __m128i t0 = _mm_add_epi32( _mm_madd_epi16( _mm_unpacklo_epi16( v00, v01 ), qw0 ),
+                                        _mm_madd_epi16( _mm_unpacklo_epi16( v10, v11 ), qw1 ));
+            __m128i t1 = _mm_add_epi32( _mm_madd_epi16( _mm_unpackhi_epi16( v00, v01 ), qw0 ),
+                                        _mm_madd_epi16( _mm_unpackhi_epi16( v10, v11 ), qw1 ));
+            int k;
+
+            t0 = _mm_srai_epi32( _mm_add_epi32( t0, qdelta_i ), ICV_LK_W_BITS - ICV_LK_I_BITS );
+            t1 = _mm_srai_epi32( _mm_add_epi32( t1, qdelta_i ), ICV_LK_W_BITS - ICV_LK_I_BITS );
+            _mm_storeu_si128( (__m128i*)(Iwin + x), _mm_packs_epi32( t0, t1 ));
+
+            // the derivatives are interleaved, so the neighbour pairs
+            // (d[x], d[x+1]) of the 4 pixels come from the 2 shifted loads
+            for( k = 0; k < 8; k += 4 )
+            {
+                const short* d0 = dsrc + (x + k)*2;
+                const short* d1 = d0 + dsrc_step;
+                __m128i a0 = _mm_loadu_si128( (const __m128i*)d0 );
+                __m128i a1 = _mm_loadu_si128( (const __m128i*)(d0 + 2) );
+                __m128i b0 = _mm_loadu_si128( (const __m128i*)d1 );
+                __m128i b1 = _mm_loadu_si128( (const __m128i*)(d1 + 2) );
+
+                t0 = _mm_add_epi32( _mm_madd_epi16( _mm_unpacklo_epi16( a0, a1 ), qw0 ),
+                                    _mm_madd_epi16( _mm_unpacklo_epi16( b0, b1 ), qw1 ));
+                t1 = _mm_add_epi32( _mm_madd_epi16( _mm_unpackhi_epi16( a0, a1 ), qw0 ),
+                                    _mm_madd_epi16( _mm_unpackhi_epi16( b0, b1 ), qw1 ));
+                t0 = _mm_srai_epi32( _mm_add_epi32( t0, qdelta_d ), ICV_LK_W_BITS );
+                t1 = _mm_srai_epi32( _mm_add_epi32( t1, qdelta_d ), ICV_LK_W_BITS );
+                _mm_storeu_si128( (__m128i*)(dIwin + (x + k)*2), _mm_packs_epi32( t0, t1 ));
+            }
+        }
+        }
+#endif
+        for( ; x < psize.width; x++ )
+        {
+            Iwin[x] = (short)CV_DESCALE( src[x]*w[0] + src[x+1]*w[1] +
+                                         src[x+src_step]*w[2] + src[x+src_step+1]*w[3],
+                                         ICV_LK_W_BITS - ICV_LK_I_BITS );
+            dIwin[x*2] = (short)CV_DESCALE( dsrc[x*2]*w[0] + dsrc[x*2+2]*w[1] +
+                                            dsrc[x*2+dsrc_step]*w[2] +
+                                            dsrc[x*2+dsrc_step+2]*w[3], ICV_LK_W_BITS );
+            dIwin[x*2+1] = (short)CV_DESCALE( dsrc[x*2+1]*w[0] + dsrc[x*2+3]*w[1] +
+                                              dsrc[x*2+dsrc_step+1]*w[2] +
+                                              dsrc[x*2+dsrc_step+3]*w[3], ICV_LK_W_BITS );
+        }
+    }
+}
+
+
+/* Computes the spatial gradient matrix sum(dI/dx^2), sum(dI/dx*dI/dy),
+   sum(dI/dy^2) over the part of the sampled derivatives (stored
+   win_step pairs per row) */
+static void
+icvLKGradientMatrix_16s( const short* dIwin, int win_step, CvSize psize, double* A )
+{
+    double A11 = 0, A12 = 0, A22 = 0;
+    int x, y;
+
+    for( y = 0; y < psize.height; y++, dIwin += win_step*2 )
+    {
+        x = 0;
+#if CV_SSE2
+        // a lane gets psize.width/2 squares of at most 16*255*16*255
+        // per row, which fit 32 bits
+        if( psize.width <= 128 )
+        {
+            __m128i qa = _mm_setzero_si128(), qb = qa;
+            int buf[8];
+
+            for( ; x <= psize.width - 4; x += 4 )
+            {
+                __m128i d = _mm_loadu_si128( (const __m128i*)(dIwin + x*2) );
+                __m128i ds = _mm_shufflehi_epi16( _mm_shufflelo_epi16( d,
+                                 _MM_SHUFFLE(2,3,0,1)), _MM_SHUFFLE(2,3,0,1));
+                __m128i lo = _mm_mullo_epi16( d, d ), hi = _mm_mulhi_epi16( d, d );
+
+                qa = _mm_add_epi32( qa, _mm_unpacklo_epi16( lo, hi ));
+                qa = _mm_add_epi32( qa, _mm_unpackhi_epi16( lo, hi ));
+
+                lo = _mm_mullo_epi16( d, ds );
+                hi = _mm_mulhi_epi16( d, ds );
+                qb = _mm_add_epi32( qb, _mm_unpacklo_epi16( lo, hi ));
+                qb = _mm_add_epi32( qb, _mm_unpackhi_epi16( lo, hi ));
+            }
+
+            _mm_storeu_si128( (__m128i*)buf, qa );
+            _mm_storeu_si128( (__m128i*)(buf + 4), qb );
+            A11 += (double)buf[0] + buf[2];
+            A22 += (double)buf[1] + buf[3];
+            A12 += (double)buf[4] + buf[6];
+        }
+#endif
+        for( ; x < psize.width; x++ )
+        {
+            int ix = dIwin[x*2], iy = dIwin[x*2+1];
+            A11 += ix*ix;
+            A12 += ix*iy;
+            A22 += iy*iy;
+        }
+    }
+
+    A[0] = A11;
+    A[1] = A12;
+    A[2] = A22;
+}
+
+
+/* Accumulates sum((I - J)*dI/dx) and sum((I - J)*dI/dy) over the part of the
+   sampled patch (stored win_step pixels per row), where J is sampled
+   bilinearly from src with the weights w. All the products are exact
+   integers, so the sums do not depend on the evaluation order */
+static void
+icvLKPatchDiff_8u16s( const uchar* src, int src_step, const short* Iwin,
+                      const short* dIwin, int win_step, CvSize psize,
+                      const int* w, double* _b1, double* _b2 )
+{
+    double b1 = 0, b2 = 0;
+    int x, y;
+
+    for( y = 0; y < psize.height; y++, src += src_step,
+                                 Iwin += win_step, dIwin += win_step*2 )
+    {
+        x = 0;
+#if CV_SSE2
+        // each accumulator lane gets psize.width/2 products of at most
+        // 255*32*16*255 by absolute value per row, which fit 32 bits
+        if( psize.width <= 128 )
+        {
+            __m128i z = _mm_setzero_si128(), qb = z;
+            __m128i qw0 = _mm_set1_epi32( w[0] + (w[1] << 16) );
+            __m128i qw1 = _mm_set1_epi32( w[2] + (int)((unsigned)w[3] << 16) );
+            __m128i qdelta = _mm_set1_epi32( 1 << (ICV_LK_W_BITS - ICV_LK_I_BITS - 1) );
+            int buf[4];
+
+            for( ; x <= psize.width - 8; x += 8 )
+            {
+                __m128i v00 = _mm_unpacklo_epi8( _mm_loadl_epi64((const __m128i*)(src + x)), z );
+                __m128i v01 = _mm_unpacklo_epi8( _mm_loadl_epi64((const __m128i*)(src + x + 1)), z );
+                __m128i v10 = _mm_unpacklo_epi8( _mm_loadl_epi64((const __m128i*)(src + x + src_step)), z );
+                __m128i v11 = _mm_unpacklo_epi8( _mm_loadl_epi64((const __m128i*)(src + x + src_step + 1)), z );
+                __m128i t0 = _mm_add_epi32( _mm_madd_epi16( _mm_unpacklo_epi16( v00, v01 ), qw0 ),
+                                            _mm_madd_epi16( _mm_unpacklo_epi16( v10, v11 ), qw1 ));
+                __m128i t1 = _mm_add_epi32( _mm_madd_epi16( _mm_unpackhi_epi16( v00, v01 ), qw0 ),
+                                            _mm_madd_epi16( _mm_unpackhi_epi16( v10, v11 ), qw1 ));
+                __m128i diff, d, dd, lo, hi;
+
+                t0 = _mm_srai_epi32( _mm_add_epi32( t0, qdelta ), ICV_LK_W_BITS - ICV_LK_I_BITS );
+                t1 = _mm_srai_epi32( _mm_add_epi32( t1, qdelta ), ICV_LK_W_BITS - ICV_LK_I_BITS );
+                diff = _mm_sub_epi16( _mm_loadu_si128( (const __m128i*)(Iwin + x) ),
+                                      _mm_packs_epi32( t0, t1 ));
+
+                // (diff*dI/dx, diff*dI/dy) pairs as 32-bit products
+                d = _mm_loadu_si128( (const __m128i*)(dIwin + x*2) );
+                dd = _mm_unpacklo_epi16( diff, diff );
+                lo = _mm_mullo_epi16( d, dd );
+                hi = _mm_mulhi_epi16( d, dd );
+                qb = _mm_add_epi32( qb, _mm_unpacklo_epi16( lo, hi ));
+                qb = _mm_add_epi32( qb, _mm_unpackhi_epi16( lo, hi ));
+
+                d = _mm_loadu_si128( (const __m128i*)(dIwin + x*2 + 8) );
+                dd = _mm_unpackhi_epi16( diff, diff );
+                lo = _mm_mullo_epi16( d, dd );
+                hi = _mm_mulhi_epi16( d, dd );
+                qb = _mm_add_epi32( qb, _mm_unpacklo_epi16( lo, hi ));
+                qb = _mm_add_epi32( qb, _mm_unpackhi_epi16( lo, hi ));
+            }
+
+            _mm_storeu_si128( (__m128i*)buf, qb );
+            b1 += (double)buf[0] + buf[2];
+            b2 += (double)buf[1] + buf[3];
+        }
+#endif
+        for( ; x < psize.width; x++ )
+        {
+            int ival = CV_DESCALE( src[x]*w[0] + src[x+1]*w[1] +
+                                   src[x+src_step]*w[2] + src[x+src_step+1]*w[3],
+                                   ICV_LK_W_BITS - ICV_LK_I_BITS );
+            int diff = Iwin[x] - ival;
+            b1 += diff*dIwin[x*2];
+            b2 += diff*dIwin[x*2+1];
+        }
+    }
+
+    *_b1 = b1;
+    *_b2 = b2;
+}
+
+
+/* Computes the bilinear weights of the point (scaled by 2^ICV_LK_W_BITS)
+   and the integer top-left corner of the window centered at it, the same
+   corner intersect() uses */
+static CvPoint
+icvLKWeights( CvPoint2D32f pt, CvSize win_size, int* w )
+{
+    CvPoint ipt;
+    float a, b;
+
+    ipt.x = cvFloor( pt.x );
+    ipt.y = cvFloor( pt.y );
+    a = pt.x - ipt.x;
+    b = pt.y - ipt.y;
+
+    w[0] = cvRound( (1.f - a)*(1.f - b)*(1 << ICV_LK_W_BITS) );
+    w[1] = cvRound( a*(1.f - b)*(1 << ICV_LK_W_BITS) );
+    w[2] = cvRound( (1.f - a)*b*(1 << ICV_LK_W_BITS) );
+    w[3] = (1 << ICV_LK_W_BITS) - w[0] - w[1] - w[2];
+
+    ipt.x -= win_size.width;
+    ipt.y -= win_size.height;
+
+    return ipt;
+}
+
+
+/* Tracks the features through all the pyramid levels, one feature per task,
+   on the integer patches of the first image and its cached Scharr
+   derivatives. The windows are clipped by the image borders and the
+   iteration, termination and status rules are the ones of the
+   floating-point tracker */
+static CvStatus
+icvCalcOpticalFlowPyrLKFixed_8uC1R( uchar** imgI, uchar** imgJ, int* step,
+                                    CvSize* size, double* scale, int level,
+                                    const CvPoint2D32f* featuresA,
+                                    CvPoint2D32f* featuresB, int count,
+                                    CvSize winSize, char* status, float* error,
+                                    CvTermCriteria criteria, int flags )
+{
+    // sums of products of 32x scaled values are brought to the units
+    // of the floating-point tracker
+    const double sum_scale = 1./(1 << (ICV_LK_I_BITS*2));
+    CvSize patchSize = cvSize( winSize.width * 2 + 1, winSize.height * 2 + 1 );
+    CvSize blockSize = cvSize( patchSize.width + 1, patchSize.height + 1 );
+    int patchLen = patchSize.width*patchSize.height;
+    int threadCount = cvGetNumThreads();
+    int scratchLen, derivLen = 0;
+    short** derivI = 0;
+    uchar* scratch = 0;
+    int i, l;
+
+    // scratch memory of each thread: the patch of I, its derivatives,
+    // the border blocks of I, J and the derivatives
+    scratchLen = cvAlign( patchLen*3*sizeof(short) +
+                          blockSize.width*blockSize.height*(2 + 2*sizeof(short)), 16 );
+
+    for( l = 0; l <= level; l++ )
+        derivLen += size[l].width*size[l].height*2;
+
+    derivI = (short**)cvAlloc( (level + 1)*sizeof(derivI[0]) +
+                               derivLen*sizeof(derivI[0][0]) );
+    scratch = (uchar*)cvAlloc( scratchLen*threadCount );
+    if( !derivI || !scratch )
+    {
+        cvFree( &derivI );
+        cvFree( &scratch );
+        return CV_OUTOFMEM_ERR;
+    }
+
+    derivI[0] = (short*)(derivI + level + 1);
+    for( l = 1; l <= level; l++ )
+        derivI[l] = derivI[l-1] + size[l-1].width*size[l-1].height*2;
+
+    for( l = 0; l <= level; l++ )
+    {
+        CvSize levelSize = size[l];
+        int bands = levelSize.width*levelSize.height >= ICV_LK_DERIV_PARALLEL_MIN_SIZE ?
+                    MIN( threadCount, levelSize.height ) : 1;
+        int k;
+
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(bands), schedule(static)
+#endif
+        for( k = 0; k < bands; k++ )
+        {
+            short* buffer = (short*)cvStackAlloc( (levelSize.width + 2)*2*sizeof(buffer[0]) );
+            icvCalcScharrDeriv_8u16s( imgI[l], step[l], derivI[l],
+                                      levelSize.width*2*sizeof(short), levelSize,
+                                      levelSize.height*k/bands,
+                                      levelSize.height*(k+1)/bands, buffer );
+        }
+    }
+
+    memset( status, 1, count );
+    if( error )
+        memset( error, 0, count*sizeof(error[0]) );
+
+    if( !(flags & CV_LKFLOW_INITIAL_GUESSES) )
+        memcpy( featuresB, featuresA, count*sizeof(featuresA[0]));
+
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(threadCount), schedule(dynamic, 4)
+#endif
+    for( i = 0; i < count; i++ )
+    {
+        uchar* buf = scratch + cvGetThreadNum()*scratchLen;
+        short* Iwin = (short*)buf;
+        short* dIwin = Iwin + patchLen;
+        uchar* blockI = (uchar*)(dIwin + patchLen*2);
+        uchar* blockJ = blockI + blockSize.width*blockSize.height;
+        uchar* blockD = blockJ + blockSize.width*blockSize.height;
+        CvPoint2D32f v = featuresB[i];
+        CvPoint minI, maxI, minJ, maxJ;
+        int pt_status = 1;
+        int j, lv;
+
+        minJ = maxJ = cvPoint( 0, 0 );
+
+        for( lv = level; lv >= 0 && pt_status; lv-- )
+        {
+            CvSize levelSize = size[lv];
+            CvPoint2D32f u;
+            CvPoint ipt, prev_minJ = { -1, -1 }, prev_maxJ = { -1, -1 };
+            const uchar* src;
+            const short* dsrc;
+            int w[4], src_step, dsrc_step;
+            double A[3] = { 0, 0, 0 }, D = 0;
+            float prev_mx = 0, prev_my = 0;
+
+            if( lv < level )
+            {
+                v.x += v.x;
+                v.y += v.y;
+            }
+            else
+            {
+                v.x = (float)(v.x * scale[lv]);
+                v.y = (float)(v.y * scale[lv]);
+            }
+
+            u.x = (float)(featuresA[i].x * scale[lv]);
+            u.y = (float)(featuresA[i].y * scale[lv]);
+
+            intersect( u, winSize, levelSize, &minI, &maxI );
+            if( maxI.x <= minI.x || maxI.y <= minI.y )
+            {
+                /* point is outside the image */
+                pt_status = 0;
+                break;
+            }
+
+            ipt = icvLKWeights( u, winSize, w );
+            src = icvGetLKBlock( imgI[lv], step[lv], levelSize, 1, ipt,
+                                 blockSize, blockI, &src_step );
+            dsrc = (const short*)icvGetLKBlock( (const uchar*)derivI[lv],
+                                 levelSize.width*2*sizeof(short), levelSize,
+                                 2*sizeof(short), ipt, blockSize, blockD, &dsrc_step );
+            icvLKSamplePatch_8u16s( src, src_step, dsrc, dsrc_step/sizeof(short),
+                                    patchSize, w, Iwin, dIwin );
+
+            for( j = 0; j < criteria.max_iter; j++ )
+            {
+                int ofs;
+                double bx, by;
+                float mx, my;
+
+                intersect( v, winSize, levelSize, &minJ, &maxJ );
+
+                minJ.x = MAX( minJ.x, minI.x );
+                minJ.y = MAX( minJ.y, minI.y );
+
+                maxJ.x = MIN( maxJ.x, maxI.x );
+                maxJ.y = MIN( maxJ.y, maxI.y );
+
+                if( maxJ.x <= minJ.x || maxJ.y <= minJ.y )
+                {
+                    /* point is outside image */
+                    pt_status = 0;
+                    break;
+                }
+
+                ofs = minJ.y*patchSize.width + minJ.x;
+
+                if( maxJ.x != prev_maxJ.x || maxJ.y != prev_maxJ.y ||
+                    minJ.x != prev_minJ.x || minJ.y != prev_minJ.y )
+                {
+                    icvLKGradientMatrix_16s( dIwin + ofs*2, patchSize.width,
+                        cvSize( maxJ.x - minJ.x, maxJ.y - minJ.y ), A );
+
+                    A[0] *= sum_scale;
+                    A[1] *= sum_scale;
+                    A[2] *= sum_scale;
+
+                    D = A[0]*A[2] - A[1]*A[1];
+                    if( D < DBL_EPSILON )
+                    {
+                        pt_status = 0;
+                        break;
+                    }
+                    D = 1./D;
+
+                    prev_minJ = minJ;
+                    prev_maxJ = maxJ;
+                }
+
+                ipt = icvLKWeights( v, winSize, w );
+                src = icvGetLKBlock( imgJ[lv], step[lv], levelSize, 1, ipt,
+                                     blockSize, blockJ, &src_step );
+                icvLKPatchDiff_8u16s( src + minJ.y*src_step + minJ.x, src_step,
+                                      Iwin + ofs, dIwin + ofs*2, patchSize.width,
+                                      cvSize( maxJ.x - minJ.x, maxJ.y - minJ.y ),
+                                      w, &bx, &by );
+
+                bx *= sum_scale;
+                by *= sum_scale;
+
+                mx = (float) ((A[2] * bx - A[1] * by) * D);
+                my = (float) ((A[0] * by - A[1] * bx) * D);
+
+                v.x += mx;
+                v.y += my;
+
+                if( mx * mx + my * my < criteria.epsilon )
+                    break;
+
+                if( j > 0 && fabs(mx + prev_mx) < 0.01 && fabs(my + prev_my) < 0.01 )
+                {
+                    v.x -= mx*0.5f;
+                    v.y -= my*0.5f;
+                    break;
+                }
+                prev_mx = mx;
+                prev_my = my;
+            }
+        }
+
+        if( pt_status && error )
+        {
+            /* calc error at the final position over the last window */
+            CvPoint ipt;
+            const uchar* src;
+            int w[4], src_step, x, y;
+            double err = 0;
+
+            ipt = icvLKWeights( v, winSize, w );
+            src = icvGetLKBlock( imgJ[0], step[0], size[0], 1, ipt,
+                                 blockSize, blockJ, &src_step );
+
+            for( y = minJ.y; y < maxJ.y; y++ )
+            {
+                const uchar* srow = src + y*src_step;
+                const short* irow = Iwin + y*patchSize.width;
+
+                for( x = minJ.x; x < maxJ.x; x++ )
+                {
+                    int ival = CV_DESCALE( srow[x]*w[0] + srow[x+1]*w[1] +
+                                           srow[x+src_step]*w[2] + srow[x+src_step+1]*w[3],
+                                           ICV_LK_W_BITS - ICV_LK_I_BITS );
+                    int diff = irow[x] - ival;
+                    err += (double)diff*diff;
+                }
+            }
+            error[i] = (float)(sqrt(err)*(1./(1 << ICV_LK_I_BITS)));
+        }
+
+        featuresB[i] = v;
+        status[i] = (char)pt_status;
+    }
+
+    cvFree( &scratch );
+    cvFree( &derivI );
+
+    return CV_OK;
+}
+
+
 icvOpticalFlowPyrLKInitAlloc_8u_C1R_t icvOpticalFlowPyrLKInitAlloc_8u_C1R_p = 0;
 icvOpticalFlowPyrLKFree_8u_C1R_t icvOpticalFlowPyrLKFree_8u_C1R_p = 0;
 icvOpticalFlowPyrLK_8u_C1R_t icvOpticalFlowPyrLK_8u_C1R_p = 0;
@@ -302,7 +926,7 @@ icvCalcOpticalFlowPyrLK_8uC1R( const uchar* imgA, const uchar* imgB,
     if( winSize.width <= 1 || winSize.height <= 1 )
         return CV_BADSIZE_ERR;
 
-    if( (flags & ~7) != 0 )
+    if( (flags & ~15) != 0 )
         return CV_BADFLAG_ERR;
     if( count <= 0 )
         return CV_BADRANGE_ERR;
@@ -376,6 +1000,14 @@ icvCalcOpticalFlowPyrLK_8uC1R( const uchar* imgA, const uchar* imgB,
     }
 #endif
 
+    if( flags & CV_LKFLOW_FIXED_POINT )
+    {
+        result = icvCalcOpticalFlowPyrLKFixed_8uC1R( imgI, imgJ, step, size, scale, level,
+                                                     featuresA, featuresB, count, winSize,
+                                                     status, error, criteria, flags );
+        goto func_exit;
+    }
+
     /* buffer_size = <size for patches> + <size for pyramids> */
     bufferBytes = (srcPatchLen + patchLen * 3) * sizeof( _patchI[0][0] ) * threadCount;
 
@@ -351,6 +351,9 @@ int CvMorphology::fill_cyclic_buffer( const uchar* src, int src_step,
 }
 
 
+/* maximal number of rectangles CV_SHAPE_ELLIPSE_APPROX is made of */
+#define ICV_MORPH_ELLIPSE_APPROX_RECTS  8
+
 void CvMorphology::init_binary_element( CvMat* element, int element_shape, CvPoint anchor )
 {
     CV_FUNCNAME( "CvMorphology::init_binary_element" );
@@ -361,6 +364,7 @@ void CvMorphology::init_binary_element( CvMat* element, int element_shape, CvPoi
     int i, j, cols, rows;
     int r = 0, c = 0;
     double inv_r2 = 0;
+    int heights[ICV_MORPH_ELLIPSE_APPROX_RECTS];
 
     if( !CV_IS_MAT(element) )
         CV_ERROR( CV_StsBadArg, "element must be valid matrix" );
@@ -379,7 +383,8 @@ void CvMorphology::init_binary_element( CvMat* element, int element_shape, CvPoi
         (unsigned)anchor.y >= (unsigned)element->rows )
         CV_ERROR( CV_StsOutOfRange, "anchor is outside of element" );
 
-    if( element_shape != RECT && element_shape != CROSS && element_shape != ELLIPSE )
+    if( element_shape != RECT && element_shape != CROSS && element_shape != ELLIPSE &&
+        element_shape != ELLIPSE_APPROX )
         CV_ERROR( CV_StsBadArg, "Unknown/unsupported element shape" );
 
     rows = element->rows;
@@ -388,13 +393,21 @@ void CvMorphology::init_binary_element( CvMat* element, int element_shape, CvPoi
     if( rows == 1 || cols == 1 )
         element_shape = RECT;
 
-    if( element_shape == ELLIPSE )
+    if( element_shape == ELLIPSE || element_shape == ELLIPSE_APPROX )
     {
         r = rows/2;
         c = cols/2;
         inv_r2 = r ? 1./((double)r*r) : 0;
     }
 
+    if( element_shape == ELLIPSE_APPROX )
+    {
+        // the half-heights of the centered rectangles with the corners
+        // on the ellipse, spread uniformly over the angle
+        for( i = 0; i < ICV_MORPH_ELLIPSE_APPROX_RECTS; i++ )
+            heights[i] = cvRound( r*sin( i*CV_PI*0.5/(ICV_MORPH_ELLIPSE_APPROX_RECTS - 1) ));
+    }
+
     for( i = 0; i < rows; i++ )
     {
         uchar* ptr = element->data.ptr + i*element->step;
@@ -406,10 +419,18 @@ void CvMorphology::init_binary_element( CvMat* element, int element_shape, CvPoi
             j1 = anchor.x, j2 = j1 + 1;
         else
         {
-            int dy = i - r;
-            if( abs(dy) <= r )
+            int dy = abs(i - r);
+            if( dy <= r )
             {
-                int dx = cvRound(c*sqrt(((double)r*r - dy*dy)*inv_r2));
+                int dx;
+                if( element_shape == ELLIPSE_APPROX )
+                {
+                    // the row is as wide as the lowest rectangle covering it
+                    for( j = 0; heights[j] < dy; j++ )
+                        ;
+                    dy = heights[j];
+                }
+                dx = cvRound(c*sqrt(((double)r*r - dy*dy)*inv_r2));
                 j1 = MAX( c - dx, 0 );
                 j2 = MIN( c + dx + 1, cols );
             }
@@ -690,6 +711,413 @@ ICV_MORPH_ANY( Dilate, 8u, uchar, int, CV_CALC_MAX, CV_NOP )
 ICV_MORPH_ANY( Erode, 32f, int, int, CV_CALC_MIN, CV_TOGGLE_FLT )
 ICV_MORPH_ANY( Dilate, 32f, int, int, CV_CALC_MAX, CV_TOGGLE_FLT )
 
+/****************************************************************************************\
+           Rectangular Elements and Unions of Them: van Herk/Gil-Werman Algorithm
+\****************************************************************************************/
+
+/* arrays of at least that many pixels are processed in parallel row bands */
+#define ICV_MORPH_PARALLEL_MIN_SIZE  (1 << 16)
+
+/* the vertical pass goes through the column strips of that many bytes */
+#define ICV_MORPH_STRIP_SIZE  1024
+
+/* a non-rectangular element is processed as a union of rectangles when
+   there are at least that many element pixels per rectangle */
+#define ICV_MORPH_RECT_COST  4
+
+typedef void (*CvMorphRowOpFunc)( const void* a, const void* b, void* dst, int len );
+typedef void (*CvMorphVHGWRowFunc)( const void* src, void* dst, int width, int cn,
+                                    int ksize, int anchor, void* buf );
+
+/* the same operand order in the scalar and the SSE2 code,
+   so that the results do not depend on the instruction set */
+#define ICV_MORPH_MIN( a, b )  ((a) < (b) ? (a) : (b))
+#define ICV_MORPH_MAX( a, b )  ((a) > (b) ? (a) : (b))
+
+#if CV_SSE2
+
+static inline __m128i icvMorphMin16u( __m128i a, __m128i b )
+{ return _mm_sub_epi16( a, _mm_subs_epu16( a, b )); }
+
+static inline __m128i icvMorphMax16u( __m128i a, __m128i b )
+{ return _mm_add_epi16( _mm_subs_epu16( a, b ), b ); }
+
+#define ICV_MORPH_VEC_OP_8U( vec_op )                                       \
+    for( ; i <= len - 16; i += 16 )                                         \
+        _mm_storeu_si128( (__m128i*)(dst + i), vec_op(                      \
+            _mm_loadu_si128( (const __m128i*)(a + i) ),                     \
+            _mm_loadu_si128( (const __m128i*)(b + i) )));
+
+#define ICV_MORPH_VEC_OP_16U( vec_op )                                      \
+    for( ; i <= len - 8; i += 8 )                                           \
+        _mm_storeu_si128( (__m128i*)(dst + i), vec_op(                      \
+            _mm_loadu_si128( (const __m128i*)(a + i) ),                     \
+            _mm_loadu_si128( (const __m128i*)(b + i) )));
+
+#define ICV_MORPH_VEC_OP_32F( vec_op )                                      \
+    for( ; i <= len - 4; i += 4 )                                           \
+        _mm_storeu_ps( dst + i, vec_op( _mm_loadu_ps( a + i ),              \
+                                        _mm_loadu_ps( b + i )));
+#else
+#define ICV_MORPH_VEC_OP_8U( vec_op )
+#define ICV_MORPH_VEC_OP_16U( vec_op )
+#define ICV_MORPH_VEC_OP_32F( vec_op )
+#endif
+
+
+/* dst[i] = op(a[i], b[i]) */
+#define ICV_DEF_MORPH_ROW_OP( name, flavor, arrtype, op, vec_op_macro )     \
+static void                                                                 \
+icv##name##RowOp_##flavor( const arrtype* a, const arrtype* b,             \
+                           arrtype* dst, int len )                          \
+{                                                                           \
+    int i = 0;                                                              \
+                                                                            \
+    vec_op_macro                                                            \
+    for( ; i < len; i++ )                                                   \
+        dst[i] = op( a[i], b[i] );                                          \
+}
+
+
+/* Computes the extremum over the horizontal ksize-pixel window of each
+   pixel of the row, with the border pixels replicated. The row is split into
+   ksize-pixel blocks; the window is made of a suffix of one block and
+   a prefix of the next one, so it takes 3 operations per pixel
+   whatever ksize is. buf must hold 3*(width + ksize - 1)*cn elements */
+#define ICV_DEF_MORPH_VHGW_ROW( name, flavor, arrtype, op )                \
+static void                                                                 \
+icv##name##VHGWRow_##flavor( const arrtype* src, arrtype* dst, int width,  \
+                             int cn, int ksize, int anchor, arrtype* buf )  \
+{                                                                           \
+    int n = width + ksize - 1, len = n*cn;                                  \
+    arrtype* pad = buf;                                                     \
+    arrtype* h = pad + len;                                                 \
+    arrtype* g = h + len;                                                   \
+    int i, i0, i1, k;                                                       \
+                                                                            \
+    if( ksize == 1 && anchor == 0 )                                         \
+    {                                                                       \
+        memcpy( dst, src, width*cn*sizeof(dst[0]) );                        \
+        return;                                                             \
+    }                                                                       \
+                                                                            \
+    i0 = MIN( MAX( anchor, 0 ), n );                                        \
+    i1 = MIN( MAX( anchor + width, 0 ), n );                                \
+    for( i = 0; i < i0; i++ )                                               \
+        for( k = 0; k < cn; k++ )                                           \
+            pad[i*cn + k] = src[k];                                         \
+    if( i1 > i0 )                                                           \
+        memcpy( pad + i0*cn, src + (i0 - anchor)*cn,                        \
+                (i1 - i0)*cn*sizeof(pad[0]) );                              \
+    for( i = MAX( i1, i0 ); i < n; i++ )                                    \
+        for( k = 0; k < cn; k++ )                                           \
+            pad[i*cn + k] = src[(width - 1)*cn + k];                        \
+                                                                            \
+    for( i = 0; i < n; i += ksize )                                         \
+    {                                                                       \
+        int e0 = i*cn, e1 = MIN( i + ksize, n )*cn;                         \
+                                                                            \
+        /* suffix extrema of the block */                                   \
+        for( k = e1 - cn; k < e1; k++ )                                     \
+            h[k] = pad[k];                                                  \
+        for( k = e1 - cn - 1; k >= e0; k-- )                                \
+            h[k] = op( pad[k], h[k + cn] );                                 \
+                                                                            \
+        /* prefix extrema of the block */                                   \
+        for( k = e0; k < e0 + cn; k++ )                                     \
+            g[k] = pad[k];                                                  \
+        for( ; k < e1; k++ )                                                \
+            g[k] = op( g[k - cn], pad[k] );                                 \
+    }                                                                       \
+                                                                            \
+    icv##name##RowOp_##flavor( h, g + (ksize - 1)*cn, dst, width*cn );      \
+}
+
+
+ICV_DEF_MORPH_ROW_OP( Erode, 8u, uchar, ICV_MORPH_MIN, ICV_MORPH_VEC_OP_8U(_mm_min_epu8) )
+ICV_DEF_MORPH_ROW_OP( Dilate, 8u, uchar, ICV_MORPH_MAX, ICV_MORPH_VEC_OP_8U(_mm_max_epu8) )
+ICV_DEF_MORPH_ROW_OP( Erode, 16u, ushort, ICV_MORPH_MIN, ICV_MORPH_VEC_OP_16U(icvMorphMin16u) )
+ICV_DEF_MORPH_ROW_OP( Dilate, 16u, ushort, ICV_MORPH_MAX, ICV_MORPH_VEC_OP_16U(icvMorphMax16u) )
+ICV_DEF_MORPH_ROW_OP( Erode, 32f, float, ICV_MORPH_MIN, ICV_MORPH_VEC_OP_32F(_mm_min_ps) )
+ICV_DEF_MORPH_ROW_OP( Dilate, 32f, float, ICV_MORPH_MAX, ICV_MORPH_VEC_OP_32F(_mm_max_ps) )
+
+ICV_DEF_MORPH_VHGW_ROW( Erode, 8u, uchar, ICV_MORPH_MIN )
+ICV_DEF_MORPH_VHGW_ROW( Dilate, 8u, uchar, ICV_MORPH_MAX )
+ICV_DEF_MORPH_VHGW_ROW( Erode, 16u, ushort, ICV_MORPH_MIN )
+ICV_DEF_MORPH_VHGW_ROW( Dilate, 16u, ushort, ICV_MORPH_MAX )
+ICV_DEF_MORPH_VHGW_ROW( Erode, 32f, float, ICV_MORPH_MIN )
+ICV_DEF_MORPH_VHGW_ROW( Dilate, 32f, float, ICV_MORPH_MAX )
+
+
+/* Computes rows [y0,y1) of the extremum over the vertical ksize-pixel
+   windows, the same way icv*VHGWRow_* do it for the rows, but with whole
+   row segments as the elements, so every operation is a vectorized row_op.
+   If merge != 0, the result is combined with the current dst content.
+   buf must hold (y1 - y0 + ksize + 1)*ICV_MORPH_STRIP_SIZE bytes */
+#define ICV_MORPH_SRC_ROW( i ) \
+    (src + MIN( MAX( y0 - anchor + (i), 0 ), height - 1 )*src_step + x)
+
+static void
+icvMorphVHGWCols( const uchar* src, int src_step, uchar* dst, int dst_step,
+                  int width_n, int height, int y0, int y1, int ksize, int anchor,
+                  int elem_size, CvMorphRowOpFunc row_op, int merge, uchar* buf )
+{
+    const int strip = ICV_MORPH_STRIP_SIZE;
+    int n = y1 - y0 + ksize - 1;
+    uchar* g = buf;
+    uchar* t = g + strip;
+    uchar* h = t + strip;
+    int x, i, k;
+
+    for( x = 0; x < width_n; x += strip )
+    {
+        int sw = MIN( strip, width_n - x ), len = sw/elem_size;
+        const uchar* gptr = 0;
+
+        if( ksize == 1 )
+        {
+            for( i = y0; i < y1; i++ )
+            {
+                uchar* d = dst + i*dst_step + x;
+                if( merge )
+                    row_op( ICV_MORPH_SRC_ROW(i - y0), d, d, len );
+                else
+                    memcpy( d, ICV_MORPH_SRC_ROW(i - y0), sw );
+            }
+            continue;
+        }
+
+        /* suffix extrema of the blocks */
+        for( i = 0; i < n; i += ksize )
+        {
+            int i1 = MIN( i + ksize, n );
+            memcpy( h + (i1 - 1)*strip, ICV_MORPH_SRC_ROW(i1 - 1), sw );
+            for( k = i1 - 2; k >= i; k-- )
+                row_op( ICV_MORPH_SRC_ROW(k), h + (k + 1)*strip, h + k*strip, len );
+        }
+
+        /* prefix extrema, combined with the suffix extrema of the window start */
+        for( i = 0; i < n; i++ )
+        {
+            if( i % ksize == 0 )
+                gptr = ICV_MORPH_SRC_ROW(i);
+            else
+            {
+                row_op( gptr, ICV_MORPH_SRC_ROW(i), g, len );
+                gptr = g;
+            }
+
+            if( i >= ksize - 1 )
+            {
+                int j = i - ksize + 1;
+                uchar* d = dst + (y0 + j)*dst_step + x;
+
+                if( merge )
+                {
+                    row_op( h + j*strip, gptr, t, len );
+                    row_op( t, d, d, len );
+                }
+                else
+                    row_op( h + j*strip, gptr, d, len );
+            }
+        }
+    }
+}
+
+#undef ICV_MORPH_SRC_ROW
+
+
+/* Erodes (mop == 0) or dilates src with the union of the rectangles,
+   given in the coordinates of the element with the anchor at anchor.
+   The replicated border is used. dst may be the same array as src only
+   when there is a single rectangle */
+static void
+icvMorphRects( const CvMat* src, CvMat* dst, const CvRect* rects, int count,
+               CvPoint anchor, int mop )
+{
+    CvMat* temp = 0;
+    uchar* buffer = 0;
+
+    CV_FUNCNAME( "icvMorphRects" );
+
+    __BEGIN__;
+
+    int depth = CV_MAT_DEPTH(src->type), cn = CV_MAT_CN(src->type);
+    int elem_size = CV_ELEM_SIZE(depth);
+    CvSize size = cvGetMatSize( src );
+    int width_n = size.width*cn*elem_size;
+    int src_step = src->step ? src->step : CV_STUB_STEP;
+    int dst_step = dst->step ? dst->step : CV_STUB_STEP;
+    int threads = cvGetNumThreads(), max_kw = 1, max_kh = 1, k;
+    size_t hbuf_size, vbuf_size, buf_size;
+    CvMorphRowOpFunc row_op;
+    CvMorphVHGWRowFunc row_func;
+
+    if( depth == CV_8U )
+    {
+        row_op = mop == 0 ? (CvMorphRowOpFunc)icvErodeRowOp_8u :
+                            (CvMorphRowOpFunc)icvDilateRowOp_8u;
+        row_func = mop == 0 ? (CvMorphVHGWRowFunc)icvErodeVHGWRow_8u :
+                              (CvMorphVHGWRowFunc)icvDilateVHGWRow_8u;
+    }
+    else if( depth == CV_16U )
+    {
+        row_op = mop == 0 ? (CvMorphRowOpFunc)icvErodeRowOp_16u :
+                            (CvMorphRowOpFunc)icvDilateRowOp_16u;
+        row_func = mop == 0 ? (CvMorphVHGWRowFunc)icvErodeVHGWRow_16u :
+                              (CvMorphVHGWRowFunc)icvDilateVHGWRow_16u;
+    }
+    else if( depth == CV_32F )
+    {
+        row_op = mop == 0 ? (CvMorphRowOpFunc)icvErodeRowOp_32f :
+                            (CvMorphRowOpFunc)icvDilateRowOp_32f;
+        row_func = mop == 0 ? (CvMorphVHGWRowFunc)icvErodeVHGWRow_32f :
+                              (CvMorphVHGWRowFunc)icvDilateVHGWRow_32f;
+    }
+    else
+        CV_ERROR( CV_StsUnsupportedFormat, "" );
+
+    for( k = 0; k < count; k++ )
+    {
+        max_kw = MAX( max_kw, rects[k].width );
+        max_kh = MAX( max_kh, rects[k].height );
+    }
+
+    if( size.width*size.height < ICV_MORPH_PARALLEL_MIN_SIZE )
+        threads = 1;
+    threads = MAX( MIN( threads, size.height ), 1 );
+
+    hbuf_size = (size_t)(size.width + max_kw - 1)*cn*elem_size*3;
+    vbuf_size = (size_t)((size.height + threads - 1)/threads + max_kh + 1)*
+                ICV_MORPH_STRIP_SIZE;
+    buf_size = cvAlign( (int)MAX( hbuf_size, vbuf_size ), 16 );
+
+    CV_CALL( temp = cvCreateMat( size.height, size.width, src->type ));
+    CV_CALL( buffer = (uchar*)cvAlloc( buf_size*threads ));
+
+    for( k = 0; k < count; k++ )
+    {
+        CvRect r = rects[k];
+        CvPoint a = cvPoint( anchor.x - r.x, anchor.y - r.y );
+        const uchar* vsrc = temp->data.ptr;
+        int vsrc_step = temp->step;
+        int t;
+
+        if( r.height == 1 && a.y == 0 && k == 0 )
+        {
+            // a single row pass; the row is copied to the buffer
+            // before it is processed, so in-place operation is fine
+#ifdef _OPENMP
+            #pragma omp parallel for num_threads(threads), schedule(static)
+#endif
+            for( t = 0; t < threads; t++ )
+            {
+                int y, y1 = size.height*(t+1)/threads;
+                uchar* buf = buffer + t*buf_size;
+                for( y = size.height*t/threads; y < y1; y++ )
+                    row_func( src->data.ptr + y*src_step, dst->data.ptr + y*dst_step,
+                              size.width, cn, r.width, a.x, buf );
+            }
+            continue;
+        }
+
+        if( r.width > 1 || a.x != 0 || src->data.ptr == dst->data.ptr )
+        {
+#ifdef _OPENMP
+            #pragma omp parallel for num_threads(threads), schedule(static)
+#endif
+            for( t = 0; t < threads; t++ )
+            {
+                int y, y1 = size.height*(t+1)/threads;
+                uchar* buf = buffer + t*buf_size;
+                for( y = size.height*t/threads; y < y1; y++ )
+                    row_func( src->data.ptr + y*src_step, temp->data.ptr + y*temp->step,
+                              size.width, cn, r.width, a.x, buf );
+            }
+        }
+        else
+        {
+            vsrc = src->data.ptr;
+            vsrc_step = src_step;
+        }
+
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(threads), schedule(static)
+#endif
+        for( t = 0; t < threads; t++ )
+            icvMorphVHGWCols( vsrc, vsrc_step, dst->data.ptr, dst_step, width_n,
+                              size.height, size.height*t/threads,
+                              size.height*(t+1)/threads, r.height, a.y,
+                              elem_size, row_op, k > 0, buffer + t*buf_size );
+    }
+
+    __END__;
+
+    cvFree( &buffer );
+    cvReleaseMat( &temp );
+}
+
+
+/* Represents the element as a union of rectangles: every run of nonzero
+   pixels in a row, extended over the adjacent rows that contain it.
+   For convex elements, such as ellipses and crosses, there are as many
+   rectangles as there are distinct row runs. Returns the number of them */
+static int
+icvMorphDecompose( const int* values, int rows, int cols, CvRect* rects )
+{
+    int i, j, count = 0;
+
+    for( i = 0; i < rows; i++ )
+    {
+        const int* row = values + i*cols;
+
+        for( j = 0; j < cols; )
+        {
+            int j1, i0, i1, x, k;
+            CvRect r;
+
+            if( !row[j] )
+            {
+                j++;
+                continue;
+            }
+
+            for( j1 = j + 1; j1 < cols && row[j1]; j1++ )
+                ;
+
+            for( i0 = i; i0 > 0; i0-- )
+            {
+                const int* prev = values + (i0 - 1)*cols;
+                for( x = j; x < j1 && prev[x]; x++ )
+                    ;
+                if( x < j1 )
+                    break;
+            }
+
+            for( i1 = i + 1; i1 < rows; i1++ )
+            {
+                const int* next = values + i1*cols;
+                for( x = j; x < j1 && next[x]; x++ )
+                    ;
+                if( x < j1 )
+                    break;
+            }
+
+            r = cvRect( j, i0, j1 - j, i1 - i0 );
+            for( k = 0; k < count; k++ )
+                if( rects[k].x == r.x && rects[k].y == r.y &&
+                    rects[k].width == r.width && rects[k].height == r.height )
+                    break;
+            if( k == count )
+                rects[count++] = r;
+
+            j = j1;
+        }
+    }
+
+    return count;
+}
+
 /////////////////////////////////// External Interface /////////////////////////////////////
 
 
@@ -787,6 +1215,7 @@ icvMorphOp( const void* srcarr, void* dstarr, IplConvKernel* element,
     int local_alloc = 0;
     void* morphstate = 0;
     CvMat* temp = 0;
+    CvRect* rects = 0;
 
     CV_FUNCNAME( "icvMorphOp" );
 
@@ -799,7 +1228,7 @@ icvMorphOp( const void* srcarr, void* dstarr, IplConvKernel* element,
     CvSize size, el_size;
     CvPoint el_anchor;
     int el_shape;
-    int type;
+    int type, depth;
     bool inplace;
 
     if( !CV_IS_MAT(src) )
@@ -1023,6 +1452,61 @@ icvMorphOp( const void* srcarr, void* dstarr, IplConvKernel* element,
         }
     }
 
+    depth = CV_MAT_DEPTH( type );
+    if( depth == CV_8U || depth == CV_16U || depth == CV_32F )
+    {
+        int rect_count = 1, nz = 0;
+
+        if( el_shape == CV_SHAPE_RECT )
+        {
+            CV_CALL( rects = (CvRect*)cvAlloc( sizeof(rects[0]) ));
+            rects[0] = cvRect( 0, 0, el_size.width, el_size.height );
+        }
+        else
+        {
+            int el_len = el_size.width*el_size.height;
+
+            CV_CALL( rects = (CvRect*)cvAlloc( el_size.height*
+                                ((el_size.width + 1)/2)*sizeof(rects[0]) ));
+            rect_count = icvMorphDecompose( element->values, el_size.height,
+                                            el_size.width, rects );
+            for( i = 0, nz = 0; i < el_len; i++ )
+                nz += element->values[i] != 0;
+
+            if( rect_count == 0 )
+            {
+                // an empty element is replaced with the anchor point
+                rects[0] = cvRect( el_anchor.x, el_anchor.y, 1, 1 );
+                rect_count = 1;
+            }
+        }
+
+        // 16u arrays are only supported by the decomposition
+        if( el_shape == CV_SHAPE_RECT || rect_count*ICV_MORPH_RECT_COST <= nz ||
+            depth == CV_16U )
+        {
+            for( i = 0; i < iterations; i++ )
+            {
+                if( rect_count > 1 && src->data.ptr == dst->data.ptr )
+                {
+                    if( !temp )
+                    {
+                        CV_CALL( temp = cvCloneMat( src ));
+                    }
+                    else
+                    {
+                        CV_CALL( cvCopy( src, temp ));
+                    }
+                    src = temp;
+                }
+
+                CV_CALL( icvMorphRects( src, dst, rects, rect_count, el_anchor, mop ));
+                src = dst;
+            }
+            EXIT;
+        }
+    }
+
     if( el_shape != CV_SHAPE_RECT )
     {
         el_hdr = cvMat( element->nRows, element->nCols, CV_32SC1, element->values );
@@ -1046,6 +1530,7 @@ icvMorphOp( const void* srcarr, void* dstarr, IplConvKernel* element,
     if( morphstate )
         icvMorphFree_p( morphstate );
     cvReleaseMat( &temp );
+    cvFree( &rects );
 }
 
 
@@ -1137,6 +1137,472 @@ cvPyrDown( const void* srcarr, void* dstarr, int _filter )
 }
 
 
+/****************************************************************************************\
+                        Banded down-sampling for image pyramids
+\****************************************************************************************/
+
+/* The functions below compute an arbitrary range of rows of the down-sampled image
+   [(src_width+1)/2 x (src_height+1)/2], with reflect-101 borders, so that a level can
+   be split into bands filtered by different threads. Each band keeps a ring buffer of
+   five horizontally filtered source rows. */
+
+static inline int icvReflect101( int i, int n )
+{
+    if( n == 1 )
+        return 0;
+    for(;;)
+    {
+        if( i < 0 )
+            i = -i;
+        else if( i >= n )
+            i = 2*n - 2 - i;
+        else
+            return i;
+    }
+}
+
+#if CV_SSE2
+
+/* horizontal pass over the interior outputs [x, x1) of a single-channel row;
+   returns the first output that was not processed */
+static int
+icvPyrDownRow_8u_C1_SSE2( const uchar* src, int* row, int x, int x1, int width )
+{
+    __m128i mask = _mm_set1_epi16( 255 ), z = _mm_setzero_si128();
+
+    for( ; x <= x1 - 8 && 2*x + 18 <= width; x += 8 )
+    {
+        const uchar* p = src + x*2 - 2;
+        __m128i a = _mm_loadu_si128( (const __m128i*)p );
+        __m128i b = _mm_loadu_si128( (const __m128i*)(p + 2) );
+        __m128i c = _mm_loadu_si128( (const __m128i*)(p + 4) );
+        __m128i e1 = _mm_and_si128( b, mask );
+        __m128i o = _mm_add_epi16( _mm_srli_epi16( a, 8 ), _mm_srli_epi16( b, 8 ));
+        __m128i s = _mm_add_epi16( _mm_and_si128( a, mask ), _mm_and_si128( c, mask ));
+
+        s = _mm_add_epi16( s, _mm_slli_epi16( o, 2 ));
+        s = _mm_add_epi16( s, _mm_add_epi16( _mm_slli_epi16( e1, 2 ), _mm_slli_epi16( e1, 1 )));
+        _mm_storeu_si128( (__m128i*)(row + x), _mm_unpacklo_epi16( s, z ));
+        _mm_storeu_si128( (__m128i*)(row + x + 4), _mm_unpackhi_epi16( s, z ));
+    }
+    return x;
+}
+
+static int
+icvPyrDownRow_32f_C1_SSE2( const float* src, float* row, int x, int x1, int width )
+{
+    __m128 k4 = _mm_set1_ps(4.f), k6 = _mm_set1_ps(6.f);
+
+    for( ; x <= x1 - 4 && 2*x + 10 <= width; x += 4 )
+    {
+        const float* p = src + x*2 - 2;
+        __m128 a = _mm_loadu_ps( p ), b = _mm_loadu_ps( p + 4 );
+        __m128 c = _mm_loadu_ps( p + 2 ), d = _mm_loadu_ps( p + 6 );
+        __m128 e = _mm_loadu_ps( p + 8 );
+        __m128 x0 = _mm_shuffle_ps( a, b, _MM_SHUFFLE(2,0,2,0) );
+        __m128 x1_ = _mm_shuffle_ps( a, b, _MM_SHUFFLE(3,1,3,1) );
+        __m128 x2 = _mm_shuffle_ps( c, d, _MM_SHUFFLE(2,0,2,0) );
+        __m128 x3 = _mm_shuffle_ps( c, d, _MM_SHUFFLE(3,1,3,1) );
+        __m128 x4 = _mm_shuffle_ps( b, e, _MM_SHUFFLE(2,0,2,0) );
+
+        /* the same order of operations as PD_FILTER */
+        __m128 s = _mm_add_ps( _mm_mul_ps( x2, k6 ), _mm_mul_ps( _mm_add_ps( x1_, x3 ), k4 ));
+        _mm_storeu_ps( row + x, _mm_add_ps( _mm_add_ps( s, x0 ), x4 ));
+    }
+    return x;
+}
+
+static int
+icvPyrDownRow_16u_C1_SSE2( const ushort* src, int* row, int x, int x1, int width )
+{
+    __m128i mask = _mm_set1_epi32( 65535 );
+
+    for( ; x <= x1 - 4 && 2*x + 10 <= width; x += 4 )
+    {
+        const ushort* p = src + x*2 - 2;
+        __m128i a = _mm_loadu_si128( (const __m128i*)p );
+        __m128i b = _mm_loadu_si128( (const __m128i*)(p + 2) );
+        __m128i c = _mm_loadu_si128( (const __m128i*)(p + 4) );
+        __m128i e1 = _mm_and_si128( b, mask );
+        __m128i o = _mm_add_epi32( _mm_srli_epi32( a, 16 ), _mm_srli_epi32( b, 16 ));
+        __m128i s = _mm_add_epi32( _mm_and_si128( a, mask ), _mm_and_si128( c, mask ));
+
+        s = _mm_add_epi32( s, _mm_slli_epi32( o, 2 ));
+        s = _mm_add_epi32( s, _mm_add_epi32( _mm_slli_epi32( e1, 2 ), _mm_slli_epi32( e1, 1 )));
+        _mm_storeu_si128( (__m128i*)(row + x), s );
+    }
+    return x;
+}
+
+static inline __m128i icvPyrDownCol4_32s( const int** rows, int x )
+{
+    __m128i r0 = _mm_loadu_si128( (const __m128i*)(rows[0] + x) );
+    __m128i r1 = _mm_loadu_si128( (const __m128i*)(rows[1] + x) );
+    __m128i r2 = _mm_loadu_si128( (const __m128i*)(rows[2] + x) );
+    __m128i r3 = _mm_loadu_si128( (const __m128i*)(rows[3] + x) );
+    __m128i r4 = _mm_loadu_si128( (const __m128i*)(rows[4] + x) );
+    __m128i t = _mm_add_epi32( _mm_add_epi32( r0, r4 ), _mm_set1_epi32( 1 << 7 ));
+    t = _mm_add_epi32( t, _mm_slli_epi32( _mm_add_epi32( r1, r3 ), 2 ));
+    t = _mm_add_epi32( t, _mm_add_epi32( _mm_slli_epi32( r2, 2 ), _mm_slli_epi32( r2, 1 )));
+    return _mm_srai_epi32( t, 8 );
+}
+
+static int
+icvPyrDownCol_16u_SSE2( const int** rows, ushort* dst, int width )
+{
+    int x = 0;
+    __m128i bias = _mm_set1_epi32( 32768 ), flip = _mm_set1_epi16( (short)0x8000 );
+
+    for( ; x <= width - 8; x += 8 )
+    {
+        __m128i s0 = _mm_sub_epi32( icvPyrDownCol4_32s( rows, x ), bias );
+        __m128i s1 = _mm_sub_epi32( icvPyrDownCol4_32s( rows, x + 4 ), bias );
+        _mm_storeu_si128( (__m128i*)(dst + x),
+                          _mm_xor_si128( _mm_packs_epi32( s0, s1 ), flip ));
+    }
+    return x;
+}
+
+static int
+icvPyrDownCol_8u_SSE2( const int** rows, uchar* dst, int width )
+{
+    int x = 0;
+
+    for( ; x <= width - 8; x += 8 )
+    {
+        __m128i s0 = icvPyrDownCol4_32s( rows, x );
+        __m128i s1 = icvPyrDownCol4_32s( rows, x + 4 );
+        s0 = _mm_packs_epi32( s0, s1 );
+        _mm_storel_epi64( (__m128i*)(dst + x), _mm_packus_epi16( s0, s0 ));
+    }
+    return x;
+}
+
+static int
+icvPyrDownCol_32f_SSE2( const float** rows, float* dst, int width )
+{
+    int x = 0;
+    __m128 k4 = _mm_set1_ps(4.f), k6 = _mm_set1_ps(6.f);
+    __m128 scale = _mm_set1_ps(0.00390625f);
+
+    for( ; x <= width - 4; x += 4 )
+    {
+        __m128 r0 = _mm_loadu_ps( rows[0] + x ), r1 = _mm_loadu_ps( rows[1] + x );
+        __m128 r2 = _mm_loadu_ps( rows[2] + x ), r3 = _mm_loadu_ps( rows[3] + x );
+        __m128 r4 = _mm_loadu_ps( rows[4] + x );
+        __m128 s = _mm_add_ps( _mm_mul_ps( r2, k6 ), _mm_mul_ps( _mm_add_ps( r1, r3 ), k4 ));
+        s = _mm_add_ps( _mm_add_ps( s, r0 ), r4 );
+        _mm_storeu_ps( dst + x, _mm_mul_ps( s, scale ));
+    }
+    return x;
+}
+
+#define ICV_PYR_DOWN_ROW_SSE2_8u( src, row, x, x1, width, cn ) \
+    ((cn) == 1 ? icvPyrDownRow_8u_C1_SSE2( (src), (row), (x), (x1), (width) ) : (x))
+#define ICV_PYR_DOWN_ROW_SSE2_16u( src, row, x, x1, width, cn ) \
+    ((cn) == 1 ? icvPyrDownRow_16u_C1_SSE2( (src), (row), (x), (x1), (width) ) : (x))
+#define ICV_PYR_DOWN_ROW_SSE2_32f( src, row, x, x1, width, cn ) \
+    ((cn) == 1 ? icvPyrDownRow_32f_C1_SSE2( (src), (row), (x), (x1), (width) ) : (x))
+#define ICV_PYR_DOWN_COL_SSE2_8u( rows, dst, width ) \
+    icvPyrDownCol_8u_SSE2( (rows), (dst), (width) )
+#define ICV_PYR_DOWN_COL_SSE2_16u( rows, dst, width ) \
+    icvPyrDownCol_16u_SSE2( (rows), (dst), (width) )
+#define ICV_PYR_DOWN_COL_SSE2_32f( rows, dst, width ) \
+    icvPyrDownCol_32f_SSE2( (rows), (dst), (width) )
+
+#else
+
+#define ICV_PYR_DOWN_ROW_SSE2_8u( src, row, x, x1, width, cn )  (x)
+#define ICV_PYR_DOWN_ROW_SSE2_16u( src, row, x, x1, width, cn ) (x)
+#define ICV_PYR_DOWN_ROW_SSE2_32f( src, row, x, x1, width, cn ) (x)
+#define ICV_PYR_DOWN_COL_SSE2_8u( rows, dst, width )  0
+#define ICV_PYR_DOWN_COL_SSE2_16u( rows, dst, width ) 0
+#define ICV_PYR_DOWN_COL_SSE2_32f( rows, dst, width ) 0
+
+#endif
+
+#define ICV_PYR_DOWN_ROW_SSE2_16s( src, row, x, x1, width, cn ) (x)
+#define ICV_PYR_DOWN_ROW_SSE2_64f( src, row, x, x1, width, cn ) (x)
+#define ICV_PYR_DOWN_COL_SSE2_16s( rows, dst, width ) 0
+#define ICV_PYR_DOWN_COL_SSE2_64f( rows, dst, width ) 0
+
+
+#define ICV_DEF_PYR_DOWN_BAND_FUNC( flavor, type, worktype, _pd_scale_ )                \
+static void                                                                             \
+icvPyrDownRow_##flavor( const type* src, worktype* row, int W, int Wd, int cn )         \
+{                                                                                       \
+    /* outputs [1,x1) have all their taps inside the row */                             \
+    int x, c, x1 = MIN( Wd, (W - 1)/2 );                                                \
+                                                                                        \
+    for( x = 0; x < Wd; x++ )                                                           \
+    {                                                                                   \
+        if( x == 1 && x1 > 1 )                                                          \
+        {                                                                               \
+            x = ICV_PYR_DOWN_ROW_SSE2_##flavor( src, row, x, x1, W, cn );               \
+            if( cn == 1 )                                                               \
+                for( ; x < x1; x++ )                                                    \
+                    row[x] = PD_FILTER( src[x*2-2], src[x*2-1], src[x*2],               \
+                                        src[x*2+1], src[x*2+2] );                       \
+            else if( cn == 3 )                                                          \
+                for( ; x < x1; x++ )                                                    \
+                {                                                                       \
+                    const type* s = src + x*6;                                          \
+                    row[x*3] = PD_FILTER( s[-6], s[-3], s[0], s[3], s[6] );             \
+                    row[x*3+1] = PD_FILTER( s[-5], s[-2], s[1], s[4], s[7] );           \
+                    row[x*3+2] = PD_FILTER( s[-4], s[-1], s[2], s[5], s[8] );           \
+                }                                                                       \
+            else                                                                        \
+                for( ; x < x1; x++ )                                                    \
+                    for( c = 0; c < cn; c++ )                                           \
+                    {                                                                   \
+                        const type* s = src + x*2*cn + c;                               \
+                        row[x*cn + c] = PD_FILTER( s[-cn*2], s[-cn], s[0],              \
+                                                   s[cn], s[cn*2] );                    \
+                    }                                                                   \
+            if( x >= Wd )                                                               \
+                break;                                                                  \
+        }                                                                               \
+                                                                                        \
+        {                                                                               \
+        int t0 = icvReflect101( x*2 - 2, W )*cn, t1 = icvReflect101( x*2 - 1, W )*cn;   \
+        int t2 = icvReflect101( x*2, W )*cn, t3 = icvReflect101( x*2 + 1, W )*cn;       \
+        int t4 = icvReflect101( x*2 + 2, W )*cn;                                        \
+        for( c = 0; c < cn; c++ )                                                       \
+            row[x*cn + c] = PD_FILTER( src[t0+c], src[t1+c], src[t2+c],                 \
+                                       src[t3+c], src[t4+c] );                          \
+        }                                                                               \
+    }                                                                                   \
+}                                                                                       \
+                                                                                        \
+                                                                                        \
+static void                                                                             \
+icvPyrDownBand_##flavor( const type* src, int srcstep, CvSize src_size,                 \
+                         type* dst, int dststep, CvSize dst_size,                       \
+                         int y0, int y1, worktype* buf, int cn )                        \
+{                                                                                       \
+    int x, y, k, Wdn = dst_size.width*cn;                                               \
+    worktype* ring[5];                                                                  \
+    const worktype* rows[5];                                                            \
+                                                                                        \
+    srcstep /= sizeof(src[0]); dststep /= sizeof(dst[0]);                               \
+    for( k = 0; k < 5; k++ )                                                            \
+        ring[k] = buf + k*Wdn;                                                          \
+                                                                                        \
+    for( y = y0; y < y1; y++ )                                                          \
+    {                                                                                   \
+        type* d = dst + y*dststep;                                                      \
+                                                                                        \
+        /* virtual source row r is kept in ring[(r+2) % 5] */                           \
+        for( k = y == y0 ? -2 : 1; k <= 2; k++ )                                        \
+        {                                                                               \
+            int r = y*2 + k;                                                            \
+            icvPyrDownRow_##flavor( src + icvReflect101( r, src_size.height )*srcstep,  \
+                                    ring[(r + 2) % 5], src_size.width,                  \
+                                    dst_size.width, cn );                               \
+        }                                                                               \
+                                                                                        \
+        for( k = 0; k < 5; k++ )                                                        \
+            rows[k] = ring[(y*2 + k) % 5];                                              \
+                                                                                        \
+        x = ICV_PYR_DOWN_COL_SSE2_##flavor( rows, d, Wdn );                             \
+        {                                                                               \
+        const worktype *r0 = rows[0], *r1 = rows[1], *r2 = rows[2];                     \
+        const worktype *r3 = rows[3], *r4 = rows[4];                                    \
+        for( ; x < Wdn; x++ )                                                           \
+            d[x] = (type)_pd_scale_( PD_FILTER( r0[x], r1[x], r2[x], r3[x], r4[x] ));   \
+        }                                                                               \
+    }                                                                                   \
+}
+
+
+ICV_DEF_PYR_DOWN_BAND_FUNC( 8u, uchar, int, PD_SCALE_INT )
+ICV_DEF_PYR_DOWN_BAND_FUNC( 16s, short, int, PD_SCALE_INT )
+ICV_DEF_PYR_DOWN_BAND_FUNC( 16u, ushort, int, PD_SCALE_INT )
+ICV_DEF_PYR_DOWN_BAND_FUNC( 32f, float, float, PD_SCALE_FLT )
+ICV_DEF_PYR_DOWN_BAND_FUNC( 64f, double, double, PD_SCALE_FLT )
+
+typedef void (*CvPyrDownBandFunc)( const void* src, int srcstep, CvSize src_size,
+                                   void* dst, int dststep, CvSize dst_size,
+                                   int y0, int y1, void* buf, int cn );
+
+static void icvInitPyrDownBandTable( CvFuncTable* tab )
+{
+    tab->fn_2d[CV_8U] = (void*)icvPyrDownBand_8u;
+    tab->fn_2d[CV_8S] = 0;
+    tab->fn_2d[CV_16S] = (void*)icvPyrDownBand_16s;
+    tab->fn_2d[CV_16U] = (void*)icvPyrDownBand_16u;
+    tab->fn_2d[CV_32F] = (void*)icvPyrDownBand_32f;
+    tab->fn_2d[CV_64F] = (void*)icvPyrDownBand_64f;
+}
+
+
+/* Down-samples src into dst [(w+1)/2 x (h+1)/2] splitting the rows between threads.
+   The ring buffers of all the bands live in *buffer, which is grown when needed and
+   can be kept by the caller between calls. */
+CvStatus
+icvPyrDownParallel( const CvMat* src, CvMat* dst, uchar** buffer, int* buffer_size )
+{
+    static CvFuncTable pyrdown_tab;
+    static int inittab = 0;
+
+    int type = CV_MAT_TYPE(src->type), depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
+    int wsz = depth <= CV_32S ? sizeof(int) : depth == CV_32F ? sizeof(float) : sizeof(double);
+    int band_size, nbands, band;
+    CvPyrDownBandFunc func;
+
+    if( !inittab )
+    {
+        icvInitPyrDownBandTable( &pyrdown_tab );
+        inittab = 1;
+    }
+
+    func = (CvPyrDownBandFunc)pyrdown_tab.fn_2d[depth];
+    if( !func )
+        return CV_BADDEPTH_ERR;
+
+    if( dst->cols != (src->cols + 1)/2 || dst->rows != (src->rows + 1)/2 ||
+        CV_MAT_TYPE(dst->type) != type )
+        return CV_BADSIZE_ERR;
+
+    nbands = MAX( MIN( cvGetNumThreads(), dst->rows/16 ), 1 );
+    band_size = (int)cvAlign( dst->cols*cn*wsz*5, 16 );
+
+    if( *buffer_size < band_size*nbands )
+    {
+        cvFree( buffer );
+        *buffer_size = 0;
+        *buffer = (uchar*)cvAlloc( band_size*nbands );
+        if( !*buffer )
+            return CV_OUTOFMEM_ERR;
+        *buffer_size = band_size*nbands;
+    }
+
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(nbands), schedule(static)
+#endif
+    for( band = 0; band < nbands; band++ )
+    {
+        int y0 = dst->rows*band/nbands, y1 = dst->rows*(band+1)/nbands;
+        func( src->data.ptr, src->step, cvGetMatSize(src), dst->data.ptr,
+              dst->step, cvGetMatSize(dst), y0, y1, *buffer + band*band_size, cn );
+    }
+
+    return CV_OK;
+}
+
+
+CV_IMPL CvImagePyramid*
+cvCreateImagePyramid( CvSize size, int type, int level_count )
+{
+    CvImagePyramid* pyr = 0;
+
+    CV_FUNCNAME( "cvCreateImagePyramid" );
+
+    __BEGIN__;
+
+    int i, total = 0;
+    CvSize sz = size;
+    type = CV_MAT_TYPE(type);
+
+    if( size.width <= 0 || size.height <= 0 )
+        CV_ERROR( CV_StsOutOfRange, "Non-positive image size" );
+
+    if( level_count < 1 || level_count > CV_MAX_PYRAMID_LEVELS )
+        CV_ERROR( CV_StsOutOfRange, "The number of levels is out of range" );
+
+    if( CV_MAT_DEPTH(type) == CV_8S || CV_MAT_DEPTH(type) == CV_32S )
+        CV_ERROR( CV_StsUnsupportedFormat, "" );
+
+    CV_CALL( pyr = (CvImagePyramid*)cvAlloc( sizeof(*pyr) ));
+    memset( pyr, 0, sizeof(*pyr) );
+    pyr->level_count = level_count;
+    pyr->type = type;
+    cvInitMatHeader( &pyr->levels[0], size.height, size.width, type );
+
+    for( i = 1; i < level_count; i++ )
+    {
+        sz.width = (sz.width + 1)/2;
+        sz.height = (sz.height + 1)/2;
+        cvInitMatHeader( &pyr->levels[i], sz.height, sz.width, type, 0,
+                         (int)cvAlign( sz.width*CV_ELEM_SIZE(type), 16 ));
+        total += (int)cvAlign( sz.width*CV_ELEM_SIZE(type), 16 )*sz.height;
+    }
+
+    if( total > 0 )
+    {
+        uchar* ptr;
+        CV_CALL( pyr->data = ptr = (uchar*)cvAlloc( total ));
+        for( i = 1; i < level_count; i++ )
+        {
+            pyr->levels[i].data.ptr = ptr;
+            ptr += (int)cvAlign( pyr->levels[i].cols*CV_ELEM_SIZE(type), 16 )*
+                   pyr->levels[i].rows;
+        }
+    }
+
+    __END__;
+
+    if( cvGetErrStatus() < 0 )
+        cvReleaseImagePyramid( &pyr );
+
+    return pyr;
+}
+
+
+CV_IMPL void
+cvReleaseImagePyramid( CvImagePyramid** pyramid )
+{
+    CV_FUNCNAME( "cvReleaseImagePyramid" );
+
+    __BEGIN__;
+
+    if( !pyramid )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    if( *pyramid )
+    {
+        CvImagePyramid* pyr = *pyramid;
+        cvFree( &pyr->data );
+        cvFree( &pyr->buffer );
+        cvFree( pyramid );
+    }
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvBuildImagePyramid( const CvArr* srcarr, CvImagePyramid* pyr )
+{
+    CV_FUNCNAME( "cvBuildImagePyramid" );
+
+    __BEGIN__;
+
+    CvMat srcstub, *src = (CvMat*)srcarr;
+    int i;
+
+    CV_CALL( src = cvGetMat( src, &srcstub ));
+
+    if( !pyr )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    if( CV_MAT_TYPE(src->type) != pyr->type )
+        CV_ERROR( CV_StsUnmatchedFormats, "" );
+
+    if( src->cols != pyr->levels[0].cols || src->rows != pyr->levels[0].rows )
+        CV_ERROR( CV_StsUnmatchedSizes, "" );
+
+    cvInitMatHeader( &pyr->levels[0], src->rows, src->cols, pyr->type,
+                     src->data.ptr, src->step );
+
+    for( i = 1; i < pyr->level_count; i++ )
+        IPPI_CALL( icvPyrDownParallel( &pyr->levels[i-1], &pyr->levels[i],
+                                       &pyr->buffer, &pyr->buffer_size ));
+
+    __END__;
+}
+
+
 /* MSVC .NET 2003 spends a long time building this, thus, as the code
    is not performance-critical, we turn off the optimization here */
 #if defined _MSC_VER && _MSC_VER > 1300 && !defined CV_ICC
@@ -219,11 +219,86 @@ icvSumRow_32f64f( const float* src, double* dst, void* params )
 }
 
 
+#define BLUR_SHIFT 24
+
+#if CV_SSE2
+
+/* emits one 8u row of the box filter and slides the column sums. s*iscale
+   may wrap around just like in the scalar code below, and only the low
+   8 bits of the descaled value are kept, so the results are identical */
+static int
+icvSumCol_32s8u_SSE2( const int* sp, const int* sm, int* sum,
+                      uchar* dst, int iscale, int width )
+{
+    int i = 0;
+    __m128i f = _mm_set1_epi32( iscale );
+    __m128i delta = _mm_set1_epi32( 1 << (BLUR_SHIFT - 1) );
+    __m128i mask = _mm_set1_epi32( 255 );
+
+    for( ; i <= width - 8; i += 8 )
+    {
+        __m128i s0 = _mm_add_epi32( _mm_loadu_si128( (const __m128i*)(sum + i) ),
+                                    _mm_loadu_si128( (const __m128i*)(sp + i) ));
+        __m128i s1 = _mm_add_epi32( _mm_loadu_si128( (const __m128i*)(sum + i + 4) ),
+                                    _mm_loadu_si128( (const __m128i*)(sp + i + 4) ));
+        __m128i t0 = _mm_mul_epu32( s0, f ), t1 = _mm_mul_epu32( s1, f );
+        __m128i u0 = _mm_mul_epu32( _mm_srli_epi64( s0, 32 ), f );
+        __m128i u1 = _mm_mul_epu32( _mm_srli_epi64( s1, 32 ), f );
+
+        t0 = _mm_unpacklo_epi32( _mm_shuffle_epi32( t0, _MM_SHUFFLE(0,0,2,0) ),
+                                 _mm_shuffle_epi32( u0, _MM_SHUFFLE(0,0,2,0) ));
+        t1 = _mm_unpacklo_epi32( _mm_shuffle_epi32( t1, _MM_SHUFFLE(0,0,2,0) ),
+                                 _mm_shuffle_epi32( u1, _MM_SHUFFLE(0,0,2,0) ));
+        t0 = _mm_and_si128( _mm_srai_epi32( _mm_add_epi32( t0, delta ), BLUR_SHIFT ), mask );
+        t1 = _mm_and_si128( _mm_srai_epi32( _mm_add_epi32( t1, delta ), BLUR_SHIFT ), mask );
+
+        _mm_storeu_si128( (__m128i*)(sum + i), _mm_sub_epi32( s0,
+                          _mm_loadu_si128( (const __m128i*)(sm + i) )));
+        _mm_storeu_si128( (__m128i*)(sum + i + 4), _mm_sub_epi32( s1,
+                          _mm_loadu_si128( (const __m128i*)(sm + i + 4) )));
+        t0 = _mm_packs_epi32( t0, t1 );
+        _mm_storel_epi64( (__m128i*)(dst + i), _mm_packus_epi16( t0, t0 ));
+    }
+    return i;
+}
+
+static int
+icvSumCol_64f32f_SSE2( const double* sp, const double* sm, double* sum,
+                       float* dst, double scale, int width )
+{
+    int i = 0;
+    __m128d f = _mm_set1_pd( scale );
+
+    for( ; i <= width - 4; i += 4 )
+    {
+        __m128d s0 = _mm_add_pd( _mm_loadu_pd( sum + i ), _mm_loadu_pd( sp + i ));
+        __m128d s1 = _mm_add_pd( _mm_loadu_pd( sum + i + 2 ), _mm_loadu_pd( sp + i + 2 ));
+        __m128 t = _mm_movelh_ps( _mm_cvtpd_ps( _mm_mul_pd( s0, f )),
+                                  _mm_cvtpd_ps( _mm_mul_pd( s1, f )));
+        _mm_storeu_pd( sum + i, _mm_sub_pd( s0, _mm_loadu_pd( sm + i )));
+        _mm_storeu_pd( sum + i + 2, _mm_sub_pd( s1, _mm_loadu_pd( sm + i + 2 )));
+        _mm_storeu_ps( dst + i, t );
+    }
+    return i;
+}
+
+#else
+
+static inline int
+icvSumCol_32s8u_SSE2( const int*, const int*, int*, uchar*, int, int )
+{ return 0; }
+
+static inline int
+icvSumCol_64f32f_SSE2( const double*, const double*, double*, float*, double, int )
+{ return 0; }
+
+#endif
+
+
 static void
 icvSumCol_32s8u( const int** src, uchar* dst,
                  int dst_step, int count, void* params )
 {
-#define BLUR_SHIFT 24
     CvBoxFilter* state = (CvBoxFilter*)params;
     int ksize = state->get_kernel_size().height;
     int i, width = state->get_width();
@@ -257,7 +332,8 @@ icvSumCol_32s8u( const int** src, uchar* dst,
         else
         {
             const int* sm = src[-ksize+1];
-            for( i = 0; i <= width - 2; i += 2 )
+            i = icvSumCol_32s8u_SSE2( sp, sm, sum, dst, iscale, width );
+            for( ; i <= width - 2; i += 2 )
             {
                 int s0 = sum[i] + sp[i], s1 = sum[i+1] + sp[i+1];
                 int t0 = CV_DESCALE(s0*iscale, BLUR_SHIFT), t1 = CV_DESCALE(s1*iscale, BLUR_SHIFT);
@@ -276,9 +352,10 @@ icvSumCol_32s8u( const int** src, uchar* dst,
     }
 
     *_sum_count = sum_count;
-#undef BLUR_SHIFT
 }
 
+#undef BLUR_SHIFT
+
 
 static void
 icvSumCol_32s16s( const int** src, short* dst,
@@ -453,8 +530,9 @@ icvSumCol_64f32f( const double** src, float* dst,
         else
         {
             const double* sm = src[-ksize+1];
+            i = icvSumCol_64f32f_SSE2( sp, sm, sum, dst, normalized ? scale : 1., width );
             if( normalized )
-                for( i = 0; i <= width - 2; i += 2 )
+                for( ; i <= width - 2; i += 2 )
                 {
                     double s0 = sum[i] + sp[i], s1 = sum[i+1] + sp[i+1];
                     double t0 = s0*scale, t1 = s1*scale;
@@ -463,7 +541,7 @@ icvSumCol_64f32f( const double** src, float* dst,
                     sum[i] = s0; sum[i+1] = s1;
                 }
             else
-                for( i = 0; i <= width - 2; i += 2 )
+                for( ; i <= width - 2; i += 2 )
                 {
                     double s0 = sum[i] + sp[i], s1 = sum[i+1] + sp[i+1];
                     dst[i] = (float)s0; dst[i+1] = (float)s1;
@@ -943,6 +1021,174 @@ icvBilateralFiltering_8u_CnR( uchar* src, int srcStep,
 #undef COLOR_DISTANCE_C3
 }
 
+/****************************************************************************************\
+                                Recursive Gaussian Filter
+\****************************************************************************************/
+
+/* Young & van Vliet third-order recursive approximation of the Gaussian:
+   one causal and one anti-causal pass in each direction, so the cost per
+   pixel does not depend on sigma. Pixels outside of the image replicate the
+   border; because the filter has unit gain this is the same as clamping the
+   recursion history to the first (last) sample. */
+static void
+icvRecursiveGaussCoeffs( double sigma, float* c )
+{
+    double q = sigma >= 2.5 ? 0.98711*sigma - 0.96330 :
+                              3.97156 - 4.14554*sqrt(1 - 0.26891*sigma);
+    double q2 = q*q, q3 = q2*q;
+    double b0 = 1.57825 + 2.44413*q + 1.4281*q2 + 0.422205*q3;
+
+    c[1] = (float)((2.44413*q + 2.85619*q2 + 1.26661*q3)/b0);
+    c[2] = (float)(-(1.4281*q2 + 1.26661*q3)/b0);
+    c[3] = (float)(0.422205*q3/b0);
+    c[0] = 1.f - (c[1] + c[2] + c[3]);
+}
+
+
+static void
+icvRecursiveGaussRow_32f( float* row, int len, int cn, const float* c )
+{
+    int i, k;
+
+    for( k = 0; k < cn; k++ )
+    {
+        float* p = row + k;
+        float w1 = p[0], w2 = w1, w3 = w1;
+
+        for( i = 0; i < len*cn; i += cn )
+        {
+            float w = c[0]*p[i] + c[1]*w1 + c[2]*w2 + c[3]*w3;
+            p[i] = w; w3 = w2; w2 = w1; w1 = w;
+        }
+
+        w1 = w2 = w3 = p[(len-1)*cn];
+        for( i = (len-1)*cn; i >= 0; i -= cn )
+        {
+            float w = c[0]*p[i] + c[1]*w1 + c[2]*w2 + c[3]*w3;
+            p[i] = w; w3 = w2; w2 = w1; w1 = w;
+        }
+    }
+}
+
+
+/* runs the vertical recursion over the columns [x0,x1) of a float image;
+   the whole stripe is updated one row at a time to stay cache-friendly */
+static void
+icvRecursiveGaussCols_32f( float* data, int step, int height,
+                           int x0, int x1, const float* c )
+{
+    int x, y;
+
+    for( y = 1; y < height; y++ )
+    {
+        float* p0 = data + y*step;
+        const float* p1 = p0 - step;
+        const float* p2 = data + MAX(y-2,0)*step;
+        const float* p3 = data + MAX(y-3,0)*step;
+
+        x = x0;
+#if CV_SSE2
+        {
+        __m128 c0 = _mm_set1_ps(c[0]), c1 = _mm_set1_ps(c[1]);
+        __m128 c2 = _mm_set1_ps(c[2]), c3 = _mm_set1_ps(c[3]);
+        for( ; x <= x1 - 4; x += 4 )
+        {
+            __m128 w = _mm_add_ps( _mm_mul_ps( c0, _mm_loadu_ps(p0 + x) ),
+                                   _mm_mul_ps( c1, _mm_loadu_ps(p1 + x) ));
+            w = _mm_add_ps( w, _mm_add_ps( _mm_mul_ps( c2, _mm_loadu_ps(p2 + x) ),
+                                           _mm_mul_ps( c3, _mm_loadu_ps(p3 + x) )));
+            _mm_storeu_ps( p0 + x, w );
+        }
+        }
+#endif
+        for( ; x < x1; x++ )
+            p0[x] = c[0]*p0[x] + c[1]*p1[x] + c[2]*p2[x] + c[3]*p3[x];
+    }
+
+    for( y = height - 2; y >= 0; y-- )
+    {
+        float* p0 = data + y*step;
+        const float* p1 = p0 + step;
+        const float* p2 = data + MIN(y+2,height-1)*step;
+        const float* p3 = data + MIN(y+3,height-1)*step;
+
+        x = x0;
+#if CV_SSE2
+        {
+        __m128 c0 = _mm_set1_ps(c[0]), c1 = _mm_set1_ps(c[1]);
+        __m128 c2 = _mm_set1_ps(c[2]), c3 = _mm_set1_ps(c[3]);
+        for( ; x <= x1 - 4; x += 4 )
+        {
+            __m128 w = _mm_add_ps( _mm_mul_ps( c0, _mm_loadu_ps(p0 + x) ),
+                                   _mm_mul_ps( c1, _mm_loadu_ps(p1 + x) ));
+            w = _mm_add_ps( w, _mm_add_ps( _mm_mul_ps( c2, _mm_loadu_ps(p2 + x) ),
+                                           _mm_mul_ps( c3, _mm_loadu_ps(p3 + x) )));
+            _mm_storeu_ps( p0 + x, w );
+        }
+        }
+#endif
+        for( ; x < x1; x++ )
+            p0[x] = c[0]*p0[x] + c[1]*p1[x] + c[2]*p2[x] + c[3]*p3[x];
+    }
+}
+
+
+/* blurs a floating-point image in-place; rows are filtered in parallel,
+   then the columns, split into vertical stripes */
+static void
+icvRecursiveGaussBlur_32f( CvMat* mat, double sigma_x, double sigma_y )
+{
+    #define STRIPE_WIDTH 256
+    float cx[4], cy[4];
+    int cn = CV_MAT_CN(mat->type);
+    int width = mat->cols*cn, height = mat->rows;
+    int step = mat->step/sizeof(float);
+    int nstripes = (width + STRIPE_WIDTH - 1)/STRIPE_WIDTH;
+#ifdef _OPENMP
+    int thread_count = cvGetNumThreads();
+#endif
+    int i;
+
+    icvRecursiveGaussCoeffs( sigma_x, cx );
+    icvRecursiveGaussCoeffs( sigma_y, cy );
+
+    if( mat->cols > 1 )
+    {
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(thread_count), schedule(static)
+#endif
+        for( i = 0; i < height; i++ )
+            icvRecursiveGaussRow_32f( mat->data.fl + i*step, mat->cols, cn, cx );
+    }
+
+    if( height > 1 )
+    {
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(thread_count), schedule(dynamic)
+#endif
+        for( i = 0; i < nstripes; i++ )
+            icvRecursiveGaussCols_32f( mat->data.fl, step, height, i*STRIPE_WIDTH,
+                                       MIN((i+1)*STRIPE_WIDTH, width), cy );
+    }
+
+    #undef STRIPE_WIDTH
+}
+
+
+/* Number of horizontal bands the separable box and Gaussian filters are split
+   into. Every band reads the rows around it straight from the source, so the
+   output does not depend on the split, but this needs src and dst to differ. */
+static int
+icvSmoothBandCount( const CvMat* src, const CvMat* dst, int kheight )
+{
+#ifdef _OPENMP
+    if( src->data.ptr != dst->data.ptr )
+        return MAX( MIN( cvGetNumThreads(), src->rows/(kheight*4 + 16) ), 1 );
+#endif
+    return 1;
+}
+
+
 //////////////////////////////// IPP smoothing functions /////////////////////////////////
 
 icvFilterMedian_8u_C1R_t icvFilterMedian_8u_C1R_p = 0;
@@ -979,7 +1225,7 @@ cvSmooth( const void* srcarr, void* dstarr, int smooth_type,
     CvMat srcstub, *src = (CvMat*)srcarr;
     CvMat dststub, *dst = (CvMat*)dstarr;
     CvSize size;
-    int src_type, dst_type, depth, cn;
+    int src_type, dst_type, depth, cn, nbands;
     double sigma1 = 0, sigma2 = 0;
     bool have_ipp = icvFilterMedian_8u_C1R_p != 0;
 
@@ -1084,7 +1330,27 @@ cvSmooth( const void* srcarr, void* dstarr, int smooth_type,
     {
         CV_CALL( box_filter.init( src->cols, src_type, dst_type,
             smooth_type == CV_BLUR, cvSize(param1, param2) ));
-        CV_CALL( box_filter.process( src, dst ));
+        nbands = icvSmoothBandCount( src, dst, param2 );
+
+        if( nbands == 1 )
+        {
+            CV_CALL( box_filter.process( src, dst ));
+        }
+        else
+        {
+            int band;
+#ifdef _OPENMP
+            #pragma omp parallel for num_threads(nbands), schedule(static)
+#endif
+            for( band = 0; band < nbands; band++ )
+            {
+                int y0 = size.height*band/nbands, y1 = size.height*(band+1)/nbands;
+                CvBoxFilter band_filter( src->cols, src_type, dst_type,
+                    smooth_type == CV_BLUR, cvSize(param1, param2) );
+                band_filter.process( src, dst, cvRect(0, y0, src->cols, y1 - y0),
+                                     cvPoint(0, y0) );
+            }
+        }
     }
     else if( smooth_type == CV_MEDIAN )
     {
@@ -1120,7 +1386,52 @@ cvSmooth( const void* srcarr, void* dstarr, int smooth_type,
         }
 
         CV_CALL( gaussian_filter.init( src->cols, src_type, dst_type, &KX, &KY ));
-        CV_CALL( gaussian_filter.process( src, dst ));
+        nbands = icvSmoothBandCount( src, dst, param2 );
+
+        if( nbands == 1 )
+        {
+            CV_CALL( gaussian_filter.process( src, dst ));
+        }
+        else
+        {
+            int band;
+#ifdef _OPENMP
+            #pragma omp parallel for num_threads(nbands), schedule(static)
+#endif
+            for( band = 0; band < nbands; band++ )
+            {
+                int y0 = size.height*band/nbands, y1 = size.height*(band+1)/nbands;
+                CvSepFilter band_filter( src->cols, src_type, dst_type, &KX, &KY );
+                band_filter.process( src, dst, cvRect(0, y0, src->cols, y1 - y0),
+                                     cvPoint(0, y0) );
+            }
+        }
+    }
+    else if( smooth_type == CV_GAUSSIAN_RECURSIVE )
+    {
+        sigma1 = param3;
+        sigma2 = param4 ? param4 : param3;
+
+        if( sigma1 < 0.5 || sigma2 < 0.5 )
+            CV_ERROR( CV_StsOutOfRange,
+            "Recursive Gaussian filter requires sigma >= 0.5" );
+
+        if( depth != CV_8U && depth != CV_16U && depth != CV_16S && depth != CV_32F )
+            CV_ERROR( CV_StsUnsupportedFormat,
+            "Recursive Gaussian filter only supports 8u, 16u, 16s and 32f images" );
+
+        if( depth == CV_32F )
+        {
+            CV_CALL( cvCopy( src, dst ));
+            icvRecursiveGaussBlur_32f( dst, sigma1, sigma2 );
+        }
+        else
+        {
+            CV_CALL( temp = cvCreateMat( size.height, size.width, CV_MAKETYPE(CV_32F, cn) ));
+            CV_CALL( cvConvert( src, temp ));
+            icvRecursiveGaussBlur_32f( temp, sigma1, sigma2 );
+            CV_CALL( cvConvert( temp, dst ));
+        }
     }
     else if( smooth_type == CV_BILATERAL )
     {
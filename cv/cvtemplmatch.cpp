@@ -48,6 +48,8 @@ icvCrossCorr( const CvArr* _img, const CvArr* _templ, CvArr* _corr, CvPoint anch
     const int min_block_size = 256;
     CvMat* dft_img = 0;
     CvMat* dft_templ = 0;
+    CvDFTPlan* fwd_plan = 0;
+    CvDFTPlan* inv_plan = 0;
     void* buf = 0;
     
     CV_FUNCNAME( "icvCrossCorr" );
@@ -132,6 +134,10 @@ icvCrossCorr( const CvArr* _img, const CvArr* _templ, CvArr* _corr, CvPoint anch
     CV_CALL( dft_img = cvCreateMat( dftsize.height, dftsize.width, max_depth ));
     CV_CALL( dft_templ = cvCreateMat( dftsize.height*templ_cn, dftsize.width, max_depth ));
 
+    // all the blocks are transformed with the same size, so the DFT tables are computed once
+    CV_CALL( fwd_plan = cvCreateDFTPlan( dft_img, dft_img, CV_DXT_FORWARD ));
+    CV_CALL( inv_plan = cvCreateDFTPlan( dft_img, dft_img, CV_DXT_INVERSE ));
+
     if( templ_cn > 1 && templ_depth != max_depth )
         buf_size = templ->cols*templ->rows*CV_ELEM_SIZE(templ_depth);
 
@@ -226,12 +232,12 @@ icvCrossCorr( const CvArr* _img, const CvArr* _templ, CvArr* _corr, CvPoint anch
                     cvZero( dst );
                 }
 
-                cvDFT( dft_img, dft_img, CV_DXT_FORWARD, isz.height );
+                cvExecDFTPlan( dft_img, dft_img, fwd_plan, isz.height );
                 cvGetSubRect( dft_templ, dst,
                     cvRect(0,(templ_cn>1?yofs:0),dftsize.width,dftsize.height) );
 
                 cvMulSpectrums( dft_img, dst, dft_img, CV_DXT_MUL_CONJ );
-                cvDFT( dft_img, dft_img, CV_DXT_INVERSE, csz.height );
+                cvExecDFTPlan( dft_img, dft_img, inv_plan, csz.height );
 
                 src = cvGetSubRect( dft_img, &sstub, cvRect(0,0,csz.width,csz.height) );
                 dst = cvGetSubRect( corr, &dstub, cvRect(x,y,csz.width,csz.height) );
@@ -270,6 +276,8 @@ icvCrossCorr( const CvArr* _img, const CvArr* _templ, CvArr* _corr, CvPoint anch
 
     cvReleaseMat( &dft_img );
     cvReleaseMat( &dft_templ );
+    cvReleaseDFTPlan( &fwd_plan );
+    cvReleaseDFTPlan( &inv_plan );
     cvFree( &buf );
 }
 
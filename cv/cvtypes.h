@@ -314,6 +314,35 @@ typedef struct CvKalman
 CvKalman;
 
 
+/*************************** Precomputed undistortion map *******************************/
+
+/* lens undistortion map in the fixed-point form accepted by cvRemap
+   (see cvConvertMaps); built once and reused for every frame */
+typedef struct CvUndistortMap
+{
+    CvSize size;                /* destination image size the map was built for */
+    CvMat* mapxy;               /* integer source coordinates, 16sC2 */
+    CvMat* mapalpha;            /* packed fractional parts, 16uC1 */
+}
+CvUndistortMap;
+
+
+#define CV_MAX_PYRAMID_LEVELS  16
+
+/* Gaussian image pyramid (see cvBuildImagePyramid). All the levels but the base
+   share one allocation, so the structure can be kept and rebuilt for every frame */
+typedef struct CvImagePyramid
+{
+    int level_count;            /* number of levels, including the base one */
+    int type;                   /* element type of all the levels */
+    CvMat levels[CV_MAX_PYRAMID_LEVELS]; /* level headers; levels[0] refers to the source */
+    uchar* data;                /* storage for levels 1..level_count-1 */
+    uchar* buffer;              /* scratch rows of the filter, grown on demand */
+    int buffer_size;
+}
+CvImagePyramid;
+
+
 /*********************** Haar-like Object Detection structures **************************/
 #define CV_HAAR_MAGIC_VAL    0x42500000
 #define CV_TYPE_NAME_HAAR    "opencv-haar-classifier"
@@ -316,4 +316,100 @@ cvInitUndistortMap( const CvMat* A, const CvMat* dist_coeffs,
     cvFree( &buffer );
 }
 
+
+CV_IMPL CvUndistortMap*
+cvCreateUndistortMap( const CvMat* A, const CvMat* dist_coeffs, CvSize size )
+{
+    CvUndistortMap* map = 0;
+    CvMat* mapx = 0;
+    CvMat* mapy = 0;
+
+    CV_FUNCNAME( "cvCreateUndistortMap" );
+
+    __BEGIN__;
+
+    if( size.width <= 0 || size.height <= 0 )
+        CV_ERROR( CV_StsOutOfRange, "Image size must be positive" );
+
+    if( size.width > SHRT_MAX || size.height > SHRT_MAX )
+        CV_ERROR( CV_StsOutOfRange,
+        "Fixed-point maps are limited to images of 32767x32767 pixels" );
+
+    CV_CALL( map = (CvUndistortMap*)cvAlloc( sizeof(*map) ));
+    memset( map, 0, sizeof(*map) );
+    map->size = size;
+
+    CV_CALL( mapx = cvCreateMat( size.height, size.width, CV_32FC1 ));
+    CV_CALL( mapy = cvCreateMat( size.height, size.width, CV_32FC1 ));
+    CV_CALL( cvInitUndistortMap( A, dist_coeffs, mapx, mapy ));
+
+    CV_CALL( map->mapxy = cvCreateMat( size.height, size.width, CV_16SC2 ));
+    CV_CALL( map->mapalpha = cvCreateMat( size.height, size.width, CV_16UC1 ));
+    CV_CALL( cvConvertMaps( mapx, mapy, map->mapxy, map->mapalpha ));
+
+    __END__;
+
+    cvReleaseMat( &mapx );
+    cvReleaseMat( &mapy );
+
+    if( cvGetErrStatus() < 0 )
+        cvReleaseUndistortMap( &map );
+
+    return map;
+}
+
+
+CV_IMPL void
+cvReleaseUndistortMap( CvUndistortMap** _map )
+{
+    CV_FUNCNAME( "cvReleaseUndistortMap" );
+
+    __BEGIN__;
+
+    CvUndistortMap* map;
+
+    if( !_map )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    map = *_map;
+    if( map )
+    {
+        cvReleaseMat( &map->mapxy );
+        cvReleaseMat( &map->mapalpha );
+        cvFree( _map );
+    }
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvUndistortWithMap( const CvArr* _src, CvArr* _dst, const CvUndistortMap* map )
+{
+    CV_FUNCNAME( "cvUndistortWithMap" );
+
+    __BEGIN__;
+
+    CvMat srcstub, *src = (CvMat*)_src;
+    CvMat dststub, *dst = (CvMat*)_dst;
+
+    if( !map || !map->mapxy || !map->mapalpha )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    CV_CALL( src = cvGetMat( src, &srcstub ));
+    CV_CALL( dst = cvGetMat( dst, &dststub ));
+
+    if( src->data.ptr == dst->data.ptr )
+        CV_ERROR( CV_StsNotImplemented, "In-place undistortion is not implemented" );
+
+    if( !CV_ARE_SIZES_EQ( src, dst ) ||
+        dst->cols != map->size.width || dst->rows != map->size.height )
+        CV_ERROR( CV_StsUnmatchedSizes, "" );
+
+    CV_CALL( cvRemap( src, dst, map->mapxy, map->mapalpha,
+                      CV_INTER_LINEAR + CV_WARP_FILL_OUTLIERS, cvScalarAll(0) ));
+
+    __END__;
+}
+
 /*  End of file  */
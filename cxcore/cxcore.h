@@ -889,6 +889,23 @@ CVAPI(void)  cvDFT( const CvArr* src, CvArr* dst, int flags,
                     int nonzero_rows CV_DEFAULT(0) );
 #define cvFFT cvDFT
 
+/* Precomputed data of cvDFT for the arrays of a particular size, type and layout:
+   the factorization, the twiddle factors, the permutation tables and the scratch
+   buffers of every thread */
+typedef struct CvDFTPlan CvDFTPlan;
+
+/* Creates DFT plan; src and dst are only used as templates of the arrays
+   that are transformed later with the same flags */
+CVAPI(CvDFTPlan*)  cvCreateDFTPlan( const CvArr* src, const CvArr* dst, int flags );
+
+/* Releases DFT plan */
+CVAPI(void)  cvReleaseDFTPlan( CvDFTPlan** plan );
+
+/* Does the same as cvDFT using the plan. The plan keeps the scratch buffers,
+   so it may not be used by several threads at once */
+CVAPI(void)  cvExecDFTPlan( const CvArr* src, CvArr* dst, CvDFTPlan* plan,
+                            int nonzero_rows CV_DEFAULT(0) );
+
 /* Multiply results of DFTs: DFT(X)*DFT(Y) or DFT(X)*conj(DFT(Y)) */
 CVAPI(void)  cvMulSpectrums( const CvArr* src1, const CvArr* src2,
                              CvArr* dst, int flags );
@@ -426,6 +426,218 @@ static const double icv_fft5_5 = 0.363271264002680442947733378740309;
 #define ICV_DFT_NO_PERMUTE 2
 #define ICV_DFT_COMPLEX_INPUT_OR_OUTPUT 4
 
+#if CV_SSE2
+
+/* SSE2 versions of the radix-2, 3, 4 and 5 passes. One complex number is kept
+   in a __m128d register (the real part in the low half) and the operations
+   repeat the scalar code one by one, so the results do not change. The scalar
+   single-precision code computes the twiddle products (and the sums of the
+   first radix-3 butterfly) in float and the rest in double; the ..._32fc
+   macros below do the same. */
+
+// (a.re*w.re - a.im*w.im, a.im*w.re + a.re*w.im)
+CV_INLINE __m128d icvCMul_SSE2( __m128d a, __m128d w )
+{
+    __m128d neg_lo = _mm_castsi128_pd( _mm_set_epi32( 0, 0, (int)0x80000000, 0 ));
+    __m128d t0 = _mm_mul_pd( a, _mm_unpacklo_pd( w, w ));
+    __m128d t1 = _mm_mul_pd( _mm_shuffle_pd( a, a, 1 ), _mm_unpackhi_pd( w, w ));
+    return _mm_add_pd( t0, _mm_xor_pd( t1, neg_lo ));
+}
+
+// the same for the two lower floats
+CV_INLINE __m128 icvCMul32f_SSE2( __m128 a, __m128 w )
+{
+    __m128 neg_lo = _mm_castsi128_ps( _mm_set_epi32( 0, 0, 0, (int)0x80000000 ));
+    __m128 t0 = _mm_mul_ps( a, _mm_shuffle_ps( w, w, _MM_SHUFFLE(0,0,0,0) ));
+    __m128 t1 = _mm_mul_ps( _mm_shuffle_ps( a, a, _MM_SHUFFLE(0,0,0,1) ),
+                            _mm_shuffle_ps( w, w, _MM_SHUFFLE(1,1,1,1) ));
+    return _mm_add_ps( t0, _mm_xor_ps( t1, neg_lo ));
+}
+
+// (a.im - b.im, b.re - a.re), that is -i*(a - b)
+CV_INLINE __m128d icvCRotDiff_SSE2( __m128d a, __m128d b )
+{
+    return _mm_shuffle_pd( _mm_sub_pd( a, b ), _mm_sub_pd( b, a ), 1 );
+}
+
+CV_INLINE __m128 icvCRotDiff32f_SSE2( __m128 a, __m128 b )
+{
+    __m128 t = _mm_unpacklo_ps( _mm_sub_ps( a, b ), _mm_sub_ps( b, a ));
+    return _mm_shuffle_ps( t, t, _MM_SHUFFLE(0,0,1,2) );
+}
+
+#define ICV_DFT_LOAD_32f(p)         _mm_castsi128_ps( _mm_loadl_epi64( (const __m128i*)(p) ))
+
+#define ICV_DFT_LOAD_64fc(p)        _mm_loadu_pd( &(p)->re )
+#define ICV_DFT_STORE_64fc(p,t)     _mm_storeu_pd( &(p)->re, (t) )
+#define ICV_DFT_CMUL_64fc(p,w)      icvCMul_SSE2( ICV_DFT_LOAD_64fc(p), ICV_DFT_LOAD_64fc(w) )
+#define ICV_DFT_SUM_64fc(p,q)       _mm_add_pd( ICV_DFT_LOAD_64fc(p), ICV_DFT_LOAD_64fc(q) )
+#define ICV_DFT_ROT_DIFF_64fc(p,q)  icvCRotDiff_SSE2( ICV_DFT_LOAD_64fc(p), ICV_DFT_LOAD_64fc(q) )
+
+#define ICV_DFT_LOAD_32fc(p)        _mm_cvtps_pd( ICV_DFT_LOAD_32f(p) )
+#define ICV_DFT_STORE_32fc(p,t)     _mm_storel_epi64( (__m128i*)(p), \
+                                        _mm_castps_si128( _mm_cvtpd_ps(t) ))
+#define ICV_DFT_CMUL_32fc(p,w)      _mm_cvtps_pd( icvCMul32f_SSE2( \
+                                        ICV_DFT_LOAD_32f(p), ICV_DFT_LOAD_32f(w) ))
+#define ICV_DFT_SUM_32fc(p,q)       _mm_cvtps_pd( _mm_add_ps( \
+                                        ICV_DFT_LOAD_32f(p), ICV_DFT_LOAD_32f(q) ))
+#define ICV_DFT_ROT_DIFF_32fc(p,q)  _mm_cvtps_pd( icvCRotDiff32f_SSE2( \
+                                        ICV_DFT_LOAD_32f(p), ICV_DFT_LOAD_32f(q) ))
+
+#define ICV_DEF_DFT_PASSES_SSE2( flavor, datatype )                     \
+static void                                                             \
+icvDFTRadix2_##flavor##_SSE2( datatype* dst, int n0, int n, int dw0,    \
+                              const datatype* wave )                    \
+{                                                                       \
+    int i, j, dw, nx = n/2;                                             \
+                                                                        \
+    for( i = 0; i < n0; i += n )                                        \
+        for( j = 0, dw = 0; j < nx; j++, dw += dw0 )                    \
+        {                                                               \
+            datatype* v = dst + i + j;                                  \
+            __m128d t0 = ICV_DFT_LOAD_##flavor( v );                    \
+            __m128d t1 = j == 0 ? ICV_DFT_LOAD_##flavor( v + nx ) :     \
+                         ICV_DFT_CMUL_##flavor( v + nx, wave + dw );    \
+                                                                        \
+            ICV_DFT_STORE_##flavor( v, _mm_add_pd( t0, t1 ));           \
+            ICV_DFT_STORE_##flavor( v + nx, _mm_sub_pd( t0, t1 ));      \
+        }                                                               \
+}                                                                       \
+                                                                        \
+                                                                        \
+static void                                                             \
+icvDFTRadix4_##flavor##_SSE2( datatype* dst, int n0, int n, int dw0,    \
+                              const datatype* wave )                    \
+{                                                                       \
+    int i, j, dw, nx = n/4;                                             \
+                                                                        \
+    for( i = 0; i < n0; i += n )                                        \
+        for( j = 0, dw = 0; j < nx; j++, dw += dw0 )                    \
+        {                                                               \
+            datatype* v0 = dst + i + j;                                 \
+            datatype* v1 = v0 + nx*2;                                   \
+            __m128d a0 = ICV_DFT_LOAD_##flavor( v0 ), a1, a2, a3, s, d; \
+                                                                        \
+            if( j == 0 )                                                \
+            {                                                           \
+                a1 = ICV_DFT_LOAD_##flavor( v1 );                       \
+                a2 = ICV_DFT_LOAD_##flavor( v0 + nx );                  \
+                a3 = ICV_DFT_LOAD_##flavor( v1 + nx );                  \
+            }                                                           \
+            else                                                        \
+            {                                                           \
+                a1 = ICV_DFT_CMUL_##flavor( v1, wave + dw );            \
+                a2 = ICV_DFT_CMUL_##flavor( v0 + nx, wave + dw*2 );     \
+                a3 = ICV_DFT_CMUL_##flavor( v1 + nx, wave + dw*3 );     \
+            }                                                           \
+                                                                        \
+            s = _mm_add_pd( a1, a3 );                                   \
+            d = icvCRotDiff_SSE2( a1, a3 );                             \
+            a1 = _mm_add_pd( a0, a2 );                                  \
+            a2 = _mm_sub_pd( a0, a2 );                                  \
+                                                                        \
+            ICV_DFT_STORE_##flavor( v0, _mm_add_pd( a1, s ));           \
+            ICV_DFT_STORE_##flavor( v1, _mm_sub_pd( a1, s ));           \
+            ICV_DFT_STORE_##flavor( v0 + nx, _mm_add_pd( a2, d ));      \
+            ICV_DFT_STORE_##flavor( v1 + nx, _mm_sub_pd( a2, d ));      \
+        }                                                               \
+}                                                                       \
+                                                                        \
+                                                                        \
+static void                                                             \
+icvDFTRadix3_##flavor##_SSE2( datatype* dst, int n0, int n, int dw0,    \
+                              const datatype* wave )                    \
+{                                                                       \
+    __m128d sin_120 = _mm_set1_pd( icv_sin_120 );                       \
+    __m128d half = _mm_set1_pd( 0.5 );                                  \
+    int i, j, dw, nx = n/3;                                             \
+                                                                        \
+    for( i = 0; i < n0; i += n )                                        \
+        for( j = 0, dw = 0; j < nx; j++, dw += dw0 )                    \
+        {                                                               \
+            datatype* v = dst + i + j;                                  \
+            __m128d a0 = ICV_DFT_LOAD_##flavor( v ), a1, a2, s, d;      \
+                                                                        \
+            if( j == 0 )                                                \
+            {                                                           \
+                s = ICV_DFT_SUM_##flavor( v + nx, v + nx*2 );           \
+                d = ICV_DFT_ROT_DIFF_##flavor( v + nx, v + nx*2 );      \
+            }                                                           \
+            else                                                        \
+            {                                                           \
+                a1 = ICV_DFT_CMUL_##flavor( v + nx, wave + dw );        \
+                a2 = ICV_DFT_CMUL_##flavor( v + nx*2, wave + dw*2 );    \
+                s = _mm_add_pd( a1, a2 );                               \
+                d = icvCRotDiff_SSE2( a1, a2 );                         \
+            }                                                           \
+                                                                        \
+            d = _mm_mul_pd( sin_120, d );                               \
+            ICV_DFT_STORE_##flavor( v, _mm_add_pd( a0, s ));            \
+            a0 = _mm_sub_pd( a0, _mm_mul_pd( half, s ));                \
+            ICV_DFT_STORE_##flavor( v + nx, _mm_add_pd( a0, d ));       \
+            ICV_DFT_STORE_##flavor( v + nx*2, _mm_sub_pd( a0, d ));     \
+        }                                                               \
+}                                                                       \
+                                                                        \
+                                                                        \
+static void                                                             \
+icvDFTRadix5_##flavor##_SSE2( datatype* dst, int n0, int n, int dw0,    \
+                              const datatype* wave )                    \
+{                                                                       \
+    __m128d quarter = _mm_set1_pd( 0.25 );                              \
+    __m128d fft5_2 = _mm_set1_pd( icv_fft5_2 );                         \
+    __m128d fft5_3 = _mm_set_pd( icv_fft5_3, -icv_fft5_3 );             \
+    __m128d fft5_4 = _mm_set_pd( icv_fft5_4, -icv_fft5_4 );             \
+    __m128d fft5_5 = _mm_set_pd( icv_fft5_5, -icv_fft5_5 );             \
+    int i, j, dw, nx = n/5;                                             \
+                                                                        \
+    for( i = 0; i < n0; i += n )                                        \
+        for( j = 0, dw = 0; j < nx; j++, dw += dw0 )                    \
+        {                                                               \
+            datatype* v0 = dst + i + j;                                 \
+            datatype* v1 = v0 + nx*2;                                   \
+            datatype* v2 = v1 + nx*2;                                   \
+            __m128d a0, a1, a2, a3, s1, s2, d3, d4, t;                  \
+                                                                        \
+            a3 = ICV_DFT_CMUL_##flavor( v0 + nx, wave + dw );           \
+            a2 = ICV_DFT_CMUL_##flavor( v2, wave + dw*4 );              \
+            s1 = _mm_add_pd( a3, a2 );                                  \
+            d3 = _mm_sub_pd( a3, a2 );                                  \
+                                                                        \
+            a1 = ICV_DFT_CMUL_##flavor( v1 + nx, wave + dw*3 );         \
+            a0 = ICV_DFT_CMUL_##flavor( v1, wave + dw*2 );              \
+            s2 = _mm_add_pd( a1, a0 );                                  \
+            d4 = _mm_sub_pd( a1, a0 );                                  \
+                                                                        \
+            a0 = ICV_DFT_LOAD_##flavor( v0 );                           \
+            t = _mm_add_pd( s1, s2 );                                   \
+            ICV_DFT_STORE_##flavor( v0, _mm_add_pd( a0, t ));           \
+            a0 = _mm_sub_pd( a0, _mm_mul_pd( quarter, t ));             \
+            s1 = _mm_mul_pd( fft5_2, _mm_sub_pd( s1, s2 ));             \
+                                                                        \
+            t = _mm_add_pd( d3, d4 );                                   \
+            a2 = _mm_mul_pd( _mm_shuffle_pd( t, t, 1 ), fft5_3 );       \
+            d3 = _mm_mul_pd( _mm_shuffle_pd( d3, d3, 1 ), fft5_5 );     \
+            d4 = _mm_mul_pd( _mm_shuffle_pd( d4, d4, 1 ), fft5_4 );     \
+            t = _mm_add_pd( a2, d3 );                                   \
+            a2 = _mm_sub_pd( a2, d4 );                                  \
+                                                                        \
+            a3 = _mm_add_pd( a0, s1 );                                  \
+            a0 = _mm_sub_pd( a0, s1 );                                  \
+                                                                        \
+            ICV_DFT_STORE_##flavor( v0 + nx, _mm_add_pd( a3, a2 ));     \
+            ICV_DFT_STORE_##flavor( v2, _mm_sub_pd( a3, a2 ));          \
+            ICV_DFT_STORE_##flavor( v1, _mm_add_pd( a0, t ));           \
+            ICV_DFT_STORE_##flavor( v1 + nx, _mm_sub_pd( a0, t ));      \
+        }                                                               \
+}
+
+
+ICV_DEF_DFT_PASSES_SSE2( 64fc, CvComplex64f )
+ICV_DEF_DFT_PASSES_SSE2( 32fc, CvComplex32f )
+
+#endif
+
 // mixed-radix complex discrete Fourier transform: double-precision version
 static CvStatus CV_STDCALL
 icvDFT_64fc( const CvComplex64f* src, CvComplex64f* dst, int n,
@@ -551,6 +763,9 @@ icvDFT_64fc( const CvComplex64f* src, CvComplex64f* dst, int n,
             n *= 4;
             dw0 /= 4;
 
+#if CV_SSE2
+            icvDFTRadix4_64fc_SSE2( dst, n0, n, dw0, wave );
+#else
             for( i = 0; i < n0; i += n )
             {
                 CvComplex64f* v0;
@@ -602,6 +817,7 @@ icvDFT_64fc( const CvComplex64f* src, CvComplex64f* dst, int n,
                     v1[nx].re = r2 - r3; v1[nx].im = i2 - i3;
                 }
             }
+#endif
         }
 
         for( ; n < factors[0]; )
@@ -611,6 +827,9 @@ icvDFT_64fc( const CvComplex64f* src, CvComplex64f* dst, int n,
             n *= 2;
             dw0 /= 2;
 
+#if CV_SSE2
+            icvDFTRadix2_64fc_SSE2( dst, n0, n, dw0, wave );
+#else
             for( i = 0; i < n0; i += n )
             {
                 CvComplex64f* v = dst + i;
@@ -632,6 +851,7 @@ icvDFT_64fc( const CvComplex64f* src, CvComplex64f* dst, int n,
                     v[nx].re = r0 - r1; v[nx].im = i0 - i1;
                 }
             }
+#endif
         }
     }
 
@@ -646,6 +866,9 @@ icvDFT_64fc( const CvComplex64f* src, CvComplex64f* dst, int n,
         if( factor == 3 )
         {
             // radix-3
+#if CV_SSE2
+            icvDFTRadix3_64fc_SSE2( dst, n0, n, dw0, wave );
+#else
             for( i = 0; i < n0; i += n )
             {
                 CvComplex64f* v = dst + i;
@@ -678,10 +901,14 @@ icvDFT_64fc( const CvComplex64f* src, CvComplex64f* dst, int n,
                     v[nx*2].re = r0 - r2; v[nx*2].im = i0 - i2;
                 }
             }
+#endif
         }
         else if( factor == 5 )
         {
             // radix-5
+#if CV_SSE2
+            icvDFTRadix5_64fc_SSE2( dst, n0, n, dw0, wave );
+#else
             for( i = 0; i < n0; i += n )
             {
                 for( j = 0, dw = 0; j < nx; j++, dw += dw0 )
@@ -733,6 +960,7 @@ icvDFT_64fc( const CvComplex64f* src, CvComplex64f* dst, int n,
                     v1[nx].re = r0 - r5; v1[nx].im = i0 - i5;
                 }
             }
+#endif
         }
         else
         {
@@ -977,6 +1205,9 @@ icvDFT_32fc( const CvComplex32f* src, CvComplex32f* dst, int n,
             n *= 4;
             dw0 /= 4;
 
+#if CV_SSE2
+            icvDFTRadix4_32fc_SSE2( dst, n0, n, dw0, wave );
+#else
             for( i = 0; i < n0; i += n )
             {
                 CvComplex32f* v0;
@@ -1028,6 +1259,7 @@ icvDFT_32fc( const CvComplex32f* src, CvComplex32f* dst, int n,
                     v1[nx].re = (float)(r2 - r3); v1[nx].im = (float)(i2 - i3);
                 }
             }
+#endif
         }
 
         for( ; n < factors[0]; )
@@ -1037,6 +1269,9 @@ icvDFT_32fc( const CvComplex32f* src, CvComplex32f* dst, int n,
             n *= 2;
             dw0 /= 2;
 
+#if CV_SSE2
+            icvDFTRadix2_32fc_SSE2( dst, n0, n, dw0, wave );
+#else
             for( i = 0; i < n0; i += n )
             {
                 CvComplex32f* v = dst + i;
@@ -1058,6 +1293,7 @@ icvDFT_32fc( const CvComplex32f* src, CvComplex32f* dst, int n,
                     v[nx].re = (float)(r0 - r1); v[nx].im = (float)(i0 - i1);
                 }
             }
+#endif
         }
     }
 
@@ -1072,6 +1308,9 @@ icvDFT_32fc( const CvComplex32f* src, CvComplex32f* dst, int n,
         if( factor == 3 )
         {
             // radix-3
+#if CV_SSE2
+            icvDFTRadix3_32fc_SSE2( dst, n0, n, dw0, wave );
+#else
             for( i = 0; i < n0; i += n )
             {
                 CvComplex32f* v = dst + i;
@@ -1104,10 +1343,14 @@ icvDFT_32fc( const CvComplex32f* src, CvComplex32f* dst, int n,
                     v[nx*2].re = (float)(r0 - r2); v[nx*2].im = (float)(i0 - i2);
                 }
             }
+#endif
         }
         else if( factor == 5 )
         {
             // radix-5
+#if CV_SSE2
+            icvDFTRadix5_32fc_SSE2( dst, n0, n, dw0, wave );
+#else
             for( i = 0; i < n0; i += n )
             {
                 for( j = 0, dw = 0; j < nx; j++, dw += dw0 )
@@ -1159,6 +1402,7 @@ icvDFT_32fc( const CvComplex32f* src, CvComplex32f* dst, int n,
                     v1[nx].re = (float)(r0 - r5); v1[nx].im = (float)(i0 - i5);
                 }
             }
+#endif
         }
         else
         {
@@ -1737,60 +1981,86 @@ typedef CvStatus (CV_STDCALL *CvDFTFunc)(
      const int* itab, const void* wave, int tab_size,
      const void* spec, void* buf, int inv, double scale );
 
-CV_IMPL void
-cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
+// transforms of smaller arrays are not split between threads
+#define ICV_DFT_PARALLEL_MIN_SIZE  (1 << 12)
+
+// one pass of the transform: either row-wise (stage 0) or column-wise (stage 1)
+typedef struct CvDFTPass
 {
-    static CvDFTFunc dft_tbl[6];
-    static int inittab = 0;
-    
-    void* buffer = 0;
-    int local_alloc = 1;
-    int depth = -1;
-    void *spec_c = 0, *spec_r = 0, *spec = 0;
-    
-    CV_FUNCNAME( "cvDFT" );
+    int stage;
+    int len, count;
+    int nf, factors[34];
+    int inplace_transform;
+    int inv_itab;
+    int own_tables; // 0 if the tables of the previous pass are reused
+    int* itab;
+    uchar* wave;
+    void* spec;     // IPP DFT specification structure, if IPP is used
+    int spec_real;
+    double scale;
+}
+CvDFTPass;
 
-    __BEGIN__;
+struct CvDFTPlan
+{
+    int flags;
+    int src_type, dst_type;
+    CvSize src_size, dst_size;
+    int cont_column;
+    int depth, elem_size, real_transform;
+    int pass_count;
+    CvDFTPass pass[2];
+    int threads;
+    int scratch_size; // per thread
+    uchar* scratch;
+    uchar* buffer;
+    int buffer_size;
+};
 
-    int prev_len = 0, buf_size = 0, stage = 0;
-    int nf = 0, inv = (flags & CV_DXT_INVERSE) != 0;
-    int real_transform = 0;
-    CvMat *src = (CvMat*)srcarr, *dst = (CvMat*)dstarr;
-    CvMat srcstub, dststub, *src0;
-    int complex_elem_size, elem_size;
-    int factors[34], inplace_transform = 0;
-    int ipp_norm_flag = 0;
 
-    if( !inittab )
-    {
-        dft_tbl[0] = (CvDFTFunc)icvDFT_32fc;
-        dft_tbl[1] = (CvDFTFunc)icvRealDFT_32f;
-        dft_tbl[2] = (CvDFTFunc)icvCCSIDFT_32f;
-        dft_tbl[3] = (CvDFTFunc)icvDFT_64fc;
-        dft_tbl[4] = (CvDFTFunc)icvRealDFT_64f;
-        dft_tbl[5] = (CvDFTFunc)icvCCSIDFT_64f;
-        inittab = 1;
-    }
+static CvMat*
+icvGetDFTMat( const CvArr* arr, CvMat* stub )
+{
+    CvMat* mat = (CvMat*)arr;
 
-    if( !CV_IS_MAT( src ))
-    {
-        int coi = 0;
-        CV_CALL( src = cvGetMat( src, &srcstub, &coi ));
+    CV_FUNCNAME( "icvGetDFTMat" );
 
-        if( coi != 0 )
-            CV_ERROR( CV_BadCOI, "" );
-    }
+    __BEGIN__;
 
-    if( !CV_IS_MAT( dst ))
+    if( !CV_IS_MAT( mat ))
     {
         int coi = 0;
-        CV_CALL( dst = cvGetMat( dst, &dststub, &coi ));
+        CV_CALL( mat = cvGetMat( mat, stub, &coi ));
 
         if( coi != 0 )
             CV_ERROR( CV_BadCOI, "" );
     }
 
-    src0 = src;
+    __END__;
+
+    return mat;
+}
+
+
+/* checks the arguments of cvDFT, chooses the passes, factorizes the lengths and computes
+   the size of the memory needed for the tables and the scratch buffers of "threads"
+   threads. IPP specification structures, if any, are allocated here as well. */
+static void
+icvSetupDFTPlan( CvDFTPlan* plan, const CvMat* src, const CvMat* dst,
+                 int flags, int threads )
+{
+    CV_FUNCNAME( "icvSetupDFTPlan" );
+
+    __BEGIN__;
+
+    int k, stage = 0, depth, tables_size = 0, scratch_size = 0;
+    int inv = (flags & CV_DXT_INVERSE) != 0;
+    int real_transform = 0;
+    int complex_elem_size, elem_size;
+    int ipp_norm_flag = !(flags & CV_DXT_SCALE) ? 8 : (flags & CV_DXT_INVERSE) ? 2 : 1;
+
+    memset( plan, 0, sizeof(*plan) );
+
     elem_size = CV_ELEM_SIZE1(src->type);
     complex_elem_size = elem_size*2;
 
@@ -1835,10 +2105,16 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
         CV_ERROR( CV_StsUnmatchedFormats,
         "Incorrect or unsupported combination of input & output formats" );
 
-    if( src->cols == 1 && nonzero_rows > 0 )
-        CV_ERROR( CV_StsNotImplemented,
-        "This mode (using nonzero_rows with a single-column matrix) breaks the function logic, so it is prohibited.\n"
-        "For fast convolution/correlation use 2-column matrix or single-row matrix instead" );
+    plan->flags = flags;
+    plan->src_type = CV_MAT_TYPE(src->type);
+    plan->dst_type = CV_MAT_TYPE(dst->type);
+    plan->src_size = cvGetMatSize( src );
+    plan->dst_size = cvGetMatSize( dst );
+    plan->cont_column = src->cols == 1 && CV_IS_MAT_CONT(src->type & dst->type);
+    plan->depth = depth;
+    plan->elem_size = elem_size;
+    plan->real_transform = real_transform;
+    plan->threads = MAX( threads, 1 );
 
     // determine, which transform to do first - row-wise
     // (stage 0) or column-wise (stage 1) transform
@@ -1847,17 +2123,14 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
         src->cols > 1 && inv && real_transform) )
         stage = 1;
 
-    ipp_norm_flag = !(flags & CV_DXT_SCALE) ? 8 : (flags & CV_DXT_INVERSE) ? 2 : 1;
-
-    for(;;)
+    for( k = 0; k < 2; k++ )
     {
-        double scale = 1;
-        uchar* wave = 0;
-        int* itab = 0;
-        uchar* ptr;
-        int i, len, count, sz = 0;
-        int use_buf = 0, odd_real = 0;
-        CvDFTFunc dft_func;
+        CvDFTPass* pass = plan->pass + k;
+        int i, len, count, sz, next_stage = -1;
+
+        plan->pass_count = k + 1;
+        pass->stage = stage;
+        pass->scale = 1;
 
         if( stage == 0 ) // row-wise transform
         {
@@ -1868,128 +2141,248 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
                 len = !inv ? src->rows : dst->rows;
                 count = 1;
             }
-            odd_real = real_transform && (len & 1);
+
+            if( count > 1 && !(flags & CV_DXT_ROWS) && (!inv || !real_transform) )
+                next_stage = 1;
+            else if( flags & CV_DXT_SCALE )
+                pass->scale = 1./(len * (flags & CV_DXT_ROWS ? 1 : count));
+
+            // the row buffer is used for in-place and for odd-length real transforms
+            sz = len*complex_elem_size;
         }
         else
         {
             len = dst->rows;
-            count = !inv ? src0->cols : dst->cols;
+            count = !inv ? src->cols : dst->cols;
+
+            if( real_transform && inv && src->cols > 1 )
+                next_stage = 0;
+            else if( flags & CV_DXT_SCALE )
+                pass->scale = 1./(len * count);
+
             sz = 2*len*complex_elem_size;
         }
 
-        spec = 0;
+        pass->len = len;
+        pass->count = count;
+
         if( len*count >= 64 && icvDFTInitAlloc_R_32f_p != 0 ) // use IPP DFT if available
         {
             int ipp_sz = 0;
-            
-            if( real_transform && stage == 0 )
+
+            pass->spec_real = real_transform && stage == 0;
+            if( pass->spec_real )
             {
                 if( depth == CV_32F )
                 {
-                    if( spec_r )
-                        IPPI_CALL( icvDFTFree_R_32f_p( spec_r ));
                     IPPI_CALL( icvDFTInitAlloc_R_32f_p(
-                        &spec_r, len, ipp_norm_flag, cvAlgHintNone ));
-                    IPPI_CALL( icvDFTGetBufSize_R_32f_p( spec_r, &ipp_sz ));
+                        &pass->spec, len, ipp_norm_flag, cvAlgHintNone ));
+                    IPPI_CALL( icvDFTGetBufSize_R_32f_p( pass->spec, &ipp_sz ));
                 }
                 else
                 {
-                    if( spec_r )
-                        IPPI_CALL( icvDFTFree_R_64f_p( spec_r ));
                     IPPI_CALL( icvDFTInitAlloc_R_64f_p(
-                        &spec_r, len, ipp_norm_flag, cvAlgHintNone ));
-                    IPPI_CALL( icvDFTGetBufSize_R_64f_p( spec_r, &ipp_sz ));
+                        &pass->spec, len, ipp_norm_flag, cvAlgHintNone ));
+                    IPPI_CALL( icvDFTGetBufSize_R_64f_p( pass->spec, &ipp_sz ));
                 }
-                spec = spec_r;
             }
             else
             {
                 if( depth == CV_32F )
                 {
-                    if( spec_c )
-                        IPPI_CALL( icvDFTFree_C_32fc_p( spec_c ));
                     IPPI_CALL( icvDFTInitAlloc_C_32fc_p(
-                        &spec_c, len, ipp_norm_flag, cvAlgHintNone ));
-                    IPPI_CALL( icvDFTGetBufSize_C_32fc_p( spec_c, &ipp_sz ));
+                        &pass->spec, len, ipp_norm_flag, cvAlgHintNone ));
+                    IPPI_CALL( icvDFTGetBufSize_C_32fc_p( pass->spec, &ipp_sz ));
                 }
                 else
                 {
-                    if( spec_c )
-                        IPPI_CALL( icvDFTFree_C_64fc_p( spec_c ));
                     IPPI_CALL( icvDFTInitAlloc_C_64fc_p(
-                        &spec_c, len, ipp_norm_flag, cvAlgHintNone ));
-                    IPPI_CALL( icvDFTGetBufSize_C_64fc_p( spec_c, &ipp_sz ));
+                        &pass->spec, len, ipp_norm_flag, cvAlgHintNone ));
+                    IPPI_CALL( icvDFTGetBufSize_C_64fc_p( pass->spec, &ipp_sz ));
                 }
-                spec = spec_c;
             }
 
             sz += ipp_sz;
         }
         else
         {
-            if( len != prev_len )
-                nf = icvDFTFactorize( len, factors );
+            const CvDFTPass* prev = pass - 1;
 
-            inplace_transform = factors[0] == factors[nf-1];
-            sz += len*(complex_elem_size + sizeof(int));
-            i = nf > 1 && (factors[0] & 1) == 0;
-            if( (factors[i] & 1) != 0 && factors[i] > 5 )
-                sz += (factors[i]+1)*complex_elem_size;
+            pass->nf = icvDFTFactorize( len, pass->factors );
+            pass->inplace_transform = pass->factors[0] == pass->factors[pass->nf-1];
+            // the inverse permutation only matters for the out-of-place transform
+            pass->inv_itab = stage == 0 && inv && real_transform && !pass->inplace_transform;
 
-            if( stage == 0 && (src->data.ptr == dst->data.ptr && !inplace_transform || odd_real) ||
-                stage == 1 && !inplace_transform )
-            {
-                use_buf = 1;
+            i = pass->nf > 1 && (pass->factors[0] & 1) == 0;
+            if( (pass->factors[i] & 1) != 0 && pass->factors[i] > 5 )
+                sz += (pass->factors[i]+1)*complex_elem_size;
+
+            if( stage == 1 && !pass->inplace_transform )
                 sz += len*complex_elem_size;
-            }
+
+            pass->own_tables = k == 0 || prev->spec != 0 || prev->len != len ||
+                               prev->inv_itab != pass->inv_itab;
+            if( pass->own_tables )
+                tables_size += cvAlign( len*complex_elem_size, 16 ) +
+                               cvAlign( len*(int)sizeof(int), 16 );
         }
 
-        if( sz > buf_size )
+        scratch_size = MAX( scratch_size, cvAlign( sz, 16 ));
+        if( next_stage < 0 )
+            break;
+        stage = next_stage;
+    }
+
+    plan->scratch_size = scratch_size;
+    plan->buffer_size = tables_size + scratch_size*plan->threads + 16;
+
+    __END__;
+}
+
+
+// computes the twiddle factors and the permutation tables in the given buffer
+static void
+icvInitDFTPlanTables( CvDFTPlan* plan, uchar* buffer )
+{
+    int k, complex_elem_size = CV_ELEM_SIZE1(plan->depth)*2;
+    uchar* ptr = (uchar*)cvAlignPtr( buffer, 16 );
+
+    plan->buffer = buffer;
+
+    for( k = 0; k < plan->pass_count; k++ )
+    {
+        CvDFTPass* pass = plan->pass + k;
+        int len = pass->len;
+
+        if( pass->spec )
+            continue;
+
+        if( !pass->own_tables )
         {
-            prev_len = 0; // because we release the buffer, 
-                          // force recalculation of
-                          // twiddle factors and permutation table
-            if( !local_alloc && buffer )
-                cvFree( &buffer );
-            if( sz <= CV_MAX_LOCAL_DFT_SIZE )
-            {
-                buf_size = sz = CV_MAX_LOCAL_DFT_SIZE;
-                buffer = cvStackAlloc(sz + 32);
-                local_alloc = 1;
-            }
-            else
-            {
-                CV_CALL( buffer = cvAlloc(sz + 32) );
-                buf_size = sz;
-                local_alloc = 0;
-            }
+            pass->wave = pass[-1].wave;
+            pass->itab = pass[-1].itab;
+            continue;
         }
 
-        ptr = (uchar*)buffer;
-        if( !spec )
-        {
-            wave = ptr;
-            ptr += len*complex_elem_size;
-            itab = (int*)ptr;
-            ptr = (uchar*)cvAlignPtr( ptr + len*sizeof(int), 16 );
+        pass->wave = ptr;
+        ptr += cvAlign( len*complex_elem_size, 16 );
+        pass->itab = (int*)ptr;
+        ptr += cvAlign( len*(int)sizeof(int), 16 );
+
+        icvDFTInit( len, pass->nf, pass->factors, pass->itab,
+                    complex_elem_size, pass->wave, pass->inv_itab );
+    }
+
+    plan->scratch = ptr;
+}
+
+
+static void
+icvFreeDFTPlanSpecs( CvDFTPlan* plan )
+{
+    int k;
 
-            if( len != prev_len || (!inplace_transform && inv && real_transform))
-                icvDFTInit( len, nf, factors, itab, complex_elem_size,
-                            wave, stage == 0 && inv && real_transform );
-            // otherwise reuse the tables calculated on the previous stage
+    for( k = 0; k < plan->pass_count; k++ )
+    {
+        CvDFTPass* pass = plan->pass + k;
+
+        if( !pass->spec )
+            continue;
+
+        if( pass->spec_real )
+        {
+            if( plan->depth == CV_32F )
+                icvDFTFree_R_32f_p( pass->spec );
+            else
+                icvDFTFree_R_64f_p( pass->spec );
         }
+        else
+        {
+            if( plan->depth == CV_32F )
+                icvDFTFree_C_32fc_p( pass->spec );
+            else
+                icvDFTFree_C_64fc_p( pass->spec );
+        }
+        pass->spec = 0;
+    }
+}
 
-        if( stage == 0 )
+
+/* runs the passes of the plan. Rows of the row-wise pass and pairs of columns of
+   the column-wise pass are split into contiguous bands, one per thread, each band
+   using its own part of the scratch memory */
+static void
+icvExecDFTPlan( const CvDFTPlan* plan, const CvMat* src, CvMat* dst, int nonzero_rows )
+{
+    static CvDFTFunc dft_tbl[6];
+    static int inittab = 0;
+
+    CV_FUNCNAME( "icvExecDFTPlan" );
+
+    __BEGIN__;
+
+    int k, flags = plan->flags, inv = (flags & CV_DXT_INVERSE) != 0;
+    int depth = plan->depth, real_transform = plan->real_transform;
+    int elem_size = plan->elem_size, complex_elem_size = CV_ELEM_SIZE1(depth)*2;
+    int scratch_size = plan->scratch_size;
+    uchar* scratch = plan->scratch;
+    CvStatus* band_status = (CvStatus*)cvStackAlloc( plan->threads*sizeof(band_status[0]) );
+
+    if( !inittab )
+    {
+        dft_tbl[0] = (CvDFTFunc)icvDFT_32fc;
+        dft_tbl[1] = (CvDFTFunc)icvRealDFT_32f;
+        dft_tbl[2] = (CvDFTFunc)icvCCSIDFT_32f;
+        dft_tbl[3] = (CvDFTFunc)icvDFT_64fc;
+        dft_tbl[4] = (CvDFTFunc)icvRealDFT_64f;
+        dft_tbl[5] = (CvDFTFunc)icvCCSIDFT_64f;
+        inittab = 1;
+    }
+
+    if( CV_MAT_TYPE(src->type) != plan->src_type ||
+        CV_MAT_TYPE(dst->type) != plan->dst_type )
+        CV_ERROR( CV_StsUnmatchedFormats, "The arrays do not match the DFT plan" );
+
+    if( src->rows != plan->src_size.height || src->cols != plan->src_size.width ||
+        dst->rows != plan->dst_size.height || dst->cols != plan->dst_size.width )
+        CV_ERROR( CV_StsUnmatchedSizes, "The arrays do not match the DFT plan" );
+
+    if( src->cols == 1 && src->rows > 1 && !(flags & CV_DXT_ROWS) &&
+        plan->cont_column != (CV_IS_MAT_CONT(src->type & dst->type) != 0) )
+        CV_ERROR( CV_StsBadArg, "The layout of the single-column arrays "
+                                "differs from the one the DFT plan was created for" );
+
+    if( src->cols == 1 && nonzero_rows > 0 )
+        CV_ERROR( CV_StsNotImplemented,
+        "This mode (using nonzero_rows with a single-column matrix) breaks the function logic, so it is prohibited.\n"
+        "For fast convolution/correlation use 2-column matrix or single-row matrix instead" );
+
+    for( k = 0; k < plan->pass_count; k++ )
+    {
+        const CvDFTPass* pass = plan->pass + k;
+        int len = pass->len, count = pass->count, nf = pass->nf;
+        int* factors = (int*)pass->factors;
+        const int* itab = pass->itab;
+        const uchar* wave = pass->wave;
+        const void* spec = pass->spec;
+        double scale = pass->scale;
+        int i, t, threads = plan->threads;
+        CvDFTFunc dft_func;
+
+        if( spec || len*count < ICV_DFT_PARALLEL_MIN_SIZE )
+            threads = 1;
+
+        if( pass->stage == 0 )
         {
-            uchar* tmp_buf = 0;
-            int dptr_offset = 0;
+            int dptr_offset = 0, use_buf = 0;
+            int odd_real = real_transform && (len & 1);
             int dst_full_len = len*elem_size;
             int _flags = inv + (CV_MAT_CN(src->type) != CV_MAT_CN(dst->type) ?
                          ICV_DFT_COMPLEX_INPUT_OR_OUTPUT : 0);
-            if( use_buf )
+
+            if( !spec && (src->data.ptr == dst->data.ptr && !pass->inplace_transform || odd_real) )
             {
-                tmp_buf = ptr;
-                ptr += len*complex_elem_size;
+                use_buf = 1;
                 if( odd_real && !inv && len > 1 &&
                     !(_flags & ICV_DFT_COMPLEX_INPUT_OR_OUTPUT))
                     dptr_offset = elem_size;
@@ -2000,67 +2393,74 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
 
             dft_func = dft_tbl[(!real_transform ? 0 : !inv ? 1 : 2) + (depth == CV_64F)*3];
 
-            if( count > 1 && !(flags & CV_DXT_ROWS) && (!inv || !real_transform) )
-                stage = 1;
-            else if( flags & CV_DXT_SCALE )
-                scale = 1./(len * (flags & CV_DXT_ROWS ? 1 : count));
-
             if( nonzero_rows <= 0 || nonzero_rows > count )
                 nonzero_rows = count;
+            threads = MIN( threads, nonzero_rows );
 
-            for( i = 0; i < nonzero_rows; i++ )
+#ifdef _OPENMP
+            #pragma omp parallel for num_threads(threads), schedule(static)
+#endif
+            for( t = 0; t < threads; t++ )
             {
-                uchar* sptr = src->data.ptr + i*src->step;
-                uchar* dptr0 = dst->data.ptr + i*dst->step;
-                uchar* dptr = dptr0;
+                uchar* tmp_buf = scratch + t*scratch_size;
+                uchar* buf = tmp_buf + len*complex_elem_size;
+                int y, y1 = nonzero_rows*(t+1)/threads;
+                int band_factors[34];
+                CvStatus status = CV_OK;
 
-                if( tmp_buf )
-                    dptr = tmp_buf;
-                
-                dft_func( sptr, dptr, len, nf, factors, itab, wave, len, spec, ptr, _flags, scale );
-                if( dptr != dptr0 )
-                    memcpy( dptr0, dptr + dptr_offset, dst_full_len );
+                // the real transforms temporarily modify the factors
+                memcpy( band_factors, factors, nf*sizeof(factors[0]) );
+
+                for( y = nonzero_rows*t/threads; y < y1 && status >= 0; y++ )
+                {
+                    uchar* sptr = src->data.ptr + y*src->step;
+                    uchar* dptr0 = dst->data.ptr + y*dst->step;
+                    uchar* dptr = use_buf ? tmp_buf : dptr0;
+
+                    status = dft_func( sptr, dptr, len, nf, band_factors, itab, wave,
+                                       len, spec, buf, _flags, scale );
+                    if( dptr != dptr0 )
+                        memcpy( dptr0, dptr + dptr_offset, dst_full_len );
+                }
+                band_status[t] = status;
             }
 
-            for( ; i < count; i++ )
+            for( t = 0; t < threads; t++ )
+                if( band_status[t] < 0 )
+                    CV_ERROR_FROM_STATUS( band_status[t] );
+
+            for( i = nonzero_rows; i < count; i++ )
             {
                 uchar* dptr0 = dst->data.ptr + i*dst->step;
                 memset( dptr0, 0, dst_full_len );
             }
-
-            if( stage != 1 )
-                break;
-            src = dst;
         }
         else
         {
-            int a = 0, b = count;
-            uchar *buf0, *buf1, *dbuf0, *dbuf1;
+            int a = 0, b = count, pairs;
+            int use_buf = !spec && !pass->inplace_transform;
             uchar* sptr0 = src->data.ptr;
             uchar* dptr0 = dst->data.ptr;
-            buf0 = ptr;
-            ptr += len*complex_elem_size;
-            buf1 = ptr;
-            ptr += len*complex_elem_size;
-            dbuf0 = buf0, dbuf1 = buf1;
-            
-            if( use_buf )
-            {
-                dbuf1 = ptr;
-                dbuf0 = buf1;
-                ptr += len*complex_elem_size;
-            }
 
             dft_func = dft_tbl[(depth == CV_64F)*3];
 
-            if( real_transform && inv && src->cols > 1 )
-                stage = 0;
-            else if( flags & CV_DXT_SCALE )
-                scale = 1./(len * count);
-
             if( real_transform )
             {
                 int even;
+                uchar *buf0, *buf1, *dbuf0, *dbuf1, *ptr;
+
+                buf0 = scratch;
+                buf1 = buf0 + len*complex_elem_size;
+                ptr = buf1 + len*complex_elem_size;
+                dbuf0 = buf0, dbuf1 = buf1;
+
+                if( use_buf )
+                {
+                    dbuf1 = ptr;
+                    dbuf0 = buf1;
+                    ptr += len*complex_elem_size;
+                }
+
                 a = 1;
                 even = (count & 1) == 0;
                 b = (count+1)/2;
@@ -2091,18 +2491,14 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
                 else
                 {
                     icvCopyColumn( sptr0, src->step, buf0, complex_elem_size, len, complex_elem_size );
-                    //memcpy( buf0 + elem_size, buf0, elem_size );
-                    //icvExpandCCS( buf0 + elem_size, len, elem_size );
                     if( even )
                     {
                         icvCopyColumn( sptr0 + b*complex_elem_size, src->step,
                                        buf1, complex_elem_size, len, complex_elem_size );
-                        //memcpy( buf0 + elem_size, buf0, elem_size );
-                        //icvExpandCCS( buf0 + elem_size, len, elem_size );
                     }
                     sptr0 += complex_elem_size;
                 }
-                
+
                 if( even )
                     IPPI_CALL( dft_func( buf1, dbuf1, len, nf, factors, itab,
                                          wave, len, spec, ptr, inv, scale ));
@@ -2150,54 +2546,185 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
                 }
             }
 
-            for( i = a; i < b; i += 2 )
+            pairs = (b - a + 1)/2;
+            threads = MIN( threads, pairs );
+
+#ifdef _OPENMP
+            #pragma omp parallel for num_threads(threads), schedule(static)
+#endif
+            for( t = 0; t < threads; t++ )
             {
-                if( i+1 < b )
+                uchar *buf0, *buf1, *dbuf0, *dbuf1, *ptr;
+                int j, j1 = pairs*(t+1)/threads;
+                CvStatus status = CV_OK;
+
+                buf0 = scratch + t*scratch_size;
+                buf1 = buf0 + len*complex_elem_size;
+                ptr = buf1 + len*complex_elem_size;
+                dbuf0 = buf0, dbuf1 = buf1;
+
+                if( use_buf )
                 {
-                    icvCopyFrom2Columns( sptr0, src->step, buf0, buf1, len, complex_elem_size );
-                    IPPI_CALL( dft_func( buf1, dbuf1, len, nf, factors, itab,
-                                         wave, len, spec, ptr, inv, scale ));
+                    dbuf1 = ptr;
+                    dbuf0 = buf1;
+                    ptr += len*complex_elem_size;
                 }
-                else
-                    icvCopyColumn( sptr0, src->step, buf0, complex_elem_size, len, complex_elem_size );
 
-                IPPI_CALL( dft_func( buf0, dbuf0, len, nf, factors, itab,
-                                     wave, len, spec, ptr, inv, scale ));
+                for( j = pairs*t/threads; j < j1 && status >= 0; j++ )
+                {
+                    uchar* sptr = sptr0 + j*2*complex_elem_size;
+                    uchar* dptr = dptr0 + j*2*complex_elem_size;
+                    int two = a + j*2 + 1 < b;
 
-                if( i+1 < b )
-                    icvCopyTo2Columns( dbuf0, dbuf1, dptr0, dst->step, len, complex_elem_size );
-                else
-                    icvCopyColumn( dbuf0, complex_elem_size, dptr0, dst->step, len, complex_elem_size );
-                sptr0 += 2*complex_elem_size;
-                dptr0 += 2*complex_elem_size;
+                    if( two )
+                    {
+                        icvCopyFrom2Columns( sptr, src->step, buf0, buf1, len, complex_elem_size );
+                        status = dft_func( buf1, dbuf1, len, nf, factors, itab, wave, len, spec, ptr, inv, scale );
+                        if( status < 0 )
+                            break;
+                    }
+                    else
+                        icvCopyColumn( sptr, src->step, buf0, complex_elem_size, len, complex_elem_size );
+
+                    status = dft_func( buf0, dbuf0, len, nf, factors, itab, wave, len, spec, ptr, inv, scale );
+
+                    if( two )
+                        icvCopyTo2Columns( dbuf0, dbuf1, dptr, dst->step, len, complex_elem_size );
+                    else
+                        icvCopyColumn( dbuf0, complex_elem_size, dptr, dst->step, len, complex_elem_size );
+                }
+                band_status[t] = status;
             }
 
-            if( stage != 0 )
-                break;
-            src = dst;
+            for( t = 0; t < threads; t++ )
+                if( band_status[t] < 0 )
+                    CV_ERROR_FROM_STATUS( band_status[t] );
         }
+
+        src = dst;
     }
 
     __END__;
+}
 
-    if( buffer && !local_alloc )
-        cvFree( &buffer );
 
-    if( spec_c )
-    {
-        if( depth == CV_32F )
-            icvDFTFree_C_32fc_p( spec_c );
-        else
-            icvDFTFree_C_64fc_p( spec_c );
-    }
+CV_IMPL void
+cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
+{
+    CvDFTPlan plan;
+    uchar* buffer = 0;
+    int local_alloc = 0;
+
+    CV_FUNCNAME( "cvDFT" );
+
+    plan.pass_count = 0;
+
+    __BEGIN__;
+
+    CvMat srcstub, dststub, *src, *dst;
+    int threads = 1;
+
+    CV_CALL( src = icvGetDFTMat( srcarr, &srcstub ));
+    CV_CALL( dst = icvGetDFTMat( dstarr, &dststub ));
 
-    if( spec_r )
+    if( src->rows*src->cols >= ICV_DFT_PARALLEL_MIN_SIZE )
+        threads = cvGetNumThreads();
+
+    CV_CALL( icvSetupDFTPlan( &plan, src, dst, flags, threads ));
+
+    if( plan.buffer_size <= CV_MAX_LOCAL_DFT_SIZE )
     {
-        if( depth == CV_32F )
-            icvDFTFree_R_32f_p( spec_r );
-        else
-            icvDFTFree_R_64f_p( spec_r );
+        buffer = (uchar*)cvStackAlloc( plan.buffer_size );
+        local_alloc = 1;
     }
+    else
+        CV_CALL( buffer = (uchar*)cvAlloc( plan.buffer_size ));
+
+    icvInitDFTPlanTables( &plan, buffer );
+    CV_CALL( icvExecDFTPlan( &plan, src, dst, nonzero_rows ));
+
+    __END__;
+
+    if( buffer && !local_alloc )
+        cvFree( &buffer );
+
+    icvFreeDFTPlanSpecs( &plan );
+}
+
+
+CV_IMPL CvDFTPlan*
+cvCreateDFTPlan( const CvArr* srcarr, const CvArr* dstarr, int flags )
+{
+    CvDFTPlan* plan = 0;
+
+    CV_FUNCNAME( "cvCreateDFTPlan" );
+
+    __BEGIN__;
+
+    CvMat srcstub, dststub, *src, *dst;
+    uchar* buffer;
+
+    CV_CALL( src = icvGetDFTMat( srcarr, &srcstub ));
+    CV_CALL( dst = icvGetDFTMat( dstarr, &dststub ));
+
+    CV_CALL( plan = (CvDFTPlan*)cvAlloc( sizeof(*plan) ));
+    plan->pass_count = 0;
+    plan->buffer = 0;
+
+    CV_CALL( icvSetupDFTPlan( plan, src, dst, flags, cvGetNumThreads() ));
+    CV_CALL( buffer = (uchar*)cvAlloc( plan->buffer_size ));
+    icvInitDFTPlanTables( plan, buffer );
+
+    __END__;
+
+    if( cvGetErrStatus() < 0 )
+        cvReleaseDFTPlan( &plan );
+
+    return plan;
+}
+
+
+CV_IMPL void
+cvReleaseDFTPlan( CvDFTPlan** _plan )
+{
+    CV_FUNCNAME( "cvReleaseDFTPlan" );
+
+    __BEGIN__;
+
+    CvDFTPlan* plan;
+
+    if( !_plan )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    plan = *_plan;
+    if( !plan )
+        EXIT;
+
+    icvFreeDFTPlanSpecs( plan );
+    cvFree( &plan->buffer );
+    cvFree( _plan );
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvExecDFTPlan( const CvArr* srcarr, CvArr* dstarr, CvDFTPlan* plan, int nonzero_rows )
+{
+    CV_FUNCNAME( "cvExecDFTPlan" );
+
+    __BEGIN__;
+
+    CvMat srcstub, dststub, *src, *dst;
+
+    if( !plan )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    CV_CALL( src = icvGetDFTMat( srcarr, &srcstub ));
+    CV_CALL( dst = icvGetDFTMat( dstarr, &dststub ));
+    CV_CALL( icvExecDFTPlan( plan, src, dst, nonzero_rows ));
+
+    __END__;
 }
 
 
@@ -2593,14 +3120,14 @@ cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
     double scale = 1.;
     int prev_len = 0, buf_size = 0, nf = 0, stage, end_stage;
     CvMat *src = (CvMat*)srcarr, *dst = (CvMat*)dstarr;
-    uchar *src_dft_buf = 0, *dst_dft_buf = 0;
-    uchar *dft_wave = 0, *dct_wave = 0;
+    uchar *dft_wave = 0, *dct_wave = 0, *scratch = 0;
     int* itab = 0;
     uchar* ptr = 0;
     CvMat srcstub, dststub;
     int complex_elem_size, elem_size;
-    int factors[34], inplace_transform;
-    int i, len, count;
+    int factors[34], inplace_transform = 1;
+    int i, len, count, t, threads = 1, scratch_size = 0;
+    CvStatus* band_status;
     CvDCTFunc dct_func;
 
     if( !inittab )
@@ -2644,6 +3171,10 @@ cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
 
     dct_func = dct_tbl[inv + (depth == CV_64F)*2];
 
+    if( src->rows*src->cols >= ICV_DFT_PARALLEL_MIN_SIZE )
+        threads = cvGetNumThreads();
+    band_status = (CvStatus*)cvStackAlloc( threads*sizeof(band_status[0]) );
+
     if( (flags & CV_DXT_ROWS) || src->rows == 1 ||
         src->cols == 1 && CV_IS_MAT_CONT(src->type & dst->type))
     {
@@ -2658,7 +3189,7 @@ cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
     for( ; stage <= end_stage; stage++ )
     {
         uchar *sptr = src->data.ptr, *dptr = dst->data.ptr;
-        int sstep0, sstep1, dstep0, dstep1;
+        int sstep0, sstep1, dstep0, dstep1, bands;
         
         if( stage == 0 )
         {
@@ -2684,13 +3215,14 @@ cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
 
         if( len != prev_len )
         {
-            int sz;
+            int sz, tables_size;
 
             if( len > 1 && (len & 1) )
                 CV_ERROR( CV_StsNotImplemented, "Odd-size DCT\'s are not implemented" );
 
+            // the tables are shared by all the bands; sz is the scratch memory of one band
             sz = len*elem_size;
-            sz += (len/2 + 1)*complex_elem_size;
+            tables_size = (len/2 + 1)*complex_elem_size + 32;
 
             spec = 0;
             inplace_transform = 1;
@@ -2716,7 +3248,7 @@ cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
             }
             else
             {
-                sz += len*(complex_elem_size + sizeof(int)) + complex_elem_size;
+                tables_size += len*(complex_elem_size + sizeof(int)) + complex_elem_size;
 
                 nf = icvDFTFactorize( len, factors );
                 inplace_transform = factors[0] == factors[nf-1];
@@ -2729,6 +3261,8 @@ cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
                     sz += len*elem_size;
             }
 
+            scratch_size = cvAlign( sz, 16 );
+            sz = tables_size + scratch_size*threads;
             if( sz > buf_size )
             {
                 if( !local_alloc && buffer )
@@ -2759,13 +3293,7 @@ cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
                 
             dct_wave = ptr;
             ptr += (len/2 + 1)*complex_elem_size;
-            src_dft_buf = dst_dft_buf = ptr;
-            ptr += len*elem_size;
-            if( !inplace_transform )
-            {
-                dst_dft_buf = ptr;
-                ptr += len*elem_size;
-            }
+            scratch = (uchar*)cvAlignPtr( ptr, 16 );
             icvDCTInit( len, complex_elem_size, dct_wave, inv );
             if( !inv )
                 scale += scale;
@@ -2773,12 +3301,40 @@ cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
         }
         // otherwise reuse the tables calculated on the previous stage
 
-        for( i = 0; i < count; i++ )
+        // the rows (columns) are split into contiguous bands, one per thread,
+        // each band using its own part of the scratch memory
+        bands = spec || len*count < ICV_DFT_PARALLEL_MIN_SIZE ? 1 : MIN( threads, count );
+
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(bands), schedule(static)
+#endif
+        for( t = 0; t < bands; t++ )
         {
-            dct_func( sptr + i*sstep0, sstep1, src_dft_buf, dst_dft_buf,
-                      dptr + i*dstep0, dstep1, len, nf, factors,
-                      itab, dft_wave, dct_wave, spec, ptr );
+            uchar* src_dft_buf = scratch + t*scratch_size;
+            uchar* dst_dft_buf = src_dft_buf;
+            uchar* buf = src_dft_buf + len*elem_size;
+            int j, j1 = count*(t+1)/bands;
+            int band_factors[34];
+            CvStatus status = CV_OK;
+
+            // the real transforms temporarily modify the factors
+            memcpy( band_factors, factors, nf*sizeof(factors[0]) );
+            if( !inplace_transform )
+            {
+                dst_dft_buf = buf;
+                buf += len*elem_size;
+            }
+
+            for( j = count*t/bands; j < j1 && status >= 0; j++ )
+                status = dct_func( sptr + j*sstep0, sstep1, src_dft_buf, dst_dft_buf,
+                                   dptr + j*dstep0, dstep1, len, nf, band_factors,
+                                   itab, dft_wave, dct_wave, spec, buf );
+            band_status[t] = status;
         }
+
+        for( t = 0; t < bands; t++ )
+            if( band_status[t] < 0 )
+                CV_ERROR_FROM_STATUS( band_status[t] );
         src = dst;
     }
 
@@ -568,6 +568,222 @@ ICV_DEF_GEMM_SINGLE_MUL( 64f_C2R, CvComplex64f, CvComplex64f)
 ICV_DEF_GEMM_BLOCK_MUL( 64f_C2R, CvComplex64f, CvComplex64f)
 ICV_DEF_GEMM_STORE( 64f_C2R, CvComplex64f, CvComplex64f)
 
+
+/* Packed-panel multiplication of real matrices. Blocks of A (ICV_GEMM_MC x ICV_GEMM_KC)
+   and B (ICV_GEMM_KC x ICV_GEMM_NC) are copied into k-major panels of ICV_GEMM_PANEL
+   rows/columns as doubles (so 32f keeps the double accumulation of the functions
+   above) and the micro-kernel adds the products of one A panel and one B panel to an
+   ICV_GEMM_PANEL x ICV_GEMM_PANEL tile of the double-precision accumulator.
+   k runs sequentially from 0 to len-1 for every element of D. */
+#define ICV_GEMM_PANEL            4
+#define ICV_GEMM_MC               64
+#define ICV_GEMM_NC               256
+#define ICV_GEMM_KC               256
+#define ICV_GEMM_PACKED_MIN_OPS   (1 << 18)
+
+/* packs rows x len elements, element (r,k) is at src + r*step0 + k*step1;
+   missing rows of the last panel are filled with zeros */
+static void
+icvGEMM_PackPanels( const uchar* src, int step0, int step1, int depth,
+                    int rows, int len, double* dst )
+{
+    int i, r, k;
+
+    for( i = 0; i < rows; i += ICV_GEMM_PANEL, src += step0*ICV_GEMM_PANEL )
+    {
+        const uchar* s = src;
+        int n = MIN( rows - i, ICV_GEMM_PANEL );
+
+        if( depth == CV_32F )
+            for( k = 0; k < len; k++, s += step1, dst += ICV_GEMM_PANEL )
+            {
+                for( r = 0; r < n; r++ )
+                    dst[r] = *(const float*)(s + r*step0);
+                for( ; r < ICV_GEMM_PANEL; r++ )
+                    dst[r] = 0;
+            }
+        else
+            for( k = 0; k < len; k++, s += step1, dst += ICV_GEMM_PANEL )
+            {
+                for( r = 0; r < n; r++ )
+                    dst[r] = *(const double*)(s + r*step0);
+                for( ; r < ICV_GEMM_PANEL; r++ )
+                    dst[r] = 0;
+            }
+    }
+}
+
+
+/* s(r,c) (+)= sum_k a[k*ICV_GEMM_PANEL + r]*b[k*ICV_GEMM_PANEL + c],
+   the rows of the tile are s_step doubles apart */
+static void
+icvGEMM_MulPanels( const double* a, const double* b, int len,
+                   double* s, int s_step, int do_acc )
+{
+    int k;
+#if CV_SSE2
+    __m128d s00, s01, s10, s11, s20, s21, s30, s31;
+
+    if( do_acc )
+    {
+        s00 = _mm_load_pd( s ); s01 = _mm_load_pd( s + 2 );
+        s10 = _mm_load_pd( s + s_step ); s11 = _mm_load_pd( s + s_step + 2 );
+        s20 = _mm_load_pd( s + s_step*2 ); s21 = _mm_load_pd( s + s_step*2 + 2 );
+        s30 = _mm_load_pd( s + s_step*3 ); s31 = _mm_load_pd( s + s_step*3 + 2 );
+    }
+    else
+        s00 = s01 = s10 = s11 = s20 = s21 = s30 = s31 = _mm_setzero_pd();
+
+    for( k = 0; k < len; k++, a += ICV_GEMM_PANEL, b += ICV_GEMM_PANEL )
+    {
+        __m128d b0 = _mm_load_pd( b ), b1 = _mm_load_pd( b + 2 );
+        __m128d a0 = _mm_load1_pd( a ), a1 = _mm_load1_pd( a + 1 );
+        s00 = _mm_add_pd( s00, _mm_mul_pd( a0, b0 ));
+        s01 = _mm_add_pd( s01, _mm_mul_pd( a0, b1 ));
+        s10 = _mm_add_pd( s10, _mm_mul_pd( a1, b0 ));
+        s11 = _mm_add_pd( s11, _mm_mul_pd( a1, b1 ));
+        a0 = _mm_load1_pd( a + 2 ); a1 = _mm_load1_pd( a + 3 );
+        s20 = _mm_add_pd( s20, _mm_mul_pd( a0, b0 ));
+        s21 = _mm_add_pd( s21, _mm_mul_pd( a0, b1 ));
+        s30 = _mm_add_pd( s30, _mm_mul_pd( a1, b0 ));
+        s31 = _mm_add_pd( s31, _mm_mul_pd( a1, b1 ));
+    }
+
+    _mm_store_pd( s, s00 ); _mm_store_pd( s + 2, s01 );
+    _mm_store_pd( s + s_step, s10 ); _mm_store_pd( s + s_step + 2, s11 );
+    _mm_store_pd( s + s_step*2, s20 ); _mm_store_pd( s + s_step*2 + 2, s21 );
+    _mm_store_pd( s + s_step*3, s30 ); _mm_store_pd( s + s_step*3 + 2, s31 );
+#else
+    int r;
+    if( !do_acc )
+        for( r = 0; r < ICV_GEMM_PANEL; r++ )
+            s[r*s_step] = s[r*s_step+1] = s[r*s_step+2] = s[r*s_step+3] = 0;
+
+    for( k = 0; k < len; k++, a += ICV_GEMM_PANEL, b += ICV_GEMM_PANEL )
+        for( r = 0; r < ICV_GEMM_PANEL; r++ )
+        {
+            double ar = a[r];
+            double* sr = s + r*s_step;
+            sr[0] += ar*b[0]; sr[1] += ar*b[1];
+            sr[2] += ar*b[2]; sr[3] += ar*b[3];
+        }
+#endif
+}
+
+
+/* d = alpha*s + beta*c for a rows x cols block of the accumulator */
+static void
+icvGEMM_StoreBlock( const double* s, int s_step, const uchar* c, int c_step0, int c_step1,
+                    uchar* d, int d_step, int depth, int rows, int cols,
+                    double alpha, double beta )
+{
+    int r, j;
+
+    for( r = 0; r < rows; r++, s += s_step, c += c_step0, d += d_step )
+    {
+        if( depth == CV_32F )
+        {
+            float* dd = (float*)d;
+            if( c_step0 | c_step1 )
+                for( j = 0; j < cols; j++ )
+                {
+                    double t0 = alpha*s[j];
+                    t0 += beta*(double)*(const float*)(c + j*c_step1);
+                    dd[j] = (float)t0;
+                }
+            else
+                for( j = 0; j < cols; j++ )
+                    dd[j] = (float)(alpha*s[j]);
+        }
+        else
+        {
+            double* dd = (double*)d;
+            if( c_step0 | c_step1 )
+                for( j = 0; j < cols; j++ )
+                {
+                    double t0 = alpha*s[j];
+                    t0 += beta*(*(const double*)(c + j*c_step1));
+                    dd[j] = t0;
+                }
+            else
+                for( j = 0; j < cols; j++ )
+                    dd[j] = alpha*s[j];
+        }
+    }
+}
+
+
+/* D = alpha*op(A)*op(B) + beta*op(C) for 32fC1/64fC1 matrices.
+   Element (i,k) of op(A) is at a + i*a_step0 + k*a_step1, element (k,j) of op(B)
+   is at b + k*b_step0 + j*b_step1 and element (i,j) of op(C) is at c + i*c_step0 + j*c_step1.
+   The rows of D are split into one band per thread, each band packs its own blocks. */
+static CvStatus
+icvGEMMPacked( const uchar* a, int a_step0, int a_step1,
+               const uchar* b, int b_step0, int b_step1,
+               const uchar* c, int c_step0, int c_step1,
+               uchar* d, int d_step, CvSize d_size, int len, int depth,
+               double alpha, double beta )
+{
+    int elem_size = depth == CV_32F ? sizeof(float) : sizeof(double);
+    int panels = (d_size.height + ICV_GEMM_PANEL - 1)/ICV_GEMM_PANEL;
+    int threads = MIN( cvGetNumThreads(), panels );
+    int mc = MIN( ICV_GEMM_MC, panels*ICV_GEMM_PANEL );
+    int nc = MIN( ICV_GEMM_NC, (d_size.width + ICV_GEMM_PANEL - 1) & -ICV_GEMM_PANEL );
+    int kc = MIN( ICV_GEMM_KC, len );
+    int band_size = (mc + nc)*kc + mc*nc, t;
+    double* buffer;
+
+    buffer = (double*)cvAlloc( threads*band_size*sizeof(buffer[0]) );
+    if( !buffer )
+        return CV_OUTOFMEM_ERR;
+
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(threads), schedule(static)
+#endif
+    for( t = 0; t < threads; t++ )
+    {
+        double* a_buf = buffer + t*band_size;
+        double* b_buf = a_buf + mc*kc;
+        double* s_buf = b_buf + nc*kc;
+        int i, i1 = MIN( panels*(t+1)/threads*ICV_GEMM_PANEL, d_size.height );
+        int di, dj, dk;
+
+        for( i = panels*t/threads*ICV_GEMM_PANEL; i < i1; i += di )
+        {
+            int j, k;
+            di = MIN( mc, i1 - i );
+
+            for( j = 0; j < d_size.width; j += dj )
+            {
+                dj = MIN( nc, d_size.width - j );
+
+                for( k = 0; k < len; k += dk )
+                {
+                    int ii, jj;
+                    dk = MIN( kc, len - k );
+
+                    icvGEMM_PackPanels( b + k*b_step0 + j*b_step1, b_step1, b_step0,
+                                        depth, dj, dk, b_buf );
+                    icvGEMM_PackPanels( a + i*a_step0 + k*a_step1, a_step0, a_step1,
+                                        depth, di, dk, a_buf );
+
+                    for( jj = 0; jj < dj; jj += ICV_GEMM_PANEL )
+                        for( ii = 0; ii < di; ii += ICV_GEMM_PANEL )
+                            icvGEMM_MulPanels( a_buf + ii*dk, b_buf + jj*dk, dk,
+                                               s_buf + ii*nc + jj, nc, k > 0 );
+                }
+
+                icvGEMM_StoreBlock( s_buf, nc, c + i*c_step0 + j*c_step1, c_step0, c_step1,
+                                    d + i*d_step + j*elem_size, d_step, depth,
+                                    di, dj, alpha, beta );
+            }
+        }
+    }
+
+    cvFree( &buffer );
+    return CV_OK;
+}
+
 typedef CvStatus (CV_STDCALL *CvGEMMSingleMulFunc)( const void* src1, size_t step1,
                    const void* src2, size_t step2, const void* src3, size_t step3,
                    void* dst, size_t dststep, CvSize srcsize, CvSize dstsize,
@@ -1090,6 +1306,30 @@ cvGEMM( const CvArr* Aarr, const CvArr* Barr, double alpha,
                        &_beta, D->data.ptr, &ldd );
             }
         }
+        else if( CV_MAT_CN(type) == 1 && len >= ICV_GEMM_PANEL*2 &&
+                 d_size.width >= ICV_GEMM_PANEL && d_size.height >= ICV_GEMM_PANEL &&
+                 (double)d_size.width*d_size.height*len >= ICV_GEMM_PACKED_MIN_OPS )
+        {
+            int elem_size = CV_ELEM_SIZE(type);
+            int a_step0 = A->step, a_step1 = elem_size;
+            int b_step0 = b_step, b_step1 = elem_size;
+            int c_step0 = C->step, c_step1 = elem_size;
+
+            if( flags & CV_GEMM_A_T )
+                a_step0 = elem_size, a_step1 = A->step;
+            if( flags & CV_GEMM_B_T )
+                b_step0 = elem_size, b_step1 = b_step;
+            if( !C->data.ptr )
+                c_step0 = c_step1 = 0;
+            else if( flags & CV_GEMM_C_T )
+                c_step0 = elem_size, c_step1 = C->step;
+
+            IPPI_CALL( icvGEMMPacked( A->data.ptr, a_step0, a_step1,
+                                      B->data.ptr, b_step0, b_step1,
+                                      C->data.ptr, c_step0, c_step1,
+                                      D->data.ptr, D->step, d_size, len,
+                                      CV_MAT_DEPTH(type), alpha, beta ));
+        }
         else if( d_size.height <= block_lin_size/2 || d_size.width <= block_lin_size/2 || len <= 10 ||
             d_size.width <= block_lin_size && d_size.height <= block_lin_size && len <= block_lin_size )
         {
@@ -1565,6 +1805,146 @@ typedef CvStatus (CV_STDCALL * CvDiagTransformFunc)(
                        void* dst, int dststep, CvSize size,
                        const void* mat );
 
+#if CV_SSE2
+
+/* SSE2 versions of the 3- and 4-channel transforms with 3 or 4 output channels.
+   The output channels 0,1 and 2,3 of a pixel are computed as two pairs of doubles
+   with the same sequence of products and sums as the scalar code above
+   (rounding uses the same MXCSR mode as cvRound), so the results are identical. */
+
+#define ICV_TRANSFORM_STORE_8u( dst, s0, s1, dst_cn )                       \
+{                                                                           \
+    __m128i r = _mm_unpacklo_epi64( _mm_cvtpd_epi32( s0 ),                  \
+                                    _mm_cvtpd_epi32( s1 ));                 \
+    int p = _mm_cvtsi128_si32( _mm_packus_epi16( _mm_packs_epi32( r, r ),   \
+                                                 _mm_setzero_si128() ));    \
+    (dst)[0] = (uchar)p; (dst)[1] = (uchar)(p >> 8);                        \
+    (dst)[2] = (uchar)(p >> 16);                                            \
+    if( (dst_cn) == 4 )                                                     \
+        (dst)[3] = (uchar)(p >> 24);                                        \
+}
+
+/* r is clipped to [0,65535] the same way as CV_CAST_16U does it */
+#define ICV_TRANSFORM_STORE_16u( dst, s0, s1, dst_cn )                      \
+{                                                                           \
+    const __m128i max16u = _mm_set1_epi32( 65535 );                         \
+    __m128i r = _mm_unpacklo_epi64( _mm_cvtpd_epi32( s0 ),                  \
+                                    _mm_cvtpd_epi32( s1 ));                 \
+    __m128i m = _mm_cmpgt_epi32( r, max16u );                               \
+    r = _mm_andnot_si128( _mm_cmplt_epi32( r, _mm_setzero_si128() ), r );   \
+    r = _mm_or_si128( _mm_andnot_si128( m, r ), _mm_and_si128( m, max16u ));\
+    r = _mm_packs_epi32( _mm_sub_epi32( r, _mm_set1_epi32( 32768 )), r );   \
+    r = _mm_xor_si128( r, _mm_set1_epi16( (short)0x8000 ));                 \
+    (dst)[0] = (ushort)_mm_extract_epi16( r, 0 );                           \
+    (dst)[1] = (ushort)_mm_extract_epi16( r, 1 );                           \
+    (dst)[2] = (ushort)_mm_extract_epi16( r, 2 );                           \
+    if( (dst_cn) == 4 )                                                     \
+        (dst)[3] = (ushort)_mm_extract_epi16( r, 3 );                       \
+}
+
+#define ICV_TRANSFORM_STORE_32f( dst, s0, s1, dst_cn )                      \
+{                                                                           \
+    __m128 r = _mm_movelh_ps( _mm_cvtpd_ps( s0 ), _mm_cvtpd_ps( s1 ));      \
+    _mm_storel_pi( (__m64*)(dst), r );                                      \
+    if( (dst_cn) == 4 )                                                     \
+        _mm_storeh_pi( (__m64*)((dst) + 2), r );                            \
+    else                                                                    \
+        _mm_store_ss( (dst) + 2, _mm_movehl_ps( r, r ));                    \
+}
+
+#define ICV_DEF_TRANSFORM_SSE2_FUNC( flavor, arrtype, cn )                  \
+static CvStatus CV_STDCALL                                                  \
+icvTransform_##flavor##_C##cn##R_SSE2( const arrtype* src, int srcstep,     \
+                                     arrtype* dst, int dststep, CvSize size,\
+                                     const double* mat, int dst_cn )        \
+{                                                                           \
+    __m128d m0[cn+1], m1[cn+1];                                             \
+    int i, j;                                                               \
+                                                                            \
+    for( j = 0; j <= cn; j++ )                                              \
+    {                                                                       \
+        m0[j] = _mm_setr_pd( mat[j], mat[cn+1+j] );                         \
+        m1[j] = _mm_setr_pd( mat[(cn+1)*2+j],                               \
+                             dst_cn == 4 ? mat[(cn+1)*3+j] : 0. );          \
+    }                                                                       \
+                                                                            \
+    srcstep /= sizeof(src[0]);                                              \
+    dststep /= sizeof(dst[0]);                                              \
+                                                                            \
+    for( ; size.height--; src += srcstep, dst += dststep )                  \
+    {                                                                       \
+        const arrtype* s = src;                                             \
+        arrtype* d = dst;                                                   \
+        for( i = 0; i < size.width; i++, s += cn, d += dst_cn )             \
+        {                                                                   \
+            __m128d t, s0, s1;                                              \
+                                                                            \
+            t = _mm_set1_pd( (double)s[0] );                                \
+            s0 = _mm_mul_pd( m0[0], t ); s1 = _mm_mul_pd( m1[0], t );       \
+            t = _mm_set1_pd( (double)s[1] );                                \
+            s0 = _mm_add_pd( s0, _mm_mul_pd( m0[1], t ));                   \
+            s1 = _mm_add_pd( s1, _mm_mul_pd( m1[1], t ));                   \
+            t = _mm_set1_pd( (double)s[2] );                                \
+            s0 = _mm_add_pd( s0, _mm_mul_pd( m0[2], t ));                   \
+            s1 = _mm_add_pd( s1, _mm_mul_pd( m1[2], t ));                   \
+            if( cn == 4 )                                                   \
+            {                                                               \
+                t = _mm_set1_pd( (double)s[3] );                            \
+                s0 = _mm_add_pd( s0, _mm_mul_pd( m0[3], t ));               \
+                s1 = _mm_add_pd( s1, _mm_mul_pd( m1[3], t ));               \
+            }                                                               \
+            s0 = _mm_add_pd( s0, m0[cn] );                                  \
+            s1 = _mm_add_pd( s1, m1[cn] );                                  \
+                                                                            \
+            ICV_TRANSFORM_STORE_##flavor( d, s0, s1, dst_cn );              \
+        }                                                                   \
+    }                                                                       \
+                                                                            \
+    return CV_OK;                                                           \
+}
+
+
+ICV_DEF_TRANSFORM_SSE2_FUNC( 8u, uchar, 3 )
+ICV_DEF_TRANSFORM_SSE2_FUNC( 8u, uchar, 4 )
+ICV_DEF_TRANSFORM_SSE2_FUNC( 16u, ushort, 3 )
+ICV_DEF_TRANSFORM_SSE2_FUNC( 16u, ushort, 4 )
+ICV_DEF_TRANSFORM_SSE2_FUNC( 32f, float, 3 )
+ICV_DEF_TRANSFORM_SSE2_FUNC( 32f, float, 4 )
+
+#endif
+
+#define ICV_TRANSFORM_PARALLEL_MIN_SIZE  (1 << 16)
+
+/* runs the per-pixel transform in one band per thread: bands of rows,
+   or pieces of the row if the array is a single (continuous) row */
+static void
+icvTransformParallel( CvTransformFunc func, const uchar* src, int srcstep,
+                      uchar* dst, int dststep, CvSize size, const double* mat,
+                      int src_pix_size, int dst_pix_size, int dst_cn )
+{
+    int threads = cvGetNumThreads(), t;
+    int len = size.height > 1 ? size.height : size.width;
+
+    if( size.width*size.height < ICV_TRANSFORM_PARALLEL_MIN_SIZE )
+        threads = 1;
+    threads = MIN( threads, len );
+
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(threads), schedule(static)
+#endif
+    for( t = 0; t < threads; t++ )
+    {
+        int y0 = len*t/threads, y1 = len*(t+1)/threads;
+
+        if( size.height > 1 )
+            func( src + y0*srcstep, srcstep, dst + y0*dststep, dststep,
+                  cvSize( size.width, y1 - y0 ), mat, dst_cn );
+        else
+            func( src + y0*src_pix_size, srcstep, dst + y0*dst_pix_size, dststep,
+                  cvSize( y1 - y0, 1 ), mat, dst_cn );
+    }
+}
+
 ///////////////////// IPP transform functions //////////////////
 
 icvColorTwist_8u_C3R_t icvColorTwist_8u_C3R_p = 0;
@@ -1765,6 +2145,21 @@ cvTransform( const CvArr* srcarr, CvArr* dstarr,
         if( !func )
             CV_ERROR( CV_StsUnsupportedFormat, "" );
 
+#if CV_SSE2
+        if( (cn == 3 || cn == 4) && (dst_cn == 3 || dst_cn == 4) )
+        {
+            switch( type )
+            {
+            case CV_8UC3: func = (CvTransformFunc)icvTransform_8u_C3R_SSE2; break;
+            case CV_8UC4: func = (CvTransformFunc)icvTransform_8u_C4R_SSE2; break;
+            case CV_16UC3: func = (CvTransformFunc)icvTransform_16u_C3R_SSE2; break;
+            case CV_16UC4: func = (CvTransformFunc)icvTransform_16u_C4R_SSE2; break;
+            case CV_32FC3: func = (CvTransformFunc)icvTransform_32f_C3R_SSE2; break;
+            case CV_32FC4: func = (CvTransformFunc)icvTransform_32f_C4R_SSE2; break;
+            }
+        }
+#endif
+
         if( cn == dst_cn )
             ipp_func = type == CV_8UC3 ? icvColorTwist_8u_C3R_p :
                        type == CV_16UC3 ? icvColorTwist_16u_C3R_p :
@@ -1871,8 +2266,9 @@ cvTransform( const CvArr* srcarr, CvArr* dstarr,
                 diag_func( src->data.ptr, src->step, dst->data.ptr,
                            dst->step, size, buffer );
             else
-                func( src->data.ptr, src->step, dst->data.ptr,
-                      dst->step, size, buffer, dst_cn );
+                icvTransformParallel( func, src->data.ptr, src->step, dst->data.ptr,
+                                      dst->step, size, buffer, CV_ELEM_SIZE(src->type),
+                                      CV_ELEM_SIZE(dst->type), dst_cn );
         }
         else
         {
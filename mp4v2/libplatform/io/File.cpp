@@ -117,6 +117,59 @@ File::write( const void* buffer, Size size, Size& nout, Size maxChunkSize )
     return false;
 }
 
+bool
+File::readAt( void* buffer, Size size, Size pos, Size& nin )
+{
+    nin = 0;
+
+    if( !_isOpen )
+        return true;
+
+    if( _provider.canReadAt() )
+        return _provider.readAt( buffer, size, pos, nin );
+
+    // emulate with seek/read, restoring the position for stream users
+    std::lock_guard<std::mutex> lock( _readAtLock );
+    if( _provider.seek( pos ))
+        return true;
+    bool failed = _provider.read( buffer, size, nin, 0 );
+    if( _provider.seek( _position ))
+        return true;
+    return failed;
+}
+
+FileMapping*
+File::map( Size pos, Size size )
+{
+    if( !_isOpen || pos < 0 || size <= 0 || pos + size > _size )
+        return NULL;
+
+    return _provider.map( pos, size );
+}
+
+bool
+File::flush()
+{
+    if( !_isOpen )
+        return true;
+
+    return _provider.flush();
+}
+
+bool
+File::updateSize()
+{
+    if( !_isOpen )
+        return true;
+
+    Size size;
+    if( FileSystem::getFileSize( _name, size ))
+        return true;
+    if( size > _size )
+        _size = size;
+    return false;
+}
+
 bool
 File::close()
 {
@@ -5,6 +5,21 @@ namespace mp4v2 { namespace platform { namespace io {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+//! Read-only view of a file region. The view is released when the object is
+//! deleted and stays valid independent of the file or provider it came from.
+class MP4V2_EXPORT FileMapping
+{
+public:
+    virtual ~FileMapping() { }
+
+    const uint8_t* data; //!< first byte of the requested region
+
+protected:
+    FileMapping() : data( NULL ) { }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 class MP4V2_EXPORT FileProvider
 {
 public:
@@ -31,6 +46,19 @@ public:
     virtual bool write( const void* buffer, Size size, Size& nout, Size maxChunkSize ) = 0;
     virtual bool close() = 0;
 
+    //! positional read which leaves the stream position alone and may be
+    //! issued concurrently. Providers which cannot do this return false from
+    //! canReadAt() and File serializes seek/read pairs instead.
+    virtual bool canReadAt() { return false; }
+    virtual bool readAt( void*, Size, Size, Size& nin ) { nin = 0; return true; }
+
+    //! maps a region read-only, or returns NULL if the provider can't
+    virtual FileMapping* map( Size, Size ) { return NULL; }
+
+    //! hands buffered writes to the operating system so other readers
+    //! see them; providers which don't buffer have nothing to do.
+    virtual bool flush() { return false; }
+
 protected:
     FileProvider() { }
 };
@@ -163,6 +191,72 @@ public:
 
     bool write( const void* buffer, Size size, Size& nout, Size maxChunkSize = 0 );
 
+    ///////////////////////////////////////////////////////////////////////////
+    //!
+    //! Positional binary read.
+    //!
+    //! The function reads up to a maximum <b>size</b> bytes starting at
+    //! file offset <b>pos</b>, storing them in <b>buffer</b>. The file
+    //! position is neither used nor changed, so several threads may call
+    //! readAt() on the same file at once. It must not race with seek(),
+    //! read() or write() though.
+    //!
+    //! @param buffer storage for data read from file.
+    //! @param size maximum number of bytes to read from file.
+    //! @param pos file offset in bytes to read from.
+    //! @param nin output indicating number of bytes read from file.
+    //!
+    //! @return true on failure, false on success.
+    //!
+    ///////////////////////////////////////////////////////////////////////////
+
+    bool readAt( void* buffer, Size size, Size pos, Size& nin );
+
+    ///////////////////////////////////////////////////////////////////////////
+    //!
+    //! Map file region.
+    //!
+    //! The function maps <b>size</b> bytes starting at file offset
+    //! <b>pos</b> into memory for reading. Only files opened with
+    //! MODE_READ on the standard provider can be mapped.
+    //!
+    //! @param pos file offset in bytes of the region.
+    //! @param size size in bytes of the region.
+    //!
+    //! @return the mapping, to be deleted by the caller,
+    //!     or NULL if the region can't be mapped.
+    //!
+    ///////////////////////////////////////////////////////////////////////////
+
+    FileMapping* map( Size pos, Size size );
+
+    ///////////////////////////////////////////////////////////////////////////
+    //!
+    //! Flush buffered writes.
+    //!
+    //! The function passes any data buffered by the provider on to the
+    //! operating system, making it visible to other readers of the file.
+    //!
+    //! @return true on failure, false on success.
+    //!
+    ///////////////////////////////////////////////////////////////////////////
+
+    bool flush();
+
+    ///////////////////////////////////////////////////////////////////////////
+    //!
+    //! Update file size.
+    //!
+    //! The function queries the filesystem for the current size of the file
+    //! and updates #size if the file has grown since it was opened, as it
+    //! does when it is being written by another process.
+    //!
+    //! @return true on failure, false on success.
+    //!
+    ///////////////////////////////////////////////////////////////////////////
+
+    bool updateSize();
+
 private:
     std::string   _name;
     bool          _isOpen;
@@ -170,6 +264,7 @@ private:
     Size          _size;
     Size          _position;
     FileProvider& _provider;
+    std::mutex    _readAtLock;  // serializes readAt() on providers without it
 
 public:
     const std::string& name;      //!< read-only: file pathname or empty-string if not applicable
@@ -1,4 +1,5 @@
 #include "libplatform/impl.h"
+#include <sys/mman.h>
 
 namespace mp4v2 { namespace platform { namespace io {
 
@@ -15,10 +16,40 @@ public:
     bool write( const void* buffer, Size size, Size& nout, Size maxChunkSize );
     bool close();
 
+    bool canReadAt();
+    bool readAt( void* buffer, Size size, Size pos, Size& nin );
+
+    FileMapping* map( Size pos, Size size );
+
+    bool flush();
+
 private:
     bool         _seekg;
     bool         _seekp;
     std::fstream _fstream;
+    int          _fd;   // read-only descriptor for readAt(), MODE_READ only
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class StandardFileMapping : public FileMapping
+{
+public:
+    StandardFileMapping( void* base, size_t length, size_t skip )
+        : _base   ( base )
+        , _length ( length )
+    {
+        data = (const uint8_t*)base + skip;
+    }
+
+    ~StandardFileMapping()
+    {
+        ::munmap( _base, _length );
+    }
+
+private:
+    void*  _base;
+    size_t _length;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -26,6 +57,7 @@ private:
 StandardFileProvider::StandardFileProvider()
     : _seekg ( false )
     , _seekp ( false )
+    , _fd    ( -1 )
 {
 }
 
@@ -56,7 +88,14 @@ StandardFileProvider::open( std::string name, Mode mode )
     }
 
     _fstream.open( name.c_str(), om );
-    return _fstream.fail();
+    if( _fstream.fail() )
+        return true;
+
+    // Writers go through the fstream buffer, so pread() on a second
+    // descriptor is only coherent for files which are never written.
+    if( mode == MODE_READ )
+        _fd = ::open( name.c_str(), O_RDONLY );
+    return false;
 }
 
 bool
@@ -89,9 +128,62 @@ StandardFileProvider::write( const void* buffer, Size size, Size& nout, Size max
     return false;
 }
 
+bool
+StandardFileProvider::canReadAt()
+{
+    return _fd != -1;
+}
+
+bool
+StandardFileProvider::readAt( void* buffer, Size size, Size pos, Size& nin )
+{
+    nin = 0;
+    while( nin < size ) {
+        ssize_t n = ::pread( _fd, (char*)buffer + nin, (size_t)(size - nin), (off_t)(pos + nin) );
+        if( n < 0 ) {
+            if( errno == EINTR )
+                continue;
+            return true;
+        }
+        if( n == 0 )
+            break;
+        nin += n;
+    }
+    return false;
+}
+
+FileMapping*
+StandardFileProvider::map( Size pos, Size size )
+{
+    if( _fd == -1 )
+        return NULL;
+
+    // mmap offsets must be page aligned
+    const Size page = ::sysconf( _SC_PAGESIZE );
+    const Size skip = pos % page;
+    const size_t length = (size_t)(size + skip);
+
+    void* base = ::mmap( NULL, length, PROT_READ, MAP_PRIVATE, _fd, (off_t)(pos - skip) );
+    if( base == MAP_FAILED )
+        return NULL;
+
+    return new StandardFileMapping( base, length, (size_t)skip );
+}
+
+bool
+StandardFileProvider::flush()
+{
+    _fstream.flush();
+    return _fstream.fail();
+}
+
 bool
 StandardFileProvider::close()
 {
+    if( _fd != -1 ) {
+        ::close( _fd );
+        _fd = -1;
+    }
     _fstream.close();
     return _fstream.fail();
 }
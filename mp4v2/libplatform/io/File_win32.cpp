@@ -38,9 +38,19 @@ public:
     bool write( const void* buffer, Size size, Size& nout, Size maxChunkSize );
     bool close();
 
+    bool canReadAt();
+    bool readAt( void* buffer, Size size, Size pos, Size& nin );
+
+    FileMapping* map( Size pos, Size size );
+
 private:
     HANDLE _handle;
 
+    /**
+     * Second read-only handle for readAt(), opened in MODE_READ only
+     */
+    HANDLE _readAtHandle;
+
     /**
      * The UTF-8 encoded file name
      */
@@ -49,8 +59,29 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+class StandardFileMapping : public FileMapping
+{
+public:
+    StandardFileMapping( void* view, size_t skip )
+        : _view( view )
+    {
+        data = (const uint8_t*)view + skip;
+    }
+
+    ~StandardFileMapping()
+    {
+        UnmapViewOfFile( _view );
+    }
+
+private:
+    void* _view;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 StandardFileProvider::StandardFileProvider()
     : _handle( INVALID_HANDLE_VALUE )
+    , _readAtHandle( INVALID_HANDLE_VALUE )
 {
 }
 
@@ -115,6 +146,12 @@ StandardFileProvider::open( std::string name, Mode mode )
     log.verbose2f("%s: CreateFileW(%s) succeeded",__FUNCTION__,filename.utf8.c_str());
 
     _name = filename.utf8;
+
+    // Positional reads use their own handle so they never move the file
+    // pointer that seek()/read() rely on.
+    if( mode == MODE_READ )
+        _readAtHandle = CreateFileW( filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                                     OPEN_EXISTING, flags, NULL );
     return false;
 }
 
@@ -217,6 +254,100 @@ StandardFileProvider::write( const void* buffer, Size size, Size& nout, Size max
     return false;
 }
 
+/**
+ * Whether readAt() is available
+ *
+ * @retval true the file was opened for reading and has a
+ * positional read handle
+ */
+bool
+StandardFileProvider::canReadAt()
+{
+    return _readAtHandle != INVALID_HANDLE_VALUE;
+}
+
+/**
+ * Read from an offset in the file without using the file
+ * pointer
+ *
+ * @param buffer populated with at most @p size bytes from
+ * the file
+ *
+ * @param size the maximum number of bytes to read
+ *
+ * @param pos the offset from the beginning of the file to
+ * read from
+ *
+ * @param nin populated with the number of bytes actually
+ * read
+ *
+ * @retval false successfully read from the file
+ * @retval true error reading from the file
+ */
+bool
+StandardFileProvider::readAt( void* buffer, Size size, Size pos, Size& nin )
+{
+    nin = 0;
+    while( nin < size ) {
+        OVERLAPPED ov;
+        memset( &ov, 0, sizeof(ov) );
+        ov.Offset     = (DWORD)((pos + nin) & MAXDWORD);
+        ov.OffsetHigh = (DWORD)((pos + nin) >> 32);
+
+        DWORD toread = (DWORD)min( size - nin, (Size)MAXDWORD );
+        DWORD nread = 0;
+        if( ReadFile( _readAtHandle, (char*)buffer + nin, toread, &nread, &ov ) == 0 )
+        {
+            if( GetLastError() == ERROR_HANDLE_EOF )
+                break;
+            log.errorf("%s: ReadFile(%s,%d) failed (%d)",__FUNCTION__,_name.c_str(),
+                       toread,GetLastError());
+            return true;
+        }
+        if( nread == 0 )
+            break;
+        nin += nread;
+    }
+    return false;
+}
+
+/**
+ * Map a region of the file for reading
+ *
+ * @param pos the offset from the beginning of the file of
+ * the region
+ *
+ * @param size the size of the region in bytes
+ *
+ * @return the mapping or NULL if the file can't be mapped
+ */
+FileMapping*
+StandardFileProvider::map( Size pos, Size size )
+{
+    if( _readAtHandle == INVALID_HANDLE_VALUE )
+        return NULL;
+
+    // view offsets must be multiples of the allocation granularity
+    SYSTEM_INFO si;
+    GetSystemInfo( &si );
+    const Size skip = pos % si.dwAllocationGranularity;
+    const Size start = pos - skip;
+
+    HANDLE mapping = CreateFileMappingW( _readAtHandle, NULL, PAGE_READONLY, 0, 0, NULL );
+    if( mapping == NULL )
+        return NULL;
+
+    void* view = MapViewOfFile( mapping, FILE_MAP_READ, (DWORD)(start >> 32),
+                                (DWORD)(start & MAXDWORD), (SIZE_T)(size + skip) );
+
+    // the view keeps the mapping object alive
+    CloseHandle( mapping );
+    if( view == NULL )
+        return NULL;
+
+    return new StandardFileMapping( view, (size_t)skip );
+}
+
 /**
  * Close the file
  *
@@ -228,6 +359,11 @@ StandardFileProvider::close()
 {
     BOOL retval;
 
+    if( _readAtHandle != INVALID_HANDLE_VALUE ) {
+        CloseHandle( _readAtHandle );
+        _readAtHandle = INVALID_HANDLE_VALUE;
+    }
+
     retval = CloseHandle( _handle );
     if (!retval)
     {
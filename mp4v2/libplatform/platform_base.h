@@ -10,6 +10,7 @@
 #include <list>
 #include <locale>
 #include <map>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <string>
@@ -12,8 +12,12 @@
 #define MP4_CREATE_64BIT_DATA 0x01
 /** Bit: enable 64-bit time-atoms. @note Incompatible with QuickTime. */
 #define MP4_CREATE_64BIT_TIME 0x02
+/** Bit: write samples as movie fragments (moof/mdat) as they arrive. */
+#define MP4_CREATE_FRAGMENTED 0x04
 /** Bit: do not recompute avg/max bitrates on file close.  @note See http://code.google.com/p/mp4v2/issues/detail?id=66 */
 #define MP4_CLOSE_DO_NOT_COMPUTE_BITRATE 0x01
+/** Bit: leave large sample tables in the file until first accessed. */
+#define MP4_READ_LAZY_TABLES 0x01
 
 /** Enumeration of file modes for custom file provider. */
 typedef enum MP4FileMode_e
@@ -74,6 +78,7 @@ void MP4Close(
  *      data or time atoms. Valid bits may be any combination of:
  *          @li #MP4_CREATE_64BIT_DATA
  *          @li #MP4_CREATE_64BIT_TIME
+ *          @li #MP4_CREATE_FRAGMENTED
  *
  *  @return On success a handle of the newly created file for use in
  *      subsequent calls to the library.
@@ -97,6 +102,7 @@ MP4FileHandle MP4Create(
  *      data or time atoms. Valid bits may be any combination of:
  *          @li #MP4_CREATE_64BIT_DATA
  *          @li #MP4_CREATE_64BIT_TIME
+ *          @li #MP4_CREATE_FRAGMENTED
  *  @param add_ftyp if true an <b>ftyp</b> atom is automatically created.
  *  @param add_iods if true an <b>iods</b> atom is automatically created.
  *  @param majorBrand <b>ftyp</b> brand identifier.
@@ -357,6 +363,94 @@ MP4FileHandle MP4ReadProvider(
     const char*            fileName,
     const MP4FileProvider* fileProvider DEFAULT(NULL) );
 
+/** Read an existing mp4 file with options.
+ *
+ *  MP4ReadEx is like MP4ReadProvider() but takes flags controlling how the
+ *  control information is loaded.
+ *
+ *  With #MP4_READ_LAZY_TABLES, large sample tables (sizes, chunk offsets,
+ *  times, composition offsets, sync samples) are only located while
+ *  parsing. Each is memory mapped, or read in if the file provider cannot
+ *  map, the first time one of its entries is needed and decoded in place.
+ *  Open time and memory use then no longer grow with the movie duration,
+ *  which matters for long, high frame rate movies.
+ *
+ *  @param fileName pathname of the file to be read.
+ *      On Windows, this should be a UTF-8 encoded string.
+ *      On other platforms, it should be an 8-bit encoding that is
+ *      appropriate for the platform, locale, file system, etc.
+ *      (prefer to use UTF-8 when possible).
+ *  @param flags bitmask that allows the user to set extra options for
+ *      reading. Valid options include:
+ *          @li #MP4_READ_LAZY_TABLES
+ *  @param fileProvider custom implementation of file I/O operations.
+ *      All functions in structure must be implemented.
+ *      The structure is immediately copied internally.
+ *
+ *  @return On success a handle of the file for use in subsequent calls to
+ *      the library.
+ *      On error, #MP4_INVALID_FILE_HANDLE.
+ */
+MP4V2_EXPORT
+MP4FileHandle MP4ReadEx(
+    const char*            fileName,
+    uint32_t               flags,
+    const MP4FileProvider* fileProvider DEFAULT(NULL) );
+
+/** Set the fragment interval of a fragmented mp4 file.
+ *
+ *  Files created with #MP4_CREATE_FRAGMENTED are written as a <b>moov</b>
+ *  atom with empty sample tables followed by a series of movie fragments,
+ *  each a <b>moof</b> atom describing the samples of its <b>mdat</b> atom.
+ *  A fragment is written out once the samples buffered for the first video
+ *  track (or the first track if there is no video) span the interval and
+ *  the next sample of that track is a sync sample, so every fragment can be
+ *  decoded on its own. The file is playable up to the last fragment while
+ *  it is still being written.
+ *
+ *  @param hFile handle of file to change.
+ *  @param duration fragment interval in the movie time scale,
+ *      or 0 for the default of one second.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ */
+MP4V2_EXPORT
+bool MP4SetFragmentDuration(
+    MP4FileHandle hFile,
+    MP4Duration   duration );
+
+/** Write out the pending samples of a fragmented mp4 file as a fragment.
+ *
+ *  MP4WriteFragment ends the current fragment regardless of the fragment
+ *  interval, e.g. at a scene change or before a pause in the input.
+ *  Samples which are still pending when the file is closed are written out
+ *  by MP4Close().
+ *
+ *  @param hFile handle of file to write.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ */
+MP4V2_EXPORT
+bool MP4WriteFragment(
+    MP4FileHandle hFile );
+
+/** Pick up movie fragments appended to a file since it was read.
+ *
+ *  When a fragmented mp4 file is read, the samples of its fragments are
+ *  added to the tracks as if they were described by the sample tables.
+ *  MP4ScanFragments looks for fragments which have been completed since the
+ *  file was read or last scanned, as happens when the file is still being
+ *  written, and adds their samples. It must not be called while samples
+ *  are read from other threads.
+ *
+ *  @param hFile handle of file to scan.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ */
+MP4V2_EXPORT
+bool MP4ScanFragments(
+    MP4FileHandle hFile );
+
 /** @} ***********************************************************************/
 
 #endif /* MP4V2_FILE_H */
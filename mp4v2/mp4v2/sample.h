@@ -99,6 +99,93 @@ bool MP4ReadSample(
     MP4Duration*  pRenderingOffset DEFAULT(NULL),
     bool*         pIsSyncSample DEFAULT(NULL) );
 
+/** Read a track sample into a caller buffer, reentrantly.
+ *
+ *  MP4ReadSampleTo reads the specified sample into <b>pBytes</b> using
+ *  positional I/O, so the file position shared by the other read functions
+ *  is neither used nor changed. Several threads may call MP4ReadSampleTo()
+ *  and MP4ReadSamples() on the same file handle at once, for the same or
+ *  different tracks, which avoids opening one handle per track. They must
+ *  not run concurrently with any other function on the handle.
+ *
+ *  The file must have been opened with MP4Read(). Nothing is allocated per
+ *  sample; the buffer must hold at least MP4GetSampleSize() bytes, or
+ *  MP4GetTrackMaxSampleSize() for any sample of the track.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param sampleId specifies which sample is to be read.
+ *      Caveat: the first sample has id <b>1</b> not <b>0</b>.
+ *  @param pBytes buffer receiving the sample data.
+ *  @param numBytes size of <b>pBytes</b> in bytes.
+ *  @param pSampleSize pointer to variable that will hold the size in bytes
+ *      of the sample.
+ *  @param pStartTime if non-NULL, pointer to variable that will receive the
+ *      starting timestamp for this sample.
+ *  @param pDuration if non-NULL, pointer to variable that will receive the
+ *      duration for this sample.
+ *  @param pRenderingOffset if non-NULL, pointer to variable that will
+ *      receive the rendering offset for this sample.
+ *  @param pIsSyncSample if non-NULL, pointer to variable that will receive
+ *      the state of the sync/random access flag for this sample.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ *
+ *  @see MP4ReadSample().
+ *  @see MP4ReadSamples().
+ */
+MP4V2_EXPORT
+bool MP4ReadSampleTo(
+    /* input parameters */
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    MP4SampleId   sampleId,
+    uint8_t*      pBytes,
+    uint32_t      numBytes,
+    /* output parameters */
+    uint32_t*     pSampleSize,
+    MP4Timestamp* pStartTime DEFAULT(NULL),
+    MP4Duration*  pDuration DEFAULT(NULL),
+    MP4Duration*  pRenderingOffset DEFAULT(NULL),
+    bool*         pIsSyncSample DEFAULT(NULL) );
+
+/** Read a run of consecutive track samples, reentrantly.
+ *
+ *  MP4ReadSamples reads up to <b>numSamples</b> samples starting at
+ *  <b>firstSampleId</b>, packed back to back into <b>pBytes</b>. Samples
+ *  stored contiguously in the file are fetched with a single read, which
+ *  typically means one read per chunk. Reading stops early at the end of
+ *  the track or at the first sample that no longer fits the buffer; at
+ *  least one sample must fit. Thread safety is as for MP4ReadSampleTo().
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param firstSampleId id of the first sample to read.
+ *  @param numSamples maximum number of samples to read.
+ *  @param pBytes buffer receiving the sample data.
+ *  @param numBytes size of <b>pBytes</b> in bytes.
+ *  @param pSampleSizes array of at least <b>numSamples</b> entries which
+ *      receives the size in bytes of each sample read.
+ *  @param pNumSamplesRead pointer to variable that will receive the number
+ *      of samples read.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ *
+ *  @see MP4ReadSampleTo().
+ */
+MP4V2_EXPORT
+bool MP4ReadSamples(
+    /* input parameters */
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    MP4SampleId   firstSampleId,
+    uint32_t      numSamples,
+    uint8_t*      pBytes,
+    uint32_t      numBytes,
+    /* output parameters */
+    uint32_t*     pSampleSizes,
+    uint32_t*     pNumSamplesRead );
+
 /** Read a track sample based on a specified time.
  *
  *  MP4ReadSampleFromTime is similar to MP4ReadSample() except the sample
@@ -435,6 +435,43 @@ bool MP4SetTrackDurationPerChunk(
     MP4TrackId    trackId,
     MP4Duration   duration );
 
+/** Get sample indexing state of track.
+ *
+ *  MP4GetTrackSampleIndexing reports whether the track may build a flat
+ *  sample index (file offset, size, times, sync flag per sample) the
+ *  first time it is read out of order. Indexing is enabled by default.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param enabled out value of indexing state.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ */
+MP4V2_EXPORT
+bool MP4GetTrackSampleIndexing(
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    bool*         enabled );
+
+/** Enable or disable sample indexing of track.
+ *
+ *  MP4SetTrackSampleIndexing controls the flat sample index used to make
+ *  random access (seeking, MP4GetSampleIdFromTime) constant or logarithmic
+ *  time. Disabling it releases an index already built, which costs about
+ *  32 bytes per sample. Files opened for writing never build an index.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param enable <b>true</b> to allow indexing, <b>false</b> to disable it.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ */
+MP4V2_EXPORT
+bool MP4SetTrackSampleIndexing(
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    bool          enable );
+
 /**
  *  @param hFile handle of file for operation.
  *  @param trackId id of track for operation.
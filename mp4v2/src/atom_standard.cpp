@@ -367,6 +367,7 @@ MP4StandardAtom::MP4StandardAtom (MP4File &file, const char *type) : MP4Atom(fil
 
     } else if (ATOMID(type) == ATOMID("traf")) {
         ExpectChildAtom("tfhd", Required, OnlyOne);
+        ExpectChildAtom("tfdt", Optional, OnlyOne);
         ExpectChildAtom("trun", Optional, Many);
 
     } else if (ATOMID(type) == ATOMID("trak")) {
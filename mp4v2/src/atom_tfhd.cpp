@@ -59,6 +59,14 @@ void MP4TfhdAtom::AddProperties(uint32_t flags)
     }
 }
 
+void MP4TfhdAtom::Generate()
+{
+    MP4Atom::Generate();
+
+    /* the flags set by the caller decide which properties are present */
+    AddProperties(GetFlags());
+}
+
 void MP4TfhdAtom::Read()
 {
     /* read atom version, flags, and trackId */
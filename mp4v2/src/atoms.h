@@ -624,9 +624,23 @@ private:
     MP4FtabAtom &operator= ( const MP4FtabAtom &src );
 };
 
+class MP4TfdtAtom : public MP4Atom {
+public:
+    MP4TfdtAtom(MP4File &file);
+    void Generate();
+    void Read();
+protected:
+    void AddProperties(uint8_t version);
+private:
+    MP4TfdtAtom();
+    MP4TfdtAtom( const MP4TfdtAtom &src );
+    MP4TfdtAtom &operator= ( const MP4TfdtAtom &src );
+};
+
 class MP4TfhdAtom : public MP4Atom {
 public:
     MP4TfhdAtom(MP4File &file);
+    void Generate();
     void Read();
 protected:
     void AddProperties(uint32_t flags);
@@ -652,6 +666,7 @@ private:
 class MP4TrunAtom : public MP4Atom {
 public:
     MP4TrunAtom(MP4File &file);
+    void Generate();
     void Read();
 protected:
     void AddProperties(uint32_t flags);
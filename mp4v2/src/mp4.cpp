@@ -143,6 +143,33 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
     return MP4_INVALID_FILE_HANDLE;
 }
 
+MP4FileHandle MP4ReadEx( const char* fileName, uint32_t flags, const MP4FileProvider* fileProvider )
+{
+    if (!fileName)
+        return MP4_INVALID_FILE_HANDLE;
+
+    MP4File *pFile = ConstructMP4File();
+    if (!pFile)
+        return MP4_INVALID_FILE_HANDLE;
+
+    try {
+        pFile->Read( fileName, fileProvider, flags );
+        return (MP4FileHandle)pFile;
+    }
+    catch( Exception* x ) {
+        mp4v2::impl::log.errorf(*x);
+        delete x;
+    }
+    catch( ... ) {
+        mp4v2::impl::log.errorf("%s: \"%s\": failed", __FUNCTION__,
+                                fileName );
+    }
+
+    if (pFile)
+        delete pFile;
+    return MP4_INVALID_FILE_HANDLE;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
     MP4FileHandle MP4Create (const char* fileName,
@@ -2927,6 +2954,83 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
         return false;
     }
 
+    bool MP4ReadSampleTo(
+        /* input parameters */
+        MP4FileHandle hFile,
+        MP4TrackId trackId,
+        MP4SampleId sampleId,
+        uint8_t* pBytes,
+        uint32_t numBytes,
+        /* output parameters */
+        uint32_t* pSampleSize,
+        MP4Timestamp* pStartTime,
+        MP4Duration* pDuration,
+        MP4Duration* pRenderingOffset,
+        bool* pIsSyncSample)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile) && pBytes && pSampleSize) {
+            try {
+                ((MP4File*)hFile)->ReadSampleTo(
+                    trackId,
+                    sampleId,
+                    pBytes,
+                    numBytes,
+                    pSampleSize,
+                    pStartTime,
+                    pDuration,
+                    pRenderingOffset,
+                    pIsSyncSample);
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        if (pSampleSize)
+            *pSampleSize = 0;
+        return false;
+    }
+
+    bool MP4ReadSamples(
+        /* input parameters */
+        MP4FileHandle hFile,
+        MP4TrackId trackId,
+        MP4SampleId firstSampleId,
+        uint32_t numSamples,
+        uint8_t* pBytes,
+        uint32_t numBytes,
+        /* output parameters */
+        uint32_t* pSampleSizes,
+        uint32_t* pNumSamplesRead)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile) && pBytes && pSampleSizes && pNumSamplesRead) {
+            try {
+                *pNumSamplesRead = ((MP4File*)hFile)->ReadSamplesTo(
+                    trackId,
+                    firstSampleId,
+                    numSamples,
+                    pBytes,
+                    numBytes,
+                    pSampleSizes);
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        if (pNumSamplesRead)
+            *pNumSamplesRead = 0;
+        return false;
+    }
+
     bool MP4ReadSampleFromTime(
         /* input parameters */
         MP4FileHandle hFile,
@@ -4560,4 +4664,127 @@ bool MP4SetTrackDurationPerChunk(
 
 ///////////////////////////////////////////////////////////////////////////////
 
+bool MP4GetTrackSampleIndexing(
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    bool*         enabled )
+{
+    if( !MP4_IS_VALID_FILE_HANDLE( hFile ))
+        return false;
+
+    if (!enabled)
+        return false;
+
+    try {
+        *enabled = ((MP4File*)hFile)->GetTrackSampleIndexing( trackId );
+        return true;
+    }
+    catch( Exception* x ) {
+        mp4v2::impl::log.errorf(*x);
+        delete x;
+    }
+    catch( ... ) {
+        mp4v2::impl::log.errorf("%s: failed", __FUNCTION__ );
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MP4SetTrackSampleIndexing(
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    bool          enable )
+{
+    if( !MP4_IS_VALID_FILE_HANDLE( hFile ))
+        return false;
+
+    try {
+        ((MP4File*)hFile)->SetTrackSampleIndexing( trackId, enable );
+        return true;
+    }
+    catch( Exception* x ) {
+        mp4v2::impl::log.errorf(*x);
+        delete x;
+    }
+    catch( ... ) {
+        mp4v2::impl::log.errorf("%s: failed", __FUNCTION__ );
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MP4SetFragmentDuration(
+    MP4FileHandle hFile,
+    MP4Duration   duration )
+{
+    if( !MP4_IS_VALID_FILE_HANDLE( hFile ))
+        return false;
+
+    try {
+        ((MP4File*)hFile)->SetFragmentDuration( duration );
+        return true;
+    }
+    catch( Exception* x ) {
+        mp4v2::impl::log.errorf(*x);
+        delete x;
+    }
+    catch( ... ) {
+        mp4v2::impl::log.errorf("%s: failed", __FUNCTION__ );
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MP4WriteFragment(
+    MP4FileHandle hFile )
+{
+    if( !MP4_IS_VALID_FILE_HANDLE( hFile ))
+        return false;
+
+    try {
+        ((MP4File*)hFile)->WriteFragment();
+        return true;
+    }
+    catch( Exception* x ) {
+        mp4v2::impl::log.errorf(*x);
+        delete x;
+    }
+    catch( ... ) {
+        mp4v2::impl::log.errorf("%s: failed", __FUNCTION__ );
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MP4ScanFragments(
+    MP4FileHandle hFile )
+{
+    if( !MP4_IS_VALID_FILE_HANDLE( hFile ))
+        return false;
+
+    try {
+        ((MP4File*)hFile)->ScanFragments();
+        return true;
+    }
+    catch( Exception* x ) {
+        mp4v2::impl::log.errorf(*x);
+        delete x;
+    }
+    catch( ... ) {
+        mp4v2::impl::log.errorf("%s: failed", __FUNCTION__ );
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 } // extern "C"
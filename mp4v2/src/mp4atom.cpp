@@ -989,6 +989,8 @@ MP4Atom::factory( MP4File &file, MP4Atom* parent, const char* type )
                 return new MP4Tx3gAtom(file);
             if( ATOMID(type) == ATOMID("tkhd") )
                 return new MP4TkhdAtom(file);
+            if( ATOMID(type) == ATOMID("tfdt") )
+                return new MP4TfdtAtom(file);
             if( ATOMID(type) == ATOMID("tfhd") )
                 return new MP4TfhdAtom(file);
             if( ATOMID(type) == ATOMID("trun") )
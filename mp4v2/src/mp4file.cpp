@@ -38,6 +38,7 @@ MP4File::MP4File( ) :
     m_file             ( NULL )
     , m_fileOriginalSize ( 0 )
     , m_createFlags      ( 0 )
+    , m_readFlags        ( 0 )
 {
     this->Init();
 }
@@ -66,6 +67,11 @@ void MP4File::Init()
     m_bufWriteBits = 0;
     m_editName = NULL;
     m_trakName[0] = '\0';
+
+    m_fragmentDuration = 0;
+    m_fragmentSequence = 0;
+    m_fragmentHeaderWritten = false;
+    m_fragmentPosition = 0;
 }
 
 MP4File::~MP4File()
@@ -90,11 +96,13 @@ MP4File::GetFilename() const
     return m_file->name;
 }
 
-void MP4File::Read( const char* name, const MP4FileProvider* provider )
+void MP4File::Read( const char* name, const MP4FileProvider* provider, uint32_t flags )
 {
+    m_readFlags = flags;
     Open( name, File::MODE_READ, provider );
     ReadFromFile();
     CacheProperties();
+    ScanFragments();
 }
 
 void MP4File::Create( const char* fileName,
@@ -120,12 +128,16 @@ void MP4File::Create( const char* fileName,
 
     CacheProperties();
 
-    // create mdat, and insert it after ftyp, and before moov
-    (void)InsertChildAtom(m_pRootAtom, "mdat",
-                          add_ftyp != 0 ? 1 : 0);
+    // fragmented files have their moov written ahead of the first fragment,
+    // see BeginFragmentedWrite()
+    if (!IsFragmentedWrite()) {
+        // create mdat, and insert it after ftyp, and before moov
+        (void)InsertChildAtom(m_pRootAtom, "mdat",
+                              add_ftyp != 0 ? 1 : 0);
 
-    // start writing
-    m_pRootAtom->BeginWrite();
+        // start writing
+        m_pRootAtom->BeginWrite();
+    }
     if (add_iods != 0) {
         (void)AddChildAtom("moov", "iods");
     }
@@ -422,16 +434,64 @@ void MP4File::ReadFromFile()
 
     uint64_t fileSize = GetSize();
 
+    // when reading, movie fragments are not kept as atoms but indexed by
+    // ScanFragments(), which can pick up more of them as the file grows
+    uint64_t rootSize = fileSize;
+    if( m_file->mode == File::MODE_READ ) {
+        m_fragmentPosition = FindFirstFragment( fileSize );
+        if( m_fragmentPosition )
+            rootSize = m_fragmentPosition;
+        SetPosition(0);
+    }
+
     m_pRootAtom->SetStart(0);
-    m_pRootAtom->SetSize(fileSize);
-    m_pRootAtom->SetEnd(fileSize);
+    m_pRootAtom->SetSize(rootSize);
+    m_pRootAtom->SetEnd(rootSize);
 
     m_pRootAtom->Read();
 
+    // a fragmented file which has no fragments yet
+    if( m_file->mode == File::MODE_READ && !m_fragmentPosition ) {
+        MP4Atom* pMoovAtom = m_pRootAtom->FindChildAtom( "moov" );
+        if( pMoovAtom && pMoovAtom->FindChildAtom( "mvex" ))
+            m_fragmentPosition = pMoovAtom->GetEnd();
+    }
+
     // create MP4Track's for any tracks in the file
     GenerateTracks();
 }
 
+// position of the first moof following the moov, or 0 if there is none
+uint64_t MP4File::FindFirstFragment( uint64_t fileSize )
+{
+    bool haveMoov = false;
+    uint64_t pos = 0;
+
+    while( pos + 8 <= fileSize ) {
+        SetPosition( pos );
+        uint64_t size = ReadUInt32();
+        uint32_t type = ReadUInt32();
+        if( size == 1 ) {
+            if( pos + 16 > fileSize )
+                break;
+            size = ReadUInt64();
+        } else if( size == 0 ) {
+            break;
+        }
+        if( size < 8 )
+            break;
+
+        if( type == ATOMID( "moov" )) {
+            haveMoov = true;
+        } else if( type == ATOMID( "moof" )) {
+            return haveMoov ? pos : 0;
+        }
+        pos += size;
+    }
+
+    return 0;
+}
+
 void MP4File::GenerateTracks()
 {
     uint32_t trackIndex = 0;
@@ -616,7 +676,10 @@ void MP4File::Close(uint32_t options)
 {
     if( IsWriteMode() ) {
         SetIntegerProperty( "moov.mvhd.modificationTime", MP4GetAbsTimestamp() );
-        FinishWrite(options);
+        if( IsFragmentedWrite() )
+            FinishFragmentedWrite();
+        else
+            FinishWrite(options);
     }
 
     delete m_file;
@@ -902,6 +965,11 @@ MP4TrackId MP4File::AddTrack(const char* type, uint32_t timeScale)
 {
     ProtectWriteOperation(__FILE__, __LINE__, __FUNCTION__);
 
+    if (m_fragmentHeaderWritten) {
+        throw new Exception("can't add tracks after the first movie fragment",
+                            __FILE__, __LINE__, __FUNCTION__);
+    }
+
     // create and add new trak atom
     MP4Atom* pTrakAtom = AddChildAtom("moov", "trak");
     ASSERT(pTrakAtom);
@@ -3033,6 +3101,44 @@ void MP4File::ReadSample(
         dependencyFlags );
 }
 
+void MP4File::ReadSampleTo(
+    MP4TrackId    trackId,
+    MP4SampleId   sampleId,
+    uint8_t*      pBytes,
+    uint32_t      numBytes,
+    uint32_t*     pSampleSize,
+    MP4Timestamp* pStartTime,
+    MP4Duration*  pDuration,
+    MP4Duration*  pRenderingOffset,
+    bool*         pIsSyncSample )
+{
+    m_pTracks[FindTrackIndex(trackId)]->ReadSampleTo(
+        sampleId,
+        pBytes,
+        numBytes,
+        pSampleSize,
+        pStartTime,
+        pDuration,
+        pRenderingOffset,
+        pIsSyncSample );
+}
+
+uint32_t MP4File::ReadSamplesTo(
+    MP4TrackId  trackId,
+    MP4SampleId firstSampleId,
+    uint32_t    numSamples,
+    uint8_t*    pBytes,
+    uint32_t    numBytes,
+    uint32_t*   pSampleSizes )
+{
+    return m_pTracks[FindTrackIndex(trackId)]->ReadSamplesTo(
+        firstSampleId,
+        numSamples,
+        pBytes,
+        numBytes,
+        pSampleSizes );
+}
+
 void MP4File::WriteSample(
     MP4TrackId     trackId,
     const uint8_t* pBytes,
@@ -3042,7 +3148,11 @@ void MP4File::WriteSample(
     bool           isSyncSample )
 {
     ProtectWriteOperation(__FILE__, __LINE__, __FUNCTION__);
-    m_pTracks[FindTrackIndex(trackId)]->WriteSample(
+    MP4Track* pTrack = m_pTracks[FindTrackIndex(trackId)];
+    if (IsFragmentedWrite()) {
+        CheckFragmentBoundary(pTrack, isSyncSample);
+    }
+    pTrack->WriteSample(
         pBytes, numBytes, duration, renderingOffset, isSyncSample );
     m_pModificationProperty->SetValue( MP4GetAbsTimestamp() );
 }
@@ -3057,7 +3167,11 @@ void MP4File::WriteSampleDependency(
     uint32_t       dependencyFlags )
 {
     ProtectWriteOperation(__FILE__, __LINE__, __FUNCTION__);
-    m_pTracks[FindTrackIndex(trackId)]->WriteSampleDependency(
+    MP4Track* pTrack = m_pTracks[FindTrackIndex(trackId)];
+    if (IsFragmentedWrite()) {
+        CheckFragmentBoundary(pTrack, isSyncSample);
+    }
+    pTrack->WriteSampleDependency(
         pBytes, numBytes, duration, renderingOffset, isSyncSample, dependencyFlags );
     m_pModificationProperty->SetValue( MP4GetAbsTimestamp() );
 }
@@ -3556,6 +3670,11 @@ bool MP4File::IsWriteMode()
     return true;
 }
 
+bool MP4File::IsFragmentedWrite()
+{
+    return (m_createFlags & MP4_CREATE_FRAGMENTED) && IsWriteMode();
+}
+
 void MP4File::GetTrackESConfiguration(MP4TrackId trackId,
                                       uint8_t** ppConfig, uint32_t* pConfigSize)
 {
@@ -4221,6 +4340,407 @@ void MP4File::SetTrackDurationPerChunk( MP4TrackId trackId, MP4Duration duration
     m_pTracks[FindTrackIndex(trackId)]->SetDurationPerChunk( duration );
 }
 
+bool MP4File::GetTrackSampleIndexing( MP4TrackId trackId )
+{
+    return m_pTracks[FindTrackIndex(trackId)]->GetSampleIndexing();
+}
+
+void MP4File::SetTrackSampleIndexing( MP4TrackId trackId, bool enable )
+{
+    m_pTracks[FindTrackIndex(trackId)]->SetSampleIndexing( enable );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// movie fragments
+
+MP4Duration MP4File::GetFragmentDuration()
+{
+    return m_fragmentDuration ? m_fragmentDuration : GetTimeScale();
+}
+
+void MP4File::SetFragmentDuration( MP4Duration duration )
+{
+    ProtectWriteOperation(__FILE__, __LINE__, __FUNCTION__);
+    m_fragmentDuration = duration;
+}
+
+// A new fragment is started ahead of a sync sample of the first video track
+// (or the first track) once that track has an interval's worth pending, so
+// each fragment starts with a random access point.
+void MP4File::CheckFragmentBoundary( MP4Track* pTrack, bool isSyncSample )
+{
+    if( !isSyncSample )
+        return;
+
+    MP4Track* pReferenceTrack = NULL;
+    for( uint32_t i = 0; i < m_pTracks.Size(); i++ ) {
+        if( !strcmp( m_pTracks[i]->GetType(), MP4_VIDEO_TRACK_TYPE )) {
+            pReferenceTrack = m_pTracks[i];
+            break;
+        }
+    }
+    if( !pReferenceTrack && m_pTracks.Size() )
+        pReferenceTrack = m_pTracks[0];
+    if( pTrack != pReferenceTrack )
+        return;
+
+    MP4Duration pending = MP4ConvertTime( pTrack->GetFragmentDuration(),
+                                          pTrack->GetTimeScale(), GetTimeScale() );
+    if( pending >= GetFragmentDuration() )
+        WriteFragment();
+}
+
+// the moov goes out with the first fragment, when all tracks are known
+void MP4File::BeginFragmentedWrite()
+{
+    MP4Atom* pMvexAtom = AddChildAtom( "moov", "mvex" );
+    for( uint32_t i = 0; i < m_pTracks.Size(); i++ ) {
+        MP4Atom* pTrexAtom = AddChildAtom( pMvexAtom, "trex" );
+
+        MP4Integer32Property* pProperty = NULL;
+        (void)pTrexAtom->FindProperty( "trex.trackId", (MP4Property**)&pProperty );
+        ASSERT( pProperty );
+        pProperty->SetValue( m_pTracks[i]->GetId() );
+
+        // the defaults are unused, every trun gives its own values
+        (void)pTrexAtom->FindProperty( "trex.defaultSampleDesriptionIndex",
+                                       (MP4Property**)&pProperty );
+        ASSERT( pProperty );
+        pProperty->SetValue( 1 );
+    }
+
+    SetPosition( 0 );
+    for( uint32_t i = 0; i < m_pRootAtom->GetNumberOfChildAtoms(); i++ )
+        m_pRootAtom->GetChildAtom( i )->Write();
+
+    m_fragmentHeaderWritten = true;
+}
+
+void MP4File::WriteFragment()
+{
+    ProtectWriteOperation(__FILE__, __LINE__, __FUNCTION__);
+
+    if( !IsFragmentedWrite() )
+        throw new Exception( "file was not created fragmented", __FILE__, __LINE__, __FUNCTION__ );
+
+    if( !m_fragmentHeaderWritten )
+        BeginFragmentedWrite();
+
+    MP4Atom* pMoofAtom = MP4Atom::CreateAtom( *this, NULL, "moof" );
+    pMoofAtom->Generate();
+
+    MP4Integer32Property* pSequenceProperty = NULL;
+    (void)pMoofAtom->FindProperty( "moof.mfhd.sequenceNumber",
+                                   (MP4Property**)&pSequenceProperty );
+    ASSERT( pSequenceProperty );
+
+    MP4TrackArray tracks;
+    MP4AtomArray  trafAtoms;
+    for( uint32_t i = 0; i < m_pTracks.Size(); i++ ) {
+        MP4Atom* pTrafAtom = m_pTracks[i]->AddFragmentAtom( *pMoofAtom );
+        if( pTrafAtom ) {
+            tracks.Add( m_pTracks[i] );
+            trafAtoms.Add( pTrafAtom );
+        }
+    }
+    if( tracks.Size() == 0 ) {
+        delete pMoofAtom;
+        return;
+    }
+    pSequenceProperty->SetValue( ++m_fragmentSequence );
+
+    try {
+        // the data offsets are relative to the moof, which is written once
+        // to learn its size and again in place with the offsets filled in
+        pMoofAtom->Write();
+
+        uint64_t dataOffset = pMoofAtom->GetEnd() - pMoofAtom->GetStart() + 8;
+        for( uint32_t i = 0; i < tracks.Size(); i++ ) {
+            MP4Integer32Property* pDataOffsetProperty = NULL;
+            (void)trafAtoms[i]->FindProperty( "traf.trun.dataOffset",
+                                              (MP4Property**)&pDataOffsetProperty );
+            ASSERT( pDataOffsetProperty );
+            pDataOffsetProperty->SetValue( (uint32_t)dataOffset );
+
+            dataOffset += tracks[i]->GetFragmentDataSize();
+            if( dataOffset > 0x7FFFFFFF )
+                throw new Exception( "movie fragment too large", __FILE__, __LINE__, __FUNCTION__ );
+        }
+        pMoofAtom->Rewrite();
+
+        uint64_t mdatSize = dataOffset - (pMoofAtom->GetEnd() - pMoofAtom->GetStart());
+        WriteUInt32( (uint32_t)mdatSize );
+        WriteBytes( (uint8_t*)"mdat", 4 );
+        for( uint32_t i = 0; i < tracks.Size(); i++ )
+            tracks[i]->WriteFragmentData();
+    }
+    catch( Exception* x ) {
+        delete pMoofAtom;
+        throw x;
+    }
+    delete pMoofAtom;
+
+    // make the fragment available to readers of the growing file
+    if( m_file->flush() )
+        throw new PlatformException( "flush failed", sys::getLastError(), __FILE__, __LINE__, __FUNCTION__ );
+}
+
+void MP4File::FinishFragmentedWrite()
+{
+    WriteFragment();
+
+    // The moov was written with the durations known at the first fragment.
+    // Rewrite it in place with the final ones unless it has changed size,
+    // e.g. because metadata was added since.
+    MP4Atom* pMoovAtom = FindAtom( "moov" );
+    ASSERT( pMoovAtom );
+
+    uint64_t start = pMoovAtom->GetStart();
+    uint64_t size = pMoovAtom->GetEnd() - start;
+    uint64_t end = GetPosition();
+
+    uint8_t* pBytes = NULL;
+    uint64_t newSize = 0;
+    EnableMemoryBuffer();
+    pMoovAtom->Write();
+    DisableMemoryBuffer( &pBytes, &newSize );
+    MP4Free( pBytes );
+
+    if( newSize != size ) {
+        log.warningf( "%s: \"%s\": moov changed size after the first fragment, not updated",
+                      __FUNCTION__, GetFilename().c_str() );
+        return;
+    }
+
+    SetPosition( start );
+    pMoovAtom->Write();
+    SetPosition( end );
+}
+
+void MP4File::ScanFragments()
+{
+    if( !m_fragmentPosition )
+        return;
+
+    // the size is updated for files which are still being written,
+    // custom providers keep the one they were opened with
+    (void)m_file->updateSize();
+    uint64_t fileSize = GetSize();
+
+    bool added = false;
+    while( m_fragmentPosition + 8 <= fileSize ) {
+        uint64_t pos = m_fragmentPosition;
+        SetPosition( pos );
+        uint64_t size = ReadUInt32();
+        uint32_t type = ReadUInt32();
+        if( size == 1 ) {
+            if( pos + 16 > fileSize )
+                break;
+            size = ReadUInt64();
+        } else if( size == 0 ) {
+            // extends to the end of the file, nothing can follow
+            break;
+        }
+
+        // stop at atoms which are incomplete so far
+        if( size < 8 || pos + size > fileSize )
+            break;
+
+        if( type == ATOMID( "moof" )) {
+            bool complete;
+            try {
+                complete = ReadFragment( pos, size, fileSize );
+            }
+            catch( Exception* x ) {
+                log.errorf( *x );
+                delete x;
+                break;
+            }
+            if( !complete )
+                break;
+            added = true;
+        }
+        m_fragmentPosition = pos + size;
+    }
+
+    if( added ) {
+        for( uint32_t i = 0; i < m_pTracks.Size(); i++ )
+            m_pTracks[i]->UpdateFragmentDurations();
+    }
+}
+
+namespace {
+    // sample of a movie fragment, kept until all of the fragment's sample
+    // data is known to be in the file
+    struct FragmentSample {
+        MP4Track* pTrack;
+        uint64_t  offset;
+        uint32_t  size;
+        uint32_t  duration;
+        uint32_t  renderingOffset;
+        bool      isSync;
+    };
+
+    MP4IntegerProperty* FindFragmentProperty( MP4Atom& atom, const char* name )
+    {
+        MP4Property* pProperty = NULL;
+        if( !atom.FindProperty( name, &pProperty ) || !pProperty )
+            return NULL;
+
+        switch( pProperty->GetType() ) {
+            case Integer8Property:
+            case Integer16Property:
+            case Integer24Property:
+            case Integer32Property:
+            case Integer64Property:
+                return (MP4IntegerProperty*)pProperty;
+            default:
+                return NULL;
+        }
+    }
+
+    uint32_t GetFragmentValue( MP4Atom& atom, const char* name, uint32_t defaultValue )
+    {
+        MP4IntegerProperty* pProperty = FindFragmentProperty( atom, name );
+        return pProperty ? (uint32_t)pProperty->GetValue() : defaultValue;
+    }
+}
+
+// Adds the samples of the moof at pos to their tracks. Returns false, leaving
+// the tracks alone, if some of its sample data is beyond fileSize yet.
+bool MP4File::ReadFragment( uint64_t pos, uint64_t size, uint64_t fileSize )
+{
+    SetPosition( pos );
+    uint8_t hdrSize = (ReadUInt32() == 1) ? 16 : 8;
+    SetPosition( pos + hdrSize );
+
+    MP4Atom* pMoofAtom = MP4Atom::CreateAtom( *this, NULL, "moof" );
+    pMoofAtom->SetStart( pos );
+    pMoofAtom->SetEnd( pos + size );
+    pMoofAtom->SetSize( size - hdrSize );
+    try {
+        pMoofAtom->Read();
+    }
+    catch( Exception* x ) {
+        delete pMoofAtom;
+        throw x;
+    }
+
+    vector<FragmentSample> samples;
+    uint64_t dataEnd = pos;
+    uint32_t numTrafs = 0;
+    bool complete = true;
+
+    for( uint32_t i = 0; i < pMoofAtom->GetNumberOfChildAtoms() && complete; i++ ) {
+        MP4Atom* pTrafAtom = pMoofAtom->GetChildAtom( i );
+        MP4Atom* pTfhdAtom = pTrafAtom->FindChildAtom( "tfhd" );
+        if( ATOMID( pTrafAtom->GetType() ) != ATOMID( "traf" ) || !pTfhdAtom )
+            continue;
+
+        MP4TrackId trackId = GetFragmentValue( *pTfhdAtom, "tfhd.trackId", 0 );
+        MP4Track* pTrack = NULL;
+        for( uint32_t t = 0; t < m_pTracks.Size(); t++ ) {
+            if( m_pTracks[t]->GetId() == trackId ) {
+                pTrack = m_pTracks[t];
+                break;
+            }
+        }
+        if( !pTrack ) {
+            log.warningf( "%s: \"%s\": fragment of unknown track %u",
+                          __FUNCTION__, GetFilename().c_str(), trackId );
+            continue;
+        }
+
+        // defaults come from the tfhd, else from the trex of the track
+        uint32_t defaultDuration = 0;
+        uint32_t defaultSize = 0;
+        uint32_t defaultFlags = 0;
+        for( uint32_t t = 0; ; t++ ) {
+            char trexName[32];
+            snprintf( trexName, sizeof(trexName), "moov.mvex.trex[%u]", t );
+            MP4Atom* pTrexAtom = m_pRootAtom->FindAtom( trexName );
+            if( !pTrexAtom )
+                break;
+            if( GetFragmentValue( *pTrexAtom, "trex.trackId", 0 ) == trackId ) {
+                defaultDuration = GetFragmentValue( *pTrexAtom, "trex.defaultSampleDuration", 0 );
+                defaultSize = GetFragmentValue( *pTrexAtom, "trex.defaultSampleSize", 0 );
+                defaultFlags = GetFragmentValue( *pTrexAtom, "trex.defaultSampleFlags", 0 );
+                break;
+            }
+        }
+        defaultDuration = GetFragmentValue( *pTfhdAtom, "tfhd.defaultSampleDuration", defaultDuration );
+        defaultSize = GetFragmentValue( *pTfhdAtom, "tfhd.defaultSampleSize", defaultSize );
+        defaultFlags = GetFragmentValue( *pTfhdAtom, "tfhd.defaultSampleFlags", defaultFlags );
+
+        // data offsets are relative to the explicit base, the moof, or for
+        // old style files the end of the previous track fragment's data
+        uint64_t base = pos;
+        MP4IntegerProperty* pBaseProperty = FindFragmentProperty( *pTfhdAtom, "tfhd.baseDataOffset" );
+        if( pBaseProperty )
+            base = pBaseProperty->GetValue();
+        else if( !(pTfhdAtom->GetFlags() & 0x020000) && numTrafs )
+            base = dataEnd;
+        dataEnd = base;
+        numTrafs++;
+
+        for( uint32_t j = 0; j < pTrafAtom->GetNumberOfChildAtoms() && complete; j++ ) {
+            MP4Atom* pTrunAtom = pTrafAtom->GetChildAtom( j );
+            if( ATOMID( pTrunAtom->GetType() ) != ATOMID( "trun" ))
+                continue;
+
+            uint32_t trunFlags = pTrunAtom->GetFlags();
+            uint32_t sampleCount = GetFragmentValue( *pTrunAtom, "trun.sampleCount", 0 );
+            MP4IntegerProperty* pDataOffsetProperty = FindFragmentProperty( *pTrunAtom, "trun.dataOffset" );
+            MP4IntegerProperty* pFirstFlagsProperty = FindFragmentProperty( *pTrunAtom, "trun.firstSampleFlags" );
+            MP4IntegerProperty* pDurationProperty = FindFragmentProperty( *pTrunAtom, "trun.samples.sampleDuration" );
+            MP4IntegerProperty* pSizeProperty = FindFragmentProperty( *pTrunAtom, "trun.samples.sampleSize" );
+            MP4IntegerProperty* pFlagsProperty = FindFragmentProperty( *pTrunAtom, "trun.samples.sampleFlags" );
+            MP4IntegerProperty* pRenderingOffsetProperty =
+                FindFragmentProperty( *pTrunAtom, "trun.samples.sampleCompositionTimeOffset" );
+
+            // a trun without data offset continues where the previous one ended
+            uint64_t offset = dataEnd;
+            if( pDataOffsetProperty && (trunFlags & 0x01) )
+                offset = base + (int32_t)pDataOffsetProperty->GetValue();
+
+            for( uint32_t s = 0; s < sampleCount; s++ ) {
+                FragmentSample sample;
+                sample.pTrack = pTrack;
+                sample.offset = offset;
+                sample.duration = pDurationProperty ? (uint32_t)pDurationProperty->GetValue( s ) : defaultDuration;
+                sample.size = pSizeProperty ? (uint32_t)pSizeProperty->GetValue( s ) : defaultSize;
+                sample.renderingOffset = pRenderingOffsetProperty ? (uint32_t)pRenderingOffsetProperty->GetValue( s ) : 0;
+
+                uint32_t sampleFlags = defaultFlags;
+                if( pFlagsProperty )
+                    sampleFlags = (uint32_t)pFlagsProperty->GetValue( s );
+                else if( s == 0 && pFirstFlagsProperty )
+                    sampleFlags = (uint32_t)pFirstFlagsProperty->GetValue();
+                sample.isSync = !(sampleFlags & 0x00010000); // sample_is_non_sync_sample
+
+                offset += sample.size;
+                if( offset > fileSize ) {
+                    complete = false;
+                    break;
+                }
+                samples.push_back( sample );
+            }
+            dataEnd = offset;
+        }
+    }
+    delete pMoofAtom;
+
+    if( !complete )
+        return false;
+
+    for( size_t i = 0; i < samples.size(); i++ ) {
+        const FragmentSample& sample = samples[i];
+        sample.pTrack->AppendFragmentSample( sample.offset, sample.size, sample.duration,
+                                             sample.renderingOffset, sample.isSync );
+    }
+    return true;
+}
+
 void MP4File::CopySample(
     MP4File*    srcFile,
     MP4TrackId  srcTrackId,
@@ -84,7 +84,7 @@ public:
                  uint32_t    supportedBrandsCount = 0 );
 
     const std::string &GetFilename() const;
-    void Read( const char* name, const MP4FileProvider* provider );
+    void Read( const char* name, const MP4FileProvider* provider, uint32_t flags = 0 );
     bool Modify( const char* fileName );
     void Optimize( const char* srcFileName, const char* dstFileName = NULL );
     bool CopyClose( const string& copyFileName );
@@ -209,6 +209,29 @@ public:
         bool*         hasDependencyFlags = NULL,
         uint32_t*     dependencyFlags = NULL );
 
+    void ReadSampleTo(
+        // input parameters
+        MP4TrackId  trackId,
+        MP4SampleId sampleId,
+        uint8_t*    pBytes,
+        uint32_t    numBytes,
+        // output parameters
+        uint32_t*     pSampleSize,
+        MP4Timestamp* pStartTime = NULL,
+        MP4Duration*  pDuration = NULL,
+        MP4Duration*  pRenderingOffset = NULL,
+        bool*         pIsSyncSample = NULL );
+
+    uint32_t ReadSamplesTo(
+        // input parameters
+        MP4TrackId  trackId,
+        MP4SampleId firstSampleId,
+        uint32_t    numSamples,
+        uint8_t*    pBytes,
+        uint32_t    numBytes,
+        // output parameters
+        uint32_t*   pSampleSizes );
+
     void WriteSample(
         MP4TrackId     trackId,
         const uint8_t* pBytes,
@@ -234,6 +257,16 @@ public:
     MP4Duration GetTrackDurationPerChunk( MP4TrackId );
     void        SetTrackDurationPerChunk( MP4TrackId, MP4Duration );
 
+    bool GetTrackSampleIndexing( MP4TrackId );
+    void SetTrackSampleIndexing( MP4TrackId, bool );
+
+    /* movie fragments */
+
+    MP4Duration GetFragmentDuration();
+    void        SetFragmentDuration( MP4Duration duration );
+    void        WriteFragment();
+    void        ScanFragments();
+
     /* track level convenience functions */
 
     MP4TrackId AddSystemsTrack(const char* type, uint32_t timeScale = 1000 );
@@ -768,6 +801,9 @@ public:
     uint64_t GetSize( File* file = NULL );
 
     void ReadBytes( uint8_t* buf, uint32_t bufsiz, File* file = NULL );
+    void ReadBytesAt( uint8_t* buf, uint32_t bufsiz, uint64_t pos, File* file = NULL );
+    FileMapping* MapBytes( uint64_t pos, uint64_t size );
+    bool IsLazyRead();
     void PeekBytes( uint8_t* buf, uint32_t bufsiz, File* file = NULL );
 
     uint64_t ReadUInt(uint8_t size);
@@ -812,6 +848,7 @@ public:
         uint8_t** ppBytes = NULL, uint64_t* pNumBytes = NULL);
 
     bool IsWriteMode();
+    bool IsFragmentedWrite();
 
     MP4Track* GetTrack(MP4TrackId trackId);
 
@@ -852,6 +889,11 @@ protected:
     void GenerateTracks();
     void BeginWrite();
     void FinishWrite(uint32_t options);
+    void BeginFragmentedWrite();
+    void FinishFragmentedWrite();
+    void CheckFragmentBoundary( MP4Track* pTrack, bool isSyncSample );
+    uint64_t FindFirstFragment( uint64_t fileSize );
+    bool ReadFragment( uint64_t pos, uint64_t size, uint64_t fileSize );
     void CacheProperties();
     void RewriteMdat( File& src, File& dst );
     bool ShallHaveIods();
@@ -953,6 +995,13 @@ protected:
     File*    m_file;
     uint64_t m_fileOriginalSize;
     uint32_t m_createFlags;
+    uint32_t m_readFlags;
+
+    // movie fragments
+    MP4Duration m_fragmentDuration;     // interval when writing, 0 for a second
+    uint32_t    m_fragmentSequence;     // mfhd sequence number of the last one
+    bool        m_fragmentHeaderWritten;
+    uint64_t    m_fragmentPosition;     // next top level atom to scan, 0 if none
 
     MP4Atom*          m_pRootAtom;
     MP4Integer32Array m_trakIds;
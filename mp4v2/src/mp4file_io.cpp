@@ -96,6 +96,43 @@ void MP4File::ReadBytes( uint8_t* buf, uint32_t bufsiz, File* file )
         throw new Exception( "not enough bytes, reached end-of-file", __FILE__, __LINE__, __FUNCTION__ );
 }
 
+// positional read for the reentrant sample API, leaves the position alone
+void MP4File::ReadBytesAt( uint8_t* buf, uint32_t bufsiz, uint64_t pos, File* file )
+{
+    if( bufsiz == 0 )
+        return;
+
+    ASSERT( buf );
+
+    if( m_memoryBuffer )
+        throw new Exception( "positional read from memory buffer", __FILE__, __LINE__, __FUNCTION__ );
+
+    if( !file )
+        file = m_file;
+
+    ASSERT( file );
+    File::Size nin;
+    if( file->readAt( buf, bufsiz, pos, nin ))
+        throw new PlatformException( "read failed", sys::getLastError(), __FILE__, __LINE__, __FUNCTION__ );
+    if( nin != bufsiz )
+        throw new Exception( "not enough bytes, reached end-of-file", __FILE__, __LINE__, __FUNCTION__ );
+}
+
+// mapping of a region of the main file, NULL if not supported
+FileMapping* MP4File::MapBytes( uint64_t pos, uint64_t size )
+{
+    if( m_memoryBuffer || !m_file )
+        return NULL;
+
+    return m_file->map( pos, size );
+}
+
+bool MP4File::IsLazyRead()
+{
+    return (m_readFlags & MP4_READ_LAZY_TABLES) && !m_memoryBuffer &&
+           m_file && m_file->mode == File::MODE_READ;
+}
+
 void MP4File::PeekBytes( uint8_t* buf, uint32_t bufsiz, File* file )
 {
     const uint64_t pos = GetPosition( file );
@@ -145,6 +145,30 @@ void MP4IntegerProperty::IncrementValue(int32_t increment, uint32_t index)
     SetValue(GetValue() + increment);
 }
 
+void MP4IntegerProperty::SetLazy(MP4TableProperty* pTable, uint32_t column, uint32_t count)
+{
+    m_pLazyTable = pTable;
+    m_lazyColumn = column;
+    m_lazyCount = count;
+    m_lazySize = GetStorageSize();
+}
+
+uint64_t MP4IntegerProperty::GetLazyValue(uint32_t index)
+{
+    if (index >= m_lazyCount) {
+        ostringstream msg;
+        msg << "illegal array index: " << index << " of " << m_lazyCount;
+        throw new PlatformException(msg.str().c_str(), ERANGE, __FILE__, __LINE__, __FUNCTION__ );
+    }
+
+    const uint8_t* p = m_pLazyTable->GetLazyEntry(index) + m_lazyColumn;
+    uint64_t value = 0;
+    for (uint8_t i = 0; i < m_lazySize; i++) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
 void MP4Integer8Property::Dump(uint8_t indent,
                                bool dumpImplicits, uint32_t index)
 {
@@ -154,11 +178,11 @@ void MP4Integer8Property::Dump(uint8_t indent,
     if (index != 0)
         log.dump(indent, MP4_LOG_VERBOSE1, "\"%s\": %s[%u] = %u (0x%02x)",
                  m_parentAtom.GetFile().GetFilename().c_str(),
-                 m_name, index, m_values[index], m_values[index]);
+                 m_name, index, GetValue(index), GetValue(index));
     else
         log.dump(indent, MP4_LOG_VERBOSE1, "\"%s\": %s = %u (0x%02x)",
                  m_parentAtom.GetFile().GetFilename().c_str(),
-                 m_name, m_values[index], m_values[index]);
+                 m_name, GetValue(index), GetValue(index));
 }
 
 void MP4Integer16Property::Dump(uint8_t indent,
@@ -170,11 +194,11 @@ void MP4Integer16Property::Dump(uint8_t indent,
     if (index != 0)
         log.dump(indent, MP4_LOG_VERBOSE1, "\"%s\": %s[%u] = %u (0x%04x)",
                  m_parentAtom.GetFile().GetFilename().c_str(),
-                 m_name, index, m_values[index], m_values[index]);
+                 m_name, index, GetValue(index), GetValue(index));
     else
         log.dump(indent, MP4_LOG_VERBOSE1, "\"%s\": %s = %u (0x%04x)",
                  m_parentAtom.GetFile().GetFilename().c_str(),
-                 m_name, m_values[index], m_values[index]);
+                 m_name, GetValue(index), GetValue(index));
 }
 
 void MP4Integer24Property::Dump(uint8_t indent,
@@ -186,11 +210,11 @@ void MP4Integer24Property::Dump(uint8_t indent,
     if (index != 0)
         log.dump(indent, MP4_LOG_VERBOSE1, "\"%s\": %s[%u] = %u (0x%06x)",
                  m_parentAtom.GetFile().GetFilename().c_str(),
-                 m_name, index, m_values[index], m_values[index]);
+                 m_name, index, GetValue(index), GetValue(index));
     else
         log.dump(indent, MP4_LOG_VERBOSE1, "\"%s\": %s = %u (0x%06x)",
                  m_parentAtom.GetFile().GetFilename().c_str(),
-                 m_name, m_values[index], m_values[index]);
+                 m_name, GetValue(index), GetValue(index));
 }
 
 void MP4Integer32Property::Dump(uint8_t indent,
@@ -202,11 +226,11 @@ void MP4Integer32Property::Dump(uint8_t indent,
     if (index != 0)
         log.dump(indent, MP4_LOG_VERBOSE1, "\"%s\": %s[%u] = %u (0x%08x)",
                  m_parentAtom.GetFile().GetFilename().c_str(),
-                 m_name, index, m_values[index], m_values[index]);
+                 m_name, index, GetValue(index), GetValue(index));
     else
         log.dump(indent, MP4_LOG_VERBOSE1, "\"%s\": %s = %u (0x%08x)",
                  m_parentAtom.GetFile().GetFilename().c_str(),
-                 m_name, m_values[index], m_values[index]);
+                 m_name, GetValue(index), GetValue(index));
 }
 
 void MP4Integer64Property::Dump(uint8_t indent,
@@ -218,11 +242,11 @@ void MP4Integer64Property::Dump(uint8_t indent,
     if (index != 0)
         log.dump(indent, MP4_LOG_VERBOSE1, "\"%s\": %s[%u] = %" PRIu64 " (0x%016" PRIx64 ")",
                  m_parentAtom.GetFile().GetFilename().c_str(),
-                 m_name, index, m_values[index], m_values[index]);
+                 m_name, index, GetValue(index), GetValue(index));
     else
         log.dump(indent, MP4_LOG_VERBOSE1, "\"%s\": %s = %" PRIu64 " (0x%016" PRIx64 ")",
                  m_parentAtom.GetFile().GetFilename().c_str(),
-                 m_name, m_values[index], m_values[index]);
+                 m_name, GetValue(index), GetValue(index));
 }
 
 // MP4BitfieldProperty
@@ -671,6 +695,12 @@ void MP4BytesProperty::Dump(uint8_t indent,
 
 MP4TableProperty::MP4TableProperty(MP4Atom& parentAtom, const char* name, MP4IntegerProperty* pCountProperty)
         : MP4Property(parentAtom, name)
+        , m_lazyPosition(0)
+        , m_lazyStride(0)
+        , m_lazyCount(0)
+        , m_lazyData(NULL)
+        , m_lazyMapping(NULL)
+        , m_lazyBuffer(NULL)
 {
     m_pCountProperty = pCountProperty;
     m_pCountProperty->SetReadOnly();
@@ -681,6 +711,8 @@ MP4TableProperty::~MP4TableProperty()
     for (uint32_t i = 0; i < m_pProperties.Size(); i++) {
         delete m_pProperties[i];
     }
+    delete m_lazyMapping;
+    MP4Free(m_lazyBuffer);
 }
 
 void MP4TableProperty::AddProperty(MP4Property* pProperty)
@@ -761,6 +793,10 @@ void MP4TableProperty::Read(MP4File& file, uint32_t index)
 
     uint32_t numEntries = GetCount();
 
+    if (ReadLazily(file, numEntries)) {
+        return;
+    }
+
     /* for each property set size */
     for (uint32_t j = 0; j < numProperties; j++) {
         m_pProperties[j]->SetCount(numEntries);
@@ -771,6 +807,89 @@ void MP4TableProperty::Read(MP4File& file, uint32_t index)
     }
 }
 
+// Big sample tables (stsz, stco, co64, stts, ctts, stss) of long movies
+// hold millions of entries. In lazy mode such tables of plain integer
+// columns are only located here and mapped or read in on first access.
+// Tables with custom entry encodings have non-integer columns.
+bool MP4TableProperty::ReadLazily(MP4File& file, uint32_t numEntries)
+{
+    static const uint64_t minLazySize = 16 * 1024;
+
+    if (!file.IsLazyRead()) {
+        return false;
+    }
+
+    uint32_t stride = 0;
+    for (uint32_t j = 0; j < m_pProperties.Size(); j++) {
+        MP4Property* pProperty = m_pProperties[j];
+        switch (pProperty->GetType()) {
+        case Integer8Property:
+        case Integer16Property:
+        case Integer24Property:
+        case Integer32Property:
+        case Integer64Property:
+            break;
+        default:
+            return false;
+        }
+        uint8_t size = ((MP4IntegerProperty*)pProperty)->GetStorageSize();
+        if (size == 0 || pProperty->IsImplicit()) {
+            return false;
+        }
+        stride += size;
+    }
+
+    uint64_t position = file.GetPosition();
+    uint64_t tableSize = (uint64_t)numEntries * stride;
+    if (tableSize < minLazySize || tableSize > 0xFFFFFFFF ||
+        position + tableSize > file.GetSize()) {
+        return false;
+    }
+
+    uint32_t column = 0;
+    for (uint32_t j = 0; j < m_pProperties.Size(); j++) {
+        MP4IntegerProperty* pProperty = (MP4IntegerProperty*)m_pProperties[j];
+        pProperty->SetCount(0);
+        pProperty->SetLazy(this, column, numEntries);
+        column += pProperty->GetStorageSize();
+    }
+
+    m_lazyPosition = position;
+    m_lazyStride = stride;
+    m_lazyCount = numEntries;
+    file.SetPosition(position + tableSize);
+
+    log.verbose2f("\"%s\": %s.%s: %u entries read lazily",
+                  m_parentAtom.GetFile().GetFilename().c_str(),
+                  m_parentAtom.GetType(), GetName(), numEntries);
+    return true;
+}
+
+const uint8_t* MP4TableProperty::GetLazyEntry(uint32_t index)
+{
+    if (!m_lazyData) {
+        MP4File& file = m_parentAtom.GetFile();
+        uint64_t tableSize = (uint64_t)m_lazyCount * m_lazyStride;
+
+        m_lazyMapping = file.MapBytes(m_lazyPosition, tableSize);
+        if (m_lazyMapping) {
+            m_lazyData = m_lazyMapping->data;
+        } else {
+            uint8_t* pBuffer = (uint8_t*)MP4Malloc(tableSize);
+            try {
+                file.ReadBytesAt(pBuffer, (uint32_t)tableSize, m_lazyPosition);
+            }
+            catch (Exception* x) {
+                MP4Free(pBuffer);
+                throw x;
+            }
+            m_lazyBuffer = pBuffer;
+            m_lazyData = m_lazyBuffer;
+        }
+    }
+    return m_lazyData + (size_t)index * m_lazyStride;
+}
+
 void MP4TableProperty::ReadEntry(MP4File& file, uint32_t index)
 {
     for (uint32_t j = 0; j < m_pProperties.Size(); j++) {
@@ -106,10 +106,13 @@ private:
 
 MP4ARRAY_DECL(MP4Property, MP4Property*);
 
+class MP4TableProperty;
+
 class MP4IntegerProperty : public MP4Property {
 protected:
     MP4IntegerProperty(MP4Atom& parentAtom, const char* name)
-            : MP4Property(parentAtom, name) { };
+            : MP4Property(parentAtom, name),
+              m_pLazyTable(NULL), m_lazyColumn(0), m_lazyCount(0), m_lazySize(0) { };
 
 public:
     uint64_t GetValue(uint32_t index = 0);
@@ -122,6 +125,21 @@ public:
 
     void IncrementValue(int32_t increment = 1, uint32_t index = 0);
 
+    // size in bytes of a stored value, 0 if not byte aligned
+    virtual uint8_t GetStorageSize() { return 0; }
+
+    // values are decoded on demand from a lazily read table column,
+    // until the first modification copies them in
+    void SetLazy(MP4TableProperty* pTable, uint32_t column, uint32_t count);
+
+protected:
+    uint64_t GetLazyValue(uint32_t index);
+
+    MP4TableProperty* m_pLazyTable;
+    uint32_t          m_lazyColumn;     // byte offset within a table entry
+    uint32_t          m_lazyCount;
+    uint8_t           m_lazySize;
+
 private:
     MP4IntegerProperty();
     MP4IntegerProperty ( const MP4IntegerProperty &src );
@@ -141,14 +159,22 @@ private:
             return Integer##xsize##Property; \
         } \
         \
+        uint8_t GetStorageSize() { \
+            return xsize / 8; \
+        } \
+        \
         uint32_t GetCount() { \
-            return m_values.Size(); \
+            return m_pLazyTable ? m_lazyCount : m_values.Size(); \
         } \
         void SetCount(uint32_t count) { \
+            Materialize(); \
             m_values.Resize(count); \
         } \
         \
         uint##isize##_t GetValue(uint32_t index = 0) { \
+            if (m_pLazyTable) { \
+                return (uint##isize##_t)GetLazyValue(index); \
+            } \
             return m_values[index]; \
         } \
         \
@@ -158,18 +184,23 @@ private:
                 msg << "property is read-only: " << m_name; \
                 throw new PlatformException(msg.str().c_str(), EACCES, __FILE__, __LINE__, __FUNCTION__); \
             } \
+            Materialize(); \
             m_values[index] = value; \
         } \
         void AddValue(uint##isize##_t value) { \
+            Materialize(); \
             m_values.Add(value); \
         } \
         void InsertValue(uint##isize##_t value, uint32_t index) { \
+            Materialize(); \
             m_values.Insert(value, index); \
         } \
         void DeleteValue(uint32_t index) { \
+            Materialize(); \
             m_values.Delete(index); \
         } \
         void IncrementValue(int32_t increment = 1, uint32_t index = 0) { \
+            Materialize(); \
             m_values[index] += increment; \
         } \
         void Read(MP4File& file, uint32_t index = 0) { \
@@ -183,12 +214,23 @@ private:
             if (m_implicit) { \
                 return; \
             } \
-            file.WriteUInt##xsize(m_values[index]); \
+            file.WriteUInt##xsize(GetValue(index)); \
         } \
         void Dump(uint8_t indent, \
             bool dumpImplicits, uint32_t index = 0); \
     \
     protected: \
+        void Materialize() { \
+            if (!m_pLazyTable) { \
+                return; \
+            } \
+            m_values.Resize(m_lazyCount); \
+            for (uint32_t i = 0; i < m_lazyCount; i++) { \
+                m_values[i] = (uint##isize##_t)GetLazyValue(i); \
+            } \
+            m_pLazyTable = NULL; \
+        } \
+        \
         MP4Integer##isize##Array m_values; \
     private: \
         MP4Integer##xsize##Property(); \
@@ -217,6 +259,10 @@ public:
     uint8_t GetNumBits() {
         return m_numBits;
     }
+
+    uint8_t GetStorageSize() {
+        return 0;
+    }
     void SetNumBits(uint8_t numBits) {
         m_numBits = numBits;
     }
@@ -501,10 +547,15 @@ public:
     bool FindProperty(const char* name,
                       MP4Property** ppProperty, uint32_t* pIndex = NULL);
 
+    // raw big-endian entry of a lazily read table, loaded on first use
+    const uint8_t* GetLazyEntry(uint32_t index);
+
 protected:
     virtual void ReadEntry(MP4File& file, uint32_t index);
     virtual void WriteEntry(MP4File& file, uint32_t index);
 
+    bool ReadLazily(MP4File& file, uint32_t numEntries);
+
     bool FindContainedProperty(const char* name,
                                MP4Property** ppProperty, uint32_t* pIndex);
 
@@ -512,6 +563,14 @@ protected:
     MP4IntegerProperty* m_pCountProperty;
     MP4PropertyArray    m_pProperties;
 
+    // lazily read table: entries stay in the file until first accessed
+    uint64_t            m_lazyPosition;
+    uint32_t            m_lazyStride;
+    uint32_t            m_lazyCount;
+    const uint8_t*      m_lazyData;
+    FileMapping*        m_lazyMapping;
+    uint8_t*            m_lazyBuffer;
+
 private:
     MP4TableProperty();
     MP4TableProperty ( const MP4TableProperty &src );
@@ -67,6 +67,13 @@ MP4Track::MP4Track(MP4File& file, MP4Atom& trakAtom)
     m_cachedSttsSid = MP4_INVALID_SAMPLE_ID;
     m_cachedCttsSid = MP4_INVALID_SAMPLE_ID;
 
+    m_sampleIndexEnabled = true;
+    m_sampleIndexBuilt = false;
+    m_lastIndexedSampleId = MP4_INVALID_SAMPLE_ID;
+
+    m_fragmentDecodeTime = 0;
+    m_numFragmentSamples = 0;
+
     bool success = true;
 
     MP4Integer32Property* pTrackIdProperty;
@@ -283,7 +290,7 @@ void MP4Track::ReadSample(
         *hasDependencyFlags = !m_sdtpLog.empty();
 
     if( dependencyFlags ) {
-        if( m_sdtpLog.empty() ) {
+        if( m_sdtpLog.empty() || IsFragmentSample( sampleId )) {
             *dependencyFlags = 0;
         }
         else {
@@ -295,7 +302,8 @@ void MP4Track::ReadSample(
 
     // handle unusual case of wanting to read a sample
     // that is still sitting in the write chunk buffer
-    if (m_pChunkBuffer && sampleId >= m_writeSampleId - m_chunkSamples) {
+    if (m_pChunkBuffer && !m_File.IsFragmentedWrite() &&
+            sampleId >= m_writeSampleId - m_chunkSamples) {
         WriteChunkBuffer();
     }
 
@@ -363,6 +371,134 @@ void MP4Track::ReadSample(
         m_File.SetPosition( oldPos, fin );
 }
 
+void MP4Track::ReadSampleTo(
+    MP4SampleId   sampleId,
+    uint8_t*      pBytes,
+    uint32_t      numBytes,
+    uint32_t*     pSampleSize,
+    MP4Timestamp* pStartTime,
+    MP4Duration*  pDuration,
+    MP4Duration*  pRenderingOffset,
+    bool*         pIsSyncSample )
+{
+    if( sampleId == MP4_INVALID_SAMPLE_ID )
+        throw new Exception( "sample id can't be zero", __FILE__, __LINE__, __FUNCTION__ );
+
+    if( m_File.IsWriteMode() )
+        throw new Exception( "operation not permitted in write mode", __FILE__, __LINE__, __FUNCTION__ );
+
+    File* fin;
+    uint64_t fileOffset;
+    uint32_t sampleSize;
+    {
+        lock_guard<mutex> lock( m_readToLock );
+
+        // lookups below use the index when available, which is read-only
+        UseSampleIndex( MP4_INVALID_SAMPLE_ID );
+
+        fin = GetSampleFile( sampleId );
+        if( fin == (File*)-1 )
+            throw new Exception( "sample is located in an inaccessible file", __FILE__, __LINE__, __FUNCTION__ );
+
+        fileOffset = GetSampleFileOffset( sampleId );
+        sampleSize = GetSampleSize( sampleId );
+        if( numBytes < sampleSize )
+            throw new Exception( "sample buffer is too small", __FILE__, __LINE__, __FUNCTION__ );
+
+        if( pStartTime || pDuration )
+            GetSampleTimes( sampleId, pStartTime, pDuration );
+        if( pRenderingOffset )
+            *pRenderingOffset = GetSampleRenderingOffset( sampleId );
+        if( pIsSyncSample )
+            *pIsSyncSample = IsSyncSample( sampleId );
+
+        // external data references are opened and closed by the lookups
+        if( fin )
+            m_File.ReadBytesAt( pBytes, sampleSize, fileOffset, fin );
+    }
+
+    if( !fin )
+        m_File.ReadBytesAt( pBytes, sampleSize, fileOffset );
+
+    *pSampleSize = sampleSize;
+}
+
+uint32_t MP4Track::ReadSamplesTo(
+    MP4SampleId firstSampleId,
+    uint32_t    numSamples,
+    uint8_t*    pBytes,
+    uint32_t    numBytes,
+    uint32_t*   pSampleSizes )
+{
+    if( firstSampleId == MP4_INVALID_SAMPLE_ID )
+        throw new Exception( "sample id can't be zero", __FILE__, __LINE__, __FUNCTION__ );
+
+    if( m_File.IsWriteMode() )
+        throw new Exception( "operation not permitted in write mode", __FILE__, __LINE__, __FUNCTION__ );
+
+    // samples which follow each other in the same file are fetched together,
+    // which is one read per chunk for interleaved files
+    struct Run {
+        File*    file;
+        uint64_t offset;
+        uint32_t size;
+    };
+    vector<Run> runs;
+    bool external = false;
+    uint32_t numRead = 0;
+
+    unique_lock<mutex> lock( m_readToLock );
+
+    UseSampleIndex( MP4_INVALID_SAMPLE_ID );
+
+    if( firstSampleId > GetNumberOfSamples() )
+        throw new Exception( "sample id out of range", __FILE__, __LINE__, __FUNCTION__ );
+    numSamples = min( numSamples, GetNumberOfSamples() - firstSampleId + 1 );
+
+    uint32_t used = 0;
+    for( ; numRead < numSamples; numRead++ ) {
+        MP4SampleId sampleId = firstSampleId + numRead;
+
+        File* fin = GetSampleFile( sampleId );
+        if( fin == (File*)-1 )
+            throw new Exception( "sample is located in an inaccessible file", __FILE__, __LINE__, __FUNCTION__ );
+
+        uint64_t fileOffset = GetSampleFileOffset( sampleId );
+        uint32_t sampleSize = GetSampleSize( sampleId );
+        if( sampleSize > numBytes - used )
+            break;
+
+        if( !runs.empty() && runs.back().file == fin &&
+            runs.back().offset + runs.back().size == fileOffset )
+        {
+            runs.back().size += sampleSize;
+        }
+        else {
+            Run run = { fin, fileOffset, sampleSize };
+            runs.push_back( run );
+        }
+        external |= (fin != NULL);
+
+        pSampleSizes[numRead] = sampleSize;
+        used += sampleSize;
+    }
+
+    if( numRead == 0 && numSamples )
+        throw new Exception( "sample buffer is too small", __FILE__, __LINE__, __FUNCTION__ );
+
+    // external data references are opened and closed by the lookups
+    if( !external )
+        lock.unlock();
+
+    uint8_t* pDest = pBytes;
+    for( size_t i = 0; i < runs.size(); i++ ) {
+        m_File.ReadBytesAt( pDest, runs[i].size, runs[i].offset, runs[i].file );
+        pDest += runs[i].size;
+    }
+
+    return numRead;
+}
+
 void MP4Track::ReadSampleFragment(
     MP4SampleId sampleId,
     uint32_t sampleOffset,
@@ -435,6 +571,14 @@ void MP4Track::WriteSample(
     log.verbose3f("\"%s\": duration %" PRIu64, GetFile().GetFilename().c_str(), 
                   duration);
 
+    if (m_File.IsFragmentedWrite()) {
+        // sample_depends_on = 2 for sync samples, else 1 plus the
+        // sample_is_non_sync_sample bit
+        WriteFragmentSample(pBytes, numBytes, duration, renderingOffset,
+                            isSyncSample ? 0x02000000 : 0x01010000);
+        return;
+    }
+
     if ((m_isAmr == AMR_TRUE) &&
             (m_curMode != curMode)) {
         WriteChunkBuffer();
@@ -483,10 +627,146 @@ void MP4Track::WriteSampleDependency(
     bool           isSyncSample,
     uint32_t       dependencyFlags )
 {
+    if( m_File.IsFragmentedWrite() ) {
+        // the sdtp flags have the same layout as bits 20-27 of the trun
+        // sample flags
+        if( pBytes == NULL && numBytes > 0 )
+            throw new Exception( "no sample data", __FILE__, __LINE__, __FUNCTION__ );
+        if( duration == MP4_INVALID_DURATION )
+            duration = GetFixedSampleDuration();
+        WriteFragmentSample( pBytes, numBytes, duration, renderingOffset,
+                             ((dependencyFlags & 0xff) << 20) | (isSyncSample ? 0 : 0x00010000) );
+        return;
+    }
+
     m_sdtpLog.push_back( dependencyFlags ); // record dependency flags for processing at finish
     WriteSample( pBytes, numBytes, duration, renderingOffset, isSyncSample );
 }
 
+void MP4Track::WriteFragmentSample(
+    const uint8_t* pBytes,
+    uint32_t       numBytes,
+    MP4Duration    duration,
+    MP4Duration    renderingOffset,
+    uint32_t       sampleFlags )
+{
+    // append sample bytes to the pending fragment
+    if( m_sizeOfDataInChunkBuffer + numBytes > m_chunkBufferSize ) {
+        m_pChunkBuffer = (uint8_t*)MP4Realloc(m_pChunkBuffer, m_chunkBufferSize + numBytes);
+        if (m_pChunkBuffer == NULL)
+            return;
+
+        m_chunkBufferSize += numBytes;
+    }
+
+    memcpy(&m_pChunkBuffer[m_sizeOfDataInChunkBuffer], pBytes, numBytes);
+    m_sizeOfDataInChunkBuffer += numBytes;
+    m_chunkSamples++;
+    m_chunkDuration += duration;
+
+    FragmentSampleEntry entry = {
+        numBytes, (uint32_t)duration, sampleFlags, (uint32_t)renderingOffset };
+    m_fragmentSamples.push_back(entry);
+
+    UpdateDurations(duration);
+
+    UpdateModificationTimes();
+
+    m_writeSampleId++;
+}
+
+// adds a traf describing the pending samples to moofAtom, the data offset
+// of its trun is left to the caller which knows the size of the moof
+MP4Atom* MP4Track::AddFragmentAtom(MP4Atom& moofAtom)
+{
+    if (m_fragmentSamples.empty()) {
+        return NULL;
+    }
+
+    MP4Atom* pTrafAtom = MP4Atom::CreateAtom(m_File, &moofAtom, "traf");
+    moofAtom.AddChildAtom(pTrafAtom);
+    pTrafAtom->Generate();
+
+    // default-base-is-moof, everything else is given per sample
+    MP4Atom* pTfhdAtom = pTrafAtom->FindChildAtom("tfhd");
+    ASSERT(pTfhdAtom);
+    pTfhdAtom->SetFlags(0x020000);
+
+    MP4Integer32Property* pTrackIdProperty = NULL;
+    ASSERT(pTfhdAtom->FindProperty("tfhd.trackId",
+                                   (MP4Property**)&pTrackIdProperty));
+    pTrackIdProperty->SetValue(m_trackId);
+
+    MP4Atom* pTfdtAtom = MP4Atom::CreateAtom(m_File, pTrafAtom, "tfdt");
+    pTrafAtom->AddChildAtom(pTfdtAtom);
+    pTfdtAtom->Generate();
+
+    MP4Integer64Property* pDecodeTimeProperty = NULL;
+    ASSERT(pTfdtAtom->FindProperty("tfdt.baseMediaDecodeTime",
+                                   (MP4Property**)&pDecodeTimeProperty));
+    pDecodeTimeProperty->SetValue(m_fragmentDecodeTime);
+
+    uint32_t trunFlags = 0x001 | 0x100 | 0x200 | 0x400;
+    for (size_t i = 0; i < m_fragmentSamples.size(); i++) {
+        if (m_fragmentSamples[i].renderingOffset) {
+            trunFlags |= 0x800;
+            break;
+        }
+    }
+
+    MP4Atom* pTrunAtom = MP4Atom::CreateAtom(m_File, pTrafAtom, "trun");
+    pTrafAtom->AddChildAtom(pTrunAtom);
+    pTrunAtom->SetFlags(trunFlags);
+    pTrunAtom->Generate();
+
+    MP4Integer32Property* pCountProperty = NULL;
+    MP4Integer32Property* pDurationProperty = NULL;
+    MP4Integer32Property* pSizeProperty = NULL;
+    MP4Integer32Property* pFlagsProperty = NULL;
+    MP4Integer32Property* pRenderingOffsetProperty = NULL;
+    ASSERT(pTrunAtom->FindProperty("trun.sampleCount",
+                                   (MP4Property**)&pCountProperty));
+    ASSERT(pTrunAtom->FindProperty("trun.samples.sampleDuration",
+                                   (MP4Property**)&pDurationProperty));
+    ASSERT(pTrunAtom->FindProperty("trun.samples.sampleSize",
+                                   (MP4Property**)&pSizeProperty));
+    ASSERT(pTrunAtom->FindProperty("trun.samples.sampleFlags",
+                                   (MP4Property**)&pFlagsProperty));
+    if (trunFlags & 0x800) {
+        ASSERT(pTrunAtom->FindProperty("trun.samples.sampleCompositionTimeOffset",
+                                       (MP4Property**)&pRenderingOffsetProperty));
+    }
+
+    for (size_t i = 0; i < m_fragmentSamples.size(); i++) {
+        const FragmentSampleEntry& entry = m_fragmentSamples[i];
+        pDurationProperty->AddValue(entry.duration);
+        pSizeProperty->AddValue(entry.size);
+        pFlagsProperty->AddValue(entry.flags);
+        if (pRenderingOffsetProperty) {
+            pRenderingOffsetProperty->AddValue(entry.renderingOffset);
+        }
+    }
+    pCountProperty->IncrementValue((int32_t)m_fragmentSamples.size());
+
+    return pTrafAtom;
+}
+
+void MP4Track::WriteFragmentData()
+{
+    m_File.WriteBytes(m_pChunkBuffer, m_sizeOfDataInChunkBuffer);
+
+    log.verbose3f("\"%s\": WriteFragmentData: track %u wrote %u bytes (%u samples)",
+                  GetFile().GetFilename().c_str(), m_trackId,
+                  m_sizeOfDataInChunkBuffer, m_chunkSamples);
+
+    m_fragmentDecodeTime += m_chunkDuration;
+    m_fragmentSamples.clear();
+
+    m_sizeOfDataInChunkBuffer = 0;
+    m_chunkSamples = 0;
+    m_chunkDuration = 0;
+}
+
 void MP4Track::WriteChunkBuffer()
 {
     if (m_sizeOfDataInChunkBuffer == 0) {
@@ -621,13 +901,26 @@ bool MP4Track::IsChunkFull(MP4SampleId sampleId)
     return m_chunkDuration >= m_durationPerChunk;
 }
 
+bool MP4Track::IsFragmentSample(MP4SampleId sampleId)
+{
+    return sampleId > m_pStszSampleCountProperty->GetValue();
+}
+
 uint32_t MP4Track::GetNumberOfSamples()
 {
-    return m_pStszSampleCountProperty->GetValue();
+    return m_pStszSampleCountProperty->GetValue() + m_numFragmentSamples;
 }
 
 uint32_t MP4Track::GetSampleSize(MP4SampleId sampleId)
 {
+    if (IsFragmentSample(sampleId)) {
+        if (sampleId > m_sampleIndex.size()) {
+            throw new Exception("sample id out of range",
+                                __FILE__, __LINE__, __FUNCTION__ );
+        }
+        return m_sampleIndex[sampleId - 1].size;
+    }
+
     if (m_pStszFixedSampleSizeProperty != NULL) {
         uint32_t fixedSampleSize =
             m_pStszFixedSampleSizeProperty->GetValue();
@@ -650,12 +943,21 @@ uint32_t MP4Track::GetSampleSize(MP4SampleId sampleId)
 
 uint32_t MP4Track::GetMaxSampleSize()
 {
+    // samples of movie fragments are only found in the index
+    uint32_t maxFragmentSampleSize = 0;
+    for (size_t i = m_sampleIndex.size() - m_numFragmentSamples;
+            i < m_sampleIndex.size(); i++) {
+        if (m_sampleIndex[i].size > maxFragmentSampleSize) {
+            maxFragmentSampleSize = m_sampleIndex[i].size;
+        }
+    }
+
     if (m_pStszFixedSampleSizeProperty != NULL) {
         uint32_t fixedSampleSize =
             m_pStszFixedSampleSizeProperty->GetValue();
 
         if (fixedSampleSize != 0) {
-            return fixedSampleSize * m_bytesPerSample;
+            return max(fixedSampleSize * m_bytesPerSample, maxFragmentSampleSize);
         }
     }
 
@@ -668,11 +970,18 @@ uint32_t MP4Track::GetMaxSampleSize()
             maxSampleSize = sampleSize;
         }
     }
-    return maxSampleSize * m_bytesPerSample;
+    return max(maxSampleSize * m_bytesPerSample, maxFragmentSampleSize);
 }
 
 uint64_t MP4Track::GetTotalOfSampleSizes()
 {
+    // samples of movie fragments are only found in the index
+    uint64_t totalFragmentSampleSizes = 0;
+    for (size_t i = m_sampleIndex.size() - m_numFragmentSamples;
+            i < m_sampleIndex.size(); i++) {
+        totalFragmentSampleSizes += m_sampleIndex[i].size;
+    }
+
     uint64_t retval;
     if (m_pStszFixedSampleSizeProperty != NULL) {
         uint32_t fixedSampleSize =
@@ -682,8 +991,8 @@ uint64_t MP4Track::GetTotalOfSampleSizes()
         if (fixedSampleSize != 0) {
             retval = m_bytesPerSample;
             retval *= fixedSampleSize;
-            retval *= GetNumberOfSamples();
-            return retval;
+            retval *= m_pStszSampleCountProperty->GetValue();
+            return retval + totalFragmentSampleSizes;
         }
     }
 
@@ -695,7 +1004,7 @@ uint64_t MP4Track::GetTotalOfSampleSizes()
             m_pStszSampleSizeProperty->GetValue(sid - 1);
         totalSampleSizes += sampleSize;
     }
-    return totalSampleSizes * m_bytesPerSample;
+    return totalSampleSizes * m_bytesPerSample + totalFragmentSampleSizes;
 }
 
 void MP4Track::SampleSizePropertyAddValue (uint32_t size)
@@ -867,23 +1176,29 @@ uint32_t MP4Track::GetSampleStscIndex(MP4SampleId sampleId)
         throw new Exception("No data chunks exist", __FILE__, __LINE__, __FUNCTION__ );
     }
 
-    for (stscIndex = 0; stscIndex < numStscs; stscIndex++) {
+    // first sample ids are increasing: find the last entry whose first
+    // sample is not after sampleId
+    uint32_t stscLIndex = 0;
+    uint32_t stscRIndex = numStscs;
+    while (stscLIndex < stscRIndex) {
+        stscIndex = (stscLIndex + stscRIndex) >> 1;
         if (sampleId < m_pStscFirstSampleProperty->GetValue(stscIndex)) {
-            ASSERT(stscIndex != 0);
-            stscIndex -= 1;
-            break;
+            stscRIndex = stscIndex;
+        } else {
+            stscLIndex = stscIndex + 1;
         }
     }
-    if (stscIndex == numStscs) {
-        ASSERT(stscIndex != 0);
-        stscIndex -= 1;
-    }
+    ASSERT(stscLIndex != 0);
 
-    return stscIndex;
+    return stscLIndex - 1;
 }
 
 File* MP4Track::GetSampleFile( MP4SampleId sampleId )
 {
+    // fragments are always in the file itself
+    if( IsFragmentSample( sampleId ))
+        return NULL;
+
     uint32_t stscIndex = GetSampleStscIndex( sampleId );
     uint32_t stsdIndex = m_pStscSampleDescrIndexProperty->GetValue( stscIndex );
 
@@ -961,6 +1276,14 @@ File* MP4Track::GetSampleFile( MP4SampleId sampleId )
 
 uint64_t MP4Track::GetSampleFileOffset(MP4SampleId sampleId)
 {
+    if (UseSampleIndex(sampleId)) {
+        if (sampleId == MP4_INVALID_SAMPLE_ID || sampleId > m_sampleIndex.size()) {
+            throw new Exception("sample id out of range",
+                                __FILE__, __LINE__, __FUNCTION__ );
+        }
+        return m_sampleIndex[sampleId - 1].offset;
+    }
+
     uint32_t stscIndex =
         GetSampleStscIndex(sampleId);
 
@@ -1056,6 +1379,23 @@ void MP4Track::SetFixedSampleDuration(MP4Duration duration)
 void MP4Track::GetSampleTimes(MP4SampleId sampleId,
                               MP4Timestamp* pStartTime, MP4Duration* pDuration)
 {
+    if (m_sampleIndexBuilt) {
+        if (sampleId == MP4_INVALID_SAMPLE_ID || sampleId > m_sampleIndex.size()) {
+            throw new Exception("sample id out of range",
+                                __FILE__, __LINE__, __FUNCTION__ );
+        }
+        MP4Timestamp startTime = m_sampleIndex[sampleId - 1].time;
+        if (pStartTime) {
+            *pStartTime = startTime;
+        }
+        if (pDuration) {
+            *pDuration = (sampleId < m_sampleIndex.size()
+                          ? m_sampleIndex[sampleId].time
+                          : m_sttsIndex.back().elapsed) - startTime;
+        }
+        return;
+    }
+
     uint32_t numStts = m_pSttsCountProperty->GetValue();
     MP4SampleId sid;
     MP4Duration elapsed;
@@ -1104,6 +1444,34 @@ MP4SampleId MP4Track::GetSampleIdFromTime(
     MP4Timestamp when,
     bool wantSyncSample)
 {
+    if (UseSampleIndex(MP4_INVALID_SAMPLE_ID)) {
+        // find the first stts entry that ends at or after 'when'
+        uint32_t sttsLIndex = 0;
+        uint32_t sttsRIndex = (uint32_t)m_sttsIndex.size() - 1;
+        while (sttsLIndex < sttsRIndex) {
+            uint32_t sttsIndex = (sttsLIndex + sttsRIndex) >> 1;
+            if (m_sttsIndex[sttsIndex + 1].elapsed < when) {
+                sttsLIndex = sttsIndex + 1;
+            } else {
+                sttsRIndex = sttsIndex;
+            }
+        }
+        if (sttsLIndex == m_sttsIndex.size() - 1) {
+            throw new Exception("time out of range",
+                                __FILE__, __LINE__, __FUNCTION__);
+        }
+
+        const SttsIndexEntry& entry = m_sttsIndex[sttsLIndex];
+        MP4SampleId sampleId = entry.firstSample;
+        if (entry.sampleDelta) {
+            sampleId += (MP4SampleId)((when - entry.elapsed) / entry.sampleDelta);
+        }
+        if (wantSyncSample) {
+            return GetNextSyncSample(sampleId);
+        }
+        return sampleId;
+    }
+
     uint32_t numStts = m_pSttsCountProperty->GetValue();
     MP4SampleId sid = 1;
     MP4Duration elapsed = 0;
@@ -1198,6 +1566,12 @@ uint32_t MP4Track::GetSampleCttsIndex(MP4SampleId sampleId,
 
 MP4Duration MP4Track::GetSampleRenderingOffset(MP4SampleId sampleId)
 {
+    if (m_sampleIndexBuilt
+            && sampleId != MP4_INVALID_SAMPLE_ID
+            && sampleId <= m_sampleIndex.size()) {
+        return m_sampleIndex[sampleId - 1].renderingOffset;
+    }
+
     if (m_pCttsCountProperty == NULL) {
         return 0;
     }
@@ -1365,6 +1739,12 @@ void MP4Track::SetSampleRenderingOffset(MP4SampleId sampleId,
 
 bool MP4Track::IsSyncSample(MP4SampleId sampleId)
 {
+    if (m_sampleIndexBuilt
+            && sampleId != MP4_INVALID_SAMPLE_ID
+            && sampleId <= m_sampleIndex.size()) {
+        return m_sampleIndex[sampleId - 1].isSync;
+    }
+
     if (m_pStssCountProperty == NULL) {
         return true;
     }
@@ -1395,20 +1775,36 @@ bool MP4Track::IsSyncSample(MP4SampleId sampleId)
 // N.B. "next" is inclusive of this sample id
 MP4SampleId MP4Track::GetNextSyncSample(MP4SampleId sampleId)
 {
+    if (m_numFragmentSamples) {
+        // sync samples of movie fragments are only flagged in the index
+        for (MP4SampleId sid = max(sampleId, (MP4SampleId)1);
+                sid <= m_sampleIndex.size(); sid++) {
+            if (m_sampleIndex[sid - 1].isSync) {
+                return sid;
+            }
+        }
+        return MP4_INVALID_SAMPLE_ID;
+    }
+
     if (m_pStssCountProperty == NULL) {
         return sampleId;
     }
 
     uint32_t numStss = m_pStssCountProperty->GetValue();
 
-    for (uint32_t stssIndex = 0; stssIndex < numStss; stssIndex++) {
-        MP4SampleId syncSampleId =
-            m_pStssSampleProperty->GetValue(stssIndex);
-
-        if (sampleId > syncSampleId) {
-            continue;
+    // sync sample numbers are increasing: find the first one >= sampleId
+    uint32_t stssLIndex = 0;
+    uint32_t stssRIndex = numStss;
+    while (stssLIndex < stssRIndex) {
+        uint32_t stssIndex = (stssLIndex + stssRIndex) >> 1;
+        if (sampleId > m_pStssSampleProperty->GetValue(stssIndex)) {
+            stssLIndex = stssIndex + 1;
+        } else {
+            stssRIndex = stssIndex;
         }
-        return syncSampleId;
+    }
+    if (stssLIndex < numStss) {
+        return m_pStssSampleProperty->GetValue(stssLIndex);
     }
 
     // LATER check stsh for alternate sample
@@ -1416,6 +1812,202 @@ MP4SampleId MP4Track::GetNextSyncSample(MP4SampleId sampleId)
     return MP4_INVALID_SAMPLE_ID;
 }
 
+void MP4Track::SetSampleIndexing( bool enable )
+{
+    m_sampleIndexEnabled = enable;
+
+    // the samples of movie fragments are only known to the index
+    if( !enable && !m_numFragmentSamples )
+        ClearSampleIndex();
+}
+
+void MP4Track::ClearSampleIndex()
+{
+    m_sampleIndexBuilt = false;
+    m_lastIndexedSampleId = MP4_INVALID_SAMPLE_ID;
+    vector<SampleIndexEntry>().swap( m_sampleIndex );
+    vector<SttsIndexEntry>().swap( m_sttsIndex );
+}
+
+// Sequential reads are served well by the sample tables and their cached
+// positions. The flat index is built the first time a track is accessed
+// out of order (seek, scrub, time lookup) and used from then on.
+// sampleId is MP4_INVALID_SAMPLE_ID for time based lookups.
+bool MP4Track::UseSampleIndex( MP4SampleId sampleId )
+{
+    if( m_sampleIndexBuilt )
+        return true;
+
+    if( !m_sampleIndexEnabled || m_File.IsWriteMode() )
+        return false;
+
+    if( sampleId != MP4_INVALID_SAMPLE_ID &&
+        ( sampleId == m_lastIndexedSampleId ||
+          sampleId == m_lastIndexedSampleId + 1 ))
+    {
+        m_lastIndexedSampleId = sampleId;
+        return false;
+    }
+
+    if( !BuildSampleIndex() ) {
+        // keep walking the tables, which report their own errors
+        m_sampleIndexEnabled = false;
+        return false;
+    }
+    return true;
+}
+
+bool MP4Track::BuildSampleIndex()
+{
+    uint32_t numSamples = GetNumberOfSamples();
+    uint32_t numStscs   = m_pStscCountProperty->GetValue();
+    uint32_t numChunks  = m_pChunkCountProperty->GetValue();
+    uint32_t numStts    = m_pSttsCountProperty->GetValue();
+
+    vector<SampleIndexEntry> sampleIndex;
+    vector<SttsIndexEntry> sttsIndex;
+    try {
+        sampleIndex.resize( numSamples );
+        sttsIndex.reserve( numStts + 1 );
+    }
+    catch( std::bad_alloc& ) {
+        log.warningf("%s: \"%s\": not enough memory to index track %u",
+                     __FUNCTION__, GetFile().GetFilename().c_str(), m_trackId);
+        return false;
+    }
+
+    if( numSamples && numStscs == 0 )
+        return false;
+
+    // offsets and sizes, same arithmetic as GetSampleFileOffset()
+    uint32_t stscIndex = 0;
+    uint64_t offset = 0;
+    for( MP4SampleId sid = 1; sid <= numSamples; sid++ ) {
+        while( stscIndex + 1 < numStscs &&
+               sid >= m_pStscFirstSampleProperty->GetValue( stscIndex + 1 ))
+        {
+            stscIndex++;
+        }
+        MP4SampleId firstSample = m_pStscFirstSampleProperty->GetValue( stscIndex );
+        uint32_t samplesPerChunk = m_pStscSamplesPerChunkProperty->GetValue( stscIndex );
+        if( sid < firstSample || samplesPerChunk == 0 )
+            return false;
+
+        if( (sid - firstSample) % samplesPerChunk == 0 ) {
+            MP4ChunkId chunkId = m_pStscFirstChunkProperty->GetValue( stscIndex ) +
+                                 (sid - firstSample) / samplesPerChunk;
+            if( chunkId == 0 || chunkId > numChunks )
+                return false;
+            offset = m_pChunkOffsetProperty->GetValue( chunkId - 1 );
+        }
+
+        SampleIndexEntry& entry = sampleIndex[sid - 1];
+        entry.offset = offset;
+        entry.size = GetSampleSize( sid );
+        entry.renderingOffset = 0;
+        entry.isSync = (m_pStssCountProperty == NULL);
+        offset += entry.size;
+    }
+
+    // decoding times
+    MP4SampleId sid = 1;
+    MP4Timestamp elapsed = 0;
+    for( uint32_t i = 0; i < numStts; i++ ) {
+        uint32_t sampleCount = m_pSttsSampleCountProperty->GetValue( i );
+        uint32_t sampleDelta = m_pSttsSampleDeltaProperty->GetValue( i );
+
+        SttsIndexEntry entry = { sid, elapsed, sampleDelta };
+        sttsIndex.push_back( entry );
+
+        MP4Timestamp time = elapsed;
+        for( MP4SampleId s = sid; s < sid + sampleCount && s <= numSamples; s++ ) {
+            sampleIndex[s - 1].time = time;
+            time += sampleDelta;
+        }
+        sid += sampleCount;
+        elapsed += (MP4Timestamp)sampleCount * sampleDelta;
+    }
+    if( sid <= numSamples )
+        return false;
+    SttsIndexEntry end = { sid, elapsed, 0 };
+    sttsIndex.push_back( end );
+
+    // rendering offsets
+    if( m_pCttsCountProperty && m_pCttsCountProperty->GetValue() ) {
+        uint32_t numCtts = m_pCttsCountProperty->GetValue();
+        sid = 1;
+        for( uint32_t cttsIndex = 0; cttsIndex < numCtts && sid <= numSamples; cttsIndex++ ) {
+            uint32_t sampleCount = m_pCttsSampleCountProperty->GetValue( cttsIndex );
+            uint32_t sampleOffset = m_pCttsSampleOffsetProperty->GetValue( cttsIndex );
+            for( uint32_t i = 0; i < sampleCount && sid <= numSamples; i++, sid++ )
+                sampleIndex[sid - 1].renderingOffset = sampleOffset;
+        }
+        if( sid <= numSamples )
+            return false;
+    }
+
+    // sync samples
+    if( m_pStssCountProperty ) {
+        uint32_t numStss = m_pStssCountProperty->GetValue();
+        for( uint32_t stssIndex = 0; stssIndex < numStss; stssIndex++ ) {
+            MP4SampleId syncSampleId = m_pStssSampleProperty->GetValue( stssIndex );
+            if( syncSampleId != MP4_INVALID_SAMPLE_ID && syncSampleId <= numSamples )
+                sampleIndex[syncSampleId - 1].isSync = true;
+        }
+    }
+
+    m_sampleIndex.swap( sampleIndex );
+    m_sttsIndex.swap( sttsIndex );
+    m_sampleIndexBuilt = true;
+
+    log.verbose2f("\"%s\": indexed %u samples of track %u",
+                  GetFile().GetFilename().c_str(), numSamples, m_trackId);
+    return true;
+}
+
+// Decoding times continue from the previous sample; tfdt is only a hint
+// for players joining mid-stream and a gap in it is not represented.
+void MP4Track::AppendFragmentSample( uint64_t offset, uint32_t size,
+                                     uint32_t duration, uint32_t renderingOffset,
+                                     bool isSyncSample )
+{
+    std::lock_guard<std::mutex> lock( m_readToLock );
+
+    if( !m_sampleIndexBuilt && !BuildSampleIndex() ) {
+        throw new Exception( "can't index the samples of the movie fragments",
+                             __FILE__, __LINE__, __FUNCTION__ );
+    }
+
+    // the end of track entry becomes the decoding time of the new sample
+    SttsIndexEntry& end = m_sttsIndex.back();
+    SampleIndexEntry entry = { offset, end.elapsed, size, renderingOffset, isSyncSample };
+    m_sampleIndex.push_back( entry );
+
+    size_t numStts = m_sttsIndex.size();
+    if( numStts > 1 && m_sttsIndex[numStts - 2].sampleDelta == duration ) {
+        end.firstSample++;
+        end.elapsed += duration;
+    } else {
+        end.sampleDelta = duration;
+        SttsIndexEntry next = { end.firstSample + 1, end.elapsed + duration, 0 };
+        m_sttsIndex.push_back( next );
+    }
+
+    m_numFragmentSamples++;
+}
+
+void MP4Track::UpdateFragmentDurations()
+{
+    if( !m_sampleIndexBuilt )
+        return;
+
+    m_pMediaDurationProperty->SetValue( m_sttsIndex.back().elapsed );
+    m_pTrackDurationProperty->SetValue(
+        ToMovieDuration( m_pMediaDurationProperty->GetValue() ));
+
+    m_File.UpdateDuration( m_pTrackDurationProperty->GetValue() );
+}
+
 void MP4Track::UpdateSyncSamples(MP4SampleId sampleId, bool isSyncSample)
 {
     if (isSyncSample) {
@@ -82,6 +82,29 @@ public:
         bool*         hasDependencyFlags = NULL,
         uint32_t*     dependencyFlags = NULL );
 
+    // reentrant reads into caller memory using positional I/O; may run
+    // concurrently with each other but not with the other read functions
+    void ReadSampleTo(
+        // input parameters
+        MP4SampleId sampleId,
+        uint8_t*    pBytes,
+        uint32_t    numBytes,
+        // output parameters
+        uint32_t*     pSampleSize,
+        MP4Timestamp* pStartTime = NULL,
+        MP4Duration*  pDuration = NULL,
+        MP4Duration*  pRenderingOffset = NULL,
+        bool*         pIsSyncSample = NULL );
+
+    uint32_t ReadSamplesTo(
+        // input parameters
+        MP4SampleId firstSampleId,
+        uint32_t    numSamples,
+        uint8_t*    pBytes,
+        uint32_t    numBytes,
+        // output parameters
+        uint32_t*   pSampleSizes );
+
     void WriteSample(
         const uint8_t* pBytes,
         uint32_t numBytes,
@@ -163,6 +186,22 @@ public:
     MP4Duration GetDurationPerChunk();
     void        SetDurationPerChunk( MP4Duration );
 
+    // flat sample index, built on the first random access in read mode
+    bool        GetSampleIndexing() { return m_sampleIndexEnabled; }
+    void        SetSampleIndexing( bool enable );
+
+    // fragmented writing: samples are held back until the next fragment
+    MP4Duration GetFragmentDuration() { return m_chunkDuration; }
+    uint32_t    GetFragmentDataSize() { return m_sizeOfDataInChunkBuffer; }
+    MP4Atom*    AddFragmentAtom( MP4Atom& moofAtom );
+    void        WriteFragmentData();
+
+    // fragmented reading: samples of fragments extend the sample index
+    void        AppendFragmentSample( uint64_t offset, uint32_t size,
+                                      uint32_t duration, uint32_t renderingOffset,
+                                      bool isSyncSample );
+    void        UpdateFragmentDurations();
+
 protected:
     bool        InitEditListProperties();
 
@@ -175,6 +214,10 @@ protected:
                                    MP4SampleId* pFirstSampleId = NULL);
     MP4SampleId GetNextSyncSample(MP4SampleId sampleId);
 
+    bool UseSampleIndex(MP4SampleId sampleId);
+    bool BuildSampleIndex();
+    void ClearSampleIndex();
+
     void UpdateSampleSizes(MP4SampleId sampleId,
                            uint32_t numBytes);
     bool IsChunkFull(MP4SampleId sampleId);
@@ -196,6 +239,15 @@ protected:
 
     void WriteChunkBuffer();
 
+    void WriteFragmentSample(
+        const uint8_t* pBytes,
+        uint32_t       numBytes,
+        MP4Duration    duration,
+        MP4Duration    renderingOffset,
+        uint32_t       sampleFlags );
+
+    bool IsFragmentSample(MP4SampleId sampleId);
+
     void CalculateBytesPerSample();
 
     void FinishSdtp();
@@ -283,6 +335,43 @@ protected:
     MP4Integer16Property* m_pElstReservedProperty;
 
     string m_sdtpLog; // records frame types for H264 samples
+
+    // flat sample index, replacing the stsc/stco/stsz/stts/ctts/stss walks
+    // once a track is accessed randomly
+    struct SampleIndexEntry {
+        uint64_t     offset;            // absolute offset in the sample file
+        MP4Timestamp time;              // decoding time
+        uint32_t     size;              // in bytes
+        uint32_t     renderingOffset;   // ctts sample offset
+        bool         isSync;
+    };
+    struct SttsIndexEntry {
+        MP4SampleId  firstSample;       // first sample of the stts entry
+        MP4Timestamp elapsed;           // decoding time of firstSample
+        uint32_t     sampleDelta;
+    };
+
+    bool        m_sampleIndexEnabled;
+    bool        m_sampleIndexBuilt;
+    MP4SampleId m_lastIndexedSampleId;  // to tell sequential from random access
+    vector<SampleIndexEntry> m_sampleIndex;
+    vector<SttsIndexEntry>   m_sttsIndex;   // plus an end of track entry
+
+    // guards the table lookups and caches used by ReadSampleTo/ReadSamplesTo
+    std::mutex  m_readToLock;
+
+    // movie fragments; when writing, the chunk buffer holds the sample data
+    // of the pending fragment, when reading, m_numFragmentSamples samples at
+    // the end of the sample index come from fragments rather than the stbl
+    struct FragmentSampleEntry {
+        uint32_t     size;
+        uint32_t     duration;
+        uint32_t     flags;             // trun sample flags
+        uint32_t     renderingOffset;
+    };
+    vector<FragmentSampleEntry> m_fragmentSamples;
+    MP4Timestamp m_fragmentDecodeTime;  // decoding time of the pending fragment
+    uint32_t     m_numFragmentSamples;
 };
 
 MP4ARRAY_DECL(MP4Track, MP4Track*);
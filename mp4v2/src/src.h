@@ -11,6 +11,7 @@
 namespace mp4v2 { namespace impl {
     using namespace mp4v2::platform;
     using io::File;
+    using io::FileMapping;
     using io::FileSystem;
 }} // namspace mp4v2::impl
 
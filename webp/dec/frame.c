@@ -36,8 +36,8 @@ static WEBP_INLINE int hev_thresh_from_level(int level, int keyframe) {
   }
 }
 
-static void DoFilter(const VP8Decoder* const dec, int mb_x, int mb_y) {
-  const VP8ThreadContext* const ctx = &dec->thread_ctx_;
+static void DoFilter(const VP8Decoder* const dec,
+                     const VP8ThreadContext* const ctx, int mb_x, int mb_y) {
   const int y_bps = dec->cache_y_stride_;
   VP8FInfo* const f_info = ctx->f_info_ + mb_x;
   uint8_t* const y_dst = dec->cache_y_ + ctx->id_ * 16 * y_bps + mb_x * 16;
@@ -86,12 +86,13 @@ static void DoFilter(const VP8Decoder* const dec, int mb_x, int mb_y) {
 }
 
 // Filter the decoded macroblock row (if needed)
-static void FilterRow(const VP8Decoder* const dec) {
+static void FilterRow(const VP8Decoder* const dec,
+                      const VP8ThreadContext* const ctx) {
   int mb_x;
-  const int mb_y = dec->thread_ctx_.mb_y_;
-  assert(dec->thread_ctx_.filter_row_);
+  const int mb_y = ctx->mb_y_;
+  assert(ctx->filter_row_);
   for (mb_x = dec->tl_mb_x_; mb_x < dec->br_mb_x_; ++mb_x) {
-    DoFilter(dec, mb_x, mb_y);
+    DoFilter(dec, ctx, mb_x, mb_y);
   }
 }
 
@@ -178,7 +179,7 @@ static int FinishRow(VP8Decoder* const dec, VP8Io* const io) {
   int y_end = MACROBLOCK_VPOS(ctx->mb_y_ + 1);
 
   if (ctx->filter_row_) {
-    FilterRow(dec);
+    FilterRow(dec, ctx);
   }
 
   if (io->put) {
@@ -378,7 +379,11 @@ int VP8ExitCritical(VP8Decoder* const dec, VP8Io* const io) {
 // Initialize multi/single-thread worker
 static int InitThreadContext(VP8Decoder* const dec) {
   dec->cache_id_ = 0;
-  if (dec->use_threads_) {
+  if (dec->num_threads_ > 1) {
+    // Parallel decoding keeps all the macroblock rows: see
+    // VP8DecodeFrameParallel(). Workers are spawned there.
+    dec->num_caches_ = dec->mb_h_;
+  } else if (dec->use_threads_) {
     WebPWorker* const worker = &dec->worker_;
     if (!WebPWorkerReset(worker)) {
       return VP8SetError(dec, VP8_STATUS_OUT_OF_MEMORY,
@@ -447,6 +452,7 @@ static int AllocateMemory(VP8Decoder* const dec) {
   mem += 8 * mb_w;
 
   dec->mb_info_ = ((VP8MB*)mem) + 1;
+  dec->mb_left_ = dec->mb_info_ - 1;
   mem += mb_info_size;
 
   dec->f_info_ = f_info_size ? (VP8FInfo*)mem : NULL;
@@ -516,6 +522,286 @@ int VP8InitFrame(VP8Decoder* const dec, VP8Io* io) {
   return 1;
 }
 
+//------------------------------------------------------------------------------
+// Parallel decoding.
+//
+// When the whole bitstream is available and more than one worker is
+// requested, the frame is decoded as a wavefront over macroblock rows:
+//  * the modes of all macroblocks are parsed upfront from the first partition,
+//    which is the only part of the bitstream that is strictly sequential.
+//  * token partitions are then parsed concurrently. Each decoding worker owns
+//    one or more partitions, and parses and reconstructs the rows they code.
+//    Macroblock (x, y) needs (x + 1, y - 1) to be reconstructed first, for
+//    the top-right samples of intra4x4 prediction.
+//  * the in-loop filter runs as a second wavefront, row y being filtered by
+//    filtering worker 'y % num_filters'. Filtering (x, y) modifies the bottom
+//    of (x, y - 1), which must have been filtered along with (x + 1, y - 1).
+//  * the calling thread emits the finished rows through io->put(), in order.
+// Rows are kept in a full-frame cache instead of the usual delay line.
+
+#define MT_MAX_WORKERS 16    // cap on the number of workers of each kind
+#define MT_POST_STEP 4       // macroblocks between two progress updates
+
+typedef struct VP8MTContext VP8MTContext;
+
+typedef struct {
+  VP8MTContext* mt_;
+  int id_;             // waiter slot in mt_->sync_
+  int index_;          // worker index, among decoders or filters
+  VP8Decoder dec_;     // private copy of the decoder, for per-MB state
+  VP8MB left_;         // private left context
+} VP8MTWorker;
+
+struct VP8MTContext {
+  VP8Decoder* dec_;
+  VP8MBModes* modes_;         // mb_w_ * br_mb_y_
+  VP8FInfo* f_info_;          // filter strengths: mb_w_ * br_mb_y_
+  int* decoded_;              // per row: number of reconstructed macroblocks
+  int* filtered_;             // per row: number of filtered macroblocks
+  int num_decoders_;
+  int num_filters_;
+  WebPRowSync sync_;
+  VP8StatusCode status_;      // first error reported by a worker
+  const char* error_msg_;
+  VP8MTWorker workers_data_[2 * MT_MAX_WORKERS];
+  WebPWorker workers_[2 * MT_MAX_WORKERS];
+};
+
+static void MTSetError(VP8MTContext* const mt,
+                       VP8StatusCode error, const char* const msg) {
+  // Only the first failing thread gets to record its error.
+  if (WebPRowSyncAbort(&mt->sync_)) {
+    mt->status_ = error;
+    mt->error_msg_ = msg;
+  }
+}
+
+// Publishes the progress of a row every MT_POST_STEP macroblocks and at its
+// end, which keeps the shared lock out of the per-macroblock loop.
+static WEBP_INLINE void MTPostRow(VP8MTContext* const mt, int* const row,
+                                  int done, int mb_w) {
+  if ((done % MT_POST_STEP) == 0 || done == mb_w) {
+    WebPRowSyncPost(&mt->sync_, row, done);
+  }
+}
+
+static WEBP_INLINE int MTWaitRow(VP8MTContext* const mt, int waiter,
+                                 const int* const row, int known, int needed) {
+  return (known >= needed) ? known
+                           : WebPRowSyncWait(&mt->sync_, waiter, row, needed);
+}
+
+static int DecodeRowsMT(VP8MTWorker* const w, void* unused) {
+  VP8MTContext* const mt = w->mt_;
+  VP8Decoder* const dec = &w->dec_;
+  const int mb_w = dec->mb_w_;
+  const int last_part = dec->num_parts_ - 1;
+  (void)unused;
+  for (dec->mb_y_ = 0; dec->mb_y_ < dec->br_mb_y_; ++dec->mb_y_) {
+    const int mb_y = dec->mb_y_;
+    VP8BitReader* const token_br = &dec->parts_[mb_y & last_part];
+    const VP8MBModes* modes = mt->modes_ + mb_y * mb_w;
+    const int* const row_above = (mb_y > 0) ? &mt->decoded_[mb_y - 1] : NULL;
+    int above = (mb_y > 0) ? 0 : mb_w;   // known progress of the row above
+    if ((mb_y & last_part) % mt->num_decoders_ != w->index_) {
+      continue;   // partition owned by another worker
+    }
+    dec->cache_id_ = mb_y;
+    dec->f_info_ = mt->f_info_ + mb_y * mb_w;
+    VP8InitScanline(dec);
+    for (dec->mb_x_ = 0; dec->mb_x_ < mb_w; ++dec->mb_x_, ++modes) {
+      const int needed = (dec->mb_x_ + 2 < mb_w) ? dec->mb_x_ + 2 : mb_w;
+      above = MTWaitRow(mt, w->id_, row_above, above, needed);
+      if (above < 0) return 0;
+      dec->segment_ = modes->segment_;
+      dec->is_i4x4_ = modes->is_i4x4_;
+      dec->uvmode_ = modes->uvmode_;
+      memcpy(dec->imodes_, modes->imodes_, sizeof(dec->imodes_));
+      dec->mb_info_[dec->mb_x_].skip_ = modes->skip_;
+      if (!VP8ParseTokens(dec, token_br)) {
+        MTSetError(mt, VP8_STATUS_NOT_ENOUGH_DATA,
+                   "Premature end-of-file encountered.");
+        return 0;
+      }
+      VP8ReconstructBlock(dec);
+      VP8StoreBlock(dec);
+      MTPostRow(mt, &mt->decoded_[mb_y], dec->mb_x_ + 1, mb_w);
+    }
+  }
+  return 1;
+}
+
+static int FilterRowsMT(VP8MTWorker* const w, void* unused) {
+  VP8MTContext* const mt = w->mt_;
+  const VP8Decoder* const dec = mt->dec_;
+  const int mb_w = dec->mb_w_;
+  int mb_y;
+  (void)unused;
+  for (mb_y = w->index_; mb_y < dec->br_mb_y_; mb_y += mt->num_filters_) {
+    VP8ThreadContext ctx;
+    int mb_x;
+    const int* const row_above = (mb_y > 0) ? &mt->filtered_[mb_y - 1] : NULL;
+    int above = (mb_y > 0) ? 0 : mb_w;
+    int decoded = 0;
+    ctx.id_ = mb_y;
+    ctx.mb_y_ = mb_y;
+    ctx.f_info_ = mt->f_info_ + mb_y * mb_w;
+    ctx.filter_row_ = (mb_y >= dec->tl_mb_y_) && (mb_y <= dec->br_mb_y_);
+    for (mb_x = 0; mb_x < mb_w; ++mb_x) {
+      const int needed = (mb_x + 2 < mb_w) ? mb_x + 2 : mb_w;
+      decoded = MTWaitRow(mt, w->id_, &mt->decoded_[mb_y], decoded, mb_x + 1);
+      if (decoded < 0) return 0;
+      above = MTWaitRow(mt, w->id_, row_above, above, needed);
+      if (above < 0) return 0;
+      if (ctx.filter_row_ && mb_x >= dec->tl_mb_x_ && mb_x < dec->br_mb_x_) {
+        DoFilter(dec, &ctx, mb_x, mb_y);
+      }
+      MTPostRow(mt, &mt->filtered_[mb_y], mb_x + 1, mb_w);
+    }
+  }
+  return 1;
+}
+
+// Emits the rows through io->put() as soon as they are complete.
+static int OutputRowsMT(VP8MTContext* const mt, VP8Io* const io, int waiter) {
+  VP8Decoder* const dec = mt->dec_;
+  const int* const done = (mt->num_filters_ > 0) ? mt->filtered_
+                                                 : mt->decoded_;
+  for (dec->mb_y_ = 0; dec->mb_y_ < dec->br_mb_y_; ++dec->mb_y_) {
+    VP8ThreadContext* const ctx = &dec->thread_ctx_;
+    if (WebPRowSyncWait(&mt->sync_, waiter,
+                        &done[dec->mb_y_], dec->mb_w_) < 0) {
+      return 0;
+    }
+    ctx->id_ = dec->mb_y_;
+    ctx->mb_y_ = dec->mb_y_;
+    ctx->filter_row_ = 0;    // already done by the filtering workers
+    if (!FinishRow(dec, io)) {
+      if (dec->status_ == VP8_STATUS_OK) {
+        MTSetError(mt, VP8_STATUS_USER_ABORT, "Output aborted.");
+      } else {
+        MTSetError(mt, dec->status_, dec->error_msg_);
+      }
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static void* MTAllocate(VP8MTContext** const mt_ptr, uint8_t** const yuv_ptr,
+                        const VP8Decoder* const dec,
+                        int num_decoders, int num_filters) {
+  const int num_mbs = dec->mb_w_ * dec->br_mb_y_;
+  const size_t yuv_size = YUV_SIZE * sizeof(*dec->yuv_b_);
+  const size_t coeffs_size = 384 * sizeof(*dec->coeffs_);
+  const size_t needed = sizeof(VP8MTContext)
+                      + num_mbs * sizeof(VP8MBModes)
+                      + num_mbs * sizeof(VP8FInfo)
+                      + 2 * dec->br_mb_y_ * sizeof(int)
+                      + num_decoders * (yuv_size + coeffs_size) + ALIGN_MASK;
+  uint8_t* const mem = (uint8_t*)calloc(1, needed);
+  uint8_t* ptr = mem;
+  VP8MTContext* mt;
+  if (mem == NULL) return NULL;
+  assert(num_decoders > 0 && num_decoders <= MT_MAX_WORKERS);
+  assert(num_filters >= 0 && num_filters <= MT_MAX_WORKERS);
+
+  mt = (VP8MTContext*)ptr;
+  ptr += sizeof(*mt);
+  mt->modes_ = (VP8MBModes*)ptr;
+  ptr += num_mbs * sizeof(VP8MBModes);
+  mt->f_info_ = (VP8FInfo*)ptr;
+  ptr += num_mbs * sizeof(VP8FInfo);
+  mt->decoded_ = (int*)ptr;
+  ptr += dec->br_mb_y_ * sizeof(int);
+  mt->filtered_ = (int*)ptr;
+  ptr += dec->br_mb_y_ * sizeof(int);
+  mt->num_decoders_ = num_decoders;
+  mt->num_filters_ = num_filters;
+  mt->status_ = VP8_STATUS_OK;
+
+  *mt_ptr = mt;
+  *yuv_ptr = (uint8_t*)((uintptr_t)(ptr + ALIGN_MASK) & ~ALIGN_MASK);
+  return mem;
+}
+
+int VP8DecodeFrameParallel(VP8Decoder* const dec, VP8Io* const io) {
+  const int num_threads =
+      (dec->num_threads_ > MT_MAX_WORKERS) ? MT_MAX_WORKERS : dec->num_threads_;
+  const int num_decoders =
+      (dec->num_parts_ < num_threads) ? dec->num_parts_ : num_threads;
+  const int num_filters = (dec->filter_type_ > 0) ? num_threads : 0;
+  const int num_workers = num_decoders + num_filters;
+  VP8MTContext* mt = NULL;
+  uint8_t* yuv = NULL;
+  void* const mem = MTAllocate(&mt, &yuv, dec, num_decoders, num_filters);
+  int ok = 1;
+  int i;
+
+  if (mem == NULL) {
+    return VP8SetError(dec, VP8_STATUS_OUT_OF_MEMORY,
+                       "no memory for parallel decoding.");
+  }
+  if (!VP8ParseModes(dec, mt->modes_)) {
+    free(mem);
+    return 0;
+  }
+  if (!WebPRowSyncInit(&mt->sync_, num_workers + 1)) {
+    free(mem);
+    return VP8SetError(dec, VP8_STATUS_OUT_OF_MEMORY,
+                       "thread initialization failed.");
+  }
+  mt->dec_ = dec;
+  for (i = 0; i < num_workers; ++i) {
+    VP8MTWorker* const w = &mt->workers_data_[i];
+    WebPWorker* const worker = &mt->workers_[i];
+    w->mt_ = mt;
+    w->id_ = i;
+    WebPWorkerInit(worker);
+    worker->data1 = w;
+    worker->data2 = NULL;
+    if (i < num_decoders) {
+      w->index_ = i;
+      w->dec_ = *dec;
+      w->dec_.yuv_b_ = yuv;
+      yuv += YUV_SIZE * sizeof(*dec->yuv_b_);
+      w->dec_.coeffs_ = (int16_t*)yuv;
+      yuv += 384 * sizeof(*dec->coeffs_);
+      w->dec_.mb_left_ = &w->left_;
+      worker->hook = (WebPWorkerHook)DecodeRowsMT;
+    } else {
+      w->index_ = i - num_decoders;
+      worker->hook = (WebPWorkerHook)FilterRowsMT;
+    }
+  }
+  for (i = 0; ok && i < num_workers; ++i) {
+    ok = WebPWorkerReset(&mt->workers_[i]);
+    if (ok) WebPWorkerLaunch(&mt->workers_[i]);
+  }
+  if (!ok) {
+    MTSetError(mt, VP8_STATUS_OUT_OF_MEMORY, "thread initialization failed.");
+  } else {
+    ok = OutputRowsMT(mt, io, num_workers);
+  }
+  for (i = 0; i < num_workers; ++i) {
+    ok &= WebPWorkerSync(&mt->workers_[i]);
+    WebPWorkerEnd(&mt->workers_[i]);
+  }
+  if (!ok) {
+    if (mt->status_ != VP8_STATUS_OK) {
+      VP8SetError(dec, mt->status_, mt->error_msg_);
+    } else {
+      VP8SetError(dec, VP8_STATUS_BITSTREAM_ERROR, "Parallel decoding failed.");
+    }
+  }
+  WebPRowSyncEnd(&mt->sync_);
+  free(mem);
+  return ok;
+}
+
+#undef MT_MAX_WORKERS
+#undef MT_POST_STEP
+
 //------------------------------------------------------------------------------
 // Main reconstruction function.
 
@@ -207,7 +207,7 @@ static int CheckMemBufferMode(MemBuffer* const mem, MemBufferMode expected) {
 static void SaveContext(const VP8Decoder* dec, const VP8BitReader* token_br,
                         MBContext* const context) {
   const VP8BitReader* const br = &dec->br_;
-  const VP8MB* const left = dec->mb_info_ - 1;
+  const VP8MB* const left = dec->mb_left_;
   const VP8MB* const info = dec->mb_info_ + dec->mb_x_;
 
   context->left_ = *left;
@@ -221,7 +221,7 @@ static void SaveContext(const VP8Decoder* dec, const VP8BitReader* token_br,
 static void RestoreContext(const MBContext* context, VP8Decoder* const dec,
                            VP8BitReader* const token_br) {
   VP8BitReader* const br = &dec->br_;
-  VP8MB* const left = dec->mb_info_ - 1;
+  VP8MB* const left = dec->mb_left_;
   VP8MB* const info = dec->mb_info_ + dec->mb_x_;
 
   *left = context->left_;
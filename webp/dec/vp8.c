@@ -544,7 +544,7 @@ static void ParseResiduals(VP8Decoder* const dec,
   ProbaArray ac_prob;
   const VP8QuantMatrix* q = &dec->dqm_[dec->segment_];
   int16_t* dst = dec->coeffs_;
-  VP8MB* const left_mb = dec->mb_info_ - 1;
+  VP8MB* const left_mb = dec->mb_left_;
   PackedNz nz_ac, nz_dc;
   PackedNz tnz, lnz;
   uint32_t non_zero_ac = 0;
@@ -620,10 +620,9 @@ static void ParseResiduals(VP8Decoder* const dec,
 //------------------------------------------------------------------------------
 // Main loop
 
-int VP8DecodeMB(VP8Decoder* const dec, VP8BitReader* const token_br) {
+// Parse segment, skip flag and intra modes from the first partition.
+static void ParseMBModes(VP8Decoder* const dec, VP8MB* const info) {
   VP8BitReader* const br = &dec->br_;
-  VP8MB* const left = dec->mb_info_ - 1;
-  VP8MB* const info = dec->mb_info_ + dec->mb_x_;
 
   // Note: we don't save segment map (yet), as we don't expect
   // to decode more than 1 keyframe.
@@ -636,9 +635,19 @@ int VP8DecodeMB(VP8Decoder* const dec, VP8BitReader* const token_br) {
   info->skip_ = dec->use_skip_proba_ ? VP8GetBit(br, dec->skip_p_) : 0;
 
   VP8ParseIntraMode(br, dec);
-  if (br->eof_) {
+}
+
+int VP8DecodeMB(VP8Decoder* const dec, VP8BitReader* const token_br) {
+  ParseMBModes(dec, dec->mb_info_ + dec->mb_x_);
+  if (dec->br_.eof_) {
     return 0;
   }
+  return VP8ParseTokens(dec, token_br);
+}
+
+int VP8ParseTokens(VP8Decoder* const dec, VP8BitReader* const token_br) {
+  VP8MB* const left = dec->mb_left_;
+  VP8MB* const info = dec->mb_info_ + dec->mb_x_;
 
   if (!info->skip_) {
     ParseResiduals(dec, info, token_br);
@@ -654,8 +663,29 @@ int VP8DecodeMB(VP8Decoder* const dec, VP8BitReader* const token_br) {
   return (!token_br->eof_);
 }
 
+int VP8ParseModes(VP8Decoder* const dec, VP8MBModes* const modes) {
+  VP8MBModes* m = modes;
+  VP8MB info;
+  for (dec->mb_y_ = 0; dec->mb_y_ < dec->br_mb_y_; ++dec->mb_y_) {
+    memset(dec->intra_l_, B_DC_PRED, sizeof(dec->intra_l_));
+    for (dec->mb_x_ = 0; dec->mb_x_ < dec->mb_w_; ++dec->mb_x_, ++m) {
+      ParseMBModes(dec, &info);
+      if (dec->br_.eof_) {
+        return VP8SetError(dec, VP8_STATUS_NOT_ENOUGH_DATA,
+                           "Premature end-of-file encountered.");
+      }
+      m->segment_ = dec->segment_;
+      m->skip_ = info.skip_;
+      m->is_i4x4_ = dec->is_i4x4_;
+      m->uvmode_ = dec->uvmode_;
+      memcpy(m->imodes_, dec->imodes_, sizeof(m->imodes_));
+    }
+  }
+  return 1;
+}
+
 void VP8InitScanline(VP8Decoder* const dec) {
-  VP8MB* const left = dec->mb_info_ - 1;
+  VP8MB* const left = dec->mb_left_;
   left->nz_ = 0;
   left->dc_nz_ = 0;
   memset(dec->intra_l_, B_DC_PRED, sizeof(dec->intra_l_));
@@ -665,27 +695,33 @@ void VP8InitScanline(VP8Decoder* const dec) {
 }
 
 static int ParseFrame(VP8Decoder* const dec, VP8Io* io) {
-  for (dec->mb_y_ = 0; dec->mb_y_ < dec->br_mb_y_; ++dec->mb_y_) {
-    VP8BitReader* const token_br =
-        &dec->parts_[dec->mb_y_ & (dec->num_parts_ - 1)];
-    VP8InitScanline(dec);
-    for (dec->mb_x_ = 0; dec->mb_x_ < dec->mb_w_;  dec->mb_x_++) {
-      if (!VP8DecodeMB(dec, token_br)) {
-        return VP8SetError(dec, VP8_STATUS_NOT_ENOUGH_DATA,
-                           "Premature end-of-file encountered.");
-      }
-      VP8ReconstructBlock(dec);
+  if (dec->num_threads_ > 1) {
+    if (!VP8DecodeFrameParallel(dec, io)) {
+      return 0;
+    }
+  } else {
+    for (dec->mb_y_ = 0; dec->mb_y_ < dec->br_mb_y_; ++dec->mb_y_) {
+      VP8BitReader* const token_br =
+          &dec->parts_[dec->mb_y_ & (dec->num_parts_ - 1)];
+      VP8InitScanline(dec);
+      for (dec->mb_x_ = 0; dec->mb_x_ < dec->mb_w_;  dec->mb_x_++) {
+        if (!VP8DecodeMB(dec, token_br)) {
+          return VP8SetError(dec, VP8_STATUS_NOT_ENOUGH_DATA,
+                             "Premature end-of-file encountered.");
+        }
+        VP8ReconstructBlock(dec);
 
-      // Store data and save block's filtering params
-      VP8StoreBlock(dec);
+        // Store data and save block's filtering params
+        VP8StoreBlock(dec);
+      }
+      if (!VP8ProcessRow(dec, io)) {
+        return VP8SetError(dec, VP8_STATUS_USER_ABORT, "Output aborted.");
+      }
     }
-    if (!VP8ProcessRow(dec, io)) {
-      return VP8SetError(dec, VP8_STATUS_USER_ABORT, "Output aborted.");
+    if (dec->use_threads_ && !WebPWorkerSync(&dec->worker_)) {
+      return 0;
     }
   }
-  if (dec->use_threads_ && !WebPWorkerSync(&dec->worker_)) {
-    return 0;
-  }
 
   // Finish
 #ifndef ONLY_KEYFRAME_CODE
@@ -167,6 +167,16 @@ typedef struct {
   quant_t y1_mat_, y2_mat_, uv_mat_;
 } VP8QuantMatrix;
 
+// Intra modes of one macroblock, parsed ahead of the token partitions when
+// decoding in parallel (see VP8ParseModes()).
+typedef struct {
+  uint8_t segment_;
+  uint8_t skip_;
+  uint8_t is_i4x4_;
+  uint8_t uvmode_;
+  uint8_t imodes_[16];
+} VP8MBModes;
+
 // Persistent information needed by the parallel processing
 typedef struct {
   int id_;            // cache row to process (in [0..2])
@@ -199,6 +209,7 @@ struct VP8Decoder {
   int cache_id_;       // current cache row
   int num_caches_;     // number of cached rows of 16 pixels (1, 2 or 3)
   VP8ThreadContext thread_ctx_;  // Thread context
+  int num_threads_;    // if > 1, number of workers for parallel decoding
 
   // dimension, in macroblock units.
   int mb_w_, mb_h_;
@@ -239,6 +250,7 @@ struct VP8Decoder {
   uint8_t* u_t_, *v_t_;  // top u/v samples: 8 * mb_w_ each
 
   VP8MB* mb_info_;       // contextual macroblock info (mb_w_ + 1)
+  VP8MB* mb_left_;       // left context (mb_info_ - 1, unless per-worker)
   VP8FInfo* f_info_;     // filter strength info
   uint8_t* yuv_b_;       // main block for Y/U/V (size = YUV_SIZE)
   int16_t* coeffs_;      // 384 coeffs = (16+8+8) * 4*4
@@ -325,6 +337,15 @@ void VP8StoreBlock(VP8Decoder* const dec);
 void VP8InitScanline(VP8Decoder* const dec);
 // Decode one macroblock. Returns false if there is not enough data.
 int VP8DecodeMB(VP8Decoder* const dec, VP8BitReader* const token_br);
+// Parse the residuals of the current macroblock, whose modes are already
+// known. Returns false if there is not enough data.
+int VP8ParseTokens(VP8Decoder* const dec, VP8BitReader* const token_br);
+// Parse the modes of all the macroblocks to be decoded (mb_w_ * br_mb_y_
+// entries) from the first partition. Returns false in case of error.
+int VP8ParseModes(VP8Decoder* const dec, VP8MBModes* const modes);
+// Decode the whole frame using dec->num_threads_ workers. Must be called
+// after VP8InitFrame(). Returns false in case of error.
+int VP8DecodeFrameParallel(VP8Decoder* const dec, VP8Io* const io);
 
 // in alpha.c
 const uint8_t* VP8DecompressAlphaRows(VP8Decoder* const dec,
@@ -297,8 +297,10 @@ static VP8StatusCode DecodeInto(const uint8_t* data, uint32_t data_size,
 
 #ifdef WEBP_USE_THREAD
   dec->use_threads_ = params->options && (params->options->use_threads > 0);
+  dec->num_threads_ = dec->use_threads_ ? params->options->use_threads : 0;
 #else
   dec->use_threads_ = 0;
+  dec->num_threads_ = 0;
 #endif
 
   // Decode bitstream header, update io->width/io->height.
@@ -236,6 +236,111 @@ void WebPWorkerEnd(WebPWorker* const worker) {
   assert(worker->status_ == NOT_OK);
 }
 
+//------------------------------------------------------------------------------
+// WebPRowSync
+
+int WebPRowSyncInit(WebPRowSync* const sync, int num_waiters) {
+  memset(sync, 0, sizeof(*sync));
+  if (num_waiters <= 0 || num_waiters > WEBP_ROW_SYNC_MAX_WAITERS) {
+    return 0;
+  }
+#ifdef WEBP_USE_THREAD
+  {
+    int i;
+    if (pthread_mutex_init(&sync->mutex_, NULL)) {
+      return 0;
+    }
+    for (i = 0; i < num_waiters; ++i) {
+      if (pthread_cond_init(&sync->conditions_[i], NULL)) {
+        while (i-- > 0) pthread_cond_destroy(&sync->conditions_[i]);
+        pthread_mutex_destroy(&sync->mutex_);
+        return 0;
+      }
+    }
+  }
+#endif
+  sync->num_waiters_ = num_waiters;
+  return 1;
+}
+
+#ifdef WEBP_USE_THREAD
+// Wakes up the waiters blocked on 'counter' whose value is reached, or all
+// the blocked waiters if 'counter' is NULL. Must be called with the mutex held.
+static void WakeUpWaiters(WebPRowSync* const sync, const int* const counter) {
+  int i;
+  for (i = 0; i < sync->num_waiters_; ++i) {
+    const int* const on = sync->waiting_on_[i];
+    if (on != NULL &&
+        (counter == NULL || (on == counter && *on >= sync->wait_value_[i]))) {
+      sync->waiting_on_[i] = NULL;
+      pthread_cond_signal(&sync->conditions_[i]);
+    }
+  }
+}
+#endif
+
+void WebPRowSyncPost(WebPRowSync* const sync, int* const counter, int value) {
+#ifdef WEBP_USE_THREAD
+  pthread_mutex_lock(&sync->mutex_);
+  *counter = value;
+  WakeUpWaiters(sync, counter);
+  pthread_mutex_unlock(&sync->mutex_);
+#else
+  (void)sync;
+  *counter = value;
+#endif
+}
+
+int WebPRowSyncWait(WebPRowSync* const sync, int waiter,
+                    const int* const counter, int value) {
+  int current;
+  assert(waiter >= 0 && waiter < sync->num_waiters_);
+#ifdef WEBP_USE_THREAD
+  pthread_mutex_lock(&sync->mutex_);
+  while (!sync->aborted_ && *counter < value) {
+    sync->waiting_on_[waiter] = counter;
+    sync->wait_value_[waiter] = value;
+    pthread_cond_wait(&sync->conditions_[waiter], &sync->mutex_);
+  }
+  sync->waiting_on_[waiter] = NULL;
+  current = sync->aborted_ ? -1 : *counter;
+  pthread_mutex_unlock(&sync->mutex_);
+#else
+  (void)waiter;
+  // Without threads, nobody else can make the counter progress.
+  current = (sync->aborted_ || *counter < value) ? -1 : *counter;
+#endif
+  return current;
+}
+
+int WebPRowSyncAbort(WebPRowSync* const sync) {
+  int first;
+#ifdef WEBP_USE_THREAD
+  pthread_mutex_lock(&sync->mutex_);
+  first = !sync->aborted_;
+  sync->aborted_ = 1;
+  WakeUpWaiters(sync, NULL);
+  pthread_mutex_unlock(&sync->mutex_);
+#else
+  first = !sync->aborted_;
+  sync->aborted_ = 1;
+#endif
+  return first;
+}
+
+void WebPRowSyncEnd(WebPRowSync* const sync) {
+#ifdef WEBP_USE_THREAD
+  int i;
+  for (i = 0; i < sync->num_waiters_; ++i) {
+    pthread_cond_destroy(&sync->conditions_[i]);
+  }
+  if (sync->num_waiters_ > 0) {
+    pthread_mutex_destroy(&sync->mutex_);
+  }
+#endif
+  sync->num_waiters_ = 0;
+}
+
 //------------------------------------------------------------------------------
 
 #if defined(__cplusplus) || defined(c_plusplus)
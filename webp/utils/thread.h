@@ -77,6 +77,43 @@ void WebPWorkerLaunch(WebPWorker* const worker);
 // must call WebPWorkerReset() again.
 void WebPWorkerEnd(WebPWorker* const worker);
 
+//------------------------------------------------------------------------------
+// Progress counters shared by several workers
+
+#define WEBP_ROW_SYNC_MAX_WAITERS 32
+
+// Lets several workers publish monotonically increasing progress counters
+// (e.g. 'number of macroblocks done in row y') and wait on each other's.
+// Each thread waiting on the object uses its own 'waiter' slot, in
+// [0..num_waiters - 1].
+typedef struct {
+#if WEBP_USE_THREAD
+  pthread_mutex_t mutex_;
+  pthread_cond_t  conditions_[WEBP_ROW_SYNC_MAX_WAITERS];
+#endif
+  // counter the waiter is blocked on (NULL if none), and the value it needs
+  const int* waiting_on_[WEBP_ROW_SYNC_MAX_WAITERS];
+  int wait_value_[WEBP_ROW_SYNC_MAX_WAITERS];
+  int num_waiters_;
+  int aborted_;
+} WebPRowSync;
+
+// Initializes the object for 'num_waiters' threads. Returns false in case of
+// error, or if num_waiters exceeds WEBP_ROW_SYNC_MAX_WAITERS.
+int WebPRowSyncInit(WebPRowSync* const sync, int num_waiters);
+// Sets '*counter' to 'value' and wakes up the waiters blocked on 'counter'
+// that need no more than 'value'.
+void WebPRowSyncPost(WebPRowSync* const sync, int* const counter, int value);
+// Blocks until '*counter' reaches at least 'value'. Returns the current value
+// of the counter, or -1 if WebPRowSyncAbort() was called meanwhile.
+int WebPRowSyncWait(WebPRowSync* const sync, int waiter,
+                    const int* const counter, int value);
+// Wakes up all the waiters and makes all subsequent waits fail. Returns true
+// for the call that actually aborted, false if the object already was.
+int WebPRowSyncAbort(WebPRowSync* const sync);
+// Releases the resources. No thread must be waiting on the object anymore.
+void WebPRowSyncEnd(WebPRowSync* const sync);
+
 //------------------------------------------------------------------------------
 
 #if defined(__cplusplus) || defined(c_plusplus)
@@ -351,7 +351,10 @@ typedef struct {
   int scaled_width, scaled_height;    // final resolution
   int force_rotation;                 // forced rotation (to be applied _last_)
   int no_enhancement;                 // if true, discard enhancement layer
-  int use_threads;                    // if true, use multi-threaded decoding
+  int use_threads;                    // if true, use multi-threaded decoding.
+                                      // Values > 1 set the number of workers
+                                      // decoding partitions and filtering in
+                                      // parallel (non-incremental decoding).
 } WebPDecoderOptions;
 
 // Main object storing the configuration for advanced decoding.